@@ -200,9 +200,13 @@ void randomize_pkt(int start, int stop)
 
 void send_encrypted(hzl_ClientCtx_t *client, hzl_Gid_t groupId ) {
 	hzl_Err_t err;
-	hzl_CbsPduMsg_t *pPdu; // Packed data, fits into one CAN FD message
-	err = hzl_ClientNewMsg(&pPdu);
-	err = hzl_ClientBuildSecuredFd(pPdu, client, cf.data, sizeof(cf.data) - 40, groupId);
+	// The message is built directly into the frame, so the plaintext must be moved out of it.
+	// The header stays in the payload (NULL CAN ID): the CAN IDs carry the car signals.
+	uint8_t plaintext[sizeof(cf.data) - 40];
+	size_t packedLen = 0;
+	memcpy(plaintext, cf.data, sizeof(plaintext));
+	err = hzl_ClientBuildSecuredFdInto(cf.data, sizeof(cf.data), &packedLen, NULL,
+	                                   client, plaintext, sizeof(plaintext), groupId);
 	if (err == HZL_ERR_SESSION_NOT_ESTABLISHED)
 	{
 		printf("ERROR NO SESSION \n");
@@ -225,8 +229,8 @@ void send_encrypted(hzl_ClientCtx_t *client, hzl_Gid_t groupId ) {
 	} else if(err != HZL_OK){
 		printf("SOME ERROR ENCRYPTING MESSAGE\n");
 	}
-	memcpy(cf.data, pPdu->data, sizeof(pPdu->data));
-	cf.len = pPdu->dataLen;
+	if (err != HZL_OK) memset(cf.data, 0, sizeof(cf.data));
+	cf.len = packedLen;
 	send_pkt(CANFD_MTU);
 
 }
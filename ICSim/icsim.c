@@ -9,6 +9,7 @@
 #include <unistd.h>
 #include <string.h>
 #include <time.h>
+#include <sys/time.h>
 #include <getopt.h>
 #include <sys/socket.h>
 #include <sys/ioctl.h>
@@ -63,6 +64,7 @@
 #define MODEL_BMW_X1_HANDBRAKE_BYTE 5
 
 const int canfd_on = 1;
+const int timestamp_on = 1;
 int debug = 0;
 int randomize = 0;
 int seed = 0;
@@ -86,6 +88,19 @@ long map(long x, long in_min, long in_max, long out_min, long out_max)
   return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
 }
 
+// Converts the kernel RX timestamp of a frame (wall-clock) to the clock Hazelnet uses,
+// by subtracting the age of the frame from the current Hazelnet time
+hzl_Timestamp_t hzl_rx_timestamp(hzl_ServerCtx_t *server, const struct timeval *rx) {
+  struct timeval now;
+  hzl_Timestamp_t hzl_now = 0;
+  long long age_ms;
+  server->io.currentTime(&hzl_now);
+  gettimeofday(&now, NULL);
+  age_ms = (now.tv_sec - rx->tv_sec) * 1000LL + (now.tv_usec - rx->tv_usec) / 1000;
+  if(age_ms < 0) age_ms = 0;
+  return hzl_now - (hzl_Timestamp_t) age_ms;
+}
+
 // Adds data dir to file name
 // Uses a single pointer so not to have a memory leak
 // returns point to data_files or NULL if append is too large
@@ -381,6 +396,8 @@ int main(int argc, char *argv[]) {
   addr.can_ifindex = ifr.ifr_ifindex;
   // CAN FD Mode
   setsockopt(can, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &canfd_on, sizeof(canfd_on));
+  // Kernel RX timestamps, to check the freshness against the actual arrival time
+  setsockopt(can, SOL_SOCKET, SO_TIMESTAMP, &timestamp_on, sizeof(timestamp_on));
 
   iov.iov_base = &frame;
   iov.iov_len = sizeof(frame);
@@ -476,6 +493,7 @@ int main(int argc, char *argv[]) {
       SDL_Delay(3);
     }
 
+      msg.msg_controllen = sizeof(ctrlmsg);
       nbytes = recvmsg(can, &msg, 0);
       if (nbytes < 0) {
         perror("read");
@@ -489,16 +507,37 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "read: incomplete CAN frame\n");
         return 1;
       }
-      hzl_CbsPduMsg_t reactionPdu;
-      hzl_RxSduMsg_t receivedUserData;
+      hzl_Timestamp_t rx_timestamp = 0;
+      int has_rx_timestamp = 0;
+      for (cmsg = CMSG_FIRSTHDR(&msg);
+           cmsg && (cmsg->cmsg_level == SOL_SOCKET);
+           cmsg = CMSG_NXTHDR(&msg,cmsg)) {
+             if (cmsg->cmsg_type == SO_TIMESTAMP) {
+               struct timeval tv;
+               memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+               rx_timestamp = hzl_rx_timestamp(server, &tv);
+               has_rx_timestamp = 1;
+             }
+             else if (cmsg->cmsg_type == SO_RXQ_OVFL) {
+               //dropcnt[i] = *(__u32 *)CMSG_DATA(cmsg);
+  	       fprintf(stderr, "Dropped packet\n");
+             }
+      }
 
-      hzl_Err_t hzlErrCode = hzl_ServerProcessReceived(
+      if (!has_rx_timestamp) {
+        server->io.currentTime(&rx_timestamp);
+      }
+      hzl_CbsPduMsg_t reactionPdu;
+      hzl_RxSduView_t receivedUserData;
+      // Decrypts directly inside the received frame, no copy of the user data
+      hzl_Err_t hzlErrCode = hzl_ServerProcessReceivedInPlace(
         &reactionPdu,
         &receivedUserData,
         server,
         frame.data,
         frame.len,
-        frame.can_id
+        frame.can_id,
+        rx_timestamp
       );
 
       int can_id = frame.can_id;
@@ -545,19 +584,13 @@ int main(int argc, char *argv[]) {
         // buffers) but not at run-time.
         printf("Some other problem\n");
       }
-      for (cmsg = CMSG_FIRSTHDR(&msg);
-           cmsg && (cmsg->cmsg_level == SOL_SOCKET);
-           cmsg = CMSG_NXTHDR(&msg,cmsg)) {
-             if (cmsg->cmsg_type == SO_TIMESTAMP) {
-               // struct timeval tv = *(struct timeval *)CMSG_DATA(cmsg);
-             }
-             else if (cmsg->cmsg_type == SO_RXQ_OVFL)
-               //dropcnt[i] = *(__u32 *)CMSG_DATA(cmsg);
-  	     fprintf(stderr, "Dropped packet\n");
-             }
 //      if(debug) fprint_canframe(stdout, &frame, "\n", 0, maxdlen);
 
-      memcpy(frame.data, receivedUserData.data, sizeof(receivedUserData.data));
+      // Move the user data to the start of the frame, where the status updaters expect it
+      if (receivedUserData.dataLen > 0)
+        memmove(frame.data, receivedUserData.data, receivedUserData.dataLen);
+      memset(frame.data + receivedUserData.dataLen, 0,
+             sizeof(frame.data) - receivedUserData.dataLen);
       if(frame.can_id == door_id) update_door_status(&frame, maxdlen);
       if(frame.can_id == signal_id) update_signal_status(&frame, maxdlen);
       if(frame.can_id == speed_id) update_speed_status(&frame, maxdlen);
@@ -53,6 +53,51 @@ extern "C"
 #include <stddef.h>  /* For NULL, size_t */
 #include <string.h>  /* For memcpy(), if available also memset_s() */
 
+/**
+ * @def HZL_AEAD_BACKEND_ASCON128
+ * True when the AEAD cipher securing the messages is Ascon-128.
+ *
+ * Exactly one `HZL_AEAD_BACKEND_*` is defined to 1, selected at build time with the CMake
+ * option `HZL_AEAD_BACKEND`. When none is defined, AES-GCM is used.
+ * All parties on the bus must use the same backend.
+ */
+/**
+ * @def HZL_AEAD_BACKEND_ASCON128A
+ * True when the AEAD cipher securing the messages is Ascon-128a.
+ * @see #HZL_AEAD_BACKEND_ASCON128
+ */
+/**
+ * @def HZL_AEAD_BACKEND_AES_GCM
+ * True when the AEAD cipher securing the messages is AES-128-GCM, provided by wolfSSL.
+ * @see #HZL_AEAD_BACKEND_ASCON128
+ */
+/**
+ * @def HZL_AEAD_BACKEND_AES_CCM
+ * True when the AEAD cipher securing the messages is AES-128-CCM, provided by wolfSSL.
+ * @see #HZL_AEAD_BACKEND_ASCON128
+ */
+/**
+ * @def HZL_AEAD_BACKEND_AES
+ * True when the AEAD cipher is any of the AES-based ones, requiring wolfSSL.
+ * @see #HZL_AEAD_BACKEND_ASCON128
+ */
+
+#if !defined(HZL_AEAD_BACKEND_ASCON128) && !defined(HZL_AEAD_BACKEND_ASCON128A) \
+ && !defined(HZL_AEAD_BACKEND_AES_GCM) && !defined(HZL_AEAD_BACKEND_AES_CCM)
+#define HZL_AEAD_BACKEND_AES_GCM 1
+#endif
+
+#if (defined(HZL_AEAD_BACKEND_ASCON128) + defined(HZL_AEAD_BACKEND_ASCON128A) \
+     + defined(HZL_AEAD_BACKEND_AES_GCM) + defined(HZL_AEAD_BACKEND_AES_CCM)) != 1
+#error "Exactly one HZL_AEAD_BACKEND_* must be defined."
+#endif
+
+#if defined(HZL_AEAD_BACKEND_AES_GCM) || defined(HZL_AEAD_BACKEND_AES_CCM)
+#define HZL_AEAD_BACKEND_AES 1
+#else
+#define HZL_AEAD_BACKEND_AES 0
+#endif
+
 /**
  * @def HZL_OS_AVAILABLE
  * True when a desktop operating system was found.
@@ -75,6 +120,11 @@ extern "C"
  * True when a Unix-like operating system was found, e.g. Linux, macOS, *BSD
  * @see #HZL_OS_AVAILABLE
  */
+/**
+ * @def HZL_OS_AVAILABLE_LINUX
+ * True when a Linux operating system was found, providing the SocketCAN API.
+ * @see #HZL_OS_AVAILABLE_NIX
+ */
 
 #if defined(WIN32) || defined(_WIN32) || defined(__WIN32__) \
  || defined(_WIN64) || defined(__NT__)
@@ -82,16 +132,20 @@ extern "C"
 #define HZL_OS_AVAILABLE 1
 #define HZL_OS_AVAILABLE_WIN 1
 #define HZL_OS_AVAILABLE_NIX 0
+#define HZL_OS_AVAILABLE_LINUX 0
 
 #include <Windows.h> /* To avoid compilation errors for other Windows headers. */
 #include <sysinfoapi.h> /* For GetSystemTimeAsFileTime(), FILETIME, ULARGE_INTEGER */
 #include <bcrypt.h>  /* For BCryptGenRandom() - requires explicit linking to `bcrypt` lib. */
 #include <stdio.h>   /* For config file IO */
 #include <stdlib.h>  /* For calloc(), free() */
+#include <malloc.h>  /* For _aligned_malloc(), _aligned_free() */
 
 #if defined(_MSC_VER) && _MSC_VER <= 1916
 // Fix for compilation with Visual Studio 2017 not supporting C11 yet.
 #define _Static_assert static_assert
+#define _Alignas(alignment) __declspec(align(alignment))
+#define _Alignof __alignof
 #endif
 
 #elif defined(__linux__) \
@@ -101,9 +155,14 @@ extern "C"
 #define HZL_OS_AVAILABLE 1
 #define HZL_OS_AVAILABLE_WIN 0
 #define HZL_OS_AVAILABLE_NIX 1
+#if defined(__linux__)
+#define HZL_OS_AVAILABLE_LINUX 1
+#else
+#define HZL_OS_AVAILABLE_LINUX 0
+#endif
 
-#include <sys/time.h> /* For gettimeofday() */
-#include <stdio.h>    /* For config file IO and TRNG with /dev/urandom */
+#include <time.h>     /* For clock_gettime(), CLOCK_MONOTONIC */
+#include <stdio.h>    /* For config file IO and TRNG fallback on /dev/urandom */
 #include <stdlib.h>   /* For calloc(), free() */
 
 #else
@@ -111,6 +170,7 @@ extern "C"
 #define HZL_OS_AVAILABLE 0
 #define HZL_OS_AVAILABLE_WIN 0
 #define HZL_OS_AVAILABLE_NIX 0
+#define HZL_OS_AVAILABLE_LINUX 0
 
 #endif
 
@@ -124,6 +184,132 @@ extern "C"
 #define HZL_API
 #endif
 
+/**
+ * @def HZL_LAZY_OUTPUT_CLEARING
+ * Selects how the functions processing a received message clear their outputs, the
+ * #hzl_RxSduMsg_t and the #hzl_CbsPduMsg_t, before writing into them.
+ *
+ * When 0 (default), both structs are securely zeroed completely, about 150 B per message.
+ *
+ * When 1 (CMake option `HZL_LAZY_OUTPUT_CLEARING`), only the metadata and the first `dataLen`
+ * bytes of the received user data are, i.e. the plaintext of the previous message. This relies
+ * on the library never leaving any plaintext byte after `dataLen`, also on errors, so no stale
+ * plaintext survives: the #hzl_RxSduMsg_t MUST thus be zero-initialised before its first use and
+ * only written by the library afterwards. The reaction just gets a zero `dataLen`, as it's always
+ * fully written up to its length and contains nothing secret, like in the in-place functions.
+ * Meant for processes serving many buses at high rates.
+ */
+#ifndef HZL_LAZY_OUTPUT_CLEARING
+#define HZL_LAZY_OUTPUT_CLEARING 0
+#endif
+
+/**
+ * @def HZL_INTEGER_CTRDELAY
+ * Selects how the Counter Nonce Delay, ctrdelay() of the CBS specification, is computed
+ * for every received SADFD message.
+ *
+ * When 0 (default), with single-precision floats, as before. Their rounding errors make many
+ * results differ by 1 from the exact `ceil()` of the specification.
+ *
+ * When 1 (CMake option `HZL_INTEGER_CTRDELAY`), with 32-bit unsigned integers only, exactly as
+ * the specification rounds. Meant for embedded systems without a floating point unit.
+ */
+#ifndef HZL_INTEGER_CTRDELAY
+#define HZL_INTEGER_CTRDELAY 0
+#endif
+
+/** Value of #HZL_FIXED_HEADER_TYPE for libraries supporting any CBS header type. */
+#define HZL_FIXED_HEADER_TYPE_ANY (-1)
+
+/**
+ * @def HZL_FIXED_HEADER_TYPE
+ * Selects which CBS header types the libraries support.
+ *
+ * When #HZL_FIXED_HEADER_TYPE_ANY (default), the header type is chosen at runtime with the
+ * `headerType` field of the configuration and every header is packed and unpacked by a switch
+ * on it.
+ *
+ * When a #hzl_HeaderType_t value in [0, 6] (CMake option `HZL_FIXED_HEADER_TYPE`), the libraries
+ * are specialised for that header type only: its packing and unpacking are inlined and its
+ * length is a constant, folded into the offsets of all payload fields. Configurations with any
+ * other header type are rejected with #HZL_ERR_INVALID_HEADER_TYPE.
+ * Meant for embedded systems on buses with a known header type. Users of the libraries must use
+ * the same value.
+ */
+#ifndef HZL_FIXED_HEADER_TYPE
+#define HZL_FIXED_HEADER_TYPE HZL_FIXED_HEADER_TYPE_ANY
+#endif
+
+/**
+ * @def HZL_SADTP
+ * True when the libraries support Secured Application Data over Transport Protocol (SADTP)
+ * messages, split over multiple CAN frames.
+ *
+ * SADTP requires an AEAD backend en/decrypting incrementally, so each message is decrypted
+ * frame by frame as its frames arrive: Ascon-128 or Ascon-128a. SADTP is deliberately not
+ * available with the AES backends, to keep the reassembly slots small: their streaming state
+ * would be a whole wolfSSL key context of #HZL_AEAD_KEY_SCHEDULE_LEN bytes per slot, instead
+ * of the #HZL_AEAD_STATE_LEN bytes of Ascon.
+ *
+ * The frames of a message are authenticated only by the tag at its end, so whoever can inject
+ * frames on the bus can prevent the reception of SADTP messages: a Consecutive Frame with the
+ * expected sequence number corrupts the message being received, a First Frame with a newer
+ * ctrnonce restarts it, forged First Frames occupy the reassembly slots until they time out.
+ * Out-of-sequence Consecutive Frames and First Frames without a newer ctrnonce are ignored
+ * instead, keeping the message being received.
+ *
+ * Default 1 with the Ascon backends and 0 with the AES ones, CMake option `HZL_SADTP`.
+ * Users of the libraries must use the same value.
+ */
+#ifndef HZL_SADTP
+#define HZL_SADTP (!HZL_AEAD_BACKEND_AES)
+#endif
+#if HZL_SADTP && HZL_AEAD_BACKEND_AES
+#error "HZL_SADTP requires a streaming AEAD backend: Ascon-128 or Ascon-128a."
+#endif
+
+/**
+ * @def HZL_SADTP_MAX_SDU_LEN
+ * Longest user data in bytes a Secured Application Data over Transport Protocol (SADTP) message
+ * can carry, thus the length of each reassembly buffer of a #hzl_SadtpRxPool_t.
+ *
+ * Default 4096 B, CMake option `HZL_SADTP_MAX_SDU_LEN`. At most 0xFFFF, as the plaintext length
+ * is transmitted in 2 bytes. Longer SADTP messages are rejected by the receivers, so it should
+ * be the same for all parties on the bus.
+ */
+#ifndef HZL_SADTP_MAX_SDU_LEN
+#define HZL_SADTP_MAX_SDU_LEN 4096U
+#endif
+#if HZL_SADTP_MAX_SDU_LEN > 0xFFFF
+#error "HZL_SADTP_MAX_SDU_LEN must fit into 16 bits."
+#endif
+
+/**
+ * @def HZL_SADTP_RX_SLOTS
+ * Amount of SADTP messages a #hzl_SadtpRxPool_t can reassemble at the same time,
+ * each from a distinct sender and Group.
+ *
+ * Default 4, CMake option `HZL_SADTP_RX_SLOTS`. At least 1.
+ */
+#ifndef HZL_SADTP_RX_SLOTS
+#define HZL_SADTP_RX_SLOTS 4U
+#endif
+#if HZL_SADTP_RX_SLOTS < 1
+#error "HZL_SADTP_RX_SLOTS must be at least 1."
+#endif
+
+/**
+ * @def HZL_SADTP_RX_TIMEOUT_MILLIS
+ * Longest silence in milliseconds between two consecutive frames of the same SADTP message.
+ *
+ * After it, the partially received message is dropped and its reassembly slot can be taken by
+ * another message. Default 1000 ms as the N_Cr timeout of ISO-TP, CMake option
+ * `HZL_SADTP_RX_TIMEOUT_MILLIS`.
+ */
+#ifndef HZL_SADTP_RX_TIMEOUT_MILLIS
+#define HZL_SADTP_RX_TIMEOUT_MILLIS 1000U
+#endif
+
 /** Identifier of the struct fields of the public API the user must set manually. */
 #define HZL_SET_BY_USER
 
@@ -133,6 +319,12 @@ extern "C"
 /** Group Identifier reserved for broadcasting, always zero. */
 #define HZL_BROADCAST_GID 0U
 
+/** Amount of distinct Group Identifiers, as a #hzl_Gid_t is 8 bits long. */
+#define HZL_MAX_GIDS 256U
+
+/** Amount of distinct Source Identifiers, as a #hzl_Sid_t is 8 bits long. */
+#define HZL_MAX_SIDS 256U
+
 /** Length of the Long Term Key in bytes. */
 #define HZL_LTK_LEN 16U
 
@@ -143,6 +335,9 @@ extern "C"
  * standard CBS security warning (case: true). False otherwise. */
 #define HZL_IS_SECURITY_WARNING(err) ((err) >= 1 && (err) <= 15)
 
+/** Assumed length of a data cache line in bytes, to which hot data is aligned. */
+#define HZL_CACHE_LINE_LEN 64U
+
 /** Maximum length of the CAN FD frame's payload in bytes. */
 #define HZL_MAX_CAN_FD_DATA_LEN 64U
 
@@ -190,6 +385,7 @@ typedef enum hzl_Err
     /** Received message contained a too-old counter nonce. CBS standard security warning "OLD". */
     HZL_ERR_SECWARN_OLD_MESSAGE = 6U,
     /** The Party is receiving too many suspect messages. CBS standard security warning "DOS".
+     * Server-side only, when #hzl_ServerCtx_t.dosConfig is set.
      * NOTE: the Client library does NOT implement this check. */
     HZL_ERR_SECWARN_DENIAL_OF_SERVICE = 7U,
     /** The Client the Request originated from does not belong into the requested Group.
@@ -343,6 +539,21 @@ typedef enum hzl_Err
     /** The function pointer to the true-random number generating function is NULL.
      * @see #hzl_Io_t.trng */
     HZL_ERR_NULL_TRNG_FUNC = 45U,
+    /** The context contains a NULL pointer to the timer wheel, required by hzl_ServerTick().
+     * @see #hzl_ServerCtx_t.timerWheel */
+    HZL_ERR_NULL_TIMER_WHEEL = 46U,
+    /** The context contains a DoS protection configuration, but a NULL pointer to its state.
+     * @see #hzl_ServerCtx_t.dosState */
+    HZL_ERR_NULL_DOS_STATE = 47U,
+    /** The DoS protection configuration contains a limit with a non-zero rate, but a zero
+     * burst, which would drop every message.
+     * @see #hzl_ServerDosLimit_t.burstMsgs */
+    HZL_ERR_INVALID_DOS_LIMIT = 48U,
+    /** The Party configuration contains an invalid header placement value.
+     * @see #hzl_HeaderPlacement_t
+     * @see #hzl_ClientConfig_t.headerPlacement
+     * @see #hzl_ServerConfig_t.headerPlacement */
+    HZL_ERR_INVALID_HEADER_PLACEMENT = 49U,
 
     // TX and RX function functions
     /** The pointer to the Protocol Data Unit (packed CBS message) to transmit or the just-received
@@ -362,6 +573,12 @@ typedef enum hzl_Err
      * The message cannot be transmitted securely (when the error occurs on TX)
      * or cannot be decrypted and validated (when on RX). */
     HZL_ERR_SESSION_NOT_ESTABLISHED = 64U,
+    /** The context has no pool of reassembly buffers to receive SADTP messages into.
+     * @see hzl_ClientProcessReceived() */
+    HZL_ERR_NULL_SADTP_POOL = 65U,
+    /** The state of the SADTP message being transmitted is NULL.
+     * @see hzl_ClientBuildSecuredTpStart() */
+    HZL_ERR_NULL_SADTP_TX = 66U,
 
     // TX functions
     /** The user-provided data to be transmitted is too long to fit into the specified message
@@ -381,6 +598,14 @@ typedef enum hzl_Err
      * phase is ongoing. The user has to retry after is it completed.
      * @see hzl_ServerForceSessionRenewal() */
     HZL_ERR_RENEWAL_ONGOING = 73U,
+    /** The user-provided output buffer is too short to contain the built message.
+     * @see hzl_ClientBuildSecuredFdInto()
+     * @see hzl_ClientBuildCanFilters() */
+    HZL_ERR_TOO_SHORT_OUTPUT_BUFFER = 74U,
+    /** All frames of the SADTP message have already been built, or its building was never
+     * successfully started. A new one must be started.
+     * @see hzl_ClientBuildSecuredTpNext() */
+    HZL_ERR_SADTP_TX_COMPLETED = 75U,
 
     // RX functions
     /** The received message contains an unknown PTY field. Its data has an unknown structure. */
@@ -409,6 +634,23 @@ typedef enum hzl_Err
     HZL_ERR_MSG_IGNORED = 87U,
     /** The received Request message contained an all-zeros Request Nonce. */
     HZL_ERR_SECWARN_RECEIVED_ZERO_REQNONCE = 88U,
+    /** The received frame of a Secured Application Data over Transport Protocol (SADTP) message
+     * is too short to contain its Protocol Control Information and at least one byte of the
+     * message, or carries an unknown frame type. */
+    HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_SADTP = 89U,
+    /** The received SADTP frame does not continue any message being received from its sender
+     * in its Group, or is out of sequence, or is a First Frame with a ctrnonce not newer than
+     * the one of the unfinished message of its sender. The frame is ignored, the partially
+     * received message, if any, is kept. */
+    HZL_ERR_SADTP_UNEXPECTED_SEGMENT = 90U,
+    /** The received SADTP frame continues a message whose previous frame was received too
+     * long ago. The partially received message is dropped.
+     * @see #HZL_SADTP_RX_TIMEOUT_MILLIS */
+    HZL_ERR_SADTP_TIMEOUT = 91U,
+    /** The received SADTP frame starts a new message, but all reassembly buffers are busy
+     * with other messages, so it's dropped.
+     * @see #HZL_SADTP_RX_SLOTS */
+    HZL_ERR_SADTP_POOL_FULL = 92U,
 
     // Failed IO operation
     /** The timestamping function failed to provide the current time.
@@ -443,6 +685,9 @@ typedef enum hzl_Err
     HZL_ERR_INVALID_FILE_MAGIC_NUMBER = 123U,
     /** Heap-memory allocation failure: out of memory. */
     HZL_ERR_MALLOC_FAILED = 124U,
+    /** The pointer to the array of CAN acceptance filters to build or to their amount is NULL.
+     * @see hzl_ClientBuildCanFilters() */
+    HZL_ERR_NULL_CAN_FILTERS = 125U,
 } hzl_Err_t;
 
 /** Standard CBS header types. */
@@ -458,6 +703,26 @@ typedef enum hzl_HeaderType
 // Values [7, 32] are RFU.
 } hzl_HeaderType_t;
 
+/**
+ * Where the packed CBS header is placed in the CAN FD frame.
+ *
+ * In the CAN ID, the packed header bytes are the least significant bits of the CAN ID, first
+ * byte most significant: the 1-byte header types 3, 4 and 6 fit an 11-bit base CAN ID,
+ * the others require a 29-bit extended CAN ID. The bits above are set to 0 by the library and
+ * ignored on reception: the user may use them, e.g. for a priority prefix.
+ * The header is still authenticated by secured messages, wherever it is placed.
+ */
+typedef enum hzl_HeaderPlacement
+{
+    /** Whole header at the beginning of the payload. Default, the CAN ID is the user's choice. */
+    HZL_HEADER_IN_PAYLOAD = 0U,
+    /** Whole header in the CAN ID, freeing its bytes in the payload for the user data. */
+    HZL_HEADER_IN_CAN_ID = 1U,
+    /** Header in the CAN ID, except the PTY, which is the first byte of the payload.
+     * Each party then uses one CAN ID per Group, for all its messages in it. */
+    HZL_HEADER_MIXED = 2U,
+} hzl_HeaderPlacement_t;
+
 /** Group Identifier data type. */
 typedef uint8_t hzl_Gid_t;
 
@@ -494,6 +759,24 @@ typedef uint32_t hzl_Timestamp_t;
 /** Counter Nonce data type. */
 typedef uint32_t hzl_CtrNonce_t;
 
+/**
+ * State of the Session of a Group, as tracked by each party.
+ *
+ * Stored in a `uint8_t` in the Group states to keep them compact.
+ */
+typedef enum hzl_SessionState
+{
+    /** No STK yet: cleared state, before the handshake (Client) or the initialisation. */
+    HZL_SESSION_STATE_NO_SESSION = 0U,
+    /** Current STK usable, no previous Session lingering. */
+    HZL_SESSION_STATE_ACTIVE = 1U,
+    /** Session renewal phase: both the current and the previous STK are usable. */
+    HZL_SESSION_STATE_RENEWING = 2U,
+    /** The current Session used up its Counter Nonces: a new handshake is required.
+     * Reached only by Clients, as the Server renews its Sessions before. */
+    HZL_SESSION_STATE_EXPIRED = 3U,
+} hzl_SessionState_t;
+
 /** Unpacked CBS Header. */
 typedef struct hzl_Header
 {
@@ -502,15 +785,16 @@ typedef struct hzl_Header
     hzl_Pty_t pty;  ///< Payload TYpe: content of the CBS message
 } hzl_Header_t;
 
-// TODO expose CBS header to allow the user to know which CAN ID to assign
-// TODO expose configuration/functions for packing the CBS header to allow the user to
-// choose where to pack the header (CAN ID, CAN payload or mixed)
 /**
  * Packed CBS PDU (Protocol Data Unit message) ready to be transmitted by the library user.
  */
 typedef struct hzl_CbsPduMsg
 {
     size_t dataLen;  ///< Length in bytes of the CBS-Payload.
+    /** CAN ID carrying the header, to transmit the frame with, unless the header is placed
+     * in the payload: then it's 0 and the CAN ID is the user's choice.
+     * @see #hzl_HeaderPlacement_t */
+    hzl_CanId_t canId;
     uint8_t data[HZL_MAX_CAN_FD_DATA_LEN];  ///< CBS-Payload.
 } hzl_CbsPduMsg_t;
 
@@ -526,6 +810,168 @@ typedef struct hzl_RxMsg
     uint8_t data[HZL_MAX_CAN_FD_DATA_LEN];  ///< User data in plaintext of \p dataLen bytes.
 } hzl_RxSduMsg_t;
 
+/**
+ * Unpacked received SDU (Service Data Unit message) after validation (and optional decryption),
+ * without a copy of the user data.
+ *
+ * Same as #hzl_RxSduMsg_t, but the user data is not copied into the struct: it points into the
+ * buffer of the received PDU, where it was decrypted in place.
+ * @see hzl_ClientProcessReceivedInPlace()
+ */
+typedef struct hzl_RxSduView
+{
+    /** User data in plaintext of \p dataLen bytes, pointing into the received PDU buffer.
+     * Valid as long as that buffer is. NULL when there is no user data. */
+    const uint8_t* data;
+    size_t dataLen;  ///< Length in bytes of the unpacked/decrypted user data.
+    hzl_CanId_t canId;  ///< CAN ID the underlying frame used.
+    hzl_Gid_t gid;  ///< Group IDentifier the message used (expected receivers).
+    hzl_Sid_t sid;  ///< Source IDentifier the message used (claimed sender).
+    bool wasSecured;  ///< True if it was encrypted and authenticated during transmission.
+    bool isForUser;  ///< True if the message contains useful data for the user, false if internal.
+} hzl_RxSduView_t;
+
+/** Received packed CBS PDU with its reception metadata, as input of batch processing. */
+typedef struct hzl_RxPdu
+{
+    const uint8_t* data;  ///< Packed CBS message as received from the underlying layer.
+    size_t dataLen;  ///< Length in bytes of \p data.
+    hzl_CanId_t canId;  ///< CAN ID the underlying frame used.
+    /** Time of reception, from the same clock as #hzl_Io_t.currentTime. */
+    hzl_Timestamp_t rxTimestamp;
+} hzl_RxPdu_t;
+
+/**
+ * @def HZL_AEAD_KEY_SCHEDULE_LEN
+ * Size in bytes of the expanded key stored in a #hzl_AeadKey_t.
+ *
+ * For the AES backends it must fit wolfSSL's key schedule, whose size depends on how wolfSSL
+ * was built (mostly on the GCM table size): the library fails to compile if it does not.
+ * Users of the libraries must use the same value.
+ */
+#ifndef HZL_AEAD_KEY_SCHEDULE_LEN
+#if HZL_AEAD_BACKEND_AES
+#define HZL_AEAD_KEY_SCHEDULE_LEN 1280U
+#else
+#define HZL_AEAD_KEY_SCHEDULE_LEN 16U
+#endif
+#endif
+
+/** Alignment in bytes of the expanded key stored in a #hzl_AeadKey_t. */
+#define HZL_AEAD_KEY_SCHEDULE_ALIGN 16U
+
+/**
+ * Expanded AEAD key of a Short Term Key, in the form the AEAD backend needs it.
+ *
+ * For the AES backends it's the key schedule (plus the GHASH tables for GCM): expanding it is
+ * much more expensive than en/decrypting the few bytes of a CAN FD frame,
+ * so the expansion is computed once per Session and reused for all its secured messages.
+ * The Ascon backends have no key schedule and just keep the raw key.
+ *
+ * The library tracks explicitly when the key changes, clearing or moving the expansion,
+ * so the key is never compared with the expanded one.
+ * Managed fully by the library: the user MUST NOT touch its contents.
+ */
+typedef struct hzl_AeadKey
+{
+    /** Opaque expanded key, valid only if \p isExpanded. */
+    _Alignas(HZL_AEAD_KEY_SCHEDULE_ALIGN)
+    uint64_t schedule[HZL_AEAD_KEY_SCHEDULE_LEN / sizeof(uint64_t)];
+    bool isExpanded;  ///< True if \p schedule holds the expansion of a key.
+} hzl_AeadKey_t;
+
+/** Size in bytes of the hash function state stored in a #hzl_HashMidstate_t. */
+#define HZL_HASH_MIDSTATE_LEN 64U
+
+/**
+ * State of the hash function after absorbing a constant prefix of the authenticated data,
+ * like `key || label`.
+ *
+ * Every tag computed with the same key and label starts from this state instead of
+ * re-absorbing the prefix. Managed fully by the library: the user MUST NOT touch its contents.
+ */
+typedef struct hzl_HashMidstate
+{
+    uint64_t state[HZL_HASH_MIDSTATE_LEN / sizeof(uint64_t)];  ///< Opaque hash state.
+    bool isValid;  ///< True if \p state holds the absorbed prefix.
+} hzl_HashMidstate_t;
+
+#if HZL_SADTP
+/** Size in bytes of the streaming AEAD cipher state stored in the SADTP structs. */
+#define HZL_AEAD_STATE_LEN 96U
+
+/** Length in bytes of the tag authenticating a whole SADTP message. */
+#define HZL_SADTP_TAG_LEN 16U
+
+/**
+ * State of the transmission of one Secured Application Data over Transport Protocol (SADTP)
+ * message, split into frames.
+ *
+ * Prepared by hzl_ClientBuildSecuredTpStart() or hzl_ServerBuildSecuredTpStart(), then advanced
+ * by one frame by every call to hzl_ClientBuildSecuredTpNext() or
+ * hzl_ServerBuildSecuredTpNext(). Managed fully by the library: the user MUST NOT touch its
+ * contents, except for reading \p isDone.
+ */
+typedef struct hzl_SadtpTx
+{
+    /** Opaque AEAD state, encrypting the user data frame by frame. */
+    uint64_t aeadState[HZL_AEAD_STATE_LEN / sizeof(uint64_t)];
+    /** User data being transmitted, owned by the user and encrypted in place. */
+    uint8_t* data;
+    size_t dataLen;  ///< Length of \p data in bytes.
+    size_t encryptedLen;  ///< Leading bytes of \p data already encrypted.
+    size_t sentLen;  ///< Bytes of the message already packed into frames.
+    size_t maxFrameLen;  ///< Longest frame to build in bytes, including the header.
+    hzl_CtrNonce_t ctrNonce;  ///< Counter Nonce the message is secured with.
+    hzl_CanId_t canId;  ///< CAN ID of every frame.
+    uint8_t packedHeader[3];  ///< Part of the header placed in the payload of every frame.
+    uint8_t packedHeaderLen;  ///< Used length of \p packedHeader in bytes.
+    uint8_t nextSeqNr;  ///< Sequence number of the next Consecutive Frame.
+    uint8_t tag[HZL_SADTP_TAG_LEN];  ///< Tag of the message, once all data is encrypted.
+    bool isEncrypted;  ///< True when all \p data is encrypted and \p tag is written.
+    bool isDone;  ///< True when all frames were built or on errors: nothing left to transmit.
+} hzl_SadtpTx_t;
+
+/**
+ * Reassembly buffer of one SADTP message being received, decrypted while its frames arrive.
+ *
+ * Managed fully by the library: the user MUST NOT touch its contents.
+ */
+typedef struct hzl_SadtpRxSlot
+{
+    /** Opaque AEAD state, decrypting the message frame by frame. */
+    uint64_t aeadState[HZL_AEAD_STATE_LEN / sizeof(uint64_t)];
+    size_t receivedLen;  ///< Bytes of the message received so far.
+    size_t writtenLen;  ///< Leading bytes of \p data written so far.
+    hzl_Timestamp_t lastFrameInstant;  ///< Time of reception of the last frame.
+    hzl_CtrNonce_t ctrNonce;  ///< Counter Nonce of the message, once received.
+    uint16_t ptlen;  ///< Length of the user data, once received.
+    hzl_Gid_t gid;  ///< Group of the message.
+    hzl_Sid_t sid;  ///< Sender of the message.
+    uint8_t nextSeqNr;  ///< Sequence number expected in the next Consecutive Frame.
+    bool isBusy;  ///< True while the message is being received.
+    bool isDelivered;  ///< True while \p data holds a delivered message, until the next frame.
+    bool isPreviousSession;  ///< True if secured with the STK of the previous Session.
+    uint8_t tag[HZL_SADTP_TAG_LEN];  ///< Received tag of the message.
+    uint8_t data[HZL_SADTP_MAX_SDU_LEN];  ///< Received user data.
+} hzl_SadtpRxSlot_t;
+
+/**
+ * Reassembly buffers of the SADTP messages being received, at most one per sender and Group.
+ *
+ * Initialised, modified, managed and cleared fully by the library:
+ * the user MUST NOT touch its contents, except for reading the statistics.
+ */
+typedef struct hzl_SadtpRxPool
+{
+    hzl_SadtpRxSlot_t slots[HZL_SADTP_RX_SLOTS];  ///< Reassembly buffers.
+    /** Messages dropped after a silence longer than #HZL_SADTP_RX_TIMEOUT_MILLIS. */
+    uint32_t timeouts;
+    /** Messages dropped as all slots were busy when their first frame arrived. */
+    uint32_t overflows;
+} hzl_SadtpRxPool_t;
+#endif  /* HZL_SADTP */
+
 /**
  * True-random number generator function.
  *
@@ -96,8 +96,13 @@ typedef struct hzl_ClientConfig
      * Must be >= 1.
      */
     HZL_SET_BY_USER uint8_t amountOfGroups;
-    /** Padding to the next struct. */
-    uint8_t unusedPadding[1];
+    /**
+     * Where the CBS header is placed in the CAN FD frames of the network.
+     *
+     * Must be the same as all other nodes, like the #headerType.
+     * Must be one of #hzl_HeaderPlacement_t enum fields.
+     */
+    HZL_SET_BY_USER uint8_t headerPlacement;
 } hzl_ClientConfig_t;
 
 /** Double-checking the size of the hzl_ClientConfig_t struct to avoid
@@ -194,6 +199,11 @@ typedef struct hzl_ClientGroupState
      * about to expire.
      */
     hzl_CtrNonce_t previousCtrNonce;
+    /**
+     * Counter Nonce of the current Session ending the renewal phase:
+     * `2 * maxCtrnonceDelayMsgs` of the Group, precomputed by hzl_ClientInit().
+     */
+    hzl_CtrNonce_t renewalPhaseEndCtrNonce;
     /**
      * Short Term Key of the the currently active Session (STK_G).
      */
@@ -203,19 +213,47 @@ typedef struct hzl_ClientGroupState
      * about to expire.
      */
     uint8_t previousStk[HZL_LTK_LEN];
+    /**
+     * State of the Session, one of #hzl_SessionState_t.
+     *
+     * Tells whether the STKs are usable without inspecting them.
+     */
+    uint8_t sessionState;
     /** Padding to the next struct. */
-    uint8_t unusedPadding[4];
+    uint8_t unusedPadding[7];
+    /**
+     * Cached expansion of currentStk, reused by all secured messages of the current Session.
+     */
+    hzl_AeadKey_t currentAeadKey;
+    /**
+     * Cached expansion of previousStk, reused by all secured messages of the previous Session
+     * during the renewal phase.
+     */
+    hzl_AeadKey_t previousAeadKey;
 } hzl_ClientGroupState_t;
 
-/** Double-checking the size of the hzl_ClientGroupState_t struct to avoid
- * unexpected paddings. */
-_Static_assert(sizeof(hzl_ClientGroupState_t) == 64,
-               "The size of the Client Group state struct must be exactly 64 B");
+/** Double-checking the offsets in the hzl_ClientGroupState_t struct to avoid
+ * unexpected paddings before the cached keys. */
+_Static_assert(offsetof(hzl_ClientGroupState_t, unusedPadding) + 7U == 72,
+               "The Session data of the Client Group state struct must be exactly 72 B");
 
 /**
  * Configuration and status of the HazelNet Client library.
  *
  * Initialised by the user on embedded, loaded from file on an OS.
+ *
+ * ### Thread safety
+ * All the protocol state is in the context. The only other mutable state of the library is
+ * the one of hzl_OsCsprng(), behind the OS `io` functions: a DRBG state per thread, in
+ * thread-local storage, and a process-wide fork counter, incremented in the child by a
+ * handler registered once with `pthread_atfork()`, which makes forked children reseed.
+ * Neither needs locking.
+ * Distinct contexts can be used concurrently from distinct threads without any locking,
+ * as long as they don't share the `groupStates` array and the `io` functions are
+ * thread-safe (the OS ones are). The constant configurations may be shared.
+ *
+ * A single context is NOT thread-safe: all calls using the same context must be serialised
+ * by the user, e.g. by handling each CAN bus with one context in one thread.
  */
 typedef struct hzl_ClientCtx
 {
@@ -250,12 +288,38 @@ typedef struct hzl_ClientCtx
      * of the same group, for every `i`.
      */
     HZL_SET_BY_USER hzl_ClientGroupState_t* groupStates;
+#if HZL_SADTP
+    /**
+     * Pointer to **one** pool of reassembly buffers for the received SADTP messages.
+     * Optional: may be NULL when not receiving SADTP messages. hzl_ClientNew() allocates it.
+     *
+     * Set by the user to point to a memory location, does not have to be initialised. The Client
+     * handles the initialisation on init and clears it at deinit. When NULL, received SADTP
+     * frames are rejected with #HZL_ERR_NULL_SADTP_POOL.
+     */
+    HZL_SET_BY_USER hzl_SadtpRxPool_t* sadtpRxPool;
+#endif
     /**
      * Set of function pointers binding the API to the rest of the system.
      *
      * Including random number generation, timestamp generation and message transmission.
      */
     HZL_SET_BY_USER hzl_Io_t io;
+    /**
+     * Position of each GID in the `groupConfigs` and `groupStates` arrays, plus one.
+     * Zero for the GIDs of the Groups the Client is not part of.
+     *
+     * Filled by hzl_ClientInit() and cleared by hzl_ClientDeInit(), so the Group of any
+     * message is found in constant time, regardless of the amount of Groups. Not to be set
+     * by the user.
+     */
+    uint8_t groupIdxOfGid[HZL_MAX_GIDS];
+    /**
+     * Length in bytes of the single allocation holding this context and all the arrays it
+     * points to, when made by hzl_ClientNew(); released at once by hzl_ClientFree().
+     * Not to be set by the user.
+     */
+    size_t arenaLen;
 } hzl_ClientCtx_t;
 
 /**
@@ -277,6 +341,7 @@ typedef struct hzl_ClientCtx
  * @retval #HZL_ERR_NULL_CTX
  * @retval #HZL_ERR_NULL_CONFIG_CLIENT
  * @retval #HZL_ERR_INVALID_HEADER_TYPE
+ * @retval #HZL_ERR_INVALID_HEADER_PLACEMENT
  * @retval #HZL_ERR_ZERO_GROUPS
  * @retval #HZL_ERR_TOO_MANY_GROUPS_FOR_CONFIGURED_HEADER_TYPE
  * @retval #HZL_ERR_LTK_IS_ALL_ZEROS
@@ -421,6 +486,106 @@ hzl_ClientBuildSecuredFd(hzl_CbsPduMsg_t* securedPdu,
                          size_t userDataLen,
                          hzl_Gid_t groupId);
 
+/**
+ * Same as hzl_ClientBuildSecuredFd(), but writes the packed message directly into a buffer
+ * owned by the caller, e.g. the payload of the CAN FD frame to transmit, without an
+ * intermediate #hzl_CbsPduMsg_t.
+ *
+ * @warning \p securedPdu must not overlap with \p userData: the plaintext is encrypted
+ * directly into \p securedPdu. Copy it elsewhere first if they share the same frame buffer.
+ *
+ * @param [out] securedPdu buffer to write the CBS message into in packed format, ready to
+ *        transmit. Not NULL.
+ * @param [in] securedPduCapacity length of \p securedPdu in bytes. Must be at least the length
+ *        of the packed header and SADFD payload for \p userDataLen bytes of user data.
+ * @param [out] securedPduLen length in bytes of the message written into \p securedPdu.
+ *        Zero on errors. Not NULL.
+ * @param [out] securedPduCanId CAN ID to transmit the message with, carrying the header
+ *        when it's not placed in the payload, otherwise 0. May be NULL only then.
+ * @param [in, out] ctx as in hzl_ClientBuildSecuredFd().
+ * @param [in] userData as in hzl_ClientBuildSecuredFd().
+ * @param [in] userDataLen as in hzl_ClientBuildSecuredFd().
+ * @param [in] groupId as in hzl_ClientBuildSecuredFd().
+ *
+ * @retval Same values as hzl_ClientBuildSecuredFd().
+ * @retval #HZL_ERR_NULL_PDU also if \p securedPduLen is NULL or \p securedPduCanId is NULL
+ *         with the header not placed in the payload.
+ * @retval #HZL_ERR_TOO_SHORT_OUTPUT_BUFFER if \p securedPduCapacity is too small to contain
+ *         the message.
+ */
+HZL_API hzl_Err_t
+hzl_ClientBuildSecuredFdInto(uint8_t* securedPdu,
+                             size_t securedPduCapacity,
+                             size_t* securedPduLen,
+                             hzl_CanId_t* securedPduCanId,
+                             hzl_ClientCtx_t* ctx,
+                             const uint8_t* userData,
+                             size_t userDataLen,
+                             hzl_Gid_t groupId);
+
+#if HZL_SADTP
+/**
+ * Starts building a secured message longer than a CAN FD frame, encrypted, authenticated and
+ * timely, only for the given group to be able to read: a Secured Application Data over
+ * Transport Protocol (SADTP) message, split into frames as short as classic CAN ones.
+ *
+ * Takes the Counter Nonce of the message. The frames are then built one by one with
+ * hzl_ClientBuildSecuredTpNext(), each carrying the CBS header, a Protocol Control Information
+ * byte like ISO-TP (First Frame, then Consecutive Frames with a 4-bit sequence number) and
+ * the next segment of the message. There is no Flow Control, as the message is broadcast to
+ * the Group: the user transmits the frames at the pace the receivers can handle.
+ *
+ * The user data is encrypted in place, in \p userData, while the frames are built, so the
+ * message is never buffered twice.
+ *
+ * @warning \p userData must stay allocated and untouched until the last frame is built.
+ * Afterwards it contains the ciphertext, not the plaintext anymore.
+ * If the transmission is abandoned earlier, securely zero out \p tx.
+ *
+ * @param [out] tx state of the transmission, to pass to hzl_ClientBuildSecuredTpNext().
+ *        Not NULL.
+ *        In case of errors, its #hzl_SadtpTx_t.isDone is true.
+ * @param [in, out] ctx to access configurations and update the group states. Not NULL.
+ * @param [in, out] userData plaintext data (SDU) to transmit encrypted and authenticated.
+ *        Can be NULL only if \p userDataLen is zero.
+ * @param [in] userDataLen length of \p userData in bytes, at most #HZL_SADTP_MAX_SDU_LEN.
+ * @param [in] groupId destination group identifier (the Parties that can decrypt).
+ * @param [in] maxFrameLen length in bytes of the frames to build, except the shorter last one:
+ *        e.g. 8 for classic CAN or 64 for CAN FD. At least the header length in the payload
+ *        plus 2, values above 64 are handled as 64.
+ *
+ * @retval Same values as hzl_ClientBuildSecuredFd().
+ * @retval #HZL_ERR_NULL_SADTP_TX if \p tx is NULL.
+ * @retval #HZL_ERR_TOO_LONG_SDU if \p userDataLen is above #HZL_SADTP_MAX_SDU_LEN.
+ * @retval #HZL_ERR_TOO_SHORT_OUTPUT_BUFFER if \p maxFrameLen cannot contain the header,
+ *         the Protocol Control Information and at least one byte of the message.
+ */
+HZL_API hzl_Err_t
+hzl_ClientBuildSecuredTpStart(hzl_SadtpTx_t* tx,
+                              hzl_ClientCtx_t* ctx,
+                              uint8_t* userData,
+                              size_t userDataLen,
+                              hzl_Gid_t groupId,
+                              size_t maxFrameLen);
+
+/**
+ * Builds the next frame of the SADTP message started with hzl_ClientBuildSecuredTpStart().
+ *
+ * To be called until #hzl_SadtpTx_t.isDone is true, transmitting every frame in order.
+ *
+ * @param [out] securedPdu frame in packed format, ready to transmit. Not NULL.
+ * @param [in, out] tx state of the transmission. Not NULL.
+ *
+ * @retval #HZL_OK on successful building of the frame.
+ * @retval #HZL_ERR_NULL_PDU if \p securedPdu is NULL.
+ * @retval #HZL_ERR_NULL_SADTP_TX if \p tx is NULL.
+ * @retval #HZL_ERR_SADTP_TX_COMPLETED if all frames were already built.
+ */
+HZL_API hzl_Err_t
+hzl_ClientBuildSecuredTpNext(hzl_CbsPduMsg_t* securedPdu,
+                             hzl_SadtpTx_t* tx);
+#endif
+
 /**
  * Validates, unpacks and decrypts (if necessary) any received message, preparing an automatic
  * response when required.
@@ -443,7 +608,8 @@ hzl_ClientBuildSecuredFd(hzl_CbsPduMsg_t* securedPdu,
  * @param [in] receivedPdu packed CBS message as received from the underlying layer. Not NULL.
  * @param [in] receivedPduLen length of \p receivedPdu in bytes.
  * @param [in] receivedCanId identifier of the underlying layer's PDU, passed as-is
- *        to \p receivedUserData.
+ *        to \p receivedUserData. The header is unpacked from it, unless it's placed in the
+ *        payload.
  *
  * @retval #HZL_OK on success.
  * @retval #HZL_ERR_MSG_IGNORED when the message has another destination.
@@ -471,6 +637,19 @@ hzl_ClientBuildSecuredFd(hzl_CbsPduMsg_t* securedPdu,
  *         replay attack
  * @retval #HZL_ERR_SECWARN_INVALID_TAG when the message integrity and authenticity
  *         cannot be guaranteed
+ * @retval #HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_SADTP when a SADTP frame is too short to
+ *         contain a segment of the message or has an unknown frame type.
+ *         Without #HZL_SADTP, SADTP frames are rejected with #HZL_ERR_INVALID_PAYLOAD_TYPE.
+ * @retval #HZL_ERR_NULL_SADTP_POOL when a SADTP frame is received by a context without
+ *         a #hzl_SadtpRxPool_t.
+ * @retval #HZL_ERR_SADTP_UNEXPECTED_SEGMENT, #HZL_ERR_SADTP_TIMEOUT,
+ *         #HZL_ERR_SADTP_POOL_FULL when a SADTP frame cannot be reassembled into a message.
+ *         All frames but the last of a SADTP message return #HZL_OK with
+ *         #hzl_RxSduMsg_t.isForUser false; the last one delivers the whole user data.
+ * @retval #HZL_ERR_TOO_SHORT_OUTPUT_BUFFER when a SADTP message is too long to be
+ *         copied into #hzl_RxSduMsg_t.data: use the in-place processing to receive it.
+ *         The message is refused with the frame carrying its length, before its Counter Nonce
+ *         is accepted, so the sender may still transmit it again.
  */
 HZL_API hzl_Err_t
 hzl_ClientProcessReceived(hzl_CbsPduMsg_t* reactionPdu,
@@ -480,6 +659,75 @@ hzl_ClientProcessReceived(hzl_CbsPduMsg_t* reactionPdu,
                           size_t receivedPduLen,
                           hzl_CanId_t receivedCanId);
 
+/**
+ * Same as hzl_ClientProcessReceived(), but with a reception timestamp provided by the caller
+ * instead of reading #hzl_Io_t.currentTime.
+ *
+ * Useful when the underlying layer provides the actual arrival time of the frame (e.g. the
+ * `SO_TIMESTAMP` of a SocketCAN socket): the freshness checks then measure the time since the
+ * frame arrived rather than since it was dequeued. It also allows a whole burst of received
+ * frames to share one clock reading.
+ *
+ * @warning \p rxTimestamp must come from the same clock as #hzl_Io_t.currentTime, which is
+ * used for all other timestamps in the context. Convert it if needed, e.g. by subtracting the
+ * age of the frame from the current time of #hzl_Io_t.currentTime.
+ *
+ * @param [out] reactionPdu as in hzl_ClientProcessReceived().
+ * @param [out] receivedUserData as in hzl_ClientProcessReceived().
+ * @param [in, out] ctx as in hzl_ClientProcessReceived().
+ * @param [in] receivedPdu as in hzl_ClientProcessReceived().
+ * @param [in] receivedPduLen as in hzl_ClientProcessReceived().
+ * @param [in] receivedCanId as in hzl_ClientProcessReceived().
+ * @param [in] rxTimestamp time of reception of \p receivedPdu.
+ *
+ * @retval Same values as hzl_ClientProcessReceived().
+ */
+HZL_API hzl_Err_t
+hzl_ClientProcessReceivedAt(hzl_CbsPduMsg_t* reactionPdu,
+                            hzl_RxSduMsg_t* receivedUserData,
+                            hzl_ClientCtx_t* ctx,
+                            const uint8_t* receivedPdu,
+                            size_t receivedPduLen,
+                            hzl_CanId_t receivedCanId,
+                            hzl_Timestamp_t rxTimestamp);
+
+/**
+ * Same as hzl_ClientProcessReceivedAt(), but decrypts the user data in place, inside
+ * \p receivedPdu, instead of copying it into a #hzl_RxSduMsg_t.
+ *
+ * Meant for the hot reception path: the received frame buffer is the only copy of the
+ * user data, and only the small \p receivedUserData view and the length of \p reactionPdu
+ * are cleared, instead of both whole structs.
+ *
+ * @warning The ciphertext in \p receivedPdu is overwritten with the plaintext, or with zeros
+ * if the message is not authentic. \p receivedUserData points into \p receivedPdu, so it
+ * is valid only until that buffer is reused. Clear the buffer after use if the plaintext
+ * is security-critical.
+ * The user data of a SADTP message, of any length, is instead in the
+ * #hzl_ClientCtx_t.sadtpRxPool, valid and not cleared until the next SADTP frame is processed.
+ *
+ * @param [out] reactionPdu as in hzl_ClientProcessReceived(). Only its length is cleared
+ *        before anything else is attempted, not its data.
+ * @param [out] receivedUserData metadata of the user data extracted out of \p receivedPdu,
+ *        pointing into it. Cleared before anything else is attempted. Not NULL.
+ * @param [in, out] ctx as in hzl_ClientProcessReceived().
+ * @param [in, out] receivedPdu as in hzl_ClientProcessReceived(), but writable, as the
+ *        user data is decrypted into it.
+ * @param [in] receivedPduLen as in hzl_ClientProcessReceived().
+ * @param [in] receivedCanId as in hzl_ClientProcessReceived().
+ * @param [in] rxTimestamp as in hzl_ClientProcessReceivedAt().
+ *
+ * @retval Same values as hzl_ClientProcessReceived().
+ */
+HZL_API hzl_Err_t
+hzl_ClientProcessReceivedInPlace(hzl_CbsPduMsg_t* reactionPdu,
+                                 hzl_RxSduView_t* receivedUserData,
+                                 hzl_ClientCtx_t* ctx,
+                                 uint8_t* receivedPdu,
+                                 size_t receivedPduLen,
+                                 hzl_CanId_t receivedCanId,
+                                 hzl_Timestamp_t rxTimestamp);
+
 #ifdef __cplusplus
 }
 #endif
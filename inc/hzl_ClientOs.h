@@ -51,6 +51,10 @@ extern "C"
 #include "hzl.h"
 #include "hzl_Client.h"
 
+#if HZL_OS_AVAILABLE_LINUX
+#include <linux/can.h>  /* For struct can_filter of SocketCAN */
+#endif
+
 #if HZL_OS_AVAILABLE
 
 /**
@@ -63,17 +67,36 @@ extern "C"
  * OS. The user must only supply the low level transmission function and the file name where to
  * take the configuration from.
  *
+ * The random bytes come from a per-thread CSPRNG seeded by the OS (`getrandom()`,
+ * `/dev/urandom` or `BCryptGenRandom()`) and reseeded periodically, so that the OS is not
+ * queried for every nonce or key.
+ *
+ * The file is read at once and each configuration struct is validated as soon as it's decoded,
+ * with the same checks as hzl_ClientInit(): on an invalid file no context is returned.
+ * The context and all the arrays it points to are a single allocation, aligned to
+ * #HZL_CACHE_LINE_LEN, with each array starting on its own cache line in access order.
  * It's up to the user to free the context allocated by this function using hzl_ClientFree().
  *
  * ### File format
  * The file must have the following format with all multi-byte integers encoded as
- * little Endian and without any paddings between any value or between any struct:
- *
- * 1. "HZL\0" as a magic number in ASCII encoding, used to double-check that the loaded file
- *    is the correct one. That is: [0x48, 0x5A, 0x4C, 0x00] in binary;
- * 2. the whole #hzl_ClientConfig_t struct without any padding;
- * 3. an array of #hzl_ClientGroupConfig_t structs without any padding and with as many
- *    elements (structs) as specified in #hzl_ClientConfig_t.amountOfGroups.
+ * little Endian and without any implicit padding: the only padding bytes are the ones listed:
+ *
+ * 1. "HZLc\0" as a magic number in ASCII encoding, used to double-check that the loaded file
+ *    is the correct one. That is: [0x48, 0x5A, 0x4C, 0x63, 0x00] in binary;
+ * 2. the #hzl_ClientConfig_t in 22 bytes:
+ *    `timeoutReqToResMillis` (uint16), `ltk` (16 bytes), `sid` (uint8),
+ *    header byte (uint8, see below), `amountOfGroups` (uint8), 1 padding byte, ignored;
+ * 3. an array of #hzl_ClientGroupConfig_t in 12 bytes each, with as many elements as
+ *    specified in #hzl_ClientConfig_t.amountOfGroups:
+ *    `maxCtrnonceDelayMsgs` (uint32), `maxSilenceIntervalMillis` (uint16),
+ *    `sessionRenewalDurationMillis` (uint16), `gid` (uint8), 3 padding bytes, ignored.
+ *
+ * The header byte holds the #hzl_HeaderType_t in its 6 least significant bits, values 0 to 6,
+ * and the #hzl_HeaderPlacement_t in its 2 most significant bits: 0 in the payload, 1 in the
+ * CAN ID, 2 mixed. Header types 7 to 63 and placement 3 are reserved and rejected with
+ * #HZL_ERR_INVALID_HEADER_TYPE and #HZL_ERR_INVALID_HEADER_PLACEMENT, as are the header
+ * types other than #HZL_FIXED_HEADER_TYPE unless it's #HZL_FIXED_HEADER_TYPE_ANY.
+ * For example, 0x00 is header type 0 in the payload and 0x44 is header type 4 in the CAN ID.
  *
  * It's common to use the `.hzl` file extension to denote this file format.
  * To generate such binary file from a JSON file, the helper Python scripts in
@@ -100,7 +123,8 @@ hzl_ClientNew(hzl_ClientCtx_t** pCtx,
  * Zeros-out the context, frees it and sets the pointer to it to NULL, to avoid use-after-free
  * and double-free.
  *
- * If some fields are partially-initialised, it clears and frees anything not-NULL.
+ * The context and the arrays allocated with it are cleared and freed at once. Arrays the user
+ * replaced after hzl_ClientNew() are not touched.
  *
  * @warning
  * Only use on heap-allocated contexts, as created by hzl_ClientNew().
@@ -131,7 +155,8 @@ hzl_ClientNewMsg(hzl_CbsPduMsg_t** pMsg);
  * Zeros-out the message, frees it and sets the pointer to it to NULL, to avoid use-after-free
  * and double-free.
  *
- * If some fields are partially-initialised, it clears and frees anything not-NULL.
+ * The context and the arrays allocated with it are cleared and freed at once. Arrays the user
+ * replaced after hzl_ClientNew() are not touched.
  *
  * @warning
  * Only use on heap-allocated messages, as created by hzl_ClientNewMsg().
@@ -145,6 +170,43 @@ hzl_ClientFreeMsg(hzl_CbsPduMsg_t** pMsg);
 
 #endif  /* HZL_OS_AVAILABLE */
 
+#if HZL_OS_AVAILABLE_LINUX
+
+/**
+ * Builds the SocketCAN acceptance filters letting through only the frames of the Client's Groups.
+ *
+ * Set them on the `CAN_RAW` socket with
+ * `setsockopt(s, SOL_CAN_RAW, CAN_RAW_FILTER, filters, amount * sizeof(struct can_filter))`:
+ * the kernel then drops the frames of other Groups before they reach userspace, instead of
+ * hzl_ClientProcessReceived() returning #HZL_ERR_MSG_IGNORED for each of them.
+ *
+ * Only the header placed in the CAN ID (#HZL_HEADER_IN_CAN_ID or #HZL_HEADER_MIXED) can be
+ * filtered: one filter per configured Group is built, matching the GID bits of the CAN ID,
+ * extended CAN IDs for headers longer than 1 byte and no remote frames.
+ * A single filter is built instead with a header type without GID bits, matching any GID,
+ * and with the header in the payload, letting through any frame.
+ * If the socket must receive also other, non-CBS frames, the user must append their filters.
+ *
+ * @param [out] filters where to write the filters. Must not be NULL.
+ * @param [out] amountOfFilters amount of filters written into \p filters: 1 or
+ *        #hzl_ClientConfig_t.amountOfGroups. 0 on error. Must not be NULL.
+ * @param [in] filtersCapacity length of \p filters in elements
+ * @param [in] ctx initialised Client context
+ *
+ * @retval #HZL_OK on success.
+ * @retval #HZL_ERR_NULL_CAN_FILTERS if \p filters or \p amountOfFilters is NULL.
+ * @retval #HZL_ERR_TOO_SHORT_OUTPUT_BUFFER if \p filtersCapacity is shorter than the
+ *         amount of filters to build.
+ * @retval Same values as hzl_ClientInit() in case the context has NULL pointers.
+ */
+HZL_API hzl_Err_t
+hzl_ClientBuildCanFilters(struct can_filter* filters,
+                          size_t* amountOfFilters,
+                          size_t filtersCapacity,
+                          const hzl_ClientCtx_t* ctx);
+
+#endif  /* HZL_OS_AVAILABLE_LINUX */
+
 #ifdef __cplusplus
 }
 #endif
@@ -52,22 +52,36 @@ extern "C"
 #include "hzl.h"
 
 /**
+ * @def HZL_SERVER_MAX_AMOUNT_OF_CLIENTS
  * Maximum amount of Clients overall this Server supports.
  *
  * At Context initialisation the amount of Clients in #hzl_ServerConfig_t
  * may be any value <= this limit.
  *
  * The per-Group configuration #hzl_ServerGroupConfig_t contains a
- * static-sized bitmap of Clients in it which is limited to 32 bits to spare
- * memory. One bit is reserved for the Server.
+ * static-sized bitmap of Clients in it, made of as many 32-bit words as needed to hold
+ * this amount of bits, so a larger limit costs memory in every Group configuration.
+ * Defaults to 32 (one word); may be set at build time to any value in [1, 255]
+ * (CMake option `HZL_SERVER_MAX_AMOUNT_OF_CLIENTS`), which are all the SIDs a
+ * #HZL_HEADER_0 can address. The library and its users must be compiled with the same value.
  */
+#ifndef HZL_SERVER_MAX_AMOUNT_OF_CLIENTS
 #define HZL_SERVER_MAX_AMOUNT_OF_CLIENTS 32U
+#endif
+
+/** Integer data type of each word of the bitmap of Clients. */
+typedef uint32_t hzl_ServerBitMapWord_t;
+
+/** Amount of bits in a #hzl_ServerBitMapWord_t. */
+#define HZL_SERVER_BITMAP_WORD_BITS 32U
 
 /**
- * Integer data type used for the bitmap of Clients that must support
+ * Amount of #hzl_ServerBitMapWord_t words in the bitmap of Clients, holding at least
  * #HZL_SERVER_MAX_AMOUNT_OF_CLIENTS bits.
  */
-typedef uint32_t hzl_ServerBitMap_t;
+#define HZL_SERVER_BITMAP_WORDS \
+    ((HZL_SERVER_MAX_AMOUNT_OF_CLIENTS + HZL_SERVER_BITMAP_WORD_BITS - 1U) \
+     / HZL_SERVER_BITMAP_WORD_BITS)
 
 /**
  * Largest Max-Counter-Nonce value allowed in the Server configuration.
@@ -112,12 +126,19 @@ typedef struct hzl_ServerConfig
      * Must be one of #hzl_HeaderType_t enum fields.
      */
     HZL_SET_BY_USER uint8_t headerType;
+    /**
+     * Where the CBS header is placed in the CAN FD frames of the network.
+     *
+     * Must be the same as all other nodes, like the #headerType.
+     * Must be one of #hzl_HeaderPlacement_t enum fields.
+     */
+    HZL_SET_BY_USER uint8_t headerPlacement;
 } hzl_ServerConfig_t;
 
 /** Double-checking the size of the hzl_ServerConfig_t struct to avoid
  * unexpected paddings. */
-_Static_assert(sizeof(hzl_ServerConfig_t) == 3,
-               "The size of the Server Config struct must be exactly 3 B");
+_Static_assert(sizeof(hzl_ServerConfig_t) == 4,
+               "The size of the Server Config struct must be exactly 4 B");
 
 /**
  * Hazelnet Server constant per-Client configuration.
@@ -200,7 +221,10 @@ typedef struct hzl_ServerGroupConfig
      *
      * If the bit is set (1), it's index is the SID of the included Client.
      * The first bit (index 0, least significant) indicates the Client with SID == 1;
-     * the i-th bit (representing 2^i) indicates the Client with SID i.
+     * the i-th bit (representing 2^i) indicates the Client with SID i+1.
+     * Bit i is in the word `i / #HZL_SERVER_BITMAP_WORD_BITS` at the position
+     * `i % #HZL_SERVER_BITMAP_WORD_BITS`, so the first word covers SIDs [1, 32],
+     * the second one SIDs [33, 64] etc.
      *
      * Constraints:
      * - Each Group must contain at least one Client, thus have at least one bit set.
@@ -212,7 +236,7 @@ typedef struct hzl_ServerGroupConfig
      *   of the broadcast bitmap always.
      * - Each Client may appear in more than one Group.
      */
-    HZL_SET_BY_USER hzl_ServerBitMap_t clientSidsInGroupBitmap;
+    HZL_SET_BY_USER hzl_ServerBitMapWord_t clientSidsInGroupBitmap[HZL_SERVER_BITMAP_WORDS];
     /**
      * Maximum Silence Interval (S^{max}_G) in milliseconds,
      * used to filter out recent messages from old ones.
@@ -240,18 +264,86 @@ typedef struct hzl_ServerGroupConfig
 
 /** Double-checking the size of the hzl_ServerGroupConfig_t struct to avoid
  *  unexpected paddings. */
-_Static_assert(sizeof(hzl_ServerGroupConfig_t) == 24,
-               "The size of the Server Group Config struct must be exactly 24 B");
+_Static_assert(sizeof(hzl_ServerGroupConfig_t)
+               == 20 + HZL_SERVER_BITMAP_WORDS * sizeof(hzl_ServerBitMapWord_t),
+               "The size of the Server Group Config struct must be exactly 24 B "
+               "plus 4 B per additional bitmap word");
+
+/**
+ * @def HZL_SERVER_SPLIT_GROUP_STATE
+ * Selects the layout of the Server Group states at build time.
+ *
+ * When 0 (default), every variable field of a Group is in its #hzl_ServerGroupState_t.
+ *
+ * When 1 (CMake option `HZL_SERVER_SPLIT_GROUP_STATE`), the fields read and written on every
+ * received secured message (Counter Nonces, timestamps, Session state) and copies of the
+ * configuration values they are checked against are moved to a #hzl_ServerGroupHotState_t per
+ * Group, each exactly one cache line long, in a dense array inside the context. The
+ * #hzl_ServerGroupState_t keeps only the key material. Processing a message thus touches a single
+ * cache line of state and configuration, at the price of a context #HZL_MAX_GIDS cache lines
+ * larger. Meant for Servers with many Groups on CPUs with data caches.
+ *
+ * The library and its users must be compiled with the same value.
+ */
+#ifndef HZL_SERVER_SPLIT_GROUP_STATE
+#define HZL_SERVER_SPLIT_GROUP_STATE 0
+#endif
+
+#if HZL_SERVER_SPLIT_GROUP_STATE
+
+/**
+ * Hazelnet Server variable State of a Group accessed on every received secured message.
+ *
+ * Available only with #HZL_SERVER_SPLIT_GROUP_STATE. One cache line per Group.
+ * Initialised, modified, managed and cleared fully by the Server:
+ * the user MUST NOT touch its contents.
+ */
+typedef struct hzl_ServerGroupHotState
+{
+    /** Same as in #hzl_ServerGroupState_t when not split. */
+    _Alignas(HZL_CACHE_LINE_LEN) hzl_Timestamp_t sessionStartInstant;
+    /** Same as in #hzl_ServerGroupState_t when not split. */
+    hzl_Timestamp_t currentRxLastMessageInstant;
+    /** Same as in #hzl_ServerGroupState_t when not split. */
+    hzl_Timestamp_t previousRxLastMessageInstant;
+    /** Same as in #hzl_ServerGroupState_t when not split. */
+    hzl_CtrNonce_t currentCtrNonce;
+    /** Same as in #hzl_ServerGroupState_t when not split. */
+    hzl_CtrNonce_t previousCtrNonce;
+    /** Copy of #hzl_ServerGroupConfig_t.maxCtrnonceDelayMsgs, made at initialisation. */
+    uint32_t maxCtrnonceDelayMsgs;
+    /** Copy of #hzl_ServerGroupConfig_t.ctrNonceUpperLimit, made at initialisation. */
+    uint32_t ctrNonceUpperLimit;
+    /** Copy of #hzl_ServerGroupConfig_t.sessionDurationMillis, made at initialisation. */
+    uint32_t sessionDurationMillis;
+    /** Copy of #hzl_ServerGroupConfig_t.maxSilenceIntervalMillis, made at initialisation. */
+    uint16_t maxSilenceIntervalMillis;
+    /** Same as in #hzl_ServerGroupState_t when not split. */
+    hzl_CtrNonce_t renewalPhaseEndCtrNonce;
+    /** Same as in #hzl_ServerGroupState_t when not split. */
+    uint32_t renewalPhaseEndMillis;
+    /** Same as in #hzl_ServerGroupState_t when not split. */
+    uint8_t sessionState;
+} hzl_ServerGroupHotState_t;
+
+/** Double-checking the hot state of a Group fills exactly one cache line. */
+_Static_assert(sizeof(hzl_ServerGroupHotState_t) == HZL_CACHE_LINE_LEN,
+               "The Server Group Hot State struct must be exactly one cache line");
+
+#endif  /* HZL_SERVER_SPLIT_GROUP_STATE */
 
 /**
  * Hazelnet Server variable State.
  *
  * Single instance per Group, multiple instances per Server.
+ * With #HZL_SERVER_SPLIT_GROUP_STATE it holds only the key material, the rest being in
+ * #hzl_ServerGroupHotState_t.
  * Initialised, modified, managed and cleared fully by the Server:
  * the user MUST NOT touch its contents.
  */
 typedef struct hzl_ServerGroupState
 {
+#if !HZL_SERVER_SPLIT_GROUP_STATE
     /**
      * Timestamp of when the Session was started.
      *
@@ -282,6 +374,25 @@ typedef struct hzl_ServerGroupState
      * about to expire.
      */
     hzl_CtrNonce_t previousCtrNonce;
+    /**
+     * Counter Nonce of the current Session ending the renewal phase:
+     * `2 * maxCtrnonceDelayMsgs` of the Group, precomputed by hzl_ServerInit().
+     */
+    hzl_CtrNonce_t renewalPhaseEndCtrNonce;
+    /**
+     * Milliseconds since the start of the current Session ending the renewal phase:
+     * `6 * delayBetweenRenNotificationsMillis` of the Group, precomputed by hzl_ServerInit().
+     */
+    uint32_t renewalPhaseEndMillis;
+    /**
+     * State of the Session, one of #hzl_SessionState_t.
+     *
+     * Tells whether a renewal phase is ongoing without inspecting the previous STK.
+     */
+    uint8_t sessionState;
+    /** Padding to the next field. */
+    uint8_t unusedPadding[3];
+#endif  /* !HZL_SERVER_SPLIT_GROUP_STATE */
     /**
      * Short Term Key of the currently active Session (STK_G).
      */
@@ -291,17 +402,239 @@ typedef struct hzl_ServerGroupState
      * about to expire.
      */
     uint8_t previousStk[HZL_LTK_LEN];
+    /**
+     * Cached expansion of currentStk, reused by all secured messages of the current Session.
+     */
+    hzl_AeadKey_t currentAeadKey;
+    /**
+     * Cached expansion of previousStk, reused by all secured messages of the previous Session
+     * during the renewal phase.
+     */
+    hzl_AeadKey_t previousAeadKey;
+    /**
+     * Hash function state after absorbing `previousStk || label` of the REN messages,
+     * computed when the renewal phase starts and reused by all its REN messages.
+     */
+    hzl_HashMidstate_t renHashMidstate;
+    /**
+     * Short Term Key of the next Session, valid only if `nextAeadKey.isExpanded`.
+     *
+     * Generated ahead of time by hzl_ServerInit() and hzl_ServerTick(), so starting a
+     * Session just copies it into currentStk, without calling the TRNG.
+     */
+    uint8_t nextStk[HZL_STK_LEN];
+    /**
+     * Expansion of nextStk, moved into currentAeadKey when the next Session starts.
+     */
+    hzl_AeadKey_t nextAeadKey;
 } hzl_ServerGroupState_t;
 
-/** Double-checking the size of the hzl_ServerGroupState_t struct to avoid
- *  unexpected paddings. */
-_Static_assert(sizeof(hzl_ServerGroupState_t) == 52,
-               "The size of the Server Group State struct must be exactly 52 B");
+/** Double-checking the offsets in the hzl_ServerGroupState_t struct to avoid
+ *  unexpected paddings before the cached keys. */
+#if HZL_SERVER_SPLIT_GROUP_STATE
+_Static_assert(offsetof(hzl_ServerGroupState_t, previousStk) + HZL_STK_LEN == 32,
+               "The Session keys of the Server Group State struct must be exactly 32 B");
+#else
+_Static_assert(offsetof(hzl_ServerGroupState_t, previousStk) + HZL_STK_LEN == 64,
+               "The Session data of the Server Group State struct must be exactly 64 B");
+#endif
+
+/**
+ * Variable state of each Client, as known by the Server.
+ *
+ * Holds only precomputed data derived from the Client's constant configuration,
+ * to speed up the processing of its messages.
+ */
+typedef struct hzl_ServerClientState
+{
+    /**
+     * Hash function state after absorbing `LTK || label` of the REQ messages of this Client,
+     * computed at initialisation and reused for all its Requests.
+     */
+    hzl_HashMidstate_t reqHashMidstate;
+    /**
+     * Expansion of the LTK of this Client, computed at initialisation and reused to
+     * encrypt all Responses to it.
+     */
+    hzl_AeadKey_t ltkAeadKey;
+} hzl_ServerClientState_t;
+
+/** Amount of levels of the Server timer wheel, each 256 times coarser than the previous one.
+ * With 4 levels the wheel spans the whole #hzl_Timestamp_t range. */
+#define HZL_SERVER_TIMER_WHEEL_LEVELS 4U
+/** Amount of slots in each level of the Server timer wheel. */
+#define HZL_SERVER_TIMER_WHEEL_SLOTS 256U
+
+/**
+ * Hierarchical timer wheel scheduling the time-driven events of each Group:
+ * Session expiration, REN messages during the renewal phase, end of the renewal phase.
+ *
+ * The slots of level `l` are `256^l` ms wide. Each Group with a pending event is in exactly one
+ * slot list, as GID + 1 (0 terminates a list). Events are moved to a finer level at most
+ * 3 times before being due, so hzl_ServerTick() costs O(due events) instead of O(Groups).
+ *
+ * Initialised, modified, managed and cleared fully by the Server:
+ * the user MUST NOT touch its contents.
+ */
+typedef struct hzl_ServerTimerWheel
+{
+    /** First instant whose level-0 slot was not processed yet by hzl_ServerTick(). */
+    hzl_Timestamp_t nextTickInstant;
+    /** Instant of the pending event of each Group, indexed by GID. */
+    hzl_Timestamp_t deadlines[HZL_MAX_GIDS];
+    /** Slot holding each Group, as `level * 256 + slot`, or 0xFFFF if none. */
+    uint16_t slotOfGid[HZL_MAX_GIDS];
+    /** First Group of each slot list, as GID + 1. */
+    uint8_t slotHeads[HZL_SERVER_TIMER_WHEEL_LEVELS][HZL_SERVER_TIMER_WHEEL_SLOTS];
+    /** Next Group in the same slot list, as GID + 1, indexed by GID. */
+    uint8_t nextInSlot[HZL_MAX_GIDS];
+    /** Previous Group in the same slot list, as GID + 1, indexed by GID. */
+    uint8_t previousInSlot[HZL_MAX_GIDS];
+    /** Groups that started a Session with their next STK and need a new one, bit `i` for
+     * GID `i`. Generated by the next hzl_ServerTick(). */
+    uint32_t nextStkToGenerateBitmap[HZL_MAX_GIDS / 32U];
+} hzl_ServerTimerWheel_t;
+
+/**
+ * Token bucket limit of the messages requiring cryptographic operations: REQ, SADFD, SADTP.
+ *
+ * The bucket holds up to \p burstMsgs messages and refills at \p msgsPerSecond.
+ * A zero \p msgsPerSecond disables the limit.
+ */
+typedef struct hzl_ServerDosLimit
+{
+    /** Sustained rate of messages, refilled every millisecond. 0 = unlimited. */
+    uint16_t msgsPerSecond;
+    /** Messages accepted in a burst after being idle. Not 0 if the limit is enabled. */
+    uint16_t burstMsgs;
+} hzl_ServerDosLimit_t;
+
+/**
+ * Denial-of-Service protection of the Server.
+ *
+ * Messages over any of the limits are dropped with #HZL_ERR_SECWARN_DENIAL_OF_SERVICE
+ * right after unpacking their header, before any cryptographic operation.
+ */
+typedef struct hzl_ServerDosConfig
+{
+    /** Limit of each Client, by the SID in the header. */
+    hzl_ServerDosLimit_t perClient;
+    /** Limit of each Group, by the GID in the header. */
+    hzl_ServerDosLimit_t perGroup;
+    /**
+     * Global budget of messages failing any security check, e.g. with an invalid tag.
+     * Once exhausted, all messages requiring cryptographic operations are dropped until
+     * it refills, as most of them are likely forged.
+     */
+    hzl_ServerDosLimit_t rejected;
+} hzl_ServerDosConfig_t;
+
+/**
+ * Counters of the DoS protection, since the Server initialisation.
+ *
+ * Updated by the Server: the user may read them.
+ */
+typedef struct hzl_ServerDosCounters
+{
+    /** Messages dropped by the #hzl_ServerDosConfig_t.perClient limit. */
+    uint32_t droppedByClientLimit;
+    /** Messages dropped by the #hzl_ServerDosConfig_t.perGroup limit. */
+    uint32_t droppedByGroupLimit;
+    /** Messages dropped because the #hzl_ServerDosConfig_t.rejected budget was exhausted. */
+    uint32_t droppedByRejectedBudget;
+    /** Messages that passed the limits, but failed a security check afterwards. */
+    uint32_t rejected;
+} hzl_ServerDosCounters_t;
+
+/** Token bucket, in thousandths of a message. */
+typedef struct hzl_ServerDosBucket
+{
+    /** Last refill of the bucket. */
+    hzl_Timestamp_t lastRefillInstant;
+    /** Available tokens, 1000 per message. */
+    uint32_t milliTokens;
+} hzl_ServerDosBucket_t;
+
+/**
+ * Variable state of the DoS protection.
+ *
+ * Initialised, modified, managed and cleared fully by the Server:
+ * the user MUST NOT touch its contents, except for reading the counters.
+ */
+typedef struct hzl_ServerDosState
+{
+    /** Counters of the dropped and rejected messages. */
+    hzl_ServerDosCounters_t counters;
+    /** Bucket of the #hzl_ServerDosConfig_t.rejected budget. */
+    hzl_ServerDosBucket_t rejectedBucket;
+    /** Buckets of the #hzl_ServerDosConfig_t.perClient limit, indexed by SID. */
+    hzl_ServerDosBucket_t clientBuckets[HZL_MAX_SIDS];
+    /** Buckets of the #hzl_ServerDosConfig_t.perGroup limit, indexed by GID. */
+    hzl_ServerDosBucket_t groupBuckets[HZL_MAX_GIDS];
+} hzl_ServerDosState_t;
+
+/**
+ * @def HZL_SERVER_REJECTED_CACHE_SLOTS
+ * Amount of fingerprints of recently rejected SADFD messages the Server remembers.
+ *
+ * A SADFD message failing the tag validation is fingerprinted and stored, so its exact
+ * repetitions, e.g. in a replay flood, are rejected with #HZL_ERR_SECWARN_INVALID_TAG
+ * without decrypting them again. The cache is 4-way set associative, 8 B per slot.
+ *
+ * Defaults to 256 (2 KiB); may be set at build time to 0, removing the cache, or to a power
+ * of 2 of at least 4 (CMake option `HZL_SERVER_REJECTED_CACHE_SLOTS`).
+ * The library and its users must be compiled with the same value.
+ */
+#ifndef HZL_SERVER_REJECTED_CACHE_SLOTS
+#define HZL_SERVER_REJECTED_CACHE_SLOTS 256U
+#endif
+
+#if HZL_SERVER_REJECTED_CACHE_SLOTS > 0
+
+/** Amount of slots in each set of the cache of rejected messages. */
+#define HZL_SERVER_REJECTED_CACHE_WAYS 4U
+
+_Static_assert(HZL_SERVER_REJECTED_CACHE_SLOTS >= HZL_SERVER_REJECTED_CACHE_WAYS
+               && (HZL_SERVER_REJECTED_CACHE_SLOTS
+                   & (HZL_SERVER_REJECTED_CACHE_SLOTS - 1U)) == 0U,
+               "HZL_SERVER_REJECTED_CACHE_SLOTS must be 0 or a power of 2, at least 4");
+
+/**
+ * Cache of the fingerprints of the SADFD messages recently rejected for an invalid tag.
+ *
+ * Initialised, modified, managed and cleared fully by the Server:
+ * the user MUST NOT touch its contents, except for reading the statistics.
+ */
+typedef struct hzl_ServerRejectedCache
+{
+    /** Fingerprints, in sets of #HZL_SERVER_REJECTED_CACHE_WAYS consecutive slots.
+     * 0 = empty slot. */
+    uint64_t fingerprints[HZL_SERVER_REJECTED_CACHE_SLOTS];
+    /** SADFD messages found in the cache and rejected without decryption. */
+    uint32_t hits;
+    /** SADFD messages not found in the cache, thus decrypted. */
+    uint32_t misses;
+} hzl_ServerRejectedCache_t;
+
+#endif
 
 /**
  * Configuration and status of the HazelNet Server library.
  *
  * Initialised by the user on embedded, loaded from file on an OS.
+ *
+ * ### Thread safety
+ * All the protocol state is in the context. The only other mutable state of the library is
+ * the one of hzl_OsCsprng(), behind the OS `io` functions: a DRBG state per thread, in
+ * thread-local storage, and a process-wide fork counter, incremented in the child by a
+ * handler registered once with `pthread_atfork()`, which makes forked children reseed.
+ * Neither needs locking.
+ * Distinct contexts can be used concurrently from distinct threads without any locking,
+ * as long as they don't share the `groupStates` array and the `io` functions are
+ * thread-safe (the OS ones are). The constant configurations may be shared.
+ *
+ * A single context is NOT thread-safe: all calls using the same context must be serialised
+ * by the user, e.g. by handling each CAN bus with one context in one thread.
  */
 typedef struct hzl_ServerCtx
 {
@@ -355,12 +688,86 @@ typedef struct hzl_ServerCtx
      * of the same group, for every `i`.
      */
     HZL_SET_BY_USER hzl_ServerGroupState_t* groupStates;
+    /**
+     * Pointer to an **array** of structs, each with the variable state of one Client.
+     * Optional: may be NULL.
+     *
+     * Set by the user to point to a memory location, does not have to be initialised. The Server
+     * handles the initialisation on init and clears it at deinit. When NULL, the Server works
+     * the same way, just slower on Requests, as it recomputes the precomputable data every time:
+     * useful on devices with very little memory.
+     *
+     * The array must contain #hzl_ServerConfig_t.amountOfClients elements (structs),
+     * which will be indexed in the same was as in the `clientConfigs` array.
+     */
+    HZL_SET_BY_USER hzl_ServerClientState_t* clientStates;
+    /**
+     * Pointer to **one** timer wheel, scheduling the Session renewals of all Groups.
+     * Optional: may be NULL, but is required by hzl_ServerTick().
+     *
+     * Set by the user to point to a memory location, does not have to be initialised. The Server
+     * handles the initialisation on init and clears it at deinit. When NULL, Sessions are renewed
+     * only upon reception of secured messages or with hzl_ServerForceSessionRenewal().
+     */
+    HZL_SET_BY_USER hzl_ServerTimerWheel_t* timerWheel;
+    /**
+     * Pointer to **one** constant DoS protection configuration.
+     * Optional: may be NULL to disable the protection.
+     *
+     * Set by the user to point to a memory location, must be initialised.
+     */
+    HZL_SET_BY_USER const hzl_ServerDosConfig_t* dosConfig;
+    /**
+     * Pointer to **one** DoS protection state, required if `dosConfig` is not NULL.
+     *
+     * Set by the user to point to a memory location, does not have to be initialised. The Server
+     * handles the initialisation on init and clears it at deinit.
+     */
+    HZL_SET_BY_USER hzl_ServerDosState_t* dosState;
+#if HZL_SERVER_REJECTED_CACHE_SLOTS > 0
+    /**
+     * Pointer to **one** cache of rejected messages.
+     * Optional: may be NULL to decrypt every SADFD message, even exact repetitions of rejected
+     * ones. hzl_ServerNew() allocates it.
+     *
+     * Set by the user to point to a memory location, does not have to be initialised. The Server
+     * handles the initialisation on init and clears it at deinit.
+     */
+    HZL_SET_BY_USER hzl_ServerRejectedCache_t* rejectedCache;
+#endif
+#if HZL_SADTP
+    /**
+     * Pointer to **one** pool of reassembly buffers for the received SADTP messages.
+     * Optional: may be NULL when not receiving SADTP messages. hzl_ServerNew() allocates it.
+     *
+     * Set by the user to point to a memory location, does not have to be initialised. The Server
+     * handles the initialisation on init and clears it at deinit. When NULL, received SADTP
+     * frames are rejected with #HZL_ERR_NULL_SADTP_POOL.
+     */
+    HZL_SET_BY_USER hzl_SadtpRxPool_t* sadtpRxPool;
+#endif
+#if HZL_SERVER_SPLIT_GROUP_STATE
+    /**
+     * Variable state of each Group accessed on every received secured message,
+     * indexed by GID like the `groupStates` array.
+     *
+     * Only the first #hzl_ServerConfig_t.amountOfGroups elements are used. Filled by
+     * hzl_ServerInit(), cleared by hzl_ServerDeInit(), not to be set by the user.
+     */
+    hzl_ServerGroupHotState_t groupHotStates[HZL_MAX_GIDS];
+#endif
     /**
      * Set of function pointers binding the API to the rest of the system.
      *
      * Including random number generation, timestamp generation and message transmission.
      */
     HZL_SET_BY_USER hzl_Io_t io;
+    /**
+     * Length in bytes of the single allocation holding this context and all the arrays it
+     * points to, when made by hzl_ServerNew(); released at once by hzl_ServerFree().
+     * Not to be set by the user.
+     */
+    size_t arenaLen;
 } hzl_ServerCtx_t;
 
 /**
@@ -385,6 +792,7 @@ typedef struct hzl_ServerCtx
  * @retval #HZL_ERR_NULL_CTX
  * @retval #HZL_ERR_NULL_CONFIG_SERVER
  * @retval #HZL_ERR_INVALID_HEADER_TYPE
+ * @retval #HZL_ERR_INVALID_HEADER_PLACEMENT
  * @retval #HZL_ERR_ZERO_GROUPS
  * @retval #HZL_ERR_TOO_MANY_GROUPS_FOR_CONFIGURED_HEADER_TYPE
  * @retval #HZL_ERR_ZERO_CLIENTS
@@ -508,6 +916,106 @@ hzl_ServerBuildSecuredFd(hzl_CbsPduMsg_t* securedPdu,
                          size_t userDataLen,
                          hzl_Gid_t groupId);
 
+/**
+ * Same as hzl_ServerBuildSecuredFd(), but writes the packed message directly into a buffer
+ * owned by the caller, e.g. the payload of the CAN FD frame to transmit, without an
+ * intermediate #hzl_CbsPduMsg_t.
+ *
+ * @warning \p securedPdu must not overlap with \p userData: the plaintext is encrypted
+ * directly into \p securedPdu. Copy it elsewhere first if they share the same frame buffer.
+ *
+ * @param [out] securedPdu buffer to write the CBS message into in packed format, ready to
+ *        transmit. Not NULL.
+ * @param [in] securedPduCapacity length of \p securedPdu in bytes. Must be at least the length
+ *        of the packed header and SADFD payload for \p userDataLen bytes of user data.
+ * @param [out] securedPduLen length in bytes of the message written into \p securedPdu.
+ *        Zero on errors. Not NULL.
+ * @param [out] securedPduCanId CAN ID to transmit the message with, carrying the header
+ *        when it's not placed in the payload, otherwise 0. May be NULL only then.
+ * @param [in, out] ctx as in hzl_ServerBuildSecuredFd().
+ * @param [in] userData as in hzl_ServerBuildSecuredFd().
+ * @param [in] userDataLen as in hzl_ServerBuildSecuredFd().
+ * @param [in] groupId as in hzl_ServerBuildSecuredFd().
+ *
+ * @retval Same values as hzl_ServerBuildSecuredFd().
+ * @retval #HZL_ERR_NULL_PDU also if \p securedPduLen is NULL or \p securedPduCanId is NULL
+ *         with the header not placed in the payload.
+ * @retval #HZL_ERR_TOO_SHORT_OUTPUT_BUFFER if \p securedPduCapacity is too small to contain
+ *         the message.
+ */
+HZL_API hzl_Err_t
+hzl_ServerBuildSecuredFdInto(uint8_t* securedPdu,
+                             size_t securedPduCapacity,
+                             size_t* securedPduLen,
+                             hzl_CanId_t* securedPduCanId,
+                             hzl_ServerCtx_t* ctx,
+                             const uint8_t* userData,
+                             size_t userDataLen,
+                             hzl_Gid_t groupId);
+
+#if HZL_SADTP
+/**
+ * Starts building a secured message longer than a CAN FD frame, encrypted, authenticated and
+ * timely, only for the given group to be able to read: a Secured Application Data over
+ * Transport Protocol (SADTP) message, split into frames as short as classic CAN ones.
+ *
+ * Takes the Counter Nonce of the message. The frames are then built one by one with
+ * hzl_ServerBuildSecuredTpNext(), each carrying the CBS header, a Protocol Control Information
+ * byte like ISO-TP (First Frame, then Consecutive Frames with a 4-bit sequence number) and
+ * the next segment of the message. There is no Flow Control, as the message is broadcast to
+ * the Group: the user transmits the frames at the pace the receivers can handle.
+ *
+ * The user data is encrypted in place, in \p userData, while the frames are built, so the
+ * message is never buffered twice.
+ *
+ * @warning \p userData must stay allocated and untouched until the last frame is built.
+ * Afterwards it contains the ciphertext, not the plaintext anymore.
+ * If the transmission is abandoned earlier, securely zero out \p tx.
+ *
+ * @param [out] tx state of the transmission, to pass to hzl_ServerBuildSecuredTpNext().
+ *        Not NULL.
+ *        In case of errors, its #hzl_SadtpTx_t.isDone is true.
+ * @param [in, out] ctx to access configurations and update the group states. Not NULL.
+ * @param [in, out] userData plaintext data (SDU) to transmit encrypted and authenticated.
+ *        Can be NULL only if \p userDataLen is zero.
+ * @param [in] userDataLen length of \p userData in bytes, at most #HZL_SADTP_MAX_SDU_LEN.
+ * @param [in] groupId destination group identifier (the Parties that can decrypt).
+ * @param [in] maxFrameLen length in bytes of the frames to build, except the shorter last one:
+ *        e.g. 8 for classic CAN or 64 for CAN FD. At least the header length in the payload
+ *        plus 2, values above 64 are handled as 64.
+ *
+ * @retval Same values as hzl_ServerBuildSecuredFd().
+ * @retval #HZL_ERR_NULL_SADTP_TX if \p tx is NULL.
+ * @retval #HZL_ERR_TOO_LONG_SDU if \p userDataLen is above #HZL_SADTP_MAX_SDU_LEN.
+ * @retval #HZL_ERR_TOO_SHORT_OUTPUT_BUFFER if \p maxFrameLen cannot contain the header,
+ *         the Protocol Control Information and at least one byte of the message.
+ */
+HZL_API hzl_Err_t
+hzl_ServerBuildSecuredTpStart(hzl_SadtpTx_t* tx,
+                              hzl_ServerCtx_t* ctx,
+                              uint8_t* userData,
+                              size_t userDataLen,
+                              hzl_Gid_t groupId,
+                              size_t maxFrameLen);
+
+/**
+ * Builds the next frame of the SADTP message started with hzl_ServerBuildSecuredTpStart().
+ *
+ * To be called until #hzl_SadtpTx_t.isDone is true, transmitting every frame in order.
+ *
+ * @param [out] securedPdu frame in packed format, ready to transmit. Not NULL.
+ * @param [in, out] tx state of the transmission. Not NULL.
+ *
+ * @retval #HZL_OK on successful building of the frame.
+ * @retval #HZL_ERR_NULL_PDU if \p securedPdu is NULL.
+ * @retval #HZL_ERR_NULL_SADTP_TX if \p tx is NULL.
+ * @retval #HZL_ERR_SADTP_TX_COMPLETED if all frames were already built.
+ */
+HZL_API hzl_Err_t
+hzl_ServerBuildSecuredTpNext(hzl_CbsPduMsg_t* securedPdu,
+                             hzl_SadtpTx_t* tx);
+#endif
+
 /**
  * Validates, unpacks and decrypts (if necessary) any received message, preparing an automatic
  * response when required.
@@ -531,7 +1039,8 @@ hzl_ServerBuildSecuredFd(hzl_CbsPduMsg_t* securedPdu,
  * @param [in] receivedPdu packed CBS message as received from the underlying layer. Not NULL.
  * @param [in] receivedPduLen length of \p receivedPdu in bytes.
  * @param [in] receivedCanId identifier of the underlying layer's PDU, passed as-is
- *        to \p receivedUserData.
+ *        to \p receivedUserData. The header is unpacked from it, unless it's placed in the
+ *        payload.
  *
  * @retval #HZL_OK on success.
  * @retval #HZL_ERR_MSG_IGNORED when the message has another destination.
@@ -558,6 +1067,21 @@ hzl_ServerBuildSecuredFd(hzl_CbsPduMsg_t* securedPdu,
  *         replay attack
  * @retval #HZL_ERR_SECWARN_INVALID_TAG when the message integrity and authenticity
  *         cannot be guaranteed
+ * @retval #HZL_ERR_SECWARN_DENIAL_OF_SERVICE when the message was dropped by the
+ *         #hzl_ServerCtx_t.dosConfig limits without being processed
+ * @retval #HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_SADTP when a SADTP frame is too short to
+ *         contain a segment of the message or has an unknown frame type.
+ *         Without #HZL_SADTP, SADTP frames are rejected with #HZL_ERR_INVALID_PAYLOAD_TYPE.
+ * @retval #HZL_ERR_NULL_SADTP_POOL when a SADTP frame is received by a context without
+ *         a #hzl_SadtpRxPool_t.
+ * @retval #HZL_ERR_SADTP_UNEXPECTED_SEGMENT, #HZL_ERR_SADTP_TIMEOUT,
+ *         #HZL_ERR_SADTP_POOL_FULL when a SADTP frame cannot be reassembled into a message.
+ *         All frames but the last of a SADTP message return #HZL_OK with
+ *         #hzl_RxSduMsg_t.isForUser false; the last one delivers the whole user data.
+ * @retval #HZL_ERR_TOO_SHORT_OUTPUT_BUFFER when a SADTP message is too long to be
+ *         copied into #hzl_RxSduMsg_t.data: use the in-place processing to receive it.
+ *         The message is refused with the frame carrying its length, before its Counter Nonce
+ *         is accepted, so the sender may still transmit it again.
  * @retval #HZL_ERR_CANNOT_GENERATE_RANDOM
  * @retval #HZL_ERR_CANNOT_GENERATE_NON_ZERO_RANDOM
  * @retval #HZL_ERR_CANNOT_GET_CURRENT_TIME
@@ -570,6 +1094,160 @@ hzl_ServerProcessReceived(hzl_CbsPduMsg_t* reactionPdu,
                           size_t receivedPduLen,
                           hzl_CanId_t receivedCanId);
 
+/**
+ * Same as hzl_ServerProcessReceived(), but with a reception timestamp provided by the caller
+ * instead of reading #hzl_Io_t.currentTime.
+ *
+ * Useful when the underlying layer provides the actual arrival time of the frame (e.g. the
+ * `SO_TIMESTAMP` of a SocketCAN socket): the freshness checks then measure the time since the
+ * frame arrived rather than since it was dequeued. It also allows a whole burst of received
+ * frames to share one clock reading.
+ *
+ * @warning \p rxTimestamp must come from the same clock as #hzl_Io_t.currentTime, which is
+ * used for all other timestamps in the context. Convert it if needed, e.g. by subtracting the
+ * age of the frame from the current time of #hzl_Io_t.currentTime.
+ *
+ * @param [out] reactionPdu as in hzl_ServerProcessReceived().
+ * @param [out] receivedUserData as in hzl_ServerProcessReceived().
+ * @param [in, out] ctx as in hzl_ServerProcessReceived().
+ * @param [in] receivedPdu as in hzl_ServerProcessReceived().
+ * @param [in] receivedPduLen as in hzl_ServerProcessReceived().
+ * @param [in] receivedCanId as in hzl_ServerProcessReceived().
+ * @param [in] rxTimestamp time of reception of \p receivedPdu.
+ *
+ * @retval Same values as hzl_ServerProcessReceived().
+ */
+HZL_API hzl_Err_t
+hzl_ServerProcessReceivedAt(hzl_CbsPduMsg_t* reactionPdu,
+                            hzl_RxSduMsg_t* receivedUserData,
+                            hzl_ServerCtx_t* ctx,
+                            const uint8_t* receivedPdu,
+                            size_t receivedPduLen,
+                            hzl_CanId_t receivedCanId,
+                            hzl_Timestamp_t rxTimestamp);
+
+/**
+ * Same as hzl_ServerProcessReceivedAt(), but decrypts the user data in place, inside
+ * \p receivedPdu, instead of copying it into a #hzl_RxSduMsg_t.
+ *
+ * Meant for the hot reception path: the received frame buffer is the only copy of the
+ * user data, and only the small \p receivedUserData view and the length of \p reactionPdu
+ * are cleared, instead of both whole structs.
+ *
+ * @warning The ciphertext in \p receivedPdu is overwritten with the plaintext, or with zeros
+ * if the message is not authentic. \p receivedUserData points into \p receivedPdu, so it
+ * is valid only until that buffer is reused. Clear the buffer after use if the plaintext
+ * is security-critical.
+ * The user data of a SADTP message, of any length, is instead in the
+ * #hzl_ServerCtx_t.sadtpRxPool, valid and not cleared until the next SADTP frame is processed.
+ *
+ * @param [out] reactionPdu as in hzl_ServerProcessReceived(). Only its length is cleared
+ *        before anything else is attempted, not its data.
+ * @param [out] receivedUserData metadata of the user data extracted out of \p receivedPdu,
+ *        pointing into it. Cleared before anything else is attempted. Not NULL.
+ * @param [in, out] ctx as in hzl_ServerProcessReceived().
+ * @param [in, out] receivedPdu as in hzl_ServerProcessReceived(), but writable, as the
+ *        user data is decrypted into it.
+ * @param [in] receivedPduLen as in hzl_ServerProcessReceived().
+ * @param [in] receivedCanId as in hzl_ServerProcessReceived().
+ * @param [in] rxTimestamp as in hzl_ServerProcessReceivedAt().
+ *
+ * @retval Same values as hzl_ServerProcessReceived().
+ */
+HZL_API hzl_Err_t
+hzl_ServerProcessReceivedInPlace(hzl_CbsPduMsg_t* reactionPdu,
+                                 hzl_RxSduView_t* receivedUserData,
+                                 hzl_ServerCtx_t* ctx,
+                                 uint8_t* receivedPdu,
+                                 size_t receivedPduLen,
+                                 hzl_CanId_t receivedCanId,
+                                 hzl_Timestamp_t rxTimestamp);
+
+/**
+ * Validates, unpacks and decrypts (if necessary) a burst of received messages at once,
+ * preparing an automatic response for each one when required.
+ *
+ * Equivalent to calling hzl_ServerProcessReceived() on each message, except that:
+ * - the context is validated once per batch instead of once per message;
+ * - the reception timestamp comes with each message instead of being read from
+ *   #hzl_Io_t.currentTime, so it's more accurate for messages that waited in a queue;
+ * - the messages are processed grouped by Group, each Group's messages keeping their
+ *   relative order. The Group state and the cached STK key schedule stay hot in the CPU cache
+ *   while all messages of the Group are processed. The messages of different Groups are
+ *   independent, so the outcome is the same as processing them in the received order.
+ *
+ * The outputs of the i-th message are always at index i of each output array, regardless of
+ * the processing order. Reactions should be transmitted in index order.
+ *
+ * @param [out] reactionPdus array of \p amount CBS messages, as \p reactionPdu of
+ *        hzl_ServerProcessReceived(). Not NULL.
+ *        **Transmit any data even if the result of the message is non-OK.**
+ * @param [out] receivedUserData array of \p amount SDUs, as \p receivedUserData of
+ *        hzl_ServerProcessReceived(), all securely cleared before processing. Not NULL.
+ * @param [out] results array of \p amount outcomes of each message, with the same values
+ *        the hzl_ServerProcessReceived() would return for it. Not NULL.
+ * @param [in, out] ctx to access configurations and update the group states. Not NULL.
+ * @param [in] receivedPdus array of \p amount received messages. Not NULL, unless
+ *        \p amount is zero.
+ * @param [in] amount number of messages in the batch. There is no upper limit.
+ *
+ * @retval #HZL_OK if the batch was processed: check \p results for the outcome of each message.
+ * @retval Same values as hzl_ServerInit() in case the context has NULL pointers.
+ * @retval #HZL_ERR_NULL_PDU if \p reactionPdus, \p results or \p receivedPdus are NULL.
+ * @retval #HZL_ERR_NULL_SDU if \p receivedUserData is NULL.
+ */
+HZL_API hzl_Err_t
+hzl_ServerProcessReceivedBatch(hzl_CbsPduMsg_t* reactionPdus,
+                               hzl_RxSduMsg_t* receivedUserData,
+                               hzl_Err_t* results,
+                               hzl_ServerCtx_t* ctx,
+                               const hzl_RxPdu_t* receivedPdus,
+                               size_t amount);
+
+/**
+ * Performs the time-driven Session management of all Groups, to be called periodically,
+ * e.g. every millisecond.
+ *
+ * - Sessions expired by time are renewed proactively, instead of at the next received secured
+ *   message of the Group. If any Client Requested the expiring Session, a renewal phase starts
+ *   with a REN message; otherwise no Client needs the previous Session and a new one simply
+ *   replaces it.
+ * - During a renewal phase, a REN message is repeated every
+ *   #hzl_ServerGroupConfig_t.delayBetweenRenNotificationsMillis since the Session start.
+ * - Renewal phases are ended as soon as they are over, clearing the previous Session.
+ * - The STK of the next Session of each Group is generated and expanded ahead of time,
+ *   replacing the one used by any Session started since the previous call, so the
+ *   reception of a message expiring the Session does not wait for the TRNG.
+ *
+ * The Groups are scheduled in the #hzl_ServerCtx_t.timerWheel, so a call costs O(due events),
+ * regardless of the amount of Groups. Calls farther apart than 65535 ms reschedule all Groups
+ * once instead.
+ *
+ * @param [out] renewalPdus array of \p capacity CBS messages. The first
+ *        \p amountOfRenewalPdus are REN messages ready to transmit, in order. Not NULL, unless
+ *        \p capacity is zero.
+ * @param [out] amountOfRenewalPdus amount of REN messages built into \p renewalPdus. Not NULL.
+ * @param [in, out] ctx to access configurations and update the group states. Not NULL, with a
+ *        timer wheel.
+ * @param [in] capacity amount of messages \p renewalPdus can hold. When more REN messages are
+ *        due, the remaining events are handled by the next call.
+ * @param [in] now current timestamp, from the same clock as #hzl_Io_t.currentTime.
+ *
+ * @retval #HZL_OK on success, also when nothing was due.
+ * @retval Same values as hzl_ServerInit() in case the context has NULL pointers.
+ * @retval #HZL_ERR_NULL_TIMER_WHEEL if the context has no timer wheel.
+ * @retval #HZL_ERR_NULL_PDU if \p renewalPdus or \p amountOfRenewalPdus are NULL.
+ * @retval #HZL_ERR_CANNOT_GET_CURRENT_TIME
+ * @retval #HZL_ERR_CANNOT_GENERATE_RANDOM
+ * @retval #HZL_ERR_CANNOT_GENERATE_NON_ZERO_RANDOM
+ */
+HZL_API hzl_Err_t
+hzl_ServerTick(hzl_CbsPduMsg_t* renewalPdus,
+               size_t* amountOfRenewalPdus,
+               hzl_ServerCtx_t* ctx,
+               size_t capacity,
+               hzl_Timestamp_t now);
+
 /**
  * Forcibly start a Session Renewal Phase, unless one is already ongoing or no Clients
  * are currently enabled (have Requested the STK) to process the REN message.
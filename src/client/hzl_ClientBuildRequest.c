@@ -51,12 +51,12 @@ hzl_ClientBuildMsgReq(hzl_CbsPduMsg_t* msgToTx,
             .sid = ctx->clientConfig->sid,
             .pty = HZL_PTY_REQ,
     };
-    const uint8_t packedHdrLen = hzl_HeaderLen(ctx->clientConfig->headerType);
-    hzl_HeaderPackFunc const headerPackFunc =
-            hzl_HeaderPackFuncForType(ctx->clientConfig->headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->clientConfig->headerType,
+                                                        ctx->clientConfig->headerPlacement);
     // Prepare REQ Payload
-    // Write the packed header at the beginning of the CAN FD frame's payload.
-    headerPackFunc(msgToTx->data, &unpackedReqHeader);
+    // Write the packed header at the beginning of the CAN FD frame's payload and/or CAN ID.
+    hzl_HeaderPackPlaced(msgToTx->data, &msgToTx->canId, &unpackedReqHeader,
+                         ctx->clientConfig->headerType, ctx->clientConfig->headerPlacement);
     // Write request nonce after the header
     hzl_ReqNonce_t requestNonce = 0;
     err = hzl_NonZeroTrng((uint8_t*) &requestNonce, ctx->io.trng, sizeof(hzl_ReqNonce_t));
@@ -29,7 +29,7 @@
 /**
  * @file
  * @internal
- * Implementation of hzl_ClientBuildSecuredFd().
+ * Implementation of hzl_ClientBuildSecuredFd() and hzl_ClientBuildSecuredFdInto().
  */
 
 #include "hzl_ClientInternal.h"
@@ -40,7 +40,9 @@
 #include "hzl_CommonInternal.h"
 
 inline static hzl_Err_t
-hzl_ClientBuildMsgSadfd(hzl_CbsPduMsg_t* const msgToTx,
+hzl_ClientBuildMsgSadfd(uint8_t* const pdu,
+                        size_t* const pduLen,
+                        hzl_CanId_t* const pduCanId,
                         hzl_ClientCtx_t* const ctx,
                         const uint8_t* const userData,
                         const size_t userDataLen,
@@ -52,40 +54,33 @@ hzl_ClientBuildMsgSadfd(hzl_CbsPduMsg_t* const msgToTx,
             .sid = ctx->clientConfig->sid,
             .pty = HZL_PTY_SADFD,
     };
-    const uint8_t packedHdrLen = hzl_HeaderLen(ctx->clientConfig->headerType);
-    hzl_HeaderPackFunc const headerPackFunc =
-            hzl_HeaderPackFuncForType(ctx->clientConfig->headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->clientConfig->headerType,
+                                                        ctx->clientConfig->headerPlacement);
     // Prepare SADFD payload
-    // Write the packed header at the beginning of the CAN FD frame's payload.
-    headerPackFunc(msgToTx->data, &unpackedSadfdHeader);
+    // Write the packed header at the beginning of the CAN FD frame's payload and/or CAN ID.
+    hzl_HeaderPackPlaced(pdu, pduCanId, &unpackedSadfdHeader,
+                         ctx->clientConfig->headerType, ctx->clientConfig->headerPlacement);
     // Write counter nonce after the header
-    hzl_EncodeLe24(&msgToTx->data[packedHdrLen + HZL_SADFD_CTRNONCE_IDX],
+    hzl_EncodeLe24(&pdu[packedHdrLen + HZL_SADFD_CTRNONCE_IDX],
                    group->state->currentCtrNonce);
-    msgToTx->data[packedHdrLen + HZL_SADFD_PTLEN_IDX] = (uint8_t) userDataLen;
+    pdu[packedHdrLen + HZL_SADFD_PTLEN_IDX] = (uint8_t) userDataLen;
     // Encrypt the plaintext (user-data a.k.a. SDU) into the ctext field of the SADFD message
+    hzl_AeadKeyExpand(&group->state->currentAeadKey, group->state->currentStk);
     hzl_Aead_t aead;
     hzl_CommonAeadInitSadfd(&aead,
-                            group->state->currentStk,
+                            &group->state->currentAeadKey,
                             &unpackedSadfdHeader,
                             group->state->currentCtrNonce,
                             (uint8_t) userDataLen);
-    const size_t processedPtLen = hzl_AeadEncryptUpdate(
+    hzl_AeadEncrypt(
             &aead,
-            &msgToTx->data[packedHdrLen + HZL_SADFD_CTEXT_IDX],  // Output: ciphertext
+            &pdu[packedHdrLen + HZL_SADFD_CTEXT_IDX],  // Output: ciphertext
             userData,  // Input: plaintext
             userDataLen,
-            &msgToTx->data[packedHdrLen + HZL_SADFD_TAG_IDX(userDataLen)],
+            &pdu[packedHdrLen + HZL_SADFD_TAG_IDX(userDataLen)],
             HZL_SADFD_TAG_LEN);
-    // Finish authenticated encryption and write tag
-    /*
-    hzl_AeadEncryptFinish(
-            &aead,
-            &msgToTx->data[packedHdrLen + HZL_SADFD_CTEXT_IDX + processedPtLen],
-            &msgToTx->data[packedHdrLen + HZL_SADFD_TAG_IDX(userDataLen)],
-            HZL_SADFD_TAG_LEN);
-    */
     // Message is packed in binary format, ready to transmit
-    msgToTx->dataLen = packedHdrLen + HZL_SADFD_PAYLOAD_LEN(userDataLen);
+    *pduLen = packedHdrLen + HZL_SADFD_PAYLOAD_LEN(userDataLen);
     // Increment the counter nonce, regardless of transmission success
     hzl_ClientGroupIncrCurrentCtrnonce(group);
     return HZL_OK;
@@ -99,14 +94,42 @@ hzl_ClientBuildSecuredFd(hzl_CbsPduMsg_t* securedPdu,
                          hzl_Gid_t groupId)
 {
     if (securedPdu == NULL) { return HZL_ERR_NULL_PDU; }
-    securedPdu->dataLen = 0; // Make output message empty in case of later error.
+    return hzl_ClientBuildSecuredFdInto(securedPdu->data, sizeof(securedPdu->data),
+                                        &securedPdu->dataLen, &securedPdu->canId,
+                                        ctx, userData, userDataLen, groupId);
+}
+
+HZL_API hzl_Err_t
+hzl_ClientBuildSecuredFdInto(uint8_t* securedPdu,
+                             size_t securedPduCapacity,
+                             size_t* securedPduLen,
+                             hzl_CanId_t* securedPduCanId,
+                             hzl_ClientCtx_t* ctx,
+                             const uint8_t* userData,
+                             size_t userDataLen,
+                             hzl_Gid_t groupId)
+{
+    if (securedPdu == NULL || securedPduLen == NULL) { return HZL_ERR_NULL_PDU; }
+    *securedPduLen = 0; // Make output message empty in case of later error.
     HZL_ERR_DECLARE(err);
     err = hzl_ClientCheckCtxPointers(ctx);
     HZL_ERR_CHECK(err);
+    if (securedPduCanId == NULL && ctx->clientConfig->headerPlacement != HZL_HEADER_IN_PAYLOAD)
+    {
+        return HZL_ERR_NULL_PDU;  // The CAN ID is needed to transmit the header
+    }
+    hzl_CanId_t unusedCanId;  // Always 0 with the header in the payload
     err = hzl_CommonCheckMsgBeforePacking(
             userData, userDataLen, groupId,
-            HZL_SADFD_METADATA_IN_PAYLOAD_LEN, ctx->clientConfig->headerType);
+            HZL_SADFD_METADATA_IN_PAYLOAD_LEN,
+            ctx->clientConfig->headerType, ctx->clientConfig->headerPlacement);
     HZL_ERR_CHECK(err);
+    if (securedPduCapacity < hzl_HeaderLenInPayload(ctx->clientConfig->headerType,
+                                                    ctx->clientConfig->headerPlacement)
+                             + HZL_SADFD_PAYLOAD_LEN(userDataLen))
+    {
+        return HZL_ERR_TOO_SHORT_OUTPUT_BUFFER;
+    }
     hzl_ClientGroup_t group;
     err = hzl_ClientFindGroup(&group, ctx, groupId);
     HZL_ERR_CHECK(err);
@@ -114,5 +137,7 @@ hzl_ClientBuildSecuredFd(hzl_CbsPduMsg_t* securedPdu,
     {
         return HZL_ERR_SESSION_NOT_ESTABLISHED;
     }
-    return hzl_ClientBuildMsgSadfd(securedPdu, ctx, userData, userDataLen, &group);
+    return hzl_ClientBuildMsgSadfd(securedPdu, securedPduLen,
+                                   securedPduCanId != NULL ? securedPduCanId : &unusedCanId,
+                                   ctx, userData, userDataLen, &group);
 }
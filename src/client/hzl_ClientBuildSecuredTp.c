@@ -0,0 +1,89 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Implementation of hzl_ClientBuildSecuredTpStart() and hzl_ClientBuildSecuredTpNext().
+ */
+
+#include "hzl_ClientInternal.h"
+#include "hzl_CommonHeader.h"
+#include "hzl_CommonMessage.h"
+#include "hzl_CommonInternal.h"
+
+#if HZL_SADTP
+
+HZL_API hzl_Err_t
+hzl_ClientBuildSecuredTpStart(hzl_SadtpTx_t* const tx,
+                              hzl_ClientCtx_t* const ctx,
+                              uint8_t* const userData,
+                              const size_t userDataLen,
+                              const hzl_Gid_t groupId,
+                              const size_t maxFrameLen)
+{
+    if (tx == NULL) { return HZL_ERR_NULL_SADTP_TX; }
+    hzl_ZeroOut(tx, sizeof(hzl_SadtpTx_t));
+    tx->isDone = true; // Nothing to transmit in case of later error.
+    HZL_ERR_DECLARE(err);
+    err = hzl_ClientCheckCtxPointers(ctx);
+    HZL_ERR_CHECK(err);
+    err = hzl_CommonCheckSadtpBeforePacking(
+            userData, userDataLen, groupId, maxFrameLen,
+            ctx->clientConfig->headerType, ctx->clientConfig->headerPlacement);
+    HZL_ERR_CHECK(err);
+    hzl_ClientGroup_t group;
+    err = hzl_ClientFindGroup(&group, ctx, groupId);
+    HZL_ERR_CHECK(err);
+    if (!hzl_ClientIsSessionEstablishedAndValid(&group))
+    {
+        return HZL_ERR_SESSION_NOT_ESTABLISHED;
+    }
+    const hzl_Header_t unpackedSadtpHeader = {
+            .gid = groupId,
+            .sid = ctx->clientConfig->sid,
+            .pty = HZL_PTY_SADTP,
+    };
+    hzl_AeadKeyExpand(&group.state->currentAeadKey, group.state->currentStk);
+    hzl_CommonBuildSecuredTpStart(tx, &group.state->currentAeadKey, &unpackedSadtpHeader,
+                                  group.state->currentCtrNonce, userData, userDataLen,
+                                  maxFrameLen, ctx->clientConfig->headerType,
+                                  ctx->clientConfig->headerPlacement);
+    // Increment the counter nonce, regardless of transmission success
+    hzl_ClientGroupIncrCurrentCtrnonce(&group);
+    return HZL_OK;
+}
+
+HZL_API hzl_Err_t
+hzl_ClientBuildSecuredTpNext(hzl_CbsPduMsg_t* const securedPdu,
+                             hzl_SadtpTx_t* const tx)
+{
+    return hzl_CommonBuildSecuredTpNext(securedPdu, tx);
+}
+
+#endif  /* HZL_SADTP */
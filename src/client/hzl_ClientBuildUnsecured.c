@@ -50,5 +50,6 @@ hzl_ClientBuildUnsecured(hzl_CbsPduMsg_t* const unsecuredPdu,
                                     userDataLen,
                                     groupId,
                                     ctx->clientConfig->sid,
-                                    ctx->clientConfig->headerType);
+                                    ctx->clientConfig->headerType,
+                                    ctx->clientConfig->headerPlacement);
 }
@@ -36,6 +36,7 @@
 #include "hzl_Client.h"
 #include "hzl_ClientInternal.h"
 #include "hzl_CommonInternal.h"
+#include "hzl_CommonAead.h"
 
 HZL_API hzl_Err_t
 hzl_ClientDeInit(hzl_ClientCtx_t* const ctx)
@@ -43,6 +44,11 @@ hzl_ClientDeInit(hzl_ClientCtx_t* const ctx)
     if (ctx == NULL) { return HZL_ERR_NULL_CTX; }
     if (ctx->clientConfig == NULL) { return HZL_ERR_NULL_CONFIG_CLIENT; }
     if (ctx->groupStates == NULL) { return HZL_ERR_NULL_STATES_GROUPS; }
+    for (size_t i = 0; i < ctx->clientConfig->amountOfGroups; i++)
+    {
+        hzl_AeadKeyClear(&ctx->groupStates[i].currentAeadKey);
+        hzl_AeadKeyClear(&ctx->groupStates[i].previousAeadKey);
+    }
     hzl_ClientClearStateUnchecked(ctx);
     return HZL_OK;
 }
@@ -45,19 +45,12 @@ hzl_ClientFree(hzl_ClientCtx_t** const pCtx)
     hzl_ClientCtx_t* ctx = *pCtx;  // Dereference once to make the code more readable
     if (ctx->clientConfig != NULL)
     {
-        HZL_SECURE_FREE(ctx->groupStates,
-                        ctx->clientConfig->amountOfGroups *
-                        sizeof(hzl_ClientGroupState_t));
-        // Here we force the pointer to the constant configuration to be writable just once
-        // because we have to clear the configuration securely before freeing it.
-        HZL_SECURE_FREE(ctx->groupConfigs,
-                        ctx->clientConfig->amountOfGroups *
-                        sizeof(hzl_ClientGroupConfig_t));
+        // Release the expanded keys cached in the states, if any.
+        (void) hzl_ClientDeInit(ctx);
     }
-    // Here we force the pointer to the constant configuration to be writable just once
-    // because we have to clear the configuration securely before freeing it.
-    HZL_SECURE_FREE(ctx->clientConfig, sizeof(hzl_ClientConfig_t));
-    HZL_SECURE_FREE(ctx, sizeof(hzl_ClientCtx_t));
+    // The context and all the arrays allocated by hzl_ClientNew() are one arena,
+    // including the constant configuration.
+    hzl_OsArenaFree(ctx, ctx->arenaLen);
     *pCtx = NULL;
 }
 
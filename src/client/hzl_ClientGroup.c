@@ -43,22 +43,23 @@ hzl_ClientFindGroup(hzl_ClientGroup_t* const group,
                     const hzl_ClientCtx_t* const ctx,
                     const hzl_Gid_t groupId)
 {
-    for (size_t i = 0; i < ctx->clientConfig->amountOfGroups; i++)
+    // Constant time, also for the GIDs of foreign Groups, which are most of the bus traffic.
+    const uint8_t idxPlusOne = ctx->groupIdxOfGid[groupId];
+    if (idxPlusOne == 0U)
     {
-        if (ctx->groupConfigs[i].gid == groupId)
-        {
-            group->config = &ctx->groupConfigs[i];
-            group->state = &ctx->groupStates[i];
-            return HZL_OK;
-        }
+        return HZL_ERR_UNKNOWN_GROUP;
     }
-    return HZL_ERR_UNKNOWN_GROUP;
+    group->config = &ctx->groupConfigs[idxPlusOne - 1U];
+    group->state = &ctx->groupStates[idxPlusOne - 1U];
+    return HZL_OK;
 }
 
 bool
 hzl_ClientIsSessionEstablishedAndValid(const hzl_ClientGroup_t* const group)
 {
-    return !hzl_IsAllZeros(group->state->currentStk, HZL_STK_LEN)
+    const uint8_t sessionState = group->state->sessionState;
+    return (sessionState == HZL_SESSION_STATE_ACTIVE
+            || sessionState == HZL_SESSION_STATE_RENEWING)
            && !HZL_IS_CTRNONCE_EXPIRED(group->state->currentCtrNonce);
 }
 
@@ -130,6 +131,13 @@ hzl_ClientGroupIncrCurrentCtrnonce(const hzl_ClientGroup_t* const group)
     {
         group->state->currentCtrNonce++;
     }
+    if (HZL_IS_CTRNONCE_EXPIRED(group->state->currentCtrNonce)
+        && group->state->sessionState == HZL_SESSION_STATE_ACTIVE)
+    {
+        // Only a new handshake can revive the Group. During a renewal phase the previous
+        // Session is still usable until the phase is over.
+        group->state->sessionState = HZL_SESSION_STATE_EXPIRED;
+    }
 }
 
 inline static void
@@ -171,31 +179,38 @@ void
 hzl_ClientSessionRenewalPhaseEnter(const hzl_ClientGroup_t* const group)
 {
     memcpy(group->state->previousStk, group->state->currentStk, HZL_STK_LEN);
+    // The expanded current STK becomes the previous one, the new STK is expanded on first use
+    hzl_AeadKeyMove(&group->state->previousAeadKey, &group->state->currentAeadKey);
     group->state->previousRxLastMessageInstant = group->state->currentRxLastMessageInstant;
     group->state->previousCtrNonce = group->state->currentCtrNonce;
+    group->state->sessionState = HZL_SESSION_STATE_RENEWING;
 }
 
 inline static bool
 hzl_ClientSessionRenewalPhaseIsActive(const hzl_ClientGroup_t* const group)
 {
-    return !hzl_IsAllZeros(group->state->previousStk, HZL_STK_LEN);
+    return group->state->sessionState == HZL_SESSION_STATE_RENEWING;
 }
 
 inline static void
 hzl_ClientSessionRenewalPhaseExit(const hzl_ClientGroup_t* const group)
 {
     hzl_ZeroOut(group->state->previousStk, HZL_STK_LEN);
+    hzl_AeadKeyClear(&group->state->previousAeadKey);
     group->state->previousRxLastMessageInstant = 0;
     group->state->previousCtrNonce = 0;
+    group->state->sessionState = HZL_IS_CTRNONCE_EXPIRED(group->state->currentCtrNonce)
+                                 ? HZL_SESSION_STATE_EXPIRED
+                                 : HZL_SESSION_STATE_ACTIVE;
 }
 
 inline static bool
 hzl_ClientSessionRenewalPhaseIsOver(const hzl_ClientGroup_t* const group,
                                     const hzl_Timestamp_t now)
 {
-    // The 2 is a multiplier coming strictly from the CBS protocol specification.
+    // Deadline precomputed by hzl_ClientInit()
     const bool haveEnoughSecuredMessagesBeenUsed =
-            group->state->currentCtrNonce >= 2U * group->config->maxCtrnonceDelayMsgs;
+            group->state->currentCtrNonce >= group->state->renewalPhaseEndCtrNonce;
     const hzl_TimeDeltaMillis_t deltaSinceRxResponse = hzl_TimeDelta(
             group->state->lastHandshakeEventInstant, now);
     const bool hasEnoughTimePassedSinceResponse =
@@ -38,8 +38,7 @@
 #include "hzl_CommonHeader.h"
 #include "hzl_CommonInternal.h"
 
-/** @internal Verifies the content of the Client Configuration structure. */
-static hzl_Err_t
+hzl_Err_t
 hzl_ClientInitCheckClientConfig(const hzl_ClientConfig_t* const config)
 {
     HZL_ERR_DECLARE(err);
@@ -50,6 +49,8 @@ hzl_ClientInitCheckClientConfig(const hzl_ClientConfig_t* const config)
     if (config->sid == HZL_SERVER_SID) { return HZL_ERR_SERVER_SID_ASSIGNED_TO_CLIENT; }
     err = hzl_HeaderTypeCheck(config->headerType);
     HZL_ERR_CHECK(err);
+    err = hzl_HeaderPlacementCheck(config->headerPlacement);
+    HZL_ERR_CHECK(err);
     const hzl_Sid_t maxSid = hzl_HeaderTypeMaxSid(config->headerType);
     if (config->sid > maxSid) { return HZL_ERR_SID_TOO_LARGE_FOR_CONFIGURED_HEADER_TYPE; }
     if (config->amountOfGroups == 0) { return HZL_ERR_ZERO_GROUPS; }
@@ -62,32 +63,41 @@ hzl_ClientInitCheckClientConfig(const hzl_ClientConfig_t* const config)
     return err;
 }
 
+hzl_Err_t
+hzl_ClientInitCheckGroupConfig(const hzl_ClientConfig_t* const clientConfig,
+                               const hzl_ClientGroupConfig_t* const groupConfigs,
+                               const size_t i)
+{
+    if (i == 0 && groupConfigs[0].gid != HZL_BROADCAST_GID) { return HZL_ERR_MISSING_GID_0; }
+    if (groupConfigs[i].maxCtrnonceDelayMsgs > HZL_LARGEST_MAX_COUNTER_NONCE_DELAY)
+    {
+        return HZL_ERR_INVALID_MAX_CTRNONCE_DELAY;
+    }
+    if (groupConfigs[i].gid > hzl_HeaderTypeMaxGid(clientConfig->headerType))
+    {
+        return HZL_ERR_GID_TOO_LARGE_FOR_CONFIGURED_HEADER_TYPE;
+    }
+    if (i > 0)
+    {
+        // Note: skipping first entry (index 0), as we are checking against the previous index
+        if (groupConfigs[i - 1U].gid >= groupConfigs[i].gid)
+        {
+            return HZL_ERR_GIDS_ARE_NOT_PRESORTED_STRICTLY_ASCENDING;
+        }
+    }
+    return HZL_OK;
+}
+
 /** @internal Verifies the content of the Groups Configurations array of structures. */
 static hzl_Err_t
 hzl_ClientInitCheckGroupConfigs(const hzl_ClientConfig_t* const clientConfig,
                                 const hzl_ClientGroupConfig_t* const groupConfigs)
 {
-    if (groupConfigs[0].gid != HZL_BROADCAST_GID) { return HZL_ERR_MISSING_GID_0; }
-    const hzl_Gid_t maxGid = hzl_HeaderTypeMaxGid(clientConfig->headerType);
+    HZL_ERR_DECLARE(err);
     for (size_t i = 0U; i < clientConfig->amountOfGroups; i++)
     {
-        if (groupConfigs[i].maxCtrnonceDelayMsgs >
-            HZL_LARGEST_MAX_COUNTER_NONCE_DELAY)
-        {
-            return HZL_ERR_INVALID_MAX_CTRNONCE_DELAY;
-        }
-        if (groupConfigs[i].gid > maxGid)
-        {
-            return HZL_ERR_GID_TOO_LARGE_FOR_CONFIGURED_HEADER_TYPE;
-        }
-        if (i > 0)
-        {
-            // Note: skipping first loop (index 0), as we are checking against the previous index
-            if (groupConfigs[i - 1U].gid >= groupConfigs[i].gid)
-            {
-                return HZL_ERR_GIDS_ARE_NOT_PRESORTED_STRICTLY_ASCENDING;
-            }
-        }
+        err = hzl_ClientInitCheckGroupConfig(clientConfig, groupConfigs, i);
+        HZL_ERR_CHECK(err);
     }
     return HZL_OK;
 }
@@ -121,6 +131,45 @@ hzl_ClientClearStateUnchecked(hzl_ClientCtx_t* const ctx)
 {
     hzl_ZeroOut(ctx->groupStates,
                 ctx->clientConfig->amountOfGroups * sizeof(hzl_ClientGroupState_t));
+    hzl_ZeroOut(ctx->groupIdxOfGid, sizeof(ctx->groupIdxOfGid));
+#if HZL_SADTP
+    if (ctx->sadtpRxPool != NULL)
+    {
+        hzl_ZeroOut(ctx->sadtpRxPool, sizeof(hzl_SadtpRxPool_t));
+    }
+#endif
+}
+
+/** @internal Precomputes the renewal phase deadline of each Group from its configuration. */
+static void
+hzl_ClientInitRenewalPhaseDeadlines(hzl_ClientCtx_t* const ctx)
+{
+    for (size_t i = 0U; i < ctx->clientConfig->amountOfGroups; i++)
+    {
+        // The 2 is a multiplier coming strictly from the CBS protocol specification.
+        // It cannot overflow, as maxCtrnonceDelayMsgs is at most 2^22.
+        ctx->groupStates[i].renewalPhaseEndCtrNonce =
+                2U * ctx->groupConfigs[i].maxCtrnonceDelayMsgs;
+    }
+}
+
+/** @internal Fills the GID-to-Group lookup table from the already-checked Group configurations. */
+static void
+hzl_ClientInitGroupIdxOfGid(hzl_ClientCtx_t* const ctx)
+{
+    // The amount of Groups is a uint8_t, so the index plus one always fits.
+    for (size_t i = 0U; i < ctx->clientConfig->amountOfGroups; i++)
+    {
+        ctx->groupIdxOfGid[ctx->groupConfigs[i].gid] = (uint8_t) (i + 1U);
+    }
+}
+
+void
+hzl_ClientInitUnchecked(hzl_ClientCtx_t* const ctx)
+{
+    hzl_ClientClearStateUnchecked(ctx);
+    hzl_ClientInitRenewalPhaseDeadlines(ctx);
+    hzl_ClientInitGroupIdxOfGid(ctx);
 }
 
 HZL_API hzl_Err_t
@@ -129,6 +178,6 @@ hzl_ClientInit(hzl_ClientCtx_t* const ctx)
     HZL_ERR_DECLARE(err);
     err = hzl_ClientCheckCtx(ctx);
     HZL_ERR_CHECK(err);
-    hzl_ClientClearStateUnchecked(ctx);
+    hzl_ClientInitUnchecked(ctx);
     return err;
 }
@@ -74,6 +74,43 @@ hzl_ClientCheckCtx(const hzl_ClientCtx_t* ctx);
 hzl_Err_t
 hzl_ClientCheckCtxPointers(const hzl_ClientCtx_t* ctx);
 
+/**
+ * @internal
+ * Verifies the content of the Client Configuration structure.
+ *
+ * @param [in] config to check, not NULL
+ * @return Same return values as hzl_ClientInit() for the Client Configuration.
+ */
+hzl_Err_t
+hzl_ClientInitCheckClientConfig(const hzl_ClientConfig_t* config);
+
+/**
+ * @internal
+ * Verifies the content of one Group Configuration structure, also against the previous one.
+ *
+ * Called on each element in order, so the configuration file can be validated in the same pass
+ * it's decoded in.
+ *
+ * @param [in] clientConfig the already checked Client Configuration
+ * @param [in] groupConfigs array of Group Configurations, filled up to index \p i
+ * @param [in] i index of the Group Configuration to check
+ * @return Same return values as hzl_ClientInit() for the Group Configurations.
+ */
+hzl_Err_t
+hzl_ClientInitCheckGroupConfig(const hzl_ClientConfig_t* clientConfig,
+                               const hzl_ClientGroupConfig_t* groupConfigs,
+                               size_t i);
+
+/**
+ * @internal
+ * Same as hzl_ClientInit() on an already validated context: clears the state and
+ * precomputes the data derived from the configuration, without checking it again.
+ *
+ * @param [in, out] ctx context with valid pointers and configuration
+ */
+void
+hzl_ClientInitUnchecked(hzl_ClientCtx_t* ctx);
+
 /**
  * @internal
  * Clears the state securely. Does not perform any memory safety checks.
@@ -85,10 +122,10 @@ hzl_ClientClearStateUnchecked(hzl_ClientCtx_t* ctx);
 
 /**
  * @internal
- * Linear search through the Groups, providing a handle to their state and config from the GID.
+ * Constant-time lookup of a Group, providing a handle to its state and config from the GID.
  *
  * @param [out] group pointers to the Group state and config
- * @param [in] ctx to search through the Group configs for the GID
+ * @param [in] ctx with the GID-to-Group table filled by hzl_ClientInit()
  * @param [in] groupId GID of the Group to search
  *
  * @retval #HZL_OK on success
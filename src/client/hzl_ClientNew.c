@@ -39,99 +39,110 @@
 
 #if HZL_OS_AVAILABLE
 
-/** @internal Loads an arbitrary amount of bytes from the stream, basically wrapping fopen()
- * to return a Hazelnet error code on unexpected stream end. */
-inline static hzl_Err_t
-hzl_LoadBytes(uint8_t* const bytes, FILE* const fileStream, const size_t amount)
-{
-    const size_t bufferedLen = fread(bytes, 1U, amount, fileStream);
-    if (bufferedLen != amount) { return HZL_ERR_UNEXPECTED_EOF; }
-    return HZL_OK;
-}
+/** @internal Length of the magic number in the file. */
+#define HZL_CLIENT_FILE_MAGIC_NUMBER_LEN 5U
+/** @internal Length of the encoded #hzl_ClientConfig_t. */
+#define HZL_CLIENT_FILE_CLIENT_CONFIG_LEN (6U + HZL_LTK_LEN)
+/** @internal Length of the encoded #hzl_ClientGroupConfig_t. */
+#define HZL_CLIENT_FILE_GROUP_CONFIG_LEN 12U
+/** @internal Length of the longest file: 255 Groups. */
+#define HZL_CLIENT_FILE_MAX_LEN \
+    (HZL_CLIENT_FILE_MAGIC_NUMBER_LEN + HZL_CLIENT_FILE_CLIENT_CONFIG_LEN \
+     + UINT8_MAX * HZL_CLIENT_FILE_GROUP_CONFIG_LEN)
 
 /** @internal Verifies the file starts with `"HZLc\0" = {0x68, 0x7A, 0x6C, 0x63, 0x00}`
  * to double check the correct binary file was selected. */
 static hzl_Err_t
-hzl_CheckMagicNumber(FILE* const fileStream)
+hzl_CheckMagicNumber(const uint8_t* const bytes, const size_t len)
 {
-    HZL_ERR_DECLARE(err);
-    uint8_t magicNumber[5U] = {0};
-    err = hzl_LoadBytes(magicNumber, fileStream, sizeof(magicNumber));
-    HZL_ERR_CHECK(err);
-    if (magicNumber[0] != 'H'
-        || magicNumber[1] != 'Z'
-        || magicNumber[2] != 'L'
-        || magicNumber[3] != 'c'
-        || magicNumber[4] != '\0')
+    if (len < HZL_CLIENT_FILE_MAGIC_NUMBER_LEN) { return HZL_ERR_UNEXPECTED_EOF; }
+    if (bytes[0] != 'H'
+        || bytes[1] != 'Z'
+        || bytes[2] != 'L'
+        || bytes[3] != 'c'
+        || bytes[4] != '\0')
     {
         return HZL_ERR_INVALID_FILE_MAGIC_NUMBER;
     }
-    return err;
-}
-
-/** @internal Loads a uint32 in Little Endian encoding from the file. */
-static hzl_Err_t
-hzl_LoadUint32Le(uint32_t* const value, FILE* const fileStream)
-{
-    HZL_ERR_DECLARE(err);
-    uint8_t bytes[sizeof(uint32_t)] = {0};
-    err = hzl_LoadBytes(bytes, fileStream, sizeof(bytes));
-    *value = hzl_DecodeLe32(bytes);
-    return err;
+    return HZL_OK;
 }
 
-/** @internal Loads a uint16 in Little Endian encoding from the file. */
-static hzl_Err_t
-hzl_LoadUint16Le(uint16_t* const value, FILE* const fileStream)
+/** @internal Decodes the Client Configuration structure.
+ * The header placement is in the 2 most significant bits of the header type byte,
+ * as in the Server's file. The last byte is padding. */
+inline static void
+hzl_DecodeClientConfig(hzl_ClientConfig_t* const config, const uint8_t* const bytes)
 {
-    HZL_ERR_DECLARE(err);
-    uint8_t bytes[sizeof(uint16_t)] = {0};
-    err = hzl_LoadBytes(bytes, fileStream, sizeof(bytes));
-    *value = hzl_DecodeLe16(bytes);
-    return err;
+    config->timeoutReqToResMillis = hzl_DecodeLe16(&bytes[0]);
+    memcpy(config->ltk, &bytes[2], HZL_LTK_LEN);
+    config->sid = bytes[2U + HZL_LTK_LEN];
+    config->headerType = bytes[3U + HZL_LTK_LEN] & 0x3FU;
+    config->headerPlacement = (uint8_t) (bytes[3U + HZL_LTK_LEN] >> 6U);
+    config->amountOfGroups = bytes[4U + HZL_LTK_LEN];
 }
 
-/** @internal Loads a uint8 in from the file (syntax sugar). */
-inline static hzl_Err_t
-hzl_LoadUint8(uint8_t* const value, FILE* const fileStream)
+/** @internal Decodes a single Group configuration structure. */
+inline static void
+hzl_DecodeGroupConfig(hzl_ClientGroupConfig_t* const group, const uint8_t* const bytes)
 {
-    return hzl_LoadBytes(value, fileStream, sizeof(uint8_t));
+    group->maxCtrnonceDelayMsgs = hzl_DecodeLe32(&bytes[0]);
+    group->maxSilenceIntervalMillis = hzl_DecodeLe16(&bytes[4]);
+    group->sessionRenewalDurationMillis = hzl_DecodeLe16(&bytes[6]);
+    group->gid = bytes[8];
+    memcpy(group->unusedPadding, &bytes[9], 3U);
 }
 
-/** @internal Loads the Client Configuration structure from the file. */
-inline static hzl_Err_t
-hzl_LoadClientConfig(hzl_ClientConfig_t* const config, FILE* const fileStream)
+/** @internal Decodes the Group configurations following the file header, checking
+ * each one as soon as it's decoded, in the same order as hzl_ClientInit() does. */
+static hzl_Err_t
+hzl_ClientDecodeAndCheckGroupConfigs(hzl_ClientCtx_t* const ctx,
+                                     const uint8_t* bytes)
 {
     HZL_ERR_DECLARE(err);
-    err = hzl_LoadUint16Le(&config->timeoutReqToResMillis, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadBytes(config->ltk, fileStream, HZL_LTK_LEN);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint8(&config->sid, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint8(&config->headerType, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint8(&config->amountOfGroups, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadBytes(config->unusedPadding, fileStream, 1U);
-    return err;
+    // Here we force the pointer to the constant configuration to be writable just once
+    // because we have to fill the configuration in the first place.
+    hzl_ClientGroupConfig_t* const groupConfigs = (hzl_ClientGroupConfig_t*) ctx->groupConfigs;
+    for (size_t i = 0U; i < ctx->clientConfig->amountOfGroups; i++)
+    {
+        hzl_DecodeGroupConfig(&groupConfigs[i], bytes);
+        bytes += HZL_CLIENT_FILE_GROUP_CONFIG_LEN;
+        err = hzl_ClientInitCheckGroupConfig(ctx->clientConfig, groupConfigs, i);
+        HZL_ERR_CHECK(err);
+    }
+    return HZL_OK;
 }
 
-/** @internal Loads a single Group configuration structure from the file. */
-inline static hzl_Err_t
-hzl_LoadGroupConfig(hzl_ClientGroupConfig_t* const group, FILE* const fileStream)
+/** @internal Allocates the context and all its arrays as one zeroed arena, laid out in the
+ * order they are accessed when processing a received message, and points the context to them.
+ * Copies the already loaded Client configuration in it. Free it with hzl_ClientFree(). */
+static hzl_ClientCtx_t*
+hzl_ClientArenaAlloc(const hzl_ClientConfig_t* const clientConfig)
 {
-    HZL_ERR_DECLARE(err);
-    err = hzl_LoadUint32Le(&group->maxCtrnonceDelayMsgs, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint16Le(&group->maxSilenceIntervalMillis, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint16Le(&group->sessionRenewalDurationMillis, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint8(&group->gid, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadBytes(group->unusedPadding, fileStream, 3U);
-    return err;
+    size_t arenaLen = 0U;
+    (void) hzl_OsArenaReserve(&arenaLen, sizeof(hzl_ClientCtx_t));  // Always at offset 0
+    const size_t clientConfigOffset = hzl_OsArenaReserve(
+            &arenaLen, sizeof(hzl_ClientConfig_t));
+    const size_t groupConfigsOffset = hzl_OsArenaReserve(
+            &arenaLen, clientConfig->amountOfGroups * sizeof(hzl_ClientGroupConfig_t));
+    const size_t groupStatesOffset = hzl_OsArenaReserve(
+            &arenaLen, clientConfig->amountOfGroups * sizeof(hzl_ClientGroupState_t));
+#if HZL_SADTP
+    const size_t sadtpRxPoolOffset = hzl_OsArenaReserve(
+            &arenaLen, sizeof(hzl_SadtpRxPool_t));
+#endif
+    uint8_t* const arena = hzl_OsArenaAlloc(arenaLen);
+    if (arena == NULL) { return NULL; }
+    hzl_ClientCtx_t* const ctx = (hzl_ClientCtx_t*) arena;
+    ctx->arenaLen = arenaLen;
+    // The constant configuration is written just once, here, before it's pointed to.
+    memcpy(&arena[clientConfigOffset], clientConfig, sizeof(hzl_ClientConfig_t));
+    ctx->clientConfig = (const hzl_ClientConfig_t*) &arena[clientConfigOffset];
+    ctx->groupConfigs = (const hzl_ClientGroupConfig_t*) &arena[groupConfigsOffset];
+    ctx->groupStates = (hzl_ClientGroupState_t*) &arena[groupStatesOffset];
+#if HZL_SADTP
+    ctx->sadtpRxPool = (hzl_SadtpRxPool_t*) &arena[sadtpRxPoolOffset];
+#endif
+    return ctx;
 }
 
 HZL_API hzl_Err_t
@@ -139,63 +150,52 @@ hzl_ClientNew(hzl_ClientCtx_t** const pCtx,
               const char* const fileName)
 {
     HZL_ERR_DECLARE(err);
-    FILE* fileStream = NULL;
+    uint8_t* bytes = NULL;
+    size_t len = 0U;
     hzl_ClientCtx_t* ctx = NULL;
+    hzl_ClientConfig_t clientConfig = {0};
     if (pCtx == NULL) { return HZL_ERR_NULL_CTX; }
     *pCtx = NULL;  // Empty output in case of allocation errors.
     if (fileName == NULL) { return HZL_ERR_NULL_FILENAME; }
-    fileStream = fopen(fileName, "r");
-    if (fileStream == NULL) { return HZL_ERR_CANNOT_OPEN_CONFIG_FILE; }
-    err = hzl_CheckMagicNumber(fileStream);
+    err = hzl_OsReadFile(&bytes, &len, fileName, HZL_CLIENT_FILE_MAX_LEN);
+    HZL_ERR_CHECK(err);
+    err = hzl_CheckMagicNumber(bytes, len);
     HZL_ERR_CLEANUP(err);
-    // At this point, the file was successfully opened and seems to be of the correct format.
-    ctx = calloc(1U, sizeof(hzl_ClientCtx_t));
-    if (ctx == NULL)
+    // At this point, the file was successfully read and seems to be of the correct format.
+    // Its header tells the length of the whole file and of all arrays.
+    if (len < HZL_CLIENT_FILE_MAGIC_NUMBER_LEN + HZL_CLIENT_FILE_CLIENT_CONFIG_LEN)
     {
-        err = HZL_ERR_MALLOC_FAILED;
+        err = HZL_ERR_UNEXPECTED_EOF;
         goto cleanup;
     }
-    ctx->clientConfig = calloc(1U, sizeof(hzl_ClientConfig_t));
-    if (ctx->clientConfig == NULL)
+    hzl_DecodeClientConfig(&clientConfig, &bytes[HZL_CLIENT_FILE_MAGIC_NUMBER_LEN]);
+    if (len < HZL_CLIENT_FILE_MAGIC_NUMBER_LEN + HZL_CLIENT_FILE_CLIENT_CONFIG_LEN
+              + clientConfig.amountOfGroups * HZL_CLIENT_FILE_GROUP_CONFIG_LEN)
     {
-        err = HZL_ERR_MALLOC_FAILED;
+        err = HZL_ERR_UNEXPECTED_EOF;
         goto cleanup;
     }
-    // Here we force the pointer to the constant configuration to be writable just once
-    // because we have to fill the configuration in the first place.
-    err = hzl_LoadClientConfig((hzl_ClientConfig_t*) ctx->clientConfig, fileStream);
+    err = hzl_ClientInitCheckClientConfig(&clientConfig);
     HZL_ERR_CLEANUP(err);
-    ctx->groupConfigs = calloc(ctx->clientConfig->amountOfGroups,
-                               sizeof(hzl_ClientGroupConfig_t));
-    if (ctx->groupConfigs == NULL)
-    {
-        err = HZL_ERR_MALLOC_FAILED;
-        goto cleanup;
-    }
-    for (size_t group = 0; group < ctx->clientConfig->amountOfGroups; group++)
-    {
-        // Here we force the pointer to the constant configuration to be writable just once
-        // because we have to fill the configuration in the first place.
-        err = hzl_LoadGroupConfig(
-                (hzl_ClientGroupConfig_t*) &ctx->groupConfigs[group],
-                fileStream);
-        HZL_ERR_CLEANUP(err);
-    }
-    ctx->groupStates = calloc(
-            ctx->clientConfig->amountOfGroups, sizeof(hzl_ClientGroupState_t));
-    if (ctx->groupStates == NULL)
+    ctx = hzl_ClientArenaAlloc(&clientConfig);
+    if (ctx == NULL)
     {
         err = HZL_ERR_MALLOC_FAILED;
         goto cleanup;
     }
+    err = hzl_ClientDecodeAndCheckGroupConfigs(
+            ctx, &bytes[HZL_CLIENT_FILE_MAGIC_NUMBER_LEN + HZL_CLIENT_FILE_CLIENT_CONFIG_LEN]);
+    HZL_ERR_CLEANUP(err);
     ctx->io.currentTime = hzl_OsCurrentTime;
-    ctx->io.trng = hzl_OsTrng;
-    err = hzl_ClientCheckCtx(ctx);
+    ctx->io.trng = hzl_OsCsprng;
+    // The configuration was checked while decoding it
+    hzl_ClientInitUnchecked(ctx);
     *pCtx = ctx;
     ctx = NULL;
     cleanup:
     {
-        fclose(fileStream);
+        HZL_SECURE_FREE(bytes, HZL_CLIENT_FILE_MAX_LEN);  // Holds the LTK
+        hzl_ZeroOut(&clientConfig, sizeof(clientConfig));  // Copy of the LTK
         if (err != HZL_OK) { hzl_ClientFree(&ctx); }
     }
     return err;
@@ -29,7 +29,8 @@
 /**
  * @file
  * @internal
- * Implementation of the hzl_ClientProcessReceived() function.
+ * Implementation of the hzl_ClientProcessReceived() and hzl_ClientProcessReceivedAt()
+ * functions.
  */
 
 #include "hzl.h"
@@ -40,32 +41,23 @@
 #include "hzl_CommonMessage.h"
 #include "hzl_CommonInternal.h"
 
-HZL_API hzl_Err_t
-hzl_ClientProcessReceived(hzl_CbsPduMsg_t* const reactionPdu,
-                          hzl_RxSduMsg_t* const receivedUserData,
-                          hzl_ClientCtx_t* const ctx,
-                          const uint8_t* const receivedPdu,
-                          const size_t receivedPduLen,
-                          const hzl_CanId_t receivedCanId)
+/** @internal Common part of hzl_ClientProcessReceived() and hzl_ClientProcessReceivedAt(),
+ * after the parameters have been validated. */
+static hzl_Err_t
+hzl_ClientProcessReceivedChecked(hzl_CbsPduMsg_t* const reactionPdu,
+                                 hzl_RxSduMsg_t* const receivedUserData,
+                                 hzl_ClientCtx_t* const ctx,
+                                 const uint8_t* const receivedPdu,
+                                 const size_t receivedPduLen,
+                                 const hzl_CanId_t receivedCanId,
+                                 const hzl_Timestamp_t rxTimestamp)
 {
-    if (reactionPdu == NULL) { return HZL_ERR_NULL_PDU; }
-    if (receivedUserData == NULL) { return HZL_ERR_NULL_SDU; }
     HZL_ERR_DECLARE(err);
-    err = hzl_ClientCheckCtxPointers(ctx);
-    HZL_ERR_CHECK(err);
-    // Get the RX timestamp ASAP to reduce the delays
-    hzl_Timestamp_t rxTimestamp = 0;
-    err = ctx->io.currentTime(&rxTimestamp);
-    // Clear any data that may still linger in the output location, if it's reused.
-    // By doing so we avoid the situation where the message buffer contains trailing data
-    // from a previously-decrypted message that may be security-critical.
-    hzl_ZeroOut(receivedUserData, sizeof(hzl_RxSduMsg_t));
-    hzl_ZeroOut(reactionPdu, sizeof(hzl_CbsPduMsg_t));
-    HZL_ERR_CHECK(err); // Return from any error of currentTime() only after the cleanups
     hzl_Header_t unpackedHdr;
     err = hzl_CommonCheckReceivedGenericMsg(
-            &unpackedHdr, receivedPdu, receivedPduLen,
-            ctx->clientConfig->sid, ctx->clientConfig->headerType);
+            &unpackedHdr, receivedPdu, receivedPduLen, receivedCanId,
+            ctx->clientConfig->sid,
+            ctx->clientConfig->headerType, ctx->clientConfig->headerPlacement);
     HZL_ERR_CHECK(err);
     receivedUserData->canId = receivedCanId;
     switch (unpackedHdr.pty)
@@ -80,9 +72,11 @@ hzl_ClientProcessReceived(hzl_CbsPduMsg_t* const reactionPdu,
             return hzl_ClientProcessReceivedRenewal(
                     reactionPdu, ctx, receivedPdu, receivedPduLen, &unpackedHdr, rxTimestamp);
 
+#if HZL_SADTP
         case HZL_PTY_SADTP:
             return hzl_ClientProcessReceivedSecuredTp(
                     receivedUserData, ctx, receivedPdu, receivedPduLen, &unpackedHdr, rxTimestamp);
+#endif
 
         case HZL_PTY_SADFD:
             return hzl_ClientProcessReceivedSecuredFd(
@@ -91,10 +85,57 @@ hzl_ClientProcessReceived(hzl_CbsPduMsg_t* const reactionPdu,
         case HZL_PTY_UAD:
             return hzl_CommonProcessReceivedUnsecured(
                     receivedUserData, receivedPdu, receivedPduLen,
-                    &unpackedHdr, ctx->clientConfig->headerType);
+                    &unpackedHdr,
+                    ctx->clientConfig->headerType, ctx->clientConfig->headerPlacement);
 
         case HZL_PTY_RFU1:  // Fall-through to default
         case HZL_PTY_RFU2:  // Fall-through to default
         default:return HZL_ERR_INVALID_PAYLOAD_TYPE;
     }
 }
+
+HZL_API hzl_Err_t
+hzl_ClientProcessReceived(hzl_CbsPduMsg_t* const reactionPdu,
+                          hzl_RxSduMsg_t* const receivedUserData,
+                          hzl_ClientCtx_t* const ctx,
+                          const uint8_t* const receivedPdu,
+                          const size_t receivedPduLen,
+                          const hzl_CanId_t receivedCanId)
+{
+    if (reactionPdu == NULL) { return HZL_ERR_NULL_PDU; }
+    if (receivedUserData == NULL) { return HZL_ERR_NULL_SDU; }
+    HZL_ERR_DECLARE(err);
+    err = hzl_ClientCheckCtxPointers(ctx);
+    HZL_ERR_CHECK(err);
+    // Get the RX timestamp ASAP to reduce the delays
+    hzl_Timestamp_t rxTimestamp = 0;
+    err = ctx->io.currentTime(&rxTimestamp);
+    // Clear any data that may still linger in the output location, if it's reused.
+    // By doing so we avoid the situation where the message buffer contains trailing data
+    // from a previously-decrypted message that may be security-critical.
+    hzl_ClearReceivedOutputs(receivedUserData, reactionPdu);
+    HZL_ERR_CHECK(err); // Return from any error of currentTime() only after the cleanups
+    return hzl_ClientProcessReceivedChecked(
+            reactionPdu, receivedUserData, ctx,
+            receivedPdu, receivedPduLen, receivedCanId, rxTimestamp);
+}
+
+HZL_API hzl_Err_t
+hzl_ClientProcessReceivedAt(hzl_CbsPduMsg_t* const reactionPdu,
+                            hzl_RxSduMsg_t* const receivedUserData,
+                            hzl_ClientCtx_t* const ctx,
+                            const uint8_t* const receivedPdu,
+                            const size_t receivedPduLen,
+                            const hzl_CanId_t receivedCanId,
+                            const hzl_Timestamp_t rxTimestamp)
+{
+    if (reactionPdu == NULL) { return HZL_ERR_NULL_PDU; }
+    if (receivedUserData == NULL) { return HZL_ERR_NULL_SDU; }
+    HZL_ERR_DECLARE(err);
+    err = hzl_ClientCheckCtxPointers(ctx);
+    HZL_ERR_CHECK(err);
+    hzl_ClearReceivedOutputs(receivedUserData, reactionPdu);
+    return hzl_ClientProcessReceivedChecked(
+            reactionPdu, receivedUserData, ctx,
+            receivedPdu, receivedPduLen, receivedCanId, rxTimestamp);
+}
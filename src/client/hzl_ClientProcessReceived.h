@@ -40,8 +40,30 @@ extern "C"
 {
 #endif
 
+#include "hzl_ClientInternal.h"
 #include "hzl_CommonInternal.h"
 #include "hzl_CommonHeader.h"
+#include "hzl_CommonAead.h"
+
+/**
+ * @internal
+ * Selects the STK to use during a Session renewal phase, in its expanded form.
+ */
+inline static hzl_AeadKey_t*
+hzl_ClientChoosePreviusOrCurrentAeadKey(const hzl_ClientGroup_t* const group,
+                                        const bool isPreviousSession)
+{
+    if (isPreviousSession)
+    {
+        hzl_AeadKeyExpand(&group->state->previousAeadKey, group->state->previousStk);
+        return &group->state->previousAeadKey;
+    }
+    else
+    {
+        hzl_AeadKeyExpand(&group->state->currentAeadKey, group->state->currentStk);
+        return &group->state->currentAeadKey;
+    }
+}
 
 /**
  * @internal
@@ -88,6 +110,32 @@ hzl_ClientProcessReceivedRenewal(hzl_CbsPduMsg_t* reactionPdu,
                                  hzl_Timestamp_t rxTimestamp);
 
 
+/**
+ * @internal
+ * Validates, decrypts and handles a received SADFD message, updating the local Counter Nonce,
+ * without copying the decrypted data anywhere else than into \p plaintext.
+ *
+ * @param [out] unpackedView metadata of the SADFD message, pointing to \p plaintext for the data
+ * @param [out] plaintext where to decrypt the user data into. Must be large enough for the
+ *        plaintext length declared in the message. May point exactly to the ciphertext in
+ *        \p rxPdu to decrypt in place, but must not overlap it otherwise.
+ * @param [in, out] ctx to access the Group configuration and alter its state
+ * @param [in] rxPdu received raw SADFD message
+ * @param [in] rxPduLen length of \p rxPdu in bytes
+ * @param [in] unpackedSadfdHeader metadata of the CBS message in unpacked format
+ * @param [in] rxTimestamp timestamp of reception
+ *
+ * @return same as hzl_ClientProcessReceivedSecuredFd()
+ */
+hzl_Err_t
+hzl_ClientProcessReceivedSecuredFdView(hzl_RxSduView_t* unpackedView,
+                                       uint8_t* plaintext,
+                                       const hzl_ClientCtx_t* ctx,
+                                       const uint8_t* rxPdu,
+                                       size_t rxPduLen,
+                                       const hzl_Header_t* unpackedSadfdHeader,
+                                       hzl_Timestamp_t rxTimestamp);
+
 /**
  * @internal
  * Validates, decrypts and handles a received SADFD message, updating the local Counter Nonce.
@@ -110,13 +158,43 @@ hzl_ClientProcessReceivedSecuredFd(hzl_RxSduMsg_t* unpackedMsg,
                                    const hzl_Header_t* unpackedSadfdHeader,
                                    hzl_Timestamp_t rxTimestamp);
 
+#if HZL_SADTP
 /**
  * @internal
- * Validates, decrypts and handles a received SADTP message, updating the local Counter Nonce.
+ * Validates and handles a received SADTP frame, reassembling its message in the
+ * #hzl_ClientCtx_t.sadtpRxPool and updating the local Counter Nonce after its last frame.
  *
- * @param [out] unpackedMsg decrypted, validated and unpacked data contained in the SADFD message
+ * @param [out] unpackedView metadata of the SADTP message, pointing into its reassembly slot for
+ *        the data. Not for the user until the last frame of the message is received.
+ * @param [in, out] ctx to access the Group configuration and alter its state
+ * @param [in] rxPdu received raw SADTP frame
+ * @param [in] rxPduLen length of \p rxPdu in bytes
+ * @param [in] unpackedSadtpHeader metadata of the CBS message in unpacked format
+ * @param [in] rxTimestamp timestamp of reception
+ * @param [in] maxSduLen longest user data the caller can deliver: longer messages are refused
+ *        with #HZL_ERR_TOO_SHORT_OUTPUT_BUFFER as soon as their ptlen is received, before
+ *        the Counter Nonce is updated
+ *
+ * @return same as hzl_ClientProcessReceivedSecuredTp()
+ */
+hzl_Err_t
+hzl_ClientProcessReceivedSecuredTpView(hzl_RxSduView_t* unpackedView,
+                                       const hzl_ClientCtx_t* ctx,
+                                       const uint8_t* rxPdu,
+                                       size_t rxPduLen,
+                                       const hzl_Header_t* unpackedSadtpHeader,
+                                       hzl_Timestamp_t rxTimestamp,
+                                       size_t maxSduLen);
+
+/**
+ * @internal
+ * Validates and handles a received SADTP frame, updating the local Counter Nonce after the last
+ * frame of its message, copying the message data into \p unpackedMsg. Messages longer than
+ * \p unpackedMsg can hold are refused as soon as their ptlen is received.
+ *
+ * @param [out] unpackedMsg decrypted, validated and unpacked data contained in the SADTP message
  * @param [in, out] ctx to access the Group configuration and alter its state
- * @param [in] rxPdu received raw SADTP message
+ * @param [in] rxPdu received raw SADTP frame
  * @param [in] rxPduLen length of \p rxPdu in bytes
  * @param [in] unpackedSadtpHeader metadata of the CBS message in unpacked format
  * @param [in] rxTimestamp timestamp of reception
@@ -131,6 +209,7 @@ hzl_ClientProcessReceivedSecuredTp(hzl_RxSduMsg_t* unpackedMsg,
                                    size_t rxPduLen,
                                    const hzl_Header_t* unpackedSadtpHeader,
                                    hzl_Timestamp_t rxTimestamp);
+#endif  /* HZL_SADTP */
 
 #ifdef __cplusplus
 }
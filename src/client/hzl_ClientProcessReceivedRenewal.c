@@ -72,7 +72,8 @@ hzl_ClientProcessReceivedRenewal(hzl_CbsPduMsg_t* reactionPdu,
         return HZL_ERR_MSG_IGNORED;
     }
     // REN msg must be long enough to contain the required fields
-    const uint8_t packedHdrLen = hzl_HeaderLen(ctx->clientConfig->headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->clientConfig->headerType,
+                                                        ctx->clientConfig->headerPlacement);
     if (rxPduLen < packedHdrLen + HZL_REN_PAYLOAD_LEN)
     {
         // We would overflow valid memory.
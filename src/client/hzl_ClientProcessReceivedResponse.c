@@ -53,7 +53,8 @@ hzl_ClientProcessReceivedResponse(const hzl_ClientCtx_t* ctx,
         return HZL_ERR_SECWARN_SERVER_ONLY_MESSAGE;
     }
     // RES msg must be long enough to contain the required fields
-    const uint8_t packedHdrLen = hzl_HeaderLen(ctx->clientConfig->headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->clientConfig->headerType,
+                                                        ctx->clientConfig->headerPlacement);
     if (rxPduLen < packedHdrLen + HZL_RES_PAYLOAD_LEN)
     {
         // We would overflow valid memory.
@@ -77,9 +78,11 @@ hzl_ClientProcessReceivedResponse(const hzl_ClientCtx_t* ctx,
     uint8_t encodedRequestNonce[HZL_REQ_REQNONCE_LEN];
     hzl_EncodeLe64(encodedRequestNonce, group.state->requestNonce);
     // Authenticated decryption initialisation
+    hzl_AeadKey_t ltkAeadKey = {0};
+    hzl_AeadKeyExpand(&ltkAeadKey, ctx->clientConfig->ltk);
     hzl_Aead_t aead;
     hzl_CommonAeadInitRes(&aead,
-                          ctx->clientConfig->ltk,
+                          &ltkAeadKey,
                           unpackedHdr,
                           &rxPdu[packedHdrLen + HZL_RES_CTRNONCE_IDX],
                           encodedRequestNonce,
@@ -87,22 +90,14 @@ hzl_ClientProcessReceivedResponse(const hzl_ClientCtx_t* ctx,
                           clientSid);
     // Decryption start
     uint8_t plaintextStk[HZL_RES_CTEXT_LEN] = {0};
-    err = hzl_AeadDecryptUpdate(
+    err = hzl_AeadDecrypt(
             &aead,
             plaintextStk,  // Output: plaintext
             &rxPdu[packedHdrLen + HZL_RES_CTEXT_IDX],  // Input: ciphertext
             HZL_RES_CTEXT_LEN,
             &rxPdu[packedHdrLen + HZL_RES_TAG_IDX],
             HZL_RES_TAG_LEN);
-    
-    /*
-    // Finish authenticated decryption and validate tag
-    err = hzl_AeadDecryptFinish(
-            &aead,
-            &plaintextStk[processedPtLen],
-            &rxPdu[packedHdrLen + HZL_RES_TAG_IDX],
-            HZL_RES_TAG_LEN);
-    */
+    hzl_AeadKeyClear(&ltkAeadKey);
     if (err != HZL_OK)
     {
         // Securely clear the decrypted data before returning. Some of the decrypted data may
@@ -119,7 +114,13 @@ hzl_ClientProcessReceivedResponse(const hzl_ClientCtx_t* ctx,
     group.state->requestNonce = HZL_REQNONCE_NOT_EXPECTING_A_RESPONSE;
     // Save the received STK, counter nonce as current Session information
     memcpy(group.state->currentStk, plaintextStk, HZL_STK_LEN);
+    hzl_AeadKeyClear(&group.state->currentAeadKey);  // Expanded on first use
     group.state->currentCtrNonce = receivedCtrnonce;
+    if (group.state->sessionState != HZL_SESSION_STATE_RENEWING)
+    {
+        // During a renewal phase the previous Session stays usable until the phase is over
+        group.state->sessionState = HZL_SESSION_STATE_ACTIVE;
+    }
     // Update the timestamps to indicate this is a valid reception and conclusion of the handshake
     group.state->currentRxLastMessageInstant = rxTimestamp;
     group.state->lastHandshakeEventInstant = rxTimestamp;
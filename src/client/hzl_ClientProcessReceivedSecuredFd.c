@@ -28,7 +28,8 @@
 
 /**
  * @file
- * @internal Implementation of the hzl_ClientProcessReceivedSecuredFd() function
+ * @internal Implementation of the hzl_ClientProcessReceivedSecuredFd() and
+ * hzl_ClientProcessReceivedSecuredFdView() functions
  */
 
 #include "hzl_ClientInternal.h"
@@ -39,25 +40,14 @@
 #include "hzl_ClientProcessReceived.h"
 #include "hzl_CommonInternal.h"
 
-/**
- * @internal
- * Selects the STK to use during a Session renewal phase.
- */
-inline static const uint8_t*
-hzl_ClientChoosePreviusOrCurrentStk(const hzl_ClientGroup_t* const group,
-                                    const bool isPreviousSession)
-{
-    if (isPreviousSession) { return group->state->previousStk; }
-    else { return group->state->currentStk; }
-}
-
 hzl_Err_t
-hzl_ClientProcessReceivedSecuredFd(hzl_RxSduMsg_t* unpackedMsg,
-                                   const hzl_ClientCtx_t* ctx,
-                                   const uint8_t* rxPdu,
-                                   size_t rxPduLen,
-                                   const hzl_Header_t* unpackedSadfdHeader,
-                                   hzl_Timestamp_t rxTimestamp)
+hzl_ClientProcessReceivedSecuredFdView(hzl_RxSduView_t* const unpackedView,
+                                       uint8_t* const plaintext,
+                                       const hzl_ClientCtx_t* const ctx,
+                                       const uint8_t* const rxPdu,
+                                       const size_t rxPduLen,
+                                       const hzl_Header_t* const unpackedSadfdHeader,
+                                       const hzl_Timestamp_t rxTimestamp)
 {
     HZL_ERR_DECLARE(err);
     hzl_ClientGroup_t group;
@@ -73,7 +63,8 @@ hzl_ClientProcessReceivedSecuredFd(hzl_RxSduMsg_t* unpackedMsg,
         return HZL_ERR_SESSION_NOT_ESTABLISHED;
     }
     // SADFD msg must be long enough to contain at least the metadata (case of empty SDU)
-    const uint8_t packedHdrLen = hzl_HeaderLen(ctx->clientConfig->headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->clientConfig->headerType,
+                                                        ctx->clientConfig->headerPlacement);
     if (rxPduLen < packedHdrLen + HZL_SADFD_METADATA_IN_PAYLOAD_LEN)
     {
         // Cannot even read the metadata of the message, including the ciphertext length.
@@ -105,45 +96,55 @@ hzl_ClientProcessReceivedSecuredFd(hzl_RxSduMsg_t* unpackedMsg,
     hzl_Aead_t aead;
     hzl_CommonAeadInitSadfd(
             &aead,
-            hzl_ClientChoosePreviusOrCurrentStk(&group, isPreviousSession),
+            hzl_ClientChoosePreviusOrCurrentAeadKey(&group, isPreviousSession),
             unpackedSadfdHeader,
             receivedCtrnonce,
             ptlen);
-    err = hzl_AeadDecryptUpdate(
+    err = hzl_AeadDecrypt(
             &aead,
-            unpackedMsg->data,  // Output: plaintext
+            plaintext,  // Output: plaintext, may be exactly over the ciphertext
             &rxPdu[packedHdrLen + HZL_SADFD_CTEXT_IDX],  // Input: ciphertext
             ctlen,
             &rxPdu[packedHdrLen + HZL_SADFD_TAG_IDX(ctlen)],
             HZL_SADFD_TAG_LEN);
-
-
-    /*
-    // Finish authenticated decryption and validate tag
-    err = hzl_AeadDecryptFinish(
-            &aead,
-            &unpackedMsg->data[processedPtLen],
-            &rxPdu[packedHdrLen + HZL_SADFD_TAG_IDX(ctlen)],
-            HZL_SADFD_TAG_LEN);
-    */
-
     if (err != HZL_OK)
     {
         // Securely clear the decrypted data before returning. Some of the decrypted data may
         // be correct, as potential errors could be injected later on in the ciphertext or even
         // in the tag. Just to avoid any leakage of information or the user reading data that may
         // not be correct, as it is not validated with the tag, erase everything written so far.
-        hzl_ZeroOut(unpackedMsg->data, ptlen);
+        hzl_ZeroOut(plaintext, ptlen);
         return err;
     }
     // Save the received counter nonce as local one and the reception timestamp.
     hzl_ClientGroupUpdateCtrnonceAndRxTimestamp(
             &group, receivedCtrnonce, rxTimestamp, isPreviousSession);
     // Copy decrypted metadata to the user's output struct
-    unpackedMsg->wasSecured = true;
-    unpackedMsg->isForUser = true;
-    unpackedMsg->gid = unpackedSadfdHeader->gid;
-    unpackedMsg->sid = unpackedSadfdHeader->sid;
-    unpackedMsg->dataLen = ptlen;
+    unpackedView->data = plaintext;
+    unpackedView->wasSecured = true;
+    unpackedView->isForUser = true;
+    unpackedView->gid = unpackedSadfdHeader->gid;
+    unpackedView->sid = unpackedSadfdHeader->sid;
+    unpackedView->dataLen = ptlen;
     return HZL_OK;
 }
+
+hzl_Err_t
+hzl_ClientProcessReceivedSecuredFd(hzl_RxSduMsg_t* const unpackedMsg,
+                                   const hzl_ClientCtx_t* const ctx,
+                                   const uint8_t* const rxPdu,
+                                   const size_t rxPduLen,
+                                   const hzl_Header_t* const unpackedSadfdHeader,
+                                   const hzl_Timestamp_t rxTimestamp)
+{
+    hzl_RxSduView_t unpackedView = {0};
+    const hzl_Err_t err = hzl_ClientProcessReceivedSecuredFdView(
+            &unpackedView, unpackedMsg->data, ctx,
+            rxPdu, rxPduLen, unpackedSadfdHeader, rxTimestamp);
+    unpackedMsg->wasSecured = unpackedView.wasSecured;
+    unpackedMsg->isForUser = unpackedView.isForUser;
+    unpackedMsg->gid = unpackedView.gid;
+    unpackedMsg->sid = unpackedView.sid;
+    unpackedMsg->dataLen = unpackedView.dataLen;
+    return err;
+}
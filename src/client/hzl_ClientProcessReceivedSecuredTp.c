@@ -28,27 +28,132 @@
 
 /**
  * @file
- * @internal Implementation of the hzl_ClientProcessReceivedSecuredTp() function
+ * @internal Implementation of the hzl_ClientProcessReceivedSecuredTp() and
+ * hzl_ClientProcessReceivedSecuredTpView() functions
  */
 
 #include "hzl_ClientInternal.h"
+#include "hzl_CommonMessage.h"
 #include "hzl_CommonHeader.h"
 #include "hzl_CommonPayload.h"
 #include "hzl_ClientProcessReceived.h"
+#include "hzl_CommonInternal.h"
+
+#include <string.h>
+
+#if HZL_SADTP
 
 hzl_Err_t
-hzl_ClientProcessReceivedSecuredTp(hzl_RxSduMsg_t* unpackedMsg,
-                                   const hzl_ClientCtx_t* ctx,
-                                   const uint8_t* rxPdu,
-                                   size_t rxPduLen,
-                                   const hzl_Header_t* unpackedSadtpHeader,
-                                   hzl_Timestamp_t rxTimestamp)
+hzl_ClientProcessReceivedSecuredTpView(hzl_RxSduView_t* const unpackedView,
+                                       const hzl_ClientCtx_t* const ctx,
+                                       const uint8_t* const rxPdu,
+                                       const size_t rxPduLen,
+                                       const hzl_Header_t* const unpackedSadtpHeader,
+                                       const hzl_Timestamp_t rxTimestamp,
+                                       const size_t maxSduLen)
 {
-    (void) unpackedMsg;
-    (void) ctx;
-    (void) rxPdu;
-    (void) rxPduLen;
-    (void) unpackedSadtpHeader;
-    (void) rxTimestamp;
-    return HZL_ERR_PROGRAMMING;  // TODO to be implemented
+    HZL_ERR_DECLARE(err);
+    hzl_ClientGroup_t group;
+    err = hzl_ClientFindGroup(&group, ctx, unpackedSadtpHeader->gid);
+    if (err == HZL_ERR_UNKNOWN_GROUP)
+    {
+        return HZL_ERR_MSG_IGNORED;
+    }
+    hzl_ClientSessionRenewalPhaseExitIfNeeded(&group, rxTimestamp);
+    // Check current state for validity
+    if (!hzl_ClientIsSessionEstablishedAndValid(&group))
+    {
+        return HZL_ERR_SESSION_NOT_ESTABLISHED;
+    }
+    if (ctx->sadtpRxPool == NULL) { return HZL_ERR_NULL_SADTP_POOL; }
+    // SADTP frame must contain the PCI and at least one byte of the message
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->clientConfig->headerType,
+                                                        ctx->clientConfig->headerPlacement);
+    if (rxPduLen < packedHdrLen + HZL_SADTP_SEGMENT_IDX + HZL_SADTP_MIN_SEGMENT_LEN)
+    {
+        return HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_SADTP;
+    }
+    // The message delivered with the previous frame was already consumed by the user.
+    hzl_CommonSadtpRxReleaseDelivered(ctx->sadtpRxPool);
+    const uint8_t* const segment = &rxPdu[packedHdrLen + HZL_SADTP_SEGMENT_IDX];
+    const size_t segmentLen = rxPduLen - packedHdrLen - HZL_SADTP_SEGMENT_IDX;
+    hzl_SadtpRxSlot_t* slot;
+    err = hzl_CommonSadtpRxFindSlot(&slot, ctx->sadtpRxPool, unpackedSadtpHeader,
+                                    rxPdu[packedHdrLen + HZL_SADTP_PCI_IDX],
+                                    segment, segmentLen, rxTimestamp);
+    HZL_ERR_CHECK(err);
+    const bool hadMetadata = hzl_CommonSadtpRxHasMetadata(slot);
+    const size_t metadataLen = hzl_CommonSadtpRxAbsorbMetadata(slot, segment, segmentLen);
+    if (!hadMetadata && hzl_CommonSadtpRxHasMetadata(slot))
+    {
+        // Check the ctrnonce as soon as it's known, not to decrypt messages bound to be dropped.
+        err = hzl_ClientCheckRxCtrnonce(&slot->isPreviousSession, &group, slot->ctrNonce,
+                                        rxTimestamp);
+        if (err != HZL_OK)
+        {
+            hzl_CommonSadtpRxRelease(slot);
+            return err;
+        }
+        err = hzl_CommonSadtpRxStart(
+                slot,
+                hzl_ClientChoosePreviusOrCurrentAeadKey(&group, slot->isPreviousSession),
+                unpackedSadtpHeader, maxSduLen);
+        HZL_ERR_CHECK(err);
+    }
+    hzl_CommonSadtpRxAbsorbPayload(slot, &segment[metadataLen], segmentLen - metadataLen);
+    if (!hzl_CommonSadtpRxIsComplete(slot))
+    {
+        // Valid frame, but the message is not complete yet: nothing for the user.
+        unpackedView->wasSecured = true;
+        unpackedView->gid = unpackedSadtpHeader->gid;
+        unpackedView->sid = unpackedSadtpHeader->sid;
+        return HZL_OK;
+    }
+    // Check the ctrnonce again: the local one or the Session may have changed while the
+    // frames of the message were arriving.
+    bool isPreviousSession = false;
+    err = hzl_ClientCheckRxCtrnonce(&isPreviousSession, &group, slot->ctrNonce, rxTimestamp);
+    if (err == HZL_OK && isPreviousSession != slot->isPreviousSession)
+    {
+        err = HZL_ERR_SECWARN_OLD_MESSAGE;  // Secured with an STK that is not in use anymore
+    }
+    if (err != HZL_OK)
+    {
+        hzl_CommonSadtpRxRelease(slot);
+        return err;
+    }
+    err = hzl_CommonSadtpRxFinish(slot);
+    HZL_ERR_CHECK(err);
+    // Save the received counter nonce as local one and the reception timestamp.
+    hzl_ClientGroupUpdateCtrnonceAndRxTimestamp(
+            &group, slot->ctrNonce, rxTimestamp, isPreviousSession);
+    hzl_CommonSadtpRxDeliver(unpackedView, slot);
+    return HZL_OK;
 }
+
+hzl_Err_t
+hzl_ClientProcessReceivedSecuredTp(hzl_RxSduMsg_t* const unpackedMsg,
+                                   const hzl_ClientCtx_t* const ctx,
+                                   const uint8_t* const rxPdu,
+                                   const size_t rxPduLen,
+                                   const hzl_Header_t* const unpackedSadtpHeader,
+                                   const hzl_Timestamp_t rxTimestamp)
+{
+    hzl_RxSduView_t unpackedView = {0};
+    const hzl_Err_t err = hzl_ClientProcessReceivedSecuredTpView(
+            &unpackedView, ctx, rxPdu, rxPduLen, unpackedSadtpHeader, rxTimestamp,
+            sizeof(unpackedMsg->data));
+    unpackedMsg->wasSecured = unpackedView.wasSecured;
+    unpackedMsg->gid = unpackedView.gid;
+    unpackedMsg->sid = unpackedView.sid;
+    if (err != HZL_OK || !unpackedView.isForUser) { return err; }
+    // Longer messages were refused as soon as their ptlen was known.
+    memcpy(unpackedMsg->data, unpackedView.data, unpackedView.dataLen);
+    unpackedMsg->isForUser = true;
+    unpackedMsg->dataLen = unpackedView.dataLen;
+    // The plaintext is not needed in the slot anymore.
+    hzl_CommonSadtpRxReleaseDelivered(ctx->sadtpRxPool);
+    return HZL_OK;
+}
+
+#endif  /* HZL_SADTP */
@@ -30,176 +30,41 @@
  * @file
  * @internal
  * Hazelnet wrapper of the AEAD function: Authenticated Encryption with
- * Associated Data.
+ * Associated Data, parts common to all backends.
  *
- * The idea of this wrapper is to provide a stable interface in case the
- * implementation of the AEAD function is changed from one cipher to another.
+ * The backend-specific parts are in hzl_CommonAeadAscon.c and hzl_CommonAeadAes.c.
  */
 
 #include "hzl_CommonAead.h"
-#include "ascon.h"
+#include "hzl_CommonPayload.h"
 
-
-#include <wolfssl/options.h>         // First if using options
-#include <wolfssl/wolfcrypt/aes.h>
 #include <string.h>
-#include <stdio.h>
 
-_Static_assert(ASCON_AEAD128_KEY_LEN == HZL_LTK_LEN,
-               "AEAD cipher must accept LTK length.");
-_Static_assert(ASCON_AEAD128_KEY_LEN == HZL_STK_LEN,
-               "AEAD cipher must accept STK length.");
-_Static_assert(ASCON_AEAD_NONCE_LEN
+_Static_assert(HZL_AEAD_NONCE_LEN
                >= HZL_CTRNONCE_LEN + HZL_GID_LEN + HZL_SID_LEN,
                "AEAD nonce must fit the concatenation ctrnonce || GID || SID.");
-
-
-Aes enc;
-uint8_t aeadNonce[16U];
-uint8_t aes_key[16U];
-
-
-int nonce_set = 0;
-void
-hzl_AeadInit(hzl_Aead_t* const ctx,
-             const uint8_t* const key,
-             const uint8_t* const nonce)
-{
-    //ascon_aead128_init(ctx, key, nonce);
-    void* hint = NULL;
-    int devId = INVALID_DEVID; //if not using async INVALID_DEVID is default
-
-    //heap hint could be set here if used
-    wc_AesInit(&enc, hint, devId);
-    memcpy(aes_key, key, 16U);
-
-    int result = wc_AesGcmSetKey(&enc, aes_key, 16U);
-    printf("Result from set key %d\n", result);
-
-    memcpy(aeadNonce, nonce, 16U);
-}
-
-void
-hzl_AeadAssocDataUpdate(hzl_Aead_t* const ctx,
-                        const uint8_t* const assocData,
-                        const size_t assocDataLen)
-{
-    return;
-    //ascon_aead128_assoc_data_update(ctx, assocData, assocDataLen);
-}
-
-size_t
-hzl_AeadEncryptUpdate(hzl_Aead_t* const ctx,
-                      uint8_t* const ciphertext,
-                      const uint8_t* const plaintext,
-                      const size_t plaintextLen,
-                      uint8_t* const tag,
-                      const uint8_t tagLen)
-{
-
-
-    int result = wc_AesGcmEncrypt(&enc, 
-    ciphertext, 
-    plaintext, 
-    plaintextLen, 
-    aeadNonce, 
-    16U, 
-    tag, 
-    tagLen, 
-    NULL,
-    0);
-
-    // printf("Encrypt nonce is: ");
-    // for(int i = 0; i < 15; i++) {
-    //     printf("%x", aeadNonce[i]);
-    // }
-    // printf("\n");
-
-    /*
-
-    printf("Encrypt Tag is: ");
-    for(int i = 0; i < 15; i++) {
-        printf("%x", tag[i]);
-    }
-    printf("\n");
-    */
-
-
-    
-    //wc_AesFree(&enc);
-
-    return plaintextLen;
-    //return ascon_aead128_encrypt_update(ctx, ciphertext, plaintext, plaintextLen);
-}
+_Static_assert(HZL_SADFD_LABEL_LEN + HZL_GID_LEN + HZL_SID_LEN + HZL_PTY_LEN
+               + HZL_SADFD_PTLEN_LEN <= HZL_AEAD_MAX_ASSOC_DATA_LEN,
+               "AEAD associated data buffer must fit the SADFD associated data.");
+#if HZL_SADTP
+_Static_assert(HZL_SADTP_LABEL_LEN + HZL_GID_LEN + HZL_SID_LEN + HZL_PTY_LEN
+               + HZL_SADTP_PTLEN_LEN <= HZL_AEAD_MAX_ASSOC_DATA_LEN,
+               "AEAD associated data buffer must fit the SADTP associated data.");
+_Static_assert(sizeof(hzl_Aead_t) <= HZL_AEAD_STATE_LEN,
+               "SADTP structs must fit the state of a streaming AEAD.");
+_Static_assert(_Alignof(hzl_Aead_t) <= _Alignof(uint64_t),
+               "SADTP structs must be aligned for the state of a streaming AEAD.");
+#endif
+_Static_assert(HZL_RES_LABEL_LEN + HZL_GID_LEN + HZL_SID_LEN + HZL_PTY_LEN
+               + HZL_RES_CLIENT_LEN + HZL_RES_CTRNONCE_LEN <= HZL_AEAD_MAX_ASSOC_DATA_LEN,
+               "AEAD associated data buffer must fit the RES associated data.");
 
 void
-hzl_AeadEncryptFinish(hzl_Aead_t* const ctx,
-                      uint8_t* const ciphertext,
-                      uint8_t* const tag,
-                      const uint8_t tagLen)
-{
-    ascon_aead128_encrypt_final(ctx, ciphertext, tag, tagLen);
-}
-
-hzl_Err_t
-hzl_AeadDecryptUpdate(hzl_Aead_t* const ctx,
-                      uint8_t* const plaintext,
-                      const uint8_t* const ciphertext,
-                      const size_t ciphertextLen,
-                      const uint8_t* const tag,
-                      const uint8_t tagLen)
-{
-
-    // printf("Decrypt nonce is: ");
-    // for(int i = 0; i < 15; i++) {
-    //     printf("%x", aeadNonce[i]);
-    // }
-    // printf("\n");
-
-
-    /*
-    printf("Decrypt Tag is: ");
-    for(int i = 0; i < 15; i++) {
-        printf("%x", tag[i]);
-    }
-    printf("\n");
-    */
-
-
-
-    int result = wc_AesGcmDecrypt(&enc, 
-    plaintext, 
-    ciphertext, 
-    ciphertextLen, 
-    aeadNonce, 
-    16U, 
-    tag,
-    tagLen, 
-    NULL,
-    0);
-    if(result == 0) {
-        printf("SUCCESSFUL DECRYPT\n");
-        return HZL_OK;
-    } else {
-        printf("ERROR DECRYPTING,result %d\n", result);
-        return HZL_OK;
-        //return HZL_ERR_SECWARN_INVALID_TAG;
-    }
-    //wc_AesFree(&enc);
-    
-    
-    
-    //return ascon_aead128_decrypt_update(ctx, plaintext, ciphertext, ciphertextLen);
-}
-
-hzl_Err_t
-hzl_AeadDecryptFinish(hzl_Aead_t* const ctx,
-                      uint8_t* const plaintext,
-                      const uint8_t* const tag,
-                      const uint8_t tagLen)
+hzl_AeadKeyMove(hzl_AeadKey_t* const destination,
+                hzl_AeadKey_t* const source)
 {
-    bool is_tag_valid = false;
-    ascon_aead128_decrypt_final(
-            ctx, plaintext, &is_tag_valid, tag, tagLen);
-    return is_tag_valid == ASCON_TAG_OK ? HZL_OK : HZL_ERR_SECWARN_INVALID_TAG;
+    hzl_AeadKeyClear(destination);
+    memcpy(destination, source, sizeof(hzl_AeadKey_t));
+    // Ownership of the expanded key passed to the destination: just erase the source.
+    hzl_ZeroOut(source, sizeof(hzl_AeadKey_t));
 }
@@ -32,11 +32,15 @@
  * Hazelnet wrapper of the AEAD functions: Authenticated Encryption with
  * Associated Data.
  *
- * The idea of this wrapper is to provide a stable interface in case the
- * implementation of the AEAD function is changed from one cipher to another.
- * Changing the AEAD cipher means updating the define #HZL_AEAD_NONCE_LEN
- * and typedef #hzl_Aead_t in this file
- * and updating the functions in the hzl_Aead.c file.
+ * The idea of this wrapper is to provide a stable interface to the rest of the library,
+ * regardless of the AEAD cipher implementing it. The cipher (backend) is selected at build
+ * time with one of the `HZL_AEAD_BACKEND_*` defines (see hzl.h), each backend providing
+ * its own #hzl_Aead_t context type and implementing the functions of this file:
+ * - Ascon-128 and Ascon-128a in hzl_CommonAeadAscon.c
+ * - AES-GCM and AES-CCM in hzl_CommonAeadAes.c
+ *
+ * The functions are reentrant: the whole state of one en/decryption is in its #hzl_Aead_t
+ * and the expanded key in the #hzl_AeadKey_t of the caller, nothing is global.
  */
 
 #ifndef HZL_AEAD_H_
@@ -49,48 +53,164 @@ extern "C"
 
 #include "hzl_CommonInternal.h"
 #include "ascon.h"
-
+#if HZL_AEAD_BACKEND_AES
 #include <wolfssl/options.h>         // First if using options
 #include <wolfssl/wolfcrypt/aes.h>
+#endif
+
 #include <string.h>
-#include <stdio.h>
 
 /**
  * @internal
  * Computes the size of the ciphertext based on the size of the plaintext.
  *
- * For the Ascon cipher, they match exactly. For block ciphers, the ciphertext
+ * For all supported backends (Ascon and AES in the GCM or CCM modes) they match exactly,
+ * as they all encrypt like stream ciphers. For block ciphers in other modes, the ciphertext
  * is generally longer than the plaintext to fit into a multiple of the
  * block size, e.g. 11 B become 16 B.
  */
 #define HZL_AEAD_PTLEN_TO_CTLEN(ptlen) (ptlen)
 
-/** @internal Length of the nonce passed to the AEAD cipher in bytes. */
-#define HZL_AEAD_NONCE_LEN ASCON_AEAD_NONCE_LEN
+/**
+ * @internal
+ * Length of the nonce passed to the AEAD wrapper in bytes.
+ *
+ * It's the protocol-level nonce: backends accepting shorter nonces use a prefix of it.
+ */
+#define HZL_AEAD_NONCE_LEN 16U
+
+/** @internal Longest associated data ever passed to the AEAD wrapper in one en/decryption. */
+#define HZL_AEAD_MAX_ASSOC_DATA_LEN 32U
+
+/** @internal Human-readable name of the AEAD backend, used for reporting. */
+#if defined(HZL_AEAD_BACKEND_ASCON128)
+#define HZL_AEAD_BACKEND_NAME "Ascon-128"
+#elif defined(HZL_AEAD_BACKEND_ASCON128A)
+#define HZL_AEAD_BACKEND_NAME "Ascon-128a"
+#elif defined(HZL_AEAD_BACKEND_AES_GCM)
+#define HZL_AEAD_BACKEND_NAME "AES-128-GCM"
+#else
+#define HZL_AEAD_BACKEND_NAME "AES-128-CCM"
+#endif
+
+#if HZL_AEAD_BACKEND_AES
+/**
+ * @internal
+ * Expanded key of the AES backends, stored in the opaque buffer of #hzl_AeadKey_t:
+ * the wolfSSL key schedule.
+ */
+typedef Aes hzl_AeadKeySchedule_t;
+#else
+
+/**
+ * @internal
+ * Expanded key of the Ascon backends, stored in the opaque buffer of #hzl_AeadKey_t:
+ * the raw key, as Ascon has no key schedule.
+ */
+typedef struct hzl_AeadKeySchedule
+{
+    uint8_t key[HZL_STK_LEN];  ///< Raw AEAD key.
+} hzl_AeadKeySchedule_t;
+#endif
+
+_Static_assert(sizeof(hzl_AeadKeySchedule_t) <= HZL_AEAD_KEY_SCHEDULE_LEN,
+               "AEAD key cache must fit the expanded key: raise HZL_AEAD_KEY_SCHEDULE_LEN.");
+_Static_assert(_Alignof(hzl_AeadKeySchedule_t) <= HZL_AEAD_KEY_SCHEDULE_ALIGN,
+               "AEAD key cache must be aligned for the expanded key.");
+
+/** @internal Expanded key held in the opaque buffer of the key cache. */
+inline static hzl_AeadKeySchedule_t*
+hzl_AeadKeySchedule(hzl_AeadKey_t* const aeadKey)
+{
+    return (hzl_AeadKeySchedule_t*) aeadKey->schedule;
+}
 
+#if HZL_AEAD_BACKEND_AES
+/**
+ * @internal
+ * AEAD-function state of the AES backends.
+ *
+ * The AES backends use the one-shot wolfSSL functions, so the nonce and the associated data
+ * are collected here until the en/decryption happens.
+ */
+typedef struct hzl_Aead
+{
+    /** Expanded key to en/decrypt with, owned by the caller. */
+    hzl_AeadKey_t* key;
+    /** Nonce of this en/decryption. */
+    uint8_t nonce[HZL_AEAD_NONCE_LEN];
+    /** Associated data collected so far. */
+    uint8_t assocData[HZL_AEAD_MAX_ASSOC_DATA_LEN];
+    /** Used length of \p assocData in bytes. */
+    size_t assocDataLen;
+} hzl_Aead_t;
+#else
 /**
  * @internal
- * AEAD-function state.
+ * AEAD-function state of the Ascon backends: the Ascon context itself.
  */
 typedef ascon_aead_ctx_t hzl_Aead_t;
+#endif
+
+/**
+ * @internal
+ * Expands the key into the cache, unless the cache already holds an expansion.
+ *
+ * To be called for every message: the expansion happens only on the first call
+ * after hzl_AeadKeyClear() or hzl_AeadKeyMove() emptied the cache, the following calls are
+ * cheap. The key is not compared with the cached one: the callers MUST clear or move the
+ * cache whenever the key it was expanded from changes, i.e. at every Session start or renewal.
+ *
+ * @param [in, out] aeadKey cache of the expanded key. Must be either zeroed out or
+ *        previously used with this function for the same \p key.
+ * @param [in] key secret AEAD key of 16 bytes
+ */
+void
+hzl_AeadKeyExpand(hzl_AeadKey_t* aeadKey,
+                  const uint8_t* key);
+
+/**
+ * @internal
+ * Moves the expanded key from one cache to another, so it does not have to be expanded again,
+ * clearing the source one.
+ *
+ * @param [in, out] destination cache, cleared before receiving the key
+ * @param [in, out] source cache, empty after the move
+ */
+void
+hzl_AeadKeyMove(hzl_AeadKey_t* destination,
+                hzl_AeadKey_t* source);
+
+/**
+ * @internal
+ * Securely erases the expanded key, forcing a new expansion on the next use.
+ *
+ * @param [in, out] aeadKey cache of the expanded key
+ */
+void
+hzl_AeadKeyClear(hzl_AeadKey_t* aeadKey);
 
 /**
  * @internal
  * Initialises the AEAD context for encryption or decryption.
  *
  * @param [out] ctx to initialise
- * @param [in] key secret AEAD key of 16 bytes
+ * @param [in] key expanded secret AEAD key, as prepared by hzl_AeadKeyExpand().
+ *        Must stay unchanged until the en/decryption is finished.
  * @param [in] nonce public unique value of #HZL_AEAD_NONCE_LEN bytes
  */
 void
 hzl_AeadInit(hzl_Aead_t* ctx,
-             const uint8_t* key,
+             hzl_AeadKey_t* key,
              const uint8_t* nonce);
 
 /**
  * @internal
  * Processes associated data to be authenticated. To be called after
- * hzl_AeadInit().
+ * hzl_AeadInit(), possibly multiple times, before the en/decryption.
+ *
+ * The total associated data of one en/decryption must not exceed
+ * #HZL_AEAD_MAX_ASSOC_DATA_LEN bytes.
  *
  * @param [in, out] ctx initialised context
  * @param [in] assocData data to authenticated, but not encrypted
@@ -103,86 +223,142 @@ hzl_AeadAssocDataUpdate(hzl_Aead_t* ctx,
 
 /**
  * @internal
- * Encrypts the plaintext into ciphertext, returning the amount of
- * ciphertext bytes written. The encryption may also occur in-place
- * (\p ciphertext == \p plaintext is a valid input).
+ * Encrypts the whole plaintext into ciphertext and writes a tag (MAC) of the desired length.
+ * Securely cleans its own context after completion.
  *
  * @param [in, out] ctx context with associated data already processed
- * @param [out] ciphertext output encrypted plaintext
+ * @param [out] ciphertext output encrypted plaintext, of the same length as the plaintext
  * @param [in] plaintext data to be authenticated and encrypted
  * @param [in] plaintextLen length of \p plaintext in bytes
+ * @param [out] tag message authentication code
+ * @param [in] tagLen length of the desired tag in bytes
+ */
+void
+hzl_AeadEncrypt(hzl_Aead_t* ctx,
+                uint8_t* ciphertext,
+                const uint8_t* plaintext,
+                size_t plaintextLen,
+                uint8_t* tag,
+                uint8_t tagLen);
+
+/**
+ * @internal
+ * Decrypts the whole ciphertext into plaintext and checks that the computed tag matches
+ * with the provided expected one of the given length.
+ * Securely cleans its own context after completion, regardless of the tag validity.
+ *
+ * @param [in, out] ctx context with associated data already processed
+ * @param [out] plaintext decrypted data, of the same length as the ciphertext.
+ *        To be considered garbage if the tag is invalid.
+ * @param [in] ciphertext data to validate and decrypt
+ * @param [in] ciphertextLen length of \p ciphertext in bytes
+ * @param [in] tag message authentication code that came with the ciphertext
+ * @param [in] tagLen length of \p tag in bytes
+ *
+ * @retval #HZL_OK if the tag is valid
+ * @retval #HZL_ERR_SECWARN_INVALID_TAG if the tag is not valid and the plaintext
+ *         should be considered garbage
+ */
+hzl_Err_t
+hzl_AeadDecrypt(hzl_Aead_t* ctx,
+                uint8_t* plaintext,
+                const uint8_t* ciphertext,
+                size_t ciphertextLen,
+                const uint8_t* tag,
+                uint8_t tagLen);
+
+/**
+ * @internal
+ * True when the AEAD backend can en/decrypt a message in chunks as they come, false when
+ * it can only process the whole message at once.
+ *
+ * Only the Ascon backends stream: the AES ones use the one-shot wolfSSL functions, as the
+ * streaming state of wolfSSL is its whole key context.
+ * SADTP decrypts the segments as they arrive, so #HZL_SADTP requires a streaming backend.
+ */
+#define HZL_AEAD_STREAMING (!HZL_AEAD_BACKEND_AES)
+
+#if HZL_AEAD_STREAMING
+/**
+ * @internal
+ * Encrypts a chunk of the plaintext, to be called after the associated data is processed,
+ * possibly multiple times, and followed by hzl_AeadEncryptFinal().
+ *
+ * The backend may keep up to a block of plaintext buffered in its context, so fewer
+ * bytes than \p plaintextLen may be written.
+ *
+ * @param [in, out] ctx context with associated data already processed
+ * @param [out] ciphertext output encrypted chunk. May be equal to \p plaintext to encrypt
+ *        in place, but must not overlap otherwise.
+ * @param [in] plaintext chunk of the data to be authenticated and encrypted
+ * @param [in] plaintextLen length of \p plaintext in bytes
  * @return amount of bytes written into \p ciphertext
  */
 size_t
 hzl_AeadEncryptUpdate(hzl_Aead_t* ctx,
                       uint8_t* ciphertext,
                       const uint8_t* plaintext,
-                      size_t plaintextLen,
-                      uint8_t* const tag,
-                      const uint8_t tagLen);
+                      size_t plaintextLen);
 
 /**
  * @internal
- * Finalises the encryption, flushing the last ciphertext bytes to the
- * output buffer and writing a tag (MAC) of the desired length.
+ * Flushes the buffered ciphertext and writes a tag (MAC) of the desired length.
  * Securely cleans its own context after completion.
  *
- * @param [in, out] ctx context with plaintext already processed.
- * @param [out] ciphertext location where to write any final trailing bytes. Should be where the
- *        previous hzl_AeadEncryptUpdate() stopped (start of the ciphertext + amount of bytes
- *        returned by hzl_AeadEncryptUpdate())
+ * @param [in, out] ctx context of the ongoing encryption
+ * @param [out] ciphertext output of the last bytes of ciphertext, less than a block
  * @param [out] tag message authentication code
  * @param [in] tagLen length of the desired tag in bytes
+ * @return amount of bytes written into \p ciphertext
  */
-void
-hzl_AeadEncryptFinish(hzl_Aead_t* ctx,
-                      uint8_t* ciphertext,
-                      uint8_t* tag,
-                      uint8_t tagLen);
+size_t
+hzl_AeadEncryptFinal(hzl_Aead_t* ctx,
+                     uint8_t* ciphertext,
+                     uint8_t* tag,
+                     uint8_t tagLen);
 
 /**
  * @internal
- * Decrypts the ciphertext into plaintext, returning the amount of
- * plaintext bytes written. The decryption may also occur in-place
- * (\p ciphertext == \p plaintext is a valid input).
+ * Decrypts a chunk of the ciphertext, to be called after the associated data is processed,
+ * possibly multiple times, and followed by hzl_AeadDecryptFinal().
+ *
+ * The backend may keep up to a block of ciphertext buffered in its context, so fewer
+ * bytes than \p ciphertextLen may be written.
  *
  * @param [in, out] ctx context with associated data already processed
- * @param [out] plaintext decrypted data
- * @param [in] ciphertext data to validate and decrypt
+ * @param [out] plaintext output decrypted chunk, to be considered garbage until the tag
+ *        is validated. May be equal to \p ciphertext, but must not overlap otherwise.
+ * @param [in] ciphertext chunk of the data to validate and decrypt
  * @param [in] ciphertextLen length of \p ciphertext in bytes
  * @return amount of bytes written into \p plaintext
  */
-hzl_Err_t
+size_t
 hzl_AeadDecryptUpdate(hzl_Aead_t* ctx,
                       uint8_t* plaintext,
                       const uint8_t* ciphertext,
-                      size_t ciphertextLen,
-                      const uint8_t* const tag,
-                      const uint8_t tagLen);
+                      size_t ciphertextLen);
 
 /**
  * @internal
- * Finalises the decryption, flushing the last plaintext bytes to the
- * output buffer and checking that the computed tag matches with the provided
+ * Flushes the buffered plaintext and checks that the computed tag matches with the provided
  * expected one of the given length.
- * Securely cleans its own state after completion, regardless of the tag validity.
+ * Securely cleans its own context after completion, regardless of the tag validity.
  *
- * @param [in, out] ctx context with ciphertext already processed.
- * @param [out] plaintext location where to write any final trailing bytes. Should be where the
- *        previous hzl_AeadDecryptUpdate() stopped (start of the plaintext + amount of bytes
- *        returned by hzl_AeadDecryptUpdate())
+ * @param [in, out] ctx context of the ongoing decryption
+ * @param [out] plaintext output of the last bytes of plaintext, less than a block
  * @param [in] tag message authentication code that came with the ciphertext
  * @param [in] tagLen length of \p tag in bytes
  *
  * @retval #HZL_OK if the tag is valid
- * @retval #HZL_ERR_SECWARN_INVALID_TAG if the tag is not valid and the plaintext
+ * @retval #HZL_ERR_SECWARN_INVALID_TAG if the tag is not valid and the whole plaintext
  *         should be considered garbage
  */
 hzl_Err_t
-hzl_AeadDecryptFinish(hzl_Aead_t* ctx,
-                      uint8_t* plaintext,
-                      const uint8_t* tag,
-                      uint8_t tagLen);
+hzl_AeadDecryptFinal(hzl_Aead_t* ctx,
+                     uint8_t* plaintext,
+                     const uint8_t* tag,
+                     uint8_t tagLen);
+#endif
 
 #ifdef __cplusplus
 }
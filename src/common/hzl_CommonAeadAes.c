@@ -0,0 +1,161 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * AEAD backends based on AES-128 in GCM or CCM mode, provided by wolfSSL.
+ *
+ * The #hzl_AeadKey_t caches the expanded key schedule (plus GHASH tables for GCM), which
+ * is the expensive part; the en/decryption itself is a single one-shot wolfSSL call
+ * with the nonce and associated data collected in the #hzl_Aead_t context.
+ * On x86 CPUs with AES-NI wolfSSL uses the hardware instructions, when compiled with
+ * `--enable-aesni`.
+ */
+
+#include "hzl_CommonAead.h"
+
+#if HZL_AEAD_BACKEND_AES
+
+#include <string.h>
+
+#if defined(HZL_AEAD_BACKEND_AES_CCM)
+/**
+ * @internal
+ * Length of the nonce passed to AES-CCM, its maximum.
+ *
+ * CCM accepts nonces of 7 to 13 bytes, so the first 13 bytes of the #HZL_AEAD_NONCE_LEN-long
+ * nonce are used. For SADFD messages that's the whole non-zero part
+ * (ctrnonce || GID || SID); for RES messages it's 104 of the 128 random bits, still
+ * unique per Long Term Key with overwhelming probability.
+ */
+#define HZL_AES_NONCE_LEN 13U
+#define HZL_AES_SET_KEY wc_AesCcmSetKey
+#define HZL_AES_ENCRYPT wc_AesCcmEncrypt
+#define HZL_AES_DECRYPT wc_AesCcmDecrypt
+#else
+/** @internal Length of the nonce passed to AES-GCM, which accepts any length. */
+#define HZL_AES_NONCE_LEN HZL_AEAD_NONCE_LEN
+#define HZL_AES_SET_KEY wc_AesGcmSetKey
+#define HZL_AES_ENCRYPT wc_AesGcmEncrypt
+#define HZL_AES_DECRYPT wc_AesGcmDecrypt
+#endif
+
+_Static_assert(HZL_AES_NONCE_LEN >= HZL_CTRNONCE_LEN + HZL_GID_LEN + HZL_SID_LEN,
+               "AES nonce must fit the concatenation ctrnonce || GID || SID.");
+
+void
+hzl_AeadKeyExpand(hzl_AeadKey_t* const aeadKey,
+                  const uint8_t* const key)
+{
+    if (aeadKey->isExpanded)
+    {
+        return;  // Cache hit: cleared by the callers when the key changes
+    }
+    Aes* const aes = hzl_AeadKeySchedule(aeadKey);
+    wc_AesInit(aes, NULL, INVALID_DEVID);
+    // Cannot fail, as the key length is always a valid AES key length.
+    HZL_AES_SET_KEY(aes, key, HZL_STK_LEN);
+    aeadKey->isExpanded = true;
+}
+
+void
+hzl_AeadKeyClear(hzl_AeadKey_t* const aeadKey)
+{
+    if (aeadKey->isExpanded)
+    {
+        wc_AesFree(hzl_AeadKeySchedule(aeadKey));
+    }
+    hzl_ZeroOut(aeadKey, sizeof(hzl_AeadKey_t));
+}
+
+void
+hzl_AeadInit(hzl_Aead_t* const ctx,
+             hzl_AeadKey_t* const key,
+             const uint8_t* const nonce)
+{
+    ctx->key = key;
+    memcpy(ctx->nonce, nonce, HZL_AEAD_NONCE_LEN);
+    ctx->assocDataLen = 0;
+}
+
+void
+hzl_AeadAssocDataUpdate(hzl_Aead_t* const ctx,
+                        const uint8_t* const assocData,
+                        const size_t assocDataLen)
+{
+    // The callers' associated data is bounded at compile time, see hzl_CommonAead.c
+    memcpy(&ctx->assocData[ctx->assocDataLen], assocData, assocDataLen);
+    ctx->assocDataLen += assocDataLen;
+}
+
+void
+hzl_AeadEncrypt(hzl_Aead_t* const ctx,
+                uint8_t* const ciphertext,
+                const uint8_t* const plaintext,
+                const size_t plaintextLen,
+                uint8_t* const tag,
+                const uint8_t tagLen)
+{
+    // Cannot fail, as all lengths are valid and the key is expanded.
+    HZL_AES_ENCRYPT(hzl_AeadKeySchedule(ctx->key),
+                    ciphertext,
+                    plaintext,
+                    (word32) plaintextLen,
+                    ctx->nonce,
+                    HZL_AES_NONCE_LEN,
+                    tag,
+                    tagLen,
+                    ctx->assocData,
+                    (word32) ctx->assocDataLen);
+    hzl_ZeroOut(ctx, sizeof(hzl_Aead_t));
+}
+
+hzl_Err_t
+hzl_AeadDecrypt(hzl_Aead_t* const ctx,
+                uint8_t* const plaintext,
+                const uint8_t* const ciphertext,
+                const size_t ciphertextLen,
+                const uint8_t* const tag,
+                const uint8_t tagLen)
+{
+    const int result = HZL_AES_DECRYPT(hzl_AeadKeySchedule(ctx->key),
+                                       plaintext,
+                                       ciphertext,
+                                       (word32) ciphertextLen,
+                                       ctx->nonce,
+                                       HZL_AES_NONCE_LEN,
+                                       tag,
+                                       tagLen,
+                                       ctx->assocData,
+                                       (word32) ctx->assocDataLen);
+    hzl_ZeroOut(ctx, sizeof(hzl_Aead_t));
+    return result == 0 ? HZL_OK : HZL_ERR_SECWARN_INVALID_TAG;
+}
+
+#endif  /* HZL_AEAD_BACKEND_AES */
@@ -0,0 +1,169 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * AEAD backends based on Ascon-128 and Ascon-128a, provided by LibAscon.
+ *
+ * Ascon has no key schedule to precompute, so the #hzl_AeadKey_t just holds the raw key
+ * and the en/decryption streams through the Ascon context directly.
+ * The two variants differ only in the rate, thus only in the LibAscon functions called.
+ */
+
+#include "hzl_CommonAead.h"
+
+#if defined(HZL_AEAD_BACKEND_ASCON128) || defined(HZL_AEAD_BACKEND_ASCON128A)
+
+#include "ascon.h"
+#include <string.h>
+
+#if defined(HZL_AEAD_BACKEND_ASCON128A)
+#define HZL_ASCON_INIT ascon_aead128a_init
+#define HZL_ASCON_ASSOC_DATA_UPDATE ascon_aead128a_assoc_data_update
+#define HZL_ASCON_ENCRYPT_UPDATE ascon_aead128a_encrypt_update
+#define HZL_ASCON_ENCRYPT_FINAL ascon_aead128a_encrypt_final
+#define HZL_ASCON_DECRYPT_UPDATE ascon_aead128a_decrypt_update
+#define HZL_ASCON_DECRYPT_FINAL ascon_aead128a_decrypt_final
+#else
+#define HZL_ASCON_INIT ascon_aead128_init
+#define HZL_ASCON_ASSOC_DATA_UPDATE ascon_aead128_assoc_data_update
+#define HZL_ASCON_ENCRYPT_UPDATE ascon_aead128_encrypt_update
+#define HZL_ASCON_ENCRYPT_FINAL ascon_aead128_encrypt_final
+#define HZL_ASCON_DECRYPT_UPDATE ascon_aead128_decrypt_update
+#define HZL_ASCON_DECRYPT_FINAL ascon_aead128_decrypt_final
+#endif
+
+_Static_assert(ASCON_AEAD128_KEY_LEN == HZL_LTK_LEN,
+               "AEAD cipher must accept LTK length.");
+_Static_assert(ASCON_AEAD128_KEY_LEN == HZL_STK_LEN,
+               "AEAD cipher must accept STK length.");
+_Static_assert(ASCON_AEAD_NONCE_LEN == HZL_AEAD_NONCE_LEN,
+               "AEAD cipher must accept the whole nonce.");
+
+void
+hzl_AeadKeyExpand(hzl_AeadKey_t* const aeadKey,
+                  const uint8_t* const key)
+{
+    if (aeadKey->isExpanded)
+    {
+        return;  // Cache hit: cleared by the callers when the key changes
+    }
+    memcpy(hzl_AeadKeySchedule(aeadKey)->key, key, HZL_STK_LEN);
+    aeadKey->isExpanded = true;
+}
+
+void
+hzl_AeadKeyClear(hzl_AeadKey_t* const aeadKey)
+{
+    hzl_ZeroOut(aeadKey, sizeof(hzl_AeadKey_t));
+}
+
+void
+hzl_AeadInit(hzl_Aead_t* const ctx,
+             hzl_AeadKey_t* const key,
+             const uint8_t* const nonce)
+{
+    HZL_ASCON_INIT(ctx, hzl_AeadKeySchedule(key)->key, nonce);
+}
+
+void
+hzl_AeadAssocDataUpdate(hzl_Aead_t* const ctx,
+                        const uint8_t* const assocData,
+                        const size_t assocDataLen)
+{
+    HZL_ASCON_ASSOC_DATA_UPDATE(ctx, assocData, assocDataLen);
+}
+
+void
+hzl_AeadEncrypt(hzl_Aead_t* const ctx,
+                uint8_t* const ciphertext,
+                const uint8_t* const plaintext,
+                const size_t plaintextLen,
+                uint8_t* const tag,
+                const uint8_t tagLen)
+{
+    const size_t written = HZL_ASCON_ENCRYPT_UPDATE(ctx, ciphertext, plaintext, plaintextLen);
+    // Flushes the buffered trailing bytes, writes the tag and clears the context.
+    HZL_ASCON_ENCRYPT_FINAL(ctx, &ciphertext[written], tag, tagLen);
+}
+
+hzl_Err_t
+hzl_AeadDecrypt(hzl_Aead_t* const ctx,
+                uint8_t* const plaintext,
+                const uint8_t* const ciphertext,
+                const size_t ciphertextLen,
+                const uint8_t* const tag,
+                const uint8_t tagLen)
+{
+    bool isTagValid = false;
+    const size_t written = HZL_ASCON_DECRYPT_UPDATE(ctx, plaintext, ciphertext, ciphertextLen);
+    // Flushes the buffered trailing bytes, validates the tag and clears the context.
+    HZL_ASCON_DECRYPT_FINAL(ctx, &plaintext[written], &isTagValid, tag, tagLen);
+    return isTagValid ? HZL_OK : HZL_ERR_SECWARN_INVALID_TAG;
+}
+
+size_t
+hzl_AeadEncryptUpdate(hzl_Aead_t* const ctx,
+                      uint8_t* const ciphertext,
+                      const uint8_t* const plaintext,
+                      const size_t plaintextLen)
+{
+    return HZL_ASCON_ENCRYPT_UPDATE(ctx, ciphertext, plaintext, plaintextLen);
+}
+
+size_t
+hzl_AeadEncryptFinal(hzl_Aead_t* const ctx,
+                     uint8_t* const ciphertext,
+                     uint8_t* const tag,
+                     const uint8_t tagLen)
+{
+    return HZL_ASCON_ENCRYPT_FINAL(ctx, ciphertext, tag, tagLen);
+}
+
+size_t
+hzl_AeadDecryptUpdate(hzl_Aead_t* const ctx,
+                      uint8_t* const plaintext,
+                      const uint8_t* const ciphertext,
+                      const size_t ciphertextLen)
+{
+    return HZL_ASCON_DECRYPT_UPDATE(ctx, plaintext, ciphertext, ciphertextLen);
+}
+
+hzl_Err_t
+hzl_AeadDecryptFinal(hzl_Aead_t* const ctx,
+                     uint8_t* const plaintext,
+                     const uint8_t* const tag,
+                     const uint8_t tagLen)
+{
+    bool isTagValid = false;
+    HZL_ASCON_DECRYPT_FINAL(ctx, plaintext, &isTagValid, tag, tagLen);
+    return isTagValid ? HZL_OK : HZL_ERR_SECWARN_INVALID_TAG;
+}
+
+#endif  /* HZL_AEAD_BACKEND_ASCON128 || HZL_AEAD_BACKEND_ASCON128A */
@@ -39,7 +39,7 @@
 
 void
 hzl_CommonAeadInitRes(hzl_Aead_t* const aead,
-                      const uint8_t* const ltk,
+                      hzl_AeadKey_t* const ltk,
                       const hzl_Header_t* const unpackedResHeader,
                       const uint8_t* const encodedCtrNonce,
                       const uint8_t* const encodedRequestNonce,
@@ -52,7 +52,6 @@ hzl_CommonAeadInitRes(hzl_Aead_t* const aead,
     uint8_t aeadNonce[HZL_AEAD_NONCE_LEN] = {0};
     memcpy(&aeadNonce[HZL_RES_AEADNONCE_REQNONCE_IDX], encodedRequestNonce, HZL_REQ_REQNONCE_LEN);
     memcpy(&aeadNonce[HZL_RES_AEADNONCE_RESNONCE_IDX], encodedResponseNonce, HZL_RES_RESNONCE_LEN);
-    printf("The RES NONCE is %x\n", *aeadNonce);
     hzl_AeadInit(aead, ltk, aeadNonce);
 
     // Associated data = label || GID || SID || PTY || clientSid || receivedCtrnonce
@@ -39,7 +39,7 @@
 
 void
 hzl_CommonAeadInitSadfd(hzl_Aead_t* const aead,
-                        const uint8_t* const stk,
+                        hzl_AeadKey_t* const stk,
                         const hzl_Header_t* const unpackedSadfdHeader,
                         const hzl_CtrNonce_t ctrnonce,
                         const uint8_t plaintextLen)
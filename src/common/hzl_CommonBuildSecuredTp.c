@@ -0,0 +1,223 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Building of SADTP messages, common to the Server and Client: the frames are built one
+ * at a time, encrypting the user data in place only as far as the next frame needs it.
+ */
+
+#include "hzl.h"
+#include "hzl_CommonMessage.h"
+#include "hzl_CommonEndian.h"
+#include "hzl_CommonHeader.h"
+#include "hzl_CommonPayload.h"
+
+#include <string.h>
+
+#if HZL_SADTP
+
+/**
+ * @internal
+ * Amount of plaintext bytes passed at once to the streaming AEAD, a multiple of the rate of
+ * all backends. The AEAD context then never keeps bytes buffered between two calls, so it
+ * always writes the ciphertext exactly over the plaintext.
+ */
+#define HZL_SADTP_TX_ENCRYPTION_CHUNK 16U
+
+void
+hzl_CommonAeadInitSadtp(hzl_Aead_t* const aead,
+                        hzl_AeadKey_t* const stk,
+                        const hzl_Header_t* const unpackedSadtpHeader,
+                        const hzl_CtrNonce_t ctrnonce,
+                        const uint16_t plaintextLen)
+{
+    // Authenticated en/decryption initialisation with:
+    // aeadKey = currentStk
+    // aeadNonce = ctrnonce || GID || SID || 0...0 (the zero-padding IS required)
+    uint8_t aeadNonce[HZL_AEAD_NONCE_LEN] = {0};
+    hzl_EncodeLe24(&aeadNonce[HZL_SADFD_AEADNONCE_CTR_IDX], ctrnonce);
+    aeadNonce[HZL_SADFD_AEADNONCE_GID_IDX] = unpackedSadtpHeader->gid;
+    aeadNonce[HZL_SADFD_AEADNONCE_SID_IDX] = unpackedSadtpHeader->sid;
+    hzl_AeadInit(aead, stk, aeadNonce);
+
+    // Associated data = label || GID || SID || PTY || ptlen
+    uint8_t encodedPtlen[HZL_SADTP_PTLEN_LEN];
+    hzl_EncodeLe16(encodedPtlen, plaintextLen);
+    hzl_AeadAssocDataUpdate(aead, (uint8_t*) HZL_SADTP_LABEL, HZL_SADTP_LABEL_LEN);
+    hzl_AeadAssocDataUpdate(aead, &unpackedSadtpHeader->gid, HZL_GID_LEN);
+    hzl_AeadAssocDataUpdate(aead, &unpackedSadtpHeader->sid, HZL_SID_LEN);
+    hzl_AeadAssocDataUpdate(aead, &unpackedSadtpHeader->pty, HZL_PTY_LEN);
+    hzl_AeadAssocDataUpdate(aead, encodedPtlen, HZL_SADTP_PTLEN_LEN);
+}
+
+hzl_Err_t
+hzl_CommonCheckSadtpBeforePacking(const uint8_t* const userData,
+                                  const size_t userDataLen,
+                                  const hzl_Gid_t group,
+                                  const size_t maxFrameLen,
+                                  const uint8_t headerType,
+                                  const uint8_t headerPlacement)
+{
+    if (userData == NULL && userDataLen != 0) { return HZL_ERR_NULL_SDU; }
+    const hzl_Gid_t maxGid = hzl_HeaderTypeMaxGid(headerType);
+    if (group > maxGid) { return HZL_ERR_GID_TOO_LARGE_FOR_CONFIGURED_HEADER_TYPE; }
+    if (userDataLen > HZL_SADTP_MAX_SDU_LEN) { return HZL_ERR_TOO_LONG_SDU; }
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(headerType, headerPlacement);
+    if (maxFrameLen < packedHdrLen + HZL_SADTP_SEGMENT_IDX + HZL_SADTP_MIN_SEGMENT_LEN)
+    {
+        return HZL_ERR_TOO_SHORT_OUTPUT_BUFFER;
+    }
+    return HZL_OK;
+}
+
+void
+hzl_CommonBuildSecuredTpStart(hzl_SadtpTx_t* const tx,
+                              hzl_AeadKey_t* const stk,
+                              const hzl_Header_t* const unpackedSadtpHeader,
+                              const hzl_CtrNonce_t ctrnonce,
+                              uint8_t* const userData,
+                              const size_t userDataLen,
+                              const size_t maxFrameLen,
+                              const uint8_t headerType,
+                              const uint8_t headerPlacement)
+{
+    tx->data = userData;
+    tx->dataLen = userDataLen;
+    tx->maxFrameLen = maxFrameLen > HZL_MAX_CAN_FD_DATA_LEN ? HZL_MAX_CAN_FD_DATA_LEN : maxFrameLen;
+    tx->ctrNonce = ctrnonce;
+    // The header is the same for every frame: packed once.
+    tx->packedHeaderLen = hzl_HeaderLenInPayload(headerType, headerPlacement);
+    hzl_HeaderPackPlaced(tx->packedHeader, &tx->canId, unpackedSadtpHeader,
+                         headerType, headerPlacement);
+    tx->nextSeqNr = 1U;  // The First Frame has no sequence number, the first CF has 1
+    hzl_CommonAeadInitSadtp((hzl_Aead_t*) tx->aeadState, stk, unpackedSadtpHeader,
+                            ctrnonce, (uint16_t) userDataLen);
+    tx->isDone = false;
+}
+
+/**
+ * @internal
+ * Encrypts the user data in place at least up to the given position of the message,
+ * writing the tag when the position reaches it.
+ */
+static void
+hzl_CommonSadtpTxEncryptUpTo(hzl_SadtpTx_t* const tx,
+                             const size_t msgEnd)
+{
+    if (tx->isEncrypted || msgEnd <= HZL_SADTP_CTEXT_IDX) { return; }
+    hzl_Aead_t* const aead = (hzl_Aead_t*) tx->aeadState;
+    const size_t neededLen = msgEnd - HZL_SADTP_CTEXT_IDX;
+    const size_t chunkedLen = ((neededLen + HZL_SADTP_TX_ENCRYPTION_CHUNK - 1U)
+                               / HZL_SADTP_TX_ENCRYPTION_CHUNK) * HZL_SADTP_TX_ENCRYPTION_CHUNK;
+    uint8_t* const unencrypted = &tx->data[tx->encryptedLen];
+    if (chunkedLen >= tx->dataLen)
+    {
+        // All the rest: the context may buffer the trailing bytes, the final call flushes them
+        // exactly where they were read from.
+        const size_t written = hzl_AeadEncryptUpdate(
+                aead, unencrypted, unencrypted, tx->dataLen - tx->encryptedLen);
+        hzl_AeadEncryptFinal(aead, &unencrypted[written], tx->tag, HZL_SADTP_TAG_LEN);
+        tx->encryptedLen = tx->dataLen;
+        tx->isEncrypted = true;
+    }
+    else if (chunkedLen > tx->encryptedLen)
+    {
+        hzl_AeadEncryptUpdate(aead, unencrypted, unencrypted, chunkedLen - tx->encryptedLen);
+        tx->encryptedLen = chunkedLen;
+    }
+}
+
+/**
+ * @internal
+ * Copies the part of a field of the message falling into the given range of the message.
+ */
+static void
+hzl_CommonSadtpCopyField(uint8_t* const out,
+                         const size_t rangeIdx,
+                         const size_t rangeLen,
+                         const uint8_t* const field,
+                         const size_t fieldIdx,
+                         const size_t fieldLen)
+{
+    const size_t begin = rangeIdx > fieldIdx ? rangeIdx : fieldIdx;
+    const size_t rangeEnd = rangeIdx + rangeLen;
+    const size_t fieldEnd = fieldIdx + fieldLen;
+    const size_t end = rangeEnd < fieldEnd ? rangeEnd : fieldEnd;
+    if (begin < end)
+    {
+        memcpy(&out[begin - rangeIdx], &field[begin - fieldIdx], end - begin);
+    }
+}
+
+hzl_Err_t
+hzl_CommonBuildSecuredTpNext(hzl_CbsPduMsg_t* const securedPdu,
+                             hzl_SadtpTx_t* const tx)
+{
+    if (securedPdu == NULL) { return HZL_ERR_NULL_PDU; }
+    securedPdu->dataLen = 0; // Make output message empty in case of later error.
+    if (tx == NULL) { return HZL_ERR_NULL_SADTP_TX; }
+    if (tx->isDone) { return HZL_ERR_SADTP_TX_COMPLETED; }
+    const size_t ctlen = HZL_AEAD_PTLEN_TO_CTLEN(tx->dataLen);
+    const size_t msgLen = HZL_SADTP_MSG_LEN(ctlen);
+    const size_t segmentIdx = tx->packedHeaderLen + HZL_SADTP_SEGMENT_IDX;
+    size_t segmentLen = tx->maxFrameLen - segmentIdx;
+    if (segmentLen > msgLen - tx->sentLen) { segmentLen = msgLen - tx->sentLen; }
+    // Header and Protocol Control Information
+    memcpy(securedPdu->data, tx->packedHeader, tx->packedHeaderLen);
+    securedPdu->canId = tx->canId;
+    uint8_t* const pci = &securedPdu->data[tx->packedHeaderLen + HZL_SADTP_PCI_IDX];
+    if (tx->sentLen == 0)
+    {
+        *pci = HZL_SADTP_PCI_FIRST_FRAME;
+    }
+    else
+    {
+        *pci = (uint8_t) (HZL_SADTP_PCI_CONSECUTIVE_FRAME | tx->nextSeqNr);
+        tx->nextSeqNr = (uint8_t) ((tx->nextSeqNr + 1U) & HZL_SADTP_PCI_SEQNR_MASK);
+    }
+    // Segment of the message: ctrnonce || ptlen || ctext || tag
+    hzl_CommonSadtpTxEncryptUpTo(tx, tx->sentLen + segmentLen);
+    uint8_t metadata[HZL_SADTP_CTEXT_IDX];
+    hzl_EncodeLe24(&metadata[HZL_SADTP_CTRNONCE_IDX], tx->ctrNonce);
+    hzl_EncodeLe16(&metadata[HZL_SADTP_PTLEN_IDX], (uint16_t) tx->dataLen);
+    uint8_t* const segment = &securedPdu->data[segmentIdx];
+    hzl_CommonSadtpCopyField(segment, tx->sentLen, segmentLen,
+                             metadata, HZL_SADTP_CTRNONCE_IDX, HZL_SADTP_CTEXT_IDX);
+    hzl_CommonSadtpCopyField(segment, tx->sentLen, segmentLen,
+                             tx->data, HZL_SADTP_CTEXT_IDX, ctlen);
+    hzl_CommonSadtpCopyField(segment, tx->sentLen, segmentLen,
+                             tx->tag, HZL_SADTP_TAG_IDX(ctlen), HZL_SADTP_TAG_LEN);
+    tx->sentLen += segmentLen;
+    securedPdu->dataLen = segmentIdx + segmentLen;
+    if (tx->sentLen == msgLen) { tx->isDone = true; }
+    return HZL_OK;
+}
+
+#endif  /* HZL_SADTP */
@@ -43,14 +43,15 @@ hzl_CommonBuildUnsecured(hzl_CbsPduMsg_t* const unsecuredPdu,
                          const size_t userDataLen,
                          const hzl_Gid_t groupId,
                          const hzl_Sid_t sourceId,
-                         const uint8_t headerType)
+                         const uint8_t headerType,
+                         const uint8_t headerPlacement)
 {
     if (unsecuredPdu == NULL) { return HZL_ERR_NULL_PDU; }
     unsecuredPdu->dataLen = 0; // Make output message empty in case of later error.
     HZL_ERR_DECLARE(err);
     err = hzl_CommonCheckMsgBeforePacking(
             userData, userDataLen, groupId,
-            HZL_UAD_METADATA_IN_PAYLOAD_LEN, headerType);
+            HZL_UAD_METADATA_IN_PAYLOAD_LEN, headerType, headerPlacement);
     HZL_ERR_CHECK(err);
     // Prepare UAD Header
     const hzl_Header_t unpackedUadHeader = {
@@ -58,12 +59,11 @@ hzl_CommonBuildUnsecured(hzl_CbsPduMsg_t* const unsecuredPdu,
             .sid = sourceId,
             .pty = HZL_PTY_UAD,
     };
-    const uint8_t packedHdrLen = hzl_HeaderLen(headerType);
-    hzl_HeaderPackFunc const headerPackFunc =
-            hzl_HeaderPackFuncForType(headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(headerType, headerPlacement);
     // Prepare UAD payload
-    // Write the packed header at the beginning of the CAN FD frame's payload.
-    headerPackFunc(unsecuredPdu->data, &unpackedUadHeader);
+    // Write the packed header at the beginning of the CAN FD frame's payload and/or CAN ID.
+    hzl_HeaderPackPlaced(unsecuredPdu->data, &unsecuredPdu->canId, &unpackedUadHeader,
+                         headerType, headerPlacement);
     // Copy user-data (SDU) to the right of the packed header.
     memcpy(unsecuredPdu->data + packedHdrLen, userData, userDataLen);
     // Message is packed in binary format, ready to transmit
@@ -29,11 +29,14 @@
 /**
  * @file
  * @internal Implementation of the ctrdelay() function from the CBS specification.
+ *
+ * With floats or, with #HZL_INTEGER_CTRDELAY, with integers rounding exactly as specified.
  */
 
 #include "hzl_CommonInternal.h"
 #include "hzl_CommonMessage.h"
 
+#if !HZL_INTEGER_CTRDELAY
 /**
  * @internal
  * Computes the ceiling of the given float in [0, 2^32-2].
@@ -51,6 +54,7 @@ hzl_CeilUint32(const float x)
     const uint32_t xFloored = (uint32_t) x;
     return xFloored + ((float) xFloored < x);
 }
+#endif
 
 hzl_CtrNonce_t
 hzl_CommonCtrDelay(const hzl_Timestamp_t lastValidRxMsgInstant,
@@ -68,8 +72,20 @@ hzl_CommonCtrDelay(const hzl_Timestamp_t lastValidRxMsgInstant,
         // counter nonce. It must be equal or newer than the local one.
         return 0;
     }
+#if HZL_INTEGER_CTRDELAY
+    // ceil(D * (1 - t/S)) = ceil(D * r / S) with r = S - t in [1, S]. Splitting D = q*S + m
+    // gives q*r + ceil(m * r / S) exactly, where q*r <= D and m * r + S - 1 < S^2 <= 2^32
+    // as S <= 0xFFFF, so nothing overflows 32 bits.
+    const hzl_TimeDeltaMillis_t remainingSilence = maxSilenceInterval - sinceLastMsg;
+    const uint32_t quotient = maxCtrNonceDelay / maxSilenceInterval;
+    const uint32_t remainder = maxCtrNonceDelay % maxSilenceInterval;
+    return (hzl_CtrNonce_t) (quotient * remainingSilence
+                             + (remainder * remainingSilence + maxSilenceInterval - 1U)
+                               / maxSilenceInterval);
+#else
     // Due to the sinceLastMsg >= maxSilenceInterval condition, this fraction is always in [0, 1].
     const float elapsedAsMaxSilenceFraction = (float) sinceLastMsg / (float) maxSilenceInterval;
     const float delay = (float) maxCtrNonceDelay * (1.0f - elapsedAsMaxSilenceFraction);
     return (hzl_CtrNonce_t) hzl_CeilUint32(delay);
+#endif
 }
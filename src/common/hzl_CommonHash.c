@@ -37,6 +37,10 @@
 
 #include "hzl_CommonHash.h"
 #include "ascon.h"
+#include <string.h>
+
+_Static_assert(sizeof(hzl_Hash_t) <= HZL_HASH_MIDSTATE_LEN,
+               "The hash midstate must fit the whole hash function state.");
 
 void
 hzl_HashInit(hzl_Hash_t* const ctx)
@@ -74,3 +78,18 @@ hzl_HashDigestCheck(hzl_Hash_t* const ctx,
         return HZL_ERR_SECWARN_INVALID_TAG;
     }
 }
+
+void
+hzl_HashSaveMidstate(hzl_HashMidstate_t* const midstate,
+                     const hzl_Hash_t* const ctx)
+{
+    memcpy(midstate->state, ctx, sizeof(hzl_Hash_t));
+    midstate->isValid = true;
+}
+
+void
+hzl_HashResumeMidstate(hzl_Hash_t* const ctx,
+                       const hzl_HashMidstate_t* const midstate)
+{
+    memcpy(ctx, midstate->state, sizeof(hzl_Hash_t));
+}
@@ -106,6 +106,28 @@ hzl_HashDigestCheck(hzl_Hash_t* ctx,
                     const uint8_t* expectedDigest,
                     size_t digestLen);
 
+/**
+ * Stores the state of a hash function that absorbed a constant prefix of the data,
+ * to restart from it with hzl_HashResumeMidstate() without absorbing the prefix again.
+ *
+ * @param [out] midstate where to store the state
+ * @param [in] ctx context with the constant prefix already processed
+ */
+void
+hzl_HashSaveMidstate(hzl_HashMidstate_t* midstate,
+                     const hzl_Hash_t* ctx);
+
+/**
+ * Initialises the hash function from a stored state, ready to process the data following
+ * the prefix. The stored state is unchanged and can be resumed again.
+ *
+ * @param [out] ctx to initialise
+ * @param [in] midstate valid state, as stored by hzl_HashSaveMidstate()
+ */
+void
+hzl_HashResumeMidstate(hzl_Hash_t* ctx,
+                       const hzl_HashMidstate_t* midstate);
+
 #ifdef __cplusplus
 }
 #endif
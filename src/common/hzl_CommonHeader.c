@@ -29,155 +29,15 @@
 /**
  * @file
  * @internal
- * Functions that pack/unpack all standard CBS Headers and check the Header Type.
+ * Functions that pack/unpack all standard CBS Headers and check the Header Type,
+ * dispatching on the Header Type known at runtime.
  *
- * In the comments of the static packer/unpacker functions, the bits of each
- * field are indicated with:
- * `g` = GID bits, `s` = SID bits, `p` = PTY bits, `.` = unused bits
+ * Empty with #HZL_FIXED_HEADER_TYPE, as the header has all of them inline then.
  */
 
 #include "hzl_CommonHeader.h"
 
-/**
- * @internal Computes the largest value of a \p bits long unsigned integer.
- * Works for \p bits <= 15, may also work for larger values on platforms where sizeof(unsigned int)
- * is 4 bytes or more.
- */
-#define HZL_MAX_UINTx(bits) ((1U << (bits)) - 1U)
-
-/** @internal `| gggg gggg | ssss ssss | pppp pppp |` */
-static void
-hzl_Header0Pack(uint8_t* binary, const hzl_Header_t* hdr)
-{
-    binary[0] = hdr->gid;
-    binary[1] = hdr->sid;
-    binary[2] = hdr->pty;
-}
-
-/** @internal `| gggg gggg | ssss sppp |` */
-static void
-hzl_Header1Pack(uint8_t* binary, const hzl_Header_t* hdr)
-{
-    binary[0] = hdr->gid;
-    binary[1] = (uint8_t) (
-            ((hdr->sid & 0x1FU) << 5U)
-            | (hdr->pty & 0x07U)
-    );
-}
-
-/** @internal `| ssss ssss | gggg gppp |` */
-static void
-hzl_Header2Pack(uint8_t* binary, const hzl_Header_t* hdr)
-{
-    binary[0] = hdr->sid;
-    binary[1] = (uint8_t) (
-            ((hdr->gid & 0x1FU) << 5U)
-            | (hdr->pty & 0x07U)
-    );
-}
-
-/** @internal `| gggs sppp |` */
-static void
-hzl_Header3Pack(uint8_t* binary, const hzl_Header_t* hdr)
-{
-    binary[0] = (uint8_t) (
-            ((hdr->gid & 0x07U) << 5U)
-            | ((hdr->sid & 0x03U) << 3U)
-            | (hdr->pty & 0x07U)
-    );
-}
-
-/** @internal `| sssg gppp |` */
-static void
-hzl_Header4Pack(uint8_t* binary, const hzl_Header_t* hdr)
-{
-    binary[0] = (uint8_t) (
-            ((hdr->sid & 0x07U) << 5U)
-            | ((hdr->gid & 0x03U) << 3U)
-            | (hdr->pty & 0x07U)
-    );
-}
-
-/** @internal `| ssss ssss | .... .ppp |` */
-static void
-hzl_Header5Pack(uint8_t* binary, const hzl_Header_t* hdr)
-{
-    binary[0] = hdr->sid;
-    binary[1] = (uint8_t) (hdr->pty & 0x07U);
-}
-
-/** @internal `| ssss sppp |` */
-static void
-hzl_Header6Pack(uint8_t* binary, const hzl_Header_t* hdr)
-{
-    binary[0] = (uint8_t) (
-            ((hdr->sid & 0x1FU) << 3U)
-            | (hdr->pty & 0x07U)
-    );
-}
-
-/** @internal `| gggg gggg | ssss ssss | pppp pppp |` */
-static void
-hzl_Header0Unpack(hzl_Header_t* hdr, const uint8_t* binary)
-{
-    hdr->gid = binary[0];
-    hdr->sid = binary[1];
-    hdr->pty = binary[2];
-}
-
-/** @internal `| gggg gggg | ssss sppp |` */
-static void
-hzl_Header1Unpack(hzl_Header_t* hdr, const uint8_t* binary)
-{
-    hdr->gid = binary[0];
-    hdr->sid = binary[1] >> 3U;
-    hdr->pty = (uint8_t) (binary[1] & 0x07U);
-}
-
-/** @internal `| ssss ssss | gggg gppp |` */
-static void
-hzl_Header2Unpack(hzl_Header_t* hdr, const uint8_t* binary)
-{
-    hdr->gid = binary[1] >> 3U;
-    hdr->sid = binary[0];
-    hdr->pty = (uint8_t) (binary[1] & 0x07U);
-}
-
-/** @internal `| gggs sppp |` */
-static void
-hzl_Header3Unpack(hzl_Header_t* hdr, const uint8_t* binary)
-{
-    hdr->gid = binary[0] >> 5U;
-    hdr->sid = (uint8_t) ((binary[0] >> 3U) & 0x03U);
-    hdr->pty = (uint8_t) (binary[0] & 0x07U);
-}
-
-/** @internal `| sssg gppp |` */
-static void
-hzl_Header4Unpack(hzl_Header_t* hdr, const uint8_t* binary)
-{
-    hdr->gid = (binary[0] >> 3U) & 0x03U;
-    hdr->sid = binary[0] >> 5U;
-    hdr->pty = (uint8_t) (binary[0] & 0x07U);
-}
-
-/** @internal `| ssss ssss | .... .ppp |` */
-static void
-hzl_Header5Unpack(hzl_Header_t* hdr, const uint8_t* binary)
-{
-    hdr->gid = HZL_BROADCAST_GID;
-    hdr->sid = binary[0];
-    hdr->pty = (uint8_t) (binary[1] & 0x07U);
-}
-
-/** @internal `| ssss sppp |` */
-static void
-hzl_Header6Unpack(hzl_Header_t* hdr, const uint8_t* binary)
-{
-    hdr->gid = HZL_BROADCAST_GID;
-    hdr->sid = binary[0] >> 3U;
-    hdr->pty = (uint8_t) (binary[0] & 0x07U);
-}
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
 
 hzl_Err_t
 hzl_HeaderTypeCheck(const uint8_t type)
@@ -234,34 +94,68 @@ hzl_HeaderTypeMaxGid(const uint8_t type)
     }
 }
 
-hzl_HeaderPackFunc
-hzl_HeaderPackFuncForType(const uint8_t type)
+void
+hzl_HeaderPack(uint8_t* const binary,
+               const hzl_Header_t* const hdr,
+               const uint8_t type)
 {
     switch (type)
     {
-        case HZL_HEADER_0:return hzl_Header0Pack;
-        case HZL_HEADER_1:return hzl_Header1Pack;
-        case HZL_HEADER_2:return hzl_Header2Pack;
-        case HZL_HEADER_3:return hzl_Header3Pack;
-        case HZL_HEADER_4:return hzl_Header4Pack;
-        case HZL_HEADER_5:return hzl_Header5Pack;
-        case HZL_HEADER_6:return hzl_Header6Pack;
-        default:return NULL;
+        case HZL_HEADER_0:
+            hzl_Header0Pack(binary, hdr);
+            break;
+        case HZL_HEADER_1:
+            hzl_Header1Pack(binary, hdr);
+            break;
+        case HZL_HEADER_2:
+            hzl_Header2Pack(binary, hdr);
+            break;
+        case HZL_HEADER_3:
+            hzl_Header3Pack(binary, hdr);
+            break;
+        case HZL_HEADER_4:
+            hzl_Header4Pack(binary, hdr);
+            break;
+        case HZL_HEADER_5:
+            hzl_Header5Pack(binary, hdr);
+            break;
+        case HZL_HEADER_6:
+            hzl_Header6Pack(binary, hdr);
+            break;
+        default:break;
     }
 }
 
-hzl_HeaderUnpackFunc
-hzl_HeaderUnpackFuncForType(const uint8_t type)
+void
+hzl_HeaderUnpack(hzl_Header_t* const hdr,
+                 const uint8_t* const binary,
+                 const uint8_t type)
 {
     switch (type)
     {
-        case HZL_HEADER_0:return hzl_Header0Unpack;
-        case HZL_HEADER_1:return hzl_Header1Unpack;
-        case HZL_HEADER_2:return hzl_Header2Unpack;
-        case HZL_HEADER_3:return hzl_Header3Unpack;
-        case HZL_HEADER_4:return hzl_Header4Unpack;
-        case HZL_HEADER_5:return hzl_Header5Unpack;
-        case HZL_HEADER_6:return hzl_Header6Unpack;
-        default:return NULL;
+        case HZL_HEADER_0:
+            hzl_Header0Unpack(hdr, binary);
+            break;
+        case HZL_HEADER_1:
+            hzl_Header1Unpack(hdr, binary);
+            break;
+        case HZL_HEADER_2:
+            hzl_Header2Unpack(hdr, binary);
+            break;
+        case HZL_HEADER_3:
+            hzl_Header3Unpack(hdr, binary);
+            break;
+        case HZL_HEADER_4:
+            hzl_Header4Unpack(hdr, binary);
+            break;
+        case HZL_HEADER_5:
+            hzl_Header5Unpack(hdr, binary);
+            break;
+        case HZL_HEADER_6:
+            hzl_Header6Unpack(hdr, binary);
+            break;
+        default:break;
     }
 }
+
+#endif  /* HZL_FIXED_HEADER_TYPE */
@@ -30,6 +30,11 @@
  * @file
  * @internal
  * Functions that pack/unpack all standard CBS Headers and check the Header Type.
+ *
+ * The packers/unpackers of each Header Type are inline, so the libraries specialised with
+ * #HZL_FIXED_HEADER_TYPE call them directly. In their comments, the bits of each
+ * field are indicated with:
+ * `g` = GID bits, `s` = SID bits, `p` = PTY bits, `.` = unused bits
  */
 
 #ifndef HZL_HEADER_H_
@@ -41,6 +46,7 @@ extern "C"
 #endif
 
 #include "hzl.h"
+#include "hzl_CommonInternal.h"
 
 /**
  * @internal
@@ -60,38 +66,283 @@ typedef enum hzl_PayloadType
     HZL_PTY_RFU2 = 7U,  ///< Reserved for future use
 } hzl_PayloadType_t;
 
+/**
+ * @internal Computes the largest value of a \p bits long unsigned integer.
+ * Works for \p bits <= 15, may also work for larger values on platforms where sizeof(unsigned int)
+ * is 4 bytes or more.
+ */
+#define HZL_MAX_UINTx(bits) ((1U << (bits)) - 1U)
+
+/** @internal `| gggg gggg | ssss ssss | pppp pppp |` */
+static inline void
+hzl_Header0Pack(uint8_t* binary, const hzl_Header_t* hdr)
+{
+    binary[0] = hdr->gid;
+    binary[1] = hdr->sid;
+    binary[2] = hdr->pty;
+}
+
+/** @internal `| gggg gggg | ssss sppp |` */
+static inline void
+hzl_Header1Pack(uint8_t* binary, const hzl_Header_t* hdr)
+{
+    binary[0] = hdr->gid;
+    binary[1] = (uint8_t) (
+            ((hdr->sid & 0x1FU) << 5U)
+            | (hdr->pty & 0x07U)
+    );
+}
+
+/** @internal `| ssss ssss | gggg gppp |` */
+static inline void
+hzl_Header2Pack(uint8_t* binary, const hzl_Header_t* hdr)
+{
+    binary[0] = hdr->sid;
+    binary[1] = (uint8_t) (
+            ((hdr->gid & 0x1FU) << 5U)
+            | (hdr->pty & 0x07U)
+    );
+}
+
+/** @internal `| gggs sppp |` */
+static inline void
+hzl_Header3Pack(uint8_t* binary, const hzl_Header_t* hdr)
+{
+    binary[0] = (uint8_t) (
+            ((hdr->gid & 0x07U) << 5U)
+            | ((hdr->sid & 0x03U) << 3U)
+            | (hdr->pty & 0x07U)
+    );
+}
+
+/** @internal `| sssg gppp |` */
+static inline void
+hzl_Header4Pack(uint8_t* binary, const hzl_Header_t* hdr)
+{
+    binary[0] = (uint8_t) (
+            ((hdr->sid & 0x07U) << 5U)
+            | ((hdr->gid & 0x03U) << 3U)
+            | (hdr->pty & 0x07U)
+    );
+}
+
+/** @internal `| ssss ssss | .... .ppp |` */
+static inline void
+hzl_Header5Pack(uint8_t* binary, const hzl_Header_t* hdr)
+{
+    binary[0] = hdr->sid;
+    binary[1] = (uint8_t) (hdr->pty & 0x07U);
+}
+
+/** @internal `| ssss sppp |` */
+static inline void
+hzl_Header6Pack(uint8_t* binary, const hzl_Header_t* hdr)
+{
+    binary[0] = (uint8_t) (
+            ((hdr->sid & 0x1FU) << 3U)
+            | (hdr->pty & 0x07U)
+    );
+}
+
+/** @internal `| gggg gggg | ssss ssss | pppp pppp |` */
+static inline void
+hzl_Header0Unpack(hzl_Header_t* hdr, const uint8_t* binary)
+{
+    hdr->gid = binary[0];
+    hdr->sid = binary[1];
+    hdr->pty = binary[2];
+}
+
+/** @internal `| gggg gggg | ssss sppp |` */
+static inline void
+hzl_Header1Unpack(hzl_Header_t* hdr, const uint8_t* binary)
+{
+    hdr->gid = binary[0];
+    hdr->sid = binary[1] >> 3U;
+    hdr->pty = (uint8_t) (binary[1] & 0x07U);
+}
+
+/** @internal `| ssss ssss | gggg gppp |` */
+static inline void
+hzl_Header2Unpack(hzl_Header_t* hdr, const uint8_t* binary)
+{
+    hdr->gid = binary[1] >> 3U;
+    hdr->sid = binary[0];
+    hdr->pty = (uint8_t) (binary[1] & 0x07U);
+}
+
+/** @internal `| gggs sppp |` */
+static inline void
+hzl_Header3Unpack(hzl_Header_t* hdr, const uint8_t* binary)
+{
+    hdr->gid = binary[0] >> 5U;
+    hdr->sid = (uint8_t) ((binary[0] >> 3U) & 0x03U);
+    hdr->pty = (uint8_t) (binary[0] & 0x07U);
+}
+
+/** @internal `| sssg gppp |` */
+static inline void
+hzl_Header4Unpack(hzl_Header_t* hdr, const uint8_t* binary)
+{
+    hdr->gid = (binary[0] >> 3U) & 0x03U;
+    hdr->sid = binary[0] >> 5U;
+    hdr->pty = (uint8_t) (binary[0] & 0x07U);
+}
+
+/** @internal `| ssss ssss | .... .ppp |` */
+static inline void
+hzl_Header5Unpack(hzl_Header_t* hdr, const uint8_t* binary)
+{
+    hdr->gid = HZL_BROADCAST_GID;
+    hdr->sid = binary[0];
+    hdr->pty = (uint8_t) (binary[1] & 0x07U);
+}
+
+/** @internal `| ssss sppp |` */
+static inline void
+hzl_Header6Unpack(hzl_Header_t* hdr, const uint8_t* binary)
+{
+    hdr->gid = HZL_BROADCAST_GID;
+    hdr->sid = binary[0] >> 3U;
+    hdr->pty = (uint8_t) (binary[0] & 0x07U);
+}
+
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
+
+/**
+ * @internal
+ * Validates if the value represents an actual standard CBS header type.
+ *
+ * With #HZL_FIXED_HEADER_TYPE, only that header type is valid.
+ *
+ * @param [in] type header type value to check
+ * @retval #HZL_OK on success
+ * @retval #HZL_ERR_INVALID_HEADER_TYPE in case of illegal header type value
+ */
+hzl_Err_t
+hzl_HeaderTypeCheck(uint8_t type);
+
+/**
+ * @internal
+ * Provides the largest SID that still fits in the given CBS Header Type.
+ *
+ * @param [in] type header type
+ * @return the max SID value or 0 in case of illegal header type
+ */
+hzl_Sid_t
+hzl_HeaderTypeMaxSid(uint8_t type);
+
+/**
+ * @internal
+ * Provides the largest GID that still fits in the given CBS Header Type.
+ *
+ * @param [in] type header type
+ * @return the max GID value or 0 in case of illegal header type
+ */
+hzl_Gid_t
+hzl_HeaderTypeMaxGid(uint8_t type);
+
 /**
  * @internal
- * Signature of a packer function that encodes the #hzl_Header_t structure into
- * a binary buffer, making the header ready for transmission.
+ * Provides the length in bytes of the encoded header of a given type.
+ *
+ * @param [in] type header
+ * @return positive length in bytes or 0 in case of invalid header type
+ */
+uint8_t
+hzl_HeaderLen(uint8_t type);
+
+/**
+ * @internal
+ * Encodes the #hzl_Header_t structure into a binary buffer, making the header ready
+ * for transmission.
  *
  * @param [out] binary buffer where to write the packed encoded header
  * @param [in] hdr data structure to encode
+ * @param [in] type header type, already validated with hzl_HeaderTypeCheck()
  */
-typedef void (* hzl_HeaderPackFunc)(uint8_t* binary,
-                                    const hzl_Header_t* hdr);
+void
+hzl_HeaderPack(uint8_t* binary,
+               const hzl_Header_t* hdr,
+               uint8_t type);
 
 /**
  * @internal
- * Signature of an unpacker function that decodes a the binary header from a
- * received CBS message into a #hzl_Header_t structure.
+ * Decodes the binary header from a received CBS message into a #hzl_Header_t structure.
  *
  * @param [out] hdr data structure where to write the decoded data
  * @param [in] binary buffer with encoded header
+ * @param [in] type header type, already validated with hzl_HeaderTypeCheck()
  */
-typedef void (* hzl_HeaderUnpackFunc)(hzl_Header_t* hdr,
-                                      const uint8_t* binary);
+void
+hzl_HeaderUnpack(hzl_Header_t* hdr,
+                 const uint8_t* binary,
+                 uint8_t type);
+
+#else  /* Fixed header type */
+
+#if HZL_FIXED_HEADER_TYPE == 0
+#define HZL_FIXED_HEADER_LEN 3U
+#define HZL_FIXED_HEADER_MAX_SID HZL_MAX_UINTx(8U)
+#define HZL_FIXED_HEADER_MAX_GID HZL_MAX_UINTx(8U)
+#define HZL_FIXED_HEADER_PACK hzl_Header0Pack
+#define HZL_FIXED_HEADER_UNPACK hzl_Header0Unpack
+#elif HZL_FIXED_HEADER_TYPE == 1
+#define HZL_FIXED_HEADER_LEN 2U
+#define HZL_FIXED_HEADER_MAX_SID HZL_MAX_UINTx(5U)
+#define HZL_FIXED_HEADER_MAX_GID HZL_MAX_UINTx(8U)
+#define HZL_FIXED_HEADER_PACK hzl_Header1Pack
+#define HZL_FIXED_HEADER_UNPACK hzl_Header1Unpack
+#elif HZL_FIXED_HEADER_TYPE == 2
+#define HZL_FIXED_HEADER_LEN 2U
+#define HZL_FIXED_HEADER_MAX_SID HZL_MAX_UINTx(8U)
+#define HZL_FIXED_HEADER_MAX_GID HZL_MAX_UINTx(5U)
+#define HZL_FIXED_HEADER_PACK hzl_Header2Pack
+#define HZL_FIXED_HEADER_UNPACK hzl_Header2Unpack
+#elif HZL_FIXED_HEADER_TYPE == 3
+#define HZL_FIXED_HEADER_LEN 1U
+#define HZL_FIXED_HEADER_MAX_SID HZL_MAX_UINTx(2U)
+#define HZL_FIXED_HEADER_MAX_GID HZL_MAX_UINTx(3U)
+#define HZL_FIXED_HEADER_PACK hzl_Header3Pack
+#define HZL_FIXED_HEADER_UNPACK hzl_Header3Unpack
+#elif HZL_FIXED_HEADER_TYPE == 4
+#define HZL_FIXED_HEADER_LEN 1U
+#define HZL_FIXED_HEADER_MAX_SID HZL_MAX_UINTx(3U)
+#define HZL_FIXED_HEADER_MAX_GID HZL_MAX_UINTx(2U)
+#define HZL_FIXED_HEADER_PACK hzl_Header4Pack
+#define HZL_FIXED_HEADER_UNPACK hzl_Header4Unpack
+#elif HZL_FIXED_HEADER_TYPE == 5
+#define HZL_FIXED_HEADER_LEN 2U
+#define HZL_FIXED_HEADER_MAX_SID HZL_MAX_UINTx(8U)
+#define HZL_FIXED_HEADER_MAX_GID HZL_MAX_UINTx(0U)
+#define HZL_FIXED_HEADER_PACK hzl_Header5Pack
+#define HZL_FIXED_HEADER_UNPACK hzl_Header5Unpack
+#elif HZL_FIXED_HEADER_TYPE == 6
+#define HZL_FIXED_HEADER_LEN 1U
+#define HZL_FIXED_HEADER_MAX_SID HZL_MAX_UINTx(5U)
+#define HZL_FIXED_HEADER_MAX_GID HZL_MAX_UINTx(0U)
+#define HZL_FIXED_HEADER_PACK hzl_Header6Pack
+#define HZL_FIXED_HEADER_UNPACK hzl_Header6Unpack
+#else
+#error "HZL_FIXED_HEADER_TYPE must be HZL_FIXED_HEADER_TYPE_ANY or a header type in [0, 6]"
+#endif
 
 /**
  * @internal
  * Validates if the value represents an actual standard CBS header type.
  *
+ * With #HZL_FIXED_HEADER_TYPE, only that header type is valid.
+ *
  * @param [in] type header type value to check
  * @retval #HZL_OK on success
  * @retval #HZL_ERR_INVALID_HEADER_TYPE in case of illegal header type value
  */
-hzl_Err_t
-hzl_HeaderTypeCheck(uint8_t type);
+static inline hzl_Err_t
+hzl_HeaderTypeCheck(const uint8_t type)
+{
+    if (type != HZL_FIXED_HEADER_TYPE) { return HZL_ERR_INVALID_HEADER_TYPE; }
+    else { return HZL_OK; }
+}
 
 /**
  * @internal
@@ -100,8 +351,12 @@ hzl_HeaderTypeCheck(uint8_t type);
  * @param [in] type header type
  * @return the max SID value or 0 in case of illegal header type
  */
-hzl_Sid_t
-hzl_HeaderTypeMaxSid(uint8_t type);
+static inline hzl_Sid_t
+hzl_HeaderTypeMaxSid(const uint8_t type)
+{
+    (void) type;
+    return HZL_FIXED_HEADER_MAX_SID;
+}
 
 /**
  * @internal
@@ -110,8 +365,12 @@ hzl_HeaderTypeMaxSid(uint8_t type);
  * @param [in] type header type
  * @return the max GID value or 0 in case of illegal header type
  */
-hzl_Gid_t
-hzl_HeaderTypeMaxGid(uint8_t type);
+static inline hzl_Gid_t
+hzl_HeaderTypeMaxGid(const uint8_t type)
+{
+    (void) type;
+    return HZL_FIXED_HEADER_MAX_GID;
+}
 
 /**
  * @internal
@@ -120,28 +379,162 @@ hzl_HeaderTypeMaxGid(uint8_t type);
  * @param [in] type header
  * @return positive length in bytes or 0 in case of invalid header type
  */
-uint8_t
-hzl_HeaderLen(uint8_t type);
+static inline uint8_t
+hzl_HeaderLen(const uint8_t type)
+{
+    (void) type;
+    return HZL_FIXED_HEADER_LEN;
+}
 
 /**
  * @internal
- * Provides the packer function for the header of a given type.
+ * Encodes the #hzl_Header_t structure into a binary buffer, making the header ready
+ * for transmission.
  *
- * @param [in] type header
- * @return packer function pointer or NULL in case of invalid header type
+ * @param [out] binary buffer where to write the packed encoded header
+ * @param [in] hdr data structure to encode
+ * @param [in] type header type, already validated with hzl_HeaderTypeCheck()
+ */
+static inline void
+hzl_HeaderPack(uint8_t* const binary,
+               const hzl_Header_t* const hdr,
+               const uint8_t type)
+{
+    (void) type;
+    HZL_FIXED_HEADER_PACK(binary, hdr);
+}
+
+/**
+ * @internal
+ * Decodes the binary header from a received CBS message into a #hzl_Header_t structure.
+ *
+ * @param [out] hdr data structure where to write the decoded data
+ * @param [in] binary buffer with encoded header
+ * @param [in] type header type, already validated with hzl_HeaderTypeCheck()
  */
-hzl_HeaderPackFunc
-hzl_HeaderPackFuncForType(uint8_t type);
+static inline void
+hzl_HeaderUnpack(hzl_Header_t* const hdr,
+                 const uint8_t* const binary,
+                 const uint8_t type)
+{
+    (void) type;
+    HZL_FIXED_HEADER_UNPACK(hdr, binary);
+}
+
+#endif  /* HZL_FIXED_HEADER_TYPE */
 
 /**
  * @internal
- * Provides the unpacker function for the header of a given type.
+ * Validates if the value represents a header placement.
  *
- * @param [in] type header
- * @return unpacker function pointer or NULL in case of invalid header type
+ * @param [in] placement header placement value to check
+ * @retval #HZL_OK on success
+ * @retval #HZL_ERR_INVALID_HEADER_PLACEMENT in case of illegal header placement value
+ */
+static inline hzl_Err_t
+hzl_HeaderPlacementCheck(const uint8_t placement)
+{
+    if (placement > HZL_HEADER_MIXED) { return HZL_ERR_INVALID_HEADER_PLACEMENT; }
+    else { return HZL_OK; }
+}
+
+/**
+ * @internal
+ * Provides the length in bytes of the part of the encoded header placed in the payload,
+ * thus the offset of the payload fields after it.
+ *
+ * @param [in] type header type
+ * @param [in] placement header placement
+ * @return length in bytes, 0 if the whole header is in the CAN ID
+ */
+static inline uint8_t
+hzl_HeaderLenInPayload(const uint8_t type,
+                       const uint8_t placement)
+{
+    switch (placement)
+    {
+        case HZL_HEADER_IN_CAN_ID:return 0U;
+        case HZL_HEADER_MIXED:return HZL_PTY_LEN;
+        default:return hzl_HeaderLen(type);
+    }
+}
+
+/**
+ * @internal
+ * Encodes the #hzl_Header_t structure into the payload and/or the CAN ID, according to the
+ * header placement.
+ *
+ * @param [out] payload buffer where to write the part of the header placed in the payload,
+ *        of hzl_HeaderLenInPayload() bytes
+ * @param [out] canId where to write the part of the header placed in the CAN ID; 0 if none
+ * @param [in] hdr data structure to encode
+ * @param [in] type header type, already validated with hzl_HeaderTypeCheck()
+ * @param [in] placement header placement, already validated with hzl_HeaderPlacementCheck()
  */
-hzl_HeaderUnpackFunc
-hzl_HeaderUnpackFuncForType(uint8_t type);
+static inline void
+hzl_HeaderPackPlaced(uint8_t* const payload,
+                     hzl_CanId_t* const canId,
+                     const hzl_Header_t* const hdr,
+                     const uint8_t type,
+                     const uint8_t placement)
+{
+    if (placement == HZL_HEADER_IN_PAYLOAD)
+    {
+        hzl_HeaderPack(payload, hdr, type);
+        *canId = 0;
+        return;
+    }
+    hzl_Header_t hdrInCanId = *hdr;
+    if (placement == HZL_HEADER_MIXED)
+    {
+        payload[0] = hdr->pty;
+        hdrInCanId.pty = 0;
+    }
+    uint8_t packed[3] = {0};  // Longest header: type 0
+    hzl_HeaderPack(packed, &hdrInCanId, type);
+    hzl_CanId_t id = 0;
+    for (uint8_t i = 0; i < hzl_HeaderLen(type); i++)
+    {
+        id = (id << 8U) | packed[i];
+    }
+    *canId = id;
+}
+
+/**
+ * @internal
+ * Decodes the header of a received CBS message from its payload and/or its CAN ID,
+ * according to the header placement, into a #hzl_Header_t structure.
+ *
+ * @param [out] hdr data structure where to write the decoded data
+ * @param [in] payload received payload, of at least hzl_HeaderLenInPayload() bytes
+ * @param [in] canId CAN ID of the received frame. Bits above the header are ignored.
+ * @param [in] type header type, already validated with hzl_HeaderTypeCheck()
+ * @param [in] placement header placement, already validated with hzl_HeaderPlacementCheck()
+ */
+static inline void
+hzl_HeaderUnpackPlaced(hzl_Header_t* const hdr,
+                       const uint8_t* const payload,
+                       const hzl_CanId_t canId,
+                       const uint8_t type,
+                       const uint8_t placement)
+{
+    if (placement == HZL_HEADER_IN_PAYLOAD)
+    {
+        hzl_HeaderUnpack(hdr, payload, type);
+        return;
+    }
+    const uint8_t len = hzl_HeaderLen(type);
+    uint8_t packed[3];  // Longest header: type 0
+    for (uint8_t i = 0; i < len; i++)
+    {
+        packed[i] = (uint8_t) (canId >> (8U * (len - 1U - i)));
+    }
+    hzl_HeaderUnpack(hdr, packed, type);
+    if (placement == HZL_HEADER_MIXED)
+    {
+        hdr->pty = payload[0];
+    }
+}
 
 #ifdef __cplusplus
 }
@@ -95,6 +95,20 @@ typedef uint32_t hzl_TimeDeltaMillis_t;
 void
 hzl_ZeroOut(void* buffer, size_t amountOfBytes);
 
+/**
+ * @internal
+ * Clears the outputs of a function processing a received message, before writing into them.
+ *
+ * Clears them completely or, with #HZL_LAZY_OUTPUT_CLEARING, only their metadata and the data
+ * bytes used by the previous message, according to their `dataLen`.
+ *
+ * @param [in, out] receivedUserData unpacked received message
+ * @param [in, out] reactionPdu message to transmit in reaction
+ */
+void
+hzl_ClearReceivedOutputs(hzl_RxSduMsg_t* receivedUserData,
+                         hzl_CbsPduMsg_t* reactionPdu);
+
 /**
  * @internal
  * Checks if all bytes are set to zero.
@@ -159,6 +173,65 @@ hzl_CommonNewMsg(hzl_CbsPduMsg_t** pMsg);
 void
 hzl_CommonFreeMsg(hzl_CbsPduMsg_t** pMsg);
 
+/**
+ * @internal
+ * Reads a whole file at once into memory, to parse it from there.
+ *
+ * The stream is unbuffered, so the content is read straight into the returned buffer.
+ * Used by hzl_ServerNew() and hzl_ClientNew() to load the configuration files.
+ *
+ * @param [out] pBytes where to store the heap-allocated buffer of \p maxLen bytes with the file
+ *        content. Release it with #HZL_SECURE_FREE, as it may hold keys. NULL on error.
+ * @param [out] len amount of bytes read, shorter than \p maxLen when the file is shorter
+ * @param [in] fileName path to the file
+ * @param [in] maxLen length of the longest file of its format; further bytes are not read
+ *
+ * @retval #HZL_OK on success, even when the file is shorter than expected
+ * @retval #HZL_ERR_CANNOT_OPEN_CONFIG_FILE if the file cannot be opened
+ * @retval #HZL_ERR_MALLOC_FAILED if the buffer allocation fails
+ */
+hzl_Err_t
+hzl_OsReadFile(uint8_t** pBytes,
+               size_t* len,
+               const char* fileName,
+               size_t maxLen);
+
+/**
+ * @internal
+ * Reserves a region in an arena that is still being sized, aligned to #HZL_CACHE_LINE_LEN.
+ *
+ * Used by hzl_ServerNew() and hzl_ClientNew() to lay out the context and all its arrays
+ * in one allocation, in their access order.
+ *
+ * @param [in, out] arenaLen length of the arena so far, increased by \p len plus padding
+ * @param [in] len length of the region in bytes
+ * @return offset of the region from the start of the arena
+ */
+size_t
+hzl_OsArenaReserve(size_t* arenaLen,
+                   size_t len);
+
+/**
+ * @internal
+ * Allocates a zeroed arena aligned to #HZL_CACHE_LINE_LEN.
+ *
+ * @param [in] arenaLen length in bytes, as computed with hzl_OsArenaReserve()
+ * @return the arena or NULL when the allocation fails. Release it with hzl_OsArenaFree().
+ */
+void*
+hzl_OsArenaAlloc(size_t arenaLen);
+
+/**
+ * @internal
+ * Securely clears and frees an arena allocated with hzl_OsArenaAlloc().
+ *
+ * @param [in] arena the arena. If NULL, the function does nothing.
+ * @param [in] arenaLen length in bytes, the same given to hzl_OsArenaAlloc()
+ */
+void
+hzl_OsArenaFree(void* arena,
+                size_t arenaLen);
+
 /**
  * @internal
  * True random number generator function using the underlying desktop Operating System.
@@ -174,6 +247,25 @@ hzl_CommonFreeMsg(hzl_CbsPduMsg_t** pMsg);
 hzl_Err_t
 hzl_OsTrng(uint8_t* buffer, size_t amount);
 
+/**
+ * @internal
+ * Cryptographically secure pseudo-random number generator, seeded by hzl_OsTrng().
+ *
+ * Provides the bytes from a per-thread pool, refilled in bulk with Ascon-XOF and reseeded
+ * from the OS periodically and after a fork(), so the OS is queried only rarely.
+ * Default #hzl_Io_t.trng of the contexts created with hzl_ServerNew() and hzl_ClientNew().
+ *
+ * @param [out] buffer where to write the random bytes
+ * @param [in] amount number of random bytes to write to \p buffer
+ *
+ * @retval #HZL_OK on success
+ * @retval #HZL_ERR_CANNOT_GENERATE_RANDOM if the seeding from the OS fails
+ *
+ * @see #hzl_TrngFunc
+ */
+hzl_Err_t
+hzl_OsCsprng(uint8_t* buffer, size_t amount);
+
 /**
  * @internal
  * Timestamping function providing the current time using the underlying desktop Operating System.
@@ -209,6 +301,42 @@ hzl_OsCurrentTime(hzl_Timestamp_t* timestamp);
 
 #endif  /* HZL_OS_AVAILABLE */
 
+#if HZL_OS_AVAILABLE_LINUX
+
+#include <linux/can.h>  /* For struct can_filter of SocketCAN */
+
+/**
+ * @internal
+ * Tells if the CAN acceptance filters can tell the Groups apart, thus one filter per Group
+ * is needed, or if a single filter suffices.
+ *
+ * @param [in] headerType header type, already validated
+ * @param [in] headerPlacement header placement, already validated
+ * @return true if the GID is placed in the CAN ID and has at least one bit
+ */
+bool
+hzl_OsCanFilterPerGroup(uint8_t headerType,
+                        uint8_t headerPlacement);
+
+/**
+ * @internal
+ * Builds the SocketCAN acceptance filter matching the CBS frames of a Group.
+ *
+ * Used by hzl_ClientBuildCanFilters() and hzl_ServerBuildCanFilters().
+ *
+ * @param [out] filter where to write the filter
+ * @param [in] gid Group Identifier to match, if hzl_OsCanFilterPerGroup() is true
+ * @param [in] headerType header type, already validated
+ * @param [in] headerPlacement header placement, already validated
+ */
+void
+hzl_OsCanFilter(struct can_filter* filter,
+                hzl_Gid_t gid,
+                uint8_t headerType,
+                uint8_t headerPlacement);
+
+#endif  /* HZL_OS_AVAILABLE_LINUX */
+
 #ifdef __cplusplus
 }
 #endif
@@ -43,6 +43,7 @@ extern "C"
 #include "hzl_CommonAead.h"
 #include "hzl_CommonHeader.h"
 #include "hzl_CommonHash.h"
+#include "hzl_CommonPayload.h"
 
 /**
  * @internal
@@ -57,7 +58,8 @@ hzl_CommonBuildUnsecured(hzl_CbsPduMsg_t* unsecuredPdu,
                          size_t userDataLen,
                          hzl_Gid_t groupId,
                          hzl_Sid_t sourceId,
-                         uint8_t headerType);
+                         uint8_t headerType,
+                         uint8_t headerPlacement);
 
 /**
  * @internal
@@ -72,6 +74,7 @@ hzl_CommonBuildUnsecured(hzl_CbsPduMsg_t* unsecuredPdu,
  * @param [in] metadataInPayloadLen length in bytes of the metadata surrounding the user data
  * within the CBS Payload, excluding the packed CBS Header.
  * @param [in] headerType to access the maximum GID and SID etc.
+ * @param [in] headerPlacement to know how much of the header is in the payload
  *
  * @retval #HZL_OK on a valid message, the specific error code if something is incorrect
  */
@@ -80,17 +83,20 @@ hzl_CommonCheckMsgBeforePacking(const uint8_t* userData,
                                 size_t userDataLen,
                                 hzl_Gid_t group,
                                 size_t metadataInPayloadLen,
-                                uint8_t headerType);
+                                uint8_t headerType,
+                                uint8_t headerPlacement);
 
 /** @internal
  * Verifies the basic integrity of the message data structure (NULL pointers,
- * minimum and maximum sizes). */
+ * minimum and maximum sizes) and unpacks its header from the payload and/or the CAN ID. */
 hzl_Err_t
 hzl_CommonCheckReceivedGenericMsg(hzl_Header_t* unpackedHdr,
                                   const uint8_t* receivedPdu,
                                   size_t receivedPduLen,
+                                  hzl_CanId_t receivedCanId,
                                   hzl_Sid_t receiverSid,
-                                  uint8_t headerType);
+                                  uint8_t headerType,
+                                  uint8_t headerPlacement);
 
 /**
  * @internal
@@ -102,6 +108,7 @@ hzl_CommonCheckReceivedGenericMsg(hzl_Header_t* unpackedHdr,
  * @param [in] rxPduLen length of \p rxPdu in bytes
  * @param [in] unpackedUadHeader metadata of the CBS message in unpacked format
  * @param [in] headerType
+ * @param [in] headerPlacement
  *
  * @return #HZL_OK always as there is no validation
  */
@@ -110,34 +117,292 @@ hzl_CommonProcessReceivedUnsecured(hzl_RxSduMsg_t* unpackedMsg,
                                    const uint8_t* rxPdu,
                                    size_t rxPduLen,
                                    const hzl_Header_t* unpackedUadHeader,
-                                   uint8_t headerType);
+                                   uint8_t headerType,
+                                   uint8_t headerPlacement);
+
+/**
+ * @internal
+ * Same as hzl_CommonProcessReceivedUnsecured(), but without copying the data: the unpacked
+ * view points into \p rxPdu.
+ */
+hzl_Err_t
+hzl_CommonProcessReceivedUnsecuredView(hzl_RxSduView_t* unpackedView,
+                                       const uint8_t* rxPdu,
+                                       size_t rxPduLen,
+                                       const hzl_Header_t* unpackedUadHeader,
+                                       uint8_t headerType,
+                                       uint8_t headerPlacement);
 
 /**
  * @internal
  * Initialised AEAD cipher with the proper AEAD-nonce, label, key etc. as used to
  * secure a SADFD message.
+ *
+ * The \p stk must be already expanded with hzl_AeadKeyExpand().
  */
 void
 hzl_CommonAeadInitSadfd(hzl_Aead_t* aead,
-                        const uint8_t* stk,
+                        hzl_AeadKey_t* stk,
                         const hzl_Header_t* unpackedSadfdHeader,
                         hzl_CtrNonce_t ctrnonce,
                         uint8_t plaintextLen);
 
+#if HZL_SADTP
+/**
+ * @internal
+ * Initialised AEAD cipher with the proper AEAD-nonce, label, key etc. as used to
+ * secure a SADTP message.
+ *
+ * Same as hzl_CommonAeadInitSadfd(), but with the SADTP label and 2-bytes \p plaintextLen.
+ * The \p stk must be already expanded with hzl_AeadKeyExpand().
+ */
+void
+hzl_CommonAeadInitSadtp(hzl_Aead_t* aead,
+                        hzl_AeadKey_t* stk,
+                        const hzl_Header_t* unpackedSadtpHeader,
+                        hzl_CtrNonce_t ctrnonce,
+                        uint16_t plaintextLen);
+
+/**
+ * @internal
+ * Validates a SADTP message to-be-transmitted provided by the user through the public API.
+ *
+ * Same as hzl_CommonCheckMsgBeforePacking(), but with the limits of the SADTP messages.
+ *
+ * @param [in] userData SDU as provided to the public API.
+ * @param [in] userDataLen length of \p userData in bytes as provided to the public API.
+ * @param [in] group GID of the destination group.
+ * @param [in] maxFrameLen length of the frames to build, as provided to the public API.
+ * @param [in] headerType to access the maximum GID and SID etc.
+ * @param [in] headerPlacement to know how much of the header is in the payload
+ *
+ * @retval #HZL_OK on a valid message, the specific error code if something is incorrect
+ */
+hzl_Err_t
+hzl_CommonCheckSadtpBeforePacking(const uint8_t* userData,
+                                  size_t userDataLen,
+                                  hzl_Gid_t group,
+                                  size_t maxFrameLen,
+                                  uint8_t headerType,
+                                  uint8_t headerPlacement);
+
+/**
+ * @internal
+ * Prepares the transmission of a SADTP message for both the Server and Client.
+ * Implements the main behaviour of hzl_ClientBuildSecuredTpStart() and
+ * hzl_ServerBuildSecuredTpStart(), after the caller validated everything.
+ *
+ * Does not increment the Counter Nonce: the caller does.
+ *
+ * @param [out] tx state of the transmission, already zeroed out
+ * @param [in] stk current STK of the Group, already expanded with hzl_AeadKeyExpand()
+ * @param [in] unpackedSadtpHeader header of every frame
+ * @param [in] ctrnonce current Counter Nonce of the Group
+ * @param [in, out] userData plaintext, encrypted in place
+ * @param [in] userDataLen length of \p userData in bytes
+ * @param [in] maxFrameLen length of the frames to build in bytes, already validated
+ * @param [in] headerType
+ * @param [in] headerPlacement
+ */
+void
+hzl_CommonBuildSecuredTpStart(hzl_SadtpTx_t* tx,
+                              hzl_AeadKey_t* stk,
+                              const hzl_Header_t* unpackedSadtpHeader,
+                              hzl_CtrNonce_t ctrnonce,
+                              uint8_t* userData,
+                              size_t userDataLen,
+                              size_t maxFrameLen,
+                              uint8_t headerType,
+                              uint8_t headerPlacement);
+
+/**
+ * @internal
+ * Implementation of hzl_ClientBuildSecuredTpNext() and hzl_ServerBuildSecuredTpNext(),
+ * identical for the Server and Client.
+ */
+hzl_Err_t
+hzl_CommonBuildSecuredTpNext(hzl_CbsPduMsg_t* securedPdu,
+                             hzl_SadtpTx_t* tx);
+
+/**
+ * @internal
+ * Releases the reassembly slots holding a SADTP message delivered to the user with the
+ * previously processed frame, securely clearing them.
+ *
+ * To be called before processing every SADTP frame.
+ */
+void
+hzl_CommonSadtpRxReleaseDelivered(hzl_SadtpRxPool_t* pool);
+
+/**
+ * @internal
+ * Securely clears a reassembly slot, making it free for the next SADTP message.
+ */
+void
+hzl_CommonSadtpRxRelease(hzl_SadtpRxSlot_t* slot);
+
+/**
+ * @internal
+ * Finds the reassembly slot of the SADTP message the received frame belongs to, validating
+ * the Protocol Control Information of the frame.
+ *
+ * A First Frame takes the slot of the previous, unfinished message of the same sender and
+ * Group, if any, or a free one, or one of a message that timed out, restarting it.
+ * The unfinished message of the same sender is restarted only if it timed out or if the
+ * First Frame carries a newer ctrnonce: otherwise the First Frame is ignored.
+ * A Consecutive Frame continues the message of its sender and Group, if it did not time out
+ * and its sequence number is the expected one. Otherwise the frame is ignored, as frames
+ * are not authenticated before the tag, but the message is kept.
+ *
+ * @param [out] slot reassembly slot of the message of the frame, with the reception timestamp
+ *        updated
+ * @param [in, out] pool of the reassembly slots
+ * @param [in] unpackedSadtpHeader metadata of the received frame
+ * @param [in] pci Protocol Control Information byte of the received frame
+ * @param [in] segment segment of the message in the received frame, after the \p pci
+ * @param [in] segmentLen length of \p segment in bytes
+ * @param [in] rxTimestamp timestamp of reception of the frame
+ *
+ * @retval #HZL_OK when the frame continues or starts a message in \p slot
+ * @retval #HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_SADTP on an unknown frame type
+ * @retval #HZL_ERR_SADTP_POOL_FULL when no slot is available for a new message
+ * @retval #HZL_ERR_SADTP_UNEXPECTED_SEGMENT when no message is waiting for the Consecutive
+ *         Frame or it has the wrong sequence number, or when the First Frame cannot restart
+ *         the unfinished message of its sender
+ * @retval #HZL_ERR_SADTP_TIMEOUT when the message of the Consecutive Frame timed out
+ */
+hzl_Err_t
+hzl_CommonSadtpRxFindSlot(hzl_SadtpRxSlot_t** slot,
+                          hzl_SadtpRxPool_t* pool,
+                          const hzl_Header_t* unpackedSadtpHeader,
+                          uint8_t pci,
+                          const uint8_t* segment,
+                          size_t segmentLen,
+                          hzl_Timestamp_t rxTimestamp);
+
+/**
+ * @internal
+ * Absorbs the segment bytes belonging to the ctrnonce and ptlen fields of the message,
+ * which may be split across frames.
+ *
+ * @return amount of bytes of \p segment consumed, zero if the fields are already complete
+ */
+size_t
+hzl_CommonSadtpRxAbsorbMetadata(hzl_SadtpRxSlot_t* slot,
+                                const uint8_t* segment,
+                                size_t segmentLen);
+
+/** @internal True when the ctrnonce and ptlen fields of the message are fully received. */
+static inline bool
+hzl_CommonSadtpRxHasMetadata(const hzl_SadtpRxSlot_t* const slot)
+{
+    return slot->receivedLen >= HZL_SADTP_CTEXT_IDX;
+}
+
+/**
+ * @internal
+ * Validates the ptlen field and starts the decryption of the message with the given STK,
+ * as soon as its metadata is received.
+ *
+ * @param [in, out] slot reassembly slot with the metadata received
+ * @param [in] stk STK chosen according to the ctrnonce, already expanded
+ * @param [in] unpackedSadtpHeader metadata of the received frame
+ * @param [in] maxSduLen longest user data the caller can deliver, at most
+ *        #HZL_SADTP_MAX_SDU_LEN
+ *
+ * Securely clears the slot on error.
+ *
+ * @retval #HZL_OK on success
+ * @retval #HZL_ERR_TOO_LONG_CIPHERTEXT if ptlen exceeds #HZL_SADTP_MAX_SDU_LEN
+ * @retval #HZL_ERR_TOO_SHORT_OUTPUT_BUFFER if ptlen exceeds \p maxSduLen
+ */
+hzl_Err_t
+hzl_CommonSadtpRxStart(hzl_SadtpRxSlot_t* slot,
+                       hzl_AeadKey_t* stk,
+                       const hzl_Header_t* unpackedSadtpHeader,
+                       size_t maxSduLen);
+
+/**
+ * @internal
+ * Absorbs the segment bytes belonging to the ciphertext and tag of the message, decrypting the
+ * ciphertext as it arrives with the streaming AEAD backends. Bytes after the tag are padding
+ * and ignored.
+ */
+void
+hzl_CommonSadtpRxAbsorbPayload(hzl_SadtpRxSlot_t* slot,
+                               const uint8_t* segment,
+                               size_t segmentLen);
+
+/** @internal True when the whole message, up to the tag, is received. */
+static inline bool
+hzl_CommonSadtpRxIsComplete(const hzl_SadtpRxSlot_t* const slot)
+{
+    return hzl_CommonSadtpRxHasMetadata(slot)
+           && slot->receivedLen >= HZL_SADTP_MSG_LEN(HZL_AEAD_PTLEN_TO_CTLEN((size_t) slot->ptlen));
+}
+
+/**
+ * @internal
+ * Completes the decryption of the fully received message and validates its tag.
+ *
+ * Securely clears the slot if the tag is invalid.
+ *
+ * @param [in, out] slot reassembly slot with the whole message received
+ *
+ * @retval #HZL_OK if the tag is valid and the slot holds the plaintext
+ * @retval #HZL_ERR_SECWARN_INVALID_TAG otherwise
+ */
+hzl_Err_t
+hzl_CommonSadtpRxFinish(hzl_SadtpRxSlot_t* slot);
+
+/**
+ * @internal
+ * Fills the user's view of a validated SADTP message, pointing into the slot, and marks the
+ * slot as delivered, to be released when the next SADTP frame is processed.
+ */
+void
+hzl_CommonSadtpRxDeliver(hzl_RxSduView_t* unpackedView,
+                         hzl_SadtpRxSlot_t* slot);
+#endif  /* HZL_SADTP */
+
 /**
  * @internal
  * Initialised AEAD cipher with the proper AEAD-nonce, label, key etc. as used to
  * secure a RES message.
+ *
+ * The \p ltk must be already expanded with hzl_AeadKeyExpand().
  */
 void
 hzl_CommonAeadInitRes(hzl_Aead_t* aead,
-                      const uint8_t* ltk,
+                      hzl_AeadKey_t* ltk,
                       const hzl_Header_t* unpackedResHeader,
                       const uint8_t* encodedCtrNonce,
                       const uint8_t* encodedRequestNonce,
                       const uint8_t* encodedResponseNonce,
                       hzl_Sid_t clientSid);
 
+/**
+ * @internal
+ * Initialises the Hash function with the constant prefix of every REQ message tag of a Client:
+ * `LTK || label`.
+ *
+ * The resulting state may be stored with hzl_HashSaveMidstate() and resumed for every
+ * Request of the same Client.
+ */
+void
+hzl_ReqHashInitPrefix(hzl_Hash_t* hash,
+                      const uint8_t* ltk);
+
+/**
+ * @internal
+ * Feeds the message-specific part of the REQ message tag into the Hash function
+ * already holding the prefix: `GID || SID || PTY || reqnonce`.
+ */
+void
+hzl_ReqHashUpdateMsg(hzl_Hash_t* hash,
+                     const hzl_Header_t* unpackedReqHeader,
+                     const uint8_t* reqNonce);
+
 /**
  * @internal
  * Initialised Hash function with the proper reqnonce, label, key etc. as used to
@@ -161,7 +426,7 @@ hzl_ReqHashInit(hzl_Hash_t* hash,
  * @param [in] lastValidRxMsgInstant timestamp of the last valid received message (`m`)
  * @param [in] evaluationInstant timestamp of the reception of the current Counter Nonce (`t`)
  * @param [in] maxCtrNonceDelay configuration parameter (`D`)
- * @param [in] maxSilenceInterval configuration parameter (`S`)
+ * @param [in] maxSilenceInterval configuration parameter (`S`), in [0, 0xFFFF]
  * @return the allowed delay, expressed in the same unit as the Counter Nonce (i.e. unitless)
  */
 hzl_CtrNonce_t
@@ -0,0 +1,77 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Implementation of the hzl_OsArenaReserve(), hzl_OsArenaAlloc() and hzl_OsArenaFree()
+ * functions.
+ */
+
+#include "hzl.h"
+#include "hzl_CommonInternal.h"
+
+#if HZL_OS_AVAILABLE
+
+size_t
+hzl_OsArenaReserve(size_t* const arenaLen,
+                   const size_t len)
+{
+    const size_t offset = *arenaLen;
+    // Every region starts on its own cache line, so the arena length stays a multiple
+    // of the alignment, as aligned_alloc() requires
+    *arenaLen = (offset + len + HZL_CACHE_LINE_LEN - 1U) & ~((size_t) HZL_CACHE_LINE_LEN - 1U);
+    return offset;
+}
+
+void*
+hzl_OsArenaAlloc(const size_t arenaLen)
+{
+#if HZL_OS_AVAILABLE_WIN
+    void* const arena = _aligned_malloc(arenaLen, HZL_CACHE_LINE_LEN);
+#else
+    void* const arena = aligned_alloc(HZL_CACHE_LINE_LEN, arenaLen);
+#endif
+    if (arena != NULL) { memset(arena, 0, arenaLen); }
+    return arena;
+}
+
+void
+hzl_OsArenaFree(void* const arena,
+                const size_t arenaLen)
+{
+    if (arena == NULL) { return; }
+    hzl_ZeroOut(arena, arenaLen);
+#if HZL_OS_AVAILABLE_WIN
+    _aligned_free(arena);
+#else
+    free(arena);
+#endif
+}
+
+#endif  /* HZL_OS_AVAILABLE */
@@ -0,0 +1,79 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Implementation of the SocketCAN acceptance filters shared by the Client and Server.
+ */
+
+#include "hzl.h"
+#include "hzl_CommonInternal.h"
+#include "hzl_CommonHeader.h"
+
+#if HZL_OS_AVAILABLE_LINUX
+
+bool
+hzl_OsCanFilterPerGroup(const uint8_t headerType,
+                        const uint8_t headerPlacement)
+{
+    return headerPlacement != HZL_HEADER_IN_PAYLOAD && hzl_HeaderTypeMaxGid(headerType) > 0U;
+}
+
+void
+hzl_OsCanFilter(struct can_filter* const filter,
+                const hzl_Gid_t gid,
+                const uint8_t headerType,
+                const uint8_t headerPlacement)
+{
+    if (headerPlacement == HZL_HEADER_IN_PAYLOAD)
+    {
+        // Nothing to match: the CAN ID is the user's choice
+        filter->can_id = 0U;
+        filter->can_mask = 0U;
+        return;
+    }
+    // Packing the header with all GID bits set and zero SID and PTY gives the mask of the GID
+    const hzl_Header_t hdr = {.gid = gid, .sid = 0U, .pty = 0U};
+    const hzl_Header_t gidBits = {.gid = hzl_HeaderTypeMaxGid(headerType), .sid = 0U, .pty = 0U};
+    uint8_t unusedPty[HZL_PTY_LEN];  // Written with the mixed placement only
+    hzl_CanId_t id;
+    hzl_CanId_t mask;
+    hzl_HeaderPackPlaced(unusedPty, &id, &hdr, headerType, headerPlacement);
+    hzl_HeaderPackPlaced(unusedPty, &mask, &gidBits, headerType, headerPlacement);
+    filter->can_id = id;
+    filter->can_mask = mask | CAN_RTR_FLAG;  // CBS frames are never remote frames
+    if (hzl_HeaderLen(headerType) > 1U)
+    {
+        // Longer than an 11-bit base CAN ID
+        filter->can_id |= CAN_EFF_FLAG;
+        filter->can_mask |= CAN_EFF_FLAG;
+    }
+}
+
+#endif  /* HZL_OS_AVAILABLE_LINUX */
@@ -0,0 +1,206 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Implementation of the hzl_OsCsprng() function: a buffered DRBG seeded by the OS.
+ *
+ * Each thread owns a pool of random bytes, generated in bulk with Ascon-XOF from a secret key.
+ * Every refill absorbs the current key and squeezes out the next key followed by the new pool,
+ * so the key is never reused and a compromised state does not reveal past outputs.
+ * Fresh OS entropy from hzl_OsTrng() is mixed in when seeding and then every
+ * #HZL_CSPRNG_REFILLS_PER_RESEED refills.
+ *
+ * On Unix-like systems the state of a thread is wiped when the thread exits, so its last key
+ * and unused pool bytes are not left behind in the freed thread-local storage.
+ * On Windows it's not: a thread exiting after using the CSPRNG leaves them in memory.
+ */
+
+// For pthread_atfork() also when compiling with a strict -std=c11.
+// Must precede any system header, including the ones from hzl.h.
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "hzl_CommonInternal.h"
+#include "hzl_CommonHash.h"
+
+#if HZL_OS_AVAILABLE
+
+#if HZL_OS_AVAILABLE_NIX
+#include <pthread.h>  /* For pthread_atfork(), pthread_once(), pthread_key_create() */
+#endif
+
+/** @internal Thread-local storage class specifier. */
+#if defined(_MSC_VER)
+#define HZL_THREAD_LOCAL __declspec(thread)
+#else
+#define HZL_THREAD_LOCAL _Thread_local
+#endif
+
+/** @internal Length in bytes of the DRBG secret key. */
+#define HZL_CSPRNG_KEY_LEN 32U
+/** @internal Length in bytes of the pool of random bytes generated at every refill. */
+#define HZL_CSPRNG_POOL_LEN 256U
+/** @internal Amount of refills (i.e. pool lengths of output) between two reseedings. */
+#define HZL_CSPRNG_REFILLS_PER_RESEED 1024U
+/** @internal Amount of OS entropy bytes mixed into the key at every reseeding. */
+#define HZL_CSPRNG_SEED_LEN 32U
+/** @internal Domain separation label of the DRBG, to avoid clashes with the CBS tags. */
+#define HZL_CSPRNG_LABEL "hzl_csprng"
+/** @internal Length of #HZL_CSPRNG_LABEL without the null terminator. */
+#define HZL_CSPRNG_LABEL_LEN 10U
+
+/** @internal State of the DRBG of one thread. */
+typedef struct hzl_CsprngState
+{
+    /** Secret key followed by the pool, squeezed out in one go from the XOF. */
+    uint8_t keyAndPool[HZL_CSPRNG_KEY_LEN + HZL_CSPRNG_POOL_LEN];
+    /** Amount of bytes of the pool already provided to the caller, which are zeroed. */
+    size_t poolUsed;
+    /** Refills since the last reseeding. */
+    uint32_t refillsSinceReseed;
+#if HZL_OS_AVAILABLE_NIX
+    /** Value of #hzl_csprngForkGeneration at the last seeding. */
+    uint32_t forkGeneration;
+#endif
+    /** False until the first seeding. */
+    bool isSeeded;
+} hzl_CsprngState_t;
+
+static HZL_THREAD_LOCAL hzl_CsprngState_t hzl_csprngState;
+
+#if HZL_OS_AVAILABLE_NIX
+/** @internal Amount of fork() calls that generated the current process, since the first
+ * seeding. A forked child must not repeat the output of its parent, so a change of this
+ * value forces a reseeding. Only written in the child right after fork(), when a single
+ * thread exists. */
+static volatile uint32_t hzl_csprngForkGeneration = 0;
+static pthread_once_t hzl_csprngRegisterOnce = PTHREAD_ONCE_INIT;
+/** @internal Key whose destructor wipes the DRBG state of an exiting thread. */
+static pthread_key_t hzl_csprngThreadExitKey;
+/** @internal False if the thread-exit key could not be created. */
+static bool hzl_csprngIsThreadExitKeyCreated = false;
+
+static void
+hzl_CsprngAtForkChild(void)
+{
+    hzl_csprngForkGeneration++;
+}
+
+static void
+hzl_CsprngAtThreadExit(void* const state)
+{
+    hzl_ZeroOut(state, sizeof(hzl_CsprngState_t));
+}
+
+static void
+hzl_CsprngRegister(void)
+{
+    pthread_atfork(NULL, NULL, hzl_CsprngAtForkChild);
+    hzl_csprngIsThreadExitKeyCreated =
+            pthread_key_create(&hzl_csprngThreadExitKey, hzl_CsprngAtThreadExit) == 0;
+}
+#endif
+
+/** @internal Replaces key and pool, mixing in fresh OS entropy when due. */
+static hzl_Err_t
+hzl_CsprngRefill(hzl_CsprngState_t* const state,
+                 const bool mustReseed)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_Hash_t xof;
+    uint8_t seed[HZL_CSPRNG_SEED_LEN];
+
+    hzl_HashInit(&xof);
+    hzl_HashUpdate(&xof, (const uint8_t*) HZL_CSPRNG_LABEL, HZL_CSPRNG_LABEL_LEN);
+    hzl_HashUpdate(&xof, state->keyAndPool, HZL_CSPRNG_KEY_LEN);
+    if (mustReseed)
+    {
+        err = hzl_OsTrng(seed, HZL_CSPRNG_SEED_LEN);
+        HZL_ERR_CLEANUP(err);
+        hzl_HashUpdate(&xof, seed, HZL_CSPRNG_SEED_LEN);
+        state->refillsSinceReseed = 0;
+#if HZL_OS_AVAILABLE_NIX
+        pthread_once(&hzl_csprngRegisterOnce, hzl_CsprngRegister);
+        state->forkGeneration = hzl_csprngForkGeneration;
+        if (!state->isSeeded && hzl_csprngIsThreadExitKeyCreated)
+        {
+            // First seeding in this thread: wipe the state when it exits.
+            pthread_setspecific(hzl_csprngThreadExitKey, state);
+        }
+#endif
+    }
+    hzl_HashDigest(&xof, state->keyAndPool, sizeof(state->keyAndPool));
+    state->poolUsed = 0;
+    state->refillsSinceReseed++;
+    state->isSeeded = true;
+    err = HZL_OK;
+cleanup:
+    hzl_ZeroOut(&xof, sizeof(xof));
+    hzl_ZeroOut(seed, sizeof(seed));
+    return err;
+}
+
+hzl_Err_t
+hzl_OsCsprng(uint8_t* buffer, size_t amount)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_CsprngState_t* const state = &hzl_csprngState;
+    bool mustReseed = !state->isSeeded;
+#if HZL_OS_AVAILABLE_NIX
+    mustReseed = mustReseed || state->forkGeneration != hzl_csprngForkGeneration;
+#endif
+    if (mustReseed)
+    {
+        err = hzl_CsprngRefill(state, true);
+        HZL_ERR_CHECK(err);
+    }
+    while (amount > 0)
+    {
+        if (state->poolUsed == HZL_CSPRNG_POOL_LEN)
+        {
+            err = hzl_CsprngRefill(
+                    state, state->refillsSinceReseed >= HZL_CSPRNG_REFILLS_PER_RESEED);
+            HZL_ERR_CHECK(err);
+        }
+        uint8_t* const pool = &state->keyAndPool[HZL_CSPRNG_KEY_LEN];
+        size_t chunkLen = HZL_CSPRNG_POOL_LEN - state->poolUsed;
+        if (chunkLen > amount) { chunkLen = amount; }
+        memcpy(buffer, &pool[state->poolUsed], chunkLen);
+        // Bytes provided to the caller are not kept in memory
+        hzl_ZeroOut(&pool[state->poolUsed], chunkLen);
+        state->poolUsed += chunkLen;
+        buffer += chunkLen;
+        amount -= chunkLen;
+    }
+    return HZL_OK;
+}
+
+#endif  /* HZL_OS_AVAILABLE */
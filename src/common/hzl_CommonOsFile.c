@@ -0,0 +1,66 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Implementation of the hzl_OsReadFile() function.
+ */
+
+#include "hzl.h"
+#include "hzl_CommonInternal.h"
+
+#if HZL_OS_AVAILABLE
+
+hzl_Err_t
+hzl_OsReadFile(uint8_t** const pBytes,
+               size_t* const len,
+               const char* const fileName,
+               const size_t maxLen)
+{
+    *pBytes = NULL;
+    *len = 0U;
+    // Binary mode, otherwise Windows would translate the bytes looking like line endings
+    FILE* const fileStream = fopen(fileName, "rb");
+    if (fileStream == NULL) { return HZL_ERR_CANNOT_OPEN_CONFIG_FILE; }
+    uint8_t* const bytes = malloc(maxLen);
+    if (bytes == NULL)
+    {
+        fclose(fileStream);
+        return HZL_ERR_MALLOC_FAILED;
+    }
+    // Read at once into the buffer, without copying through the stdio one
+    (void) setvbuf(fileStream, NULL, _IONBF, 0U);
+    // A read error is like a premature end of file: the parser finds out the file is too short
+    *len = fread(bytes, 1U, maxLen, fileStream);
+    fclose(fileStream);
+    *pBytes = bytes;
+    return HZL_OK;
+}
+
+#endif  /* HZL_OS_AVAILABLE */
@@ -29,9 +29,15 @@
 /**
  * @file
  * @internal
- * Implementation of the hzl_OsTrng() function for different operating systems.
+ * Implementation of the hzl_OsCurrentTime() function for different operating systems.
  */
 
+// For clock_gettime() also when compiling with a strict -std=c11.
+// Must precede any system header, including the ones from hzl.h.
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
 #include "hzl_CommonInternal.h"
 
 #if HZL_OS_AVAILABLE_WIN
@@ -89,17 +95,19 @@ hzl_Err_t
 hzl_OsCurrentTime(hzl_Timestamp_t* const timestamp)
 {
     // Timestamp is never NULL, guaranteed by the caller.
-    struct timeval now;
-    // gettimeofday provides the amount of seconds.microseconds since
-    // 1970-01-01T00:00:00.000 UTC, a.k.a. Epoch, a.k.a. Unix time.
-    if (gettimeofday(&now, NULL) == 0)
+    struct timespec now;
+    // The monotonic clock provides the amount of seconds.nanoseconds since an unspecified
+    // point in time (usually the boot). Unlike gettimeofday() it does not jump when the
+    // wall-clock time is adjusted, which would break the freshness checks.
+    // On Linux it's served by the vDSO without entering the kernel.
+    if (clock_gettime(CLOCK_MONOTONIC, &now) == 0)
     {
-        // Convert seconds and remainder microseconds since Unix Epoch to milliseconds since it.
+        // Convert seconds and remainder nanoseconds to milliseconds.
         // Truncate the high bits, a we only need timestamps that show us a relative
         // time for a short timeframe (some days at the very most).
         // No rounding, we don't need this kind of accuracy.
         *timestamp = (hzl_Timestamp_t) ((hzl_Timestamp_t) now.tv_sec * 1000U);
-        *timestamp += (hzl_Timestamp_t) ((hzl_Timestamp_t) now.tv_usec / 1000U);
+        *timestamp += (hzl_Timestamp_t) ((hzl_Timestamp_t) (now.tv_nsec / 1000000L));
         return HZL_OK;
     }
     else
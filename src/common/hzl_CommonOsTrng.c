@@ -54,9 +54,45 @@ hzl_OsTrng(uint8_t* const buffer, const size_t amount)
 
 #elif HZL_OS_AVAILABLE_NIX
 
+// getrandom() where the header is available, otherwise /dev/urandom only. Can be forced
+// to 0 or 1 with a define from the build system.
+#ifndef HZL_OS_GETRANDOM_AVAILABLE
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/random.h>)
+#define HZL_OS_GETRANDOM_AVAILABLE 1
+#endif
+#endif
+#endif
+#ifndef HZL_OS_GETRANDOM_AVAILABLE
+#define HZL_OS_GETRANDOM_AVAILABLE 0
+#endif
+#if HZL_OS_GETRANDOM_AVAILABLE
+#include <sys/random.h>  /* For getrandom(), glibc 2.25+ */
+#include <errno.h>  /* For errno, EINTR */
+
+/** @internal Fills the buffer with the getrandom() syscall, without opening any file.
+ * @return true on success, false if the syscall is not available or fails. */
+static bool
+hzl_OsTrngGetrandom(uint8_t* const buffer, const size_t amount)
+{
+    size_t obtained = 0;
+    while (obtained < amount)
+    {
+        const ssize_t got = getrandom(&buffer[obtained], amount - obtained, 0);
+        if (got >= 0) { obtained += (size_t) got; }
+        else if (errno != EINTR) { return false; }
+    }
+    return true;
+}
+#endif
+
 hzl_Err_t
 hzl_OsTrng(uint8_t* const buffer, const size_t amount)
 {
+#if HZL_OS_GETRANDOM_AVAILABLE
+    if (hzl_OsTrngGetrandom(buffer, amount)) { return HZL_OK; }
+    // Kernel older than 3.17: fall back to the device file
+#endif
     FILE* urandom = fopen("/dev/urandom", "r");
     size_t obtained = 0;
     if (urandom != NULL)
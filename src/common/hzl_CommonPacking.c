@@ -41,12 +41,13 @@ hzl_CommonCheckMsgBeforePacking(const uint8_t* const userData,
                                 const size_t userDataLen,
                                 const hzl_Gid_t group,
                                 const size_t metadataInPayloadLen,
-                                const uint8_t headerType)
+                                const uint8_t headerType,
+                                const uint8_t headerPlacement)
 {
     if (userData == NULL && userDataLen != 0) { return HZL_ERR_NULL_SDU; }
     const hzl_Gid_t maxGid = hzl_HeaderTypeMaxGid(headerType);
     if (group > maxGid) { return HZL_ERR_GID_TOO_LARGE_FOR_CONFIGURED_HEADER_TYPE; }
-    const uint8_t packedHdrLen = hzl_HeaderLen(headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(headerType, headerPlacement);
     const size_t maxDataLen = HZL_MAX_CAN_FD_DATA_LEN - packedHdrLen - metadataInPayloadLen;
     if (userDataLen > maxDataLen) { return HZL_ERR_TOO_LONG_SDU; }
     return HZL_OK;
@@ -59,14 +60,15 @@ hzl_Err_t
 hzl_CommonCheckReceivedGenericMsg(hzl_Header_t* const unpackedHdr,
                                   const uint8_t* const receivedPdu,
                                   const size_t receivedPduLen,
+                                  const hzl_CanId_t receivedCanId,
                                   const hzl_Sid_t receiverSid,
-                                  const uint8_t headerType)
+                                  const uint8_t headerType,
+                                  const uint8_t headerPlacement)
 {
     if (receivedPdu == NULL && receivedPduLen != 0) { return HZL_ERR_NULL_PDU; }
-    const uint8_t packedHdrLen = hzl_HeaderLen(headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(headerType, headerPlacement);
     if (receivedPduLen < packedHdrLen) { return HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_HEADER; }
-    hzl_HeaderUnpackFunc headerUnpackerFunc = hzl_HeaderUnpackFuncForType(headerType);
-    headerUnpackerFunc(unpackedHdr, receivedPdu);
+    hzl_HeaderUnpackPlaced(unpackedHdr, receivedPdu, receivedCanId, headerType, headerPlacement);
     if (unpackedHdr->sid == receiverSid) { return HZL_ERR_SECWARN_MESSAGE_FROM_MYSELF; }
     return HZL_OK;
 }
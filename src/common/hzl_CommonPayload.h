@@ -178,6 +178,53 @@ _Static_assert(HZL_SADFD_PAYLOAD_LEN(0) == 20,
 _Static_assert(HZL_SADFD_AEADNONCE_SID_END <= HZL_AEAD_NONCE_LEN,
                "SAD msg AEAD nonce is large enough to fit ctrnonce||GID||SID");
 
+#if HZL_SADTP
+// Secured Application Data over Transport Protocol (SADTP)
+// Every frame is: header || PCI || segment of the message.
+// The message, split into the segments, is: ctrnonce || ptlen || ctext || tag.
+#define HZL_SADTP_LABEL "cbs_secured_tp"
+#define HZL_SADTP_LABEL_LEN 14U
+
+// Protocol Control Information, like ISO-TP: frame type in the high nibble,
+// sequence number of the Consecutive Frames in the low one, starting from 1 and wrapping to 0.
+#define HZL_SADTP_PCI_IDX 0U
+#define HZL_SADTP_PCI_LEN 1U
+#define HZL_SADTP_PCI_FIRST_FRAME 0x10U
+#define HZL_SADTP_PCI_CONSECUTIVE_FRAME 0x20U
+#define HZL_SADTP_PCI_TYPE_MASK 0xF0U
+#define HZL_SADTP_PCI_SEQNR_MASK 0x0FU
+#define HZL_SADTP_SEGMENT_IDX (HZL_SADTP_PCI_IDX + HZL_SADTP_PCI_LEN)
+#define HZL_SADTP_MIN_SEGMENT_LEN 1U
+
+#define HZL_SADTP_CTRNONCE_IDX 0U
+#define HZL_SADTP_CTRNONCE_LEN HZL_CTRNONCE_LEN
+#define HZL_SADTP_CTRNONCE_END (HZL_SADTP_CTRNONCE_IDX + HZL_SADTP_CTRNONCE_LEN)
+
+#define HZL_SADTP_PTLEN_IDX HZL_SADTP_CTRNONCE_END
+#define HZL_SADTP_PTLEN_LEN 2U
+#define HZL_SADTP_PTLEN_END (HZL_SADTP_PTLEN_IDX + HZL_SADTP_PTLEN_LEN)
+
+#define HZL_SADTP_CTEXT_IDX HZL_SADTP_PTLEN_END
+#define HZL_SADTP_CTEXT_END(ctlen) (HZL_SADTP_PTLEN_END + (ctlen))
+
+#define HZL_SADTP_TAG_IDX(ctlen) HZL_SADTP_CTEXT_END(ctlen)
+#define HZL_SADTP_TAG_END(ctlen) (HZL_SADTP_TAG_IDX(ctlen) + HZL_SADTP_TAG_LEN)
+
+#define HZL_SADTP_METADATA_LEN (\
+        HZL_SADTP_CTRNONCE_LEN \
+        + HZL_SADTP_PTLEN_LEN \
+        + HZL_SADTP_TAG_LEN)
+#define HZL_SADTP_MSG_LEN(ctlen) (HZL_SADTP_METADATA_LEN + (ctlen))
+
+_Static_assert(HZL_SADTP_TAG_END(0) == HZL_SADTP_METADATA_LEN,
+               "The length of an SADTP message without data must be consistent with the "
+               "metadata length");
+_Static_assert(HZL_SADTP_TAG_LEN == HZL_SADFD_TAG_LEN,
+               "SADTP messages must be as strongly authenticated as SADFD ones.");
+_Static_assert(HZL_SADTP_MAX_SDU_LEN <= 0xFFFFU,
+               "SADTP ptlen field must fit the longest SDU.");
+#endif  /* HZL_SADTP */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,289 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Reassembly of received SADTP messages, common to the Server and Client.
+ *
+ * Each message being received occupies one slot of the #hzl_SadtpRxPool_t, identified by its
+ * sender and Group. The ciphertext is decrypted into the slot as the frames arrive, so the tag
+ * validation after the last frame is all that is left.
+ * The checks of the Counter Nonce are specific to the Server and Client, so they are up to the
+ * callers, between the steps of this file.
+ */
+
+#include "hzl.h"
+#include "hzl_CommonMessage.h"
+#include "hzl_CommonEndian.h"
+#include "hzl_CommonInternal.h"
+#include "hzl_CommonPayload.h"
+
+#include <string.h>
+
+#if HZL_SADTP
+
+void
+hzl_CommonSadtpRxRelease(hzl_SadtpRxSlot_t* const slot)
+{
+    // Also erases the copy of the STK in the AEAD state of an unfinished message.
+    hzl_ZeroOut(slot, sizeof(hzl_SadtpRxSlot_t));
+}
+
+void
+hzl_CommonSadtpRxReleaseDelivered(hzl_SadtpRxPool_t* const pool)
+{
+    for (size_t i = 0; i < HZL_SADTP_RX_SLOTS; i++)
+    {
+        if (pool->slots[i].isDelivered)
+        {
+            hzl_CommonSadtpRxRelease(&pool->slots[i]);
+        }
+    }
+}
+
+/** @internal True if the message in the slot received no frame for too long. */
+static inline bool
+hzl_CommonSadtpRxIsExpired(const hzl_SadtpRxSlot_t* const slot,
+                           const hzl_Timestamp_t rxTimestamp)
+{
+    return hzl_TimeDelta(slot->lastFrameInstant, rxTimestamp) > HZL_SADTP_RX_TIMEOUT_MILLIS;
+}
+
+/**
+ * @internal
+ * True if the First Frame carries a ctrnonce newer than the one of the unfinished message in
+ * the slot, as its sender would when giving up on it. False when either is not known yet.
+ */
+static inline bool
+hzl_CommonSadtpRxIsNewerFirstFrame(const hzl_SadtpRxSlot_t* const slot,
+                                   const uint8_t* const segment,
+                                   const size_t segmentLen)
+{
+    return slot->receivedLen >= HZL_SADTP_CTRNONCE_END
+           && segmentLen >= HZL_SADTP_CTRNONCE_END
+           && hzl_DecodeLe24(&segment[HZL_SADTP_CTRNONCE_IDX]) > slot->ctrNonce;
+}
+
+hzl_Err_t
+hzl_CommonSadtpRxFindSlot(hzl_SadtpRxSlot_t** const slot,
+                          hzl_SadtpRxPool_t* const pool,
+                          const hzl_Header_t* const unpackedSadtpHeader,
+                          const uint8_t pci,
+                          const uint8_t* const segment,
+                          const size_t segmentLen,
+                          const hzl_Timestamp_t rxTimestamp)
+{
+    hzl_SadtpRxSlot_t* ongoing = NULL;
+    hzl_SadtpRxSlot_t* free = NULL;
+    hzl_SadtpRxSlot_t* expired = NULL;
+    for (size_t i = 0; i < HZL_SADTP_RX_SLOTS; i++)
+    {
+        hzl_SadtpRxSlot_t* const candidate = &pool->slots[i];
+        if (!candidate->isBusy)
+        {
+            if (free == NULL) { free = candidate; }
+        }
+        else if (candidate->gid == unpackedSadtpHeader->gid
+                 && candidate->sid == unpackedSadtpHeader->sid)
+        {
+            ongoing = candidate;  // At most one message per sender and Group
+        }
+        else if (expired == NULL && hzl_CommonSadtpRxIsExpired(candidate, rxTimestamp))
+        {
+            expired = candidate;
+        }
+    }
+    hzl_SadtpRxSlot_t* found;
+    if (pci == HZL_SADTP_PCI_FIRST_FRAME)
+    {
+        if (ongoing != NULL)
+        {
+            // The frames are authenticated only by the tag at the end of the message: an
+            // unfinished one is restarted only when it timed out or with a newer ctrnonce,
+            // so a single injected First Frame cannot drop it.
+            if (!hzl_CommonSadtpRxIsExpired(ongoing, rxTimestamp)
+                && !hzl_CommonSadtpRxIsNewerFirstFrame(ongoing, segment, segmentLen))
+            {
+                return HZL_ERR_SADTP_UNEXPECTED_SEGMENT;
+            }
+            found = ongoing;  // The sender gave up on its previous message: restart it.
+        }
+        else if (free != NULL)
+        {
+            found = free;
+        }
+        else if (expired != NULL)
+        {
+            found = expired;
+            pool->timeouts++;
+        }
+        else
+        {
+            pool->overflows++;
+            return HZL_ERR_SADTP_POOL_FULL;
+        }
+        hzl_CommonSadtpRxRelease(found);
+        found->isBusy = true;
+        found->gid = unpackedSadtpHeader->gid;
+        found->sid = unpackedSadtpHeader->sid;
+        found->nextSeqNr = 1U;
+    }
+    else if ((pci & HZL_SADTP_PCI_TYPE_MASK) == HZL_SADTP_PCI_CONSECUTIVE_FRAME)
+    {
+        if (ongoing == NULL) { return HZL_ERR_SADTP_UNEXPECTED_SEGMENT; }
+        if (hzl_CommonSadtpRxIsExpired(ongoing, rxTimestamp))
+        {
+            hzl_CommonSadtpRxRelease(ongoing);
+            pool->timeouts++;
+            return HZL_ERR_SADTP_TIMEOUT;
+        }
+        if ((pci & HZL_SADTP_PCI_SEQNR_MASK) != ongoing->nextSeqNr)
+        {
+            // Repeated, out of order or injected frame: ignored, keeping the message, as
+            // it's not authenticated. If a frame was lost, the message is dropped when it
+            // times out or its sender starts a new one.
+            return HZL_ERR_SADTP_UNEXPECTED_SEGMENT;
+        }
+        ongoing->nextSeqNr = (uint8_t) ((ongoing->nextSeqNr + 1U) & HZL_SADTP_PCI_SEQNR_MASK);
+        found = ongoing;
+    }
+    else
+    {
+        return HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_SADTP;  // Unknown frame type
+    }
+    found->lastFrameInstant = rxTimestamp;
+    *slot = found;
+    return HZL_OK;
+}
+
+size_t
+hzl_CommonSadtpRxAbsorbMetadata(hzl_SadtpRxSlot_t* const slot,
+                                const uint8_t* const segment,
+                                const size_t segmentLen)
+{
+    size_t consumed = 0;
+    // Little endian fields, possibly split across frames: decoded one byte at a time.
+    while (consumed < segmentLen && slot->receivedLen < HZL_SADTP_CTEXT_IDX)
+    {
+        const uint8_t fieldByte = segment[consumed++];
+        if (slot->receivedLen < HZL_SADTP_CTRNONCE_END)
+        {
+            slot->ctrNonce |= (hzl_CtrNonce_t) fieldByte << (8U * slot->receivedLen);
+        }
+        else
+        {
+            slot->ptlen |= (uint16_t) (fieldByte
+                                       << (8U * (slot->receivedLen - HZL_SADTP_PTLEN_IDX)));
+        }
+        slot->receivedLen++;
+    }
+    return consumed;
+}
+
+hzl_Err_t
+hzl_CommonSadtpRxStart(hzl_SadtpRxSlot_t* const slot,
+                       hzl_AeadKey_t* const stk,
+                       const hzl_Header_t* const unpackedSadtpHeader,
+                       const size_t maxSduLen)
+{
+    if (slot->ptlen > HZL_SADTP_MAX_SDU_LEN)
+    {
+        // The message would not fit the slot.
+        hzl_CommonSadtpRxRelease(slot);
+        return HZL_ERR_TOO_LONG_CIPHERTEXT;
+    }
+    if (slot->ptlen > maxSduLen)
+    {
+        // Refused before the ctrnonce is consumed, so the sender can still send it another way.
+        hzl_CommonSadtpRxRelease(slot);
+        return HZL_ERR_TOO_SHORT_OUTPUT_BUFFER;
+    }
+    hzl_CommonAeadInitSadtp((hzl_Aead_t*) slot->aeadState, stk, unpackedSadtpHeader,
+                            slot->ctrNonce, slot->ptlen);
+    return HZL_OK;
+}
+
+void
+hzl_CommonSadtpRxAbsorbPayload(hzl_SadtpRxSlot_t* const slot,
+                               const uint8_t* const segment,
+                               const size_t segmentLen)
+{
+    const size_t ctlen = HZL_AEAD_PTLEN_TO_CTLEN((size_t) slot->ptlen);
+    const size_t msgLen = HZL_SADTP_MSG_LEN(ctlen);
+    size_t consumed = 0;
+    if (slot->receivedLen < HZL_SADTP_TAG_IDX(ctlen))
+    {
+        size_t ctextLen = HZL_SADTP_TAG_IDX(ctlen) - slot->receivedLen;
+        if (ctextLen > segmentLen) { ctextLen = segmentLen; }
+        // Decrypted right away, from the frame into the slot: the frame is not needed anymore.
+        slot->writtenLen += hzl_AeadDecryptUpdate((hzl_Aead_t*) slot->aeadState,
+                                                  &slot->data[slot->writtenLen],
+                                                  segment, ctextLen);
+        consumed += ctextLen;
+        slot->receivedLen += ctextLen;
+    }
+    if (consumed < segmentLen && slot->receivedLen < msgLen)
+    {
+        size_t tagLen = msgLen - slot->receivedLen;
+        if (tagLen > segmentLen - consumed) { tagLen = segmentLen - consumed; }
+        memcpy(&slot->tag[slot->receivedLen - HZL_SADTP_TAG_IDX(ctlen)], &segment[consumed],
+               tagLen);
+        slot->receivedLen += tagLen;
+    }
+    // Anything after the tag is padding of the last frame.
+}
+
+hzl_Err_t
+hzl_CommonSadtpRxFinish(hzl_SadtpRxSlot_t* const slot)
+{
+    const hzl_Err_t err = hzl_AeadDecryptFinal(
+            (hzl_Aead_t*) slot->aeadState, &slot->data[slot->writtenLen],
+            slot->tag, HZL_SADTP_TAG_LEN);
+    if (err != HZL_OK)
+    {
+        // Securely clear the decrypted data: it is not validated by the tag.
+        hzl_CommonSadtpRxRelease(slot);
+    }
+    return err;
+}
+
+void
+hzl_CommonSadtpRxDeliver(hzl_RxSduView_t* const unpackedView,
+                         hzl_SadtpRxSlot_t* const slot)
+{
+    unpackedView->data = slot->data;
+    unpackedView->wasSecured = true;
+    unpackedView->isForUser = true;
+    unpackedView->gid = slot->gid;
+    unpackedView->sid = slot->sid;
+    unpackedView->dataLen = slot->ptlen;
+    slot->isDelivered = true;
+}
+
+#endif  /* HZL_SADTP */
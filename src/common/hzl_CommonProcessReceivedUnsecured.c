@@ -39,14 +39,33 @@ hzl_CommonProcessReceivedUnsecured(hzl_RxSduMsg_t* const unpackedMsg,
                                    const uint8_t* const rxPdu,
                                    const size_t rxPduLen,
                                    const hzl_Header_t* const unpackedUadHeader,
-                                   const uint8_t headerType)
+                                   const uint8_t headerType,
+                                   const uint8_t headerPlacement)
 {
     unpackedMsg->wasSecured = false;
     unpackedMsg->isForUser = true;
     unpackedMsg->gid = unpackedUadHeader->gid;
     unpackedMsg->sid = unpackedUadHeader->sid;
-    const uint8_t packedHdrLen = hzl_HeaderLen(headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(headerType, headerPlacement);
     unpackedMsg->dataLen = rxPduLen - packedHdrLen;
     memcpy(unpackedMsg->data, rxPdu + packedHdrLen, unpackedMsg->dataLen);
     return HZL_OK;
 }
+
+hzl_Err_t
+hzl_CommonProcessReceivedUnsecuredView(hzl_RxSduView_t* const unpackedView,
+                                       const uint8_t* const rxPdu,
+                                       const size_t rxPduLen,
+                                       const hzl_Header_t* const unpackedUadHeader,
+                                       const uint8_t headerType,
+                                       const uint8_t headerPlacement)
+{
+    unpackedView->wasSecured = false;
+    unpackedView->isForUser = true;
+    unpackedView->gid = unpackedUadHeader->gid;
+    unpackedView->sid = unpackedUadHeader->sid;
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(headerType, headerPlacement);
+    unpackedView->dataLen = rxPduLen - packedHdrLen;
+    unpackedView->data = rxPdu + packedHdrLen;
+    return HZL_OK;
+}
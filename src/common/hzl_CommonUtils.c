@@ -86,3 +86,28 @@ hzl_ZeroOut(void* const buffer, size_t amountOfBytes)
     }
 #endif
 }
+
+void
+hzl_ClearReceivedOutputs(hzl_RxSduMsg_t* const receivedUserData,
+                         hzl_CbsPduMsg_t* const reactionPdu)
+{
+#if HZL_LAZY_OUTPUT_CLEARING
+    // Every byte after dataLen is already zero. The lengths are clamped, in case the user
+    // did not zero-initialise the outputs.
+    const size_t sduLen = receivedUserData->dataLen < HZL_MAX_CAN_FD_DATA_LEN
+                          ? receivedUserData->dataLen : HZL_MAX_CAN_FD_DATA_LEN;
+    hzl_ZeroOut(receivedUserData->data, sduLen);  // Previous plaintext
+    receivedUserData->dataLen = 0;
+    receivedUserData->canId = 0;
+    receivedUserData->gid = 0;
+    receivedUserData->sid = 0;
+    receivedUserData->wasSecured = false;
+    receivedUserData->isForUser = false;
+    // Every reaction is fully written up to its length and is transmitted in clear anyway
+    reactionPdu->dataLen = 0;
+    reactionPdu->canId = 0;
+#else
+    hzl_ZeroOut(receivedUserData, sizeof(hzl_RxSduMsg_t));
+    hzl_ZeroOut(reactionPdu, sizeof(hzl_CbsPduMsg_t));
+#endif
+}
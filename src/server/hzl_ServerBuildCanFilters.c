@@ -0,0 +1,65 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Implementation of the hzl_ServerBuildCanFilters() function.
+ */
+
+#include "hzl_ServerOs.h"
+#include "hzl_ServerInternal.h"
+#include "hzl_CommonInternal.h"
+
+#if HZL_OS_AVAILABLE_LINUX
+
+HZL_API hzl_Err_t
+hzl_ServerBuildCanFilters(struct can_filter* const filters,
+                          size_t* const amountOfFilters,
+                          const size_t filtersCapacity,
+                          const hzl_ServerCtx_t* const ctx)
+{
+    if (filters == NULL || amountOfFilters == NULL) { return HZL_ERR_NULL_CAN_FILTERS; }
+    *amountOfFilters = 0;  // Make output empty in case of later error.
+    HZL_ERR_DECLARE(err);
+    err = hzl_ServerCheckCtxPointers(ctx);
+    HZL_ERR_CHECK(err);
+    const hzl_ServerConfig_t* const config = ctx->serverConfig;
+    const size_t amount = hzl_OsCanFilterPerGroup(config->headerType, config->headerPlacement)
+                          ? config->amountOfGroups : 1U;
+    if (filtersCapacity < amount) { return HZL_ERR_TOO_SHORT_OUTPUT_BUFFER; }
+    for (size_t i = 0; i < amount; i++)
+    {
+        hzl_OsCanFilter(&filters[i], ctx->groupConfigs[i].gid,
+                        config->headerType, config->headerPlacement);
+    }
+    *amountOfFilters = amount;
+    return HZL_OK;
+}
+
+#endif  /* HZL_OS_AVAILABLE_LINUX */
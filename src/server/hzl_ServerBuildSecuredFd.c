@@ -29,7 +29,7 @@
 /**
  * @file
  * @internal
- * Implementation of hzl_ServerBuildSecuredFd().
+ * Implementation of hzl_ServerBuildSecuredFd() and hzl_ServerBuildSecuredFdInto().
  */
 
 #include "hzl.h"
@@ -50,12 +50,14 @@ hzl_ServerDidAnyClientAlreadyRequest(const hzl_ServerCtx_t* const ctx,
     // They will be equal again for one single millisecond when the timestamp rolls around,
     // 2^32 milliseconds after the session started (that is 49 DAYS!), but at that point the
     // Session will already be expired and renewed.
-    return ctx->groupStates[groupId].currentRxLastMessageInstant !=
-           ctx->groupStates[groupId].sessionStartInstant;
+    const hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHotConst(ctx, groupId);
+    return hot->currentRxLastMessageInstant != hot->sessionStartInstant;
 }
 
 inline static hzl_Err_t
-hzl_ServerBuildMsgSadfd(hzl_CbsPduMsg_t* const msgToTx,
+hzl_ServerBuildMsgSadfd(uint8_t* const pdu,
+                        size_t* const pduLen,
+                        hzl_CanId_t* const pduCanId,
                         hzl_ServerCtx_t* const ctx,
                         const uint8_t* const userData,
                         const size_t userDataLen,
@@ -67,40 +69,34 @@ hzl_ServerBuildMsgSadfd(hzl_CbsPduMsg_t* const msgToTx,
             .sid = HZL_SERVER_SID,
             .pty = HZL_PTY_SADFD,
     };
-    const uint8_t packedHdrLen = hzl_HeaderLen(ctx->serverConfig->headerType);
-    hzl_HeaderPackFunc const headerPackFunc =
-            hzl_HeaderPackFuncForType(ctx->serverConfig->headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->serverConfig->headerType,
+                                                        ctx->serverConfig->headerPlacement);
     // Prepare SADFD payload
-    // Write the packed header at the beginning of the CAN FD frame's payload.
-    headerPackFunc(msgToTx->data, &unpackedSadfdHeader);
+    // Write the packed header at the beginning of the CAN FD frame's payload and/or CAN ID.
+    hzl_HeaderPackPlaced(pdu, pduCanId, &unpackedSadfdHeader,
+                         ctx->serverConfig->headerType, ctx->serverConfig->headerPlacement);
     // Write counter nonce after the header
-    hzl_EncodeLe24(&msgToTx->data[packedHdrLen + HZL_SADFD_CTRNONCE_IDX],
-                   ctx->groupStates[groupId].currentCtrNonce);
-    msgToTx->data[packedHdrLen + HZL_SADFD_PTLEN_IDX] = (uint8_t) userDataLen;
+    hzl_EncodeLe24(&pdu[packedHdrLen + HZL_SADFD_CTRNONCE_IDX],
+                   hzl_ServerGroupHot(ctx, groupId)->currentCtrNonce);
+    pdu[packedHdrLen + HZL_SADFD_PTLEN_IDX] = (uint8_t) userDataLen;
     // Encrypt the plaintext (user-data a.k.a. SDU) into the ctext field of the SADFD message
+    hzl_AeadKeyExpand(&ctx->groupStates[groupId].currentAeadKey,
+                      ctx->groupStates[groupId].currentStk);
     hzl_Aead_t aead;
     hzl_CommonAeadInitSadfd(&aead,
-                            ctx->groupStates[groupId].currentStk,
+                            &ctx->groupStates[groupId].currentAeadKey,
                             &unpackedSadfdHeader,
-                            ctx->groupStates[groupId].currentCtrNonce,
+                            hzl_ServerGroupHot(ctx, groupId)->currentCtrNonce,
                             (uint8_t) userDataLen);
-    const size_t processedPtLen = hzl_AeadEncryptUpdate(
+    hzl_AeadEncrypt(
             &aead,
-            &msgToTx->data[packedHdrLen + HZL_SADFD_CTEXT_IDX],  // Output: ciphertext
+            &pdu[packedHdrLen + HZL_SADFD_CTEXT_IDX],  // Output: ciphertext
             userData,  // Input: plaintext
             userDataLen,
-            &msgToTx->data[packedHdrLen + HZL_SADFD_TAG_IDX(userDataLen)],
+            &pdu[packedHdrLen + HZL_SADFD_TAG_IDX(userDataLen)],
             HZL_SADFD_TAG_LEN);
-    // Finish authenticated encryption and write tag
-    /*
-    hzl_AeadEncryptFinish(
-            &aead,
-            &msgToTx->data[packedHdrLen + HZL_SADFD_CTEXT_IDX + processedPtLen],
-            &msgToTx->data[packedHdrLen + HZL_SADFD_TAG_IDX(userDataLen)],
-            HZL_SADFD_TAG_LEN);
-     */
     // Message is packed in binary format, ready to transmit
-    msgToTx->dataLen = packedHdrLen + HZL_SADFD_PAYLOAD_LEN(userDataLen);
+    *pduLen = packedHdrLen + HZL_SADFD_PAYLOAD_LEN(userDataLen);
     // Increment the counter nonce, regardless of transmission success
     hzl_ServerGroupIncrCurrentCtrnonce(ctx, groupId);
     return HZL_OK;
@@ -114,14 +110,42 @@ hzl_ServerBuildSecuredFd(hzl_CbsPduMsg_t* const securedPdu,
                          const hzl_Gid_t groupId)
 {
     if (securedPdu == NULL) { return HZL_ERR_NULL_PDU; }
-    securedPdu->dataLen = 0; // Make output message empty in case of later error.
+    return hzl_ServerBuildSecuredFdInto(securedPdu->data, sizeof(securedPdu->data),
+                                        &securedPdu->dataLen, &securedPdu->canId,
+                                        ctx, userData, userDataLen, groupId);
+}
+
+HZL_API hzl_Err_t
+hzl_ServerBuildSecuredFdInto(uint8_t* const securedPdu,
+                             const size_t securedPduCapacity,
+                             size_t* const securedPduLen,
+                             hzl_CanId_t* const securedPduCanId,
+                             hzl_ServerCtx_t* const ctx,
+                             const uint8_t* const userData,
+                             const size_t userDataLen,
+                             const hzl_Gid_t groupId)
+{
+    if (securedPdu == NULL || securedPduLen == NULL) { return HZL_ERR_NULL_PDU; }
+    *securedPduLen = 0; // Make output message empty in case of later error.
     HZL_ERR_DECLARE(err);
     err = hzl_ServerCheckCtxPointers(ctx);
     HZL_ERR_CHECK(err);
+    if (securedPduCanId == NULL && ctx->serverConfig->headerPlacement != HZL_HEADER_IN_PAYLOAD)
+    {
+        return HZL_ERR_NULL_PDU;  // The CAN ID is needed to transmit the header
+    }
+    hzl_CanId_t unusedCanId;  // Always 0 with the header in the payload
     err = hzl_CommonCheckMsgBeforePacking(
             userData, userDataLen, groupId,
-            HZL_SADFD_METADATA_IN_PAYLOAD_LEN, ctx->serverConfig->headerType);
+            HZL_SADFD_METADATA_IN_PAYLOAD_LEN,
+            ctx->serverConfig->headerType, ctx->serverConfig->headerPlacement);
     HZL_ERR_CHECK(err);
+    if (securedPduCapacity < hzl_HeaderLenInPayload(ctx->serverConfig->headerType,
+                                                    ctx->serverConfig->headerPlacement)
+                             + HZL_SADFD_PAYLOAD_LEN(userDataLen))
+    {
+        return HZL_ERR_TOO_SHORT_OUTPUT_BUFFER;
+    }
     if (groupId >= ctx->serverConfig->amountOfGroups)
     {
         return HZL_ERR_UNKNOWN_GROUP;
@@ -130,5 +154,7 @@ hzl_ServerBuildSecuredFd(hzl_CbsPduMsg_t* const securedPdu,
     {
         return HZL_ERR_NO_POTENTIAL_RECEIVER;
     }
-    return hzl_ServerBuildMsgSadfd(securedPdu, ctx, userData, userDataLen, groupId);
+    return hzl_ServerBuildMsgSadfd(securedPdu, securedPduLen,
+                                   securedPduCanId != NULL ? securedPduCanId : &unusedCanId,
+                                   ctx, userData, userDataLen, groupId);
 }
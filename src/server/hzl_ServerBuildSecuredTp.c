@@ -0,0 +1,93 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Implementation of hzl_ServerBuildSecuredTpStart() and hzl_ServerBuildSecuredTpNext().
+ */
+
+#include "hzl.h"
+#include "hzl_ServerInternal.h"
+#include "hzl_CommonHeader.h"
+#include "hzl_CommonMessage.h"
+
+#if HZL_SADTP
+
+HZL_API hzl_Err_t
+hzl_ServerBuildSecuredTpStart(hzl_SadtpTx_t* const tx,
+                              hzl_ServerCtx_t* const ctx,
+                              uint8_t* const userData,
+                              const size_t userDataLen,
+                              const hzl_Gid_t groupId,
+                              const size_t maxFrameLen)
+{
+    if (tx == NULL) { return HZL_ERR_NULL_SADTP_TX; }
+    hzl_ZeroOut(tx, sizeof(hzl_SadtpTx_t));
+    tx->isDone = true; // Nothing to transmit in case of later error.
+    HZL_ERR_DECLARE(err);
+    err = hzl_ServerCheckCtxPointers(ctx);
+    HZL_ERR_CHECK(err);
+    err = hzl_CommonCheckSadtpBeforePacking(
+            userData, userDataLen, groupId, maxFrameLen,
+            ctx->serverConfig->headerType, ctx->serverConfig->headerPlacement);
+    HZL_ERR_CHECK(err);
+    if (groupId >= ctx->serverConfig->amountOfGroups)
+    {
+        return HZL_ERR_UNKNOWN_GROUP;
+    }
+    if (!hzl_ServerDidAnyClientAlreadyRequest(ctx, groupId))
+    {
+        return HZL_ERR_NO_POTENTIAL_RECEIVER;
+    }
+    const hzl_Header_t unpackedSadtpHeader = {
+            .gid = groupId,
+            .sid = HZL_SERVER_SID,
+            .pty = HZL_PTY_SADTP,
+    };
+    hzl_AeadKeyExpand(&ctx->groupStates[groupId].currentAeadKey,
+                      ctx->groupStates[groupId].currentStk);
+    hzl_CommonBuildSecuredTpStart(tx, &ctx->groupStates[groupId].currentAeadKey,
+                                  &unpackedSadtpHeader,
+                                  hzl_ServerGroupHot(ctx, groupId)->currentCtrNonce,
+                                  userData, userDataLen, maxFrameLen,
+                                  ctx->serverConfig->headerType,
+                                  ctx->serverConfig->headerPlacement);
+    // Increment the counter nonce, regardless of transmission success
+    hzl_ServerGroupIncrCurrentCtrnonce(ctx, groupId);
+    return HZL_OK;
+}
+
+HZL_API hzl_Err_t
+hzl_ServerBuildSecuredTpNext(hzl_CbsPduMsg_t* const securedPdu,
+                             hzl_SadtpTx_t* const tx)
+{
+    return hzl_CommonBuildSecuredTpNext(securedPdu, tx);
+}
+
+#endif  /* HZL_SADTP */
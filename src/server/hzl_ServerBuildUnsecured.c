@@ -50,5 +50,6 @@ hzl_ServerBuildUnsecured(hzl_CbsPduMsg_t* const unsecuredPdu,
                                     userDataLen,
                                     groupId,
                                     HZL_SERVER_SID,
-                                    ctx->serverConfig->headerType);
+                                    ctx->serverConfig->headerType,
+                                    ctx->serverConfig->headerPlacement);
 }
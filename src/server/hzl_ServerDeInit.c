@@ -35,6 +35,7 @@
 #include "hzl.h"
 #include "hzl_Server.h"
 #include "hzl_ServerInternal.h"
+#include "hzl_CommonAead.h"
 
 HZL_API hzl_Err_t
 hzl_ServerDeInit(hzl_ServerCtx_t* const ctx)
@@ -42,7 +43,46 @@ hzl_ServerDeInit(hzl_ServerCtx_t* const ctx)
     if (ctx == NULL) { return HZL_ERR_NULL_CTX; }
     if (ctx->serverConfig == NULL) { return HZL_ERR_NULL_CONFIG_SERVER; }
     if (ctx->groupStates == NULL) { return HZL_ERR_NULL_STATES_GROUPS; }
+    for (size_t i = 0; i < ctx->serverConfig->amountOfGroups; i++)
+    {
+        hzl_AeadKeyClear(&ctx->groupStates[i].currentAeadKey);
+        hzl_AeadKeyClear(&ctx->groupStates[i].previousAeadKey);
+        hzl_AeadKeyClear(&ctx->groupStates[i].nextAeadKey);
+    }
     hzl_ZeroOut(ctx->groupStates,
                 ctx->serverConfig->amountOfGroups * sizeof(hzl_ServerGroupState_t));
+#if HZL_SERVER_SPLIT_GROUP_STATE
+    hzl_ZeroOut(ctx->groupHotStates, sizeof(ctx->groupHotStates));
+#endif
+    if (ctx->clientStates != NULL)
+    {
+        for (size_t i = 0; i < ctx->serverConfig->amountOfClients; i++)
+        {
+            hzl_AeadKeyClear(&ctx->clientStates[i].ltkAeadKey);
+        }
+        hzl_ZeroOut(ctx->clientStates,
+                    ctx->serverConfig->amountOfClients * sizeof(hzl_ServerClientState_t));
+    }
+    if (ctx->timerWheel != NULL)
+    {
+        hzl_ZeroOut(ctx->timerWheel, sizeof(hzl_ServerTimerWheel_t));
+    }
+    if (ctx->dosState != NULL)
+    {
+        hzl_ZeroOut(ctx->dosState, sizeof(hzl_ServerDosState_t));
+    }
+#if HZL_SERVER_REJECTED_CACHE_SLOTS > 0
+    if (ctx->rejectedCache != NULL)
+    {
+        hzl_ZeroOut(ctx->rejectedCache, sizeof(hzl_ServerRejectedCache_t));
+    }
+#endif
+#if HZL_SADTP
+    if (ctx->sadtpRxPool != NULL)
+    {
+        // Also erases the plaintexts and the STK copies of the messages being received.
+        hzl_ZeroOut(ctx->sadtpRxPool, sizeof(hzl_SadtpRxPool_t));
+    }
+#endif
     return HZL_OK;
 }
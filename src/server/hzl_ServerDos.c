@@ -0,0 +1,192 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Token buckets protecting the Server from a Denial-of-Service by limiting the received messages
+ * requiring cryptographic operations.
+ */
+
+#include "hzl.h"
+#include "hzl_Server.h"
+#include "hzl_ServerInternal.h"
+#include "hzl_CommonHeader.h"
+
+/** @internal Tokens in a bucket corresponding to one message. */
+#define HZL_SERVER_DOS_MILLITOKENS_PER_MSG 1000U
+
+/** @internal Largest elapsed time considered as forward in time. Anything larger is a
+ * timestamp preceding the last refill, e.g. in a batch with out-of-order timestamps. */
+#define HZL_SERVER_DOS_MAX_ELAPSED_MILLIS 0x7FFFFFFFUL
+
+/** @internal Returns true if the message type requires cryptographic operations and is thus
+ * subject to the DoS protection. */
+inline static bool
+hzl_ServerDosIsGated(const hzl_Header_t* const hdr)
+{
+    return hdr->pty == HZL_PTY_REQ || hdr->pty == HZL_PTY_SADFD || hdr->pty == HZL_PTY_SADTP;
+}
+
+/** @internal Fills the bucket completely. */
+inline static void
+hzl_ServerDosBucketFill(hzl_ServerDosBucket_t* const bucket,
+                        const hzl_ServerDosLimit_t* const limit,
+                        const hzl_Timestamp_t now)
+{
+    bucket->lastRefillInstant = now;
+    bucket->milliTokens = (uint32_t) limit->burstMsgs * HZL_SERVER_DOS_MILLITOKENS_PER_MSG;
+}
+
+/** @internal Adds the tokens accumulated since the last refill, up to the burst size.
+ * Returns true if the bucket contains at least one message worth of tokens afterwards or if its
+ * limit is disabled. */
+static bool
+hzl_ServerDosBucketRefill(hzl_ServerDosBucket_t* const bucket,
+                          const hzl_ServerDosLimit_t* const limit,
+                          const hzl_Timestamp_t now)
+{
+    if (limit->msgsPerSecond == 0U) { return true; }
+    const hzl_TimeDeltaMillis_t elapsed = now - bucket->lastRefillInstant;
+    if (elapsed != 0U && elapsed <= HZL_SERVER_DOS_MAX_ELAPSED_MILLIS)
+    {
+        // Rate in messages per second = rate in milli-tokens per millisecond
+        const uint64_t capacity =
+                (uint64_t) limit->burstMsgs * HZL_SERVER_DOS_MILLITOKENS_PER_MSG;
+        uint64_t tokens = bucket->milliTokens + (uint64_t) elapsed * limit->msgsPerSecond;
+        if (tokens > capacity) { tokens = capacity; }
+        bucket->milliTokens = (uint32_t) tokens;
+        bucket->lastRefillInstant = now;
+    }
+    return bucket->milliTokens >= HZL_SERVER_DOS_MILLITOKENS_PER_MSG;
+}
+
+/** @internal Removes one message worth of tokens, if any and if the limit is enabled. */
+inline static void
+hzl_ServerDosBucketConsume(hzl_ServerDosBucket_t* const bucket,
+                           const hzl_ServerDosLimit_t* const limit)
+{
+    if (limit->msgsPerSecond == 0U) { return; }
+    if (bucket->milliTokens >= HZL_SERVER_DOS_MILLITOKENS_PER_MSG)
+    {
+        bucket->milliTokens -= HZL_SERVER_DOS_MILLITOKENS_PER_MSG;
+    }
+    else
+    {
+        bucket->milliTokens = 0U;
+    }
+}
+
+/** @internal Checks a single limit of the configuration. */
+inline static hzl_Err_t
+hzl_ServerDosCheckLimit(const hzl_ServerDosLimit_t* const limit)
+{
+    if (limit->msgsPerSecond != 0U && limit->burstMsgs == 0U)
+    {
+        return HZL_ERR_INVALID_DOS_LIMIT;
+    }
+    return HZL_OK;
+}
+
+hzl_Err_t
+hzl_ServerDosCheckConfig(const hzl_ServerCtx_t* const ctx)
+{
+    if (ctx->dosConfig == NULL) { return HZL_OK; }
+    if (ctx->dosState == NULL) { return HZL_ERR_NULL_DOS_STATE; }
+    HZL_ERR_DECLARE(err);
+    err = hzl_ServerDosCheckLimit(&ctx->dosConfig->perClient);
+    HZL_ERR_CHECK(err);
+    err = hzl_ServerDosCheckLimit(&ctx->dosConfig->perGroup);
+    HZL_ERR_CHECK(err);
+    return hzl_ServerDosCheckLimit(&ctx->dosConfig->rejected);
+}
+
+void
+hzl_ServerDosInit(hzl_ServerCtx_t* const ctx,
+                  const hzl_Timestamp_t now)
+{
+    if (ctx->dosConfig == NULL) { return; }
+    hzl_ServerDosState_t* const state = ctx->dosState;
+    hzl_ZeroOut(&state->counters, sizeof(hzl_ServerDosCounters_t));
+    hzl_ServerDosBucketFill(&state->rejectedBucket, &ctx->dosConfig->rejected, now);
+    for (uint16_t i = 0U; i < HZL_MAX_SIDS; i++)
+    {
+        hzl_ServerDosBucketFill(&state->clientBuckets[i], &ctx->dosConfig->perClient, now);
+    }
+    for (uint16_t i = 0U; i < HZL_MAX_GIDS; i++)
+    {
+        hzl_ServerDosBucketFill(&state->groupBuckets[i], &ctx->dosConfig->perGroup, now);
+    }
+}
+
+hzl_Err_t
+hzl_ServerDosAdmit(hzl_ServerCtx_t* const ctx,
+                   const hzl_Header_t* const unpackedHdr,
+                   const hzl_Timestamp_t rxTimestamp)
+{
+    if (ctx->dosConfig == NULL || !hzl_ServerDosIsGated(unpackedHdr)) { return HZL_OK; }
+    const hzl_ServerDosConfig_t* const config = ctx->dosConfig;
+    hzl_ServerDosState_t* const state = ctx->dosState;
+    // The rejected budget is only peeked here: it's consumed by hzl_ServerDosAccount()
+    if (!hzl_ServerDosBucketRefill(&state->rejectedBucket, &config->rejected, rxTimestamp))
+    {
+        state->counters.droppedByRejectedBudget++;
+        return HZL_ERR_SECWARN_DENIAL_OF_SERVICE;
+    }
+    hzl_ServerDosBucket_t* const groupBucket = &state->groupBuckets[unpackedHdr->gid];
+    if (!hzl_ServerDosBucketRefill(groupBucket, &config->perGroup, rxTimestamp))
+    {
+        state->counters.droppedByGroupLimit++;
+        return HZL_ERR_SECWARN_DENIAL_OF_SERVICE;
+    }
+    hzl_ServerDosBucket_t* const clientBucket = &state->clientBuckets[unpackedHdr->sid];
+    if (!hzl_ServerDosBucketRefill(clientBucket, &config->perClient, rxTimestamp))
+    {
+        state->counters.droppedByClientLimit++;
+        return HZL_ERR_SECWARN_DENIAL_OF_SERVICE;
+    }
+    // Consume only once the message passed all limits, so a flooding Client does not drain
+    // the Group bucket with messages dropped anyway
+    hzl_ServerDosBucketConsume(groupBucket, &config->perGroup);
+    hzl_ServerDosBucketConsume(clientBucket, &config->perClient);
+    return HZL_OK;
+}
+
+void
+hzl_ServerDosAccount(hzl_ServerCtx_t* const ctx,
+                     const hzl_Header_t* const unpackedHdr,
+                     const hzl_Err_t result)
+{
+    if (ctx->dosConfig == NULL || !hzl_ServerDosIsGated(unpackedHdr)) { return; }
+    const bool isRejected = (HZL_IS_SECURITY_WARNING(result)
+                             && result != HZL_ERR_SECWARN_DENIAL_OF_SERVICE)
+                            || result == HZL_ERR_SECWARN_RECEIVED_ZERO_REQNONCE;
+    if (!isRejected) { return; }
+    ctx->dosState->counters.rejected++;
+    hzl_ServerDosBucketConsume(&ctx->dosState->rejectedBucket, &ctx->dosConfig->rejected);
+}
@@ -45,24 +45,12 @@ hzl_ServerFree(hzl_ServerCtx_t** const pCtx)
     hzl_ServerCtx_t* ctx = *pCtx;  // Dereference once to make the code more readable
     if (ctx->serverConfig != NULL)
     {
-        HZL_SECURE_FREE(ctx->groupStates,
-                        ctx->serverConfig->amountOfGroups *
-                        sizeof(hzl_ServerGroupState_t));
-        // Here we force the pointer to the constant configuration to be writable just once
-        // because we have to clear the configuration securely before freeing it.
-        HZL_SECURE_FREE(ctx->clientConfigs,
-                        ctx->serverConfig->amountOfClients *
-                        sizeof(hzl_ServerClientConfig_t));
-        // Here we force the pointer to the constant configuration to be writable just once
-        // because we have to clear the configuration securely before freeing it.
-        HZL_SECURE_FREE(ctx->groupConfigs,
-                        ctx->serverConfig->amountOfGroups *
-                        sizeof(hzl_ServerGroupConfig_t));
+        // Release the expanded keys cached in the states, if any.
+        (void) hzl_ServerDeInit(ctx);
     }
-    // Here we force the pointer to the constant configuration to be writable just once
-    // because we have to clear the configuration securely before freeing it.
-    HZL_SECURE_FREE(ctx->serverConfig, sizeof(hzl_ServerConfig_t));
-    HZL_SECURE_FREE(ctx, sizeof(hzl_ServerCtx_t));
+    // The context and all the arrays allocated by hzl_ServerNew() are one arena,
+    // including the constant configuration.
+    hzl_OsArenaFree(ctx, ctx->arenaLen);
     *pCtx = NULL;
 }
 
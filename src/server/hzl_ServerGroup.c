@@ -34,21 +34,23 @@
 #include "hzl_ServerInternal.h"
 
 void
-hzl_ServerGroupIncrCurrentCtrnonce(const hzl_ServerCtx_t* const ctx,
+hzl_ServerGroupIncrCurrentCtrnonce(hzl_ServerCtx_t* const ctx,
                                    const hzl_Gid_t groupId)
 {
-    if (!HZL_IS_CTRNONCE_EXPIRED(ctx->groupStates[groupId].currentCtrNonce))
+    hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHot(ctx, groupId);
+    if (!HZL_IS_CTRNONCE_EXPIRED(hot->currentCtrNonce))
     {
-        ctx->groupStates[groupId].currentCtrNonce++;
+        hot->currentCtrNonce++;
     }
 }
 
 void
-hzl_ServerGroupIncrPreviousCtrnonce(const hzl_ServerCtx_t* const ctx,
+hzl_ServerGroupIncrPreviousCtrnonce(hzl_ServerCtx_t* const ctx,
                                     const hzl_Gid_t groupId)
 {
-    if (!HZL_IS_CTRNONCE_EXPIRED(ctx->groupStates[groupId].previousCtrNonce))
+    hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHot(ctx, groupId);
+    if (!HZL_IS_CTRNONCE_EXPIRED(hot->previousCtrNonce))
     {
-        ctx->groupStates[groupId].previousCtrNonce++;
+        hot->previousCtrNonce++;
     }
 }
@@ -36,14 +36,16 @@
 #include "hzl_Server.h"
 #include "hzl_ServerInternal.h"
 #include "hzl_CommonHeader.h"
+#include "hzl_CommonMessage.h"
 
-/** @internal Verifies the content of the Server Configuration structure. */
-static hzl_Err_t
+hzl_Err_t
 hzl_ServerInitCheckServerConfig(const hzl_ServerConfig_t* const config)
 {
     HZL_ERR_DECLARE(err);
     err = hzl_HeaderTypeCheck(config->headerType);
     HZL_ERR_CHECK(err);
+    err = hzl_HeaderPlacementCheck(config->headerPlacement);
+    HZL_ERR_CHECK(err);
     if (config->amountOfGroups == 0) { return HZL_ERR_ZERO_GROUPS; }
     const hzl_Gid_t maxGid = hzl_HeaderTypeMaxGid(config->headerType);
     const size_t maxAmountOfGroups = maxGid + 1U;  // [0, maxGid] = maxGid+1 possible groups
@@ -57,43 +59,55 @@ hzl_ServerInitCheckServerConfig(const hzl_ServerConfig_t* const config)
     {
         return HZL_ERR_TOO_MANY_CLIENTS_FOR_CONFIGURED_HEADER_TYPE;
     }
+#if HZL_SERVER_MAX_AMOUNT_OF_CLIENTS < 255U  // Otherwise any uint8_t amount fits
     if (config->amountOfClients > HZL_SERVER_MAX_AMOUNT_OF_CLIENTS)
     {
         return HZL_ERR_TOO_MANY_CLIENTS;
     }
+#endif
     return HZL_OK;
 }
 
-/** @internal Verifies the content of the array of Client Configuration structures. */
-static hzl_Err_t
-hzl_ServerInitCheckClientConfigs(const hzl_ServerCtx_t* const ctx)
+hzl_Err_t
+hzl_ServerInitCheckClientConfig(const hzl_ServerClientConfig_t* const clientConfigs,
+                                const size_t i)
 {
-    for (size_t i = 0U; i < ctx->serverConfig->amountOfClients; i++)
+    if (hzl_IsAllZeros(clientConfigs[i].ltk, HZL_LTK_LEN))
     {
-        if (hzl_IsAllZeros(ctx->clientConfigs[i].ltk, HZL_LTK_LEN))
-        {
-            return HZL_ERR_LTK_IS_ALL_ZEROS;
-        }
-        if (ctx->clientConfigs[i].sid == HZL_SERVER_SID)
+        return HZL_ERR_LTK_IS_ALL_ZEROS;
+    }
+    if (clientConfigs[i].sid == HZL_SERVER_SID)
+    {
+        return HZL_ERR_SERVER_SID_ASSIGNED_TO_CLIENT;
+    }
+    if (i > 0)
+    {
+        // Note: skipping first entry (index 0), as we are checking against the previous index
+        if (clientConfigs[i - 1U].sid >= clientConfigs[i].sid)
         {
-            return HZL_ERR_SERVER_SID_ASSIGNED_TO_CLIENT;
+            return HZL_ERR_SIDS_ARE_NOT_PRESORTED_STRICTLY_ASCENDING;
         }
-        if (i > 0)
+        if (clientConfigs[i - 1U].sid + 1U != clientConfigs[i].sid)
         {
-            // Note: skipping first loop (index 0), as we are checking against the previous index
-            if (ctx->clientConfigs[i - 1U].sid >= ctx->clientConfigs[i].sid)
-            {
-                return HZL_ERR_SIDS_ARE_NOT_PRESORTED_STRICTLY_ASCENDING;
-            }
-            if (ctx->clientConfigs[i - 1U].sid + 1U != ctx->clientConfigs[i].sid)
-            {
-                return HZL_ERR_GAP_IN_SIDS;
-            }
+            return HZL_ERR_GAP_IN_SIDS;
         }
     }
     return HZL_OK;
 }
 
+/** @internal Verifies the content of the array of Client Configuration structures. */
+static hzl_Err_t
+hzl_ServerInitCheckClientConfigs(const hzl_ServerCtx_t* const ctx)
+{
+    HZL_ERR_DECLARE(err);
+    for (size_t i = 0U; i < ctx->serverConfig->amountOfClients; i++)
+    {
+        err = hzl_ServerInitCheckClientConfig(ctx->clientConfigs, i);
+        HZL_ERR_CHECK(err);
+    }
+    return HZL_OK;
+}
+
 /** @internal True if the delay between successive REN message is valid.
  * The division by 6 is defined as an upper limit in the CBS protocol. */
 inline static bool
@@ -104,72 +118,120 @@ hzl_ServerIsValidDelayBetweenRen(const hzl_ServerGroupConfig_t* const groupConfi
               groupConfig->sessionDurationMillis / 6U;
 }
 
-/** @internal Bitmap containing all possible SIDs for a given amount of Clients.
- * Operates on 64 bits in case the bitmap is expanded from 32 to 64 bits
- * (32 at the time of writing).
- * Example: if amountOfClients==3, then allClientSids==0b111
- * Example: if amountOfClients==32, then allClientSids==0xFFFFFFFF */
-inline static hzl_ServerBitMap_t
-hzl_ServerAllClientsBitmap(const hzl_ServerCtx_t* const ctx)
+void
+hzl_ServerAllClientsBitmap(hzl_ServerBitMapWord_t allClientSids[HZL_SERVER_BITMAP_WORDS],
+                           const uint8_t amountOfClients)
 {
-    return (hzl_ServerBitMap_t)
-            (UINT64_MAX >> (64U - ctx->serverConfig->amountOfClients));
+    size_t bitsLeft = amountOfClients;
+    for (size_t w = 0U; w < HZL_SERVER_BITMAP_WORDS; w++)
+    {
+        if (bitsLeft >= HZL_SERVER_BITMAP_WORD_BITS)
+        {
+            allClientSids[w] = UINT32_MAX;
+            bitsLeft -= HZL_SERVER_BITMAP_WORD_BITS;
+        }
+        else
+        {
+            // Shifting by 32 would be undefined: bitsLeft < 32 here
+            allClientSids[w] = (hzl_ServerBitMapWord_t) ((1UL << bitsLeft) - 1U);
+            bitsLeft = 0U;
+        }
+    }
 }
 
-/** @internal Verifies the content of the array of Client Configuration structures. */
+/** @internal Checks a Group's bitmap against the one of all Clients, one word at the time. */
 static hzl_Err_t
-hzl_ServerInitCheckGroupConfigs(const hzl_ServerCtx_t* const ctx)
+hzl_ServerCheckGroupBitmap(const hzl_ServerBitMapWord_t* const bitmap,
+                           const hzl_ServerBitMapWord_t* const allClientSids)
 {
-    const hzl_ServerBitMap_t allClientSids = hzl_ServerAllClientsBitmap(ctx);
-    if (ctx->groupConfigs[0].gid != HZL_BROADCAST_GID) { return HZL_ERR_MISSING_GID_0; }
-    if ((ctx->groupConfigs[0].clientSidsInGroupBitmap & allClientSids) != allClientSids)
-    {
-        // The broadcast group bitmap must contain ALL the bits that map to the Clients
-        // listed in the Clients config, but may contain SOME higher set bits, which are ignored.
-        // This allows to reuse the same configuration structures, but just limit the amount
-        // of clients to smaller value, without needing to change the broadcast group.
-        // This also allows to set the broadcast bitmap to 0xFF...FF without worrying too much
-        // about it.
-        return HZL_ERR_CLIENTS_BITMAP_INVALID_BROADCAST_GROUP;
+    hzl_ServerBitMapWord_t anySid = 0U;
+    hzl_ServerBitMapWord_t unknownSids = 0U;
+    for (size_t w = 0U; w < HZL_SERVER_BITMAP_WORDS; w++)
+    {
+        anySid |= bitmap[w];
+        unknownSids |= bitmap[w] & ~allClientSids[w];
     }
-    for (size_t i = 0U; i < ctx->serverConfig->amountOfGroups; i++)
+    if (anySid == 0U) { return HZL_ERR_CLIENTS_BITMAP_ZERO_CLIENTS; }
+    // The bitmap contains some set bits outside of the possible range.
+    if (unknownSids != 0U) { return HZL_ERR_CLIENTS_BITMAP_UNKNOWN_SID; }
+    return HZL_OK;
+}
+
+/** @internal True if the broadcast Group's bitmap contains all Clients, one word at the time. */
+static bool
+hzl_ServerIsCompleteBroadcastBitmap(const hzl_ServerBitMapWord_t* const bitmap,
+                                    const hzl_ServerBitMapWord_t* const allClientSids)
+{
+    hzl_ServerBitMapWord_t missingSids = 0U;
+    for (size_t w = 0U; w < HZL_SERVER_BITMAP_WORDS; w++)
     {
-        if (i > 0)
-        {
-            // Note: skipping first loop (index 0), as we are checking against the previous index
-            if (ctx->groupConfigs[i - 1U].gid >= ctx->groupConfigs[i].gid)
-            {
-                return HZL_ERR_GIDS_ARE_NOT_PRESORTED_STRICTLY_ASCENDING;
-            }
-            if (ctx->groupConfigs[i - 1U].gid + 1U != ctx->groupConfigs[i].gid)
-            {
-                return HZL_ERR_GAP_IN_GIDS;
-            }
-            // Note: skipping the first loo (index 0) as the broadcast group is already checked
-            // outside of the loop.
-            if (ctx->groupConfigs[i].clientSidsInGroupBitmap == 0U)
-            {
-                return HZL_ERR_CLIENTS_BITMAP_ZERO_CLIENTS;
-            }
-            if (ctx->groupConfigs[i].clientSidsInGroupBitmap & ~allClientSids)
-            {
-                // The bitmap contains some set bits outside of the possible range.
-                return HZL_ERR_CLIENTS_BITMAP_UNKNOWN_SID;
-            }
-        }
-        if (ctx->groupConfigs[i].maxCtrnonceDelayMsgs > HZL_LARGEST_MAX_COUNTER_NONCE_DELAY)
+        missingSids |= allClientSids[w] & ~bitmap[w];
+    }
+    return missingSids == 0U;
+}
+
+hzl_Err_t
+hzl_ServerInitCheckGroupConfig(const hzl_ServerGroupConfig_t* const groupConfigs,
+                               const size_t i,
+                               const hzl_ServerBitMapWord_t* const allClientSids)
+{
+    HZL_ERR_DECLARE(err);
+    if (i == 0)
+    {
+        if (groupConfigs[0].gid != HZL_BROADCAST_GID) { return HZL_ERR_MISSING_GID_0; }
+        if (!hzl_ServerIsCompleteBroadcastBitmap(groupConfigs[0].clientSidsInGroupBitmap,
+                                                 allClientSids))
         {
-            return HZL_ERR_INVALID_MAX_CTRNONCE_DELAY;
+            // The broadcast group bitmap must contain ALL the bits that map to the Clients
+            // listed in the Clients config, but may contain SOME higher set bits, which are
+            // ignored. This allows to reuse the same configuration structures, but just limit
+            // the amount of clients to smaller value, without needing to change the broadcast
+            // group. This also allows to set the broadcast bitmap to 0xFF...FF without worrying
+            // too much about it.
+            return HZL_ERR_CLIENTS_BITMAP_INVALID_BROADCAST_GROUP;
         }
-        if (ctx->groupConfigs[i].ctrNonceUpperLimit >
-            HZL_SERVER_MAX_COUNTER_NONCE_UPPER_LIMIT)
+    }
+    else
+    {
+        // Note: the first entry (index 0) is the broadcast group, checked above.
+        if (groupConfigs[i - 1U].gid >= groupConfigs[i].gid)
         {
-            return HZL_ERR_TOO_LARGE_CTRNONCE_UPPER_LIMIT;
+            return HZL_ERR_GIDS_ARE_NOT_PRESORTED_STRICTLY_ASCENDING;
         }
-        if (!hzl_ServerIsValidDelayBetweenRen(&ctx->groupConfigs[i]))
+        if (groupConfigs[i - 1U].gid + 1U != groupConfigs[i].gid)
         {
-            return HZL_ERR_INVALID_DELAY_BETWEEN_REN_NOTIFICATIONS;
+            return HZL_ERR_GAP_IN_GIDS;
         }
+        err = hzl_ServerCheckGroupBitmap(groupConfigs[i].clientSidsInGroupBitmap,
+                                         allClientSids);
+        HZL_ERR_CHECK(err);
+    }
+    if (groupConfigs[i].maxCtrnonceDelayMsgs > HZL_LARGEST_MAX_COUNTER_NONCE_DELAY)
+    {
+        return HZL_ERR_INVALID_MAX_CTRNONCE_DELAY;
+    }
+    if (groupConfigs[i].ctrNonceUpperLimit > HZL_SERVER_MAX_COUNTER_NONCE_UPPER_LIMIT)
+    {
+        return HZL_ERR_TOO_LARGE_CTRNONCE_UPPER_LIMIT;
+    }
+    if (!hzl_ServerIsValidDelayBetweenRen(&groupConfigs[i]))
+    {
+        return HZL_ERR_INVALID_DELAY_BETWEEN_REN_NOTIFICATIONS;
+    }
+    return HZL_OK;
+}
+
+/** @internal Verifies the content of the array of Group Configuration structures. */
+static hzl_Err_t
+hzl_ServerInitCheckGroupConfigs(const hzl_ServerCtx_t* const ctx)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_ServerBitMapWord_t allClientSids[HZL_SERVER_BITMAP_WORDS];
+    hzl_ServerAllClientsBitmap(allClientSids, ctx->serverConfig->amountOfClients);
+    for (size_t i = 0U; i < ctx->serverConfig->amountOfGroups; i++)
+    {
+        err = hzl_ServerInitCheckGroupConfig(ctx->groupConfigs, i, allClientSids);
+        HZL_ERR_CHECK(err);
     }
     return HZL_OK;
 }
@@ -197,7 +259,9 @@ hzl_ServerCheckCtx(const hzl_ServerCtx_t* const ctx)
     HZL_ERR_CHECK(err);
     err = hzl_ServerInitCheckClientConfigs(ctx);
     HZL_ERR_CHECK(err);
-    return hzl_ServerInitCheckGroupConfigs(ctx);
+    err = hzl_ServerInitCheckGroupConfigs(ctx);
+    HZL_ERR_CHECK(err);
+    return hzl_ServerDosCheckConfig(ctx);
 }
 
 /** @internal Starts the current session of all Groups, clearing the remaining
@@ -206,23 +270,91 @@ static hzl_Err_t
 hzl_ServerInitStartAllSessions(hzl_ServerCtx_t* const ctx)
 {
     HZL_ERR_DECLARE(err);
-    for (size_t i = 0; i < ctx->serverConfig->amountOfGroups; i++)
+    for (hzl_Gid_t i = 0; i < ctx->serverConfig->amountOfGroups; i++)
     {
-        err = ctx->io.currentTime(&ctx->groupStates[i].sessionStartInstant);
+        hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHot(ctx, i);
+#if HZL_SERVER_SPLIT_GROUP_STATE
+        // Per-message thresholds next to the state they are checked against
+        hot->maxCtrnonceDelayMsgs = ctx->groupConfigs[i].maxCtrnonceDelayMsgs;
+        hot->ctrNonceUpperLimit = ctx->groupConfigs[i].ctrNonceUpperLimit;
+        hot->sessionDurationMillis = ctx->groupConfigs[i].sessionDurationMillis;
+        hot->maxSilenceIntervalMillis = ctx->groupConfigs[i].maxSilenceIntervalMillis;
+#endif
+        // The 2 and 6 are multipliers coming strictly from the CBS protocol specification.
+        // Both products fit: the operands are checked in hzl_ServerInitCheckGroupConfigs().
+        hot->renewalPhaseEndCtrNonce = 2U * ctx->groupConfigs[i].maxCtrnonceDelayMsgs;
+        hot->renewalPhaseEndMillis = 6U * ctx->groupConfigs[i].delayBetweenRenNotificationsMillis;
+        hot->sessionState = HZL_SESSION_STATE_ACTIVE;
+        err = ctx->io.currentTime(&hot->sessionStartInstant);
         HZL_ERR_CHECK(err);
         // Upon Session initialisation or renewal, before the first Request in a Group,
         // currentRxLastMessageInstant is set to sessionStartInstant. When the Request is
         // received, currentRxLastMessageInstant is updated to a different value. This information
         // is used by the Server to know whether there is at least one Client in the Group
         // that is enabled to received Secured Application Data messages.
-        ctx->groupStates[i].currentRxLastMessageInstant = ctx->groupStates[i].sessionStartInstant;
-        ctx->groupStates[i].previousRxLastMessageInstant = 0;
-        ctx->groupStates[i].currentCtrNonce = 0;
-        ctx->groupStates[i].previousCtrNonce = 0;
+        hot->currentRxLastMessageInstant = hot->sessionStartInstant;
+        hot->previousRxLastMessageInstant = 0;
+        hot->currentCtrNonce = 0;
+        hot->previousCtrNonce = 0;
         err = hzl_NonZeroTrng(ctx->groupStates[i].currentStk, ctx->io.trng, HZL_STK_LEN);
         HZL_ERR_CHECK(err);
         hzl_ZeroOut(ctx->groupStates[i].previousStk, HZL_STK_LEN);
+        // The states may be uninitialised memory: empty the key caches without freeing them
+        hzl_ZeroOut(&ctx->groupStates[i].currentAeadKey, sizeof(hzl_AeadKey_t));
+        hzl_ZeroOut(&ctx->groupStates[i].previousAeadKey, sizeof(hzl_AeadKey_t));
+        hzl_ZeroOut(&ctx->groupStates[i].renHashMidstate, sizeof(hzl_HashMidstate_t));
+        hzl_ZeroOut(ctx->groupStates[i].nextStk, HZL_STK_LEN);
+        hzl_ZeroOut(&ctx->groupStates[i].nextAeadKey, sizeof(hzl_AeadKey_t));
+        err = hzl_ServerGroupGenerateNextStk(ctx, i);
+        HZL_ERR_CHECK(err);
+    }
+    return err;
+}
+
+/** @internal Precomputes the data derived from the Clients' configuration, if there is
+ * space for it. */
+static void
+hzl_ServerInitClientStates(hzl_ServerCtx_t* const ctx)
+{
+    if (ctx->clientStates == NULL) { return; }
+    for (size_t i = 0; i < ctx->serverConfig->amountOfClients; i++)
+    {
+        hzl_Hash_t hash;
+        hzl_ReqHashInitPrefix(&hash, ctx->clientConfigs[i].ltk);
+        hzl_HashSaveMidstate(&ctx->clientStates[i].reqHashMidstate, &hash);
+        hzl_ZeroOut(&hash, sizeof(hash));
+        // The states may be uninitialised memory: empty the key cache without freeing it
+        hzl_ZeroOut(&ctx->clientStates[i].ltkAeadKey, sizeof(hzl_AeadKey_t));
+        hzl_AeadKeyExpand(&ctx->clientStates[i].ltkAeadKey, ctx->clientConfigs[i].ltk);
+    }
+}
+
+hzl_Err_t
+hzl_ServerInitUnchecked(hzl_ServerCtx_t* const ctx)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_ServerInitClientStates(ctx);
+    hzl_ServerRejectedCacheInit(ctx);
+#if HZL_SADTP
+    if (ctx->sadtpRxPool != NULL)
+    {
+        memset(ctx->sadtpRxPool, 0, sizeof(hzl_SadtpRxPool_t));
+    }
+#endif
+    err = hzl_ServerInitStartAllSessions(ctx);
+    HZL_ERR_CHECK(err);
+    if (ctx->timerWheel == NULL && ctx->dosConfig == NULL) { return err; }
+    hzl_Timestamp_t now;
+    err = ctx->io.currentTime(&now);
+    HZL_ERR_CHECK(err);
+    if (ctx->timerWheel != NULL)
+    {
+        // All next STKs were just generated
+        memset(ctx->timerWheel->nextStkToGenerateBitmap, 0,
+               sizeof(ctx->timerWheel->nextStkToGenerateBitmap));
+        hzl_ServerTimerWheelInit(ctx, now);
     }
+    hzl_ServerDosInit(ctx, now);
     return err;
 }
 
@@ -232,5 +364,5 @@ hzl_ServerInit(hzl_ServerCtx_t* const ctx)
     HZL_ERR_DECLARE(err);
     err = hzl_ServerCheckCtx(ctx);
     HZL_ERR_CHECK(err);
-    return hzl_ServerInitStartAllSessions(ctx);
+    return hzl_ServerInitUnchecked(ctx);
 }
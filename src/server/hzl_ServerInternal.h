@@ -46,9 +46,92 @@ extern "C"
 
 /** Double-checking that the bitmap can hold the max amount of Clients. */
 _Static_assert(
-        sizeof(hzl_ServerBitMap_t) * 8U <= HZL_SERVER_MAX_AMOUNT_OF_CLIENTS,
+        HZL_SERVER_BITMAP_WORDS * HZL_SERVER_BITMAP_WORD_BITS >= HZL_SERVER_MAX_AMOUNT_OF_CLIENTS,
         "The bitmap of Clients in the Group must be large enough to support "
         "the max amount of Clients.");
+/** The amount of Clients is a uint8_t and SID 0 is the Server. */
+_Static_assert(
+        HZL_SERVER_MAX_AMOUNT_OF_CLIENTS >= 1U && HZL_SERVER_MAX_AMOUNT_OF_CLIENTS <= 255U,
+        "The max amount of Clients must be in [1, 255].");
+
+#if HZL_SERVER_SPLIT_GROUP_STATE
+/** @internal Struct holding the Group's per-message state fields. */
+typedef hzl_ServerGroupHotState_t hzl_ServerGroupHot_t;
+/** @internal Struct holding the Group's configuration fields checked on every message. */
+typedef hzl_ServerGroupHotState_t hzl_ServerGroupHotConfig_t;
+#else
+/** @internal Struct holding the Group's per-message state fields. */
+typedef hzl_ServerGroupState_t hzl_ServerGroupHot_t;
+/** @internal Struct holding the Group's configuration fields checked on every message. */
+typedef hzl_ServerGroupConfig_t hzl_ServerGroupHotConfig_t;
+#endif
+
+/**
+ * @internal
+ * Per-message state of the Group: Counter Nonces and timestamps.
+ *
+ * In the Group state or in the Group hot state, depending on
+ * #HZL_SERVER_SPLIT_GROUP_STATE. The field names are the same in both.
+ */
+inline static hzl_ServerGroupHot_t*
+hzl_ServerGroupHot(hzl_ServerCtx_t* const ctx,
+                   const hzl_Gid_t gid)
+{
+#if HZL_SERVER_SPLIT_GROUP_STATE
+    return &ctx->groupHotStates[gid];
+#else
+    return &ctx->groupStates[gid];
+#endif
+}
+
+/** @internal Read-only variant of hzl_ServerGroupHot(). */
+inline static const hzl_ServerGroupHot_t*
+hzl_ServerGroupHotConst(const hzl_ServerCtx_t* const ctx,
+                        const hzl_Gid_t gid)
+{
+#if HZL_SERVER_SPLIT_GROUP_STATE
+    return &ctx->groupHotStates[gid];
+#else
+    return &ctx->groupStates[gid];
+#endif
+}
+
+/**
+ * @internal
+ * Configuration values of the Group checked on every message: ctrnonce limits and durations.
+ *
+ * In the Group configuration or copied into the Group hot state, depending on
+ * #HZL_SERVER_SPLIT_GROUP_STATE. The field names are the same in both.
+ */
+inline static const hzl_ServerGroupHotConfig_t*
+hzl_ServerGroupHotConfig(const hzl_ServerCtx_t* const ctx,
+                         const hzl_Gid_t gid)
+{
+#if HZL_SERVER_SPLIT_GROUP_STATE
+    return &ctx->groupHotStates[gid];
+#else
+    return &ctx->groupConfigs[gid];
+#endif
+}
+
+/**
+ * @internal
+ * True if the Client with the given SID is set in the bitmap of Clients.
+ *
+ * Constant time: one word read and one shift.
+ *
+ * @param [in] bitmap of #HZL_SERVER_BITMAP_WORDS words
+ * @param [in] sid of a Client, in [1, #HZL_SERVER_MAX_AMOUNT_OF_CLIENTS]
+ */
+inline static bool
+hzl_ServerBitMapHasSid(const hzl_ServerBitMapWord_t* const bitmap,
+                       const hzl_Sid_t sid)
+{
+    // SID 1 maps to bit at index 0, SID 2 to index 1 etc.
+    const size_t bitIdx = sid - 1U;
+    return (bitmap[bitIdx / HZL_SERVER_BITMAP_WORD_BITS]
+            >> (bitIdx % HZL_SERVER_BITMAP_WORD_BITS)) & 1U;
+}
 
 /**
  * @internal
@@ -62,13 +145,80 @@ _Static_assert(
 hzl_Err_t
 hzl_ServerCheckCtxPointers(const hzl_ServerCtx_t* ctx);
 
+/**
+ * @internal
+ * Verifies the content of the Server Configuration structure.
+ *
+ * @param [in] config to check, not NULL
+ * @return Same return values as hzl_ServerInit() for the Server Configuration.
+ */
+hzl_Err_t
+hzl_ServerInitCheckServerConfig(const hzl_ServerConfig_t* config);
+
+/**
+ * @internal
+ * Verifies the content of one Client Configuration structure, also against the previous one.
+ *
+ * Called on each element in order, so the configuration file can be validated in the same pass
+ * it's decoded in.
+ *
+ * @param [in] clientConfigs array of Client Configurations, filled up to index \p i
+ * @param [in] i index of the Client Configuration to check
+ * @return Same return values as hzl_ServerInit() for the Client Configurations.
+ */
+hzl_Err_t
+hzl_ServerInitCheckClientConfig(const hzl_ServerClientConfig_t* clientConfigs,
+                                size_t i);
+
+/**
+ * @internal
+ * Bitmap containing all possible SIDs for a given amount of Clients.
+ *
+ * Example: if amountOfClients==3, then allClientSids=={0b111, 0, ...}
+ * Example: if amountOfClients==40, then allClientSids=={0xFFFFFFFF, 0xFF, 0, ...}
+ *
+ * @param [out] allClientSids the bitmap
+ * @param [in] amountOfClients as in #hzl_ServerConfig_t.amountOfClients
+ */
+void
+hzl_ServerAllClientsBitmap(hzl_ServerBitMapWord_t allClientSids[HZL_SERVER_BITMAP_WORDS],
+                           uint8_t amountOfClients);
+
+/**
+ * @internal
+ * Verifies the content of one Group Configuration structure, also against the previous one.
+ *
+ * Called on each element in order, so the configuration file can be validated in the same pass
+ * it's decoded in.
+ *
+ * @param [in] groupConfigs array of Group Configurations, filled up to index \p i
+ * @param [in] i index of the Group Configuration to check
+ * @param [in] allClientSids as from hzl_ServerAllClientsBitmap()
+ * @return Same return values as hzl_ServerInit() for the Group Configurations.
+ */
+hzl_Err_t
+hzl_ServerInitCheckGroupConfig(const hzl_ServerGroupConfig_t* groupConfigs,
+                               size_t i,
+                               const hzl_ServerBitMapWord_t* allClientSids);
+
+/**
+ * @internal
+ * Same as hzl_ServerInit() on an already validated context: starts all Sessions and
+ * precomputes the derived data, without checking the configuration again.
+ *
+ * @param [in, out] ctx context with valid pointers and configuration
+ * @return Same return values as hzl_ServerInit() on IO failures.
+ */
+hzl_Err_t
+hzl_ServerInitUnchecked(hzl_ServerCtx_t* ctx);
+
 /**
  * @internal
  * Increments the Group's Counter Nonce by 1, unless its upper limit was reached and the Nonce
  * is already expired.
  */
 void
-hzl_ServerGroupIncrCurrentCtrnonce(const hzl_ServerCtx_t* ctx,
+hzl_ServerGroupIncrCurrentCtrnonce(hzl_ServerCtx_t* ctx,
                                    hzl_Gid_t groupId);
 
 /**
@@ -77,7 +227,7 @@ hzl_ServerGroupIncrCurrentCtrnonce(const hzl_ServerCtx_t* ctx,
  * Nonce is already expired.
  */
 void
-hzl_ServerGroupIncrPreviousCtrnonce(const hzl_ServerCtx_t* ctx,
+hzl_ServerGroupIncrPreviousCtrnonce(hzl_ServerCtx_t* ctx,
                                     hzl_Gid_t groupId);
 
 /** @internal Checks if the current Session is expired and, if so, it generates a new one,
@@ -107,11 +257,133 @@ hzl_ServerBuildMsgRenewal(hzl_CbsPduMsg_t* reactionPdu,
                           hzl_ServerCtx_t* ctx,
                           hzl_Gid_t gid);
 
+/** @internal Generates and expands the STK of the Group's next Session, unless already
+ * available. */
+hzl_Err_t
+hzl_ServerGroupGenerateNextStk(hzl_ServerCtx_t* ctx,
+                               hzl_Gid_t gid);
+
 /** @internal Start a session renewal phase, forcibly. */
 hzl_Err_t
 hzl_ServerSessionRenewalPhaseEnter(hzl_ServerCtx_t* ctx,
                                    hzl_Gid_t gid);
 
+/** @internal Computes the instant of the next time-driven event of the Group, given its
+ * Session state at \p now: Session expiration, next REN message or end of the renewal phase.
+ * Returns false if the Group has no such event. */
+bool
+hzl_ServerSessionNextTimeEvent(hzl_Timestamp_t* eventInstant,
+                               const hzl_ServerCtx_t* ctx,
+                               hzl_Timestamp_t now,
+                               hzl_Gid_t gid);
+
+/** @internal Handles the time-driven event of the Group due at \p now, if any: renews the
+ * expired Session, builds the next REN message or ends the renewal phase.
+ * The \p renewalPdu has zero length if no REN message was built. */
+hzl_Err_t
+hzl_ServerSessionTimeEvent(hzl_CbsPduMsg_t* renewalPdu,
+                           hzl_ServerCtx_t* ctx,
+                           hzl_Timestamp_t now,
+                           hzl_Gid_t gid);
+
+/** @internal Empties the timer wheel and schedules the time-driven events of all Groups,
+ * starting from \p now. */
+void
+hzl_ServerTimerWheelInit(hzl_ServerCtx_t* ctx,
+                         hzl_Timestamp_t now);
+
+/** @internal (Re)schedules the next time-driven event of the Group in the timer wheel,
+ * replacing its pending one, if any. */
+void
+hzl_ServerTimerWheelSchedule(hzl_ServerCtx_t* ctx,
+                             hzl_Timestamp_t now,
+                             hzl_Gid_t gid);
+
+/** @internal Checks the DoS protection configuration, if any. */
+hzl_Err_t
+hzl_ServerDosCheckConfig(const hzl_ServerCtx_t* ctx);
+
+/** @internal Fills all token buckets of the DoS protection and clears its counters. */
+void
+hzl_ServerDosInit(hzl_ServerCtx_t* ctx,
+                  hzl_Timestamp_t now);
+
+/** @internal Takes the tokens of a received message requiring cryptographic operations or
+ * returns #HZL_ERR_SECWARN_DENIAL_OF_SERVICE if it should be dropped right away.
+ * Always admits other messages or when the DoS protection is disabled. */
+hzl_Err_t
+hzl_ServerDosAdmit(hzl_ServerCtx_t* ctx,
+                   const hzl_Header_t* unpackedHdr,
+                   hzl_Timestamp_t rxTimestamp);
+
+/** @internal Charges the rejected-messages budget if the admitted message failed
+ * a security check. */
+void
+hzl_ServerDosAccount(hzl_ServerCtx_t* ctx,
+                     const hzl_Header_t* unpackedHdr,
+                     hzl_Err_t result);
+
+#if HZL_SERVER_REJECTED_CACHE_SLOTS > 0
+
+/** @internal Computes the fingerprint of the message, never 0, combined with an identifier
+ * of the key it's validated with and of its header, so a key change makes older fingerprints
+ * unreachable and the same payload in another Group or CAN ID is not confused with it. */
+uint64_t
+hzl_ServerRejectedFingerprint(const uint8_t* pdu,
+                              size_t pduLen,
+                              uint64_t keyId);
+
+/** @internal Empties the cache of rejected messages and resets its statistics, if any. */
+void
+hzl_ServerRejectedCacheInit(hzl_ServerCtx_t* ctx);
+
+/** @internal Returns true if the fingerprint is in the cache of rejected messages, counting
+ * the hit or miss. Always false without cache. */
+bool
+hzl_ServerRejectedCacheLookup(hzl_ServerCtx_t* ctx,
+                              uint64_t fingerprint);
+
+/** @internal Stores the fingerprint in the cache of rejected messages, if any, evicting
+ * an older one of the same set if full. */
+void
+hzl_ServerRejectedCacheInsert(hzl_ServerCtx_t* ctx,
+                              uint64_t fingerprint);
+
+#else
+
+inline static uint64_t
+hzl_ServerRejectedFingerprint(const uint8_t* const pdu,
+                              const size_t pduLen,
+                              const uint64_t keyId)
+{
+    (void) pdu;
+    (void) pduLen;
+    (void) keyId;
+    return 0U;
+}
+
+inline static void
+hzl_ServerRejectedCacheInit(hzl_ServerCtx_t* const ctx) { (void) ctx; }
+
+inline static bool
+hzl_ServerRejectedCacheLookup(hzl_ServerCtx_t* const ctx,
+                              const uint64_t fingerprint)
+{
+    (void) ctx;
+    (void) fingerprint;
+    return false;
+}
+
+inline static void
+hzl_ServerRejectedCacheInsert(hzl_ServerCtx_t* const ctx,
+                              const uint64_t fingerprint)
+{
+    (void) ctx;
+    (void) fingerprint;
+}
+
+#endif
+
 /** @internal Checks whether a Secured Application Data or Renewal message could already
  * be build and transmitted. In other words, returns true if at least one Client
  * has already Requested the Session Information and should be thus able to properly validate
@@ -123,7 +395,7 @@ hzl_ServerDidAnyClientAlreadyRequest(const hzl_ServerCtx_t* ctx,
 /** @internal Stores the timestamp of last reception in the current Session, while taking
  * care of a corner case timing condition. */
 void
-hzl_ServerUpdateCurrentRxLastMessageInstant(const hzl_ServerCtx_t* ctx,
+hzl_ServerUpdateCurrentRxLastMessageInstant(hzl_ServerCtx_t* ctx,
                                             hzl_Timestamp_t rxTimestamp,
                                             hzl_Gid_t gid);
 
@@ -39,110 +39,201 @@
 
 #if HZL_OS_AVAILABLE
 
-/** @internal Loads an arbitrary amount of bytes from the stream, basically wrapping fopen()
- * to return a Hazelnet error code on unexpected stream end. */
-inline static hzl_Err_t
-hzl_LoadBytes(uint8_t* const bytes, FILE* const fileStream, const size_t amount)
-{
-    const size_t bufferedLen = fread(bytes, 1U, amount, fileStream);
-    if (bufferedLen != amount) { return HZL_ERR_UNEXPECTED_EOF; }
-    return HZL_OK;
-}
+/** @internal File format where each Group's bitmap of Clients is a uint32. */
+#define HZL_SERVER_FILE_FORMAT_V0 0U
+/** @internal File format where each Group's bitmap of Clients has as many bytes as needed
+ * for the amount of Clients, to support more than 32 Clients. */
+#define HZL_SERVER_FILE_FORMAT_V1 1U
+
+/** @internal Length of the magic number in the file, including the format version byte. */
+#define HZL_SERVER_FILE_MAGIC_NUMBER_LEN 5U
+/** @internal Length of the encoded #hzl_ServerConfig_t. */
+#define HZL_SERVER_FILE_SERVER_CONFIG_LEN 3U
+/** @internal Length of the encoded #hzl_ServerClientConfig_t. */
+#define HZL_SERVER_FILE_CLIENT_CONFIG_LEN (1U + HZL_LTK_LEN)
+/** @internal Length of the encoded #hzl_ServerGroupConfig_t without the bitmap of Clients. */
+#define HZL_SERVER_FILE_GROUP_CONFIG_LEN_WITHOUT_BITMAP 20U
+/** @internal Length of the longest encoded bitmap of Clients of any format version. */
+#define HZL_SERVER_FILE_MAX_BITMAP_LEN \
+    (HZL_SERVER_BITMAP_WORDS * sizeof(hzl_ServerBitMapWord_t))
+/** @internal Length of the longest file: 255 Clients and Groups with the longest bitmaps. */
+#define HZL_SERVER_FILE_MAX_LEN \
+    (HZL_SERVER_FILE_MAGIC_NUMBER_LEN + HZL_SERVER_FILE_SERVER_CONFIG_LEN \
+     + UINT8_MAX * HZL_SERVER_FILE_CLIENT_CONFIG_LEN \
+     + UINT8_MAX * (HZL_SERVER_FILE_GROUP_CONFIG_LEN_WITHOUT_BITMAP \
+                    + HZL_SERVER_FILE_MAX_BITMAP_LEN))
 
-/** @internal Verifies the file starts with `"HZLs\0" = {0x68, 0x7A, 0x73, 0x00}`
- * to double check the correct binary file was selected. */
+/** @internal Verifies the file starts with `"HZLs" = {0x68, 0x7A, 0x73}` followed by a
+ * known format version byte, to double check the correct binary file was selected.
+ * Version 0 files start with `"HZLs\0"`. */
 static hzl_Err_t
-hzl_CheckMagicNumber(FILE* const fileStream)
+hzl_CheckMagicNumber(uint8_t* const formatVersion,
+                     const uint8_t* const bytes,
+                     const size_t len)
 {
-    HZL_ERR_DECLARE(err);
-    uint8_t magicNumber[5U] = {0};
-    err = hzl_LoadBytes(magicNumber, fileStream, sizeof(magicNumber));
-    HZL_ERR_CHECK(err);
-    if (magicNumber[0] != 'H'
-        || magicNumber[1] != 'Z'
-        || magicNumber[2] != 'L'
-        || magicNumber[3] != 's'
-        || magicNumber[4] != '\0')
+    if (len < HZL_SERVER_FILE_MAGIC_NUMBER_LEN) { return HZL_ERR_UNEXPECTED_EOF; }
+    if (bytes[0] != 'H'
+        || bytes[1] != 'Z'
+        || bytes[2] != 'L'
+        || bytes[3] != 's'
+        || bytes[4] > HZL_SERVER_FILE_FORMAT_V1)
     {
         return HZL_ERR_INVALID_FILE_MAGIC_NUMBER;
     }
-    return err;
+    *formatVersion = bytes[4];
+    return HZL_OK;
 }
 
-/** @internal Loads a uint32 in Little Endian encoding from the file. */
-static hzl_Err_t
-hzl_LoadUint32Le(uint32_t* const value, FILE* const fileStream)
+/** @internal Decodes the Server Configuration structure.
+ * The header placement is in the 2 most significant bits of the header type byte. */
+inline static void
+hzl_DecodeServerConfig(hzl_ServerConfig_t* const config, const uint8_t* const bytes)
 {
-    HZL_ERR_DECLARE(err);
-    uint8_t bytes[sizeof(uint32_t)] = {0};
-    err = hzl_LoadBytes(bytes, fileStream, sizeof(bytes));
-    *value = hzl_DecodeLe32(bytes);
-    return err;
+    config->amountOfGroups = bytes[0];
+    config->amountOfClients = bytes[1];
+    config->headerType = bytes[2] & 0x3FU;
+    config->headerPlacement = (uint8_t) (bytes[2] >> 6U);
 }
 
-/** @internal Loads a uint16 in Little Endian encoding from the file. */
-static hzl_Err_t
-hzl_LoadUint16Le(uint16_t* const value, FILE* const fileStream)
+/** @internal Length of each Group's bitmap of Clients in the file.
+ * Version 0: a uint32. Version 1: ceil(amountOfClients / 8) bytes, Little Endian. */
+inline static size_t
+hzl_ServerFileBitmapLen(const uint8_t formatVersion, const uint8_t amountOfClients)
 {
-    HZL_ERR_DECLARE(err);
-    uint8_t bytes[sizeof(uint16_t)] = {0};
-    err = hzl_LoadBytes(bytes, fileStream, sizeof(bytes));
-    *value = hzl_DecodeLe16(bytes);
-    return err;
+    if (formatVersion == HZL_SERVER_FILE_FORMAT_V0) { return sizeof(uint32_t); }
+    return (amountOfClients + 7U) / 8U;
 }
 
-/** @internal Loads a uint8 in from the file (syntax sugar). */
-inline static hzl_Err_t
-hzl_LoadUint8(uint8_t* const value, FILE* const fileStream)
+/** @internal Length of the whole file, known from its header. */
+inline static size_t
+hzl_ServerFileLen(const hzl_ServerConfig_t* const config, const size_t bitmapLen)
 {
-    return hzl_LoadBytes(value, fileStream, sizeof(uint8_t));
+    return HZL_SERVER_FILE_MAGIC_NUMBER_LEN + HZL_SERVER_FILE_SERVER_CONFIG_LEN
+           + config->amountOfClients * HZL_SERVER_FILE_CLIENT_CONFIG_LEN
+           + config->amountOfGroups
+             * (HZL_SERVER_FILE_GROUP_CONFIG_LEN_WITHOUT_BITMAP + bitmapLen);
 }
 
-/** @internal Loads the Server Configuration structure from the file. */
-inline static hzl_Err_t
-hzl_LoadServerConfig(hzl_ServerConfig_t* const config, FILE* const fileStream)
+/** @internal Decodes a single Client configuration structure. */
+inline static void
+hzl_DecodeClientConfig(hzl_ServerClientConfig_t* const client, const uint8_t* const bytes)
 {
-    HZL_ERR_DECLARE(err);
-    err = hzl_LoadUint8(&config->amountOfGroups, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint8(&config->amountOfClients, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint8(&config->headerType, fileStream);
-    return err;
+    client->sid = bytes[0];
+    memcpy(client->ltk, &bytes[1], HZL_LTK_LEN);
 }
 
-/** @internal Loads a single Client configuration structure from the file. */
-inline static hzl_Err_t
-hzl_LoadClientConfig(hzl_ServerClientConfig_t* const client, FILE* const fileStream)
+/** @internal Decodes the bitmap of Clients of a Group, of any format version. */
+static void
+hzl_DecodeClientsBitmap(hzl_ServerBitMapWord_t* const bitmap,
+                        const uint8_t* const bytes,
+                        const size_t bitmapLen)
 {
-    HZL_ERR_DECLARE(err);
-    err = hzl_LoadUint8(&client->sid, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadBytes(client->ltk, fileStream, HZL_LTK_LEN);
-    return err;
+    // Fits in the bitmap: the amount of Clients is checked before decoding the Groups
+    uint8_t words[HZL_SERVER_FILE_MAX_BITMAP_LEN] = {0};
+    memcpy(words, bytes, bitmapLen);
+    for (size_t w = 0U; w < HZL_SERVER_BITMAP_WORDS; w++)
+    {
+        bitmap[w] = hzl_DecodeLe32(&words[w * sizeof(hzl_ServerBitMapWord_t)]);
+    }
+}
+
+/** @internal Decodes a single Group configuration structure. */
+inline static void
+hzl_DecodeGroupConfig(hzl_ServerGroupConfig_t* const group,
+                      const uint8_t* const bytes,
+                      const size_t bitmapLen)
+{
+    group->maxCtrnonceDelayMsgs = hzl_DecodeLe32(&bytes[0]);
+    group->ctrNonceUpperLimit = hzl_DecodeLe32(&bytes[4]);
+    group->sessionDurationMillis = hzl_DecodeLe32(&bytes[8]);
+    group->delayBetweenRenNotificationsMillis = hzl_DecodeLe32(&bytes[12]);
+    hzl_DecodeClientsBitmap(group->clientSidsInGroupBitmap, &bytes[16], bitmapLen);
+    group->maxSilenceIntervalMillis = hzl_DecodeLe16(&bytes[16U + bitmapLen]);
+    group->gid = bytes[18U + bitmapLen];
+    group->unusedPadding[0] = bytes[19U + bitmapLen];
 }
 
-/** @internal Loads a single Group configuration structure from the file. */
-inline static hzl_Err_t
-hzl_LoadGroupConfig(hzl_ServerGroupConfig_t* const group, FILE* const fileStream)
+/** @internal Decodes the Client and Group configurations following the file header, checking
+ * each one as soon as it's decoded, in the same order as hzl_ServerInit() does. */
+static hzl_Err_t
+hzl_ServerDecodeAndCheckConfigs(hzl_ServerCtx_t* const ctx,
+                                const uint8_t* bytes,
+                                const size_t bitmapLen)
 {
     HZL_ERR_DECLARE(err);
-    err = hzl_LoadUint32Le(&group->maxCtrnonceDelayMsgs, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint32Le(&group->ctrNonceUpperLimit, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint32Le(&group->sessionDurationMillis, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint32Le(&group->delayBetweenRenNotificationsMillis, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint32Le(&group->clientSidsInGroupBitmap, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint16Le(&group->maxSilenceIntervalMillis, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadUint8(&group->gid, fileStream);
-    HZL_ERR_CHECK(err);
-    err = hzl_LoadBytes(group->unusedPadding, fileStream, 1U);
-    return err;
+    // Here we force the pointers to the constant configuration to be writable just once
+    // because we have to fill the configuration in the first place.
+    hzl_ServerClientConfig_t* const clientConfigs = (hzl_ServerClientConfig_t*) ctx->clientConfigs;
+    hzl_ServerGroupConfig_t* const groupConfigs = (hzl_ServerGroupConfig_t*) ctx->groupConfigs;
+    for (size_t i = 0U; i < ctx->serverConfig->amountOfClients; i++)
+    {
+        hzl_DecodeClientConfig(&clientConfigs[i], bytes);
+        bytes += HZL_SERVER_FILE_CLIENT_CONFIG_LEN;
+        err = hzl_ServerInitCheckClientConfig(clientConfigs, i);
+        HZL_ERR_CHECK(err);
+    }
+    hzl_ServerBitMapWord_t allClientSids[HZL_SERVER_BITMAP_WORDS];
+    hzl_ServerAllClientsBitmap(allClientSids, ctx->serverConfig->amountOfClients);
+    for (size_t i = 0U; i < ctx->serverConfig->amountOfGroups; i++)
+    {
+        hzl_DecodeGroupConfig(&groupConfigs[i], bytes, bitmapLen);
+        bytes += HZL_SERVER_FILE_GROUP_CONFIG_LEN_WITHOUT_BITMAP + bitmapLen;
+        err = hzl_ServerInitCheckGroupConfig(groupConfigs, i, allClientSids);
+        HZL_ERR_CHECK(err);
+    }
+    return HZL_OK;
+}
+
+_Static_assert(_Alignof(hzl_ServerCtx_t) <= HZL_CACHE_LINE_LEN,
+               "The arena alignment must fit the Server context, holding the Group hot states");
+
+/** @internal Allocates the context and all its arrays as one zeroed arena, laid out in the
+ * order they are accessed when processing a received message, and points the context to them.
+ * Copies the already loaded Server configuration in it. Free it with hzl_ServerFree(). */
+static hzl_ServerCtx_t*
+hzl_ServerArenaAlloc(const hzl_ServerConfig_t* const serverConfig)
+{
+    size_t arenaLen = 0U;
+    (void) hzl_OsArenaReserve(&arenaLen, sizeof(hzl_ServerCtx_t));  // Always at offset 0
+    const size_t serverConfigOffset = hzl_OsArenaReserve(
+            &arenaLen, sizeof(hzl_ServerConfig_t));
+    const size_t groupConfigsOffset = hzl_OsArenaReserve(
+            &arenaLen, serverConfig->amountOfGroups * sizeof(hzl_ServerGroupConfig_t));
+    const size_t groupStatesOffset = hzl_OsArenaReserve(
+            &arenaLen, serverConfig->amountOfGroups * sizeof(hzl_ServerGroupState_t));
+    const size_t clientConfigsOffset = hzl_OsArenaReserve(
+            &arenaLen, serverConfig->amountOfClients * sizeof(hzl_ServerClientConfig_t));
+    const size_t clientStatesOffset = hzl_OsArenaReserve(
+            &arenaLen, serverConfig->amountOfClients * sizeof(hzl_ServerClientState_t));
+    const size_t timerWheelOffset = hzl_OsArenaReserve(
+            &arenaLen, sizeof(hzl_ServerTimerWheel_t));
+#if HZL_SERVER_REJECTED_CACHE_SLOTS > 0
+    const size_t rejectedCacheOffset = hzl_OsArenaReserve(
+            &arenaLen, sizeof(hzl_ServerRejectedCache_t));
+#endif
+#if HZL_SADTP
+    const size_t sadtpRxPoolOffset = hzl_OsArenaReserve(
+            &arenaLen, sizeof(hzl_SadtpRxPool_t));
+#endif
+    uint8_t* const arena = hzl_OsArenaAlloc(arenaLen);
+    if (arena == NULL) { return NULL; }
+    hzl_ServerCtx_t* const ctx = (hzl_ServerCtx_t*) arena;
+    ctx->arenaLen = arenaLen;
+    // The constant configuration is written just once, here, before it's pointed to.
+    memcpy(&arena[serverConfigOffset], serverConfig, sizeof(hzl_ServerConfig_t));
+    ctx->serverConfig = (const hzl_ServerConfig_t*) &arena[serverConfigOffset];
+    ctx->groupConfigs = (const hzl_ServerGroupConfig_t*) &arena[groupConfigsOffset];
+    ctx->groupStates = (hzl_ServerGroupState_t*) &arena[groupStatesOffset];
+    ctx->clientConfigs = (const hzl_ServerClientConfig_t*) &arena[clientConfigsOffset];
+    ctx->clientStates = (hzl_ServerClientState_t*) &arena[clientStatesOffset];
+    ctx->timerWheel = (hzl_ServerTimerWheel_t*) &arena[timerWheelOffset];
+#if HZL_SERVER_REJECTED_CACHE_SLOTS > 0
+    ctx->rejectedCache = (hzl_ServerRejectedCache_t*) &arena[rejectedCacheOffset];
+#endif
+#if HZL_SADTP
+    ctx->sadtpRxPool = (hzl_SadtpRxPool_t*) &arena[sadtpRxPoolOffset];
+#endif
+    return ctx;
 }
 
 HZL_API hzl_Err_t
@@ -150,80 +241,62 @@ hzl_ServerNew(hzl_ServerCtx_t** const pCtx,
               const char* const fileName)
 {
     HZL_ERR_DECLARE(err);
-    FILE* fileStream = NULL;
+    uint8_t* bytes = NULL;
+    size_t len = 0U;
     hzl_ServerCtx_t* ctx = NULL;
+    hzl_ServerConfig_t serverConfig = {0};
+    uint8_t formatVersion = HZL_SERVER_FILE_FORMAT_V0;
     if (pCtx == NULL) { return HZL_ERR_NULL_CTX; }
     *pCtx = NULL;  // Empty output in case of allocation errors.
     if (fileName == NULL) { return HZL_ERR_NULL_FILENAME; }
-    fileStream = fopen(fileName, "r");
-    if (fileStream == NULL) { return HZL_ERR_CANNOT_OPEN_CONFIG_FILE; }
-    err = hzl_CheckMagicNumber(fileStream);
+    err = hzl_OsReadFile(&bytes, &len, fileName, HZL_SERVER_FILE_MAX_LEN);
+    HZL_ERR_CHECK(err);
+    err = hzl_CheckMagicNumber(&formatVersion, bytes, len);
     HZL_ERR_CLEANUP(err);
-    // At this point, the file was successfully opened and seems to be of the correct format.
-    ctx = calloc(1U, sizeof(hzl_ServerCtx_t));
-    if (ctx == NULL)
-    {
-        err = HZL_ERR_MALLOC_FAILED;
-        goto cleanup;
-    }
-    ctx->serverConfig = calloc(1U, sizeof(hzl_ServerConfig_t));
-    if (ctx->serverConfig == NULL)
+    // At this point, the file was successfully read and seems to be of the correct format.
+    // Its header tells the length of the whole file and of all arrays.
+    if (len < HZL_SERVER_FILE_MAGIC_NUMBER_LEN + HZL_SERVER_FILE_SERVER_CONFIG_LEN)
     {
-        err = HZL_ERR_MALLOC_FAILED;
+        err = HZL_ERR_UNEXPECTED_EOF;
         goto cleanup;
     }
-    // Here we force the pointer to the constant configuration to be writable just once
-    // because we have to fill the configuration in the first place.
-    err = hzl_LoadServerConfig((hzl_ServerConfig_t*) ctx->serverConfig, fileStream);
-    HZL_ERR_CLEANUP(err);
-    ctx->clientConfigs = calloc(ctx->serverConfig->amountOfClients,
-                                sizeof(hzl_ServerClientConfig_t));
-    if (ctx->clientConfigs == NULL)
+    hzl_DecodeServerConfig(&serverConfig, &bytes[HZL_SERVER_FILE_MAGIC_NUMBER_LEN]);
+#if HZL_SERVER_MAX_AMOUNT_OF_CLIENTS < 255U  // Otherwise any uint8_t amount fits
+    if (serverConfig.amountOfClients > HZL_SERVER_MAX_AMOUNT_OF_CLIENTS)
     {
-        err = HZL_ERR_MALLOC_FAILED;
+        // The Group bitmaps could not hold them
+        err = HZL_ERR_TOO_MANY_CLIENTS;
         goto cleanup;
     }
-    for (size_t client = 0; client < ctx->serverConfig->amountOfClients; client++)
-    {
-        // Here we force the pointer to the constant configuration to be writable just once
-        // because we have to fill the configuration in the first place.
-        err = hzl_LoadClientConfig(
-                (hzl_ServerClientConfig_t*) &ctx->clientConfigs[client],
-                fileStream);
-        HZL_ERR_CLEANUP(err);
-    }
-
-    ctx->groupConfigs = calloc(ctx->serverConfig->amountOfGroups,
-                               sizeof(hzl_ServerGroupConfig_t));
-    if (ctx->groupConfigs == NULL)
+#endif
+    const size_t bitmapLen = hzl_ServerFileBitmapLen(formatVersion,
+                                                     serverConfig.amountOfClients);
+    if (len < hzl_ServerFileLen(&serverConfig, bitmapLen))
     {
-        err = HZL_ERR_MALLOC_FAILED;
+        err = HZL_ERR_UNEXPECTED_EOF;
         goto cleanup;
     }
-    for (size_t group = 0; group < ctx->serverConfig->amountOfGroups; group++)
-    {
-        // Here we force the pointer to the constant configuration to be writable just once
-        // because we have to fill the configuration in the first place.
-        err = hzl_LoadGroupConfig(
-                (hzl_ServerGroupConfig_t*) &ctx->groupConfigs[group],
-                fileStream);
-        HZL_ERR_CLEANUP(err);
-    }
-    ctx->groupStates = calloc(
-            ctx->serverConfig->amountOfGroups, sizeof(hzl_ServerGroupState_t));
-    if (ctx->groupStates == NULL)
+    err = hzl_ServerInitCheckServerConfig(&serverConfig);
+    HZL_ERR_CLEANUP(err);
+    ctx = hzl_ServerArenaAlloc(&serverConfig);
+    if (ctx == NULL)
     {
         err = HZL_ERR_MALLOC_FAILED;
         goto cleanup;
     }
+    err = hzl_ServerDecodeAndCheckConfigs(
+            ctx, &bytes[HZL_SERVER_FILE_MAGIC_NUMBER_LEN + HZL_SERVER_FILE_SERVER_CONFIG_LEN],
+            bitmapLen);
+    HZL_ERR_CLEANUP(err);
     ctx->io.currentTime = hzl_OsCurrentTime;
-    ctx->io.trng = hzl_OsTrng;
-    err = hzl_ServerInit(ctx);
+    ctx->io.trng = hzl_OsCsprng;
+    // The configuration was checked while decoding it
+    err = hzl_ServerInitUnchecked(ctx);
     *pCtx = ctx;
     ctx = NULL;
     cleanup:
     {
-        fclose(fileStream);
+        HZL_SECURE_FREE(bytes, HZL_SERVER_FILE_MAX_LEN);  // Holds the LTKs
         if (err != HZL_OK) { hzl_ServerFree(&ctx); }
     }
     return err;
@@ -29,7 +29,8 @@
 /**
  * @file
  * @internal
- * Implementation of the hzl_ServerProcessReceived() function.
+ * Implementation of the hzl_ServerProcessReceived() and hzl_ServerProcessReceivedAt() functions
+ * and their dispatching of the unpacked message to the handler of its type.
  */
 
 #include "hzl.h"
@@ -37,6 +38,28 @@
 #include "hzl_CommonMessage.h"
 #include "hzl_ServerProcessReceived.h"
 
+/** @internal Common part of hzl_ServerProcessReceived() and hzl_ServerProcessReceivedAt(),
+ * after the parameters have been validated. */
+static hzl_Err_t
+hzl_ServerProcessReceivedChecked(hzl_CbsPduMsg_t* const reactionPdu,
+                                 hzl_RxSduMsg_t* const receivedUserData,
+                                 hzl_ServerCtx_t* const ctx,
+                                 const uint8_t* const receivedPdu,
+                                 const size_t receivedPduLen,
+                                 const hzl_CanId_t receivedCanId,
+                                 const hzl_Timestamp_t rxTimestamp)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_Header_t unpackedHdr;
+    err = hzl_CommonCheckReceivedGenericMsg(
+            &unpackedHdr, receivedPdu, receivedPduLen, receivedCanId,
+            HZL_SERVER_SID, ctx->serverConfig->headerType, ctx->serverConfig->headerPlacement);
+    HZL_ERR_CHECK(err);
+    return hzl_ServerProcessReceivedUnpacked(
+            reactionPdu, receivedUserData, ctx,
+            receivedPdu, receivedPduLen, receivedCanId, &unpackedHdr, rxTimestamp);
+}
+
 HZL_API hzl_Err_t
 hzl_ServerProcessReceived(hzl_CbsPduMsg_t* const reactionPdu,
                           hzl_RxSduMsg_t* const receivedUserData,
@@ -56,39 +79,94 @@ hzl_ServerProcessReceived(hzl_CbsPduMsg_t* const reactionPdu,
     // Clear any data that may still linger in the output location, if it's reused.
     // By doing so we avoid the situation where the message buffer contains trailing data
     // from a previously-decrypted message that may be security-critical.
-    hzl_ZeroOut(receivedUserData, sizeof(hzl_RxSduMsg_t));
-    hzl_ZeroOut(reactionPdu, sizeof(hzl_CbsPduMsg_t));
+    hzl_ClearReceivedOutputs(receivedUserData, reactionPdu);
     HZL_ERR_CHECK(err); // Return from any error of currentTime() only after the cleanups
-    hzl_Header_t unpackedHdr;
-    err = hzl_CommonCheckReceivedGenericMsg(
-            &unpackedHdr, receivedPdu, receivedPduLen,
-            HZL_SERVER_SID, ctx->serverConfig->headerType);
+    return hzl_ServerProcessReceivedChecked(
+            reactionPdu, receivedUserData, ctx,
+            receivedPdu, receivedPduLen, receivedCanId, rxTimestamp);
+}
+
+HZL_API hzl_Err_t
+hzl_ServerProcessReceivedAt(hzl_CbsPduMsg_t* const reactionPdu,
+                            hzl_RxSduMsg_t* const receivedUserData,
+                            hzl_ServerCtx_t* const ctx,
+                            const uint8_t* const receivedPdu,
+                            const size_t receivedPduLen,
+                            const hzl_CanId_t receivedCanId,
+                            const hzl_Timestamp_t rxTimestamp)
+{
+    if (reactionPdu == NULL) { return HZL_ERR_NULL_PDU; }
+    if (receivedUserData == NULL) { return HZL_ERR_NULL_SDU; }
+    HZL_ERR_DECLARE(err);
+    err = hzl_ServerCheckCtxPointers(ctx);
     HZL_ERR_CHECK(err);
-    receivedUserData->canId = receivedCanId;
-    switch (unpackedHdr.pty)
+    hzl_ClearReceivedOutputs(receivedUserData, reactionPdu);
+    return hzl_ServerProcessReceivedChecked(
+            reactionPdu, receivedUserData, ctx,
+            receivedPdu, receivedPduLen, receivedCanId, rxTimestamp);
+}
+
+/** @internal Dispatches the unpacked message to the handler of its type. */
+static hzl_Err_t
+hzl_ServerProcessReceivedDispatch(hzl_CbsPduMsg_t* const reactionPdu,
+                                  hzl_RxSduMsg_t* const receivedUserData,
+                                  hzl_ServerCtx_t* const ctx,
+                                  const uint8_t* const receivedPdu,
+                                  const size_t receivedPduLen,
+                                  const hzl_Header_t* const unpackedHdr,
+                                  const hzl_Timestamp_t rxTimestamp)
+{
+    switch (unpackedHdr->pty)
     {
         case HZL_PTY_REQ:
             return hzl_ServerProcessReceivedRequest(
                     reactionPdu, ctx,
-                    receivedPdu, receivedPduLen, &unpackedHdr, rxTimestamp);
+                    receivedPdu, receivedPduLen, unpackedHdr, rxTimestamp);
 
         case HZL_PTY_RES: // Fall-through to Server-only-msg error
         case HZL_PTY_REN:return HZL_ERR_SECWARN_SERVER_ONLY_MESSAGE;
 
-        case HZL_PTY_SADTP:return HZL_ERR_PROGRAMMING; // TODO to be implemented
+#if HZL_SADTP
+        case HZL_PTY_SADTP:
+            return hzl_ServerProcessReceivedSecuredTp(
+                    reactionPdu, receivedUserData,
+                    ctx, receivedPdu, receivedPduLen, unpackedHdr, rxTimestamp);
+#endif
 
         case HZL_PTY_SADFD:
             return hzl_ServerProcessReceivedSecuredFd(
                     reactionPdu, receivedUserData,
-                    ctx, receivedPdu, receivedPduLen, &unpackedHdr, rxTimestamp);
+                    ctx, receivedPdu, receivedPduLen, unpackedHdr, rxTimestamp);
 
         case HZL_PTY_UAD:
             return hzl_CommonProcessReceivedUnsecured(
                     receivedUserData, receivedPdu,
-                    receivedPduLen, &unpackedHdr, ctx->serverConfig->headerType);
+                    receivedPduLen, unpackedHdr,
+                    ctx->serverConfig->headerType, ctx->serverConfig->headerPlacement);
 
         case HZL_PTY_RFU1:  // Fall-through to default
         case HZL_PTY_RFU2:  // Fall-through to default
         default:return HZL_ERR_INVALID_PAYLOAD_TYPE;
     }
 }
+
+hzl_Err_t
+hzl_ServerProcessReceivedUnpacked(hzl_CbsPduMsg_t* const reactionPdu,
+                                  hzl_RxSduMsg_t* const receivedUserData,
+                                  hzl_ServerCtx_t* const ctx,
+                                  const uint8_t* const receivedPdu,
+                                  const size_t receivedPduLen,
+                                  const hzl_CanId_t receivedCanId,
+                                  const hzl_Header_t* const unpackedHdr,
+                                  const hzl_Timestamp_t rxTimestamp)
+{
+    receivedUserData->canId = receivedCanId;
+    HZL_ERR_DECLARE(err);
+    err = hzl_ServerDosAdmit(ctx, unpackedHdr, rxTimestamp);
+    HZL_ERR_CHECK(err);
+    err = hzl_ServerProcessReceivedDispatch(
+            reactionPdu, receivedUserData, ctx,
+            receivedPdu, receivedPduLen, unpackedHdr, rxTimestamp);
+    hzl_ServerDosAccount(ctx, unpackedHdr, err);
+    return err;
+}
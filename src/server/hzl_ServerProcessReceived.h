@@ -40,8 +40,67 @@ extern "C"
 {
 #endif
 
+#include "hzl_ServerInternal.h"
 #include "hzl_CommonInternal.h"
 #include "hzl_CommonHeader.h"
+#include "hzl_CommonAead.h"
+
+/**
+ * @internal
+ * Selects the STK to use during a Session renewal phase, in its expanded form.
+ */
+inline static hzl_AeadKey_t*
+hzl_ServerChoosePreviusOrCurrentAeadKey(const hzl_ServerCtx_t* const ctx,
+                                        const bool isPreviousSession,
+                                        const hzl_Gid_t gid)
+{
+    hzl_ServerGroupState_t* const state = &ctx->groupStates[gid];
+    if (isPreviousSession)
+    {
+        hzl_AeadKeyExpand(&state->previousAeadKey, state->previousStk);
+        return &state->previousAeadKey;
+    }
+    else
+    {
+        hzl_AeadKeyExpand(&state->currentAeadKey, state->currentStk);
+        return &state->currentAeadKey;
+    }
+}
+
+/**
+ * @internal
+ * Checks the freshness of the Counter Nonce of a received secured message, considering
+ * the Session it belongs to during a Session renewal phase.
+ *
+ * @param [out] isPreviousSession true if the message belongs to the previous Session.
+ *        May be NULL to check against the current Session only.
+ * @param [in] ctx to access the Group configuration and state
+ * @param [in] receivedCtrnonce Counter Nonce of the message
+ * @param [in] rxTimestamp timestamp of reception of the message
+ * @param [in] gid Group of the message
+ *
+ * @retval #HZL_OK if the Counter Nonce is fresh
+ * @retval #HZL_ERR_SECWARN_RECEIVED_OVERFLOWN_NONCE
+ * @retval #HZL_ERR_SECWARN_OLD_MESSAGE
+ */
+hzl_Err_t
+hzl_ServerCheckRxCtrnonce(bool* isPreviousSession,
+                          const hzl_ServerCtx_t* ctx,
+                          hzl_CtrNonce_t receivedCtrnonce,
+                          hzl_Timestamp_t rxTimestamp,
+                          hzl_Gid_t gid);
+
+/**
+ * @internal
+ * Updates the local Counter Nonce and the timestamp of the last valid received message
+ * of the Session the received message belongs to.
+ */
+void
+hzl_ServerGroupUpdateCtrnonceAndRxTimestamp(hzl_ServerCtx_t* ctx,
+                                            hzl_CtrNonce_t receivedCtrnonce,
+                                            hzl_Timestamp_t receptionTimestamp,
+                                            bool isPreviousSession,
+                                            hzl_Gid_t gid);
 
 /** @internal Validates the GID and SID of the received message. */
 hzl_Err_t
@@ -49,6 +108,32 @@ hzl_ServerValidateSidAndGid(const hzl_ServerCtx_t* ctx,
                             hzl_Gid_t gid,
                             hzl_Sid_t sid);
 
+/**
+ * @internal
+ * Handles a received message, which header is already unpacked and checked,
+ * according to its payload type.
+ *
+ * @param [out] reactionPdu automatic reaction to the message, if any
+ * @param [out] receivedUserData user data of the message, if any, already zeroed out
+ * @param [in, out] ctx to access the Group configuration and alter its state
+ * @param [in] receivedPdu received raw message
+ * @param [in] receivedPduLen length of \p receivedPdu in bytes
+ * @param [in] receivedCanId identifier of the underlying layer's PDU
+ * @param [in] unpackedHdr metadata of the CBS message in unpacked format
+ * @param [in] rxTimestamp timestamp of reception of the message
+ *
+ * @return same as hzl_ServerProcessReceived()
+ */
+hzl_Err_t
+hzl_ServerProcessReceivedUnpacked(hzl_CbsPduMsg_t* reactionPdu,
+                                  hzl_RxSduMsg_t* receivedUserData,
+                                  hzl_ServerCtx_t* ctx,
+                                  const uint8_t* receivedPdu,
+                                  size_t receivedPduLen,
+                                  hzl_CanId_t receivedCanId,
+                                  const hzl_Header_t* unpackedHdr,
+                                  hzl_Timestamp_t rxTimestamp);
+
 /**
  * @internal
  * Validates, decrypts and handles a received REQ message, preparing a RES reaction.
@@ -71,6 +156,34 @@ hzl_ServerProcessReceivedRequest(hzl_CbsPduMsg_t* msgToTx,
                                  const hzl_Header_t* unpackedHdr,
                                  hzl_Timestamp_t rxTimestamp);
 
+/**
+ * @internal
+ * Validates, decrypts and handles a received SADFD message, updating the local Counter Nonce,
+ * without copying the decrypted data anywhere else than into \p plaintext.
+ *
+ * @param [out] reactionPdu REN message, generated if required. Contains 0 bytes of data otherwise.
+ * @param [out] unpackedView metadata of the SADFD message, pointing to \p plaintext for the data
+ * @param [out] plaintext where to decrypt the user data into. Must be large enough for the
+ *        plaintext length declared in the message. May point exactly to the ciphertext in
+ *        \p rxPdu to decrypt in place, but must not overlap it otherwise.
+ * @param [in, out] ctx to access the Group configuration and alter its state
+ * @param [in] rxPdu received raw SADFD message
+ * @param [in] rxPduLen length of \p rxPdu in bytes
+ * @param [in] unpackedSadfdHeader metadata of the CBS message in unpacked format
+ * @param [in] rxTimestamp timestamp of reception of the SADFD message
+ *
+ * @return same as hzl_ServerProcessReceivedSecuredFd()
+ */
+hzl_Err_t
+hzl_ServerProcessReceivedSecuredFdView(hzl_CbsPduMsg_t* reactionPdu,
+                                       hzl_RxSduView_t* unpackedView,
+                                       uint8_t* plaintext,
+                                       hzl_ServerCtx_t* ctx,
+                                       const uint8_t* rxPdu,
+                                       size_t rxPduLen,
+                                       const hzl_Header_t* unpackedSadfdHeader,
+                                       hzl_Timestamp_t rxTimestamp);
+
 /**
  * @internal
  * Validates, decrypts and handles a received SADFD message, updating the local Counter Nonce.
@@ -95,13 +208,46 @@ hzl_ServerProcessReceivedSecuredFd(hzl_CbsPduMsg_t* reactionPdu,
                                    const hzl_Header_t* unpackedSadfdHeader,
                                    hzl_Timestamp_t rxTimestamp);
 
+#if HZL_SADTP
 /**
  * @internal
- * Validates, decrypts and handles a received SADTP message, updating the local Counter Nonce.
+ * Validates and handles a received SADTP frame, reassembling its message in the
+ * #hzl_ServerCtx_t.sadtpRxPool and updating the local Counter Nonce after its last frame.
  *
- * @param [out] unpackedMsg decrypted, validated and unpacked data contained in the SADFD message
+ * @param [out] reactionPdu REN message, generated if required. Contains 0 bytes of data otherwise.
+ * @param [out] unpackedView metadata of the SADTP message, pointing into its reassembly slot for
+ *        the data. Not for the user until the last frame of the message is received.
  * @param [in, out] ctx to access the Group configuration and alter its state
- * @param [in] rxPdu received raw SADTP message
+ * @param [in] rxPdu received raw SADTP frame
+ * @param [in] rxPduLen length of \p rxPdu in bytes
+ * @param [in] unpackedSadtpHeader metadata of the CBS message in unpacked format
+ * @param [in] rxTimestamp timestamp of reception
+ * @param [in] maxSduLen longest user data the caller can deliver: longer messages are refused
+ *        with #HZL_ERR_TOO_SHORT_OUTPUT_BUFFER as soon as their ptlen is received, before
+ *        the Counter Nonce is updated
+ *
+ * @return same as hzl_ServerProcessReceivedSecuredTp()
+ */
+hzl_Err_t
+hzl_ServerProcessReceivedSecuredTpView(hzl_CbsPduMsg_t* reactionPdu,
+                                       hzl_RxSduView_t* unpackedView,
+                                       hzl_ServerCtx_t* ctx,
+                                       const uint8_t* rxPdu,
+                                       size_t rxPduLen,
+                                       const hzl_Header_t* unpackedSadtpHeader,
+                                       hzl_Timestamp_t rxTimestamp,
+                                       size_t maxSduLen);
+
+/**
+ * @internal
+ * Validates and handles a received SADTP frame, updating the local Counter Nonce after the last
+ * frame of its message, copying the message data into \p unpackedMsg. Messages longer than
+ * \p unpackedMsg can hold are refused as soon as their ptlen is received.
+ *
+ * @param [out] reactionPdu REN message, generated if required. Contains 0 bytes of data otherwise.
+ * @param [out] unpackedMsg decrypted, validated and unpacked data contained in the SADTP message
+ * @param [in, out] ctx to access the Group configuration and alter its state
+ * @param [in] rxPdu received raw SADTP frame
  * @param [in] rxPduLen length of \p rxPdu in bytes
  * @param [in] unpackedSadtpHeader metadata of the CBS message in unpacked format
  * @param [in] rxTimestamp timestamp of reception
@@ -110,12 +256,14 @@ hzl_ServerProcessReceivedSecuredFd(hzl_CbsPduMsg_t* reactionPdu,
  *        message or with the local state
  */
 hzl_Err_t
-hzl_ServerProcessReceivedSecuredTp(hzl_RxSduMsg_t* unpackedMsg,
-                                   const hzl_ServerCtx_t* ctx,
+hzl_ServerProcessReceivedSecuredTp(hzl_CbsPduMsg_t* reactionPdu,
+                                   hzl_RxSduMsg_t* unpackedMsg,
+                                   hzl_ServerCtx_t* ctx,
                                    const uint8_t* rxPdu,
                                    size_t rxPduLen,
                                    const hzl_Header_t* unpackedSadtpHeader,
                                    hzl_Timestamp_t rxTimestamp);
+#endif  /* HZL_SADTP */
 
 #ifdef __cplusplus
 }
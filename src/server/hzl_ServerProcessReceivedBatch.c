@@ -0,0 +1,136 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Implementation of the hzl_ServerProcessReceivedBatch() function.
+ */
+
+#include "hzl.h"
+#include "hzl_ServerInternal.h"
+#include "hzl_CommonMessage.h"
+#include "hzl_ServerProcessReceived.h"
+
+/**
+ * @internal
+ * Messages unpacked and sorted at once, on the stack. Larger batches are split into
+ * chunks of this size.
+ */
+#define HZL_SERVER_BATCH_CHUNK_LEN 64U
+
+/**
+ * @internal
+ * Sorts the indices of the messages by their GID.
+ *
+ * The sort is stable, so the messages of the same Group keep their reception order, which
+ * matters for the freshness checks of the counter nonce. Insertion sort, as the chunk is short
+ * and a burst is often already grouped.
+ */
+static void
+hzl_ServerBatchSortByGid(uint8_t* const order,
+                         const hzl_Header_t* const unpackedHdrs,
+                         const size_t amount)
+{
+    for (size_t i = 1; i < amount; i++)
+    {
+        const uint8_t current = order[i];
+        size_t j = i;
+        while (j > 0 && unpackedHdrs[order[j - 1U]].gid > unpackedHdrs[current].gid)
+        {
+            order[j] = order[j - 1U];
+            j--;
+        }
+        order[j] = current;
+    }
+}
+
+/**
+ * @internal
+ * Processes up to #HZL_SERVER_BATCH_CHUNK_LEN messages, the context is already validated.
+ */
+static void
+hzl_ServerProcessReceivedChunk(hzl_CbsPduMsg_t* const reactionPdus,
+                               hzl_RxSduMsg_t* const receivedUserData,
+                               hzl_Err_t* const results,
+                               hzl_ServerCtx_t* const ctx,
+                               const hzl_RxPdu_t* const receivedPdus,
+                               const size_t amount)
+{
+    hzl_Header_t unpackedHdrs[HZL_SERVER_BATCH_CHUNK_LEN];
+    uint8_t order[HZL_SERVER_BATCH_CHUNK_LEN];
+    size_t amountUnpacked = 0;
+
+    // Clear the outputs and unpack all headers first, to know the Groups of the messages.
+    for (size_t i = 0; i < amount; i++)
+    {
+        hzl_ClearReceivedOutputs(&receivedUserData[i], &reactionPdus[i]);
+        results[i] = hzl_CommonCheckReceivedGenericMsg(
+                &unpackedHdrs[i], receivedPdus[i].data, receivedPdus[i].dataLen,
+                receivedPdus[i].canId, HZL_SERVER_SID,
+                ctx->serverConfig->headerType, ctx->serverConfig->headerPlacement);
+        if (results[i] == HZL_OK)
+        {
+            order[amountUnpacked++] = (uint8_t) i;
+        }
+    }
+    hzl_ServerBatchSortByGid(order, unpackedHdrs, amountUnpacked);
+    for (size_t k = 0; k < amountUnpacked; k++)
+    {
+        const uint8_t i = order[k];
+        results[i] = hzl_ServerProcessReceivedUnpacked(
+                &reactionPdus[i], &receivedUserData[i], ctx,
+                receivedPdus[i].data, receivedPdus[i].dataLen, receivedPdus[i].canId,
+                &unpackedHdrs[i], receivedPdus[i].rxTimestamp);
+    }
+}
+
+HZL_API hzl_Err_t
+hzl_ServerProcessReceivedBatch(hzl_CbsPduMsg_t* const reactionPdus,
+                               hzl_RxSduMsg_t* const receivedUserData,
+                               hzl_Err_t* const results,
+                               hzl_ServerCtx_t* const ctx,
+                               const hzl_RxPdu_t* const receivedPdus,
+                               const size_t amount)
+{
+    if (reactionPdus == NULL || results == NULL) { return HZL_ERR_NULL_PDU; }
+    if (receivedPdus == NULL && amount != 0) { return HZL_ERR_NULL_PDU; }
+    if (receivedUserData == NULL) { return HZL_ERR_NULL_SDU; }
+    HZL_ERR_DECLARE(err);
+    err = hzl_ServerCheckCtxPointers(ctx);
+    HZL_ERR_CHECK(err);
+    for (size_t start = 0; start < amount; start += HZL_SERVER_BATCH_CHUNK_LEN)
+    {
+        const size_t remaining = amount - start;
+        hzl_ServerProcessReceivedChunk(
+                &reactionPdus[start], &receivedUserData[start], &results[start],
+                ctx, &receivedPdus[start],
+                remaining < HZL_SERVER_BATCH_CHUNK_LEN ? remaining : HZL_SERVER_BATCH_CHUNK_LEN);
+    }
+    return HZL_OK;
+}
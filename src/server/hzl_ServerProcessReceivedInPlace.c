@@ -0,0 +1,127 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Implementation of the hzl_ServerProcessReceivedInPlace() function.
+ */
+
+#include "hzl.h"
+#include "hzl_ServerInternal.h"
+#include "hzl_CommonMessage.h"
+#include "hzl_CommonPayload.h"
+#include "hzl_ServerProcessReceived.h"
+
+/** @internal Dispatches the unpacked message to the handler of its type, decrypting
+ * the Secured Application Data in place. */
+static hzl_Err_t
+hzl_ServerProcessReceivedInPlaceDispatch(hzl_CbsPduMsg_t* const reactionPdu,
+                                         hzl_RxSduView_t* const receivedUserData,
+                                         hzl_ServerCtx_t* const ctx,
+                                         uint8_t* const receivedPdu,
+                                         const size_t receivedPduLen,
+                                         const hzl_Header_t* const unpackedHdr,
+                                         const hzl_Timestamp_t rxTimestamp)
+{
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->serverConfig->headerType,
+                                                        ctx->serverConfig->headerPlacement);
+    switch (unpackedHdr->pty)
+    {
+        case HZL_PTY_REQ:
+            return hzl_ServerProcessReceivedRequest(
+                    reactionPdu, ctx,
+                    receivedPdu, receivedPduLen, unpackedHdr, rxTimestamp);
+
+        case HZL_PTY_RES: // Fall-through to Server-only-msg error
+        case HZL_PTY_REN:return HZL_ERR_SECWARN_SERVER_ONLY_MESSAGE;
+
+#if HZL_SADTP
+        case HZL_PTY_SADTP:
+            // Reassembled and decrypted in the pool: the view points into it.
+            return hzl_ServerProcessReceivedSecuredTpView(
+                    reactionPdu, receivedUserData,
+                    ctx, receivedPdu, receivedPduLen, unpackedHdr, rxTimestamp,
+                    HZL_SADTP_MAX_SDU_LEN);
+#endif
+
+        case HZL_PTY_SADFD:
+            if (receivedPduLen < packedHdrLen + HZL_SADFD_METADATA_IN_PAYLOAD_LEN)
+            {
+                // Cannot even point to the ciphertext to decrypt it in place.
+                return HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_SADFD;
+            }
+            return hzl_ServerProcessReceivedSecuredFdView(
+                    reactionPdu, receivedUserData,
+                    &receivedPdu[packedHdrLen + HZL_SADFD_CTEXT_IDX],  // Decrypt in place
+                    ctx, receivedPdu, receivedPduLen, unpackedHdr, rxTimestamp);
+
+        case HZL_PTY_UAD:
+            return hzl_CommonProcessReceivedUnsecuredView(
+                    receivedUserData, receivedPdu,
+                    receivedPduLen, unpackedHdr,
+                    ctx->serverConfig->headerType, ctx->serverConfig->headerPlacement);
+
+        case HZL_PTY_RFU1:  // Fall-through to default
+        case HZL_PTY_RFU2:  // Fall-through to default
+        default:return HZL_ERR_INVALID_PAYLOAD_TYPE;
+    }
+}
+
+HZL_API hzl_Err_t
+hzl_ServerProcessReceivedInPlace(hzl_CbsPduMsg_t* const reactionPdu,
+                                 hzl_RxSduView_t* const receivedUserData,
+                                 hzl_ServerCtx_t* const ctx,
+                                 uint8_t* const receivedPdu,
+                                 const size_t receivedPduLen,
+                                 const hzl_CanId_t receivedCanId,
+                                 const hzl_Timestamp_t rxTimestamp)
+{
+    if (reactionPdu == NULL) { return HZL_ERR_NULL_PDU; }
+    if (receivedUserData == NULL) { return HZL_ERR_NULL_SDU; }
+    HZL_ERR_DECLARE(err);
+    err = hzl_ServerCheckCtxPointers(ctx);
+    HZL_ERR_CHECK(err);
+    // The user data is not copied anywhere, so only the small view and the length of the
+    // reaction need clearing. Every reaction is fully written up to its length.
+    hzl_ZeroOut(receivedUserData, sizeof(hzl_RxSduView_t));
+    reactionPdu->dataLen = 0;
+    hzl_Header_t unpackedHdr;
+    err = hzl_CommonCheckReceivedGenericMsg(
+            &unpackedHdr, receivedPdu, receivedPduLen, receivedCanId,
+            HZL_SERVER_SID, ctx->serverConfig->headerType, ctx->serverConfig->headerPlacement);
+    HZL_ERR_CHECK(err);
+    receivedUserData->canId = receivedCanId;
+    err = hzl_ServerDosAdmit(ctx, &unpackedHdr, rxTimestamp);
+    HZL_ERR_CHECK(err);
+    err = hzl_ServerProcessReceivedInPlaceDispatch(
+            reactionPdu, receivedUserData, ctx,
+            receivedPdu, receivedPduLen, &unpackedHdr, rxTimestamp);
+    hzl_ServerDosAccount(ctx, &unpackedHdr, err);
+    return err;
+}
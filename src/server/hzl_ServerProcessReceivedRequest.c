@@ -56,9 +56,7 @@ hzl_ServerValidateSidAndGid(const hzl_ServerCtx_t* const ctx,
         return HZL_ERR_UNKNOWN_GROUP;
     }
     // SID 0 is server: already checked for that.
-    // SID 1 maps to bit at index 0, SID 2 to index 1 etc.
-    const hzl_ServerBitMap_t sidAsBitFlag = 1U << (sid - 1U);
-    if (!(ctx->groupConfigs[gid].clientSidsInGroupBitmap & sidAsBitFlag))
+    if (!hzl_ServerBitMapHasSid(ctx->groupConfigs[gid].clientSidsInGroupBitmap, sid))
     {
         return HZL_ERR_SECWARN_NOT_IN_GROUP;
     }
@@ -67,7 +65,7 @@ hzl_ServerValidateSidAndGid(const hzl_ServerCtx_t* const ctx,
 
 inline static hzl_Err_t
 hzl_ServerBuildMsgResponse(hzl_CbsPduMsg_t* const msgToTx,
-                           const hzl_ServerCtx_t* const ctx,
+                           hzl_ServerCtx_t* const ctx,
                            const uint8_t* const encodedRequestNonce,
                            const hzl_Gid_t gid,
                            const hzl_Sid_t clientSid)
@@ -79,60 +77,64 @@ hzl_ServerBuildMsgResponse(hzl_CbsPduMsg_t* const msgToTx,
             .sid = HZL_SERVER_SID,
             .pty = HZL_PTY_RES,
     };
-    const uint8_t packedHdrLen = hzl_HeaderLen(ctx->serverConfig->headerType);
-    hzl_HeaderPackFunc const headerPackFunc =
-            hzl_HeaderPackFuncForType(ctx->serverConfig->headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->serverConfig->headerType,
+                                                        ctx->serverConfig->headerPlacement);
     // Prepare RES Payload
-    // Write the packed header at the beginning of the CAN FD frame's payload.
-    headerPackFunc(msgToTx->data, &unpackedResHeader);
+    // Write the packed header at the beginning of the CAN FD frame's payload and/or CAN ID.
+    hzl_HeaderPackPlaced(msgToTx->data, &msgToTx->canId, &unpackedResHeader,
+                         ctx->serverConfig->headerType, ctx->serverConfig->headerPlacement);
     // Destination client
     msgToTx->data[packedHdrLen + HZL_RES_CLIENT_IDX] = clientSid;
     // Counter Nonce of the Group
     hzl_EncodeLe24(&msgToTx->data[packedHdrLen + HZL_RES_CTRNONCE_IDX],
-                   ctx->groupStates[gid].currentCtrNonce);
+                   hzl_ServerGroupHotConst(ctx, gid)->currentCtrNonce);
     // Response nonce
     err = hzl_NonZeroTrng(&msgToTx->data[packedHdrLen + HZL_RES_RESNONCE_IDX],
                           ctx->io.trng,
                           sizeof(hzl_ResNonce_t));
     HZL_ERR_CHECK(err);
     // Authenticated decryption initialisation
+    hzl_AeadKey_t ltkAeadKey = {0};
+    hzl_AeadKey_t* key = &ltkAeadKey;
+    if (ctx->clientStates != NULL)
+    {
+        // Expanded once at initialisation
+        key = &ctx->clientStates[clientSid - 1U].ltkAeadKey;
+    }
+    else
+    {
+        hzl_AeadKeyExpand(&ltkAeadKey, ctx->clientConfigs[clientSid - 1U].ltk);
+    }
     hzl_Aead_t aead;
     hzl_CommonAeadInitRes(&aead,
-                          ctx->clientConfigs[clientSid - 1U].ltk,
+                          key,
                           &unpackedResHeader,
                           &msgToTx->data[packedHdrLen + HZL_RES_CTRNONCE_IDX],
                           encodedRequestNonce,
                           &msgToTx->data[packedHdrLen + HZL_RES_RESNONCE_IDX],
                           clientSid);
     // Encryption start
-    const size_t processedCtLen = hzl_AeadEncryptUpdate(
+    hzl_AeadEncrypt(
             &aead,
             &msgToTx->data[packedHdrLen + HZL_RES_CTEXT_IDX],  // Output: ciphertext
             ctx->groupStates[gid].currentStk,  // Input: plaintext
             HZL_RES_CTEXT_LEN,
             &msgToTx->data[packedHdrLen + HZL_RES_TAG_IDX],
             HZL_RES_TAG_LEN);
-    // Finish authenticated encryption and generate tag
-    /*
-    hzl_AeadEncryptFinish(
-            &aead,
-            &msgToTx->data[packedHdrLen + HZL_RES_CTEXT_IDX + processedCtLen],  // Flush CT
-            &msgToTx->data[packedHdrLen + HZL_RES_TAG_IDX],
-            HZL_RES_TAG_LEN);
-    */
+    if (key == &ltkAeadKey) { hzl_AeadKeyClear(&ltkAeadKey); }
     // Message is packed in binary format, ready to transmit
     msgToTx->dataLen = packedHdrLen + HZL_RES_PAYLOAD_LEN;
     return HZL_OK;
 }
 
 void
-hzl_ServerUpdateCurrentRxLastMessageInstant(const hzl_ServerCtx_t* const ctx,
+hzl_ServerUpdateCurrentRxLastMessageInstant(hzl_ServerCtx_t* const ctx,
                                             const hzl_Timestamp_t rxTimestamp,
                                             const hzl_Gid_t gid)
 {
-    ctx->groupStates[gid].currentRxLastMessageInstant = rxTimestamp;
-    if (ctx->groupStates[gid].currentRxLastMessageInstant
-        == ctx->groupStates[gid].sessionStartInstant)
+    hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHot(ctx, gid);
+    hot->currentRxLastMessageInstant = rxTimestamp;
+    if (hot->currentRxLastMessageInstant == hot->sessionStartInstant)
     {
         // The Request was received IMMEDIATELY after the Session was started, within the
         // same millisecond. This happens on fast busses sometimes on the bus startup and
@@ -143,7 +145,7 @@ hzl_ServerUpdateCurrentRxLastMessageInstant(const hzl_ServerCtx_t* const ctx,
         // and sessionStartInstant to be different, as their equality is used to understand
         // whether there is at least one Client that has Requested the Session information.
         // There is one Client, otherwise we would not be in this function.
-        ctx->groupStates[gid].currentRxLastMessageInstant++;
+        hot->currentRxLastMessageInstant++;
     }
 }
 
@@ -159,7 +161,8 @@ hzl_ServerProcessReceivedRequest(hzl_CbsPduMsg_t* const msgToTx,
     err = hzl_ServerValidateSidAndGid(ctx, unpackedReqHeader->gid, unpackedReqHeader->sid);
     HZL_ERR_CHECK(err);
     // REQ msg must be long enough to contain the required fields
-    const uint8_t packedHdrLen = hzl_HeaderLen(ctx->serverConfig->headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->serverConfig->headerType,
+                                                        ctx->serverConfig->headerPlacement);
     if (rxPduLen < packedHdrLen + HZL_REQ_PAYLOAD_LEN)
     {
         // We would overflow valid memory.
@@ -173,8 +176,17 @@ hzl_ServerProcessReceivedRequest(hzl_CbsPduMsg_t* const msgToTx,
     // Validate the msg with
     // tag = hash(LTK || label || GID || SID || PTY || reqnonce)
     hzl_Hash_t hash;
-    hzl_ReqHashInit(&hash, ctx->clientConfigs[unpackedReqHeader->sid - 1U].ltk,
-                    unpackedReqHeader, encodedRequestNonce);
+    if (ctx->clientStates != NULL)
+    {
+        // Resume after the constant LTK || label, absorbed once at initialisation
+        hzl_HashResumeMidstate(&hash,
+                               &ctx->clientStates[unpackedReqHeader->sid - 1U].reqHashMidstate);
+    }
+    else
+    {
+        hzl_ReqHashInitPrefix(&hash, ctx->clientConfigs[unpackedReqHeader->sid - 1U].ltk);
+    }
+    hzl_ReqHashUpdateMsg(&hash, unpackedReqHeader, encodedRequestNonce);
     err = hzl_HashDigestCheck(&hash,
                               &rxPdu[packedHdrLen + HZL_REQ_TAG_IDX],
                               HZL_REQ_TAG_LEN);
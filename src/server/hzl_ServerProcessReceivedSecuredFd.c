@@ -28,7 +28,8 @@
 
 /**
  * @file
- * @internal Implementation of the hzl_ServerProcessReceivedSecuredFd() function
+ * @internal Implementation of the hzl_ServerProcessReceivedSecuredFd() and
+ * hzl_ServerProcessReceivedSecuredFdView() functions
  */
 
 #include "hzl_ServerInternal.h"
@@ -43,25 +44,13 @@ hzl_ServerIsCtrNonceOfPreviousSession(const hzl_ServerCtx_t* const ctx,
                                       const hzl_CtrNonce_t receivedCtrnonce,
                                       const hzl_Gid_t gid)
 {
+    const hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHotConst(ctx, gid);
     const hzl_CtrNonce_t average = (hzl_CtrNonce_t)
-            ((ctx->groupStates[gid].currentCtrNonce + ctx->groupStates[gid].previousCtrNonce) / 2U);
+            ((hot->currentCtrNonce + hot->previousCtrNonce) / 2U);
     return receivedCtrnonce >= average;
 }
 
-/**
- * @internal
- * Selects the STK to use during a Session renewal phase.
- */
-inline static const uint8_t*
-hzl_ServerChoosePreviusOrCurrentStk(const hzl_ServerCtx_t* const ctx,
-                                    const bool isPreviousSession,
-                                    const hzl_Gid_t gid)
-{
-    if (isPreviousSession) { return ctx->groupStates[gid].previousStk; }
-    else { return ctx->groupStates[gid].currentStk; }
-}
-
-static hzl_Err_t
+hzl_Err_t
 hzl_ServerCheckRxCtrnonce(bool* const isPreviousSession,
                           const hzl_ServerCtx_t* const ctx,
                           const hzl_CtrNonce_t receivedCtrnonce,
@@ -77,17 +66,19 @@ hzl_ServerCheckRxCtrnonce(bool* const isPreviousSession,
             isPreviousSession != NULL
             && hzl_ServerSessionRenewalPhaseIsActive(ctx, gid)
             && hzl_ServerIsCtrNonceOfPreviousSession(ctx, receivedCtrnonce, gid);
+    const hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHotConst(ctx, gid);
+    const hzl_ServerGroupHotConfig_t* const hotConfig = hzl_ServerGroupHotConfig(ctx, gid);
     hzl_Timestamp_t selectedLastRxTimestamp;
     hzl_CtrNonce_t selectedCtrNonce;
     if (isPrevious)
     {
-        selectedLastRxTimestamp = ctx->groupStates[gid].previousRxLastMessageInstant;
-        selectedCtrNonce = ctx->groupStates[gid].previousCtrNonce;
+        selectedLastRxTimestamp = hot->previousRxLastMessageInstant;
+        selectedCtrNonce = hot->previousCtrNonce;
     }
     else
     {
-        selectedLastRxTimestamp = ctx->groupStates[gid].currentRxLastMessageInstant;
-        selectedCtrNonce = ctx->groupStates[gid].currentCtrNonce;
+        selectedLastRxTimestamp = hot->currentRxLastMessageInstant;
+        selectedCtrNonce = hot->currentCtrNonce;
     }
     // Freshness of received ctrnonce compared to the ctrnonce of the last
     // received message of the previous or current session, depending where
@@ -95,8 +86,8 @@ hzl_ServerCheckRxCtrnonce(bool* const isPreviousSession,
     const hzl_CtrNonce_t delay = hzl_CommonCtrDelay(
             selectedLastRxTimestamp,
             rxTimestamp,
-            ctx->groupConfigs[gid].maxCtrnonceDelayMsgs,
-            ctx->groupConfigs[gid].maxSilenceIntervalMillis);
+            hotConfig->maxCtrnonceDelayMsgs,
+            hotConfig->maxSilenceIntervalMillis);
     // Casting to signed to avoid compiler errors. Counter nonces anyway use
     // only 24 bits, so the signed value is the same as the unsigned.
     const int32_t oldestToleratedCtrNonce = (int32_t) selectedCtrNonce - (int32_t) delay;
@@ -108,27 +99,28 @@ hzl_ServerCheckRxCtrnonce(bool* const isPreviousSession,
     return HZL_OK;
 }
 
-static void
-hzl_ServerGroupUpdateCtrnonceAndRxTimestamp(const hzl_ServerCtx_t* const ctx,
+void
+hzl_ServerGroupUpdateCtrnonceAndRxTimestamp(hzl_ServerCtx_t* const ctx,
                                             const hzl_CtrNonce_t receivedCtrnonce,
                                             const hzl_Timestamp_t receptionTimestamp,
                                             const bool isPreviousSession,
                                             const hzl_Gid_t gid)
 {
+    hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHot(ctx, gid);
     if (isPreviousSession)
     {
-        if (receivedCtrnonce > ctx->groupStates[gid].previousCtrNonce)
+        if (receivedCtrnonce > hot->previousCtrNonce)
         {
-            ctx->groupStates[gid].previousCtrNonce = receivedCtrnonce;
+            hot->previousCtrNonce = receivedCtrnonce;
         }
         hzl_ServerGroupIncrPreviousCtrnonce(ctx, gid);
-        ctx->groupStates[gid].previousRxLastMessageInstant = receptionTimestamp;
+        hot->previousRxLastMessageInstant = receptionTimestamp;
     }
     else
     {
-        if (receivedCtrnonce > ctx->groupStates[gid].currentCtrNonce)
+        if (receivedCtrnonce > hot->currentCtrNonce)
         {
-            ctx->groupStates[gid].currentCtrNonce = receivedCtrnonce;
+            hot->currentCtrNonce = receivedCtrnonce;
         }
         hzl_ServerGroupIncrCurrentCtrnonce(ctx, gid);
         hzl_ServerUpdateCurrentRxLastMessageInstant(ctx, receptionTimestamp, gid);
@@ -136,13 +128,14 @@ hzl_ServerGroupUpdateCtrnonceAndRxTimestamp(const hzl_ServerCtx_t* const ctx,
 }
 
 hzl_Err_t
-hzl_ServerProcessReceivedSecuredFd(hzl_CbsPduMsg_t* const reactionPdu,
-                                   hzl_RxSduMsg_t* const unpackedMsg,
-                                   hzl_ServerCtx_t* const ctx,
-                                   const uint8_t* const rxPdu,
-                                   const size_t rxPduLen,
-                                   const hzl_Header_t* const unpackedSadfdHeader,
-                                   const hzl_Timestamp_t rxTimestamp)
+hzl_ServerProcessReceivedSecuredFdView(hzl_CbsPduMsg_t* const reactionPdu,
+                                       hzl_RxSduView_t* const unpackedView,
+                                       uint8_t* const plaintext,
+                                       hzl_ServerCtx_t* const ctx,
+                                       const uint8_t* const rxPdu,
+                                       const size_t rxPduLen,
+                                       const hzl_Header_t* const unpackedSadfdHeader,
+                                       const hzl_Timestamp_t rxTimestamp)
 {
     HZL_ERR_DECLARE(err);
     err = hzl_ServerValidateSidAndGid(ctx, unpackedSadfdHeader->gid, unpackedSadfdHeader->sid);
@@ -152,7 +145,8 @@ hzl_ServerProcessReceivedSecuredFd(hzl_CbsPduMsg_t* const reactionPdu,
     // Session should NOT be considered anymore.
     hzl_ServerSessionRenewalPhaseExitIfNeeded(ctx, rxTimestamp, unpackedSadfdHeader->gid);
     // SADFD msg must be long enough to contain at least the metadata (case of empty SDU)
-    const uint8_t packedHdrLen = hzl_HeaderLen(ctx->serverConfig->headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->serverConfig->headerType,
+                                                        ctx->serverConfig->headerPlacement);
     if (rxPduLen < packedHdrLen + HZL_SADFD_METADATA_IN_PAYLOAD_LEN)
     {
         // Cannot even read the metadata of the message, including the ciphertext length.
@@ -182,38 +176,46 @@ hzl_ServerProcessReceivedSecuredFd(hzl_CbsPduMsg_t* const reactionPdu,
         // PDU lays is much longer than the PDU itself, as long as it's long-enough to hold it.
         return HZL_ERR_TOO_LONG_CIPHERTEXT;
     }
+    // Exact repetitions of a message rejected with the same key are rejected again right away.
+    // The start of the Session identifies its STK, which is per Group, and the header is part
+    // of the validated data, but may be in the CAN ID: both are mixed in with the payload.
+    // Fingerprinted before decrypting in place.
+    const hzl_Timestamp_t sessionStart =
+            hzl_ServerGroupHotConst(ctx, unpackedSadfdHeader->gid)->sessionStartInstant;
+    const uint64_t keyId = ((uint64_t) sessionStart << 25U)
+                           | ((uint64_t) unpackedSadfdHeader->gid << 17U)
+                           | ((uint64_t) unpackedSadfdHeader->sid << 9U)
+                           | ((uint64_t) unpackedSadfdHeader->pty << 1U)
+                           | (uint64_t) isPreviousSession;
+    const uint64_t fingerprint = hzl_ServerRejectedFingerprint(
+            rxPdu, pduLenInferredFromCtlen, keyId);
+    if (hzl_ServerRejectedCacheLookup(ctx, fingerprint))
+    {
+        return HZL_ERR_SECWARN_INVALID_TAG;
+    }
     hzl_Aead_t aead;
     hzl_CommonAeadInitSadfd(
             &aead,
-            hzl_ServerChoosePreviusOrCurrentStk(ctx, isPreviousSession,
-                                                unpackedSadfdHeader->gid),
+            hzl_ServerChoosePreviusOrCurrentAeadKey(ctx, isPreviousSession,
+                                                    unpackedSadfdHeader->gid),
             unpackedSadfdHeader,
             receivedCtrnonce,
             ptlen);
-    err = hzl_AeadDecryptUpdate(
+    err = hzl_AeadDecrypt(
             &aead,
-            unpackedMsg->data,  // Output: plaintext
+            plaintext,  // Output: plaintext, may be exactly over the ciphertext
             &rxPdu[packedHdrLen + HZL_SADFD_CTEXT_IDX],  // Input: ciphertext
             ctlen,
             &rxPdu[packedHdrLen + HZL_SADFD_TAG_IDX(ctlen)],
             HZL_SADFD_TAG_LEN);
-
-    /*
-    // Finish authenticated decryption and validate tag
-    err = hzl_AeadDecryptFinish(
-            &aead,
-            &unpackedMsg->data[processedPtLen],
-            &rxPdu[packedHdrLen + HZL_SADFD_TAG_IDX(ctlen)],
-            HZL_SADFD_TAG_LEN);
-    */
-
     if (err != HZL_OK)
     {
         // Securely clear the decrypted data before returning. Some of the decrypted data may
         // be correct, as potential errors could be injected later on in the ciphertext or even
         // in the tag. Just to avoid any leakage of information or the user reading data that may
         // not be correct, as it is not validated with the tag, erase everything written so far.
-        hzl_ZeroOut(unpackedMsg->data, ptlen);
+        hzl_ZeroOut(plaintext, ptlen);
+        if (err == HZL_ERR_SECWARN_INVALID_TAG) { hzl_ServerRejectedCacheInsert(ctx, fingerprint); }
         return err;
     }
     // Save the received counter nonce as local one and the reception timestamp.
@@ -221,11 +223,12 @@ hzl_ServerProcessReceivedSecuredFd(hzl_CbsPduMsg_t* const reactionPdu,
                                                 isPreviousSession,
                                                 unpackedSadfdHeader->gid);
     // Copy decrypted metadata to the user's output struct
-    unpackedMsg->wasSecured = true;
-    unpackedMsg->isForUser = true;
-    unpackedMsg->gid = unpackedSadfdHeader->gid;
-    unpackedMsg->sid = unpackedSadfdHeader->sid;
-    unpackedMsg->dataLen = ptlen;
+    unpackedView->data = plaintext;
+    unpackedView->wasSecured = true;
+    unpackedView->isForUser = true;
+    unpackedView->gid = unpackedSadfdHeader->gid;
+    unpackedView->sid = unpackedSadfdHeader->sid;
+    unpackedView->dataLen = ptlen;
     // Check if the Session is expired and should be renewed, in order to send the REN message
     // using the ctrnonce that was already updated after the reception of the SADFD message just
     // processed.
@@ -233,3 +236,24 @@ hzl_ServerProcessReceivedSecuredFd(hzl_CbsPduMsg_t* const reactionPdu,
             reactionPdu, ctx, rxTimestamp, unpackedSadfdHeader->gid);
     return err;
 }
+
+hzl_Err_t
+hzl_ServerProcessReceivedSecuredFd(hzl_CbsPduMsg_t* const reactionPdu,
+                                   hzl_RxSduMsg_t* const unpackedMsg,
+                                   hzl_ServerCtx_t* const ctx,
+                                   const uint8_t* const rxPdu,
+                                   const size_t rxPduLen,
+                                   const hzl_Header_t* const unpackedSadfdHeader,
+                                   const hzl_Timestamp_t rxTimestamp)
+{
+    hzl_RxSduView_t unpackedView = {0};
+    const hzl_Err_t err = hzl_ServerProcessReceivedSecuredFdView(
+            reactionPdu, &unpackedView, unpackedMsg->data, ctx,
+            rxPdu, rxPduLen, unpackedSadfdHeader, rxTimestamp);
+    unpackedMsg->wasSecured = unpackedView.wasSecured;
+    unpackedMsg->isForUser = unpackedView.isForUser;
+    unpackedMsg->gid = unpackedView.gid;
+    unpackedMsg->sid = unpackedView.sid;
+    unpackedMsg->dataLen = unpackedView.dataLen;
+    return err;
+}
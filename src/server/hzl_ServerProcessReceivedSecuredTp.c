@@ -0,0 +1,159 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal Implementation of the hzl_ServerProcessReceivedSecuredTp() and
+ * hzl_ServerProcessReceivedSecuredTpView() functions
+ */
+
+#include "hzl_ServerInternal.h"
+#include "hzl_CommonMessage.h"
+#include "hzl_CommonHeader.h"
+#include "hzl_CommonPayload.h"
+#include "hzl_ServerProcessReceived.h"
+
+#include <string.h>
+
+#if HZL_SADTP
+
+hzl_Err_t
+hzl_ServerProcessReceivedSecuredTpView(hzl_CbsPduMsg_t* const reactionPdu,
+                                       hzl_RxSduView_t* const unpackedView,
+                                       hzl_ServerCtx_t* const ctx,
+                                       const uint8_t* const rxPdu,
+                                       const size_t rxPduLen,
+                                       const hzl_Header_t* const unpackedSadtpHeader,
+                                       const hzl_Timestamp_t rxTimestamp,
+                                       const size_t maxSduLen)
+{
+    HZL_ERR_DECLARE(err);
+    const hzl_Gid_t gid = unpackedSadtpHeader->gid;
+    err = hzl_ServerValidateSidAndGid(ctx, gid, unpackedSadtpHeader->sid);
+    HZL_ERR_CHECK(err);
+    // Check if the Session renewal phase must be terminated before processing the SADTP frame
+    // in order to avoid accepting messages belonging to the previous Session, if the previous
+    // Session should NOT be considered anymore.
+    hzl_ServerSessionRenewalPhaseExitIfNeeded(ctx, rxTimestamp, gid);
+    if (ctx->sadtpRxPool == NULL) { return HZL_ERR_NULL_SADTP_POOL; }
+    // SADTP frame must contain the PCI and at least one byte of the message
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->serverConfig->headerType,
+                                                        ctx->serverConfig->headerPlacement);
+    if (rxPduLen < packedHdrLen + HZL_SADTP_SEGMENT_IDX + HZL_SADTP_MIN_SEGMENT_LEN)
+    {
+        return HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_SADTP;
+    }
+    // The message delivered with the previous frame was already consumed by the user.
+    hzl_CommonSadtpRxReleaseDelivered(ctx->sadtpRxPool);
+    const uint8_t* const segment = &rxPdu[packedHdrLen + HZL_SADTP_SEGMENT_IDX];
+    const size_t segmentLen = rxPduLen - packedHdrLen - HZL_SADTP_SEGMENT_IDX;
+    hzl_SadtpRxSlot_t* slot;
+    err = hzl_CommonSadtpRxFindSlot(&slot, ctx->sadtpRxPool, unpackedSadtpHeader,
+                                    rxPdu[packedHdrLen + HZL_SADTP_PCI_IDX],
+                                    segment, segmentLen, rxTimestamp);
+    HZL_ERR_CHECK(err);
+    const bool hadMetadata = hzl_CommonSadtpRxHasMetadata(slot);
+    const size_t metadataLen = hzl_CommonSadtpRxAbsorbMetadata(slot, segment, segmentLen);
+    if (!hadMetadata && hzl_CommonSadtpRxHasMetadata(slot))
+    {
+        // Check the ctrnonce as soon as it's known, not to decrypt messages bound to be dropped.
+        err = hzl_ServerCheckRxCtrnonce(&slot->isPreviousSession, ctx, slot->ctrNonce,
+                                        rxTimestamp, gid);
+        if (err != HZL_OK)
+        {
+            hzl_CommonSadtpRxRelease(slot);
+            return err;
+        }
+        err = hzl_CommonSadtpRxStart(
+                slot,
+                hzl_ServerChoosePreviusOrCurrentAeadKey(ctx, slot->isPreviousSession, gid),
+                unpackedSadtpHeader, maxSduLen);
+        HZL_ERR_CHECK(err);
+    }
+    hzl_CommonSadtpRxAbsorbPayload(slot, &segment[metadataLen], segmentLen - metadataLen);
+    if (!hzl_CommonSadtpRxIsComplete(slot))
+    {
+        // Valid frame, but the message is not complete yet: nothing for the user.
+        unpackedView->wasSecured = true;
+        unpackedView->gid = gid;
+        unpackedView->sid = unpackedSadtpHeader->sid;
+        return HZL_OK;
+    }
+    // Check the ctrnonce again: the local one or the Session may have changed while the
+    // frames of the message were arriving.
+    bool isPreviousSession = false;
+    err = hzl_ServerCheckRxCtrnonce(&isPreviousSession, ctx, slot->ctrNonce, rxTimestamp, gid);
+    if (err == HZL_OK && isPreviousSession != slot->isPreviousSession)
+    {
+        err = HZL_ERR_SECWARN_OLD_MESSAGE;  // Secured with an STK that is not in use anymore
+    }
+    if (err != HZL_OK)
+    {
+        hzl_CommonSadtpRxRelease(slot);
+        return err;
+    }
+    err = hzl_CommonSadtpRxFinish(slot);
+    HZL_ERR_CHECK(err);
+    // Save the received counter nonce as local one and the reception timestamp.
+    hzl_ServerGroupUpdateCtrnonceAndRxTimestamp(ctx, slot->ctrNonce, rxTimestamp,
+                                                isPreviousSession, gid);
+    hzl_CommonSadtpRxDeliver(unpackedView, slot);
+    // Check if the Session is expired and should be renewed, in order to send the REN message
+    // using the ctrnonce that was already updated after the reception of the SADTP message just
+    // processed.
+    err = hzl_ServerSessionRenewalPhaseEnterIfNeeded(reactionPdu, ctx, rxTimestamp, gid);
+    return err;
+}
+
+hzl_Err_t
+hzl_ServerProcessReceivedSecuredTp(hzl_CbsPduMsg_t* const reactionPdu,
+                                   hzl_RxSduMsg_t* const unpackedMsg,
+                                   hzl_ServerCtx_t* const ctx,
+                                   const uint8_t* const rxPdu,
+                                   const size_t rxPduLen,
+                                   const hzl_Header_t* const unpackedSadtpHeader,
+                                   const hzl_Timestamp_t rxTimestamp)
+{
+    hzl_RxSduView_t unpackedView = {0};
+    const hzl_Err_t err = hzl_ServerProcessReceivedSecuredTpView(
+            reactionPdu, &unpackedView, ctx, rxPdu, rxPduLen, unpackedSadtpHeader, rxTimestamp,
+            sizeof(unpackedMsg->data));
+    unpackedMsg->wasSecured = unpackedView.wasSecured;
+    unpackedMsg->gid = unpackedView.gid;
+    unpackedMsg->sid = unpackedView.sid;
+    if (!unpackedView.isForUser) { return err; }
+    // Longer messages were refused as soon as their ptlen was known.
+    memcpy(unpackedMsg->data, unpackedView.data, unpackedView.dataLen);
+    unpackedMsg->isForUser = true;
+    unpackedMsg->dataLen = unpackedView.dataLen;
+    // The plaintext is not needed in the slot anymore.
+    hzl_CommonSadtpRxReleaseDelivered(ctx->sadtpRxPool);
+    return err;
+}
+
+#endif  /* HZL_SADTP */
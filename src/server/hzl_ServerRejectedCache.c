@@ -0,0 +1,129 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cache of the fingerprints of the SADFD messages recently rejected for an invalid tag,
+ * to reject their exact repetitions without decrypting them.
+ */
+
+#include "hzl.h"
+#include "hzl_Server.h"
+#include "hzl_ServerInternal.h"
+#include <string.h>
+
+#if HZL_SERVER_REJECTED_CACHE_SLOTS > 0
+
+/** @internal Amount of sets of the cache. */
+#define HZL_SERVER_REJECTED_CACHE_SETS \
+    (HZL_SERVER_REJECTED_CACHE_SLOTS / HZL_SERVER_REJECTED_CACHE_WAYS)
+
+/** @internal Odd 64-bit constant multiplied into the fingerprint, 2^64 / golden ratio. */
+#define HZL_SERVER_FINGERPRINT_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+/**
+ * @internal
+ * Fast, non-cryptographic hash of the message, 8 bytes at a time.
+ *
+ * It does not need to resist forgeries: colliding with a rejected message would require
+ * knowing the valid message, its tag included, before it's transmitted.
+ */
+uint64_t
+hzl_ServerRejectedFingerprint(const uint8_t* const pdu,
+                              const size_t pduLen,
+                              const uint64_t keyId)
+{
+    uint64_t hash = (keyId + pduLen) * HZL_SERVER_FINGERPRINT_MULTIPLIER;
+    for (size_t i = 0; i < pduLen; i += sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        const size_t wordLen = pduLen - i < sizeof(uint64_t) ? pduLen - i : sizeof(uint64_t);
+        memcpy(&word, &pdu[i], wordLen);
+        hash = (hash ^ word) * HZL_SERVER_FINGERPRINT_MULTIPLIER;
+        hash ^= hash >> 32U;
+    }
+    return hash | 1U;  // 0 marks the empty slots
+}
+
+void
+hzl_ServerRejectedCacheInit(hzl_ServerCtx_t* const ctx)
+{
+    if (ctx->rejectedCache == NULL) { return; }
+    memset(ctx->rejectedCache, 0, sizeof(hzl_ServerRejectedCache_t));
+}
+
+/** @internal First slot of the set of the fingerprint, chosen by its highest bits, as the
+ * lowest ones also choose the way to evict. */
+inline static uint64_t*
+hzl_ServerRejectedCacheSet(hzl_ServerRejectedCache_t* const cache,
+                           const uint64_t fingerprint)
+{
+    const size_t set = (size_t) (fingerprint >> 32U) % HZL_SERVER_REJECTED_CACHE_SETS;
+    return &cache->fingerprints[set * HZL_SERVER_REJECTED_CACHE_WAYS];
+}
+
+bool
+hzl_ServerRejectedCacheLookup(hzl_ServerCtx_t* const ctx,
+                              const uint64_t fingerprint)
+{
+    hzl_ServerRejectedCache_t* const cache = ctx->rejectedCache;
+    if (cache == NULL) { return false; }
+    const uint64_t* const set = hzl_ServerRejectedCacheSet(cache, fingerprint);
+    for (uint8_t way = 0; way < HZL_SERVER_REJECTED_CACHE_WAYS; way++)
+    {
+        if (set[way] == fingerprint)
+        {
+            cache->hits++;
+            return true;
+        }
+    }
+    cache->misses++;
+    return false;
+}
+
+void
+hzl_ServerRejectedCacheInsert(hzl_ServerCtx_t* const ctx,
+                              const uint64_t fingerprint)
+{
+    hzl_ServerRejectedCache_t* const cache = ctx->rejectedCache;
+    if (cache == NULL) { return; }
+    uint64_t* const set = hzl_ServerRejectedCacheSet(cache, fingerprint);
+    for (uint8_t way = 0; way < HZL_SERVER_REJECTED_CACHE_WAYS; way++)
+    {
+        if (set[way] == 0U)
+        {
+            set[way] = fingerprint;
+            return;
+        }
+    }
+    // Full set: evict a pseudo-random way, without keeping any replacement state
+    set[(fingerprint >> 1U) % HZL_SERVER_REJECTED_CACHE_WAYS] = fingerprint;
+}
+
+#endif
@@ -38,11 +38,35 @@
 #include "hzl_CommonEndian.h"
 #include "hzl_ServerProcessReceived.h"
 
+/** @internal Initialises the Hash function with the constant prefix of every REN message tag
+ * of a renewal phase: `previousStk || label`. */
+inline static void
+hzl_RenHashInitPrefix(hzl_Hash_t* const hash,
+                      const uint8_t* const stk)
+{
+    hzl_HashInit(hash);
+    hzl_HashUpdate(hash, stk, HZL_STK_LEN);
+    hzl_HashUpdate(hash, (uint8_t*) HZL_REN_LABEL, HZL_REN_LABEL_LEN);
+}
+
+/** @internal Feeds the message-specific part of the REN message tag into the Hash function
+ * already holding the prefix: `GID || SID || PTY || ctrnonce`. */
+inline static void
+hzl_RenHashUpdateMsg(hzl_Hash_t* const hash,
+                     const hzl_Header_t* const unpackedRenHeader,
+                     const uint8_t* const encodedCtrnonce)
+{
+    hzl_HashUpdate(hash, &unpackedRenHeader->gid, HZL_GID_LEN);
+    hzl_HashUpdate(hash, &unpackedRenHeader->sid, HZL_SID_LEN);
+    hzl_HashUpdate(hash, &unpackedRenHeader->pty, HZL_PTY_LEN);
+    hzl_HashUpdate(hash, encodedCtrnonce, HZL_REN_CTRNONCE_LEN);
+}
+
 bool
 hzl_ServerSessionRenewalPhaseIsActive(const hzl_ServerCtx_t* const ctx,
                                       const hzl_Gid_t gid)
 {
-    return !hzl_IsAllZeros(ctx->groupStates[gid].previousStk, HZL_STK_LEN);
+    return hzl_ServerGroupHotConst(ctx, gid)->sessionState == HZL_SESSION_STATE_RENEWING;
 }
 
 inline static bool
@@ -50,35 +74,67 @@ hzl_ServerSessionRenewalPhaseIsOver(const hzl_ServerCtx_t* const ctx,
                                     const hzl_Timestamp_t now,
                                     const hzl_Gid_t gid)
 {
-    // The 2 and 6 are multipliers coming strictly from the CBS protocol specification.
+    const hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHotConst(ctx, gid);
+    // Deadlines precomputed by hzl_ServerInit()
     const bool haveEnoughSecuredMessagesBeenUsed =
-            ctx->groupStates[gid].currentCtrNonce >=
-            2U * ctx->groupConfigs[gid].maxCtrnonceDelayMsgs;
+            hot->currentCtrNonce >= hot->renewalPhaseEndCtrNonce;
     const hzl_TimeDeltaMillis_t timeSinceNewSessionStart = hzl_TimeDelta(
-            ctx->groupStates[gid].sessionStartInstant, now);
+            hot->sessionStartInstant, now);
     const bool hasEnoughTimePassedSinceNewSessionStart =
-            timeSinceNewSessionStart >
-            6U * ctx->groupConfigs[gid].delayBetweenRenNotificationsMillis;
+            timeSinceNewSessionStart > hot->renewalPhaseEndMillis;
     return haveEnoughSecuredMessagesBeenUsed || hasEnoughTimePassedSinceNewSessionStart;
 }
 
+hzl_Err_t
+hzl_ServerGroupGenerateNextStk(hzl_ServerCtx_t* const ctx,
+                               const hzl_Gid_t gid)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_ServerGroupState_t* const state = &ctx->groupStates[gid];
+    if (state->nextAeadKey.isExpanded) { return HZL_OK; }
+    err = hzl_NonZeroTrng(state->nextStk, ctx->io.trng, HZL_STK_LEN);
+    if (err == HZL_OK) { hzl_AeadKeyExpand(&state->nextAeadKey, state->nextStk); }
+    else { hzl_ZeroOut(state->nextStk, HZL_STK_LEN); }
+    return err;
+}
+
 hzl_Err_t
 hzl_ServerSessionRenewalPhaseEnter(hzl_ServerCtx_t* const ctx,
                                    const hzl_Gid_t gid)
 {
     HZL_ERR_DECLARE(err);
+    // Normally generated ahead of time: only the fallback calls the TRNG here
+    err = hzl_ServerGroupGenerateNextStk(ctx, gid);
+    HZL_ERR_CHECK(err);
+    hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHot(ctx, gid);
     // Backup previous Session information
     memcpy(ctx->groupStates[gid].previousStk, ctx->groupStates[gid].currentStk, HZL_STK_LEN);
-    ctx->groupStates[gid].previousRxLastMessageInstant =
-            ctx->groupStates[gid].currentRxLastMessageInstant;
-    ctx->groupStates[gid].previousCtrNonce = ctx->groupStates[gid].currentCtrNonce;
-    // Start a new Session: set starting time, new random STK, reset counter nonce
-    err = ctx->io.currentTime(&ctx->groupStates[gid].sessionStartInstant);
-    HZL_ERR_CHECK(err);
-    ctx->groupStates[gid].currentRxLastMessageInstant = ctx->groupStates[gid].sessionStartInstant;
-    err = hzl_NonZeroTrng(ctx->groupStates[gid].currentStk, ctx->io.trng, HZL_STK_LEN);
+    hot->sessionState = HZL_SESSION_STATE_RENEWING;
+    // The expanded current STK becomes the previous one, the new STK is expanded on first use
+    hzl_AeadKeyMove(&ctx->groupStates[gid].previousAeadKey,
+                    &ctx->groupStates[gid].currentAeadKey);
+    hot->previousRxLastMessageInstant = hot->currentRxLastMessageInstant;
+    hot->previousCtrNonce = hot->currentCtrNonce;
+    // All REN messages of this renewal phase are authenticated with the same previousStk
+    hzl_Hash_t hash;
+    hzl_RenHashInitPrefix(&hash, ctx->groupStates[gid].previousStk);
+    hzl_HashSaveMidstate(&ctx->groupStates[gid].renHashMidstate, &hash);
+    hzl_ZeroOut(&hash, sizeof(hash));
+    // Start a new Session: set starting time, next STK, reset counter nonce
+    err = ctx->io.currentTime(&hot->sessionStartInstant);
     HZL_ERR_CHECK(err);
-    ctx->groupStates[gid].currentCtrNonce = 0;
+    hot->currentRxLastMessageInstant = hot->sessionStartInstant;
+    memcpy(ctx->groupStates[gid].currentStk, ctx->groupStates[gid].nextStk, HZL_STK_LEN);
+    hzl_ZeroOut(ctx->groupStates[gid].nextStk, HZL_STK_LEN);
+    hzl_AeadKeyMove(&ctx->groupStates[gid].currentAeadKey, &ctx->groupStates[gid].nextAeadKey);
+    hot->currentCtrNonce = 0;
+    if (ctx->timerWheel != NULL)
+    {
+        hzl_ServerTimerWheel_t* const wheel = ctx->timerWheel;
+        wheel->nextStkToGenerateBitmap[gid / 32U] |= (uint32_t) 1U << (gid % 32U);
+        // Next event: the second REN message of this renewal phase
+        hzl_ServerTimerWheelSchedule(ctx, hot->sessionStartInstant, gid);
+    }
     return err;
 }
 
@@ -90,12 +146,14 @@ hzl_ServerSessionIsExpired(const hzl_ServerCtx_t* const ctx,
                            const hzl_Timestamp_t now,
                            const hzl_Gid_t gid)
 {
+    const hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHotConst(ctx, gid);
+    const hzl_ServerGroupHotConfig_t* const hotConfig = hzl_ServerGroupHotConfig(ctx, gid);
     const bool haveEnoughMessagesBeenSent =
-            ctx->groupStates[gid].currentCtrNonce >= ctx->groupConfigs[gid].ctrNonceUpperLimit;
+            hot->currentCtrNonce >= hotConfig->ctrNonceUpperLimit;
     const hzl_TimeDeltaMillis_t timeSinceSessionStart =
-            hzl_TimeDelta(ctx->groupStates[gid].sessionStartInstant, now);
+            hzl_TimeDelta(hot->sessionStartInstant, now);
     const bool hasEnoughTimePassedSinceStart =
-            timeSinceSessionStart > ctx->groupConfigs[gid].sessionDurationMillis;
+            timeSinceSessionStart > hotConfig->sessionDurationMillis;
     return haveEnoughMessagesBeenSent || hasEnoughTimePassedSinceStart;
 }
 
@@ -104,25 +162,12 @@ hzl_ServerSessionRenewalPhaseExit(hzl_ServerCtx_t* const ctx,
                                   const hzl_Gid_t gid)
 {
     hzl_ZeroOut(ctx->groupStates[gid].previousStk, HZL_STK_LEN);
-    ctx->groupStates[gid].previousRxLastMessageInstant = 0;
-    ctx->groupStates[gid].previousCtrNonce = 0;
-}
-
-inline static void
-hzl_RenHashInit(hzl_Hash_t* const hash,
-                const uint8_t* const ltk,
-                const hzl_Header_t* const unpackedRenHeader,
-                const uint8_t* const encodedCtrnonce)
-{
-    // Authentication/validation of the msg with
-    // tag = hash(LTK || label || GID || SID || PTY || ctrnonce)
-    hzl_HashInit(hash);
-    hzl_HashUpdate(hash, ltk, HZL_LTK_LEN);
-    hzl_HashUpdate(hash, (uint8_t*) HZL_REN_LABEL, HZL_REN_LABEL_LEN);
-    hzl_HashUpdate(hash, &unpackedRenHeader->gid, HZL_GID_LEN);
-    hzl_HashUpdate(hash, &unpackedRenHeader->sid, HZL_SID_LEN);
-    hzl_HashUpdate(hash, &unpackedRenHeader->pty, HZL_PTY_LEN);
-    hzl_HashUpdate(hash, encodedCtrnonce, HZL_REN_CTRNONCE_LEN);
+    hzl_AeadKeyClear(&ctx->groupStates[gid].previousAeadKey);
+    hzl_ZeroOut(&ctx->groupStates[gid].renHashMidstate, sizeof(hzl_HashMidstate_t));
+    hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHot(ctx, gid);
+    hot->sessionState = HZL_SESSION_STATE_ACTIVE;
+    hot->previousRxLastMessageInstant = 0;
+    hot->previousCtrNonce = 0;
 }
 
 hzl_Err_t
@@ -136,20 +181,29 @@ hzl_ServerBuildMsgRenewal(hzl_CbsPduMsg_t* const reactionPdu,
             .sid = HZL_SERVER_SID,
             .pty = HZL_PTY_REN,
     };
-    const uint8_t packedHdrLen = hzl_HeaderLen(ctx->serverConfig->headerType);
-    hzl_HeaderPackFunc const headerPackFunc =
-            hzl_HeaderPackFuncForType(ctx->serverConfig->headerType);
+    const uint8_t packedHdrLen = hzl_HeaderLenInPayload(ctx->serverConfig->headerType,
+                                                        ctx->serverConfig->headerPlacement);
     // Prepare REN Payload
-    // Write the packed header at the beginning of the CAN FD frame's payload.
-    headerPackFunc(reactionPdu->data, &unpackedRenHeader);
+    // Write the packed header at the beginning of the CAN FD frame's payload and/or CAN ID.
+    hzl_HeaderPackPlaced(reactionPdu->data, &reactionPdu->canId, &unpackedRenHeader,
+                         ctx->serverConfig->headerType, ctx->serverConfig->headerPlacement);
     // Write counter nonce after the header
     hzl_EncodeLe24(&reactionPdu->data[packedHdrLen + HZL_REN_CTRNONCE_IDX],
-                   ctx->groupStates[gid].previousCtrNonce);
+                   hzl_ServerGroupHotConst(ctx, gid)->previousCtrNonce);
     // Authenticate the msg with
     // tag = hash(LTK || label || GID || SID || PTY || ctrnonce)
     hzl_Hash_t hash;
-    hzl_RenHashInit(&hash, ctx->groupStates[gid].previousStk, &unpackedRenHeader,
-                    &reactionPdu->data[packedHdrLen + HZL_REN_CTRNONCE_IDX]);
+    if (ctx->groupStates[gid].renHashMidstate.isValid)
+    {
+        // Resume after the constant previousStk || label, absorbed once per renewal phase
+        hzl_HashResumeMidstate(&hash, &ctx->groupStates[gid].renHashMidstate);
+    }
+    else
+    {
+        hzl_RenHashInitPrefix(&hash, ctx->groupStates[gid].previousStk);
+    }
+    hzl_RenHashUpdateMsg(&hash, &unpackedRenHeader,
+                         &reactionPdu->data[packedHdrLen + HZL_REN_CTRNONCE_IDX]);
     hzl_HashDigest(&hash, &reactionPdu->data[packedHdrLen + HZL_REN_TAG_IDX],
                    HZL_REN_TAG_LEN);
     // Message is packed in binary format, ready to transmit
@@ -190,3 +244,83 @@ hzl_ServerSessionRenewalPhaseExitIfNeeded(hzl_ServerCtx_t* const ctx,
         hzl_ServerSessionRenewalPhaseExit(ctx, gid);
     }
 }
+
+bool
+hzl_ServerSessionNextTimeEvent(hzl_Timestamp_t* const eventInstant,
+                               const hzl_ServerCtx_t* const ctx,
+                               const hzl_Timestamp_t now,
+                               const hzl_Gid_t gid)
+{
+    const hzl_ServerGroupHot_t* const hot = hzl_ServerGroupHotConst(ctx, gid);
+    hzl_TimeDeltaMillis_t offsetFromSessionStart;
+    switch (hot->sessionState)
+    {
+        case HZL_SESSION_STATE_ACTIVE:
+        {
+            // First instant at which hzl_ServerSessionIsExpired() is true by time
+            offsetFromSessionStart = hzl_ServerGroupHotConfig(ctx, gid)->sessionDurationMillis + 1U;
+            break;
+        }
+        case HZL_SESSION_STATE_RENEWING:
+        {
+            // Next REN message, paced from the Session start, or the end of the renewal phase
+            const hzl_TimeDeltaMillis_t delay =
+                    ctx->groupConfigs[gid].delayBetweenRenNotificationsMillis;
+            const hzl_TimeDeltaMillis_t elapsed = hzl_TimeDelta(hot->sessionStartInstant, now);
+            const hzl_TimeDeltaMillis_t nextRen = (elapsed / delay + 1U) * delay;
+            const hzl_TimeDeltaMillis_t end = hot->renewalPhaseEndMillis + 1U;
+            offsetFromSessionStart = nextRen < end ? nextRen : end;
+            break;
+        }
+        default:
+        {
+            return false;
+        }
+    }
+    *eventInstant = hot->sessionStartInstant + offsetFromSessionStart;
+    return true;
+}
+
+hzl_Err_t
+hzl_ServerSessionTimeEvent(hzl_CbsPduMsg_t* const renewalPdu,
+                           hzl_ServerCtx_t* const ctx,
+                           const hzl_Timestamp_t now,
+                           const hzl_Gid_t gid)
+{
+    HZL_ERR_DECLARE(err);
+    renewalPdu->dataLen = 0U;
+    if (hzl_ServerSessionRenewalPhaseIsActive(ctx, gid))
+    {
+        if (hzl_ServerSessionRenewalPhaseIsOver(ctx, now, gid))
+        {
+            hzl_ServerSessionRenewalPhaseExit(ctx, gid);
+            err = HZL_OK;
+        }
+        else
+        {
+            err = hzl_ServerBuildMsgRenewal(renewalPdu, ctx, gid);
+        }
+    }
+    else if (hzl_ServerGroupHotConst(ctx, gid)->sessionState == HZL_SESSION_STATE_ACTIVE
+             && hzl_ServerSessionIsExpired(ctx, now, gid))
+    {
+        // Checked before entering, as the new Session has no Requests by definition
+        const bool isAnyClientUsingTheSession = hzl_ServerDidAnyClientAlreadyRequest(ctx, gid);
+        err = hzl_ServerSessionRenewalPhaseEnter(ctx, gid);
+        HZL_ERR_CHECK(err);
+        if (isAnyClientUsingTheSession)
+        {
+            err = hzl_ServerBuildMsgRenewal(renewalPdu, ctx, gid);
+        }
+        else
+        {
+            // No Client can decrypt with the previous Session: skip the renewal phase
+            hzl_ServerSessionRenewalPhaseExit(ctx, gid);
+        }
+    }
+    else
+    {
+        err = HZL_OK;
+    }
+    return err;
+}
@@ -0,0 +1,262 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Implementation of the hzl_ServerTick() function and of the hierarchical timer wheel
+ * scheduling the time-driven Session events of the Groups.
+ */
+
+#include "hzl.h"
+#include "hzl_Server.h"
+#include "hzl_ServerInternal.h"
+
+/** @internal Value of #hzl_ServerTimerWheel_t.slotOfGid for Groups in no slot. */
+#define HZL_SERVER_TIMER_WHEEL_UNSCHEDULED 0xFFFFU
+
+/** @internal Bits of a timestamp covered by each slot of a level. */
+#define HZL_SERVER_TIMER_WHEEL_SLOT_BITS 8U
+
+/** @internal Largest interval hzl_ServerTick() walks through slot by slot. Longer intervals
+ * reschedule all Groups instead. */
+#define HZL_SERVER_TIMER_WHEEL_MAX_WALK_MILLIS 0xFFFFU
+
+/** @internal Appends the Group at the head of the slot list. */
+inline static void
+hzl_TimerWheelLink(hzl_ServerTimerWheel_t* const wheel,
+                   const uint8_t level,
+                   const uint8_t slot,
+                   const hzl_Gid_t gid)
+{
+    const uint8_t head = wheel->slotHeads[level][slot];
+    wheel->nextInSlot[gid] = head;
+    wheel->previousInSlot[gid] = 0U;
+    if (head != 0U) { wheel->previousInSlot[head - 1U] = (uint8_t) (gid + 1U); }
+    wheel->slotHeads[level][slot] = (uint8_t) (gid + 1U);
+    wheel->slotOfGid[gid] = (uint16_t) (level * HZL_SERVER_TIMER_WHEEL_SLOTS + slot);
+}
+
+/** @internal Removes the Group from its slot list, if in any. */
+inline static void
+hzl_TimerWheelUnlink(hzl_ServerTimerWheel_t* const wheel,
+                     const hzl_Gid_t gid)
+{
+    const uint16_t slotOfGid = wheel->slotOfGid[gid];
+    if (slotOfGid == HZL_SERVER_TIMER_WHEEL_UNSCHEDULED) { return; }
+    const uint8_t next = wheel->nextInSlot[gid];
+    const uint8_t previous = wheel->previousInSlot[gid];
+    if (previous != 0U)
+    {
+        wheel->nextInSlot[previous - 1U] = next;
+    }
+    else
+    {
+        wheel->slotHeads[slotOfGid / HZL_SERVER_TIMER_WHEEL_SLOTS]
+                        [slotOfGid % HZL_SERVER_TIMER_WHEEL_SLOTS] = next;
+    }
+    if (next != 0U) { wheel->previousInSlot[next - 1U] = previous; }
+    wheel->slotOfGid[gid] = HZL_SERVER_TIMER_WHEEL_UNSCHEDULED;
+}
+
+/** @internal Places the unlinked Group in the slot of its deadline, relative to the first
+ * instant not processed yet. Deadlines at or before that instant are due at it. */
+static void
+hzl_TimerWheelInsert(hzl_ServerTimerWheel_t* const wheel,
+                     const hzl_Gid_t gid)
+{
+    const hzl_Timestamp_t deadline = wheel->deadlines[gid];
+    const hzl_TimeDeltaMillis_t delta = hzl_TimeDelta(wheel->nextTickInstant, deadline);
+    if (delta == 0U || delta > INT32_MAX)
+    {
+        hzl_TimerWheelLink(wheel, 0U, (uint8_t) wheel->nextTickInstant, gid);
+        return;
+    }
+    uint8_t level = 0U;
+    while (level < HZL_SERVER_TIMER_WHEEL_LEVELS - 1U
+           && (delta >> (HZL_SERVER_TIMER_WHEEL_SLOT_BITS * (level + 1U))) != 0U)
+    {
+        level++;
+    }
+    hzl_TimerWheelLink(wheel, level,
+                       (uint8_t) (deadline >> (HZL_SERVER_TIMER_WHEEL_SLOT_BITS * level)), gid);
+}
+
+/** @internal Moves the Groups of the level's slot starting at the given instant into the
+ * finer levels. */
+static void
+hzl_TimerWheelCascade(hzl_ServerTimerWheel_t* const wheel,
+                      const uint8_t level,
+                      const hzl_Timestamp_t instant)
+{
+    const uint8_t slot = (uint8_t) (instant >> (HZL_SERVER_TIMER_WHEEL_SLOT_BITS * level));
+    uint8_t current = wheel->slotHeads[level][slot];
+    wheel->slotHeads[level][slot] = 0U;
+    while (current != 0U)
+    {
+        const hzl_Gid_t gid = (hzl_Gid_t) (current - 1U);
+        current = wheel->nextInSlot[gid];
+        wheel->slotOfGid[gid] = HZL_SERVER_TIMER_WHEEL_UNSCHEDULED;
+        hzl_TimerWheelInsert(wheel, gid);
+    }
+}
+
+void
+hzl_ServerTimerWheelSchedule(hzl_ServerCtx_t* const ctx,
+                             const hzl_Timestamp_t now,
+                             const hzl_Gid_t gid)
+{
+    hzl_ServerTimerWheel_t* const wheel = ctx->timerWheel;
+    hzl_TimerWheelUnlink(wheel, gid);
+    if (hzl_ServerSessionNextTimeEvent(&wheel->deadlines[gid], ctx, now, gid))
+    {
+        hzl_TimerWheelInsert(wheel, gid);
+    }
+}
+
+void
+hzl_ServerTimerWheelInit(hzl_ServerCtx_t* const ctx,
+                         const hzl_Timestamp_t now)
+{
+    hzl_ServerTimerWheel_t* const wheel = ctx->timerWheel;
+    memset(wheel->slotHeads, 0, sizeof(wheel->slotHeads));
+    memset(wheel->slotOfGid, 0xFF, sizeof(wheel->slotOfGid));
+    wheel->nextTickInstant = now;
+    for (hzl_Gid_t gid = 0; gid < ctx->serverConfig->amountOfGroups; gid++)
+    {
+        hzl_ServerTimerWheelSchedule(ctx, now, gid);
+    }
+}
+
+/** @internal Handles the events of all Groups due up to \p now, walking the level 0 slots
+ * one instant at a time. */
+static hzl_Err_t
+hzl_TimerWheelAdvance(hzl_CbsPduMsg_t* const renewalPdus,
+                      size_t* const amountOfRenewalPdus,
+                      hzl_ServerCtx_t* const ctx,
+                      const size_t capacity,
+                      const hzl_Timestamp_t now)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_ServerTimerWheel_t* const wheel = ctx->timerWheel;
+    const hzl_TimeDeltaMillis_t toWalk = hzl_TimeDelta(wheel->nextTickInstant, now);
+    if (toWalk > INT32_MAX)
+    {
+        return HZL_OK;  // Instant already processed
+    }
+    if (toWalk > HZL_SERVER_TIMER_WHEEL_MAX_WALK_MILLIS)
+    {
+        // Cheaper than walking through all the slots since the previous call
+        hzl_ServerTimerWheelInit(ctx, now);
+    }
+    while (hzl_TimeDelta(wheel->nextTickInstant, now) <= INT32_MAX)
+    {
+        const hzl_Timestamp_t instant = wheel->nextTickInstant;
+        // Coarser levels first, so their Groups can reach the level 0 slot of this instant.
+        // Repeating a cascade on a resumed instant finds the slots empty.
+        for (uint8_t level = HZL_SERVER_TIMER_WHEEL_LEVELS - 1U; level > 0U; level--)
+        {
+            const hzl_Timestamp_t levelMask = (hzl_Timestamp_t) (
+                    ((hzl_Timestamp_t) 1U << (HZL_SERVER_TIMER_WHEEL_SLOT_BITS * level)) - 1U);
+            if ((instant & levelMask) == 0U) { hzl_TimerWheelCascade(wheel, level, instant); }
+        }
+        const uint8_t slot = (uint8_t) instant;
+        while (wheel->slotHeads[0][slot] != 0U)
+        {
+            const hzl_Gid_t gid = (hzl_Gid_t) (wheel->slotHeads[0][slot] - 1U);
+            if (hzl_TimeDelta(instant, wheel->deadlines[gid]) - 1U < INT32_MAX)
+            {
+                // Not due yet: move it to the slot of its deadline
+                hzl_TimerWheelUnlink(wheel, gid);
+                hzl_TimerWheelInsert(wheel, gid);
+                continue;
+            }
+            if (*amountOfRenewalPdus == capacity)
+            {
+                return HZL_OK;  // Resumed from this instant on the next call
+            }
+            hzl_TimerWheelUnlink(wheel, gid);
+            err = hzl_ServerSessionTimeEvent(&renewalPdus[*amountOfRenewalPdus], ctx, now, gid);
+            if (err != HZL_OK)
+            {
+                // Retry on the next call
+                hzl_TimerWheelInsert(wheel, gid);
+                return err;
+            }
+            if (renewalPdus[*amountOfRenewalPdus].dataLen != 0U) { (*amountOfRenewalPdus)++; }
+            hzl_ServerTimerWheelSchedule(ctx, now, gid);
+            if (wheel->slotOfGid[gid] == (uint16_t) slot)
+            {
+                // Not rescheduled after now, e.g. Session expired by counter nonce only
+                hzl_TimerWheelUnlink(wheel, gid);
+                wheel->deadlines[gid] = now + 1U;
+                hzl_TimerWheelInsert(wheel, gid);
+            }
+        }
+        wheel->nextTickInstant = instant + 1U;
+    }
+    return HZL_OK;
+}
+
+/** @internal Generates the next STK of the Groups that used theirs since the previous call. */
+static hzl_Err_t
+hzl_TimerWheelGenerateNextStks(hzl_ServerCtx_t* const ctx)
+{
+    HZL_ERR_DECLARE(err);
+    uint32_t* const bitmap = ctx->timerWheel->nextStkToGenerateBitmap;
+    for (size_t word = 0U; word < HZL_MAX_GIDS / 32U; word++)
+    {
+        for (uint8_t bit = 0U; bitmap[word] != 0U; bit++)
+        {
+            if ((bitmap[word] & ((uint32_t) 1U << bit)) == 0U) { continue; }
+            err = hzl_ServerGroupGenerateNextStk(ctx, (hzl_Gid_t) (word * 32U + bit));
+            HZL_ERR_CHECK(err);  // Retried on the next call
+            bitmap[word] &= ~((uint32_t) 1U << bit);
+        }
+    }
+    return HZL_OK;
+}
+
+HZL_API hzl_Err_t
+hzl_ServerTick(hzl_CbsPduMsg_t* const renewalPdus,
+               size_t* const amountOfRenewalPdus,
+               hzl_ServerCtx_t* const ctx,
+               const size_t capacity,
+               const hzl_Timestamp_t now)
+{
+    if (amountOfRenewalPdus == NULL) { return HZL_ERR_NULL_PDU; }
+    *amountOfRenewalPdus = 0U;  // Make output empty in case of later error.
+    if (renewalPdus == NULL && capacity > 0U) { return HZL_ERR_NULL_PDU; }
+    HZL_ERR_DECLARE(err);
+    err = hzl_ServerCheckCtxPointers(ctx);
+    HZL_ERR_CHECK(err);
+    if (ctx->timerWheel == NULL) { return HZL_ERR_NULL_TIMER_WHEEL; }
+    err = hzl_TimerWheelAdvance(renewalPdus, amountOfRenewalPdus, ctx, capacity, now);
+    HZL_ERR_CHECK(err);
+    return hzl_TimerWheelGenerateNextStks(ctx);
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Common includes and definitions used across the benchmarks.
+ *
+ * The benchmarks emulate a bus with instantaneous transmission, as the interop tests do,
+ * and measure the time spent by the library alone. They are not part of the test suite,
+ * as their results depend on the machine.
+ */
+
+#ifndef HZL_BENCH_H_
+#define HZL_BENCH_H_
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include "hzl.h"
+#include "hzl_Client.h"
+#include "hzl_ClientOs.h"
+#include "hzl_Server.h"
+#include "hzl_ServerOs.h"
+#include "hzl_CommonInternal.h"
+#include <stdio.h>
+#include <time.h>
+
+/** CAN ID used by all benchmark messages. */
+#define HZL_BENCH_CAN_ID 0x123U
+/** Group the benchmarks communicate in: Server, Alice and Bob. */
+#define HZL_BENCH_GID 3U
+
+/** Server and one Client with an established Session, connected by an ideal bus. */
+typedef struct hzlBench_Bus
+{
+    hzl_ServerCtx_t* server;
+    hzl_ClientCtx_t* alice;
+} hzlBench_Bus_t;
+
+/**
+ * Loads the Server and Alice from the test configuration files and performs the handshake
+ * in the #HZL_BENCH_GID Group.
+ */
+hzl_Err_t
+hzlBench_BusInit(hzlBench_Bus_t* bus);
+
+/** Frees the parties on the bus. */
+void
+hzlBench_BusTeardown(hzlBench_Bus_t* bus);
+
+/**
+ * Delivers a message the Server generated as reaction (e.g. a REN) to Alice and keeps
+ * ping-ponging the reactions until nobody has anything more to say.
+ */
+hzl_Err_t
+hzlBench_BusDeliverServerReaction(hzlBench_Bus_t* bus,
+                                  const hzl_CbsPduMsg_t* reaction);
+
+/** Monotonic timestamp in nanoseconds since an unspecified point in time. */
+uint64_t
+hzlBench_NowNanos(void);
+
+/**
+ * Reading of the CPU timestamp counter, to compute cycles per byte.
+ *
+ * Available on x86 only (`rdtsc`), where it counts at the nominal frequency of the CPU,
+ * so frequency scaling makes it diverge from the actual core cycles: disable turbo-boost
+ * for accurate results. Always zero on other architectures.
+ */
+uint64_t
+hzlBench_NowCycles(void);
+
+/**
+ * Prints the average cost of one frame and the CPU load it implies at a few
+ * typical bus loads: 1k, 10k and 100k frames per second.
+ */
+void
+hzlBench_ReportFrameCost(const char* label,
+                         double nanosPerFrame);
+
+// Benchmark running functions.
+int hzlBench_AeadKeyCache(void);
+int hzlBench_AeadBackend(void);
+int hzlBench_ProcessReceivedBatch(void);
+int hzlBench_TrngResponse(void);
+int hzlBench_ClientGroupLookup(void);
+int hzlBench_ServerGroupState(void);
+int hzlBench_ServerTick(void);
+int hzlBench_RenewalLatency(void);
+int hzlBench_DosFlood(void);
+int hzlBench_RejectedCache(void);
+int hzlBench_OutputClearing(void);
+int hzlBench_ContextStartup(void);
+int hzlBench_HeaderTypes(void);
+int hzlBench_CanFilters(void);
+int hzlBench_CtrDelay(void);
+int hzlBench_SadtpThroughput(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  /* HZL_BENCH_H_ */
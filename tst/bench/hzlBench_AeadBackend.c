@@ -0,0 +1,184 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cost of the AEAD backend the library was built with (see the CMake option
+ * `HZL_AEAD_BACKEND`) on SDUs of typical CAN FD sizes.
+ *
+ * Two measurements per SDU size:
+ * - the AEAD alone, en- and decrypting with the SADFD nonce and associated data and a
+ *   cached expanded key, reported also in cycles per byte of SDU;
+ * - a whole SADFD message, built by a Client and processed by the Server, when the SDU
+ *   fits into one.
+ *
+ * To compare the backends, run the `bench_hzl_aead_backends` target, which builds and runs
+ * this benchmark once per backend.
+ */
+
+#include "hzlBench.h"
+#include "hzl_CommonAead.h"
+#include "hzl_CommonHeader.h"
+#include "hzl_CommonMessage.h"
+#include "hzl_CommonPayload.h"
+
+#define HZL_BENCH_AEAD_BACKEND_FRAMES 100000U
+#define HZL_BENCH_AEAD_BACKEND_MAX_SDU_LEN 48U
+
+/** Largest SDU fitting into a SADFD message with the Server's header type. */
+#define HZL_BENCH_AEAD_BACKEND_MAX_SADFD_SDU_LEN(headerType) \
+    (HZL_MAX_CAN_FD_DATA_LEN - hzl_HeaderLen(headerType) - HZL_SADFD_METADATA_IN_PAYLOAD_LEN)
+
+static const size_t hzlBench_AeadBackendSduLens[] = {8, 16, 32, 48};
+
+static void
+hzlBench_AeadBackendReport(const char* const label,
+                           const size_t sduLen,
+                           const uint64_t elapsedNanos,
+                           const uint64_t elapsedCycles)
+{
+    const double nanosPerFrame = (double) elapsedNanos / HZL_BENCH_AEAD_BACKEND_FRAMES;
+    printf("  %-24s %2zu B: %8.1f ns/frame | %10.0f frames/s | ",
+           label, sduLen, nanosPerFrame, 1e9 / nanosPerFrame);
+    if (elapsedCycles == 0)
+    {
+        printf("cycles/byte n/a\n");
+    }
+    else
+    {
+        printf("%7.1f cycles/byte\n",
+               (double) elapsedCycles / HZL_BENCH_AEAD_BACKEND_FRAMES / (double) sduLen);
+    }
+}
+
+static hzl_Err_t
+hzlBench_AeadBackendCipherOnly(const size_t sduLen)
+{
+    const uint8_t stk[HZL_STK_LEN] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    const hzl_Header_t header = {.gid = HZL_BENCH_GID, .sid = 1U, .pty = HZL_PTY_SADFD};
+    uint8_t plaintext[HZL_BENCH_AEAD_BACKEND_MAX_SDU_LEN] = {0};
+    uint8_t ciphertext[HZL_BENCH_AEAD_BACKEND_MAX_SDU_LEN];
+    uint8_t tag[HZL_SADFD_TAG_LEN];
+    hzl_AeadKey_t key = {0};
+    hzl_Aead_t aead;
+    uint64_t encNanos = 0;
+    uint64_t encCycles = 0;
+    uint64_t decNanos = 0;
+    uint64_t decCycles = 0;
+    hzl_Err_t err = HZL_OK;
+
+    hzl_AeadKeyExpand(&key, stk);
+    for (hzl_CtrNonce_t ctr = 0; ctr < HZL_BENCH_AEAD_BACKEND_FRAMES && err == HZL_OK; ctr++)
+    {
+        uint64_t startNanos = hzlBench_NowNanos();
+        uint64_t startCycles = hzlBench_NowCycles();
+        hzl_CommonAeadInitSadfd(&aead, &key, &header, ctr, (uint8_t) sduLen);
+        hzl_AeadEncrypt(&aead, ciphertext, plaintext, sduLen, tag, HZL_SADFD_TAG_LEN);
+        encCycles += hzlBench_NowCycles() - startCycles;
+        encNanos += hzlBench_NowNanos() - startNanos;
+
+        startNanos = hzlBench_NowNanos();
+        startCycles = hzlBench_NowCycles();
+        hzl_CommonAeadInitSadfd(&aead, &key, &header, ctr, (uint8_t) sduLen);
+        err = hzl_AeadDecrypt(&aead, plaintext, ciphertext, sduLen, tag, HZL_SADFD_TAG_LEN);
+        decCycles += hzlBench_NowCycles() - startCycles;
+        decNanos += hzlBench_NowNanos() - startNanos;
+    }
+    hzl_AeadKeyClear(&key);
+    hzlBench_AeadBackendReport("AEAD encrypt", sduLen, encNanos, encCycles);
+    hzlBench_AeadBackendReport("AEAD decrypt", sduLen, decNanos, decCycles);
+    return err;
+}
+
+static hzl_Err_t
+hzlBench_AeadBackendSadfd(const size_t sduLen)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_Bus_t bus = {0};
+    hzl_CbsPduMsg_t sadfd;
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduMsg_t sdu;
+    const uint8_t sadData[HZL_BENCH_AEAD_BACKEND_MAX_SDU_LEN] = {0};
+    uint64_t buildNanos = 0;
+    uint64_t buildCycles = 0;
+    uint64_t processNanos = 0;
+    uint64_t processCycles = 0;
+
+    err = hzlBench_BusInit(&bus);
+    HZL_ERR_CLEANUP(err);
+    if (sduLen > HZL_BENCH_AEAD_BACKEND_MAX_SADFD_SDU_LEN(bus.server->serverConfig->headerType))
+    {
+        printf("  %-24s %2zu B: does not fit into a SADFD message\n", "SADFD build/process",
+               sduLen);
+        goto cleanup;
+    }
+    for (size_t i = 0; i < HZL_BENCH_AEAD_BACKEND_FRAMES; i++)
+    {
+        uint64_t startNanos = hzlBench_NowNanos();
+        uint64_t startCycles = hzlBench_NowCycles();
+        err = hzl_ClientBuildSecuredFd(&sadfd, bus.alice, sadData, sduLen, HZL_BENCH_GID);
+        buildCycles += hzlBench_NowCycles() - startCycles;
+        buildNanos += hzlBench_NowNanos() - startNanos;
+        HZL_ERR_CLEANUP(err);
+
+        startNanos = hzlBench_NowNanos();
+        startCycles = hzlBench_NowCycles();
+        err = hzl_ServerProcessReceived(&reaction, &sdu, bus.server, sadfd.data, sadfd.dataLen,
+                                        HZL_BENCH_CAN_ID);
+        processCycles += hzlBench_NowCycles() - startCycles;
+        processNanos += hzlBench_NowNanos() - startNanos;
+        HZL_ERR_CLEANUP(err);
+        // Session renewals are part of the traffic, but not of the measured SADFD cost
+        err = hzlBench_BusDeliverServerReaction(&bus, &reaction);
+        HZL_ERR_CLEANUP(err);
+    }
+    hzlBench_AeadBackendReport("SADFD Client build", sduLen, buildNanos, buildCycles);
+    hzlBench_AeadBackendReport("SADFD Server process", sduLen, processNanos, processCycles);
+cleanup:
+    hzlBench_BusTeardown(&bus);
+    return err;
+}
+
+int
+hzlBench_AeadBackend(void)
+{
+    HZL_ERR_DECLARE(err);
+
+    printf("AEAD backend %s:\n", HZL_AEAD_BACKEND_NAME);
+    for (size_t i = 0; i < sizeof(hzlBench_AeadBackendSduLens) / sizeof(size_t); i++)
+    {
+        err = hzlBench_AeadBackendCipherOnly(hzlBench_AeadBackendSduLens[i]);
+        HZL_ERR_CLEANUP(err);
+        err = hzlBench_AeadBackendSadfd(hzlBench_AeadBackendSduLens[i]);
+        HZL_ERR_CLEANUP(err);
+    }
+cleanup:
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cost of a SADFD message, built by a Client and processed by the Server, with and without
+ * caching the expanded STK across messages.
+ *
+ * The uncached run clears the key caches before every message, forcing the key schedule
+ * and GHASH tables to be recomputed on both sides, as it happened before the caching.
+ */
+
+#include "hzlBench.h"
+#include "hzl_CommonAead.h"
+
+#define HZL_BENCH_AEAD_KEY_CACHE_FRAMES 100000U
+#define HZL_BENCH_AEAD_KEY_CACHE_SDU_LEN 8U
+
+static void
+hzlBench_AeadKeyCacheForget(const hzlBench_Bus_t* const bus)
+{
+    hzl_AeadKeyClear(&bus->server->groupStates[HZL_BENCH_GID].currentAeadKey);
+    hzl_AeadKeyClear(&bus->server->groupStates[HZL_BENCH_GID].previousAeadKey);
+    for (size_t i = 0; i < bus->alice->clientConfig->amountOfGroups; i++)
+    {
+        hzl_AeadKeyClear(&bus->alice->groupStates[i].currentAeadKey);
+        hzl_AeadKeyClear(&bus->alice->groupStates[i].previousAeadKey);
+    }
+}
+
+static hzl_Err_t
+hzlBench_AeadKeyCacheRun(double* const nanosPerFrame,
+                         const bool forgetKeys)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_Bus_t bus = {0};
+    hzl_CbsPduMsg_t sadfd;
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduMsg_t sdu;
+    const uint8_t sadData[HZL_BENCH_AEAD_KEY_CACHE_SDU_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint64_t elapsedNanos = 0;
+
+    err = hzlBench_BusInit(&bus);
+    HZL_ERR_CLEANUP(err);
+    for (size_t i = 0; i < HZL_BENCH_AEAD_KEY_CACHE_FRAMES; i++)
+    {
+        if (forgetKeys) { hzlBench_AeadKeyCacheForget(&bus); }
+        const uint64_t start = hzlBench_NowNanos();
+        err = hzl_ClientBuildSecuredFd(&sadfd, bus.alice, sadData, sizeof(sadData),
+                                       HZL_BENCH_GID);
+        HZL_ERR_CLEANUP(err);
+        err = hzl_ServerProcessReceived(&reaction, &sdu, bus.server, sadfd.data, sadfd.dataLen,
+                                        HZL_BENCH_CAN_ID);
+        HZL_ERR_CLEANUP(err);
+        elapsedNanos += hzlBench_NowNanos() - start;
+        // Session renewals are part of the traffic, but not of the measured SADFD cost
+        err = hzlBench_BusDeliverServerReaction(&bus, &reaction);
+        HZL_ERR_CLEANUP(err);
+    }
+    *nanosPerFrame = (double) elapsedNanos / HZL_BENCH_AEAD_KEY_CACHE_FRAMES;
+cleanup:
+    hzlBench_BusTeardown(&bus);
+    return err;
+}
+
+int
+hzlBench_AeadKeyCache(void)
+{
+    HZL_ERR_DECLARE(err);
+    double uncachedNanos = 0;
+    double cachedNanos = 0;
+
+    err = hzlBench_AeadKeyCacheRun(&uncachedNanos, true);
+    HZL_ERR_CLEANUP(err);
+    err = hzlBench_AeadKeyCacheRun(&cachedNanos, false);
+    HZL_ERR_CLEANUP(err);
+    printf("SADFD %u B, Client build + Server process:\n", HZL_BENCH_AEAD_KEY_CACHE_SDU_LEN);
+    hzlBench_ReportFrameCost("  re-keying every frame (before)", uncachedNanos);
+    hzlBench_ReportFrameCost("  cached STK key schedule (after)", cachedNanos);
+    printf("  speedup: %.2fx\n", uncachedNanos / cachedNanos);
+cleanup:
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
@@ -0,0 +1,283 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * CPU usage of a Client receiving from a `vcan` interface loaded at 90%, with and without
+ * the acceptance filters of hzl_ClientBuildCanFilters() set on its socket.
+ *
+ * A sender thread transmits UAD frames with the header in the CAN ID, round-robin over
+ * #HZL_BENCH_CAN_FILTERS_BUS_GROUPS Groups, paced as a real CAN FD bus at 90% load would be.
+ * Alice receives them on her own `CAN_RAW` socket and processes each one, as ICSim does.
+ * Without filters, every frame crosses into userspace just to be ignored by the library.
+ *
+ * Linux only. Requires the interface to exist and be up, e.g. with `ICSim/setup_vcan.sh`:
+ * otherwise the benchmark is skipped. On `vcan` the kernel-side filtering runs in the
+ * sender's context, thus the CPU usage of the whole process is reported alongside the
+ * receiver's.
+ */
+
+// For clock_nanosleep() and RUSAGE_THREAD also when compiling with a strict -std=c11.
+// Must be defined before any inclusion.
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include "hzlBench.h"
+#include "hzl_CommonHeader.h"
+#include "hzl_CommonMessage.h"
+
+#if HZL_OS_AVAILABLE_LINUX
+
+#include <linux/can/raw.h>
+#include <net/if.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/** CAN interface to transmit and receive on. */
+#define HZL_BENCH_CAN_FILTERS_IFNAME "vcan0"
+/** Duration of each run. */
+#define HZL_BENCH_CAN_FILTERS_SECONDS 5U
+/**
+ * Duration of a 64 B CAN FD frame with a 29-bit CAN ID at 500 kbit/s nominal and
+ * 2 Mbit/s data bit rate: about 49 nominal bits and 550 data bits, stuffing included.
+ */
+#define HZL_BENCH_CAN_FILTERS_FRAME_NANOS (49U * 2000U + 550U * 500U)
+/** Bus load in percent. */
+#define HZL_BENCH_CAN_FILTERS_BUS_LOAD 90U
+/** Interval between two transmitted frames to load the bus as configured. */
+#define HZL_BENCH_CAN_FILTERS_INTERVAL_NANOS \
+    (HZL_BENCH_CAN_FILTERS_FRAME_NANOS * 100U / HZL_BENCH_CAN_FILTERS_BUS_LOAD)
+/** Amount of Groups the bus traffic is spread over, GIDs 0 to 15. */
+#define HZL_BENCH_CAN_FILTERS_BUS_GROUPS 16U
+/** How long the receiver waits for a frame before checking if the sender is done. */
+#define HZL_BENCH_CAN_FILTERS_RX_TIMEOUT_MICROS 100000
+
+/** Alice's context with the header in the CAN ID, sharing her Group arrays. */
+typedef struct hzlBench_CanFiltersClient
+{
+    hzl_ClientCtx_t ctx;
+    hzl_ClientConfig_t clientConfig;
+} hzlBench_CanFiltersClient_t;
+
+/** Sender thread state. */
+typedef struct hzlBench_CanFiltersSender
+{
+    int socket;
+    uint8_t headerType;
+    atomic_bool isDone;
+    hzl_Err_t err;
+    size_t sentFrames;
+} hzlBench_CanFiltersSender_t;
+
+/** Opens a `CAN_RAW` socket with CAN FD frames enabled, bound to the interface. */
+static int
+hzlBench_CanFiltersOpenSocket(void)
+{
+    const int s = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (s < 0) { return -1; }
+    const int canFdOn = 1;
+    struct sockaddr_can addr = {
+            .can_family = AF_CAN,
+            .can_ifindex = (int) if_nametoindex(HZL_BENCH_CAN_FILTERS_IFNAME),
+    };
+    if (addr.can_ifindex == 0
+        || setsockopt(s, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &canFdOn, sizeof(canFdOn)) != 0
+        || bind(s, (struct sockaddr*) &addr, sizeof(addr)) != 0)
+    {
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+static uint64_t
+hzlBench_CanFiltersCpuNanos(const int who)
+{
+    struct rusage usage;
+    getrusage(who, &usage);
+    return (uint64_t) (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000ULL
+           + (uint64_t) (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ULL;
+}
+
+/** Transmits UAD frames to all Groups in turn at the configured pace, then stops. */
+static void*
+hzlBench_CanFiltersSend(void* const arg)
+{
+    hzlBench_CanFiltersSender_t* const sender = arg;
+    const uint8_t sdu[HZL_MAX_CAN_FD_DATA_LEN] = {0};
+    const uint64_t frames = HZL_BENCH_CAN_FILTERS_SECONDS * 1000000000ULL
+                            / HZL_BENCH_CAN_FILTERS_INTERVAL_NANOS;
+    struct timespec next;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    sender->err = HZL_OK;
+    for (uint64_t i = 0; i < frames && sender->err == HZL_OK; i++)
+    {
+        hzl_CbsPduMsg_t uad;
+        sender->err = hzl_CommonBuildUnsecured(
+                &uad, sdu, sizeof(sdu), (hzl_Gid_t) (i % HZL_BENCH_CAN_FILTERS_BUS_GROUPS),
+                HZL_SERVER_SID, sender->headerType, HZL_HEADER_IN_CAN_ID);
+        struct canfd_frame frame = {
+                .can_id = uad.canId | CAN_EFF_FLAG,
+                .len = (uint8_t) uad.dataLen,
+        };
+        memcpy(frame.data, uad.data, uad.dataLen);
+        next.tv_nsec += HZL_BENCH_CAN_FILTERS_INTERVAL_NANOS;
+        if (next.tv_nsec >= 1000000000L)
+        {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+        // Counted only when the interface accepts it
+        if (write(sender->socket, &frame, sizeof(frame)) == sizeof(frame))
+        {
+            sender->sentFrames++;
+        }
+    }
+    atomic_store(&sender->isDone, true);
+    return NULL;
+}
+
+/** Receives and processes frames until the sender is done, with or without filters. */
+static hzl_Err_t
+hzlBench_CanFiltersRun(hzlBench_CanFiltersClient_t* const alice,
+                       const bool useFilters)
+{
+    HZL_ERR_DECLARE(err);
+    struct can_filter filters[UINT8_MAX];
+    size_t amountOfFilters = 0;
+    size_t receivedFrames = 0;
+    size_t framesForAlice = 0;
+    hzlBench_CanFiltersSender_t sender = {.headerType = alice->clientConfig.headerType};
+    const int rxSocket = hzlBench_CanFiltersOpenSocket();
+    sender.socket = hzlBench_CanFiltersOpenSocket();
+    if (rxSocket < 0 || sender.socket < 0) { err = HZL_ERR_PROGRAMMING; goto cleanup; }
+    const struct timeval rxTimeout = {.tv_usec = HZL_BENCH_CAN_FILTERS_RX_TIMEOUT_MICROS};
+    setsockopt(rxSocket, SOL_SOCKET, SO_RCVTIMEO, &rxTimeout, sizeof(rxTimeout));
+    if (useFilters)
+    {
+        err = hzl_ClientBuildCanFilters(filters, &amountOfFilters, UINT8_MAX, &alice->ctx);
+        HZL_ERR_CLEANUP(err);
+        setsockopt(rxSocket, SOL_CAN_RAW, CAN_RAW_FILTER, filters,
+                   (socklen_t) (amountOfFilters * sizeof(struct can_filter)));
+    }
+    pthread_t senderThread;
+    const uint64_t startNanos = hzlBench_NowNanos();
+    const uint64_t startRxCpu = hzlBench_CanFiltersCpuNanos(RUSAGE_THREAD);
+    const uint64_t startProcessCpu = hzlBench_CanFiltersCpuNanos(RUSAGE_SELF);
+    if (pthread_create(&senderThread, NULL, hzlBench_CanFiltersSend, &sender) != 0)
+    {
+        err = HZL_ERR_PROGRAMMING;
+        goto cleanup;
+    }
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduMsg_t sdu;
+    err = HZL_OK;
+    while (!atomic_load(&sender.isDone) && err == HZL_OK)
+    {
+        struct canfd_frame frame;
+        if (read(rxSocket, &frame, sizeof(frame)) <= 0) { continue; }  // Timeout
+        receivedFrames++;
+        err = hzl_ClientProcessReceived(&reaction, &sdu, &alice->ctx, frame.data, frame.len,
+                                        frame.can_id & CAN_EFF_MASK);
+        if (err == HZL_OK && sdu.isForUser) { framesForAlice++; }
+        else if (err == HZL_ERR_MSG_IGNORED) { err = HZL_OK; }
+    }
+    pthread_join(senderThread, NULL);
+    const double seconds = (double) (hzlBench_NowNanos() - startNanos) / 1e9;
+    const double rxCpu = (double) (hzlBench_CanFiltersCpuNanos(RUSAGE_THREAD) - startRxCpu)
+                         / 1e9;
+    const double processCpu =
+            (double) (hzlBench_CanFiltersCpuNanos(RUSAGE_SELF) - startProcessCpu) / 1e9;
+    HZL_ERR_CLEANUP(err);
+    err = sender.err;
+    HZL_ERR_CLEANUP(err);
+    printf("%s: %zu filters\n", useFilters ? "With filters" : "Without filters",
+           amountOfFilters);
+    printf("%-40s %10.0f frames/s\n", "  sent on the bus", (double) sender.sentFrames / seconds);
+    printf("%-40s %10.0f frames/s\n", "  received in userspace",
+           (double) receivedFrames / seconds);
+    printf("%-40s %10.0f frames/s\n", "  for Alice", (double) framesForAlice / seconds);
+    printf("%-40s %10.2f %%\n", "  CPU usage, receiver thread", 100.0 * rxCpu / seconds);
+    printf("%-40s %10.2f %%\n", "  CPU usage, whole process", 100.0 * processCpu / seconds);
+cleanup:
+    if (rxSocket >= 0) { close(rxSocket); }
+    if (sender.socket >= 0) { close(sender.socket); }
+    return err;
+}
+
+int
+hzlBench_CanFilters(void)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_ClientCtx_t* aliceFromFile = NULL;
+    hzlBench_CanFiltersClient_t alice;
+
+    const int probe = hzlBench_CanFiltersOpenSocket();
+    if (probe < 0)
+    {
+        printf("Skip | %s: cannot open %s\n", __func__, HZL_BENCH_CAN_FILTERS_IFNAME);
+        return 0;
+    }
+    close(probe);
+    err = hzl_ClientNew(&aliceFromFile, "clientconfigfiles/Alice.hzl");
+    HZL_ERR_CLEANUP(err);
+    alice.ctx = *aliceFromFile;
+    alice.clientConfig = *aliceFromFile->clientConfig;
+    alice.clientConfig.headerPlacement = HZL_HEADER_IN_CAN_ID;
+    alice.ctx.clientConfig = &alice.clientConfig;
+    err = hzl_ClientInit(&alice.ctx);
+    HZL_ERR_CLEANUP(err);
+    printf("Client on %s at %u%% load of a 500k/2M CAN FD bus, 64 B frames, %u Groups:\n",
+           HZL_BENCH_CAN_FILTERS_IFNAME, HZL_BENCH_CAN_FILTERS_BUS_LOAD,
+           HZL_BENCH_CAN_FILTERS_BUS_GROUPS);
+    err = hzlBench_CanFiltersRun(&alice, false);
+    HZL_ERR_CLEANUP(err);
+    err = hzlBench_CanFiltersRun(&alice, true);
+cleanup:
+    hzl_ClientFree(&aliceFromFile);
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
+
+#else
+
+int
+hzlBench_CanFilters(void)
+{
+    printf("Skip | %s: SocketCAN is available on Linux only\n", __func__);
+    return 0;
+}
+
+#endif  /* HZL_OS_AVAILABLE_LINUX */
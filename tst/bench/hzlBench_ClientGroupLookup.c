@@ -0,0 +1,190 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cost for a Client of ignoring frames of foreign Groups and of finding its own Group,
+ * when it is part of 1, 8, 32 or 255 Groups.
+ *
+ * The Group lookup is a table indexed by GID, so both costs should be the same for any
+ * amount of Groups. The linear scan through the Group configurations, as done before the
+ * table, is timed alongside as reference.
+ */
+
+#include "hzlBench.h"
+#include "hzl_CommonHeader.h"
+#include <stdlib.h>
+
+#define HZL_BENCH_GROUP_LOOKUP_FRAMES 1000000U
+/** GID no Client in this benchmark is part of. */
+#define HZL_BENCH_GROUP_LOOKUP_FOREIGN_GID 255U
+
+/** Client in \p amountOfGroups Groups, GIDs 0 to amountOfGroups-1, without Sessions. */
+typedef struct hzlBench_GroupLookupClient
+{
+    hzl_ClientCtx_t ctx;
+    hzl_ClientConfig_t clientConfig;
+    hzl_ClientGroupConfig_t* groupConfigs;
+    hzl_ClientGroupState_t* groupStates;
+} hzlBench_GroupLookupClient_t;
+
+static hzl_Err_t
+hzlBench_GroupLookupClientInit(hzlBench_GroupLookupClient_t* const client,
+                               const hzl_ClientCtx_t* const template,
+                               const uint8_t amountOfGroups)
+{
+    client->clientConfig = *template->clientConfig;
+    client->clientConfig.amountOfGroups = amountOfGroups;
+    client->clientConfig.headerType = HZL_HEADER_0;  // 8-bit GIDs
+    client->groupConfigs = calloc(amountOfGroups, sizeof(hzl_ClientGroupConfig_t));
+    client->groupStates = calloc(amountOfGroups, sizeof(hzl_ClientGroupState_t));
+    if (client->groupConfigs == NULL || client->groupStates == NULL)
+    {
+        return HZL_ERR_MALLOC_FAILED;
+    }
+    for (size_t i = 0; i < amountOfGroups; i++)
+    {
+        client->groupConfigs[i] = template->groupConfigs[0];
+        client->groupConfigs[i].gid = (hzl_Gid_t) i;
+    }
+    client->ctx.clientConfig = &client->clientConfig;
+    client->ctx.groupConfigs = client->groupConfigs;
+    client->ctx.groupStates = client->groupStates;
+    client->ctx.io = template->io;
+    return hzl_ClientInit(&client->ctx);
+}
+
+static void
+hzlBench_GroupLookupClientTeardown(hzlBench_GroupLookupClient_t* const client)
+{
+    free(client->groupConfigs);
+    free(client->groupStates);
+}
+
+/** Reference: the linear scan hzl_ClientFindGroup() performed before the GID table. */
+static size_t
+hzlBench_GroupLookupLinearScan(const hzl_ClientCtx_t* const ctx,
+                               const hzl_Gid_t groupId)
+{
+    for (size_t i = 0; i < ctx->clientConfig->amountOfGroups; i++)
+    {
+        if (ctx->groupConfigs[i].gid == groupId) { return i; }
+    }
+    return ctx->clientConfig->amountOfGroups;
+}
+
+/** Processes the same SADFD frame from the Server over and over, expecting \p expectedErr. */
+static hzl_Err_t
+hzlBench_GroupLookupRunFrames(double* const nanosPerFrame,
+                              hzl_ClientCtx_t* const ctx,
+                              const hzl_Gid_t groupId,
+                              const hzl_Err_t expectedErr)
+{
+    // Header 0, ctrnonce, ptlen, 8 B of ctext and a tag: it's never decrypted anyway
+    uint8_t sadfd[HZL_MAX_CAN_FD_DATA_LEN] = {groupId, HZL_SERVER_SID, HZL_PTY_SADFD, 1, 0, 0, 8};
+    const size_t sadfdLen = 3 + 3 + 1 + 8 + 8;
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduMsg_t sdu;
+    const hzl_Timestamp_t rxTimestamp = 1000U;
+
+    const uint64_t start = hzlBench_NowNanos();
+    for (size_t i = 0; i < HZL_BENCH_GROUP_LOOKUP_FRAMES; i++)
+    {
+        const hzl_Err_t err = hzl_ClientProcessReceivedAt(
+                &reaction, &sdu, ctx, sadfd, sadfdLen, HZL_BENCH_CAN_ID, rxTimestamp);
+        if (err != expectedErr) { return err == HZL_OK ? HZL_ERR_PROGRAMMING : err; }
+    }
+    *nanosPerFrame = (double) (hzlBench_NowNanos() - start) / HZL_BENCH_GROUP_LOOKUP_FRAMES;
+    return HZL_OK;
+}
+
+static double
+hzlBench_GroupLookupRunLinearScan(const hzl_ClientCtx_t* const ctx,
+                                  const hzl_Gid_t groupId)
+{
+    volatile size_t sink = 0;  // Keeps the scan from being optimised away
+    const uint64_t start = hzlBench_NowNanos();
+    for (size_t i = 0; i < HZL_BENCH_GROUP_LOOKUP_FRAMES; i++)
+    {
+        sink += hzlBench_GroupLookupLinearScan(ctx, groupId);
+    }
+    (void) sink;
+    return (double) (hzlBench_NowNanos() - start) / HZL_BENCH_GROUP_LOOKUP_FRAMES;
+}
+
+static hzl_Err_t
+hzlBench_GroupLookupRun(const hzl_ClientCtx_t* const template,
+                        const uint8_t amountOfGroups)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_GroupLookupClient_t client = {0};
+    double foreignNanos = 0;
+    double ownNanos = 0;
+    const hzl_Gid_t lastOwnGid = (hzl_Gid_t) (amountOfGroups - 1U);
+
+    err = hzlBench_GroupLookupClientInit(&client, template, amountOfGroups);
+    HZL_ERR_CLEANUP(err);
+    err = hzlBench_GroupLookupRunFrames(&foreignNanos, &client.ctx,
+                                        HZL_BENCH_GROUP_LOOKUP_FOREIGN_GID,
+                                        HZL_ERR_MSG_IGNORED);
+    HZL_ERR_CLEANUP(err);
+    // The own Group found last by a linear scan. No Session, so it stops right after the lookup.
+    err = hzlBench_GroupLookupRunFrames(&ownNanos, &client.ctx, lastOwnGid,
+                                        HZL_ERR_SESSION_NOT_ESTABLISHED);
+    HZL_ERR_CLEANUP(err);
+    printf("%u Groups:\n", amountOfGroups);
+    hzlBench_ReportFrameCost("  foreign GID, ignored", foreignNanos);
+    hzlBench_ReportFrameCost("  own GID, found", ownNanos);
+    printf("%-40s %10.1f ns/lookup\n", "  linear scan (before), foreign GID",
+           hzlBench_GroupLookupRunLinearScan(&client.ctx, HZL_BENCH_GROUP_LOOKUP_FOREIGN_GID));
+cleanup:
+    hzlBench_GroupLookupClientTeardown(&client);
+    return err;
+}
+
+int
+hzlBench_ClientGroupLookup(void)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_Bus_t bus = {0};
+    const uint8_t amountsOfGroups[] = {1U, 8U, 32U, 255U};
+
+    err = hzlBench_BusInit(&bus);
+    HZL_ERR_CLEANUP(err);
+    printf("SADFD received by a Client, Group lookup only:\n");
+    for (size_t i = 0; i < sizeof(amountsOfGroups); i++)
+    {
+        err = hzlBench_GroupLookupRun(bus.alice, amountsOfGroups[i]);
+        HZL_ERR_CLEANUP(err);
+    }
+cleanup:
+    hzlBench_BusTeardown(&bus);
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
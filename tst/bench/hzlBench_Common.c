@@ -0,0 +1,144 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Bus emulation, timing and reporting functions shared by all benchmarks.
+ */
+
+// For clock_gettime() also when compiling with a strict -std=c11.
+// Must precede any system header, including the ones from hzlBench.h.
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "hzlBench.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>  /* For __rdtsc() */
+#elif defined(_M_X64) || defined(_M_IX86)
+#include <intrin.h>  /* For __rdtsc() */
+#endif
+
+hzl_Err_t
+hzlBench_BusInit(hzlBench_Bus_t* const bus)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_CbsPduMsg_t req;
+    hzl_CbsPduMsg_t res;
+    hzl_CbsPduMsg_t nothing;
+    hzl_RxSduMsg_t sdu;
+
+    err = hzl_ServerNew(&bus->server, "serverconfigfiles/Server.hzl");
+    HZL_ERR_CHECK(err);
+    err = hzl_ClientNew(&bus->alice, "clientconfigfiles/Alice.hzl");
+    HZL_ERR_CHECK(err);
+    err = hzl_ClientBuildRequest(&req, bus->alice, HZL_BENCH_GID);
+    HZL_ERR_CHECK(err);
+    err = hzl_ServerProcessReceived(&res, &sdu, bus->server, req.data, req.dataLen,
+                                    HZL_BENCH_CAN_ID);
+    HZL_ERR_CHECK(err);
+    err = hzl_ClientProcessReceived(&nothing, &sdu, bus->alice, res.data, res.dataLen,
+                                    HZL_BENCH_CAN_ID);
+    return err;
+}
+
+void
+hzlBench_BusTeardown(hzlBench_Bus_t* const bus)
+{
+    hzl_ServerFree(&bus->server);
+    hzl_ClientFree(&bus->alice);
+}
+
+hzl_Err_t
+hzlBench_BusDeliverServerReaction(hzlBench_Bus_t* const bus,
+                                  const hzl_CbsPduMsg_t* const reaction)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_CbsPduMsg_t fromServer = *reaction;
+    hzl_CbsPduMsg_t fromAlice;
+    hzl_RxSduMsg_t sdu;
+
+    while (fromServer.dataLen > 0)
+    {
+        err = hzl_ClientProcessReceived(&fromAlice, &sdu, bus->alice,
+                                        fromServer.data, fromServer.dataLen, HZL_BENCH_CAN_ID);
+        HZL_ERR_CHECK(err);
+        if (fromAlice.dataLen == 0) { break; }
+        err = hzl_ServerProcessReceived(&fromServer, &sdu, bus->server,
+                                        fromAlice.data, fromAlice.dataLen, HZL_BENCH_CAN_ID);
+        HZL_ERR_CHECK(err);
+    }
+    return HZL_OK;
+}
+
+uint64_t
+hzlBench_NowNanos(void)
+{
+#if HZL_OS_AVAILABLE_WIN
+    // Frequency fixed at boot, so queried once.
+    static LARGE_INTEGER frequency = {0};
+    if (frequency.QuadPart == 0) { QueryPerformanceFrequency(&frequency); }
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    // Split to avoid overflowing when multiplying the ticks by 10^9.
+    const uint64_t ticks = (uint64_t) now.QuadPart;
+    const uint64_t ticksPerSecond = (uint64_t) frequency.QuadPart;
+    return ticks / ticksPerSecond * 1000000000U
+           + ticks % ticksPerSecond * 1000000000U / ticksPerSecond;
+#else
+    // Unlike the wall-clock time, it does not jump when the time is adjusted mid-measurement.
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000U + (uint64_t) now.tv_nsec;
+#endif
+}
+
+uint64_t
+hzlBench_NowCycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    return (uint64_t) __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+void
+hzlBench_ReportFrameCost(const char* const label,
+                         const double nanosPerFrame)
+{
+    // CPU load [%] = frame cost [s] * frames per second * 100
+    printf("%-40s %10.1f ns/frame | CPU load @1k fps %7.3f %% | @10k fps %7.3f %% "
+           "| @100k fps %7.2f %%\n",
+           label, nanosPerFrame,
+           nanosPerFrame * 1e3 * 1e-7,
+           nanosPerFrame * 1e4 * 1e-7,
+           nanosPerFrame * 1e5 * 1e-7);
+}
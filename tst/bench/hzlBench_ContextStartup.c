@@ -0,0 +1,76 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cost of creating and destroying contexts from their configuration files,
+ * as when spinning up many of them, e.g. one per CAN bus.
+ *
+ * Includes the file parsing and the initialisation, e.g. the generation of the first STKs,
+ * besides the allocation of the single arena per context.
+ */
+
+#include "hzlBench.h"
+
+#define HZL_BENCH_CONTEXT_STARTUP_CYCLES 10000U
+
+int
+hzlBench_ContextStartup(void)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_ServerCtx_t* server = NULL;
+    hzl_ClientCtx_t* client = NULL;
+
+    uint64_t start = hzlBench_NowNanos();
+    for (size_t i = 0; i < HZL_BENCH_CONTEXT_STARTUP_CYCLES; i++)
+    {
+        err = hzl_ServerNew(&server, "serverconfigfiles/Server.hzl");
+        HZL_ERR_CLEANUP(err);
+        hzl_ServerFree(&server);
+    }
+    const double serverNanos =
+            (double) (hzlBench_NowNanos() - start) / HZL_BENCH_CONTEXT_STARTUP_CYCLES;
+    start = hzlBench_NowNanos();
+    for (size_t i = 0; i < HZL_BENCH_CONTEXT_STARTUP_CYCLES; i++)
+    {
+        err = hzl_ClientNew(&client, "clientconfigfiles/Alice.hzl");
+        HZL_ERR_CLEANUP(err);
+        hzl_ClientFree(&client);
+    }
+    const double clientNanos =
+            (double) (hzlBench_NowNanos() - start) / HZL_BENCH_CONTEXT_STARTUP_CYCLES;
+    printf("Context created from file and freed:\n");
+    printf("%-40s %10.1f ns/context\n", "  Server New + Free", serverNanos);
+    printf("%-40s %10.1f ns/context\n", "  Client New + Free", clientNanos);
+cleanup:
+    hzl_ServerFree(&server);
+    hzl_ClientFree(&client);
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
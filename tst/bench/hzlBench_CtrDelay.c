@@ -0,0 +1,90 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cost of the Counter Nonce Delay computed for every received SADFD message, in the
+ * implementation of this build, #HZL_INTEGER_CTRDELAY.
+ *
+ * Run the `bench_hzl_ctrdelay` target to compare both implementations.
+ */
+
+#include "hzlBench.h"
+#include "hzl_CommonMessage.h"
+
+#define HZL_BENCH_CTRDELAY_CALLS 20000000U
+/** Amount of distinct inputs, cycled through, a power of 2. */
+#define HZL_BENCH_CTRDELAY_INPUTS 4096U
+
+#if HZL_INTEGER_CTRDELAY
+#define HZL_BENCH_CTRDELAY_MODE "integer"
+#else
+#define HZL_BENCH_CTRDELAY_MODE "float"
+#endif
+
+/** Input of one ctrdelay() call. */
+typedef struct hzlBench_CtrDelayInput
+{
+    hzl_Timestamp_t elapsed;
+    hzl_CtrNonce_t maxDelay;
+    uint16_t maxSilence;
+} hzlBench_CtrDelayInput_t;
+
+int
+hzlBench_CtrDelay(void)
+{
+    static hzlBench_CtrDelayInput_t inputs[HZL_BENCH_CTRDELAY_INPUTS];
+    // Pseudo-random inputs within the silence interval, with xorshift32,
+    // so the result is never the trivial 0
+    uint32_t state = 0x12345678U;
+    for (size_t i = 0; i < HZL_BENCH_CTRDELAY_INPUTS; i++)
+    {
+        state ^= state << 13U;
+        state ^= state >> 17U;
+        state ^= state << 5U;
+        inputs[i].maxSilence = (uint16_t) (1U + (state & 0x7FFFU));
+        inputs[i].elapsed = (state >> 15U) % inputs[i].maxSilence;
+        inputs[i].maxDelay = state % (HZL_LARGEST_MAX_COUNTER_NONCE_DELAY + 1U);
+    }
+
+    uint32_t checksum = 0;
+    const uint64_t startNanos = hzlBench_NowNanos();
+    const uint64_t startCycles = hzlBench_NowCycles();
+    for (size_t i = 0; i < HZL_BENCH_CTRDELAY_CALLS; i++)
+    {
+        const hzlBench_CtrDelayInput_t* const input = &inputs[i & (HZL_BENCH_CTRDELAY_INPUTS - 1U)];
+        checksum += hzl_CommonCtrDelay(0, input->elapsed, input->maxDelay, input->maxSilence);
+    }
+    const uint64_t cycles = hzlBench_NowCycles() - startCycles;
+    const uint64_t nanos = hzlBench_NowNanos() - startNanos;
+    printf("ctrdelay() in %s mode: %.2f ns/call, %.1f cycles/call (checksum %08x)\n",
+           HZL_BENCH_CTRDELAY_MODE, (double) nanos / HZL_BENCH_CTRDELAY_CALLS,
+           (double) cycles / HZL_BENCH_CTRDELAY_CALLS, (unsigned int) checksum);
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Latency of the legit SADFD messages processed by the Server during a flood of forged ones,
+ * with and without the DoS protection.
+ *
+ * Each legit message of Alice is queued behind #HZL_BENCH_DOS_FLOOD_FORGED_PER_LEGIT forged
+ * SADFD messages in the broadcast Group, spoofing the other Clients, so its latency includes
+ * the processing of the whole queue. The bus time advances by 1 ms per legit message, i.e.
+ * Alice sends 1k messages/s among a flood of 20k messages/s. Without protection, every forged
+ * message costs a tag validation. With it, most are dropped right after unpacking the header.
+ */
+
+#include "hzlBench.h"
+#include "hzl_ServerInternal.h"
+#include "hzl_CommonHeader.h"
+#include <stdlib.h>
+
+#define HZL_BENCH_DOS_FLOOD_LEGIT_FRAMES 2000U
+#define HZL_BENCH_DOS_FLOOD_FORGED_PER_LEGIT 20U
+#define HZL_BENCH_DOS_FLOOD_SDU_LEN 8U
+
+/** Limits well above the traffic of Alice, well below the one of the flood. */
+static const hzl_ServerDosConfig_t hzlBench_dosFloodConfig = {
+        .perClient = {.msgsPerSecond = 2000U, .burstMsgs = 20U},
+        .perGroup = {.msgsPerSecond = 4000U, .burstMsgs = 40U},
+        .rejected = {.msgsPerSecond = 0U, .burstMsgs = 0U},  // Would drop Alice too
+};
+
+/** Too large for the stack. */
+static hzl_ServerDosState_t hzlBench_dosFloodState;
+
+static int
+hzlBench_DosFloodCompare(const void* const a,
+                         const void* const b)
+{
+    const uint32_t left = *(const uint32_t*) a;
+    const uint32_t right = *(const uint32_t*) b;
+    return (left > right) - (left < right);
+}
+
+/** Xorshift32: the flood must not depend on the OS TRNG. */
+static uint32_t
+hzlBench_DosFloodRandom(uint32_t* const state)
+{
+    uint32_t x = *state;
+    x ^= x << 13U;
+    x ^= x >> 17U;
+    x ^= x << 5U;
+    *state = x;
+    return x;
+}
+
+/** Copy of the legit message in the broadcast Group from another Client, with a broken tag. */
+static void
+hzlBench_DosFloodForge(hzl_CbsPduMsg_t* const forged,
+                       const hzl_CbsPduMsg_t* const legit,
+                       const hzlBench_Bus_t* const bus,
+                       uint32_t* const random)
+{
+    const uint8_t headerType = bus->server->serverConfig->headerType;
+    const hzl_Sid_t aliceSid = bus->alice->clientConfig->sid;
+    const hzl_Sid_t amountOfClients = bus->server->serverConfig->amountOfClients;
+    hzl_Sid_t sid;
+    do
+    {
+        sid = (hzl_Sid_t) (1U + hzlBench_DosFloodRandom(random) % amountOfClients);
+    } while (sid == aliceSid);
+    const hzl_Header_t hdr = {.gid = HZL_BROADCAST_GID, .sid = sid, .pty = HZL_PTY_SADFD};
+    *forged = *legit;
+    hzl_HeaderPack(forged->data, &hdr, headerType);
+    forged->data[forged->dataLen - 1U] ^= 0xFFU;
+}
+
+/** Processes all frames, storing the latency of each legit one, queue included. */
+static hzl_Err_t
+hzlBench_DosFloodRun(uint32_t* const nanos,
+                     size_t* const legitDropped,
+                     hzlBench_Bus_t* const bus)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_CbsPduMsg_t sadfd;
+    hzl_CbsPduMsg_t forged[HZL_BENCH_DOS_FLOOD_FORGED_PER_LEGIT];
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduMsg_t sdu;
+    const uint8_t sadData[HZL_BENCH_DOS_FLOOD_SDU_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint32_t random = 0x2545F491U;
+    hzl_Timestamp_t busTime;
+
+    err = bus->server->io.currentTime(&busTime);
+    HZL_ERR_CHECK(err);
+    *legitDropped = 0;
+    for (size_t i = 0; i < HZL_BENCH_DOS_FLOOD_LEGIT_FRAMES; i++)
+    {
+        busTime++;
+        err = hzl_ClientBuildSecuredFd(&sadfd, bus->alice, sadData, sizeof(sadData),
+                                       HZL_BENCH_GID);
+        HZL_ERR_CHECK(err);
+        for (size_t j = 0; j < HZL_BENCH_DOS_FLOOD_FORGED_PER_LEGIT; j++)
+        {
+            hzlBench_DosFloodForge(&forged[j], &sadfd, bus, &random);
+        }
+        const uint64_t start = hzlBench_NowNanos();
+        for (size_t j = 0; j < HZL_BENCH_DOS_FLOOD_FORGED_PER_LEGIT; j++)
+        {
+            err = hzl_ServerProcessReceivedAt(&reaction, &sdu, bus->server, forged[j].data,
+                                              forged[j].dataLen, HZL_BENCH_CAN_ID, busTime);
+            if (err == HZL_OK) { return HZL_ERR_PROGRAMMING; }  // A forgery must never pass
+        }
+        err = hzl_ServerProcessReceivedAt(&reaction, &sdu, bus->server, sadfd.data,
+                                          sadfd.dataLen, HZL_BENCH_CAN_ID, busTime);
+        nanos[i] = (uint32_t) (hzlBench_NowNanos() - start);
+        if (err == HZL_ERR_SECWARN_DENIAL_OF_SERVICE)
+        {
+            (*legitDropped)++;
+            continue;
+        }
+        HZL_ERR_CHECK(err);
+        err = hzlBench_BusDeliverServerReaction(bus, &reaction);
+        HZL_ERR_CHECK(err);
+    }
+    return HZL_OK;
+}
+
+static hzl_Err_t
+hzlBench_DosFloodReport(const char* const label,
+                        uint32_t* const nanos,
+                        const bool protect)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_Bus_t bus = {0};
+    size_t legitDropped = 0;
+    uint64_t totalNanos = 0;
+
+    err = hzlBench_BusInit(&bus);
+    HZL_ERR_CLEANUP(err);
+    if (protect)
+    {
+        // Enabled after the handshake, which would otherwise be repeated after hzl_ServerInit()
+        bus.server->dosConfig = &hzlBench_dosFloodConfig;
+        bus.server->dosState = &hzlBench_dosFloodState;
+        hzl_Timestamp_t now;
+        err = bus.server->io.currentTime(&now);
+        HZL_ERR_CLEANUP(err);
+        hzl_ServerDosInit(bus.server, now);
+    }
+    err = hzlBench_DosFloodRun(nanos, &legitDropped, &bus);
+    HZL_ERR_CLEANUP(err);
+    for (size_t i = 0; i < HZL_BENCH_DOS_FLOOD_LEGIT_FRAMES; i++) { totalNanos += nanos[i]; }
+    qsort(nanos, HZL_BENCH_DOS_FLOOD_LEGIT_FRAMES, sizeof(uint32_t), hzlBench_DosFloodCompare);
+    const size_t forged = HZL_BENCH_DOS_FLOOD_LEGIT_FRAMES * HZL_BENCH_DOS_FLOOD_FORGED_PER_LEGIT;
+    const hzl_ServerDosCounters_t* const counters = &hzlBench_dosFloodState.counters;
+    const size_t forgedDropped = protect
+                                 ? counters->droppedByClientLimit + counters->droppedByGroupLimit
+                                 : 0U;
+    printf("%-36s mean %8.0f ns | p99 %8u ns | legit dropped %5.2f %% | forged dropped %6.2f %%\n",
+           label,
+           (double) totalNanos / HZL_BENCH_DOS_FLOOD_LEGIT_FRAMES,
+           nanos[(size_t) (0.99 * (HZL_BENCH_DOS_FLOOD_LEGIT_FRAMES - 1U))],
+           100.0 * (double) legitDropped / HZL_BENCH_DOS_FLOOD_LEGIT_FRAMES,
+           100.0 * (double) forgedDropped / (double) forged);
+cleanup:
+    if (bus.server != NULL)
+    {
+        bus.server->dosConfig = NULL;
+        bus.server->dosState = NULL;
+    }
+    hzlBench_BusTeardown(&bus);
+    return err;
+}
+
+int
+hzlBench_DosFlood(void)
+{
+    HZL_ERR_DECLARE(err);
+    uint32_t* const nanos = malloc(HZL_BENCH_DOS_FLOOD_LEGIT_FRAMES * sizeof(uint32_t));
+
+    if (nanos == NULL)
+    {
+        err = HZL_ERR_MALLOC_FAILED;
+        HZL_ERR_CLEANUP(err);
+    }
+    printf("SADFD %u B of Alice queued behind %u forged SADFD each, latency with the queue:\n",
+           HZL_BENCH_DOS_FLOOD_SDU_LEN, HZL_BENCH_DOS_FLOOD_FORGED_PER_LEGIT);
+    err = hzlBench_DosFloodReport("  no DoS protection (before)", nanos, false);
+    HZL_ERR_CLEANUP(err);
+    err = hzlBench_DosFloodReport("  token buckets (after)", nanos, true);
+    HZL_ERR_CLEANUP(err);
+cleanup:
+    free(nanos);
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cost of the header-dependent work of one frame: packing the header of an unsecured message,
+ * then checking, unpacking and extracting it on reception. No cryptography is involved.
+ *
+ * Libraries supporting any header type dispatch on the configured one; libraries built with
+ * #HZL_FIXED_HEADER_TYPE have it inlined and constant-folded into the payload offsets instead.
+ * To compare them, run the `bench_hzl_header_types` target, which builds and runs this
+ * benchmark once per build variant, reporting also the code size of the `hzl_*_any` libraries.
+ */
+
+#include "hzlBench.h"
+#include "hzl_CommonHeader.h"
+#include "hzl_CommonMessage.h"
+
+#define HZL_BENCH_HEADER_TYPES_FRAMES 1000000U
+#define HZL_BENCH_HEADER_TYPES_SDU_LEN 8U
+/** Sender of the benchmark frames, fitting into the SID of every header type. */
+#define HZL_BENCH_HEADER_TYPES_SID 1U
+
+static hzl_Err_t
+hzlBench_HeaderTypesRun(const uint8_t headerType)
+{
+    const uint8_t sdu[HZL_BENCH_HEADER_TYPES_SDU_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+    hzl_CbsPduMsg_t uad;
+    hzl_Header_t unpackedHdr;
+    hzl_RxSduView_t view;
+    hzl_Err_t err = HZL_OK;
+
+    const uint64_t startNanos = hzlBench_NowNanos();
+    const uint64_t startCycles = hzlBench_NowCycles();
+    for (size_t i = 0; i < HZL_BENCH_HEADER_TYPES_FRAMES && err == HZL_OK; i++)
+    {
+        err = hzl_CommonBuildUnsecured(&uad, sdu, sizeof(sdu), HZL_BROADCAST_GID,
+                                       HZL_BENCH_HEADER_TYPES_SID, headerType,
+                                       HZL_HEADER_IN_PAYLOAD);
+        if (err != HZL_OK) { break; }
+        err = hzl_CommonCheckReceivedGenericMsg(&unpackedHdr, uad.data, uad.dataLen, uad.canId,
+                                                HZL_SERVER_SID, headerType,
+                                                HZL_HEADER_IN_PAYLOAD);
+        if (err != HZL_OK) { break; }
+        err = hzl_CommonProcessReceivedUnsecuredView(&view, uad.data, uad.dataLen,
+                                                     &unpackedHdr, headerType,
+                                                     HZL_HEADER_IN_PAYLOAD);
+    }
+    const uint64_t elapsedCycles = hzlBench_NowCycles() - startCycles;
+    const double nanosPerFrame =
+            (double) (hzlBench_NowNanos() - startNanos) / HZL_BENCH_HEADER_TYPES_FRAMES;
+    if (err != HZL_OK) { return err; }
+    if (view.dataLen != sizeof(sdu)) { return HZL_ERR_PROGRAMMING; }
+
+    char label[40];
+    snprintf(label, sizeof(label), "  Header %u (%u B)", headerType, hzl_HeaderLen(headerType));
+    hzlBench_ReportFrameCost(label, nanosPerFrame);
+    if (elapsedCycles != 0)
+    {
+        printf("%-40s %10.1f cycles/frame\n", "",
+               (double) elapsedCycles / HZL_BENCH_HEADER_TYPES_FRAMES);
+    }
+    return HZL_OK;
+}
+
+int
+hzlBench_HeaderTypes(void)
+{
+    HZL_ERR_DECLARE(err);
+
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
+    printf("UAD header packing and unpacking, any header type:\n");
+    for (uint8_t headerType = HZL_HEADER_0; headerType <= HZL_HEADER_6; headerType++)
+    {
+        err = hzlBench_HeaderTypesRun(headerType);
+        HZL_ERR_CLEANUP(err);
+    }
+#else
+    printf("UAD header packing and unpacking, fixed header type:\n");
+    err = hzlBench_HeaderTypesRun(HZL_FIXED_HEADER_TYPE);
+    HZL_ERR_CLEANUP(err);
+#endif
+cleanup:
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Main file and function, running all the benchmarks.
+ */
+
+#include "hzlBench.h"
+
+/**
+ * Main function, running all benchmarks.
+ * @return 0 if all benchmarks could run, non-zero otherwise.
+ */
+int main(void)
+{
+    int failures = 0;
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY || HZL_FIXED_HEADER_TYPE == 0
+    // The parties on the benchmark bus are loaded from configuration files with header type 0
+    failures += hzlBench_AeadKeyCache();
+    failures += hzlBench_AeadBackend();
+    failures += hzlBench_ProcessReceivedBatch();
+    failures += hzlBench_TrngResponse();
+    failures += hzlBench_ClientGroupLookup();
+    failures += hzlBench_ServerGroupState();
+    failures += hzlBench_ServerTick();
+    failures += hzlBench_RenewalLatency();
+    failures += hzlBench_DosFlood();
+    failures += hzlBench_RejectedCache();
+    failures += hzlBench_OutputClearing();
+    failures += hzlBench_ContextStartup();
+    failures += hzlBench_CanFilters();
+    failures += hzlBench_SadtpThroughput();
+#endif
+    failures += hzlBench_HeaderTypes();
+    failures += hzlBench_CtrDelay();
+    return failures;
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cost of processing a small received message, dominated by the clearing of the outputs,
+ * in the clearing mode of this build, #HZL_LAZY_OUTPUT_CLEARING.
+ *
+ * Run the `bench_hzl_output_clearing` target to compare both modes.
+ */
+
+#include "hzlBench.h"
+
+#define HZL_BENCH_OUTPUT_CLEARING_FRAMES 1000000U
+#define HZL_BENCH_OUTPUT_CLEARING_SDU_LEN 8U
+
+#if HZL_LAZY_OUTPUT_CLEARING
+#define HZL_BENCH_OUTPUT_CLEARING_MODE "lazy"
+#else
+#define HZL_BENCH_OUTPUT_CLEARING_MODE "full"
+#endif
+
+int
+hzlBench_OutputClearing(void)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_Bus_t bus = {0};
+    hzl_CbsPduMsg_t fromServer;
+    hzl_CbsPduMsg_t fromAlice;
+    // The outputs are reused across messages, zero-initialised once
+    hzl_CbsPduMsg_t reaction = {0};
+    hzl_RxSduMsg_t sdu = {0};
+    const uint8_t uadData[HZL_BENCH_OUTPUT_CLEARING_SDU_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    err = hzlBench_BusInit(&bus);
+    HZL_ERR_CLEANUP(err);
+    err = hzl_ServerBuildUnsecured(&fromServer, bus.server, uadData, sizeof(uadData),
+                                   HZL_BENCH_GID);
+    HZL_ERR_CLEANUP(err);
+    err = hzl_ClientBuildUnsecured(&fromAlice, bus.alice, uadData, sizeof(uadData),
+                                   HZL_BENCH_GID);
+    HZL_ERR_CLEANUP(err);
+
+    uint64_t start = hzlBench_NowNanos();
+    for (size_t i = 0; i < HZL_BENCH_OUTPUT_CLEARING_FRAMES; i++)
+    {
+        err = hzl_ClientProcessReceived(&reaction, &sdu, bus.alice,
+                                        fromServer.data, fromServer.dataLen, HZL_BENCH_CAN_ID);
+        HZL_ERR_CLEANUP(err);
+    }
+    const double clientNanos =
+            (double) (hzlBench_NowNanos() - start) / HZL_BENCH_OUTPUT_CLEARING_FRAMES;
+    start = hzlBench_NowNanos();
+    for (size_t i = 0; i < HZL_BENCH_OUTPUT_CLEARING_FRAMES; i++)
+    {
+        err = hzl_ServerProcessReceived(&reaction, &sdu, bus.server,
+                                        fromAlice.data, fromAlice.dataLen, HZL_BENCH_CAN_ID);
+        HZL_ERR_CLEANUP(err);
+    }
+    const double serverNanos =
+            (double) (hzlBench_NowNanos() - start) / HZL_BENCH_OUTPUT_CLEARING_FRAMES;
+    printf("UAD %u B received, outputs cleared in %s mode:\n",
+           HZL_BENCH_OUTPUT_CLEARING_SDU_LEN, HZL_BENCH_OUTPUT_CLEARING_MODE);
+    hzlBench_ReportFrameCost("  Client process", clientNanos);
+    hzlBench_ReportFrameCost("  Server process", serverNanos);
+cleanup:
+    hzlBench_BusTeardown(&bus);
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
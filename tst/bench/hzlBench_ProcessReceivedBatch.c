@@ -0,0 +1,133 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cost of processing a burst of SADFD messages on the Server, one call per message
+ * versus one hzl_ServerProcessReceivedBatch() call per burst.
+ */
+
+#include "hzlBench.h"
+
+#define HZL_BENCH_BATCH_BURSTS 2000U
+#define HZL_BENCH_BATCH_BURST_LEN 64U
+#define HZL_BENCH_BATCH_SDU_LEN 8U
+
+static hzl_Err_t
+hzlBench_ProcessReceivedBatchBuildBurst(hzlBench_Bus_t* const bus,
+                                        hzl_CbsPduMsg_t* const burst,
+                                        hzl_RxPdu_t* const pdus)
+{
+    const uint8_t sadData[HZL_BENCH_BATCH_SDU_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+    hzl_Timestamp_t now = 0;
+    hzl_Err_t err = bus->server->io.currentTime(&now);
+
+    for (size_t i = 0; i < HZL_BENCH_BATCH_BURST_LEN && err == HZL_OK; i++)
+    {
+        err = hzl_ClientBuildSecuredFd(&burst[i], bus->alice, sadData, sizeof(sadData),
+                                       HZL_BENCH_GID);
+        pdus[i].data = burst[i].data;
+        pdus[i].dataLen = burst[i].dataLen;
+        pdus[i].canId = HZL_BENCH_CAN_ID;
+        pdus[i].rxTimestamp = now;
+    }
+    return err;
+}
+
+static hzl_Err_t
+hzlBench_ProcessReceivedBatchRun(double* const nanosPerFrame,
+                                 const bool batched)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_Bus_t bus = {0};
+    hzl_CbsPduMsg_t burst[HZL_BENCH_BATCH_BURST_LEN];
+    hzl_RxPdu_t pdus[HZL_BENCH_BATCH_BURST_LEN];
+    hzl_CbsPduMsg_t reactions[HZL_BENCH_BATCH_BURST_LEN];
+    hzl_RxSduMsg_t sdus[HZL_BENCH_BATCH_BURST_LEN];
+    hzl_Err_t results[HZL_BENCH_BATCH_BURST_LEN];
+    uint64_t elapsedNanos = 0;
+
+    err = hzlBench_BusInit(&bus);
+    HZL_ERR_CLEANUP(err);
+    for (size_t b = 0; b < HZL_BENCH_BATCH_BURSTS; b++)
+    {
+        err = hzlBench_ProcessReceivedBatchBuildBurst(&bus, burst, pdus);
+        HZL_ERR_CLEANUP(err);
+        const uint64_t start = hzlBench_NowNanos();
+        if (batched)
+        {
+            err = hzl_ServerProcessReceivedBatch(reactions, sdus, results, bus.server, pdus,
+                                                 HZL_BENCH_BATCH_BURST_LEN);
+            HZL_ERR_CLEANUP(err);
+        }
+        else
+        {
+            for (size_t i = 0; i < HZL_BENCH_BATCH_BURST_LEN; i++)
+            {
+                results[i] = hzl_ServerProcessReceived(&reactions[i], &sdus[i], bus.server,
+                                                       pdus[i].data, pdus[i].dataLen,
+                                                       pdus[i].canId);
+            }
+        }
+        elapsedNanos += hzlBench_NowNanos() - start;
+        for (size_t i = 0; i < HZL_BENCH_BATCH_BURST_LEN; i++)
+        {
+            err = results[i];
+            HZL_ERR_CLEANUP(err);
+            // Session renewals are part of the traffic, but not of the measured cost
+            err = hzlBench_BusDeliverServerReaction(&bus, &reactions[i]);
+            HZL_ERR_CLEANUP(err);
+        }
+    }
+    *nanosPerFrame = (double) elapsedNanos / (HZL_BENCH_BATCH_BURSTS * HZL_BENCH_BATCH_BURST_LEN);
+cleanup:
+    hzlBench_BusTeardown(&bus);
+    return err;
+}
+
+int
+hzlBench_ProcessReceivedBatch(void)
+{
+    HZL_ERR_DECLARE(err);
+    double oneByOneNanos = 0;
+    double batchedNanos = 0;
+
+    err = hzlBench_ProcessReceivedBatchRun(&oneByOneNanos, false);
+    HZL_ERR_CLEANUP(err);
+    err = hzlBench_ProcessReceivedBatchRun(&batchedNanos, true);
+    HZL_ERR_CLEANUP(err);
+    printf("Burst of %u SADFD %u B, Server process:\n",
+           HZL_BENCH_BATCH_BURST_LEN, HZL_BENCH_BATCH_SDU_LEN);
+    hzlBench_ReportFrameCost("  one call per frame (before)", oneByOneNanos);
+    hzlBench_ReportFrameCost("  one batch call per burst (after)", batchedNanos);
+    printf("  speedup: %.2fx\n", oneByOneNanos / batchedNanos);
+cleanup:
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
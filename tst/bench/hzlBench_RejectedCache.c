@@ -0,0 +1,158 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cost of the SADFD messages processed by the Server with and without the cache of rejected
+ * messages: forged messages replayed in a flood and legit messages paying for the lookup.
+ */
+
+#include "hzlBench.h"
+
+#define HZL_BENCH_REJECTED_CACHE_FRAMES 100000U
+/** Distinct forged messages replayed in a loop, fitting in the cache. */
+#define HZL_BENCH_REJECTED_CACHE_REPLAYED 16U
+#define HZL_BENCH_REJECTED_CACHE_SDU_LEN 8U
+
+static hzl_Err_t
+hzlBench_RejectedCacheRunReplays(double* const nanosPerFrame,
+                                 hzlBench_Bus_t* const bus)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_CbsPduMsg_t forged[HZL_BENCH_REJECTED_CACHE_REPLAYED];
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduMsg_t sdu;
+    const uint8_t sadData[HZL_BENCH_REJECTED_CACHE_SDU_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+
+    for (size_t i = 0; i < HZL_BENCH_REJECTED_CACHE_REPLAYED; i++)
+    {
+        // Legit messages never delivered, with a broken tag
+        err = hzl_ClientBuildSecuredFd(&forged[i], bus->alice, sadData, sizeof(sadData),
+                                       HZL_BENCH_GID);
+        HZL_ERR_CHECK(err);
+        forged[i].data[forged[i].dataLen - 1U] ^= 0xFFU;
+    }
+    const uint64_t start = hzlBench_NowNanos();
+    for (size_t i = 0; i < HZL_BENCH_REJECTED_CACHE_FRAMES; i++)
+    {
+        const hzl_CbsPduMsg_t* const replayed = &forged[i % HZL_BENCH_REJECTED_CACHE_REPLAYED];
+        err = hzl_ServerProcessReceived(&reaction, &sdu, bus->server,
+                                        replayed->data, replayed->dataLen, HZL_BENCH_CAN_ID);
+        if (err != HZL_ERR_SECWARN_INVALID_TAG) { return HZL_ERR_PROGRAMMING; }
+    }
+    *nanosPerFrame = (double) (hzlBench_NowNanos() - start) / HZL_BENCH_REJECTED_CACHE_FRAMES;
+    return HZL_OK;
+}
+
+static hzl_Err_t
+hzlBench_RejectedCacheRunLegit(double* const nanosPerFrame,
+                               hzlBench_Bus_t* const bus)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_CbsPduMsg_t sadfd;
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduMsg_t sdu;
+    const uint8_t sadData[HZL_BENCH_REJECTED_CACHE_SDU_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint64_t elapsedNanos = 0;
+
+    for (size_t i = 0; i < HZL_BENCH_REJECTED_CACHE_FRAMES; i++)
+    {
+        err = hzl_ClientBuildSecuredFd(&sadfd, bus->alice, sadData, sizeof(sadData),
+                                       HZL_BENCH_GID);
+        HZL_ERR_CHECK(err);
+        const uint64_t start = hzlBench_NowNanos();
+        err = hzl_ServerProcessReceived(&reaction, &sdu, bus->server, sadfd.data, sadfd.dataLen,
+                                        HZL_BENCH_CAN_ID);
+        elapsedNanos += hzlBench_NowNanos() - start;
+        HZL_ERR_CHECK(err);
+        err = hzlBench_BusDeliverServerReaction(bus, &reaction);
+        HZL_ERR_CHECK(err);
+    }
+    *nanosPerFrame = (double) elapsedNanos / HZL_BENCH_REJECTED_CACHE_FRAMES;
+    return HZL_OK;
+}
+
+static hzl_Err_t
+hzlBench_RejectedCacheRun(double* const replayNanos,
+                          double* const legitNanos,
+                          const bool useCache)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_Bus_t bus = {0};
+#if HZL_SERVER_REJECTED_CACHE_SLOTS > 0
+    hzl_ServerRejectedCache_t* rejectedCache = NULL;
+#endif
+
+    err = hzlBench_BusInit(&bus);
+    HZL_ERR_CLEANUP(err);
+#if HZL_SERVER_REJECTED_CACHE_SLOTS > 0
+    if (!useCache)
+    {
+        rejectedCache = bus.server->rejectedCache;
+        bus.server->rejectedCache = NULL;
+    }
+#else
+    (void) useCache;
+#endif
+    err = hzlBench_RejectedCacheRunReplays(replayNanos, &bus);
+    HZL_ERR_CLEANUP(err);
+    err = hzlBench_RejectedCacheRunLegit(legitNanos, &bus);
+    HZL_ERR_CLEANUP(err);
+cleanup:
+#if HZL_SERVER_REJECTED_CACHE_SLOTS > 0
+    if (rejectedCache != NULL) { bus.server->rejectedCache = rejectedCache; }
+#endif
+    hzlBench_BusTeardown(&bus);
+    return err;
+}
+
+int
+hzlBench_RejectedCache(void)
+{
+    HZL_ERR_DECLARE(err);
+    double uncachedReplayNanos = 0;
+    double uncachedLegitNanos = 0;
+    double cachedReplayNanos = 0;
+    double cachedLegitNanos = 0;
+
+    err = hzlBench_RejectedCacheRun(&uncachedReplayNanos, &uncachedLegitNanos, false);
+    HZL_ERR_CLEANUP(err);
+    err = hzlBench_RejectedCacheRun(&cachedReplayNanos, &cachedLegitNanos, true);
+    HZL_ERR_CLEANUP(err);
+    printf("SADFD %u B replayed with an invalid tag, %u distinct ones, Server process:\n",
+           HZL_BENCH_REJECTED_CACHE_SDU_LEN, HZL_BENCH_REJECTED_CACHE_REPLAYED);
+    hzlBench_ReportFrameCost("  decrypted every time (before)", uncachedReplayNanos);
+    hzlBench_ReportFrameCost("  rejected cache hit (after)", cachedReplayNanos);
+    printf("SADFD %u B legit, Server process:\n", HZL_BENCH_REJECTED_CACHE_SDU_LEN);
+    hzlBench_ReportFrameCost("  without cache of rejected (before)", uncachedLegitNanos);
+    hzlBench_ReportFrameCost("  with cache lookup (after)", cachedLegitNanos);
+cleanup:
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
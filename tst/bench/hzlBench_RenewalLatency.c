@@ -0,0 +1,181 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Latency percentiles of the SADFD messages processed by the Server, when some of them
+ * expire the Session and start a renewal phase.
+ *
+ * The Session of the benchmark Group expires every #HZL_BENCH_RENEWAL_LATENCY_PERIOD
+ * messages, i.e. 0.2% of them. With the next STK generated on the spot, those messages
+ * wait for the TRNG and the key expansion and make up the p99.9. With the next STK
+ * generated ahead of time by hzl_ServerTick(), called between messages as in an idle loop,
+ * they cost about as much as any other message.
+ */
+
+#include "hzlBench.h"
+#include "hzl_ServerInternal.h"
+#include <stdlib.h>
+
+#define HZL_BENCH_RENEWAL_LATENCY_FRAMES 200000U
+/** Counter Nonce upper limit of the benchmark Group: messages per Session. */
+#define HZL_BENCH_RENEWAL_LATENCY_PERIOD 512U
+#define HZL_BENCH_RENEWAL_LATENCY_SDU_LEN 8U
+
+static int
+hzlBench_RenewalLatencyCompare(const void* const a,
+                               const void* const b)
+{
+    const uint32_t left = *(const uint32_t*) a;
+    const uint32_t right = *(const uint32_t*) b;
+    return (left > right) - (left < right);
+}
+
+static uint32_t
+hzlBench_RenewalLatencyPercentile(const uint32_t* const sortedNanos,
+                                  const double percentile)
+{
+    const size_t index = (size_t) (percentile / 100.0 * (HZL_BENCH_RENEWAL_LATENCY_FRAMES - 1U));
+    return sortedNanos[index];
+}
+
+/** Processes all frames, storing the latency of each and the average of the renewing ones. */
+static hzl_Err_t
+hzlBench_RenewalLatencyRun(uint32_t* const nanos,
+                           double* const renewingNanos,
+                           hzlBench_Bus_t* const bus,
+                           const bool generateAhead)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_CbsPduMsg_t sadfd;
+    hzl_CbsPduMsg_t reaction;
+    hzl_CbsPduMsg_t renewalPdus[1];
+    size_t amountOfRenewalPdus;
+    hzl_RxSduMsg_t sdu;
+    const uint8_t sadData[HZL_BENCH_RENEWAL_LATENCY_SDU_LEN] = {1, 2, 3, 4, 5, 6, 7, 8};
+    uint64_t renewingTotalNanos = 0;
+    size_t renewing = 0;
+
+    for (size_t i = 0; i < HZL_BENCH_RENEWAL_LATENCY_FRAMES; i++)
+    {
+        err = hzl_ClientBuildSecuredFd(&sadfd, bus->alice, sadData, sizeof(sadData),
+                                       HZL_BENCH_GID);
+        HZL_ERR_CHECK(err);
+        const uint64_t start = hzlBench_NowNanos();
+        err = hzl_ServerProcessReceived(&reaction, &sdu, bus->server, sadfd.data, sadfd.dataLen,
+                                        HZL_BENCH_CAN_ID);
+        nanos[i] = (uint32_t) (hzlBench_NowNanos() - start);
+        HZL_ERR_CHECK(err);
+        if (reaction.dataLen > 0)
+        {
+            renewingTotalNanos += nanos[i];
+            renewing++;
+        }
+        // The renewal handshake is part of the traffic, but not of the measured latency
+        err = hzlBench_BusDeliverServerReaction(bus, &reaction);
+        HZL_ERR_CHECK(err);
+        if (generateAhead)
+        {
+            hzl_Timestamp_t now;
+            err = bus->server->io.currentTime(&now);
+            HZL_ERR_CHECK(err);
+            err = hzl_ServerTick(renewalPdus, &amountOfRenewalPdus, bus->server, 1U, now);
+            HZL_ERR_CHECK(err);
+            if (amountOfRenewalPdus > 0)
+            {
+                err = hzlBench_BusDeliverServerReaction(bus, &renewalPdus[0]);
+                HZL_ERR_CHECK(err);
+            }
+        }
+    }
+    *renewingNanos = renewing > 0 ? (double) renewingTotalNanos / (double) renewing : 0;
+    return HZL_OK;
+}
+
+static hzl_Err_t
+hzlBench_RenewalLatencyReport(const char* const label,
+                              uint32_t* const nanos,
+                              const bool generateAhead)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_Bus_t bus = {0};
+    hzl_ServerTimerWheel_t* timerWheel = NULL;
+    double renewingNanos = 0;
+
+    err = hzlBench_BusInit(&bus);
+    HZL_ERR_CLEANUP(err);
+    // Here we force the configuration to be writable, to expire the Session more often.
+    // Its hot copy is the configuration itself, unless the Group states are split.
+    ((hzl_ServerGroupHotConfig_t*) hzl_ServerGroupHotConfig(bus.server, HZL_BENCH_GID))
+            ->ctrNonceUpperLimit = HZL_BENCH_RENEWAL_LATENCY_PERIOD;
+    if (!generateAhead)
+    {
+        // Without the timer wheel, hzl_ServerTick() is unavailable
+        timerWheel = bus.server->timerWheel;
+        bus.server->timerWheel = NULL;
+    }
+    err = hzlBench_RenewalLatencyRun(nanos, &renewingNanos, &bus, generateAhead);
+    HZL_ERR_CLEANUP(err);
+    qsort(nanos, HZL_BENCH_RENEWAL_LATENCY_FRAMES, sizeof(uint32_t),
+          hzlBench_RenewalLatencyCompare);
+    printf("%-40s p50 %7u ns | p99 %7u ns | p99.9 %7u ns | max %8u ns | renewing %8.0f ns\n",
+           label,
+           hzlBench_RenewalLatencyPercentile(nanos, 50.0),
+           hzlBench_RenewalLatencyPercentile(nanos, 99.0),
+           hzlBench_RenewalLatencyPercentile(nanos, 99.9),
+           nanos[HZL_BENCH_RENEWAL_LATENCY_FRAMES - 1U],
+           renewingNanos);
+cleanup:
+    if (timerWheel != NULL) { bus.server->timerWheel = timerWheel; }
+    hzlBench_BusTeardown(&bus);
+    return err;
+}
+
+int
+hzlBench_RenewalLatency(void)
+{
+    HZL_ERR_DECLARE(err);
+    uint32_t* const nanos = malloc(HZL_BENCH_RENEWAL_LATENCY_FRAMES * sizeof(uint32_t));
+
+    if (nanos == NULL)
+    {
+        err = HZL_ERR_MALLOC_FAILED;
+        HZL_ERR_CLEANUP(err);
+    }
+    printf("SADFD %u B processed by the Server, Session expiring every %u messages:\n",
+           HZL_BENCH_RENEWAL_LATENCY_SDU_LEN, HZL_BENCH_RENEWAL_LATENCY_PERIOD);
+    err = hzlBench_RenewalLatencyReport("  next STK generated on expiry (before)", nanos, false);
+    HZL_ERR_CLEANUP(err);
+    err = hzlBench_RenewalLatencyReport("  next STK generated ahead (after)", nanos, true);
+    HZL_ERR_CLEANUP(err);
+cleanup:
+    free(nanos);
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
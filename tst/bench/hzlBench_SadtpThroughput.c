@@ -0,0 +1,180 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Throughput of SADTP messages: long user data secured once and segmented over many frames.
+ *
+ * Alice transmits 1 KiB and 4 KiB messages to the Server, either on classic CAN frames
+ * (8 B) or on CAN FD frames (64 B). Transmission (hzl_ClientBuildSecuredTpStart() and all
+ * hzl_ClientBuildSecuredTpNext() calls) and reception (hzl_ServerProcessReceivedInPlace()
+ * of all frames) are measured separately, reported per byte of user data and per frame.
+ */
+
+#include "hzlBench.h"
+#include "hzl_CommonAead.h"
+#include "hzl_CommonPayload.h"
+
+#include <string.h>
+
+#if HZL_SADTP
+
+/** User data transmitted per measurement, regardless of the message length. */
+#define HZL_BENCH_SADTP_TOTAL_BYTES (2U * 1024U * 1024U)
+/** Most frames of one message: all the metadata and user data in 1-byte segments. */
+#define HZL_BENCH_SADTP_MAX_FRAMES (HZL_SADTP_MSG_LEN(HZL_SADTP_MAX_SDU_LEN))
+
+static const size_t hzlBench_SadtpThroughputSduLens[] = {1024, 4096};
+static const size_t hzlBench_SadtpThroughputFrameLens[] = {8, HZL_MAX_CAN_FD_DATA_LEN};
+
+static hzl_CbsPduMsg_t hzlBench_sadtpFrames[HZL_BENCH_SADTP_MAX_FRAMES];
+static uint8_t hzlBench_sadtpPlaintext[HZL_SADTP_MAX_SDU_LEN];
+static uint8_t hzlBench_sadtpUserData[HZL_SADTP_MAX_SDU_LEN];
+
+static void
+hzlBench_SadtpThroughputReport(const char* const label,
+                               const size_t sduLen,
+                               const size_t frameLen,
+                               const size_t frames,
+                               const uint64_t elapsedNanos,
+                               const uint64_t elapsedCycles)
+{
+    const double mibPerSec = (double) HZL_BENCH_SADTP_TOTAL_BYTES / (1024.0 * 1024.0)
+                             / ((double) elapsedNanos / 1e9);
+    printf("  %-9s %4zu B in %2zu B frames: %8.1f MiB/s | %7.1f ns/frame | ",
+           label, sduLen, frameLen, mibPerSec, (double) elapsedNanos / (double) frames);
+    if (elapsedCycles == 0)
+    {
+        printf("cycles/byte n/a\n");
+    }
+    else
+    {
+        printf("%6.1f cycles/byte\n",
+               (double) elapsedCycles / (double) HZL_BENCH_SADTP_TOTAL_BYTES);
+    }
+}
+
+static hzl_Err_t
+hzlBench_SadtpThroughputRun(const size_t sduLen,
+                            const size_t frameLen)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_Bus_t bus = {0};
+    hzl_SadtpTx_t tx;
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduView_t sdu;
+    hzl_Timestamp_t now;
+    size_t totalFrames = 0;
+    uint64_t txNanos = 0;
+    uint64_t txCycles = 0;
+    uint64_t rxNanos = 0;
+    uint64_t rxCycles = 0;
+
+    err = hzlBench_BusInit(&bus);
+    HZL_ERR_CLEANUP(err);
+    for (size_t i = 0; i < sduLen; i++) { hzlBench_sadtpPlaintext[i] = (uint8_t) i; }
+    for (size_t msg = 0; msg < HZL_BENCH_SADTP_TOTAL_BYTES / sduLen; msg++)
+    {
+        // The user data is encrypted in place: restore it outside of the measurement
+        memcpy(hzlBench_sadtpUserData, hzlBench_sadtpPlaintext, sduLen);
+        size_t frames = 0;
+        uint64_t startNanos = hzlBench_NowNanos();
+        uint64_t startCycles = hzlBench_NowCycles();
+        err = hzl_ClientBuildSecuredTpStart(&tx, bus.alice, hzlBench_sadtpUserData, sduLen,
+                                            HZL_BENCH_GID, frameLen);
+        while (err == HZL_OK && !tx.isDone)
+        {
+            err = hzl_ClientBuildSecuredTpNext(&hzlBench_sadtpFrames[frames++], &tx);
+        }
+        txCycles += hzlBench_NowCycles() - startCycles;
+        txNanos += hzlBench_NowNanos() - startNanos;
+        HZL_ERR_CLEANUP(err);
+
+        err = bus.server->io.currentTime(&now);
+        HZL_ERR_CLEANUP(err);
+        startNanos = hzlBench_NowNanos();
+        startCycles = hzlBench_NowCycles();
+        for (size_t i = 0; i < frames && err == HZL_OK; i++)
+        {
+            err = hzl_ServerProcessReceivedInPlace(
+                    &reaction, &sdu, bus.server, hzlBench_sadtpFrames[i].data,
+                    hzlBench_sadtpFrames[i].dataLen, HZL_BENCH_CAN_ID, now);
+        }
+        rxCycles += hzlBench_NowCycles() - startCycles;
+        rxNanos += hzlBench_NowNanos() - startNanos;
+        HZL_ERR_CLEANUP(err);
+        if (!sdu.isForUser || sdu.dataLen != sduLen
+            || memcmp(sdu.data, hzlBench_sadtpPlaintext, sduLen) != 0)
+        {
+            printf("Fail | %s: reassembled user data differs\n", __func__);
+            err = HZL_ERR_PROGRAMMING;
+            goto cleanup;
+        }
+        // Session renewals are part of the traffic, but not of the measured SADTP cost
+        err = hzlBench_BusDeliverServerReaction(&bus, &reaction);
+        HZL_ERR_CLEANUP(err);
+        totalFrames += frames;
+    }
+    hzlBench_SadtpThroughputReport("Alice TX", sduLen, frameLen, totalFrames, txNanos, txCycles);
+    hzlBench_SadtpThroughputReport("Server RX", sduLen, frameLen, totalFrames, rxNanos,
+                                   rxCycles);
+cleanup:
+    hzlBench_BusTeardown(&bus);
+    return err;
+}
+
+#endif  /* HZL_SADTP */
+
+int
+hzlBench_SadtpThroughput(void)
+{
+#if HZL_SADTP
+    HZL_ERR_DECLARE(err);
+
+    printf("SADTP throughput, %s, %u KiB of user data per measurement:\n",
+           HZL_AEAD_BACKEND_NAME, HZL_BENCH_SADTP_TOTAL_BYTES / 1024U);
+    for (size_t s = 0; s < sizeof(hzlBench_SadtpThroughputSduLens) / sizeof(size_t); s++)
+    {
+        for (size_t f = 0; f < sizeof(hzlBench_SadtpThroughputFrameLens) / sizeof(size_t); f++)
+        {
+            if (hzlBench_SadtpThroughputSduLens[s] > HZL_SADTP_MAX_SDU_LEN) { continue; }
+            err = hzlBench_SadtpThroughputRun(hzlBench_SadtpThroughputSduLens[s],
+                                              hzlBench_SadtpThroughputFrameLens[f]);
+            HZL_ERR_CLEANUP(err);
+        }
+    }
+cleanup:
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+#else
+    printf("SADTP throughput, %s: skipped, SADTP needs a streaming AEAD backend.\n",
+           HZL_AEAD_BACKEND_NAME);
+    return 0;
+#endif
+}
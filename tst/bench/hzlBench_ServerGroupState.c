@@ -0,0 +1,174 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cost for a Server of checking the Counter Nonce of SADFD messages spread randomly
+ * across 255 Groups, with the Group states in the layout selected by
+ * #HZL_SERVER_SPLIT_GROUP_STATE.
+ *
+ * Every message is rejected as old right after the Counter Nonce check, so the measured
+ * cost is dominated by the accesses to the Group states, not by the decryption. Build once
+ * per layout (see the `bench_hzl_group_state_layouts` target) to compare them.
+ */
+
+#include "hzlBench.h"
+#include "hzl_ServerInternal.h"
+#include "hzl_CommonHeader.h"
+#include <stdlib.h>
+
+#define HZL_BENCH_GROUP_STATE_FRAMES 1000000U
+/** 255 rather than 256 Groups, as the amount of Groups is stored in a `uint8_t`. */
+#define HZL_BENCH_GROUP_STATE_AMOUNT_OF_GROUPS 255U
+/** Length of the precomputed sequence of random GIDs, power of 2. */
+#define HZL_BENCH_GROUP_STATE_GIDS 4096U
+#define HZL_BENCH_GROUP_STATE_SID 1U
+
+/** The static storage respects the alignment of the hot Group states, if split. */
+static hzl_ServerCtx_t hzlBench_groupStateServer;
+
+/** Xorshift32: the GID sequence must not depend on the OS TRNG. */
+static void
+hzlBench_GroupStateRandomGids(hzl_Gid_t* const gids)
+{
+    uint32_t x = 0x2545F491U;
+    for (size_t i = 0; i < HZL_BENCH_GROUP_STATE_GIDS; i++)
+    {
+        x ^= x << 13U;
+        x ^= x >> 17U;
+        x ^= x << 5U;
+        gids[i] = (hzl_Gid_t) (x % HZL_BENCH_GROUP_STATE_AMOUNT_OF_GROUPS);
+    }
+}
+
+/**
+ * Server in 255 Groups, GIDs 0 to 254 each with all Clients, expecting the Counter Nonce
+ * 1 in every Group.
+ */
+static hzl_Err_t
+hzlBench_GroupStateServerInit(hzl_ServerCtx_t* const ctx,
+                              hzl_ServerConfig_t* const serverConfig,
+                              hzl_ServerGroupConfig_t* const groupConfigs,
+                              const hzl_ServerCtx_t* const template)
+{
+    HZL_ERR_DECLARE(err);
+    *serverConfig = *template->serverConfig;
+    serverConfig->amountOfGroups = HZL_BENCH_GROUP_STATE_AMOUNT_OF_GROUPS;
+    serverConfig->headerType = HZL_HEADER_0;  // 8-bit GIDs
+    for (size_t i = 0; i < HZL_BENCH_GROUP_STATE_AMOUNT_OF_GROUPS; i++)
+    {
+        groupConfigs[i] = template->groupConfigs[0];
+        groupConfigs[i].gid = (hzl_Gid_t) i;
+    }
+    ctx->serverConfig = serverConfig;
+    ctx->clientConfigs = template->clientConfigs;
+    ctx->groupConfigs = groupConfigs;
+    ctx->io = template->io;
+    err = hzl_ServerInit(ctx);
+    HZL_ERR_CHECK(err);
+    for (size_t i = 0; i < HZL_BENCH_GROUP_STATE_AMOUNT_OF_GROUPS; i++)
+    {
+        hzl_ServerGroupHot(ctx, (hzl_Gid_t) i)->currentCtrNonce = 1U;
+    }
+    return HZL_OK;
+}
+
+static hzl_Err_t
+hzlBench_GroupStateRunFrames(double* const nanosPerFrame,
+                             hzl_ServerCtx_t* const ctx,
+                             const hzl_Gid_t* const gids)
+{
+    // Header 0, ctrnonce 0, ptlen, 8 B of ctext and a tag: it's never decrypted anyway
+    uint8_t sadfd[HZL_MAX_CAN_FD_DATA_LEN] = {
+            0, HZL_BENCH_GROUP_STATE_SID, HZL_PTY_SADFD, 0, 0, 0, 8};
+    const size_t sadfdLen = 3 + 3 + 1 + 8 + 8;
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduView_t sdu;
+    hzl_Timestamp_t now = 0;
+    hzl_Err_t err = ctx->io.currentTime(&now);
+    HZL_ERR_CHECK(err);
+    // Long after the last reception, so no Counter Nonce delay is tolerated
+    const hzl_Timestamp_t rxTimestamp = now + 1000000U;
+
+    const uint64_t start = hzlBench_NowNanos();
+    for (size_t i = 0; i < HZL_BENCH_GROUP_STATE_FRAMES; i++)
+    {
+        sadfd[0] = gids[i & (HZL_BENCH_GROUP_STATE_GIDS - 1U)];
+        err = hzl_ServerProcessReceivedInPlace(
+                &reaction, &sdu, ctx, sadfd, sadfdLen, HZL_BENCH_CAN_ID, rxTimestamp);
+        if (err != HZL_ERR_SECWARN_OLD_MESSAGE)
+        {
+            return err == HZL_OK ? HZL_ERR_PROGRAMMING : err;
+        }
+    }
+    *nanosPerFrame = (double) (hzlBench_NowNanos() - start) / HZL_BENCH_GROUP_STATE_FRAMES;
+    return HZL_OK;
+}
+
+int
+hzlBench_ServerGroupState(void)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_Bus_t bus = {0};
+    hzl_ServerCtx_t* const ctx = &hzlBench_groupStateServer;
+    hzl_ServerConfig_t serverConfig;
+    hzl_ServerGroupConfig_t* const groupConfigs = calloc(
+            HZL_BENCH_GROUP_STATE_AMOUNT_OF_GROUPS, sizeof(hzl_ServerGroupConfig_t));
+    hzl_ServerGroupState_t* const groupStates = calloc(
+            HZL_BENCH_GROUP_STATE_AMOUNT_OF_GROUPS, sizeof(hzl_ServerGroupState_t));
+    hzl_Gid_t* const gids = malloc(HZL_BENCH_GROUP_STATE_GIDS * sizeof(hzl_Gid_t));
+    double nanosPerFrame = 0;
+
+    if (groupConfigs == NULL || groupStates == NULL || gids == NULL)
+    {
+        err = HZL_ERR_MALLOC_FAILED;
+        HZL_ERR_CLEANUP(err);
+    }
+    err = hzlBench_BusInit(&bus);
+    HZL_ERR_CLEANUP(err);
+    ctx->groupStates = groupStates;
+    err = hzlBench_GroupStateServerInit(ctx, &serverConfig, groupConfigs, bus.server);
+    HZL_ERR_CLEANUP(err);
+    hzlBench_GroupStateRandomGids(gids);
+    err = hzlBench_GroupStateRunFrames(&nanosPerFrame, ctx, gids);
+    HZL_ERR_CLEANUP(err);
+    printf("SADFD received by the Server in random ones of %u Groups, rejected as old:\n",
+           HZL_BENCH_GROUP_STATE_AMOUNT_OF_GROUPS);
+    hzlBench_ReportFrameCost(HZL_SERVER_SPLIT_GROUP_STATE
+                             ? "  hot/cold split Group states"
+                             : "  single Group state struct",
+                             nanosPerFrame);
+cleanup:
+    hzlBench_BusTeardown(&bus);
+    free(groupConfigs);
+    free(groupStates);
+    free(gids);
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
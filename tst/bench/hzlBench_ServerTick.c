@@ -0,0 +1,178 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cost for a Server of the time-driven Session management of 255 Groups, called every
+ * millisecond: hzl_ServerTick() with its timer wheel against scanning all Groups for
+ * expiration, as done without the wheel.
+ *
+ * The Sessions last from 60 s to about 5 min, so a few of them are renewed during the run.
+ * The simulated clock advances by 1 ms per call, to measure the library alone.
+ */
+
+#include "hzlBench.h"
+#include "hzl_ServerInternal.h"
+#include <stdlib.h>
+
+/** Simulated duration of the run, one call per millisecond. */
+#define HZL_BENCH_TICK_MILLIS 1000000U
+/** 255 rather than 256 Groups, as the amount of Groups is stored in a `uint8_t`. */
+#define HZL_BENCH_TICK_AMOUNT_OF_GROUPS 255U
+#define HZL_BENCH_TICK_MIN_SESSION_MILLIS 60000U
+#define HZL_BENCH_TICK_SESSION_MILLIS_STEP 997U
+
+static hzl_ServerCtx_t hzlBench_tickServer;
+static hzl_ServerTimerWheel_t hzlBench_tickTimerWheel;
+/** Simulated clock, shared by the Server and the benchmark loop. */
+static hzl_Timestamp_t hzlBench_tickNow;
+
+static hzl_Err_t
+hzlBench_TickCurrentTime(hzl_Timestamp_t* const timestamp)
+{
+    *timestamp = hzlBench_tickNow;
+    return HZL_OK;
+}
+
+/** Server in 255 Groups, each with a different Session duration. */
+static hzl_Err_t
+hzlBench_TickServerInit(hzl_ServerCtx_t* const ctx,
+                        hzl_ServerConfig_t* const serverConfig,
+                        hzl_ServerGroupConfig_t* const groupConfigs,
+                        const hzl_ServerCtx_t* const template)
+{
+    *serverConfig = *template->serverConfig;
+    serverConfig->amountOfGroups = HZL_BENCH_TICK_AMOUNT_OF_GROUPS;
+    for (size_t i = 0; i < HZL_BENCH_TICK_AMOUNT_OF_GROUPS; i++)
+    {
+        groupConfigs[i] = template->groupConfigs[0];
+        groupConfigs[i].gid = (hzl_Gid_t) i;
+        groupConfigs[i].sessionDurationMillis = (hzl_TimeDeltaMillis_t)
+                (HZL_BENCH_TICK_MIN_SESSION_MILLIS + i * HZL_BENCH_TICK_SESSION_MILLIS_STEP);
+        groupConfigs[i].delayBetweenRenNotificationsMillis = 1000U;
+    }
+    ctx->serverConfig = serverConfig;
+    ctx->clientConfigs = template->clientConfigs;
+    ctx->groupConfigs = groupConfigs;
+    ctx->io.trng = template->io.trng;
+    ctx->io.currentTime = hzlBench_TickCurrentTime;
+    return hzl_ServerInit(ctx);
+}
+
+static hzl_Err_t
+hzlBench_TickRunTimerWheel(double* const nanosPerTick,
+                           hzl_ServerCtx_t* const ctx)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_CbsPduMsg_t renewalPdus[HZL_BENCH_TICK_AMOUNT_OF_GROUPS];
+    size_t amount;
+    const uint64_t start = hzlBench_NowNanos();
+    for (size_t i = 0; i < HZL_BENCH_TICK_MILLIS; i++)
+    {
+        hzlBench_tickNow++;
+        err = hzl_ServerTick(renewalPdus, &amount, ctx,
+                             HZL_BENCH_TICK_AMOUNT_OF_GROUPS, hzlBench_tickNow);
+        HZL_ERR_CHECK(err);
+    }
+    *nanosPerTick = (double) (hzlBench_NowNanos() - start) / HZL_BENCH_TICK_MILLIS;
+    return HZL_OK;
+}
+
+/** Reference: every millisecond, checks every Group for a due event. */
+static hzl_Err_t
+hzlBench_TickRunLinearScan(double* const nanosPerTick,
+                           hzl_ServerCtx_t* const ctx)
+{
+    HZL_ERR_DECLARE(err);
+    hzl_CbsPduMsg_t renewalPdu;
+    const uint64_t start = hzlBench_NowNanos();
+    for (size_t i = 0; i < HZL_BENCH_TICK_MILLIS; i++)
+    {
+        hzlBench_tickNow++;
+        for (hzl_Gid_t gid = 0; gid < HZL_BENCH_TICK_AMOUNT_OF_GROUPS; gid++)
+        {
+            hzl_Timestamp_t eventInstant;
+            if (hzl_ServerSessionNextTimeEvent(&eventInstant, ctx, hzlBench_tickNow, gid)
+                && hzl_TimeDelta(eventInstant, hzlBench_tickNow) <= INT32_MAX)
+            {
+                err = hzl_ServerSessionTimeEvent(&renewalPdu, ctx, hzlBench_tickNow, gid);
+                HZL_ERR_CHECK(err);
+            }
+        }
+    }
+    *nanosPerTick = (double) (hzlBench_NowNanos() - start) / HZL_BENCH_TICK_MILLIS;
+    return HZL_OK;
+}
+
+int
+hzlBench_ServerTick(void)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_Bus_t bus = {0};
+    hzl_ServerCtx_t* const ctx = &hzlBench_tickServer;
+    hzl_ServerConfig_t serverConfig;
+    hzl_ServerGroupConfig_t* const groupConfigs = calloc(
+            HZL_BENCH_TICK_AMOUNT_OF_GROUPS, sizeof(hzl_ServerGroupConfig_t));
+    hzl_ServerGroupState_t* const groupStates = calloc(
+            HZL_BENCH_TICK_AMOUNT_OF_GROUPS, sizeof(hzl_ServerGroupState_t));
+    double nanosPerTickWheel = 0;
+    double nanosPerTickScan = 0;
+
+    if (groupConfigs == NULL || groupStates == NULL)
+    {
+        err = HZL_ERR_MALLOC_FAILED;
+        HZL_ERR_CLEANUP(err);
+    }
+    err = hzlBench_BusInit(&bus);
+    HZL_ERR_CLEANUP(err);
+    ctx->groupStates = groupStates;
+    ctx->timerWheel = &hzlBench_tickTimerWheel;
+    err = hzlBench_TickServerInit(ctx, &serverConfig, groupConfigs, bus.server);
+    HZL_ERR_CLEANUP(err);
+    err = hzlBench_TickRunTimerWheel(&nanosPerTickWheel, ctx);
+    HZL_ERR_CLEANUP(err);
+    // Same Sessions from the start, without the wheel
+    ctx->timerWheel = NULL;
+    hzlBench_tickNow = 0;
+    err = hzl_ServerInit(ctx);
+    HZL_ERR_CLEANUP(err);
+    err = hzlBench_TickRunLinearScan(&nanosPerTickScan, ctx);
+    HZL_ERR_CLEANUP(err);
+    printf("Session management of %u Groups, once per ms (cost per call):\n",
+           HZL_BENCH_TICK_AMOUNT_OF_GROUPS);
+    printf("  timer wheel: %8.1f ns\n", nanosPerTickWheel);
+    printf("  linear scan: %8.1f ns\n", nanosPerTickScan);
+cleanup:
+    hzlBench_BusTeardown(&bus);
+    (void) hzl_ServerDeInit(ctx);
+    free(groupConfigs);
+    free(groupStates);
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
@@ -0,0 +1,91 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Cost of the Server building a RES message, which needs a fresh Response nonce, with the
+ * random bytes taken directly from the OS and from the buffered CSPRNG.
+ *
+ * Alice transmits a REQ before every measurement, outside of the timed section.
+ */
+
+#include "hzlBench.h"
+
+#define HZL_BENCH_TRNG_RESPONSE_FRAMES 20000U
+
+static hzl_Err_t
+hzlBench_TrngResponseRun(double* const nanosPerFrame,
+                         const hzl_TrngFunc trng)
+{
+    HZL_ERR_DECLARE(err);
+    hzlBench_Bus_t bus = {0};
+    hzl_CbsPduMsg_t req;
+    hzl_CbsPduMsg_t res;
+    hzl_RxSduMsg_t sdu;
+    uint64_t elapsedNanos = 0;
+
+    err = hzlBench_BusInit(&bus);
+    HZL_ERR_CLEANUP(err);
+    bus.server->io.trng = trng;
+    for (size_t i = 0; i < HZL_BENCH_TRNG_RESPONSE_FRAMES; i++)
+    {
+        err = hzl_ClientBuildRequest(&req, bus.alice, HZL_BENCH_GID);
+        HZL_ERR_CLEANUP(err);
+        const uint64_t start = hzlBench_NowNanos();
+        err = hzl_ServerProcessReceived(&res, &sdu, bus.server, req.data, req.dataLen,
+                                        HZL_BENCH_CAN_ID);
+        HZL_ERR_CLEANUP(err);
+        elapsedNanos += hzlBench_NowNanos() - start;
+        if (res.dataLen == 0) { err = HZL_ERR_PROGRAMMING; goto cleanup; }
+    }
+    *nanosPerFrame = (double) elapsedNanos / HZL_BENCH_TRNG_RESPONSE_FRAMES;
+cleanup:
+    hzlBench_BusTeardown(&bus);
+    return err;
+}
+
+int
+hzlBench_TrngResponse(void)
+{
+    HZL_ERR_DECLARE(err);
+    double osNanos = 0;
+    double csprngNanos = 0;
+
+    err = hzlBench_TrngResponseRun(&osNanos, hzl_OsTrng);
+    HZL_ERR_CLEANUP(err);
+    err = hzlBench_TrngResponseRun(&csprngNanos, hzl_OsCsprng);
+    HZL_ERR_CLEANUP(err);
+    printf("RES build on REQ reception, Server:\n");
+    hzlBench_ReportFrameCost("  OS TRNG on every call (before)", osNanos);
+    hzlBench_ReportFrameCost("  buffered CSPRNG (after)", csprngNanos);
+    printf("  speedup: %.2fx\n", osNanos / csprngNanos);
+cleanup:
+    if (err != HZL_OK) { printf("Fail | %s: error %d\n", __func__, err); }
+    return err != HZL_OK;
+}
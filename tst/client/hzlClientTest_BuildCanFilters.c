@@ -0,0 +1,176 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Tests of the hzl_ClientBuildCanFilters() function.
+ */
+
+#include "hzlTest.h"
+
+#if HZL_OS_AVAILABLE_LINUX
+
+static void
+hzlClientTest_ClientBuildCanFiltersOutputsMustBeNotNull(void)
+{
+    hzl_Err_t err;
+    struct can_filter filters[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    size_t amountOfFilters = 123;
+
+    err = hzl_ClientBuildCanFilters(NULL, &amountOfFilters, 3, NULL);
+    atto_eq(err, HZL_ERR_NULL_CAN_FILTERS);
+    err = hzl_ClientBuildCanFilters(filters, NULL, 3, NULL);
+    atto_eq(err, HZL_ERR_NULL_CAN_FILTERS);
+    err = hzl_ClientBuildCanFilters(filters, &amountOfFilters, 3, NULL);
+    atto_eq(err, HZL_ERR_NULL_CTX);
+    atto_eq(amountOfFilters, 0);
+}
+
+static void
+hzlClientTest_ClientBuildCanFiltersPassAllWithHeaderInPayload(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &HZL_TEST_CORRECT_CLIENT_CONFIG,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ClientInit(&ctx);
+    atto_eq(err, HZL_OK);
+    struct can_filter filters[1];
+    size_t amountOfFilters = 0;
+    // Requirement for this test: the header is in the payload
+    atto_eq(ctx.clientConfig->headerPlacement, HZL_HEADER_IN_PAYLOAD);
+
+    err = hzl_ClientBuildCanFilters(filters, &amountOfFilters, 1, &ctx);
+
+    atto_eq(err, HZL_OK);
+    atto_eq(amountOfFilters, 1);
+    atto_eq(filters[0].can_id, 0);
+    atto_eq(filters[0].can_mask, 0);
+}
+
+static void
+hzlClientTest_ClientBuildCanFiltersOnePerGroupWithHeaderInCanId(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientConfig_t clientConfigWithHeaderInCanId = HZL_TEST_CORRECT_CLIENT_CONFIG;
+    clientConfigWithHeaderInCanId.headerPlacement = HZL_HEADER_IN_CAN_ID;
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &clientConfigWithHeaderInCanId,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ClientInit(&ctx);
+    atto_eq(err, HZL_OK);
+    struct can_filter filters[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    size_t amountOfFilters = 123;
+    // Requirement for this test: the header 0 is 3 bytes long, GID in the first one
+    atto_eq(ctx.clientConfig->headerType, HZL_HEADER_0);
+
+    err = hzl_ClientBuildCanFilters(filters, &amountOfFilters,
+                                    HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS - 1, &ctx);
+    atto_eq(err, HZL_ERR_TOO_SHORT_OUTPUT_BUFFER);
+    atto_eq(amountOfFilters, 0);
+
+    err = hzl_ClientBuildCanFilters(filters, &amountOfFilters,
+                                    HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, &ctx);
+
+    atto_eq(err, HZL_OK);
+    atto_eq(amountOfFilters, HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS);
+    const canid_t expectedMask = 0xFFUL << 16U | CAN_EFF_FLAG | CAN_RTR_FLAG;
+    for (size_t i = 0; i < HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS; i++)
+    {
+        const canid_t gid = ctx.groupConfigs[i].gid;
+        atto_eq(filters[i].can_id, gid << 16U | CAN_EFF_FLAG);
+        atto_eq(filters[i].can_mask, expectedMask);
+    }
+}
+
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
+static void
+hzlClientTest_ClientBuildCanFiltersMatchOnlyOwnGroups(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientConfig_t clientConfigWithMixedHeader = HZL_TEST_CORRECT_CLIENT_CONFIG;
+    clientConfigWithMixedHeader.headerType = HZL_HEADER_4;
+    clientConfigWithMixedHeader.headerPlacement = HZL_HEADER_MIXED;
+    clientConfigWithMixedHeader.sid = 3;
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &clientConfigWithMixedHeader,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ClientInit(&ctx);
+    atto_eq(err, HZL_OK);
+    struct can_filter filters[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    size_t amountOfFilters = 0;
+    err = hzl_ClientBuildCanFilters(filters, &amountOfFilters,
+                                    HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, &ctx);
+    atto_eq(err, HZL_OK);
+    // Header 4 is 1 byte long: base CAN IDs, GIDs 0, 2, 3 configured, 1 is not
+    atto_eq(amountOfFilters, HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS);
+    hzl_CbsPduMsg_t msg = {0};
+    const uint8_t userData[4] = {1, 2, 3, 4};
+
+    for (hzl_Gid_t gid = 0; gid <= 3U; gid++)
+    {
+        err = hzl_ClientBuildUnsecured(&msg, &ctx, userData, sizeof(userData), gid);
+        atto_eq(err, HZL_OK);
+        bool accepted = false;
+        for (size_t i = 0; i < amountOfFilters; i++)
+        {
+            accepted |= (msg.canId & filters[i].can_mask)
+                        == (filters[i].can_id & filters[i].can_mask);
+        }
+        atto_eq(accepted, gid != 1U);
+    }
+}
+#endif
+
+#endif  /* HZL_OS_AVAILABLE_LINUX */
+
+void hzlClientTest_ClientBuildCanFilters(void)
+{
+#if HZL_OS_AVAILABLE_LINUX
+    hzlClientTest_ClientBuildCanFiltersOutputsMustBeNotNull();
+    hzlClientTest_ClientBuildCanFiltersPassAllWithHeaderInPayload();
+    hzlClientTest_ClientBuildCanFiltersOnePerGroupWithHeaderInCanId();
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
+    hzlClientTest_ClientBuildCanFiltersMatchOnlyOwnGroups();
+#endif
+    HZL_TEST_PARTIAL_REPORT();
+#endif  /* HZL_OS_AVAILABLE_LINUX */
+}
@@ -29,7 +29,7 @@
 /**
  * @file
  * @internal
- * Tests of the hzl_ClientBuildSecuredFd() function.
+ * Tests of the hzl_ClientBuildSecuredFd() and hzl_ClientBuildSecuredFdInto() functions.
  *
  * @warning
  * REDUCING COVERAGE ON PURPOSE. NOT implementing all the testcases for all possible incorrect
@@ -101,6 +101,7 @@ hzlClientTest_ClientBuildSecuredFdDataLenMustBeShortEnough(void)
     // Dummy established-session state
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 99;
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {1, 2, 3, 4};
     size_t userDataLen;
@@ -116,6 +117,7 @@ hzlClientTest_ClientBuildSecuredFdDataLenMustBeShortEnough(void)
     atto_eq(err, HZL_ERR_TOO_LONG_SDU);
 }
 
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
 static void
 hzlClientTest_ClientBuildSecuredFdDataLenDependsOnHeaderLen(void)
 {
@@ -137,6 +139,7 @@ hzlClientTest_ClientBuildSecuredFdDataLenDependsOnHeaderLen(void)
     // Dummy established-session state
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 99;
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {1, 2, 3, 4};
     size_t userDataLen;
@@ -172,6 +175,7 @@ hzlClientTest_ClientBuildSecuredFdCompactHeaderPreventsTooManyGroups(void)
     // Dummy established-session state
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 99;
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {1, 2, 3, 4};
     size_t userDataLen = 4;
@@ -182,6 +186,7 @@ hzlClientTest_ClientBuildSecuredFdCompactHeaderPreventsTooManyGroups(void)
 
     atto_eq(err, HZL_ERR_GID_TOO_LARGE_FOR_CONFIGURED_HEADER_TYPE);
 }
+#endif
 
 static void
 hzlClientTest_ClientBuildSecuredFdGidMustBeInConfig(void)
@@ -251,6 +256,7 @@ hzlClientTest_ClientBuildSecuredFdHeaderIsPackedBeforePayload(void)
     // Dummy established-session state
     groupStates[0].currentCtrNonce = 0x112233;
     groupStates[0].currentStk[0] = 99;
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {1, 2, 3, 4};
     size_t userDataLen = 4;
@@ -278,6 +284,7 @@ hzlClientTest_ClientBuildSecuredFdHeaderIsPackedBeforePayload(void)
     atto_eq(groupStates[0].currentCtrNonce, 0x112234);
 }
 
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
 static void
 hzlClientTest_ClientBuildSecuredFdHeaderPackingDependsOnType(void)
 {
@@ -298,6 +305,7 @@ hzlClientTest_ClientBuildSecuredFdHeaderPackingDependsOnType(void)
     // Dummy established-session state
     groupStates[1].currentCtrNonce = 0x112233;  // Group with idx == 1 has GID == 2
     groupStates[1].currentStk[0] = 99;
+    groupStates[1].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {1, 2, 3, 4};
     size_t userDataLen = 4;
@@ -324,6 +332,7 @@ hzlClientTest_ClientBuildSecuredFdHeaderPackingDependsOnType(void)
     // Ctrnonce was incremented in the state
     atto_eq(groupStates[1].currentCtrNonce, 0x112234);
 }
+#endif
 
 static void
 hzlClientTest_ClientBuildSecuredFdMaxCtrnonceRequiresHandshake(void)
@@ -343,6 +352,7 @@ hzlClientTest_ClientBuildSecuredFdMaxCtrnonceRequiresHandshake(void)
     // Dummy established-session state, with expired ctrnonce, should require a new handshake
     groupStates[0].currentCtrNonce = 0xFFFFFF;
     groupStates[0].currentStk[0] = 99;
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {1, 2, 3, 4};
     size_t userDataLen = 4;
@@ -368,6 +378,7 @@ hzlClientTest_ClientBuildSecuredFdMsgWithNoPayload(void)
     // Dummy established-session state
     groupStates[0].currentCtrNonce = 0x010203;
     groupStates[0].currentStk[0] = 99;
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     size_t userDataLen = 0;
 
@@ -412,6 +423,7 @@ hzlClientTest_ClientBuildSecuredFdSuccessfully(void)
     groupStates[0].currentCtrNonce = 0x010203;
     groupStates[0].currentStk[0] = 99;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {'A', 'B', 'C', 'D', 'E'};
     size_t userDataLen = 5;
@@ -463,6 +475,7 @@ hzlClientTest_ClientBuildSecuredFdSuccessfullyUsesNewKeyDuringRenewalPhase(void)
     groupStates[0].previousCtrNonce = 0x111111;
     groupStates[0].previousStk[0] = 150;
     atto_zeros(&groupStates[0].previousStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_RENEWING;
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {'A', 'B', 'C', 'D', 'E'};
     size_t userDataLen = 5;
@@ -491,6 +504,124 @@ hzlClientTest_ClientBuildSecuredFdSuccessfullyUsesNewKeyDuringRenewalPhase(void)
     atto_eq(groupStates[0].currentCtrNonce, 0x010204);
 }
 
+static void
+hzlClientTest_ClientBuildSecuredFdIntoOutputLenMustBeNotNull(void)
+{
+    hzl_Err_t err;
+    uint8_t frame[64];
+
+    err = hzl_ClientBuildSecuredFdInto(frame, sizeof(frame), NULL, NULL, NULL, NULL, 0, 0);
+
+    atto_eq(err, HZL_ERR_NULL_PDU);
+}
+
+static void
+hzlClientTest_ClientBuildSecuredFdIntoOutputBufferMustBeLongEnough(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &HZL_TEST_CORRECT_CLIENT_CONFIG,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ClientInit(&ctx);
+    atto_eq(err, HZL_OK);
+    // Dummy established-session state
+    groupStates[0].currentCtrNonce = 0x010203;
+    groupStates[0].currentStk[0] = 99;
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
+    uint8_t frame[64];
+    size_t frameLen = 123;
+    const uint8_t userData[5] = {'A', 'B', 'C', 'D', 'E'};
+
+    // Header 0 + ctrnonce + ptlen + dataLen + tag, minus one byte
+    err = hzl_ClientBuildSecuredFdInto(frame, 3 + 3 + 1 + 5 + 8 - 1, &frameLen, NULL,
+                                       &ctx, userData, sizeof(userData), 0);
+
+    atto_eq(err, HZL_ERR_TOO_SHORT_OUTPUT_BUFFER);
+    atto_eq(frameLen, 0);
+    // Ctrnonce was not consumed
+    atto_eq(groupStates[0].currentCtrNonce, 0x010203);
+}
+
+static void
+hzlClientTest_ClientBuildSecuredFdIntoSuccessfully(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &HZL_TEST_CORRECT_CLIENT_CONFIG,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ClientInit(&ctx);
+    atto_eq(err, HZL_OK);
+    groupStates[0].currentCtrNonce = 0x010203;
+    groupStates[0].currentStk[0] = 99;
+    atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
+    // Exactly as long as the message, no more
+    uint8_t frame[3 + 3 + 1 + 5 + 8];
+    size_t frameLen = 0;
+    const uint8_t userData[5] = {'A', 'B', 'C', 'D', 'E'};
+
+    err = hzl_ClientBuildSecuredFdInto(frame, sizeof(frame), &frameLen, NULL,
+                                       &ctx, userData, sizeof(userData), 0);
+
+    atto_eq(err, HZL_OK);
+    atto_eq(frameLen, sizeof(frame));
+    // Same message as hzl_ClientBuildSecuredFd() would build
+    const uint8_t expectedPdu[3 + 3 + 1 + 5 + 8] = {
+            0, 13, 4,  // Header 0: GID, SID, PTY SADFD
+            0x03, 0x02, 0x01,  // Ctrnonce
+            5,  // Ptlen
+            0xE0, 0x04, 0xD9, 0xD9, 0x05,  // Ciphertext
+            0xAB, 0x04, 0x46, 0x61, 0x2C, 0x54, 0x37, 0x1F,  // Tag
+    };
+    atto_memeq(frame, expectedPdu, sizeof(expectedPdu));
+    // Ctrnonce was incremented in the state
+    atto_eq(groupStates[0].currentCtrNonce, 0x010204);
+}
+
+static void
+hzlClientTest_ClientBuildSecuredFdIntoCanIdMustBeNotNullWhenHeaderInCanId(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientConfig_t clientConfigWithHeaderInCanId = HZL_TEST_CORRECT_CLIENT_CONFIG;
+    clientConfigWithHeaderInCanId.headerPlacement = HZL_HEADER_IN_CAN_ID;
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &clientConfigWithHeaderInCanId,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ClientInit(&ctx);
+    atto_eq(err, HZL_OK);
+    groupStates[0].currentCtrNonce = 0x010203;
+    groupStates[0].currentStk[0] = 99;
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
+    uint8_t frame[64];
+    size_t frameLen = 0;
+    hzl_CanId_t canId = 0;
+    const uint8_t userData[5] = {'A', 'B', 'C', 'D', 'E'};
+
+    err = hzl_ClientBuildSecuredFdInto(frame, sizeof(frame), &frameLen, NULL,
+                                       &ctx, userData, sizeof(userData), 0);
+    atto_eq(err, HZL_ERR_NULL_PDU);
+
+    err = hzl_ClientBuildSecuredFdInto(frame, sizeof(frame), &frameLen, &canId,
+                                       &ctx, userData, sizeof(userData), 0);
+    atto_eq(err, HZL_OK);
+    atto_eq(canId, 0UL << 16U | 13UL << 8U | 4UL);  // Header 0: GID, SID, PTY SADFD
+    atto_eq(frameLen, 3 + 1 + 5 + 16);  // Ctrnonce + ptlen + dataLen + tag
+    atto_eq(frame[0], 0x03);  // Ctrnonce low
+    atto_eq(frame[3], 5);  // Ptlen
+}
+
 void hzlClientTest_ClientBuildSecuredFd(void)
 {
     hzlClientTest_ClientBuildSecuredFdMsgToTxMustBeNotNull();
@@ -498,14 +629,22 @@ void hzlClientTest_ClientBuildSecuredFd(void)
     hzlClientTest_ClientBuildSecuredFdRequiresAnEstablishedSession();
     hzlClientTest_ClientBuildSecuredFdMsgDataMustBeNotNullWhenPositiveDataLen();
     hzlClientTest_ClientBuildSecuredFdDataLenMustBeShortEnough();
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlClientTest_ClientBuildSecuredFdDataLenDependsOnHeaderLen();
     hzlClientTest_ClientBuildSecuredFdCompactHeaderPreventsTooManyGroups();
+#endif
     hzlClientTest_ClientBuildSecuredFdGidMustBeInConfig();
     hzlClientTest_ClientBuildSecuredFdHeaderIsPackedBeforePayload();
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlClientTest_ClientBuildSecuredFdHeaderPackingDependsOnType();
+#endif
     hzlClientTest_ClientBuildSecuredFdMaxCtrnonceRequiresHandshake();
     hzlClientTest_ClientBuildSecuredFdMsgWithNoPayload();
     hzlClientTest_ClientBuildSecuredFdSuccessfully();
     hzlClientTest_ClientBuildSecuredFdSuccessfullyUsesNewKeyDuringRenewalPhase();
+    hzlClientTest_ClientBuildSecuredFdIntoOutputLenMustBeNotNull();
+    hzlClientTest_ClientBuildSecuredFdIntoOutputBufferMustBeLongEnough();
+    hzlClientTest_ClientBuildSecuredFdIntoSuccessfully();
+    hzlClientTest_ClientBuildSecuredFdIntoCanIdMustBeNotNullWhenHeaderInCanId();
     HZL_TEST_PARTIAL_REPORT();
 }
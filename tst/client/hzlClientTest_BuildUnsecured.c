@@ -120,6 +120,7 @@ hzlClientTest_ClientBuildUnsecuredDataLenMustBeShortEnough(void)
     atto_eq(err, HZL_ERR_TOO_LONG_SDU);
 }
 
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
 static void
 hzlClientTest_ClientBuildUnsecuredDataLenDependsOnHeaderLen(void)
 {
@@ -180,6 +181,7 @@ hzlClientTest_ClientBuildUnsecuredCompactHeaderPreventsTooManyGroups(void)
 
     atto_eq(err, HZL_ERR_GID_TOO_LARGE_FOR_CONFIGURED_HEADER_TYPE);
 }
+#endif
 
 static void
 hzlClientTest_ClientBuildUnsecuredGidsNotInConfigAreAccepted(void)
@@ -250,6 +252,7 @@ hzlClientTest_ClientBuildUnsecuredHeaderIsPackedBeforePayload(void)
     atto_eq(msgToTx.data[6], 4);
 }
 
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
 static void
 hzlClientTest_ClientBuildUnsecuredHeaderPackingDependsOnType(void)
 {
@@ -288,6 +291,70 @@ hzlClientTest_ClientBuildUnsecuredHeaderPackingDependsOnType(void)
     atto_eq(msgToTx.data[3], 3);
     atto_eq(msgToTx.data[4], 4);
 }
+#endif
+
+static void
+hzlClientTest_ClientBuildUnsecuredHeaderIsPackedInCanId(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientConfig_t clientConfigWithHeaderInCanId = HZL_TEST_CORRECT_CLIENT_CONFIG;
+    clientConfigWithHeaderInCanId.headerPlacement = HZL_HEADER_IN_CAN_ID;
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &clientConfigWithHeaderInCanId,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ClientInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    const uint8_t userData[65] = {1, 2, 3, 4};
+    // Requirement for this test: the header 0 is 3 bytes long
+    atto_eq(ctx.clientConfig->headerType, HZL_HEADER_0);
+
+    err = hzl_ClientBuildUnsecured(&msgToTx, &ctx, userData, 4, 42);
+
+    atto_eq(err, HZL_OK);
+    // Packed Header 0 in the CAN ID: GID from API call, SID from client config, PTY UAD
+    atto_eq(msgToTx.canId, 42UL << 16U | 13UL << 8U | 5UL);
+    // CBS UAD-Payload from the first byte
+    atto_eq(msgToTx.dataLen, 4);
+    atto_memeq(msgToTx.data, userData, 4);
+    // The whole frame is available for the user data
+    err = hzl_ClientBuildUnsecured(&msgToTx, &ctx, userData, 64, 42);
+    atto_eq(err, HZL_OK);
+    err = hzl_ClientBuildUnsecured(&msgToTx, &ctx, userData, 65, 42);
+    atto_eq(err, HZL_ERR_TOO_LONG_SDU);
+}
+
+static void
+hzlClientTest_ClientBuildUnsecuredMixedHeaderKeepsPtyInPayload(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientConfig_t clientConfigWithMixedHeader = HZL_TEST_CORRECT_CLIENT_CONFIG;
+    clientConfigWithMixedHeader.headerPlacement = HZL_HEADER_MIXED;
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &clientConfigWithMixedHeader,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ClientInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    const uint8_t userData[4] = {1, 2, 3, 4};
+
+    err = hzl_ClientBuildUnsecured(&msgToTx, &ctx, userData, 4, 42);
+
+    atto_eq(err, HZL_OK);
+    // Packed Header 0 in the CAN ID with PTY 0: same CAN ID for all messages in the Group
+    atto_eq(msgToTx.canId, 42UL << 16U | 13UL << 8U);
+    atto_eq(msgToTx.dataLen, 1 + 4);  // PTY + dataLen
+    atto_eq(msgToTx.data[0], 5);  // PTY UAD
+    atto_memeq(&msgToTx.data[1], userData, 4);
+}
 
 void hzlClientTest_ClientBuildUnsecured(void)
 {
@@ -295,10 +362,16 @@ void hzlClientTest_ClientBuildUnsecured(void)
     hzlClientTest_ClientBuildUnsecuredCtxMustBeNotNull();
     hzlClientTest_ClientBuildUnsecuredUserDataMustBeNotNullWhenPositiveDataLen();
     hzlClientTest_ClientBuildUnsecuredDataLenMustBeShortEnough();
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlClientTest_ClientBuildUnsecuredDataLenDependsOnHeaderLen();
     hzlClientTest_ClientBuildUnsecuredCompactHeaderPreventsTooManyGroups();
+#endif
     hzlClientTest_ClientBuildUnsecuredGidsNotInConfigAreAccepted();
     hzlClientTest_ClientBuildUnsecuredHeaderIsPackedBeforePayload();
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlClientTest_ClientBuildUnsecuredHeaderPackingDependsOnType();
+#endif
+    hzlClientTest_ClientBuildUnsecuredHeaderIsPackedInCanId();
+    hzlClientTest_ClientBuildUnsecuredMixedHeaderKeepsPtyInPayload();
     HZL_TEST_PARTIAL_REPORT();
 }
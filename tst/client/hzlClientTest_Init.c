@@ -79,14 +79,52 @@ hzlClientTest_ClientInitCorrectCtxSucceeds(void)
     err = hzl_ClientInit(&ctx);
 
     atto_eq(err, HZL_OK);
+    for (size_t i = 0; i < ctx.clientConfig->amountOfGroups; i++)
+    {
+        // Everything is cleared except for the precomputed renewal phase deadline
+        atto_eq(ctx.groupStates[i].renewalPhaseEndCtrNonce,
+                2U * ctx.groupConfigs[i].maxCtrnonceDelayMsgs);
+        atto_eq(ctx.groupStates[i].sessionState, HZL_SESSION_STATE_NO_SESSION);
+        ctx.groupStates[i].renewalPhaseEndCtrNonce = 0;
+    }
     atto_zeros(ctx.groupStates,
                ctx.clientConfig->amountOfGroups * sizeof(hzl_ClientGroupState_t));
 }
 
+static void
+hzlClientTest_ClientInitFillsGroupIdxOfGid(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &HZL_TEST_CORRECT_CLIENT_CONFIG,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    memset(ctx.groupIdxOfGid, 0xAA, sizeof(ctx.groupIdxOfGid));  // Dirty, reused ctx
+    // Requirement for this test: the first 3 Groups have GIDs 0, 2, 3
+    atto_eq(ctx.clientConfig->amountOfGroups, 3);
+
+    err = hzl_ClientInit(&ctx);
+
+    atto_eq(err, HZL_OK);
+    // Index in the configs array plus one
+    atto_eq(ctx.groupIdxOfGid[0], 1);
+    atto_eq(ctx.groupIdxOfGid[2], 2);
+    atto_eq(ctx.groupIdxOfGid[3], 3);
+    // Not a member: also GID 4, which is in the configs array, but beyond amountOfGroups
+    atto_eq(ctx.groupIdxOfGid[1], 0);
+    atto_eq(ctx.groupIdxOfGid[4], 0);
+    atto_eq(ctx.groupIdxOfGid[250], 0);
+    atto_eq(ctx.groupIdxOfGid[255], 0);
+}
+
 void hzlClientTest_ClientInit(void)
 {
     hzlClientTest_ClientInitCtxMustBeNotNull();
     hzlClientTest_ClientInitGroupStatesMustBeNotNull();
     hzlClientTest_ClientInitCorrectCtxSucceeds();
+    hzlClientTest_ClientInitFillsGroupIdxOfGid();
     HZL_TEST_PARTIAL_REPORT();
 }
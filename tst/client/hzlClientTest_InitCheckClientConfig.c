@@ -109,6 +109,25 @@ hzlClientTest_ClientInitConfigHeaderTypeMustBeStandard(void)
     atto_eq(err, HZL_ERR_INVALID_HEADER_TYPE);
 }
 
+static void
+hzlClientTest_ClientInitConfigHeaderPlacementMustBeStandard(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientConfig_t incorrectConfig = HZL_TEST_CORRECT_CLIENT_CONFIG;
+    incorrectConfig.headerPlacement = HZL_HEADER_MIXED + 1U;
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &incorrectConfig,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+
+    err = hzl_ClientInit(&ctx);
+
+    atto_eq(err, HZL_ERR_INVALID_HEADER_PLACEMENT);
+}
+
 static void
 hzlClientTest_ClientInitConfigClientSidMustBeNonZero(void)
 {
@@ -221,6 +240,7 @@ void hzlClientTest_ClientInitCheckClientConfig(void)
     hzlClientTest_ClientInitConfigAmountOfGroupsMustBePositive();
     hzlClientTest_ClientInitConfigLtkMustBeNonZeros();
     hzlClientTest_ClientInitConfigHeaderTypeMustBeStandard();
+    hzlClientTest_ClientInitConfigHeaderPlacementMustBeStandard();
     hzlClientTest_ClientInitConfigClientSidMustBeNonZero();
     hzlClientTest_ClientInitConfigClientSidMustFitForHeaderType();
     hzlClientTest_ClientInitConfigClientAmountOfGroupsMustFitForHeaderType();
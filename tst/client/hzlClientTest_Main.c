@@ -36,10 +36,14 @@
 
 /**
  * Main function, running all test cases for the Client lib.
+ *
+ * With a fixed header type, runs only the ones building and processing received messages,
+ * which pack and unpack the header, skipping their cases with other header types.
  * @return 0 if all tests passed, non-zero otherwise.
  */
 int main(void)
 {
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlClientTest_ClientInit();
     hzlClientTest_ClientInitCheckClientConfig();
     hzlClientTest_ClientInitCheckGroupConfigs();
@@ -47,6 +51,8 @@ int main(void)
     hzlClientTest_ClientDeinit();
     hzlClientTest_ClientNew();
     hzlClientTest_ClientNewMsg();
+#endif
+    hzlClientTest_ClientBuildCanFilters();
     hzlClientTest_ClientBuildRequest();
     hzlClientTest_ClientBuildUnsecured();
     hzlClientTest_ClientBuildSecuredFd();
@@ -56,6 +62,7 @@ int main(void)
     hzlClientTest_ClientProcessReceivedRequest();
     hzlClientTest_ClientProcessReceivedResponse();
     hzlClientTest_ClientProcessReceivedRenewal();
+    hzlClientTest_ClientSecuredTp();
     HZL_TEST_PARTIAL_REPORT();
     return atto_at_least_one_fail;
 }
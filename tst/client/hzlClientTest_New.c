@@ -103,9 +103,11 @@ hzlClientTest_ClientNewFileMustHaveValidConfig(void)
 
     err = hzl_ClientNew(&ctx, "clientconfigfiles/invalidSid.hzl");
     atto_eq(err, HZL_ERR_SERVER_SID_ASSIGNED_TO_CLIENT);
+    atto_eq(ctx, NULL);  // Rejected while decoding, before allocating
 
     err = hzl_ClientNew(&ctx, "clientconfigfiles/missingGidZero.hzl");
     atto_eq(err, HZL_ERR_MISSING_GID_0);
+    atto_eq(ctx, NULL);  // Rejected while decoding, after allocating
 
     err = hzl_ClientNew(&ctx, "clientconfigfiles/invalidMaxCtrnonceDelay.hzl");
     atto_eq(err, HZL_ERR_INVALID_MAX_CTRNONCE_DELAY);
@@ -138,8 +140,20 @@ hzlClientTest_ClientNewFileAliceIsAccepted(void)
     atto_eq(ctx->groupConfigs[2].maxSilenceIntervalMillis, 5002);
     atto_eq(ctx->groupConfigs[2].sessionRenewalDurationMillis, 5000);
     atto_eq(ctx->groupConfigs[2].gid, 3);
-    atto_zeros(ctx->groupStates,
-               ctx->clientConfig->amountOfGroups * sizeof(hzl_ClientGroupState_t));
+    // States are initialised as by hzl_ClientInit(): no Session yet
+    for (size_t i = 0; i < ctx->clientConfig->amountOfGroups; i++)
+    {
+        atto_eq(ctx->groupStates[i].sessionState, HZL_SESSION_STATE_NO_SESSION);
+        atto_eq(ctx->groupStates[i].requestNonce, 0);
+        atto_eq(ctx->groupStates[i].currentCtrNonce, 0);
+        atto_zeros(ctx->groupStates[i].currentStk, HZL_STK_LEN);
+        atto_eq(ctx->groupStates[i].renewalPhaseEndCtrNonce,
+                2U * ctx->groupConfigs[i].maxCtrnonceDelayMsgs);
+    }
+    atto_eq(ctx->groupIdxOfGid[0], 1);
+    atto_eq(ctx->groupIdxOfGid[1], 0);
+    atto_eq(ctx->groupIdxOfGid[2], 2);
+    atto_eq(ctx->groupIdxOfGid[3], 3);
     atto_neq(ctx->io.trng, NULL);
     atto_neq(ctx->io.currentTime, NULL);
 
@@ -179,6 +193,34 @@ hzlClientTest_ClientNewOsIoFunctionsWork(void)
     atto_neq(ctx->groupStates[0].requestNonce, 0);
 }
 
+static void
+hzlClientTest_ClientNewLaysOutOneAlignedArena(void)
+{
+    hzl_Err_t err;
+    hzl_ClientCtx_t* ctx = NULL;
+
+    err = hzl_ClientNew(&ctx, "clientconfigfiles/Alice.hzl");
+
+    atto_eq(err, HZL_OK);
+    // The context and its arrays in access order, each on its own cache line
+    const uintptr_t regions[] = {
+            (uintptr_t) ctx,
+            (uintptr_t) ctx->clientConfig,
+            (uintptr_t) ctx->groupConfigs,
+            (uintptr_t) ctx->groupStates,
+    };
+    for (size_t i = 0; i < sizeof(regions) / sizeof(regions[0]); i++)
+    {
+        atto_eq(regions[i] % HZL_CACHE_LINE_LEN, 0);
+        atto_lt(regions[i], (uintptr_t) ctx + ctx->arenaLen);
+        if (i > 0) { atto_lt(regions[i - 1], regions[i]); }
+    }
+    atto_eq(ctx->arenaLen % HZL_CACHE_LINE_LEN, 0);
+
+    hzl_ClientFree(&ctx);
+    atto_eq(ctx, NULL);
+}
+
 #endif  /* HZL_OS_AVAILABLE */
 
 void hzlClientTest_ClientNew(void)
@@ -193,6 +235,7 @@ void hzlClientTest_ClientNew(void)
     hzlClientTest_ClientNewFileAliceIsAccepted();
     hzlClientTest_ClientNewBobAndCharlieAreAccepted();
     hzlClientTest_ClientNewOsIoFunctionsWork();
+    hzlClientTest_ClientNewLaysOutOneAlignedArena();
     HZL_TEST_PARTIAL_REPORT();
 #endif  /* HZL_OS_AVAILABLE */
 }
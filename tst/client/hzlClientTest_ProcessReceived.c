@@ -133,6 +133,7 @@ hzlClientTest_ClientProcessReceivedMsgMustHaveEnoughDataLenForCbsHeader0(void)
     atto_zeros(&msgToTx, sizeof(hzl_CbsPduMsg_t)); // No msg to transmit
 }
 
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
 static void
 hzlClientTest_ClientProcessReceivedMsgMustHaveEnoughDataLenForCbsHeader4(void)
 {
@@ -169,6 +170,7 @@ hzlClientTest_ClientProcessReceivedMsgMustHaveEnoughDataLenForCbsHeader4(void)
     atto_eq(err, HZL_OK);
     atto_zeros(&msgToTx, sizeof(hzl_CbsPduMsg_t)); // No msg to transmit
 }
+#endif
 
 static void
 hzlClientTest_ClientProcessReceivedMsgMustHaveKnownPtyField(void)
@@ -235,7 +237,9 @@ void hzlClientTest_ClientProcessReceived(void)
     hzlClientTest_ClientProcessReceivedCtxMustNotBeNull();
     hzlClientTest_ClientProcessReceivedRxDataMustNotBeNullWhenPositiveDataLen();
     hzlClientTest_ClientProcessReceivedMsgMustHaveEnoughDataLenForCbsHeader0();
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlClientTest_ClientProcessReceivedMsgMustHaveEnoughDataLenForCbsHeader4();
+#endif
     hzlClientTest_ClientProcessReceivedMsgMustHaveKnownPtyField();
     hzlClientTest_ClientProcessReceivedMsgMustNotHaveReceiversSid();
     HZL_TEST_PARTIAL_REPORT();
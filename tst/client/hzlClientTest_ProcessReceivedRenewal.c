@@ -57,6 +57,7 @@ hzlClientTest_ClientProcessReceivedRenewalMsgMustHaveKnownGid(void)
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 1;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     size_t rxPduLen = 64;
@@ -95,6 +96,7 @@ hzlClientTest_ClientProcessReceivedRenewalMsgMustComeFromServer(void)
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 1;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     size_t rxPduLen = 64;
@@ -133,6 +135,7 @@ hzlClientTest_ClientProcessReceivedRenewalMsgMustBeLongEnough(void)
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 1;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     size_t rxPduLen;
@@ -210,6 +213,7 @@ hzlClientTest_ClientProcessReceivedRenewalReceiverMustNotBeInHandshake(void)
     // Dummy established-session state but ongoing handshake
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 1;
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     groupStates[0].requestNonce = 13; // non-zero
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
@@ -250,6 +254,7 @@ hzlClientTest_ClientProcessReceivedRenewalReceiverMustNotBeInRenewalPhase(void)
     groupStates[0].previousCtrNonce = 0;
     groupStates[0].previousStk[0] = 111;
     atto_zeros(&groupStates[0].previousStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_RENEWING;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     size_t rxPduLen = 64;
@@ -285,6 +290,7 @@ hzlClientTest_ClientProcessReceivedRenewalReceiverMustNotHaveExpiredCtrNonce(voi
     groupStates[0].currentCtrNonce = 0xFFFFFF;
     groupStates[0].currentStk[0] = 1;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     size_t rxPduLen = 64;
@@ -319,6 +325,7 @@ hzlClientTest_ClientProcessReceivedRenewalMsgMustHaveNonExpiredCtrnonce(void)
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 1;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     size_t rxPduLen = 64;
@@ -357,6 +364,7 @@ hzlClientTest_ClientProcessReceivedRenewalMsgMustHaveFreshCtrnonce(void)
     groupStates[0].currentCtrNonce = 0x001000;
     groupStates[0].currentStk[0] = 1;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     size_t rxPduLen = 64;
@@ -391,6 +399,7 @@ hzlClientTest_ClientProcessReceivedRenewalMsgWithValidTagSuccessfully(void)
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 1;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     size_t rxPduLen = 64;
@@ -422,6 +431,7 @@ hzlClientTest_ClientProcessReceivedRenewalMsgWithValidTagSuccessfully(void)
     atto_gt(groupStates[0].currentRxLastMessageInstant, previousunpackedMsgTimestamp);
     // Old session information is backed up
     atto_memeq(groupStates[0].previousStk, groupStates[0].currentStk, 16);
+    atto_eq(groupStates[0].sessionState, HZL_SESSION_STATE_RENEWING);
     atto_eq(groupStates[0].previousCtrNonce, groupStates[0].currentCtrNonce);
     // A request message is ready to transmit
     // Header 0 + reqnonce + tag
@@ -450,6 +460,7 @@ hzlClientTest_ClientProcessReceivedRenewalMsgIsIgnoredIfNotFirst(void)
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 1;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     size_t rxPduLen = 64;
@@ -386,6 +386,7 @@ hzlClientTest_ClientProcessReceivedResponseMsgWithValidTagSuccessfully(void)
     // Internal state has the session information ready
     atto_eq(groupStates[0].currentCtrNonce, 0x112233);
     atto_memeq(groupStates[0].currentStk, "The session key!", 16);
+    atto_eq(groupStates[0].sessionState, HZL_SESSION_STATE_ACTIVE);
 
     // New timestamps are saved
     atto_gt(groupStates[0].currentRxLastMessageInstant, timestampOfReqTx);
@@ -29,7 +29,8 @@
 /**
  * @file
  * @internal
- * Tests of the hzl_ClientProcessReceived() function for the SADFD messages.
+ * Tests of the hzl_ClientProcessReceived() and hzl_ClientProcessReceivedInPlace() functions
+ * for the SADFD messages.
  *
  * @warning
  * REDUCING COVERAGE ON PURPOSE. NOT implementing all the testcases for all possible incorrect
@@ -57,6 +58,7 @@ hzlClientTest_ClientProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader0(vo
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 99;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     uint8_t rxPdu[64] = {
@@ -82,6 +84,7 @@ hzlClientTest_ClientProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader0(vo
 }
 
 
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
 static void
 hzlClientTest_ClientProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader6(void)
 {
@@ -104,6 +107,7 @@ hzlClientTest_ClientProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader6(vo
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 99;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     uint8_t rxPdu[64] = {
@@ -125,6 +129,7 @@ hzlClientTest_ClientProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader6(vo
     atto_neq(err, HZL_ERR_TOO_LONG_CIPHERTEXT);
     atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);  // Tag is wrong, but other checks are passing
 }
+#endif
 
 static void
 hzlClientTest_ClientProcessReceivedSadfdMsgMustHaveKnownGid(void)
@@ -174,6 +179,7 @@ hzlClientTest_ClientProcessReceivedSadfdMsgMustBeLongEnoughForMetadata(void)
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 99;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     const uint8_t rxPdu[64] = {
@@ -216,6 +222,7 @@ hzlClientTest_ClientProcessReceivedSadfdMsgMustHaveNonExpiredCtrnonce(void)
     groupStates[0].currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 99;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     uint8_t rxPdu[64] = {
@@ -290,6 +297,7 @@ hzlClientTest_ClientProcessReceivedSadfdReceiverMustHaveNonExpiredCtrnonce(void)
     groupStates[0].currentCtrNonce = 0xFFFFFF;
     groupStates[0].currentStk[0] = 99;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     const uint8_t rxPdu[64] = {
@@ -330,6 +338,7 @@ hzlClientTest_ClientProcessReceivedSadfdMsgMustHaveFreshCtrnonce(void)
     groupStates[0].currentCtrNonce = 0xFFFF;  // Newer ctrnonce than received one
     groupStates[0].currentStk[0] = 99;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     const uint8_t rxPdu[64] = {
@@ -368,6 +377,7 @@ hzlClientTest_ClientProcessReceivedSadfdMsgWithEmptyCtextSuccessfully(void)
     groupStates[0].currentCtrNonce = 20;
     groupStates[0].currentStk[0] = 99;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     const uint8_t rxPdu[64] = {
@@ -417,6 +427,7 @@ hzlClientTest_ClientProcessReceivedSadfdMsgWithSomeCtextSuccessfully(void)
     groupStates[0].currentCtrNonce = 20;
     groupStates[0].currentStk[0] = 99;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     const uint8_t rxPdu[64] = {
@@ -462,6 +473,7 @@ hzlClientTest_ClientProcessReceivedSadfdMsgMustHaveFreshCtrnonceWithinTolerance(
     groupStates[0].currentCtrNonce = 8;
     groupStates[0].currentStk[0] = 99;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
     hzlTest_IoMockupCurrentTimeSucceeding(&groupStates[0].lastHandshakeEventInstant);
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
@@ -585,6 +597,7 @@ hzlClientTest_ClientProcessReceivedSadfdCurrentSessionAcceptedDuringRenewal(void
     groupStates[0].currentCtrNonce = 0x010200;
     groupStates[0].currentStk[0] = 99;
     atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_RENEWING;
     // Fake timestamps after receiving the RES that the REN msg triggered
     hzl_Timestamp_t lastHandshakeInstant = 0;
     hzlTest_IoMockupCurrentTimeSucceeding(&lastHandshakeInstant);
@@ -641,6 +654,7 @@ hzlClientTest_ClientProcessReceivedSadfdPreviousSessionAcceptedDuringRenewal(voi
     // Dummy new session state as obtained from a RES message
     groupStates[0].currentCtrNonce = 3;
     groupStates[0].currentStk[0] = 100;
+    groupStates[0].sessionState = HZL_SESSION_STATE_RENEWING;
     // Fake timestamps after receiving the RES that the REN msg triggered
     hzl_Timestamp_t lastHandshakeInstant = 0;
     hzlTest_IoMockupCurrentTimeSucceeding(&lastHandshakeInstant);
@@ -698,6 +712,7 @@ hzlClientTest_ClientProcessReceivedSadfdPreviousSessionRejectedAfterTooManyMsgs(
     // Dummy new session state as obtained from a RES message
     groupStates[0].currentCtrNonce = 3;
     groupStates[0].currentStk[0] = 100;
+    groupStates[0].sessionState = HZL_SESSION_STATE_RENEWING;
     // Fake timestamps after receiving the RES that the REN msg triggered
     hzl_Timestamp_t lastHandshakeInstant = 0;
     hzlTest_IoMockupCurrentTimeSucceeding(&lastHandshakeInstant);
@@ -730,6 +745,7 @@ hzlClientTest_ClientProcessReceivedSadfdPreviousSessionRejectedAfterTooManyMsgs(
     // session is deleted.
     atto_eq(groupStates[0].previousCtrNonce, 0);
     atto_zeros(groupStates[0].previousStk, HZL_STK_LEN);
+    atto_eq(groupStates[0].sessionState, HZL_SESSION_STATE_ACTIVE);
 }
 
 static void
@@ -754,6 +770,7 @@ hzlClientTest_ClientProcessReceivedSadfdPreviousSessionRejectedAfterTooMuchTime(
     // Dummy new session state as obtained from a RES message
     groupStates[0].currentCtrNonce = 3;
     groupStates[0].currentStk[0] = 100;
+    groupStates[0].sessionState = HZL_SESSION_STATE_RENEWING;
     // Fake timestamps after receiving the RES that the REN msg triggered
     hzl_Timestamp_t lastHandshakeInstant = 0;
     hzlTest_IoMockupCurrentTimeSucceeding(&lastHandshakeInstant);
@@ -790,12 +807,119 @@ hzlClientTest_ClientProcessReceivedSadfdPreviousSessionRejectedAfterTooMuchTime(
     // session is deleted.
     atto_eq(groupStates[0].previousCtrNonce, 0);
     atto_zeros(groupStates[0].previousStk, HZL_STK_LEN);
+    atto_eq(groupStates[0].sessionState, HZL_SESSION_STATE_ACTIVE);
+}
+
+static void
+hzlClientTest_ClientProcessReceivedInPlaceSadfdDecryptsOverCiphertext(void)
+{
+    hzl_Err_t err;
+    hzl_ClientConfig_t clientConfigWithNewSid = HZL_TEST_CORRECT_CLIENT_CONFIG;
+    clientConfigWithNewSid.sid = 42;  // To avoid "message from myself" error
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &clientConfigWithNewSid,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ClientInit(&ctx);
+    atto_eq(err, HZL_OK);
+    // Dummy established-session state
+    groupStates[0].currentCtrNonce = 20;
+    groupStates[0].currentStk[0] = 99;
+    atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
+    hzl_CbsPduMsg_t msgToTx;
+    memset(&msgToTx, 0xAA, sizeof(msgToTx));  // Dirty, reused buffer
+    hzl_RxSduView_t unpackedView;
+    memset(&unpackedView, 0xAA, sizeof(unpackedView));  // Dirty, reused buffer
+    uint8_t rxPdu[64] = {
+            // Header 0
+            0,  // GID
+            13,  // SID
+            4,  // PTY == SADFD
+            0x03, 0x02, 0x01,  // Ctrnonce
+            5,  // ptlen
+            0xE0, 0x04, 0xD9, 0xD9, 0x05,  // ctext: "ABCDE" in ASCII encoding
+            0xAB, 0x04, 0x46, 0x61, 0x2C, 0x54, 0x37, 0x1F,  // Tag (correct)
+    };
+    size_t rxPduLen = 64;
+    hzl_Timestamp_t now = 0;
+    err = ctx.io.currentTime(&now);
+    atto_eq(err, HZL_OK);
+
+    err = hzl_ClientProcessReceivedInPlace(&msgToTx, &unpackedView, &ctx,
+                                           rxPdu, rxPduLen, 0xABC, now);
+
+    atto_eq(err, HZL_OK);
+    atto_eq(unpackedView.canId, 0xABC);
+    atto_eq(unpackedView.dataLen, 5);
+    atto_eq(unpackedView.gid, 0);
+    atto_eq(unpackedView.sid, 13);
+    atto_true(unpackedView.wasSecured);
+    atto_true(unpackedView.isForUser);
+    // The plaintext is exactly where the ciphertext was
+    atto_eq(unpackedView.data, &rxPdu[7]);
+    atto_memeq(&rxPdu[7], "ABCDE", 5);
+    atto_eq(msgToTx.dataLen, 0); // No msg to transmit
+    // New ctrnonce is stored in state, incremented
+    atto_eq(groupStates[0].currentCtrNonce, 0x010203 + 1);
+}
+
+static void
+hzlClientTest_ClientProcessReceivedInPlaceSadfdInvalidTagClearsPlaintext(void)
+{
+    hzl_Err_t err;
+    hzl_ClientConfig_t clientConfigWithNewSid = HZL_TEST_CORRECT_CLIENT_CONFIG;
+    clientConfigWithNewSid.sid = 42;  // To avoid "message from myself" error
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &clientConfigWithNewSid,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ClientInit(&ctx);
+    atto_eq(err, HZL_OK);
+    // Dummy established-session state
+    groupStates[0].currentCtrNonce = 20;
+    groupStates[0].currentStk[0] = 99;
+    atto_zeros(&groupStates[0].currentStk[1], 15);  // The rest is zeros
+    groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduView_t unpackedView = {0};
+    uint8_t rxPdu[64] = {
+            // Header 0
+            0,  // GID
+            13,  // SID
+            4,  // PTY == SADFD
+            0x03, 0x02, 0x01,  // Ctrnonce
+            5,  // ptlen
+            0xE0, 0x04, 0xD9, 0xD9, 0x05,  // ctext: "ABCDE" in ASCII encoding
+            0xAB, 0x04, 0x46, 0x61, 0x2C, 0x54, 0x37, 0x00,  // Tag (last byte altered)
+    };
+    size_t rxPduLen = 64;
+
+    err = hzl_ClientProcessReceivedInPlace(&msgToTx, &unpackedView, &ctx,
+                                           rxPdu, rxPduLen, 0xABC, 1000);
+
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    atto_eq(unpackedView.data, NULL);
+    atto_eq(unpackedView.dataLen, 0);
+    atto_false(unpackedView.isForUser);
+    // The unauthenticated plaintext does not linger in the frame
+    atto_zeros(&rxPdu[7], 5);
+    // The state is unchanged
+    atto_eq(groupStates[0].currentCtrNonce, 20);
 }
 
 void hzlClientTest_ClientProcessReceivedSecuredFd(void)
 {
     hzlClientTest_ClientProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader0();
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlClientTest_ClientProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader6();
+#endif
     hzlClientTest_ClientProcessReceivedSadfdMsgMustHaveKnownGid();
     hzlClientTest_ClientProcessReceivedSadfdMsgMustBeLongEnoughForMetadata();
     hzlClientTest_ClientProcessReceivedSadfdMsgMustHaveNonExpiredCtrnonce();
@@ -809,5 +933,7 @@ void hzlClientTest_ClientProcessReceivedSecuredFd(void)
     hzlClientTest_ClientProcessReceivedSadfdPreviousSessionAcceptedDuringRenewal();
     hzlClientTest_ClientProcessReceivedSadfdPreviousSessionRejectedAfterTooManyMsgs();
     hzlClientTest_ClientProcessReceivedSadfdPreviousSessionRejectedAfterTooMuchTime();
+    hzlClientTest_ClientProcessReceivedInPlaceSadfdDecryptsOverCiphertext();
+    hzlClientTest_ClientProcessReceivedInPlaceSadfdInvalidTagClearsPlaintext();
     HZL_TEST_PARTIAL_REPORT();
 }
@@ -74,8 +74,44 @@ hzlClientTest_ClientProcessReceivedUadMsgSuccessfully(void)
     atto_zeros(&msgToTx, sizeof(hzl_CbsPduMsg_t)); // No msg to transmit
 }
 
+static void
+hzlClientTest_ClientProcessReceivedUadMsgWithHeaderInCanId(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientConfig_t clientConfigWithHeaderInCanId = HZL_TEST_CORRECT_CLIENT_CONFIG;
+    clientConfigWithHeaderInCanId.headerPlacement = HZL_HEADER_IN_CAN_ID;
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &clientConfigWithHeaderInCanId,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ClientInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+    uint8_t rxPdu[64] = {11, 22, 33, 44};  // Only the UAD-Payload
+    size_t rxPduLen = 4;
+    // Header 0 with GID 0, SID 42, PTY UAD; the bits above it are ignored
+    const hzl_CanId_t canId = 0x1F000000UL | 0UL << 16U | 42UL << 8U | 5UL;
+
+    err = hzl_ClientProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPdu, rxPduLen, canId);
+
+    atto_eq(err, HZL_OK);
+    atto_eq(unpackedMsg.canId, canId);
+    atto_eq(unpackedMsg.dataLen, 4);
+    atto_eq(unpackedMsg.gid, 0);
+    atto_eq(unpackedMsg.sid, 42);
+    atto_false(unpackedMsg.wasSecured);
+    atto_true(unpackedMsg.isForUser);
+    atto_memeq(unpackedMsg.data, rxPdu, 4);
+    atto_zeros(&msgToTx, sizeof(hzl_CbsPduMsg_t)); // No msg to transmit
+}
+
 void hzlClientTest_ClientProcessReceivedUnsecured(void)
 {
     hzlClientTest_ClientProcessReceivedUadMsgSuccessfully();
+    hzlClientTest_ClientProcessReceivedUadMsgWithHeaderInCanId();
     HZL_TEST_PARTIAL_REPORT();
 }
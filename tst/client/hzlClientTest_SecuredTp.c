@@ -0,0 +1,507 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Tests of the hzl_ClientBuildSecuredTpStart() and hzl_ClientBuildSecuredTpNext() functions
+ * and of the reception of the SADTP messages they build with hzl_ClientProcessReceivedAt()
+ * and hzl_ClientProcessReceivedInPlace().
+ *
+ * Two Clients share the Session of Group 0, one transmitting and one receiving.
+ */
+
+#include "hzlTest.h"
+
+#include <string.h>
+
+#if HZL_SADTP
+
+/** Frames of the longest message of the tests, split into the shortest frames. */
+#define HZLTEST_SADTP_MAX_FRAMES 300U
+
+static hzl_CbsPduMsg_t hzlClientTest_sadtpFrames[HZLTEST_SADTP_MAX_FRAMES];
+static hzl_SadtpRxPool_t hzlClientTest_sadtpTxPool;
+static hzl_SadtpRxPool_t hzlClientTest_sadtpRxPool;
+
+/** Receiving Client: same Groups as the transmitting one, different SID. */
+static const hzl_ClientConfig_t hzlClientTest_sadtpReceiverConfig = {
+        .amountOfGroups = HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS,
+        .headerType = HZL_HEADER_0,
+        .ltk = {2}, // Not all-zeros
+        .sid = 14,
+        .timeoutReqToResMillis = 5000,
+};
+
+/** Initialises the context with a dummy established Session in Group 0. */
+static void
+hzlClientTest_SadtpInit(hzl_ClientCtx_t* const ctx)
+{
+    const hzl_Err_t err = hzl_ClientInit(ctx);
+    atto_eq(err, HZL_OK);
+    ctx->groupStates[0].currentCtrNonce = 1;
+    ctx->groupStates[0].currentStk[0] = 99;
+    ctx->groupStates[0].sessionState = HZL_SESSION_STATE_ACTIVE;
+}
+
+/** Builds all frames of a SADTP message into hzlClientTest_sadtpFrames, returning how many. */
+static size_t
+hzlClientTest_SadtpBuildAll(hzl_ClientCtx_t* const ctx,
+                            uint8_t* const userData,
+                            const size_t userDataLen,
+                            const size_t maxFrameLen)
+{
+    hzl_SadtpTx_t tx;
+    hzl_Err_t err = hzl_ClientBuildSecuredTpStart(&tx, ctx, userData, userDataLen, 0,
+                                                  maxFrameLen);
+    atto_eq(err, HZL_OK);
+    size_t amount = 0;
+    while (!tx.isDone && amount < HZLTEST_SADTP_MAX_FRAMES)
+    {
+        err = hzl_ClientBuildSecuredTpNext(&hzlClientTest_sadtpFrames[amount], &tx);
+        atto_eq(err, HZL_OK);
+        atto_ge(hzlClientTest_sadtpFrames[amount].dataLen, 5);
+        atto_ge(maxFrameLen, hzlClientTest_sadtpFrames[amount].dataLen);
+        amount++;
+    }
+    atto_true(tx.isDone);
+    return amount;
+}
+
+static void
+hzlClientTest_ClientBuildSecuredTpStartChecksInputs(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &HZL_TEST_CORRECT_CLIENT_CONFIG,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ClientInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_SadtpTx_t tx;
+    uint8_t userData[16] = {1, 2, 3};
+
+    err = hzl_ClientBuildSecuredTpStart(NULL, &ctx, userData, sizeof(userData), 0, 8);
+    atto_eq(err, HZL_ERR_NULL_SADTP_TX);
+    err = hzl_ClientBuildSecuredTpStart(&tx, NULL, userData, sizeof(userData), 0, 8);
+    atto_eq(err, HZL_ERR_NULL_CTX);
+    atto_true(tx.isDone);
+    err = hzl_ClientBuildSecuredTpStart(&tx, &ctx, userData, sizeof(userData), 0, 8);
+    atto_eq(err, HZL_ERR_SESSION_NOT_ESTABLISHED);
+    atto_true(tx.isDone);
+    hzlClientTest_SadtpInit(&ctx);
+    err = hzl_ClientBuildSecuredTpStart(&tx, &ctx, NULL, 1, 0, 8);
+    atto_eq(err, HZL_ERR_NULL_SDU);
+    err = hzl_ClientBuildSecuredTpStart(&tx, &ctx, userData, HZL_SADTP_MAX_SDU_LEN + 1U, 0, 8);
+    atto_eq(err, HZL_ERR_TOO_LONG_SDU);
+    // Header 0 is 3 bytes long: with the PCI, 5 bytes are the shortest frame.
+    err = hzl_ClientBuildSecuredTpStart(&tx, &ctx, userData, sizeof(userData), 0, 4);
+    atto_eq(err, HZL_ERR_TOO_SHORT_OUTPUT_BUFFER);
+    err = hzl_ClientBuildSecuredTpStart(&tx, &ctx, userData, sizeof(userData), 1, 8);
+    atto_eq(err, HZL_ERR_UNKNOWN_GROUP);
+    atto_eq(groupStates[0].currentCtrNonce, 1);  // Not consumed by the errors
+
+    err = hzl_ClientBuildSecuredTpStart(&tx, &ctx, userData, sizeof(userData), 0, 5);
+    atto_eq(err, HZL_OK);
+    atto_false(tx.isDone);
+    atto_eq(groupStates[0].currentCtrNonce, 2);
+}
+
+static void
+hzlClientTest_ClientBuildSecuredTpNextChecksInputs(void)
+{
+    hzl_Err_t err;
+    hzl_SadtpTx_t tx = {.isDone = true};
+    hzl_CbsPduMsg_t frame = {.dataLen = 33};
+
+    err = hzl_ClientBuildSecuredTpNext(NULL, &tx);
+    atto_eq(err, HZL_ERR_NULL_PDU);
+    err = hzl_ClientBuildSecuredTpNext(&frame, NULL);
+    atto_eq(err, HZL_ERR_NULL_SADTP_TX);
+    atto_eq(frame.dataLen, 0);
+    err = hzl_ClientBuildSecuredTpNext(&frame, &tx);
+    atto_eq(err, HZL_ERR_SADTP_TX_COMPLETED);
+}
+
+static void
+hzlClientTest_ClientBuildSecuredTpFramesLayout(void)
+{
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &HZL_TEST_CORRECT_CLIENT_CONFIG,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlClientTest_SadtpInit(&ctx);
+    uint8_t userData[60] = {1, 2, 3};
+
+    // Message: 3 B ctrnonce, 2 B ptlen, 60 B ctext, 16 B tag = 81 B in 4-bytes segments
+    const size_t amount = hzlClientTest_SadtpBuildAll(&ctx, userData, sizeof(userData), 8);
+
+    atto_eq(amount, 21);
+    // Header 0: GID, SID, PTY
+    atto_eq(hzlClientTest_sadtpFrames[0].data[0], 0);
+    atto_eq(hzlClientTest_sadtpFrames[0].data[1], 13);
+    atto_eq(hzlClientTest_sadtpFrames[0].data[2], 3);  // PTY == SADTP
+    // First Frame
+    atto_eq(hzlClientTest_sadtpFrames[0].dataLen, 8);
+    atto_eq(hzlClientTest_sadtpFrames[0].data[3], 0x10);
+    atto_eq(hzlClientTest_sadtpFrames[0].data[4], 1);  // Ctrnonce
+    atto_eq(hzlClientTest_sadtpFrames[0].data[5], 0);
+    atto_eq(hzlClientTest_sadtpFrames[0].data[6], 0);
+    atto_eq(hzlClientTest_sadtpFrames[0].data[7], 60);  // Ptlen, low byte
+    atto_eq(hzlClientTest_sadtpFrames[1].data[4], 0);  // Ptlen, high byte
+    // Consecutive Frames: sequence number from 1, wrapping to 0 after 15
+    atto_eq(hzlClientTest_sadtpFrames[1].data[3], 0x21);
+    atto_eq(hzlClientTest_sadtpFrames[15].data[3], 0x2F);
+    atto_eq(hzlClientTest_sadtpFrames[16].data[3], 0x20);
+    atto_eq(hzlClientTest_sadtpFrames[17].data[3], 0x21);
+    // The last frame is shorter
+    atto_eq(hzlClientTest_sadtpFrames[20].dataLen, 5);
+    atto_eq(groupStates[0].currentCtrNonce, 2);
+}
+
+static void
+hzlClientTest_ClientSecuredTpRoundTrip(const size_t userDataLen,
+                                       const size_t maxFrameLen)
+{
+    if (userDataLen > HZL_SADTP_MAX_SDU_LEN) { return; }  // Build option set lower
+    hzl_Err_t err;
+    hzl_ClientGroupState_t txGroupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t txCtx = {
+            .clientConfig = &HZL_TEST_CORRECT_CLIENT_CONFIG,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = txGroupStates,
+            .sadtpRxPool = &hzlClientTest_sadtpTxPool,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlClientTest_SadtpInit(&txCtx);
+    hzl_ClientGroupState_t rxGroupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t rxCtx = {
+            .clientConfig = &hzlClientTest_sadtpReceiverConfig,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = rxGroupStates,
+            .sadtpRxPool = &hzlClientTest_sadtpRxPool,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlClientTest_SadtpInit(&rxCtx);
+    static uint8_t plaintext[HZL_SADTP_MAX_SDU_LEN];
+    static uint8_t userData[HZL_SADTP_MAX_SDU_LEN];
+    for (size_t i = 0; i < userDataLen; i++) { plaintext[i] = (uint8_t) (i * 7U + 1U); }
+    memcpy(userData, plaintext, userDataLen);
+
+    const size_t amount = hzlClientTest_SadtpBuildAll(&txCtx, userData, userDataLen, maxFrameLen);
+
+    hzl_CbsPduMsg_t reactionPdu;
+    hzl_RxSduView_t view;
+    for (size_t i = 0; i < amount; i++)
+    {
+        err = hzl_ClientProcessReceivedInPlace(
+                &reactionPdu, &view, &rxCtx, hzlClientTest_sadtpFrames[i].data,
+                hzlClientTest_sadtpFrames[i].dataLen, 0x123, (hzl_Timestamp_t) (10U + i));
+        atto_eq(err, HZL_OK);
+        atto_eq(reactionPdu.dataLen, 0);
+        atto_eq(view.isForUser, i == amount - 1U);
+    }
+    atto_true(view.wasSecured);
+    atto_eq(view.gid, 0);
+    atto_eq(view.sid, 13);
+    atto_eq(view.dataLen, userDataLen);
+    atto_memeq(view.data, plaintext, userDataLen);
+    atto_eq(rxGroupStates[0].currentCtrNonce, 2);
+}
+
+static void
+hzlClientTest_ClientSecuredTpRoundTrips(void)
+{
+    hzlClientTest_ClientSecuredTpRoundTrip(0, 8);
+    hzlClientTest_ClientSecuredTpRoundTrip(1, 5);
+    hzlClientTest_ClientSecuredTpRoundTrip(100, 8);
+    hzlClientTest_ClientSecuredTpRoundTrip(1024, 64);
+    hzlClientTest_ClientSecuredTpRoundTrip(1000, 8);
+    hzlClientTest_ClientSecuredTpRoundTrip(HZL_SADTP_MAX_SDU_LEN, 64);
+}
+
+static void
+hzlClientTest_ClientSecuredTpCopyingReceptionOnlyForShortMessages(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t txGroupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t txCtx = {
+            .clientConfig = &HZL_TEST_CORRECT_CLIENT_CONFIG,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = txGroupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlClientTest_SadtpInit(&txCtx);
+    hzl_ClientGroupState_t rxGroupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t rxCtx = {
+            .clientConfig = &hzlClientTest_sadtpReceiverConfig,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = rxGroupStates,
+            .sadtpRxPool = &hzlClientTest_sadtpRxPool,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlClientTest_SadtpInit(&rxCtx);
+    const uint8_t plaintext[65] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    uint8_t userData[65];
+    hzl_CbsPduMsg_t reactionPdu;
+    hzl_RxSduMsg_t msg;
+    size_t amount;
+
+    memcpy(userData, plaintext, sizeof(userData));
+    amount = hzlClientTest_SadtpBuildAll(&txCtx, userData, 64, 8);
+    for (size_t i = 0; i < amount; i++)
+    {
+        err = hzl_ClientProcessReceivedAt(
+                &reactionPdu, &msg, &rxCtx, hzlClientTest_sadtpFrames[i].data,
+                hzlClientTest_sadtpFrames[i].dataLen, 0x123, 10);
+        atto_eq(err, HZL_OK);
+    }
+    atto_true(msg.isForUser);
+    atto_eq(msg.dataLen, 64);
+    atto_memeq(msg.data, plaintext, 64);
+    atto_false(hzlClientTest_sadtpRxPool.slots[0].isBusy);  // Released after the copy
+
+    memcpy(userData, plaintext, sizeof(userData));
+    amount = hzlClientTest_SadtpBuildAll(&txCtx, userData, 65, 8);
+    // Refused with the second frame, completing the ptlen, the rest is unexpected.
+    for (size_t i = 0; i < amount; i++)
+    {
+        err = hzl_ClientProcessReceivedAt(
+                &reactionPdu, &msg, &rxCtx, hzlClientTest_sadtpFrames[i].data,
+                hzlClientTest_sadtpFrames[i].dataLen, 0x123, 10);
+        atto_eq(err, i == 0 ? HZL_OK
+                            : i == 1 ? HZL_ERR_TOO_SHORT_OUTPUT_BUFFER
+                                     : HZL_ERR_SADTP_UNEXPECTED_SEGMENT);
+        atto_false(msg.isForUser);
+    }
+    atto_zeros(&hzlClientTest_sadtpRxPool, sizeof(hzlClientTest_sadtpRxPool));
+    atto_eq(rxGroupStates[0].currentCtrNonce, 2);  // Not consumed: it can still be received
+
+    hzl_RxSduView_t view;
+    for (size_t i = 0; i < amount; i++)
+    {
+        err = hzl_ClientProcessReceivedInPlace(
+                &reactionPdu, &view, &rxCtx, hzlClientTest_sadtpFrames[i].data,
+                hzlClientTest_sadtpFrames[i].dataLen, 0x123, 10);
+        atto_eq(err, HZL_OK);
+    }
+    atto_true(view.isForUser);
+    atto_eq(view.dataLen, 65);
+    atto_memeq(view.data, plaintext, 65);
+    atto_eq(rxGroupStates[0].currentCtrNonce, 3);
+}
+
+static void
+hzlClientTest_ClientProcessReceivedSadtpChecksFrames(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &HZL_TEST_CORRECT_CLIENT_CONFIG,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlClientTest_SadtpInit(&ctx);
+    hzl_CbsPduMsg_t reactionPdu;
+    hzl_RxSduMsg_t msg;
+    uint8_t rxPdu[8] = {
+            // Header 0
+            0,  // GID
+            42,  // SID
+            3,  // PTY == SADTP
+            0x10,  // First Frame
+            0x01, 0x00, 0x00,  // Ctrnonce
+            0x40,  // Ptlen, low byte
+    };
+
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 10);
+    atto_eq(err, HZL_ERR_NULL_SADTP_POOL);
+    ctx.sadtpRxPool = &hzlClientTest_sadtpRxPool;
+    memset(ctx.sadtpRxPool, 0, sizeof(hzl_SadtpRxPool_t));
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 4, 0x123, 10);
+    atto_eq(err, HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_SADTP);
+    rxPdu[3] = 0x30;  // Unknown frame type
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 10);
+    atto_eq(err, HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_SADTP);
+    rxPdu[0] = 1;  // Group of other Clients
+    rxPdu[3] = 0x10;
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 10);
+    atto_eq(err, HZL_ERR_MSG_IGNORED);
+    rxPdu[0] = 0;
+    rxPdu[3] = 0x21;  // Consecutive Frame without a First Frame
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 10);
+    atto_eq(err, HZL_ERR_SADTP_UNEXPECTED_SEGMENT);
+
+    rxPdu[3] = 0x10;
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 10);
+    atto_eq(err, HZL_OK);
+    atto_false(msg.isForUser);
+    atto_true(msg.wasSecured);
+    rxPdu[3] = 0x21;
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 11);
+    atto_eq(err, HZL_OK);
+    rxPdu[3] = 0x23;  // Out of sequence
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 12);
+    atto_eq(err, HZL_ERR_SADTP_UNEXPECTED_SEGMENT);
+    rxPdu[3] = 0x21;  // Repeated
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 12);
+    atto_eq(err, HZL_ERR_SADTP_UNEXPECTED_SEGMENT);
+    rxPdu[3] = 0x10;  // Restart with the same ctrnonce
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 12);
+    atto_eq(err, HZL_ERR_SADTP_UNEXPECTED_SEGMENT);
+    rxPdu[3] = 0x22;  // The ignored frames did not drop the message
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 13);
+    atto_eq(err, HZL_OK);
+    atto_eq(ctx.sadtpRxPool->slots[0].nextSeqNr, 3);
+
+    rxPdu[3] = 0x10;
+    rxPdu[4] = 0x02;  // Restart with a newer ctrnonce
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 20);
+    atto_eq(err, HZL_OK);
+    atto_eq(ctx.sadtpRxPool->slots[0].nextSeqNr, 1);
+    rxPdu[3] = 0x21;
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123,
+                                      21 + HZL_SADTP_RX_TIMEOUT_MILLIS);
+    atto_eq(err, HZL_ERR_SADTP_TIMEOUT);
+    atto_eq(ctx.sadtpRxPool->timeouts, 1);
+    atto_zeros(ctx.sadtpRxPool->slots, sizeof(ctx.sadtpRxPool->slots));
+}
+
+static void
+hzlClientTest_ClientProcessReceivedSadtpPoolIsBounded(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t ctx = {
+            .clientConfig = &HZL_TEST_CORRECT_CLIENT_CONFIG,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .sadtpRxPool = &hzlClientTest_sadtpRxPool,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlClientTest_SadtpInit(&ctx);
+    hzl_CbsPduMsg_t reactionPdu;
+    hzl_RxSduMsg_t msg;
+    uint8_t rxPdu[7] = {
+            0,  // GID
+            20,  // SID
+            3,  // PTY == SADTP
+            0x10,  // First Frame
+            0x01, 0x00, 0x00,  // Ctrnonce
+    };
+
+    // One message per sender fits
+    for (uint8_t i = 0; i < HZL_SADTP_RX_SLOTS; i++)
+    {
+        rxPdu[1] = (uint8_t) (20U + i);
+        err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 7, 0x123, 10);
+        atto_eq(err, HZL_OK);
+    }
+    rxPdu[1] = 40;
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 7, 0x123, 10);
+    atto_eq(err, HZL_ERR_SADTP_POOL_FULL);
+    atto_eq(ctx.sadtpRxPool->overflows, 1);
+    // The same sender restarts its message in the same slot, with a newer ctrnonce
+    rxPdu[1] = 20;
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 7, 0x123, 10);
+    atto_eq(err, HZL_ERR_SADTP_UNEXPECTED_SEGMENT);
+    rxPdu[4] = 0x02;
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 7, 0x123, 10);
+    atto_eq(err, HZL_OK);
+    atto_eq(ctx.sadtpRxPool->slots[0].ctrNonce, 2);
+    // Until the unfinished messages time out
+    rxPdu[1] = 40;
+    err = hzl_ClientProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 7, 0x123,
+                                      11 + HZL_SADTP_RX_TIMEOUT_MILLIS);
+    atto_eq(err, HZL_OK);
+    atto_eq(ctx.sadtpRxPool->timeouts, 1);
+    atto_eq(ctx.sadtpRxPool->overflows, 1);
+}
+
+static void
+hzlClientTest_ClientProcessReceivedSadtpRejectsTamperedMessage(void)
+{
+    hzl_Err_t err;
+    hzl_ClientGroupState_t txGroupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t txCtx = {
+            .clientConfig = &HZL_TEST_CORRECT_CLIENT_CONFIG,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = txGroupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlClientTest_SadtpInit(&txCtx);
+    hzl_ClientGroupState_t rxGroupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ClientCtx_t rxCtx = {
+            .clientConfig = &hzlClientTest_sadtpReceiverConfig,
+            .groupConfigs = HZL_TEST_CLIENT_CORRECT_GROUP_CONFIGS,
+            .groupStates = rxGroupStates,
+            .sadtpRxPool = &hzlClientTest_sadtpRxPool,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlClientTest_SadtpInit(&rxCtx);
+    uint8_t userData[200] = {1, 2, 3};
+    hzl_CbsPduMsg_t reactionPdu;
+    hzl_RxSduView_t view;
+
+    const size_t amount = hzlClientTest_SadtpBuildAll(&txCtx, userData, sizeof(userData), 16);
+    hzlClientTest_sadtpFrames[amount / 2U].data[10] ^= 0x01;  // Ciphertext bit flip
+    for (size_t i = 0; i < amount; i++)
+    {
+        err = hzl_ClientProcessReceivedInPlace(
+                &reactionPdu, &view, &rxCtx, hzlClientTest_sadtpFrames[i].data,
+                hzlClientTest_sadtpFrames[i].dataLen, 0x123, 10);
+        atto_eq(err, i == amount - 1U ? HZL_ERR_SECWARN_INVALID_TAG : HZL_OK);
+    }
+    atto_false(view.isForUser);
+    atto_eq(rxGroupStates[0].currentCtrNonce, 1);  // Not updated
+    atto_zeros(&hzlClientTest_sadtpRxPool, sizeof(hzlClientTest_sadtpRxPool));
+}
+
+#endif  /* HZL_SADTP */
+
+void
+hzlClientTest_ClientSecuredTp(void)
+{
+#if HZL_SADTP
+    hzlClientTest_ClientBuildSecuredTpStartChecksInputs();
+    hzlClientTest_ClientBuildSecuredTpNextChecksInputs();
+    hzlClientTest_ClientBuildSecuredTpFramesLayout();
+    hzlClientTest_ClientSecuredTpRoundTrips();
+    hzlClientTest_ClientSecuredTpCopyingReceptionOnlyForShortMessages();
+    hzlClientTest_ClientProcessReceivedSadtpChecksFrames();
+    hzlClientTest_ClientProcessReceivedSadtpPoolIsBounded();
+    hzlClientTest_ClientProcessReceivedSadtpRejectsTamperedMessage();
+#endif
+}
@@ -0,0 +1,207 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Main file and function, comparing the ctrdelay() implementation of the library with its
+ * float reference over the domain of the maximum silence interval and maximum delay.
+ *
+ * The reference evaluates the formula of the CBS specification with doubles, which are exact
+ * there: `D * (S - t)` is below 2^38 and any non-integer `D * (S - t) / S` is at least 2^-16
+ * away from an integer, far more than the rounding error, so its `ceil()` is the exact one.
+ * The single-precision implementation of the library without #HZL_INTEGER_CTRDELAY is compared
+ * too, for information only, as its rounding errors make it differ by 1 in places.
+ *
+ * The whole domain, every `S` in [0, 0xFFFF] times every `D` in
+ * [0, #HZL_LARGEST_MAX_COUNTER_NONCE_DELAY] times every elapsed time `t` in [0, S], has 2^53
+ * points, so it's swept along all pairs of its axes instead:
+ * - every `S` times every `t`, at the largest delays, where the rounding is hardest;
+ * - every `D` times every `t`, at the shortest silence intervals, where `D / S` is largest;
+ * - every `S` times one `D` every #HZL_CTRDELAY_TEST_DELAY_STRIDE, at a few `t` each.
+ */
+
+#include "atto.h"
+#include "hzl.h"
+#include "hzl_CommonInternal.h"
+#include "hzl_CommonMessage.h"
+
+/** Largest maximum silence interval, as the configuration field is 16 bits long. */
+#define HZL_CTRDELAY_TEST_MAX_SILENCE 0xFFFFU
+/** Largest silence interval of the sweep over every maximum delay. */
+#define HZL_CTRDELAY_TEST_SHORT_SILENCE 16U
+/** Step of the maximum delays of the sweep over every silence interval, a prime. */
+#define HZL_CTRDELAY_TEST_DELAY_STRIDE 4093U
+/** Arbitrary timestamp of the last valid message, elapsed time is counted from it. */
+#define HZL_CTRDELAY_TEST_LAST_RX 0xFFFF0000U
+
+/** Statistics of a sweep. */
+typedef struct hzlCtrDelayTest_Stats
+{
+    /** Amount of compared inputs. */
+    uint64_t points;
+    /** Amount of inputs where the library differs from the reference. */
+    uint64_t mismatches;
+    /** Amount of inputs where the single-precision implementation differs from the reference. */
+    uint64_t floatMismatches;
+    /** Largest difference between the single-precision implementation and the reference. */
+    uint32_t floatMaxError;
+} hzlCtrDelayTest_Stats_t;
+
+/** ctrdelay() as specified, exact with doubles in the tested domain. */
+static uint32_t
+hzlCtrDelayTest_Reference(const uint32_t maxDelay,
+                          const uint32_t maxSilence,
+                          const uint32_t elapsed)
+{
+    if (elapsed >= maxSilence) { return 0; }
+    const double delay = (double) maxDelay * (double) (maxSilence - elapsed) / (double) maxSilence;
+    const uint32_t floored = (uint32_t) delay;
+    return floored + ((double) floored < delay);
+}
+
+/** Copy of the single-precision implementation of the library. */
+static uint32_t
+hzlCtrDelayTest_Float(const uint32_t maxDelay,
+                      const uint32_t maxSilence,
+                      const uint32_t elapsed)
+{
+    if (elapsed >= maxSilence) { return 0; }
+    const float fraction = (float) elapsed / (float) maxSilence;
+    const float delay = (float) maxDelay * (1.0f - fraction);
+    const uint32_t floored = (uint32_t) delay;
+    return floored + ((float) floored < delay);
+}
+
+static void
+hzlCtrDelayTest_Compare(hzlCtrDelayTest_Stats_t* const stats,
+                        const uint32_t maxDelay,
+                        const uint32_t maxSilence,
+                        const uint32_t elapsed)
+{
+    const uint32_t expected = hzlCtrDelayTest_Reference(maxDelay, maxSilence, elapsed);
+    const uint32_t actual = hzl_CommonCtrDelay(
+            HZL_CTRDELAY_TEST_LAST_RX, HZL_CTRDELAY_TEST_LAST_RX + elapsed,
+            maxDelay, maxSilence);
+    const uint32_t single = hzlCtrDelayTest_Float(maxDelay, maxSilence, elapsed);
+    stats->points++;
+    if (actual != expected)
+    {
+        if (stats->mismatches == 0)
+        {
+            printf("First mismatch: D=%u S=%u t=%u: expected %u, got %u\n",
+                   maxDelay, maxSilence, elapsed, expected, actual);
+        }
+        stats->mismatches++;
+    }
+    if (single != expected)
+    {
+        const uint32_t error = single > expected ? single - expected : expected - single;
+        stats->floatMismatches++;
+        if (error > stats->floatMaxError) { stats->floatMaxError = error; }
+    }
+}
+
+static void
+hzlCtrDelayTest_Report(const char* const sweep,
+                       const hzlCtrDelayTest_Stats_t* const stats)
+{
+    printf("%s: %llu points, %llu mismatches, float %llu mismatches (max error %u)\n",
+           sweep, (unsigned long long) stats->points, (unsigned long long) stats->mismatches,
+           (unsigned long long) stats->floatMismatches, stats->floatMaxError);
+    atto_eq(stats->mismatches, 0);
+    atto_true(stats->floatMaxError <= 1U);
+}
+
+static void
+hzlCtrDelayTest_EverySilenceEveryElapsed(void)
+{
+    static const uint32_t maxDelays[] = {
+            HZL_LARGEST_MAX_COUNTER_NONCE_DELAY,
+            HZL_LARGEST_MAX_COUNTER_NONCE_DELAY - 1U,
+    };
+    hzlCtrDelayTest_Stats_t stats = {0};
+    for (size_t i = 0; i < sizeof(maxDelays) / sizeof(maxDelays[0]); i++)
+    {
+        for (uint32_t maxSilence = 0; maxSilence <= HZL_CTRDELAY_TEST_MAX_SILENCE; maxSilence++)
+        {
+            for (uint32_t elapsed = 0; elapsed <= maxSilence; elapsed++)
+            {
+                hzlCtrDelayTest_Compare(&stats, maxDelays[i], maxSilence, elapsed);
+            }
+        }
+    }
+    hzlCtrDelayTest_Report(__func__, &stats);
+}
+
+static void
+hzlCtrDelayTest_EveryDelayEveryElapsed(void)
+{
+    hzlCtrDelayTest_Stats_t stats = {0};
+    for (uint32_t maxSilence = 0; maxSilence <= HZL_CTRDELAY_TEST_SHORT_SILENCE; maxSilence++)
+    {
+        for (uint32_t maxDelay = 0; maxDelay <= HZL_LARGEST_MAX_COUNTER_NONCE_DELAY; maxDelay++)
+        {
+            for (uint32_t elapsed = 0; elapsed <= maxSilence; elapsed++)
+            {
+                hzlCtrDelayTest_Compare(&stats, maxDelay, maxSilence, elapsed);
+            }
+        }
+    }
+    hzlCtrDelayTest_Report(__func__, &stats);
+}
+
+static void
+hzlCtrDelayTest_EverySilenceSteppedDelay(void)
+{
+    hzlCtrDelayTest_Stats_t stats = {0};
+    for (uint32_t maxSilence = 0; maxSilence <= HZL_CTRDELAY_TEST_MAX_SILENCE; maxSilence++)
+    {
+        for (uint32_t maxDelay = 0; maxDelay <= HZL_LARGEST_MAX_COUNTER_NONCE_DELAY;
+             maxDelay += HZL_CTRDELAY_TEST_DELAY_STRIDE)
+        {
+            hzlCtrDelayTest_Compare(&stats, maxDelay, maxSilence, 1U);
+            hzlCtrDelayTest_Compare(&stats, maxDelay, maxSilence, maxSilence / 3U);
+            hzlCtrDelayTest_Compare(&stats, maxDelay, maxSilence, maxSilence / 2U);
+            hzlCtrDelayTest_Compare(&stats, maxDelay, maxSilence, maxSilence - 1U);
+        }
+    }
+    hzlCtrDelayTest_Report(__func__, &stats);
+}
+
+/**
+ * Main function, running all sweeps.
+ * @return 0 if all tests passed, non-zero otherwise.
+ */
+int main(void)
+{
+    hzlCtrDelayTest_EverySilenceEveryElapsed();
+    hzlCtrDelayTest_EveryDelayEveryElapsed();
+    hzlCtrDelayTest_EverySilenceSteppedDelay();
+    return atto_at_least_one_fail;
+}
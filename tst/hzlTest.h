@@ -69,6 +69,23 @@ extern "C"
 #define HZL_DEFAULT_TEST_AMOUNT_OF_CLIENTS 2U
 /** Maximum allocated amount of Croups in the sample correct configuration. */
 #define HZL_MAX_TEST_AMOUNT_OF_CLIENTS 4U
+/**
+ * @def HZL_TEST_SERVER_GROUP_HOT
+ * Pointer to the struct holding the Counter Nonces and timestamps of a Server Group,
+ * for any #HZL_SERVER_SPLIT_GROUP_STATE layout.
+ *
+ * @def HZL_TEST_SERVER_MARK_RENEWAL_PHASE_ACTIVE
+ * Completes the setup of a fake renewal phase made by writing a non-zero previous STK,
+ * as the Server tracks the renewal phase with the Session state instead.
+ */
+#if HZL_SERVER_SPLIT_GROUP_STATE
+#define HZL_TEST_SERVER_GROUP_HOT(pCtx, gid) (&(pCtx)->groupHotStates[(gid)])
+#else
+#define HZL_TEST_SERVER_GROUP_HOT(pCtx, gid) (&(pCtx)->groupStates[(gid)])
+#endif
+#define HZL_TEST_SERVER_MARK_RENEWAL_PHASE_ACTIVE(pCtx, gid) \
+    (HZL_TEST_SERVER_GROUP_HOT((pCtx), (gid))->sessionState = HZL_SESSION_STATE_RENEWING)
+
 /** Sample correct Client configuration. Copy and tweak into a wrong one if needed. */
 extern const hzl_ClientConfig_t HZL_TEST_CORRECT_CLIENT_CONFIG;
 /** Sample correct Groups configuration array for a Client.
@@ -119,6 +136,8 @@ void hzlClientTest_ClientNew(void);
 
 void hzlClientTest_ClientNewMsg(void);
 
+void hzlClientTest_ClientBuildCanFilters(void);
+
 void hzlClientTest_ClientBuildRequest(void);
 
 void hzlClientTest_ClientBuildUnsecured(void);
@@ -137,6 +156,8 @@ void hzlClientTest_ClientProcessReceivedResponse(void);
 
 void hzlClientTest_ClientProcessReceivedRenewal(void);
 
+void hzlClientTest_ClientSecuredTp(void);
+
 // Server test running functions, grouping test cases.
 void hzlServerTest_ServerInit(void);
 
@@ -156,6 +177,8 @@ void hzlServerTest_ServerBuildUnsecured(void);
 
 void hzlServerTest_ServerBuildSecuredFd(void);
 
+void hzlServerTest_ServerBuildCanFilters(void);
+
 void hzlServerTest_ServerProcessReceived(void);
 
 void hzlServerTest_ServerProcessReceivedRequest(void);
@@ -166,8 +189,21 @@ void hzlServerTest_ServerProcessReceivedUnsecured(void);
 
 void hzlServerTest_ServerProcessReceivedSecuredFd(void);
 
+void hzlServerTest_ServerProcessReceivedBatch(void);
+
 void hzlServerTest_ServerForceSessionRenewal(void);
 
+void hzlServerTest_ServerTick(void);
+
+void hzlServerTest_ServerDos(void);
+
+void hzlServerTest_ServerRejectedCache(void);
+
+void hzlServerTest_ServerSecuredTp(void);
+
+// Interop test running functions, grouping test cases.
+void hzlInteropTest_MultiThread(void);
+
 #ifdef __cplusplus
 }
 #endif
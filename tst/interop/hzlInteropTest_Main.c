@@ -41,7 +41,10 @@
 
 #include "hzlTest.h"
 
+#include <string.h>
+
 #define CAN_ID 0x123U
+#define CAN_CLASSIC_MAX_DATA_LEN 8U
 
 typedef enum hzlTest_Sid
 {
@@ -278,6 +281,60 @@ hzlInteropTest_InitialisationPhase(hzlInteropTest_Bus_t* const bus)
     atto_eq(req.dataLen, 0);
 }
 
+#if HZL_SADTP
+static void
+hzlInteropTest_SadtpExchange(hzlInteropTest_Bus_t* const bus)
+{
+    hzl_Err_t err;
+    hzl_SadtpTx_t tx;
+    hzl_CbsPduMsg_t frame;
+    hzl_CbsPduMsg_t nothing;
+    hzl_RxSduView_t serverView;
+    hzl_RxSduView_t bobView;
+    hzl_RxSduView_t charlieView;
+    hzl_Timestamp_t now;
+    static uint8_t sadtpData[1024];
+    static uint8_t userData[1024];
+    for (size_t i = 0; i < sizeof(sadtpData); i++) { sadtpData[i] = (uint8_t) (i ^ 0xA5U); }
+    memcpy(userData, sadtpData, sizeof(userData));
+
+    // Alice transmits a long secured message for Bob and Server only, on classic CAN frames
+    err = hzl_ClientBuildSecuredTpStart(&tx, bus->alice, userData, sizeof(userData), GID_SAB,
+                                        CAN_CLASSIC_MAX_DATA_LEN);
+    atto_eq(err, HZL_OK);
+    err = bus->server->io.currentTime(&now);
+    atto_eq(err, HZL_OK);
+    while (!tx.isDone)
+    {
+        err = hzl_ClientBuildSecuredTpNext(&frame, &tx);
+        atto_eq(err, HZL_OK);
+        atto_ge(CAN_CLASSIC_MAX_DATA_LEN, frame.dataLen);
+        err = hzl_ServerProcessReceivedInPlace(&nothing, &serverView, bus->server, frame.data,
+                                               frame.dataLen, CAN_ID, now);
+        atto_eq(err, HZL_OK);
+        atto_eq(nothing.dataLen, 0);
+        atto_eq(serverView.isForUser, tx.isDone);
+        err = hzl_ClientProcessReceivedInPlace(&nothing, &bobView, bus->bob, frame.data,
+                                               frame.dataLen, CAN_ID, now);
+        atto_eq(err, HZL_OK);
+        atto_eq(nothing.dataLen, 0);
+        atto_eq(bobView.isForUser, tx.isDone);
+        err = hzl_ClientProcessReceivedInPlace(&nothing, &charlieView, bus->charlie, frame.data,
+                                               frame.dataLen, CAN_ID, now);
+        atto_eq(err, HZL_ERR_MSG_IGNORED);
+        atto_eq(charlieView.isForUser, false);
+    }
+    atto_eq(serverView.gid, GID_SAB);
+    atto_eq(serverView.sid, ALICE);
+    atto_eq(serverView.dataLen, sizeof(sadtpData));
+    atto_memeq(serverView.data, sadtpData, sizeof(sadtpData));
+    atto_eq(bobView.gid, GID_SAB);
+    atto_eq(bobView.sid, ALICE);
+    atto_eq(bobView.dataLen, sizeof(sadtpData));
+    atto_memeq(bobView.data, sadtpData, sizeof(sadtpData));
+}
+#endif  /* HZL_SADTP */
+
 static void
 hzlInteropTest_RenewalPhase(hzlInteropTest_Bus_t* const bus)
 {
@@ -455,8 +512,12 @@ int main(void)
     hzlInteropTest_BusInit(&bus);
     hzlInteropTest_UadExchange(&bus);
     hzlInteropTest_InitialisationPhase(&bus);
+#if HZL_SADTP
+    hzlInteropTest_SadtpExchange(&bus);
+#endif
     hzlInteropTest_RenewalPhase(&bus);
     hzlInteropTest_BusTeardown(&bus);
+    hzlInteropTest_MultiThread();
     HZL_TEST_PARTIAL_REPORT();
     return atto_at_least_one_fail;
 }
@@ -0,0 +1,245 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Stress test of the thread-safety contract: distinct contexts on distinct threads,
+ * without shared mutable state, must behave exactly as if they were running alone.
+ *
+ * Each thread runs the same deterministic exchange between a Server and a Client,
+ * including handshakes and Session renewals, recording every transmitted frame.
+ * All transcripts must match bit-for-bit the one obtained by a single-threaded run.
+ */
+
+#include "hzlTest.h"
+
+#ifndef __STDC_NO_THREADS__
+
+#include <threads.h>
+
+#define HZL_MT_CAN_ID 0x123U
+#define HZL_MT_GID 3U  // Server, Alice and Bob
+#define HZL_MT_AMOUNT_OF_THREADS 8U
+#define HZL_MT_AMOUNT_OF_ROUNDS 400U
+#define HZL_MT_ROUNDS_BETWEEN_RENEWALS 50U
+#define HZL_MT_MAX_FRAMES (HZL_MT_AMOUNT_OF_ROUNDS * 4U \
+    + (HZL_MT_AMOUNT_OF_ROUNDS / HZL_MT_ROUNDS_BETWEEN_RENEWALS + 1U) * 4U)
+
+/** Every frame transmitted on the bus by one thread, in order. */
+typedef struct hzlInteropTest_Transcript
+{
+    hzl_Err_t err;  ///< First error encountered, stopping the run.
+    size_t amountOfFrames;
+    hzl_CbsPduMsg_t frames[HZL_MT_MAX_FRAMES];
+} hzlInteropTest_Transcript_t;
+
+/** Per-thread clock, so the timestamps of one thread don't depend on the others. */
+static _Thread_local hzl_Timestamp_t hzlInteropTest_threadClock = 42U;
+
+static hzl_Err_t
+hzlInteropTest_ThreadLocalCurrentTime(hzl_Timestamp_t* const timestamp)
+{
+    *timestamp = hzlInteropTest_threadClock++;
+    return HZL_OK;
+}
+
+/** Deterministic and stateless, thus thread-safe. */
+static const hzl_Io_t HZL_MT_IO = {
+        .currentTime = hzlInteropTest_ThreadLocalCurrentTime,
+        .trng = hzlTest_IoMockupTrngSucceeding,
+};
+
+static void
+hzlInteropTest_Record(hzlInteropTest_Transcript_t* const transcript,
+                      const hzl_CbsPduMsg_t* const frame)
+{
+    if (frame->dataLen > 0 && transcript->amountOfFrames < HZL_MT_MAX_FRAMES)
+    {
+        transcript->frames[transcript->amountOfFrames++] = *frame;
+    }
+}
+
+/** Transmits the Server's reaction to Alice and back, until nobody has to reply. */
+static hzl_Err_t
+hzlInteropTest_PingPong(hzlInteropTest_Transcript_t* const transcript,
+                        hzl_ServerCtx_t* const server,
+                        hzl_ClientCtx_t* const alice,
+                        const hzl_CbsPduMsg_t* const fromServerFirst)
+{
+    hzl_Err_t err;
+    hzl_CbsPduMsg_t fromServer = *fromServerFirst;
+    hzl_CbsPduMsg_t fromAlice;
+    hzl_RxSduMsg_t sdu;
+
+    while (fromServer.dataLen > 0)
+    {
+        hzlInteropTest_Record(transcript, &fromServer);
+        err = hzl_ClientProcessReceived(&fromAlice, &sdu, alice,
+                                        fromServer.data, fromServer.dataLen, HZL_MT_CAN_ID);
+        if (err != HZL_OK) { return err; }
+        if (fromAlice.dataLen == 0) { break; }
+        hzlInteropTest_Record(transcript, &fromAlice);
+        err = hzl_ServerProcessReceived(&fromServer, &sdu, server,
+                                        fromAlice.data, fromAlice.dataLen, HZL_MT_CAN_ID);
+        if (err != HZL_OK) { return err; }
+    }
+    return HZL_OK;
+}
+
+static hzl_Err_t
+hzlInteropTest_Exchange(hzlInteropTest_Transcript_t* const transcript,
+                        hzl_ServerCtx_t* const server,
+                        hzl_ClientCtx_t* const alice)
+{
+    hzl_Err_t err;
+    hzl_CbsPduMsg_t msg;
+    hzl_CbsPduMsg_t reaction;
+    hzl_RxSduMsg_t sdu;
+    uint8_t sadData[16];
+
+    // Restart both parties with the deterministic IO
+    server->io = HZL_MT_IO;
+    alice->io = HZL_MT_IO;
+    err = hzl_ServerInit(server);
+    if (err != HZL_OK) { return err; }
+    err = hzl_ClientInit(alice);
+    if (err != HZL_OK) { return err; }
+    // Handshake
+    err = hzl_ClientBuildRequest(&msg, alice, HZL_MT_GID);
+    if (err != HZL_OK) { return err; }
+    hzlInteropTest_Record(transcript, &msg);
+    err = hzl_ServerProcessReceived(&reaction, &sdu, server, msg.data, msg.dataLen,
+                                    HZL_MT_CAN_ID);
+    if (err != HZL_OK) { return err; }
+    err = hzlInteropTest_PingPong(transcript, server, alice, &reaction);
+    if (err != HZL_OK) { return err; }
+    for (size_t round = 0; round < HZL_MT_AMOUNT_OF_ROUNDS; round++)
+    {
+        for (size_t i = 0; i < sizeof(sadData); i++) { sadData[i] = (uint8_t) (round + i); }
+        // Alice -> Server
+        err = hzl_ClientBuildSecuredFd(&msg, alice, sadData, round % sizeof(sadData),
+                                       HZL_MT_GID);
+        if (err != HZL_OK) { return err; }
+        hzlInteropTest_Record(transcript, &msg);
+        err = hzl_ServerProcessReceived(&reaction, &sdu, server, msg.data, msg.dataLen,
+                                        HZL_MT_CAN_ID);
+        if (err != HZL_OK) { return err; }
+        if (sdu.dataLen != round % sizeof(sadData)
+            || memcmp(sdu.data, sadData, sdu.dataLen) != 0)
+        {
+            return HZL_ERR_SECWARN_INVALID_TAG;
+        }
+        err = hzlInteropTest_PingPong(transcript, server, alice, &reaction);
+        if (err != HZL_OK) { return err; }
+        // Server -> Alice
+        err = hzl_ServerBuildSecuredFd(&msg, server, sadData, sizeof(sadData), HZL_MT_GID);
+        if (err != HZL_OK) { return err; }
+        hzlInteropTest_Record(transcript, &msg);
+        err = hzl_ClientProcessReceived(&reaction, &sdu, alice, msg.data, msg.dataLen,
+                                        HZL_MT_CAN_ID);
+        if (err != HZL_OK) { return err; }
+        // Renewal: REN, REQ, RES
+        if (round % HZL_MT_ROUNDS_BETWEEN_RENEWALS == HZL_MT_ROUNDS_BETWEEN_RENEWALS - 1U)
+        {
+            err = hzl_ServerForceSessionRenewal(&msg, server, HZL_MT_GID);
+            if (err != HZL_OK) { return err; }
+            err = hzlInteropTest_PingPong(transcript, server, alice, &msg);
+            if (err != HZL_OK) { return err; }
+        }
+    }
+    return HZL_OK;
+}
+
+/** Thread entry point, running a whole exchange with its own contexts. */
+static int
+hzlInteropTest_Run(void* const arg)
+{
+    hzlInteropTest_Transcript_t* const transcript = arg;
+    hzl_ServerCtx_t* server = NULL;
+    hzl_ClientCtx_t* alice = NULL;
+    hzlInteropTest_threadClock = 42U;
+    transcript->amountOfFrames = 0;
+    transcript->err = hzl_ServerNew(&server, "serverconfigfiles/Server.hzl");
+    if (transcript->err == HZL_OK)
+    {
+        transcript->err = hzl_ClientNew(&alice, "clientconfigfiles/Alice.hzl");
+    }
+    if (transcript->err == HZL_OK)
+    {
+        transcript->err = hzlInteropTest_Exchange(transcript, server, alice);
+    }
+    hzl_ServerFree(&server);
+    hzl_ClientFree(&alice);
+    return 0;
+}
+
+void
+hzlInteropTest_MultiThread(void)
+{
+    static hzlInteropTest_Transcript_t reference;
+    static hzlInteropTest_Transcript_t transcripts[HZL_MT_AMOUNT_OF_THREADS];
+    thrd_t threads[HZL_MT_AMOUNT_OF_THREADS];
+
+    // Single-threaded reference run
+    hzlInteropTest_Run(&reference);
+    atto_eq(reference.err, HZL_OK);
+    atto_gt(reference.amountOfFrames, HZL_MT_AMOUNT_OF_ROUNDS * 2U);
+    // Parallel runs
+    for (size_t i = 0; i < HZL_MT_AMOUNT_OF_THREADS; i++)
+    {
+        atto_eq(thrd_create(&threads[i], hzlInteropTest_Run, &transcripts[i]), thrd_success);
+    }
+    for (size_t i = 0; i < HZL_MT_AMOUNT_OF_THREADS; i++)
+    {
+        atto_eq(thrd_join(threads[i], NULL), thrd_success);
+    }
+    for (size_t i = 0; i < HZL_MT_AMOUNT_OF_THREADS; i++)
+    {
+        atto_eq(transcripts[i].err, HZL_OK);
+        atto_eq(transcripts[i].amountOfFrames, reference.amountOfFrames);
+        for (size_t frame = 0; frame < reference.amountOfFrames; frame++)
+        {
+            atto_eq(transcripts[i].frames[frame].dataLen, reference.frames[frame].dataLen);
+            atto_memeq(transcripts[i].frames[frame].data, reference.frames[frame].data,
+                       reference.frames[frame].dataLen);
+        }
+    }
+    HZL_TEST_PARTIAL_REPORT();
+}
+
+#else
+
+void
+hzlInteropTest_MultiThread(void)
+{
+    // No C11 threads available on this platform: nothing to stress.
+    HZL_TEST_PARTIAL_REPORT();
+}
+
+#endif  /* __STDC_NO_THREADS__ */
@@ -0,0 +1,98 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Tests of the hzl_ServerBuildCanFilters() function.
+ */
+
+#include "hzlTest.h"
+
+#if HZL_OS_AVAILABLE_LINUX
+
+static void
+hzlServerTest_ServerBuildCanFiltersOutputsMustBeNotNull(void)
+{
+    hzl_Err_t err;
+    struct can_filter filters[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    size_t amountOfFilters = 123;
+
+    err = hzl_ServerBuildCanFilters(NULL, &amountOfFilters, 3, NULL);
+    atto_eq(err, HZL_ERR_NULL_CAN_FILTERS);
+    err = hzl_ServerBuildCanFilters(filters, NULL, 3, NULL);
+    atto_eq(err, HZL_ERR_NULL_CAN_FILTERS);
+    err = hzl_ServerBuildCanFilters(filters, &amountOfFilters, 3, NULL);
+    atto_eq(err, HZL_ERR_NULL_CTX);
+    atto_eq(amountOfFilters, 0);
+}
+
+static void
+hzlServerTest_ServerBuildCanFiltersOnePerGroupWithMixedHeader(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerConfig_t serverConfigWithMixedHeader = HZL_TEST_CORRECT_SERVER_CONFIG;
+    serverConfigWithMixedHeader.headerPlacement = HZL_HEADER_MIXED;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &serverConfigWithMixedHeader,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    struct can_filter filters[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    size_t amountOfFilters = 0;
+    // Requirement for this test: the header 0 is 3 bytes long, GID in the first one
+    atto_eq(ctx.serverConfig->headerType, HZL_HEADER_0);
+
+    err = hzl_ServerBuildCanFilters(filters, &amountOfFilters,
+                                    HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, &ctx);
+
+    atto_eq(err, HZL_OK);
+    atto_eq(amountOfFilters, HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS);
+    for (size_t i = 0; i < HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS; i++)
+    {
+        const canid_t gid = ctx.groupConfigs[i].gid;
+        atto_eq(filters[i].can_id, gid << 16U | CAN_EFF_FLAG);
+        atto_eq(filters[i].can_mask, 0xFFUL << 16U | CAN_EFF_FLAG | CAN_RTR_FLAG);
+    }
+}
+
+#endif  /* HZL_OS_AVAILABLE_LINUX */
+
+void hzlServerTest_ServerBuildCanFilters(void)
+{
+#if HZL_OS_AVAILABLE_LINUX
+    hzlServerTest_ServerBuildCanFiltersOutputsMustBeNotNull();
+    hzlServerTest_ServerBuildCanFiltersOnePerGroupWithMixedHeader();
+    HZL_TEST_PARTIAL_REPORT();
+#endif  /* HZL_OS_AVAILABLE_LINUX */
+}
@@ -29,7 +29,7 @@
 /**
  * @file
  * @internal
- * Tests of the hzl_ServerBuildSecuredFd() function.
+ * Tests of the hzl_ServerBuildSecuredFd() and hzl_ServerBuildSecuredFdInto() functions.
  *
  * @warning
  * REDUCING COVERAGE ON PURPOSE. NOT implementing all the testcases for all possible incorrect
@@ -101,7 +101,8 @@ hzlServerTest_ServerBuildSecuredFdDataLenMustBeShortEnough(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Fake a Request being already received
-    groupStates[0].currentRxLastMessageInstant = groupStates[0].sessionStartInstant + 1U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant + 1U;
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {1, 2, 3, 4};
     size_t userDataLen;
@@ -117,6 +118,7 @@ hzlServerTest_ServerBuildSecuredFdDataLenMustBeShortEnough(void)
     atto_eq(err, HZL_ERR_TOO_LONG_SDU);
 }
 
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
 static void
 hzlServerTest_ServerBuildSecuredFdDataLenDependsOnHeaderLen(void)
 {
@@ -136,7 +138,8 @@ hzlServerTest_ServerBuildSecuredFdDataLenDependsOnHeaderLen(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Fake a Request being already received
-    groupStates[0].currentRxLastMessageInstant = groupStates[0].sessionStartInstant + 1U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant + 1U;
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {1, 2, 3, 4};
     size_t userDataLen;
@@ -170,7 +173,8 @@ hzlServerTest_ServerBuildSecuredFdCompactHeaderPreventsTooManyGroups(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Fake a Request being already received
-    groupStates[0].currentRxLastMessageInstant = groupStates[0].sessionStartInstant + 1U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant + 1U;
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {1, 2, 3, 4};
     size_t userDataLen = 4;
@@ -181,6 +185,7 @@ hzlServerTest_ServerBuildSecuredFdCompactHeaderPreventsTooManyGroups(void)
 
     atto_eq(err, HZL_ERR_GID_TOO_LARGE_FOR_CONFIGURED_HEADER_TYPE);
 }
+#endif
 
 static void
 hzlServerTest_ServerBuildSecuredFdGidMustBeInConfig(void)
@@ -229,7 +234,8 @@ hzlServerTest_ServerBuildSecuredFdRequiresSomeClientsRequestedAlready(void)
     atto_zeros(&msgToTx, sizeof(hzl_CbsPduMsg_t));
 
     // Fake a Request being received
-    groupStates[0].currentRxLastMessageInstant = groupStates[0].sessionStartInstant + 1U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant + 1U;
     err = hzl_ServerBuildSecuredFd(&msgToTx, &ctx, userData, userDataLen, 0);
     atto_eq(err, HZL_OK);
 }
@@ -249,10 +255,11 @@ hzlServerTest_ServerBuildSecuredFdHeaderIsPackedBeforePayload(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Fake a Request being already received
-    groupStates[0].currentRxLastMessageInstant = groupStates[0].sessionStartInstant + 1U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant + 1U;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);
-    groupStates[0].currentCtrNonce = 0x112233U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 0x112233U;
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {1, 2, 3, 4};
     size_t userDataLen = 4;
@@ -277,9 +284,10 @@ hzlServerTest_ServerBuildSecuredFdHeaderIsPackedBeforePayload(void)
     atto_memneq(&msgToTx.data[7], userData, userDataLen);  // CT
     // Tag: not verified here, not relevant to this test.
     // Ctrnonce was incremented in the state
-    atto_eq(groupStates[0].currentCtrNonce, 0x112234);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 0x112234);
 }
 
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
 static void
 hzlServerTest_ServerBuildSecuredFdHeaderPackingDependsOnType(void)
 {
@@ -298,8 +306,9 @@ hzlServerTest_ServerBuildSecuredFdHeaderPackingDependsOnType(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Fake a Request being already received
-    groupStates[2].currentRxLastMessageInstant = groupStates[0].sessionStartInstant + 1U;
-    groupStates[2].currentCtrNonce = 0x112233U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 2)->currentRxLastMessageInstant =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant + 1U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 2)->currentCtrNonce = 0x112233U;
     groupStates[2].currentStk[0] = 99;
     memset(&groupStates[2].currentStk[1], 0, 15);
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -326,8 +335,9 @@ hzlServerTest_ServerBuildSecuredFdHeaderPackingDependsOnType(void)
     atto_memneq(&msgToTx.data[5], userData, userDataLen);  // CT
     // Tag: not verified here, not relevant to this test.
     // Ctrnonce was incremented in the state
-    atto_eq(groupStates[2].currentCtrNonce, 0x112234);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 2)->currentCtrNonce, 0x112234);
 }
+#endif
 
 static void
 hzlServerTest_ServerBuildSecuredFdMsgWithNoPayload(void)
@@ -344,10 +354,11 @@ hzlServerTest_ServerBuildSecuredFdMsgWithNoPayload(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Fake a Request being already received
-    groupStates[0].currentRxLastMessageInstant = groupStates[0].sessionStartInstant + 1U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant + 1U;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);
-    groupStates[0].currentCtrNonce = 0x010203U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 0x010203U;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -373,7 +384,7 @@ hzlServerTest_ServerBuildSecuredFdMsgWithNoPayload(void)
     const uint8_t expectedTag[8] = {0xEB, 0xE5, 0x7B, 0x17, 0x89, 0xBC, 0xCA, 0xCD};
     atto_memeq(&msgToTx.data[7], expectedTag, 8);
     // Ctrnonce was incremented in the state
-    atto_eq(groupStates[0].currentCtrNonce, 0x010204);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 0x010204);
 }
 
 static void
@@ -393,8 +404,9 @@ hzlServerTest_ServerBuildSecuredFdSuccessfully(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Fake a Request being already received
-    groupStates[0].currentRxLastMessageInstant = groupStates[0].sessionStartInstant + 1U;
-    groupStates[0].currentCtrNonce = 0x010203U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant + 1U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 0x010203U;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -421,7 +433,7 @@ hzlServerTest_ServerBuildSecuredFdSuccessfully(void)
     const uint8_t expectedTag[8] = {0x97, 0x96, 0xA0, 0x03, 0x46, 0x82, 0xE8, 0xF4};
     atto_memeq(&msgToTx.data[12], expectedTag, 8);
     // Ctrnonce was incremented in the state
-    atto_eq(groupStates[0].currentCtrNonce, 0x010204);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 0x010204);
 }
 
 
@@ -442,14 +454,16 @@ hzlServerTest_ServerBuildSecuredFdSuccessfullyUsesNewKeyDuringRenewalPhase(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Fake a Request being already received
-    groupStates[0].currentRxLastMessageInstant = groupStates[0].sessionStartInstant + 1U;
-    groupStates[0].currentCtrNonce = 0x010203U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant + 1U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 0x010203U;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);
     // Dummy old session state as copied after getting a REN message
-    groupStates[0].previousCtrNonce = 0x111111;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->previousCtrNonce = 0x111111;
     groupStates[0].previousStk[0] = 150;
     memset(&groupStates[0].previousStk[1], 0, 15);
+    HZL_TEST_SERVER_MARK_RENEWAL_PHASE_ACTIVE(&ctx, 0);
     hzl_CbsPduMsg_t msgToTx = {0};
     const uint8_t userData[64] = {'A', 'B', 'C', 'D', 'E'};
     size_t userDataLen = 5;
@@ -475,7 +489,93 @@ hzlServerTest_ServerBuildSecuredFdSuccessfullyUsesNewKeyDuringRenewalPhase(void)
     const uint8_t expectedTag[8] = {0x97, 0x96, 0xA0, 0x03, 0x46, 0x82, 0xE8, 0xF4};
     atto_memeq(&msgToTx.data[12], expectedTag, 8);
     // Ctrnonce was incremented in the state
-    atto_eq(groupStates[0].currentCtrNonce, 0x010204);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 0x010204);
+}
+
+static void
+hzlServerTest_ServerBuildSecuredFdIntoOutputLenMustBeNotNull(void)
+{
+    hzl_Err_t err;
+    uint8_t frame[64];
+
+    err = hzl_ServerBuildSecuredFdInto(frame, sizeof(frame), NULL, NULL, NULL, NULL, 0, 0);
+
+    atto_eq(err, HZL_ERR_NULL_PDU);
+}
+
+static void
+hzlServerTest_ServerBuildSecuredFdIntoOutputBufferMustBeLongEnough(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    // Fake a Request being already received
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant + 1U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 0x010203U;
+    uint8_t frame[64];
+    size_t frameLen = 123;
+    const uint8_t userData[5] = {'A', 'B', 'C', 'D', 'E'};
+
+    // Header 0 + ctrnonce + ptlen + dataLen + tag, minus one byte
+    err = hzl_ServerBuildSecuredFdInto(frame, 3 + 3 + 1 + 5 + 8 - 1, &frameLen, NULL,
+                                       &ctx, userData, sizeof(userData), 0);
+
+    atto_eq(err, HZL_ERR_TOO_SHORT_OUTPUT_BUFFER);
+    atto_eq(frameLen, 0);
+    // Ctrnonce was not consumed
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 0x010203);
+}
+
+static void
+hzlServerTest_ServerBuildSecuredFdIntoSuccessfully(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    // Fake a Request being already received
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant + 1U;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 0x010203U;
+    groupStates[0].currentStk[0] = 99;
+    memset(&groupStates[0].currentStk[1], 0, 15);
+    // Exactly as long as the message, no more
+    uint8_t frame[3 + 3 + 1 + 5 + 8];
+    size_t frameLen = 0;
+    const uint8_t userData[5] = {'A', 'B', 'C', 'D', 'E'};
+
+    err = hzl_ServerBuildSecuredFdInto(frame, sizeof(frame), &frameLen, NULL,
+                                       &ctx, userData, sizeof(userData), 0);
+
+    atto_eq(err, HZL_OK);
+    atto_eq(frameLen, sizeof(frame));
+    // Same message as hzl_ServerBuildSecuredFd() would build
+    const uint8_t expectedPdu[3 + 3 + 1 + 5 + 8] = {
+            0, 0, 4,  // Header 0: GID, SID, PTY SADFD
+            0x03, 0x02, 0x01,  // Ctrnonce
+            5,  // Ptlen
+            0xAF, 0xE4, 0x31, 0xE5, 0xBD,  // Ciphertext
+            0x97, 0x96, 0xA0, 0x03, 0x46, 0x82, 0xE8, 0xF4,  // Tag
+    };
+    atto_memeq(frame, expectedPdu, sizeof(expectedPdu));
+    // Ctrnonce was incremented in the state
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 0x010204);
 }
 
 void hzlServerTest_ServerBuildSecuredFd(void)
@@ -485,13 +585,20 @@ void hzlServerTest_ServerBuildSecuredFd(void)
     hzlServerTest_ServerBuildSecuredFdRequiresSomeClientsRequestedAlready();
     hzlServerTest_ServerBuildSecuredFdMsgDataMustBeNotNullWhenPositiveDataLen();
     hzlServerTest_ServerBuildSecuredFdDataLenMustBeShortEnough();
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlServerTest_ServerBuildSecuredFdDataLenDependsOnHeaderLen();
     hzlServerTest_ServerBuildSecuredFdCompactHeaderPreventsTooManyGroups();
+#endif
     hzlServerTest_ServerBuildSecuredFdGidMustBeInConfig();
     hzlServerTest_ServerBuildSecuredFdHeaderIsPackedBeforePayload();
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlServerTest_ServerBuildSecuredFdHeaderPackingDependsOnType();
+#endif
     hzlServerTest_ServerBuildSecuredFdMsgWithNoPayload();
     hzlServerTest_ServerBuildSecuredFdSuccessfully();
     hzlServerTest_ServerBuildSecuredFdSuccessfullyUsesNewKeyDuringRenewalPhase();
+    hzlServerTest_ServerBuildSecuredFdIntoOutputLenMustBeNotNull();
+    hzlServerTest_ServerBuildSecuredFdIntoOutputBufferMustBeLongEnough();
+    hzlServerTest_ServerBuildSecuredFdIntoSuccessfully();
     HZL_TEST_PARTIAL_REPORT();
 }
@@ -0,0 +1,315 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Tests of the Denial-of-Service protection of the Server, dropping the received messages
+ * requiring cryptographic operations over the #hzl_ServerDosConfig_t limits.
+ */
+
+#include "hzlTest.h"
+
+/** Valid REQ message from SID 1 in GID 0, assuming the LTK being [1, 0, 0, ..., 0]. */
+static const uint8_t HZL_TEST_DOS_VALID_REQ[64] = {
+        // Header 0
+        0,  // GID
+        1,  // SID != server
+        2,  // PTY == REQ
+        8, 9, 10, 11, 12, 13, 14, 15,  // Reqnonce
+        0xC7, 0x70, 0xFE, 0x35, 0x67, 0x85, 0x78, 0xD8,  // Tag (valid)
+        0x2E, 0x78, 0x57, 0x90, 0xCD, 0x76, 0xC1, 0x1F,  // Tag (valid)
+};
+
+/** SADFD message from SID 2 in GID 0 with a forged tag. */
+static const uint8_t HZL_TEST_DOS_FORGED_SADFD[64] = {
+        // Header 0
+        0,  // GID
+        2,  // SID
+        4,  // PTY == SADFD
+        0x33, 0x22, 0x11,  // Ctrnonce
+        5,  // ptlen
+        11, 22, 33, 44, 55,  // ctext
+        20, 21, 22, 23, 24, 25, 26, 27  // tag (incorrect)
+};
+
+/** UAD message from SID 1 in GID 0. */
+static const uint8_t HZL_TEST_DOS_UAD[7] = {0, 1, 5, 11, 22, 33, 44};
+
+static void
+hzlServerTest_ServerDosStateMustBeNotNull(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    const hzl_ServerDosConfig_t dosConfig = {.perClient = {.msgsPerSecond = 1, .burstMsgs = 2}};
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .dosConfig = &dosConfig,
+            .dosState = NULL,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_ERR_NULL_DOS_STATE);
+}
+
+static void
+hzlServerTest_ServerDosLimitMustHaveNonZeroBurst(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerDosState_t dosState;
+    hzl_ServerDosConfig_t dosConfig = {.perClient = {.msgsPerSecond = 1, .burstMsgs = 0}};
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .dosConfig = &dosConfig,
+            .dosState = &dosState,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_ERR_INVALID_DOS_LIMIT);
+
+    dosConfig.perClient.burstMsgs = 1;
+    dosConfig.perGroup.burstMsgs = 0;
+    dosConfig.perGroup.msgsPerSecond = 1;
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_ERR_INVALID_DOS_LIMIT);
+
+    dosConfig.perGroup.burstMsgs = 1;
+    dosConfig.rejected.burstMsgs = 0;
+    dosConfig.rejected.msgsPerSecond = 1;
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_ERR_INVALID_DOS_LIMIT);
+
+    dosConfig.rejected.msgsPerSecond = 0;  // Disabled: burst is irrelevant
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+}
+
+static void
+hzlServerTest_ServerDosDropsOverClientLimit(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerDosState_t dosState;
+    const hzl_ServerDosConfig_t dosConfig = {.perClient = {.msgsPerSecond = 1, .burstMsgs = 2}};
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .dosConfig = &dosConfig,
+            .dosState = &dosState,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_Timestamp_t now = 0;
+    hzlTest_IoMockupCurrentTimeSucceeding(&now);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+
+    // The burst is accepted
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_VALID_REQ, 64, 0xABC, now);
+    atto_eq(err, HZL_OK);
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_VALID_REQ, 64, 0xABC, now);
+    atto_eq(err, HZL_OK);
+    // Dropped before validating the tag, no Response is built
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_VALID_REQ, 64, 0xABC, now);
+    atto_eq(err, HZL_ERR_SECWARN_DENIAL_OF_SERVICE);
+    atto_eq(msgToTx.dataLen, 0);
+    atto_eq(dosState.counters.droppedByClientLimit, 1);
+    // Other Clients have their own bucket
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_FORGED_SADFD, 64, 0xABC, now);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    // Not yet refilled of a full message
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_VALID_REQ, 64, 0xABC, now + 999);
+    atto_eq(err, HZL_ERR_SECWARN_DENIAL_OF_SERVICE);
+    atto_eq(dosState.counters.droppedByClientLimit, 2);
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_VALID_REQ, 64, 0xABC, now + 1000);
+    atto_eq(err, HZL_OK);
+    atto_eq(dosState.counters.droppedByGroupLimit, 0);
+    atto_eq(dosState.counters.droppedByRejectedBudget, 0);
+    atto_eq(dosState.counters.rejected, 1);
+}
+
+static void
+hzlServerTest_ServerDosDropsOverGroupLimit(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerDosState_t dosState;
+    const hzl_ServerDosConfig_t dosConfig = {.perGroup = {.msgsPerSecond = 1, .burstMsgs = 2}};
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .dosConfig = &dosConfig,
+            .dosState = &dosState,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_Timestamp_t now = 0;
+    hzlTest_IoMockupCurrentTimeSucceeding(&now);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_VALID_REQ, 64, 0xABC, now);
+    atto_eq(err, HZL_OK);
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_FORGED_SADFD, 64, 0xABC, now);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    // Any Client of the Group is dropped
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_VALID_REQ, 64, 0xABC, now);
+    atto_eq(err, HZL_ERR_SECWARN_DENIAL_OF_SERVICE);
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_FORGED_SADFD, 64, 0xABC, now);
+    atto_eq(err, HZL_ERR_SECWARN_DENIAL_OF_SERVICE);
+    atto_eq(dosState.counters.droppedByGroupLimit, 2);
+    atto_eq(dosState.counters.droppedByClientLimit, 0);
+    // Unsecured messages require no cryptographic operations and are never limited
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_UAD, sizeof(HZL_TEST_DOS_UAD), 0xABC, now);
+    atto_eq(err, HZL_OK);
+    atto_eq(unpackedMsg.dataLen, 4);
+    atto_eq(dosState.counters.droppedByGroupLimit, 2);
+}
+
+static void
+hzlServerTest_ServerDosDropsAllWhenRejectedBudgetIsExhausted(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerDosState_t dosState;
+    const hzl_ServerDosConfig_t dosConfig = {.rejected = {.msgsPerSecond = 1, .burstMsgs = 2}};
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .dosConfig = &dosConfig,
+            .dosState = &dosState,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_Timestamp_t now = 0;
+    hzlTest_IoMockupCurrentTimeSucceeding(&now);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+
+    // Valid messages do not consume the budget
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_VALID_REQ, 64, 0xABC, now);
+    atto_eq(err, HZL_OK);
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_FORGED_SADFD, 64, 0xABC, now);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_FORGED_SADFD, 64, 0xABC, now);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    atto_eq(dosState.counters.rejected, 2);
+    // Even valid messages are dropped until the budget refills
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_VALID_REQ, 64, 0xABC, now + 10);
+    atto_eq(err, HZL_ERR_SECWARN_DENIAL_OF_SERVICE);
+    atto_eq(dosState.counters.droppedByRejectedBudget, 1);
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx,
+                                      HZL_TEST_DOS_VALID_REQ, 64, 0xABC, now + 1000);
+    atto_eq(err, HZL_OK);
+    atto_eq(dosState.counters.rejected, 2);
+}
+
+static void
+hzlServerTest_ServerDosAlsoLimitsInPlaceProcessing(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerDosState_t dosState;
+    const hzl_ServerDosConfig_t dosConfig = {.perClient = {.msgsPerSecond = 1, .burstMsgs = 1}};
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .dosConfig = &dosConfig,
+            .dosState = &dosState,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_Timestamp_t now = 0;
+    hzlTest_IoMockupCurrentTimeSucceeding(&now);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduView_t unpackedView = {0};
+    uint8_t rxPdu[64];
+
+    memcpy(rxPdu, HZL_TEST_DOS_FORGED_SADFD, sizeof(rxPdu));
+    err = hzl_ServerProcessReceivedInPlace(&msgToTx, &unpackedView, &ctx,
+                                           rxPdu, sizeof(rxPdu), 0xABC, now);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    memcpy(rxPdu, HZL_TEST_DOS_FORGED_SADFD, sizeof(rxPdu));
+    err = hzl_ServerProcessReceivedInPlace(&msgToTx, &unpackedView, &ctx,
+                                           rxPdu, sizeof(rxPdu), 0xABC, now);
+    atto_eq(err, HZL_ERR_SECWARN_DENIAL_OF_SERVICE);
+    atto_memeq(rxPdu, HZL_TEST_DOS_FORGED_SADFD, sizeof(rxPdu));  // Not even decrypted
+    atto_eq(dosState.counters.droppedByClientLimit, 1);
+    atto_eq(dosState.counters.rejected, 1);
+
+    err = hzl_ServerDeInit(&ctx);
+    atto_eq(err, HZL_OK);
+    atto_zeros(&dosState, sizeof(dosState));
+}
+
+void hzlServerTest_ServerDos(void)
+{
+    hzlServerTest_ServerDosStateMustBeNotNull();
+    hzlServerTest_ServerDosLimitMustHaveNonZeroBurst();
+    hzlServerTest_ServerDosDropsOverClientLimit();
+    hzlServerTest_ServerDosDropsOverGroupLimit();
+    hzlServerTest_ServerDosDropsAllWhenRejectedBudgetIsExhausted();
+    hzlServerTest_ServerDosAlsoLimitsInPlaceProcessing();
+    HZL_TEST_PARTIAL_REPORT();
+}
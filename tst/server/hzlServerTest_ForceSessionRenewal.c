@@ -89,7 +89,8 @@ hzlServerTest_ServerForceSessionRenewalGidMustBeValid(void)
     // Assume at least one Client Requested the state already:
     // the last RX message was after the start of the session.
     hzlTest_IoMockupCurrentTimeSucceeding(
-            &groupStates[ctx.serverConfig->amountOfGroups - 1U].currentRxLastMessageInstant);
+            &HZL_TEST_SERVER_GROUP_HOT(&ctx, ctx.serverConfig->amountOfGroups - 1U)
+                    ->currentRxLastMessageInstant);
 
     err = hzl_ServerForceSessionRenewal(&msgToTx, &ctx, ctx.serverConfig->amountOfGroups);
     atto_eq(err, HZL_ERR_UNKNOWN_GROUP);
@@ -135,13 +136,14 @@ hzlServerTest_ServerForceSessionRenewalRenewsAndBuildsRenMsg(void)
     atto_eq(err, HZL_OK);
     hzl_CbsPduMsg_t msgToTx = {0};
     // Dummy non-zero ctrnonce to see that it's used
-    groupStates[1].currentCtrNonce = 0x110022;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentCtrNonce = 0x110022;
     // Dummy STK
     groupStates[1].currentStk[0] = 99;
     memset(&groupStates[1].currentStk[1], 0, 15);  // The rest is zeros
     // Assume at least one Client Requested the state already:
     // the last RX message was after the start of the session.
-    hzlTest_IoMockupCurrentTimeSucceeding(&groupStates[1].currentRxLastMessageInstant);
+    hzlTest_IoMockupCurrentTimeSucceeding(
+            &HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentRxLastMessageInstant);
 
     err = hzl_ServerForceSessionRenewal(&msgToTx, &ctx, 1);
 
@@ -149,9 +151,10 @@ hzlServerTest_ServerForceSessionRenewalRenewsAndBuildsRenMsg(void)
     // Session was renewed
     atto_neq(groupStates[1].currentStk[0], 99);
     atto_eq(groupStates[1].previousStk[0], 99);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->sessionState, HZL_SESSION_STATE_RENEWING);
     // Greater by 1 because it was incremented after building the REN
-    atto_eq(groupStates[1].previousCtrNonce, 0x110023);
-    atto_eq(groupStates[1].currentCtrNonce, 0);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->previousCtrNonce, 0x110023);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentCtrNonce, 0);
     // REN message available
     atto_eq(msgToTx.dataLen, 3 + 19);
     // Packed header 0
@@ -169,7 +172,7 @@ hzlServerTest_ServerForceSessionRenewalRenewsAndBuildsRenMsg(void)
     };
     atto_memeq(&msgToTx.data[6], expectedTag, 16);
     // Ctrnonce was incremented in the state
-    atto_eq(groupStates[1].previousCtrNonce, 0x110023);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->previousCtrNonce, 0x110023);
 }
 
 static void
@@ -188,13 +191,14 @@ hzlServerTest_ServerForceSessionRenewalOnlyBuildRenMsgDuringExistingRenewal(void
     atto_eq(err, HZL_OK);
     hzl_CbsPduMsg_t msgToTx = {0};
     // Dummy non-zero ctrnonce to see that it's used
-    groupStates[1].currentCtrNonce = 0x110022;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentCtrNonce = 0x110022;
     // Dummy STK
     groupStates[1].currentStk[0] = 99;
     memset(&groupStates[1].currentStk[1], 0, 15);  // The rest is zeros
     // Assume at least one Client Requested the state already:
     // the last RX message was after the start of the session.
-    hzlTest_IoMockupCurrentTimeSucceeding(&groupStates[1].currentRxLastMessageInstant);
+    hzlTest_IoMockupCurrentTimeSucceeding(
+            &HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentRxLastMessageInstant);
 
     err = hzl_ServerForceSessionRenewal(&msgToTx, &ctx, 1);
     atto_eq(err, HZL_OK);
@@ -205,8 +209,8 @@ hzlServerTest_ServerForceSessionRenewalOnlyBuildRenMsgDuringExistingRenewal(void
     uint8_t currentStkAtFirstRenewalCall[16];
     memcpy(currentStkAtFirstRenewalCall, groupStates[1].currentStk, 16);
     // Greater by 1 because it was incremented after building the REN
-    atto_eq(groupStates[1].previousCtrNonce, 0x110023);
-    atto_eq(groupStates[1].currentCtrNonce, 0);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->previousCtrNonce, 0x110023);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentCtrNonce, 0);
     // REN message available
     atto_eq(msgToTx.dataLen, 3 + 19);
 
@@ -217,8 +221,8 @@ hzlServerTest_ServerForceSessionRenewalOnlyBuildRenMsgDuringExistingRenewal(void
     atto_eq(groupStates[1].previousStk[0], 99);
     atto_memeq(groupStates[1].currentStk, currentStkAtFirstRenewalCall, 16);
     // Greater by 2 because it was incremented after building the SECOND REN
-    atto_eq(groupStates[1].previousCtrNonce, 0x110024);
-    atto_eq(groupStates[1].currentCtrNonce, 0);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->previousCtrNonce, 0x110024);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentCtrNonce, 0);
     // REN message available
     atto_eq(msgToTx.dataLen, 3 + 19);
 
@@ -229,12 +233,101 @@ hzlServerTest_ServerForceSessionRenewalOnlyBuildRenMsgDuringExistingRenewal(void
     atto_eq(groupStates[1].previousStk[0], 99);
     atto_memeq(groupStates[1].currentStk, currentStkAtFirstRenewalCall, 16);
     // Greater by 3 because it was incremented after building the THIRD REN
-    atto_eq(groupStates[1].previousCtrNonce, 0x110025);
-    atto_eq(groupStates[1].currentCtrNonce, 0);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->previousCtrNonce, 0x110025);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentCtrNonce, 0);
     // REN message available
     atto_eq(msgToTx.dataLen, 3 + 19);
 }
 
+static void
+hzlServerTest_ServerForceSessionRenewalMovesExpandedStkToPrevious(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    atto_false(groupStates[1].currentAeadKey.isExpanded);
+    atto_false(groupStates[1].previousAeadKey.isExpanded);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    const uint8_t userData[] = {1, 2, 3};
+    // Dummy STK
+    groupStates[1].currentStk[0] = 99;
+    memset(&groupStates[1].currentStk[1], 0, 15);  // The rest is zeros
+    // Assume at least one Client Requested the state already:
+    // the last RX message was after the start of the session.
+    hzlTest_IoMockupCurrentTimeSucceeding(
+            &HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentRxLastMessageInstant);
+    // Using the STK expands it
+    err = hzl_ServerBuildSecuredFd(&msgToTx, &ctx, userData, sizeof(userData), 1);
+    atto_eq(err, HZL_OK);
+    atto_true(groupStates[1].currentAeadKey.isExpanded);
+
+    err = hzl_ServerForceSessionRenewal(&msgToTx, &ctx, 1);
+
+    atto_eq(err, HZL_OK);
+    // The expanded old STK is kept for the renewal phase, the new one was expanded in advance
+    atto_true(groupStates[1].previousAeadKey.isExpanded);
+    atto_true(groupStates[1].currentAeadKey.isExpanded);
+    // Used up: without a timer wheel, the next renewal generates it on the spot
+    atto_false(groupStates[1].nextAeadKey.isExpanded);
+    // Assume at least one Client Requested the new state already.
+    hzlTest_IoMockupCurrentTimeSucceeding(
+            &HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentRxLastMessageInstant);
+    err = hzl_ServerBuildSecuredFd(&msgToTx, &ctx, userData, sizeof(userData), 1);
+    atto_eq(err, HZL_OK);
+    atto_true(groupStates[1].currentAeadKey.isExpanded);
+    err = hzl_ServerDeInit(&ctx);
+    atto_eq(err, HZL_OK);
+}
+
+static void
+hzlServerTest_ServerForceSessionRenewalUsesNextStkWithoutTrng(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    uint8_t nextStk[HZL_STK_LEN];
+    memcpy(nextStk, groupStates[1].nextStk, HZL_STK_LEN);
+    hzlTest_IoMockupCurrentTimeSucceeding(
+            &HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentRxLastMessageInstant);
+    // The TRNG is not needed anymore to start a Session
+    ctx.io.trng = hzlTest_IoMockupTrngFailing;
+
+    err = hzl_ServerForceSessionRenewal(&msgToTx, &ctx, 1);
+
+    atto_eq(err, HZL_OK);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->sessionState, HZL_SESSION_STATE_RENEWING);
+    atto_memeq(groupStates[1].currentStk, nextStk, HZL_STK_LEN);
+    atto_false(groupStates[1].nextAeadKey.isExpanded);
+    atto_eq(msgToTx.dataLen, 3 + 19);
+    // Without a next STK, the TRNG is called and its failure leaves the Session untouched
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->sessionState = HZL_SESSION_STATE_ACTIVE;
+    hzlTest_IoMockupCurrentTimeSucceeding(
+            &HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentRxLastMessageInstant);
+    err = hzl_ServerForceSessionRenewal(&msgToTx, &ctx, 1);
+    atto_eq(err, HZL_ERR_CANNOT_GENERATE_RANDOM);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->sessionState, HZL_SESSION_STATE_ACTIVE);
+    atto_memeq(groupStates[1].currentStk, nextStk, HZL_STK_LEN);
+    err = hzl_ServerDeInit(&ctx);
+    atto_eq(err, HZL_OK);
+}
+
 void hzlServerTest_ServerForceSessionRenewal(void)
 {
     hzlServerTest_ServerForceSessionRenewalMsgToTxMustBeNotNull();
@@ -243,5 +336,7 @@ void hzlServerTest_ServerForceSessionRenewal(void)
     hzlServerTest_ServerForceSessionRenewalRequiresSomeClientsRequestedAlready();
     hzlServerTest_ServerForceSessionRenewalRenewsAndBuildsRenMsg();
     hzlServerTest_ServerForceSessionRenewalOnlyBuildRenMsgDuringExistingRenewal();
+    hzlServerTest_ServerForceSessionRenewalMovesExpandedStkToPrevious();
+    hzlServerTest_ServerForceSessionRenewalUsesNextStkWithoutTrng();
     HZL_TEST_PARTIAL_REPORT();
 }
@@ -132,17 +132,26 @@ hzlServerTest_ServerInitCorrectCtxSucceedsInitsAllSessions(void)
     for (size_t i = 0; i < ctx.serverConfig->amountOfGroups; i++)
     {
         // The session timestamp was initialised during the call
-        atto_gt(ctx.groupStates[i].sessionStartInstant, timestampBefore);
-        atto_lt(ctx.groupStates[i].sessionStartInstant, timestampAfter);
+        atto_gt(HZL_TEST_SERVER_GROUP_HOT(&ctx, i)->sessionStartInstant, timestampBefore);
+        atto_lt(HZL_TEST_SERVER_GROUP_HOT(&ctx, i)->sessionStartInstant, timestampAfter);
         // The STK contains "fake random" values from the mockup TRNG function
         atto_memeq(ctx.groupStates[i].currentStk, expectedRandomStk, HZL_STK_LEN);
-        atto_eq(ctx.groupStates[i].currentCtrNonce, 0);
+        atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, i)->currentCtrNonce, 0);
         // There was no message received yet
-        atto_eq(ctx.groupStates[i].currentRxLastMessageInstant,
-                ctx.groupStates[i].sessionStartInstant);
+        atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, i)->currentRxLastMessageInstant,
+                HZL_TEST_SERVER_GROUP_HOT(&ctx, i)->sessionStartInstant);
         // Previous session is cleared
-        atto_eq(ctx.groupStates[i].previousCtrNonce, 0);
+        atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, i)->previousCtrNonce, 0);
         atto_zeros(ctx.groupStates[i].previousStk, HZL_STK_LEN);
+        atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, i)->sessionState, HZL_SESSION_STATE_ACTIVE);
+        // Renewal phase deadlines are precomputed
+        atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, i)->renewalPhaseEndCtrNonce,
+                2U * ctx.groupConfigs[i].maxCtrnonceDelayMsgs);
+        atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, i)->renewalPhaseEndMillis,
+                6U * ctx.groupConfigs[i].delayBetweenRenNotificationsMillis);
+        // STK of the next Session is ready in advance
+        atto_true(ctx.groupStates[i].nextAeadKey.isExpanded);
+        atto_memeq(ctx.groupStates[i].nextStk, expectedRandomStk, HZL_STK_LEN);
     }
 }
 
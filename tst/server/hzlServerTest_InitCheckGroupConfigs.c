@@ -235,11 +235,11 @@ hzlServerTest_ServerInitGroupConfigsBitmapMustHaveAtLeastOneClient(void)
             .io = HZL_TEST_CORRECT_IO,
     };
 
-    modifiedGroupConfigs[1].clientSidsInGroupBitmap = 0;
+    modifiedGroupConfigs[1].clientSidsInGroupBitmap[0] = 0;
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_ERR_CLIENTS_BITMAP_ZERO_CLIENTS);
 
-    modifiedGroupConfigs[1].clientSidsInGroupBitmap = 1;
+    modifiedGroupConfigs[1].clientSidsInGroupBitmap[0] = 1;
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
 }
@@ -262,12 +262,12 @@ hzlServerTest_ServerInitGroupConfigsBitmapMustHaveKnownClients(void)
     };
 
     // Bits outside of the range of known clients
-    modifiedGroupConfigs[1].clientSidsInGroupBitmap = 0xFFFFFFFF;
+    modifiedGroupConfigs[1].clientSidsInGroupBitmap[0] = 0xFFFFFFFF;
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_ERR_CLIENTS_BITMAP_UNKNOWN_SID);
 
     // ALL known clients, but no extra ones.
-    modifiedGroupConfigs[1].clientSidsInGroupBitmap =
+    modifiedGroupConfigs[1].clientSidsInGroupBitmap[0] =
             (1U << ctx.serverConfig->amountOfClients) - 1U;
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
@@ -289,31 +289,82 @@ hzlServerTest_ServerInitGroupConfigsBitmapMustHaveCompleteBroadcastGroup(void)
             .groupStates = groupStates,
             .io = HZL_TEST_CORRECT_IO,
     };
-    hzl_ServerBitMap_t broadcastBitmap = 0;
+    hzl_ServerBitMapWord_t broadcastBitmap = 0;
     for (size_t i = 0U; i < ctx.serverConfig->amountOfClients; i++)
     {
         broadcastBitmap |= 1U << i;
     }
 
     // Subset of bits is rejected.
-    modifiedGroupConfigs[0].clientSidsInGroupBitmap = broadcastBitmap >> 1U;
+    modifiedGroupConfigs[0].clientSidsInGroupBitmap[0] = broadcastBitmap >> 1U;
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_ERR_CLIENTS_BITMAP_INVALID_BROADCAST_GROUP);
 
-    modifiedGroupConfigs[0].clientSidsInGroupBitmap = ~(broadcastBitmap & 2);
+    modifiedGroupConfigs[0].clientSidsInGroupBitmap[0] = ~(broadcastBitmap & 2);
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_ERR_CLIENTS_BITMAP_INVALID_BROADCAST_GROUP);
 
-    modifiedGroupConfigs[0].clientSidsInGroupBitmap = broadcastBitmap;
+    modifiedGroupConfigs[0].clientSidsInGroupBitmap[0] = broadcastBitmap;
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
 
     // One bit higher than the rest of the bitmap
-    modifiedGroupConfigs[0].clientSidsInGroupBitmap = (broadcastBitmap << 1U) | 1U;
+    modifiedGroupConfigs[0].clientSidsInGroupBitmap[0] = (broadcastBitmap << 1U) | 1U;
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
 }
 
+#if HZL_SERVER_MAX_AMOUNT_OF_CLIENTS >= 40U
+
+static void
+hzlServerTest_ServerInitGroupConfigsBitmapSpansMultipleWords(void)
+{
+    hzl_Err_t err;
+    hzl_ServerConfig_t modifiedServerConfig = HZL_TEST_CORRECT_SERVER_CONFIG;
+    hzl_ServerClientConfig_t manyClientConfigs[40];
+    for (size_t i = 0; i < 40U; i++)
+    {
+        manyClientConfigs[i] = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS[0];
+        manyClientConfigs[i].sid = (hzl_Sid_t) (i + 1U);
+    }
+    hzl_ServerGroupConfig_t modifiedGroupConfigs[HZL_MAX_TEST_AMOUNT_OF_GROUPS];
+    memcpy(modifiedGroupConfigs,
+           HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+           sizeof(hzl_ServerGroupConfig_t) * HZL_MAX_TEST_AMOUNT_OF_GROUPS);
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &modifiedServerConfig,
+            .clientConfigs = manyClientConfigs,
+            .groupConfigs = modifiedGroupConfigs,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    modifiedServerConfig.amountOfClients = 40U;
+
+    // SIDs [1, 32] in the first word, [33, 40] in the second one: SID 40 missing
+    modifiedGroupConfigs[0].clientSidsInGroupBitmap[0] = 0xFFFFFFFFU;
+    modifiedGroupConfigs[0].clientSidsInGroupBitmap[1] = 0x7FU;
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_ERR_CLIENTS_BITMAP_INVALID_BROADCAST_GROUP);
+
+    modifiedGroupConfigs[0].clientSidsInGroupBitmap[1] = 0xFFU;
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+
+    // Only SID 41, which is unknown
+    modifiedGroupConfigs[1].clientSidsInGroupBitmap[0] = 0U;
+    modifiedGroupConfigs[1].clientSidsInGroupBitmap[1] = 0x100U;
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_ERR_CLIENTS_BITMAP_UNKNOWN_SID);
+
+    // Only SID 40
+    modifiedGroupConfigs[1].clientSidsInGroupBitmap[1] = 0x80U;
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+}
+
+#endif  /* HZL_SERVER_MAX_AMOUNT_OF_CLIENTS >= 40U */
+
 void hzlServerTest_ServerInitCheckGroupConfigs(void)
 {
     hzlServerTest_ServerInitGroupConfigsMustBeNotNull();
@@ -326,5 +377,8 @@ void hzlServerTest_ServerInitCheckGroupConfigs(void)
     hzlServerTest_ServerInitGroupConfigsBitmapMustHaveAtLeastOneClient();
     hzlServerTest_ServerInitGroupConfigsBitmapMustHaveKnownClients();
     hzlServerTest_ServerInitGroupConfigsBitmapMustHaveCompleteBroadcastGroup();
+#if HZL_SERVER_MAX_AMOUNT_OF_CLIENTS >= 40U
+    hzlServerTest_ServerInitGroupConfigsBitmapSpansMultipleWords();
+#endif
     HZL_TEST_PARTIAL_REPORT();
 }
@@ -112,6 +112,26 @@ hzlServerTest_ServerInitConfigHeaderTypeMustBeStandard(void)
     atto_eq(err, HZL_ERR_INVALID_HEADER_TYPE);
 }
 
+static void
+hzlServerTest_ServerInitConfigHeaderPlacementMustBeStandard(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerConfig_t modifiedServerConfig = HZL_TEST_CORRECT_SERVER_CONFIG;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &modifiedServerConfig,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    modifiedServerConfig.headerPlacement = HZL_HEADER_MIXED + 1U;
+
+    err = hzl_ServerInit(&ctx);
+
+    atto_eq(err, HZL_ERR_INVALID_HEADER_PLACEMENT);
+}
+
 static void
 hzlServerTest_ServerInitConfigServerAmountOfGroupsMustFitForHeaderType(void)
 {
@@ -190,9 +210,11 @@ hzlServerTest_ServerInitConfigServerAmountOfClientsMustFitInBitmap(void)
             .io = HZL_TEST_CORRECT_IO,
     };
 
+#if HZL_SERVER_MAX_AMOUNT_OF_CLIENTS < 255U
     modifiedServerConfig.amountOfClients = HZL_SERVER_MAX_AMOUNT_OF_CLIENTS + 1;
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_ERR_TOO_MANY_CLIENTS);
+#endif
 
     modifiedServerConfig.amountOfClients = HZL_SERVER_MAX_AMOUNT_OF_CLIENTS;
     err = hzl_ServerInit(&ctx);
@@ -234,6 +256,7 @@ void hzlServerTest_ServerInitCheckServerConfig(void)
     hzlServerTest_ServerInitConfigAmountOfGroupsMustBePositive();
     hzlServerTest_ServerInitConfigAmountOfClientsMustBePositive();
     hzlServerTest_ServerInitConfigHeaderTypeMustBeStandard();
+    hzlServerTest_ServerInitConfigHeaderPlacementMustBeStandard();
     hzlServerTest_ServerInitConfigServerAmountOfGroupsMustFitForHeaderType();
     hzlServerTest_ServerInitConfigServerAmountOfClientsMustFitForHeaderType();
     hzlServerTest_ServerInitConfigServerAmountOfClientsMustFitInBitmap();
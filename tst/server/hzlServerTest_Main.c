@@ -36,10 +36,14 @@
 
 /**
  * Main function, running all test cases for the Server lib.
+ *
+ * With a fixed header type, runs only the ones building and processing received messages,
+ * which pack and unpack the header, skipping their cases with other header types.
  * @return 0 if all tests passed, non-zero otherwise.
  */
 int main(void)
 {
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlServerTest_ServerInit();
     hzlServerTest_ServerInitCheckServerConfig();
     hzlServerTest_ServerInitCheckClientConfigs();
@@ -47,14 +51,23 @@ int main(void)
     hzlServerTest_ServerInitCheckIo();
     hzlServerTest_ServerDeinit();
     hzlServerTest_ServerNew();
+#endif
     hzlServerTest_ServerBuildUnsecured();
     hzlServerTest_ServerBuildSecuredFd();
+    hzlServerTest_ServerBuildCanFilters();
     hzlServerTest_ServerProcessReceived();
     hzlServerTest_ServerProcessReceivedRequest();
     hzlServerTest_ServerProcessReceivedServerOnlyMsg();
     hzlServerTest_ServerProcessReceivedUnsecured();
     hzlServerTest_ServerProcessReceivedSecuredFd();
+    hzlServerTest_ServerProcessReceivedBatch();
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlServerTest_ServerForceSessionRenewal();
+    hzlServerTest_ServerTick();
+#endif
+    hzlServerTest_ServerDos();
+    hzlServerTest_ServerRejectedCache();
+    hzlServerTest_ServerSecuredTp();
     HZL_TEST_PARTIAL_REPORT();
     return atto_at_least_one_fail;
 }
@@ -106,12 +106,14 @@ hzlServerTest_ServerNewFileMustHaveValidConfig(void)
 
     err = hzl_ServerNew(&ctx, "serverconfigfiles/invalidHeaderType.hzl");
     atto_eq(err, HZL_ERR_INVALID_HEADER_TYPE);
+    atto_eq(ctx, NULL);  // Rejected while decoding, before allocating
 
     err = hzl_ServerNew(&ctx, "serverconfigfiles/invalidSidOrder.hzl");
     atto_eq(err, HZL_ERR_SIDS_ARE_NOT_PRESORTED_STRICTLY_ASCENDING);
 
     err = hzl_ServerNew(&ctx, "serverconfigfiles/invalidLtk.hzl");
     atto_eq(err, HZL_ERR_LTK_IS_ALL_ZEROS);
+    atto_eq(ctx, NULL);  // Rejected while decoding, after allocating
 
     err = hzl_ServerNew(&ctx, "serverconfigfiles/invalidGidOrder.hzl");
     atto_eq(err, HZL_ERR_GAP_IN_GIDS);
@@ -167,7 +169,7 @@ hzlServerTest_ServerNewFileValidIsAccepted(void)
     atto_eq(ctx->groupConfigs[0].ctrNonceUpperLimit, 0xFF0000U);
     atto_eq(ctx->groupConfigs[0].sessionDurationMillis, 36000000);
     atto_eq(ctx->groupConfigs[0].delayBetweenRenNotificationsMillis, 10000);
-    atto_eq(ctx->groupConfigs[0].clientSidsInGroupBitmap, 0xFFFFFFFFU);
+    atto_eq(ctx->groupConfigs[0].clientSidsInGroupBitmap[0], 0xFFFFFFFFU);
     atto_eq(ctx->groupConfigs[0].maxSilenceIntervalMillis, 5000);
     atto_eq(ctx->groupConfigs[0].gid, 0);
 
@@ -175,7 +177,7 @@ hzlServerTest_ServerNewFileValidIsAccepted(void)
     atto_eq(ctx->groupConfigs[1].ctrNonceUpperLimit, 1000);
     atto_eq(ctx->groupConfigs[1].sessionDurationMillis, 36000000);
     atto_eq(ctx->groupConfigs[1].delayBetweenRenNotificationsMillis, 5000);
-    atto_eq(ctx->groupConfigs[1].clientSidsInGroupBitmap, 0x06U);
+    atto_eq(ctx->groupConfigs[1].clientSidsInGroupBitmap[0], 0x06U);
     atto_eq(ctx->groupConfigs[1].maxSilenceIntervalMillis, 5000);
     atto_eq(ctx->groupConfigs[1].gid, 1);
 
@@ -183,7 +185,7 @@ hzlServerTest_ServerNewFileValidIsAccepted(void)
     atto_eq(ctx->groupConfigs[2].ctrNonceUpperLimit, 0xFF0000U);
     atto_eq(ctx->groupConfigs[2].sessionDurationMillis, 36000000);
     atto_eq(ctx->groupConfigs[2].delayBetweenRenNotificationsMillis, 5000);
-    atto_eq(ctx->groupConfigs[2].clientSidsInGroupBitmap, 0x01U);
+    atto_eq(ctx->groupConfigs[2].clientSidsInGroupBitmap[0], 0x01U);
     atto_eq(ctx->groupConfigs[2].maxSilenceIntervalMillis, 5001);
     atto_eq(ctx->groupConfigs[2].gid, 2);
 
@@ -191,7 +193,7 @@ hzlServerTest_ServerNewFileValidIsAccepted(void)
     atto_eq(ctx->groupConfigs[3].ctrNonceUpperLimit, 0xFF0000U);
     atto_eq(ctx->groupConfigs[3].sessionDurationMillis, 36000000);
     atto_eq(ctx->groupConfigs[3].delayBetweenRenNotificationsMillis, 5000);
-    atto_eq(ctx->groupConfigs[3].clientSidsInGroupBitmap, 0x03U);
+    atto_eq(ctx->groupConfigs[3].clientSidsInGroupBitmap[0], 0x03U);
     atto_eq(ctx->groupConfigs[3].maxSilenceIntervalMillis, 5002);
     atto_eq(ctx->groupConfigs[3].gid, 3);
 
@@ -199,7 +201,7 @@ hzlServerTest_ServerNewFileValidIsAccepted(void)
     atto_eq(ctx->groupConfigs[4].ctrNonceUpperLimit, 16710000);
     atto_eq(ctx->groupConfigs[4].sessionDurationMillis, 36000001);
     atto_eq(ctx->groupConfigs[4].delayBetweenRenNotificationsMillis, 5077);
-    atto_eq(ctx->groupConfigs[4].clientSidsInGroupBitmap, 0x04U);
+    atto_eq(ctx->groupConfigs[4].clientSidsInGroupBitmap[0], 0x04U);
     atto_eq(ctx->groupConfigs[4].maxSilenceIntervalMillis, 5000);
     atto_eq(ctx->groupConfigs[4].gid, 4);
 
@@ -208,13 +210,13 @@ hzlServerTest_ServerNewFileValidIsAccepted(void)
     {
         // The STK contains true random values from the OS TRNG function
         atto_assert(hzlServerTest_NotAllZeros(ctx->groupStates[i].currentStk, HZL_STK_LEN));
-        atto_eq(ctx->groupStates[i].currentCtrNonce, 0);
+        atto_eq(HZL_TEST_SERVER_GROUP_HOT(ctx, i)->currentCtrNonce, 0);
         // There was no message received yet
-        atto_eq(ctx->groupStates[i].currentRxLastMessageInstant,
-                ctx->groupStates[i].sessionStartInstant);
-        atto_neq(ctx->groupStates[i].sessionStartInstant, 0);
+        atto_eq(HZL_TEST_SERVER_GROUP_HOT(ctx, i)->currentRxLastMessageInstant,
+                HZL_TEST_SERVER_GROUP_HOT(ctx, i)->sessionStartInstant);
+        atto_neq(HZL_TEST_SERVER_GROUP_HOT(ctx, i)->sessionStartInstant, 0);
         // Previous session is cleared
-        atto_eq(ctx->groupStates[i].previousCtrNonce, 0);
+        atto_eq(HZL_TEST_SERVER_GROUP_HOT(ctx, i)->previousCtrNonce, 0);
         atto_zeros(ctx->groupStates[i].previousStk, HZL_STK_LEN);
     }
     atto_neq(ctx->io.trng, NULL);
@@ -223,6 +225,92 @@ hzlServerTest_ServerNewFileValidIsAccepted(void)
     hzl_ServerFree(&ctx);
 }
 
+static void
+hzlServerTest_ServerNewFileV1LoadsVariableWidthBitmap(void)
+{
+    hzl_Err_t err;
+    hzl_ServerCtx_t* ctx = NULL;
+
+    // Same content as Server.hzl, but each bitmap is 1 B long as there are 3 Clients
+    err = hzl_ServerNew(&ctx, "serverconfigfiles/ServerBitmapV1.hzl");
+
+    atto_eq(err, HZL_OK);
+    atto_eq(ctx->serverConfig->amountOfClients, 3);
+    atto_eq(ctx->groupConfigs[0].clientSidsInGroupBitmap[0], 0xFFU);
+    atto_eq(ctx->groupConfigs[1].clientSidsInGroupBitmap[0], 0x06U);
+    atto_eq(ctx->groupConfigs[2].clientSidsInGroupBitmap[0], 0x01U);
+    atto_eq(ctx->groupConfigs[3].clientSidsInGroupBitmap[0], 0x03U);
+    atto_eq(ctx->groupConfigs[4].clientSidsInGroupBitmap[0], 0x04U);
+    for (size_t w = 1U; w < HZL_SERVER_BITMAP_WORDS; w++)
+    {
+        atto_eq(ctx->groupConfigs[0].clientSidsInGroupBitmap[w], 0U);
+    }
+    // The fields after the bitmap are still aligned
+    atto_eq(ctx->groupConfigs[4].maxSilenceIntervalMillis, 5000);
+    atto_eq(ctx->groupConfigs[4].gid, 4);
+
+    hzl_ServerFree(&ctx);
+}
+
+static void
+hzlServerTest_ServerNewTrngProvidesFreshBytes(void)
+{
+    hzl_Err_t err;
+    hzl_ServerCtx_t* ctx = NULL;
+    err = hzl_ServerNew(&ctx, "serverconfigfiles/Server.hzl");
+    atto_eq(err, HZL_OK);
+    uint8_t first[16] = {0};
+    uint8_t second[16] = {0};
+    // Longer than the internal pool of the default CSPRNG, so it gets refilled in between
+    uint8_t large[1000] = {0};
+
+    err = ctx->io.trng(first, sizeof(first));
+    atto_eq(err, HZL_OK);
+    err = ctx->io.trng(large, sizeof(large));
+    atto_eq(err, HZL_OK);
+    err = ctx->io.trng(second, sizeof(second));
+    atto_eq(err, HZL_OK);
+
+    atto_assert(hzlServerTest_NotAllZeros(first, sizeof(first)));
+    atto_assert(hzlServerTest_NotAllZeros(second, sizeof(second)));
+    atto_assert(hzlServerTest_NotAllZeros(&large[sizeof(large) - 16], 16));
+    atto_neq(memcmp(first, second, sizeof(first)), 0);
+    atto_neq(memcmp(large, &large[256], 16), 0);
+
+    hzl_ServerFree(&ctx);
+}
+
+static void
+hzlServerTest_ServerNewLaysOutOneAlignedArena(void)
+{
+    hzl_Err_t err;
+    hzl_ServerCtx_t* ctx = NULL;
+
+    err = hzl_ServerNew(&ctx, "serverconfigfiles/Server.hzl");
+
+    atto_eq(err, HZL_OK);
+    // The context and its arrays in access order, each on its own cache line
+    const uintptr_t regions[] = {
+            (uintptr_t) ctx,
+            (uintptr_t) ctx->serverConfig,
+            (uintptr_t) ctx->groupConfigs,
+            (uintptr_t) ctx->groupStates,
+            (uintptr_t) ctx->clientConfigs,
+            (uintptr_t) ctx->clientStates,
+            (uintptr_t) ctx->timerWheel,
+    };
+    for (size_t i = 0; i < sizeof(regions) / sizeof(regions[0]); i++)
+    {
+        atto_eq(regions[i] % HZL_CACHE_LINE_LEN, 0);
+        atto_lt(regions[i], (uintptr_t) ctx + ctx->arenaLen);
+        if (i > 0) { atto_lt(regions[i - 1], regions[i]); }
+    }
+    atto_eq(ctx->arenaLen % HZL_CACHE_LINE_LEN, 0);
+
+    hzl_ServerFree(&ctx);
+    atto_eq(ctx, NULL);
+}
+
 #endif  /* HZL_OS_AVAILABLE */
 
 void hzlServerTest_ServerNew(void)
@@ -235,6 +323,9 @@ void hzlServerTest_ServerNew(void)
     hzlServerTest_ServerNewFileMustHaveProperLength();
     hzlServerTest_ServerNewFileMustHaveValidConfig();
     hzlServerTest_ServerNewFileValidIsAccepted();
+    hzlServerTest_ServerNewFileV1LoadsVariableWidthBitmap();
+    hzlServerTest_ServerNewTrngProvidesFreshBytes();
+    hzlServerTest_ServerNewLaysOutOneAlignedArena();
     HZL_TEST_PARTIAL_REPORT();
 #endif  /* HZL_OS_AVAILABLE */
 }
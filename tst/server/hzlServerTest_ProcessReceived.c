@@ -29,7 +29,8 @@
 /**
  * @file
  * @internal
- * Tests of the hzl_ServerProcessReceived() function, generic part.
+ * Tests of the hzl_ServerProcessReceived() and hzl_ServerProcessReceivedAt() functions,
+ * generic part.
  *
  * @warning
  * REDUCING COVERAGE ON PURPOSE. NOT implementing all the testcases for all possible incorrect
@@ -134,6 +135,7 @@ hzlServerTest_ServerProcessReceivedMsgMustHaveEnoughDataLenForCbsHeader0(void)
     atto_zeros(&msgToTx, sizeof(hzl_CbsPduMsg_t)); // No msg to transmit
 }
 
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
 static void
 hzlServerTest_ServerProcessReceivedMsgMustHaveEnoughDataLenForCbsHeader4(void)
 {
@@ -170,6 +172,7 @@ hzlServerTest_ServerProcessReceivedMsgMustHaveEnoughDataLenForCbsHeader4(void)
     atto_eq(err, HZL_OK);
     atto_zeros(&msgToTx, sizeof(hzl_CbsPduMsg_t)); // No msg to transmit
 }
+#endif
 
 static void
 hzlServerTest_ServerProcessReceivedMsgMustHaveKnownPtyField(void)
@@ -233,6 +236,63 @@ hzlServerTest_ServerProcessReceivedMsgMustNotHaveServerSid(void)
     atto_eq(err, HZL_ERR_SECWARN_MESSAGE_FROM_MYSELF);
 }
 
+static void
+hzlServerTest_ServerProcessReceivedAtNullChecks(void)
+{
+    hzl_Err_t err;
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+
+    err = hzl_ServerProcessReceivedAt(NULL, NULL, NULL, NULL, 0, 0xABC, 1000);
+    atto_eq(err, HZL_ERR_NULL_PDU);
+    err = hzl_ServerProcessReceivedAt(&msgToTx, NULL, NULL, NULL, 0, 0xABC, 1000);
+    atto_eq(err, HZL_ERR_NULL_SDU);
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, NULL, NULL, 0, 0xABC, 1000);
+    atto_eq(err, HZL_ERR_NULL_CTX);
+}
+
+static void
+hzlServerTest_ServerProcessReceivedAtUsesGivenTimestamp(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    // The clock is not read at all when the timestamp is provided
+    ctx.io.currentTime = hzlTest_IoMockupCurrentTimeFailing;
+    const hzl_Timestamp_t rxTimestamp =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant + 1234U;
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+    const uint8_t rxPdu[64] = {
+            // Header 0
+            0,  // GID
+            1,  // SID != server
+            2,  // PTY == REQ
+            8, 9, 10, 11, 12, 13, 14, 15,  // Reqnonce
+            // Assuming the LTK being [1, 0, 0, ..., 0]
+            0xC7, 0x70, 0xFE, 0x35, 0x67, 0x85, 0x78, 0xD8,
+            0x2E, 0x78, 0x57, 0x90, 0xCD, 0x76, 0xC1, 0x1F,  // Tag (valid)
+    };
+
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPdu, 64, 0xABC);
+    atto_eq(err, HZL_ERR_CANNOT_GET_CURRENT_TIME);
+
+    err = hzl_ServerProcessReceivedAt(&msgToTx, &unpackedMsg, &ctx, rxPdu, 64, 0xABC,
+                                      rxTimestamp);
+    atto_eq(err, HZL_OK);
+    atto_eq(unpackedMsg.canId, 0xABC);
+    atto_eq(msgToTx.data[2], 1);  // RES
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant, rxTimestamp);
+}
+
 void hzlServerTest_ServerProcessReceived(void)
 {
     hzlServerTest_ServerProcessReceivedMsgToTxMustNotBeNull();
@@ -240,8 +300,12 @@ void hzlServerTest_ServerProcessReceived(void)
     hzlServerTest_ServerProcessReceivedCtxMustNotBeNull();
     hzlServerTest_ServerProcessReceivedRxDataMustNotBeNullWhenPositiveDataLen();
     hzlServerTest_ServerProcessReceivedMsgMustHaveEnoughDataLenForCbsHeader0();
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlServerTest_ServerProcessReceivedMsgMustHaveEnoughDataLenForCbsHeader4();
+#endif
     hzlServerTest_ServerProcessReceivedMsgMustHaveKnownPtyField();
     hzlServerTest_ServerProcessReceivedMsgMustNotHaveServerSid();
+    hzlServerTest_ServerProcessReceivedAtNullChecks();
+    hzlServerTest_ServerProcessReceivedAtUsesGivenTimestamp();
     HZL_TEST_PARTIAL_REPORT();
 }
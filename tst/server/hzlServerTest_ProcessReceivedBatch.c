@@ -0,0 +1,164 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Tests of the hzl_ServerProcessReceivedBatch() function.
+ *
+ * @warning
+ * REDUCING COVERAGE ON PURPOSE. The handling of each message is the same as in
+ * hzl_ServerProcessReceived(), already tested per message type: here only the batch-specific
+ * behaviour is checked.
+ */
+
+#include "hzlTest.h"
+
+#define HZL_TEST_BATCH_LEN 70U  // More than one chunk
+
+static void
+hzlServerTest_ServerProcessReceivedBatchInvalidInputs(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t reactions[1];
+    hzl_RxSduMsg_t sdus[1];
+    hzl_Err_t results[1];
+    const uint8_t rxPdu[7] = {0, 42, 5, 11, 22, 33, 44};  // UAD
+    const hzl_RxPdu_t pdus[1] = {{.data = rxPdu, .dataLen = 7, .canId = 0xABC}};
+
+    err = hzl_ServerProcessReceivedBatch(NULL, sdus, results, &ctx, pdus, 1);
+    atto_eq(err, HZL_ERR_NULL_PDU);
+    err = hzl_ServerProcessReceivedBatch(reactions, NULL, results, &ctx, pdus, 1);
+    atto_eq(err, HZL_ERR_NULL_SDU);
+    err = hzl_ServerProcessReceivedBatch(reactions, sdus, NULL, &ctx, pdus, 1);
+    atto_eq(err, HZL_ERR_NULL_PDU);
+    err = hzl_ServerProcessReceivedBatch(reactions, sdus, results, &ctx, NULL, 1);
+    atto_eq(err, HZL_ERR_NULL_PDU);
+    err = hzl_ServerProcessReceivedBatch(reactions, sdus, results, NULL, pdus, 1);
+    atto_eq(err, HZL_ERR_NULL_CTX);
+    // Empty batch
+    err = hzl_ServerProcessReceivedBatch(reactions, sdus, results, &ctx, NULL, 0);
+    atto_eq(err, HZL_OK);
+}
+
+static void
+hzlServerTest_ServerProcessReceivedBatchSameAsOneByOne(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    // Mix of messages of different types and Groups, successful and not
+    uint8_t rxPdus[HZL_TEST_BATCH_LEN][HZL_MAX_CAN_FD_DATA_LEN] = {0};
+    hzl_RxPdu_t pdus[HZL_TEST_BATCH_LEN];
+    for (uint8_t i = 0; i < HZL_TEST_BATCH_LEN; i++)
+    {
+        pdus[i].data = rxPdus[i];
+        pdus[i].canId = 0x100U + i;
+        pdus[i].rxTimestamp = i;
+        switch (i % 5U)
+        {
+            case 0:  // UAD in Group 2, alternating with other Groups
+                memcpy(rxPdus[i], (uint8_t[]) {2, 1, 5, i, 22}, 5);
+                pdus[i].dataLen = 5;
+                break;
+            case 1:  // UAD in Group 0
+                memcpy(rxPdus[i], (uint8_t[]) {0, 3, 5, i}, 4);
+                pdus[i].dataLen = 4;
+                break;
+            case 2:  // SADFD in unknown Group
+                memcpy(rxPdus[i], (uint8_t[]) {13, 1, 4, 0x33, 0x22, 0x11, 0}, 7);
+                pdus[i].dataLen = 64;
+                break;
+            case 3:  // Too short
+                memcpy(rxPdus[i], (uint8_t[]) {1, 1}, 2);
+                pdus[i].dataLen = 2;
+                break;
+            default:  // Server-only message
+                memcpy(rxPdus[i], (uint8_t[]) {1, 2, 0}, 3);
+                pdus[i].dataLen = 19;
+                break;
+        }
+    }
+    hzl_CbsPduMsg_t reactions[HZL_TEST_BATCH_LEN];
+    hzl_RxSduMsg_t sdus[HZL_TEST_BATCH_LEN];
+    hzl_Err_t results[HZL_TEST_BATCH_LEN];
+    memset(reactions, 0xFF, sizeof(reactions));  // Garbage, must be cleared
+    memset(sdus, 0xFF, sizeof(sdus));
+
+    err = hzl_ServerProcessReceivedBatch(reactions, sdus, results, &ctx, pdus,
+                                         HZL_TEST_BATCH_LEN);
+
+    atto_eq(err, HZL_OK);
+    for (uint8_t i = 0; i < HZL_TEST_BATCH_LEN; i++)
+    {
+        hzl_CbsPduMsg_t expectedReaction;
+        hzl_RxSduMsg_t expectedSdu;
+        const hzl_Err_t expectedResult = hzl_ServerProcessReceived(
+                &expectedReaction, &expectedSdu, &ctx,
+                pdus[i].data, pdus[i].dataLen, pdus[i].canId);
+        atto_eq(results[i], expectedResult);
+        atto_memeq(&reactions[i], &expectedReaction, sizeof(hzl_CbsPduMsg_t));
+        atto_memeq(&sdus[i], &expectedSdu, sizeof(hzl_RxSduMsg_t));
+    }
+    // Spot-check of the outputs ending up at the index of their input
+    atto_eq(results[5], HZL_OK);
+    atto_eq(sdus[5].canId, 0x105);
+    atto_eq(sdus[5].gid, 2);
+    atto_eq(sdus[5].data[0], 5);
+    atto_eq(results[66], HZL_OK);
+    atto_eq(sdus[66].gid, 0);
+    atto_eq(sdus[66].data[0], 66);
+    atto_eq(results[67], HZL_ERR_UNKNOWN_GROUP);
+    atto_eq(results[68], HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_HEADER);
+    atto_eq(results[69], HZL_ERR_SECWARN_SERVER_ONLY_MESSAGE);
+}
+
+void hzlServerTest_ServerProcessReceivedBatch(void)
+{
+    hzlServerTest_ServerProcessReceivedBatchInvalidInputs();
+    hzlServerTest_ServerProcessReceivedBatchSameAsOneByOne();
+    HZL_TEST_PARTIAL_REPORT();
+}
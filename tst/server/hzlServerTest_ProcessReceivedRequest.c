@@ -247,7 +247,8 @@ hzlServerTest_ServerProcessReceivedRequestMsgWithValidTagSuccessfully(void)
     hzl_Timestamp_t timestampOfReqRx = 0;
     hzlTest_IoMockupCurrentTimeSucceeding(&timestampOfReqRx);
     // Inner state indicates no REQ was received so far
-    atto_eq(groupStates[0].currentRxLastMessageInstant, groupStates[0].sessionStartInstant);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant,
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant);
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     size_t rxPduLen = 64;
@@ -275,8 +276,9 @@ hzlServerTest_ServerProcessReceivedRequestMsgWithValidTagSuccessfully(void)
     atto_zeros(&unpackedMsg.data, 64);
 
     // New timestamps are saved
-    atto_gt(groupStates[0].currentRxLastMessageInstant, timestampOfReqRx);
-    atto_neq(groupStates[0].currentRxLastMessageInstant, groupStates[0].sessionStartInstant);
+    atto_gt(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant, timestampOfReqRx);
+    atto_neq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant,
+             HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant);
 }
 
 static void
@@ -296,7 +298,8 @@ hzlServerTest_ServerProcessReceivedRequestMsgWithValidTagGeneratesResponse(void)
     hzl_Timestamp_t timestampOfReqRx = 0;
     hzlTest_IoMockupCurrentTimeSucceeding(&timestampOfReqRx);
     // Inner state indicates no REQ was received so far
-    atto_eq(groupStates[0].currentRxLastMessageInstant, groupStates[0].sessionStartInstant);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant,
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant);
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     size_t rxPduLen = 64;
@@ -343,6 +346,121 @@ hzlServerTest_ServerProcessReceivedRequestMsgWithValidTagGeneratesResponse(void)
     atto_memeq(&msgToTx.data[7 + 8 + 16], expectedTag, 16);
 }
 
+static void
+hzlServerTest_ServerProcessReceivedRequestMsgWithPrecomputedMidstate(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerClientState_t clientStates[HZL_DEFAULT_TEST_AMOUNT_OF_CLIENTS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .clientStates = clientStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    // Midstates of all Clients are precomputed during the initialisation
+    atto_true(clientStates[0].reqHashMidstate.isValid);
+    atto_true(clientStates[1].reqHashMidstate.isValid);
+    atto_neq(memcmp(&clientStates[0].reqHashMidstate, &clientStates[1].reqHashMidstate,
+                    sizeof(hzl_HashMidstate_t)), 0);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+    size_t rxPduLen = 64;
+    uint8_t rxPdu[64] = {
+            // Header 0
+            0,  // GID
+            1,  // SID != server
+            2,  // PTY == REQ
+            8, 9, 10, 11, 12, 13, 14, 15,  // Reqnonce
+            // Assuming the LTK being [1, 0, 0, ..., 0]
+            0xC7, 0x70, 0xFE, 0x35, 0x67, 0x85, 0x78, 0xD8,
+            0x2E, 0x78, 0x57, 0x90, 0xCD, 0x76, 0xC1, 0x1F,  // Tag (valid)
+    };
+
+    // Same tag as when computed from scratch
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPdu, rxPduLen, 0xABC);
+    atto_eq(err, HZL_OK);
+    atto_eq(msgToTx.dataLen, 3 + 44);
+
+    // Midstate is not consumed by the validation
+    atto_true(clientStates[0].reqHashMidstate.isValid);
+    rxPdu[3]++;  // Different reqnonce, so the tag is wrong
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPdu, rxPduLen, 0xABC);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+
+    err = hzl_ServerDeInit(&ctx);
+    atto_eq(err, HZL_OK);
+    atto_zeros(clientStates, sizeof(clientStates));
+}
+
+static void
+hzlServerTest_ServerProcessReceivedRequestMsgWithPrecomputedLtkKey(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerClientState_t clientStates[HZL_DEFAULT_TEST_AMOUNT_OF_CLIENTS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .clientStates = clientStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzl_ServerGroupState_t groupStatesWithoutCache[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctxWithoutCache = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStatesWithoutCache,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    err = hzl_ServerInit(&ctxWithoutCache);
+    atto_eq(err, HZL_OK);
+    // LTKs of all Clients are expanded during the initialisation
+    atto_true(clientStates[0].ltkAeadKey.isExpanded);
+    atto_true(clientStates[1].ltkAeadKey.isExpanded);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_CbsPduMsg_t msgToTxWithoutCache = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+    size_t rxPduLen = 64;
+    uint8_t rxPdu[64] = {
+            // Header 0
+            0,  // GID
+            1,  // SID != server
+            2,  // PTY == REQ
+            8, 9, 10, 11, 12, 13, 14, 15,  // Reqnonce
+            // Assuming the LTK being [1, 0, 0, ..., 0]
+            0xC7, 0x70, 0xFE, 0x35, 0x67, 0x85, 0x78, 0xD8,
+            0x2E, 0x78, 0x57, 0x90, 0xCD, 0x76, 0xC1, 0x1F,  // Tag (valid)
+    };
+
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPdu, rxPduLen, 0xABC);
+    atto_eq(err, HZL_OK);
+    err = hzl_ServerProcessReceived(&msgToTxWithoutCache, &unpackedMsg, &ctxWithoutCache,
+                                    rxPdu, rxPduLen, 0xABC);
+    atto_eq(err, HZL_OK);
+
+    // Same Response as when expanding the LTK from scratch
+    atto_eq(msgToTx.dataLen, 3 + 44);
+    atto_eq(msgToTxWithoutCache.dataLen, msgToTx.dataLen);
+    atto_memeq(msgToTx.data, msgToTxWithoutCache.data, msgToTx.dataLen);
+    // Expanded LTK is not consumed by the Response
+    atto_true(clientStates[0].ltkAeadKey.isExpanded);
+
+    err = hzl_ServerDeInit(&ctx);
+    atto_eq(err, HZL_OK);
+    atto_zeros(clientStates, sizeof(clientStates));
+    err = hzl_ServerDeInit(&ctxWithoutCache);
+    atto_eq(err, HZL_OK);
+}
+
 void hzlServerTest_ServerProcessReceivedRequest(void)
 {
     hzlServerTest_ServerProcessReceivedRequestMsgMustHaveKnownGid();
@@ -352,5 +470,7 @@ void hzlServerTest_ServerProcessReceivedRequest(void)
     hzlServerTest_ServerProcessReceivedRequestMsgSidMustBelongToGidGroup();
     hzlServerTest_ServerProcessReceivedRequestMsgWithValidTagSuccessfully();
     hzlServerTest_ServerProcessReceivedRequestMsgWithValidTagGeneratesResponse();
+    hzlServerTest_ServerProcessReceivedRequestMsgWithPrecomputedMidstate();
+    hzlServerTest_ServerProcessReceivedRequestMsgWithPrecomputedLtkKey();
     HZL_TEST_PARTIAL_REPORT();
 }
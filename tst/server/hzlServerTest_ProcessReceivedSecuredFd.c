@@ -29,7 +29,8 @@
 /**
  * @file
  * @internal
- * Tests of the hzl_ServerProcessReceived() function for the SADFD messages.
+ * Tests of the hzl_ServerProcessReceived() and hzl_ServerProcessReceivedInPlace() functions
+ * for the SADFD messages.
  *
  * @warning
  * REDUCING COVERAGE ON PURPOSE. NOT implementing all the testcases for all possible incorrect
@@ -55,7 +56,7 @@ hzlServerTest_ServerProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader0(vo
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy established-session state
-    groupStates[0].currentCtrNonce = 0x112233;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 0x112233;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -83,6 +84,7 @@ hzlServerTest_ServerProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader0(vo
 }
 
 
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
 static void
 hzlServerTest_ServerProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader6(void)
 {
@@ -102,7 +104,7 @@ hzlServerTest_ServerProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader6(vo
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy established-session state
-    groupStates[0].currentCtrNonce = 0x112233;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 0x112233;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -126,6 +128,7 @@ hzlServerTest_ServerProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader6(vo
     atto_neq(err, HZL_ERR_TOO_LONG_CIPHERTEXT);
     atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);  // Tag is wrong, but other checks are passing
 }
+#endif
 
 static void
 hzlServerTest_ServerProcessReceivedSadfdMsgMustHaveKnownGid(void)
@@ -211,7 +214,7 @@ hzlServerTest_ServerProcessReceivedSadfdMsgMustBeLongEnoughForMetadata(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy established-session state
-    groupStates[0].currentCtrNonce = 1;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -254,7 +257,7 @@ hzlServerTest_ServerProcessReceivedSadfdMsgMustHaveNonExpiredCtrnonce(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy established-session state
-    groupStates[0].currentCtrNonce = 1;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 1;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -295,7 +298,8 @@ hzlServerTest_ServerProcessReceivedSadfdMsgMustHaveFreshCtrnonce(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy established-session state
-    groupStates[0].currentCtrNonce = 0xFFFF;  // Newer ctrnonce than received one
+    // Newer ctrnonce than received one
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 0xFFFF;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -333,7 +337,7 @@ hzlServerTest_ServerProcessReceivedSadfdMsgWithEmptyCtextSuccessfully(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy established-session state
-    groupStates[0].currentCtrNonce = 20;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 20;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -363,7 +367,7 @@ hzlServerTest_ServerProcessReceivedSadfdMsgWithEmptyCtextSuccessfully(void)
     atto_zeros(&msgToTx, sizeof(hzl_CbsPduMsg_t)); // No msg to transmit
 
     // New ctrnonce is stored in state, incremented
-    atto_eq(groupStates[0].currentCtrNonce, 0x010203 + 1);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 0x010203 + 1);
 }
 
 static void
@@ -382,7 +386,7 @@ hzlServerTest_ServerProcessReceivedSadfdMsgWithSomeCtextSuccessfully(void)
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy established-session state
-    groupStates[0].currentCtrNonce = 20;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 20;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -428,7 +432,7 @@ hzlServerTest_ServerProcessReceivedSadfdMsgMustHaveFreshCtrnonceWithinTolerance(
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy established-session state
-    groupStates[0].currentCtrNonce = 8;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 8;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -491,20 +495,23 @@ hzlServerTest_ServerProcessReceivedSadfdMsgMustHaveFreshCtrnonceWithinTolerance(
     atto_eq(err, HZL_OK);
     atto_zeros(&msgToTx, sizeof(hzl_CbsPduMsg_t)); // No msg to transmit
 
-    atto_eq(groupStates[0].currentCtrNonce, 9);  // state ctrnonce was increased
+    // state ctrnonce was increased
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 9);
     // Slightly older ctrnonce => still accepted
     err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPduWithCtrNonce8, rxPduLen,
                                     0xABC);
     atto_eq(err, HZL_OK);
     atto_zeros(&msgToTx, sizeof(hzl_CbsPduMsg_t)); // No msg to transmit
 
-    atto_eq(groupStates[0].currentCtrNonce, 10);  // state ctrnonce was increased
+    // state ctrnonce was increased
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 10);
     // Too old ctrnonce compared to the max delay => rejected
     err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPduWithCtrNonce5, rxPduLen,
                                     0xABC);
     atto_eq(err, HZL_ERR_SECWARN_OLD_MESSAGE);
 
-    atto_eq(groupStates[0].currentCtrNonce, 10);  // state ctrnonce was NOT increased
+    // state ctrnonce was NOT increased
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 10);
     // Slightly older ctrnonce => rejected, as too much time passed
     err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPduWithCtrNonce7, rxPduLen,
                                     0xABC);
@@ -517,13 +524,15 @@ hzlServerTest_ServerProcessReceivedSadfdMsgMustHaveFreshCtrnonceWithinTolerance(
         hzlTest_IoMockupCurrentTimeSucceeding(NULL);
     }
 
-    atto_eq(groupStates[0].currentCtrNonce, 11);  // state ctrnonce was increased
+    // state ctrnonce was increased
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 11);
     // Slightly older ctrnonce => rejected, as too much time passed
     err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPduWithCtrNonce10,
                                     rxPduLen, 0xABC);
     atto_eq(err, HZL_ERR_SECWARN_OLD_MESSAGE);
 
-    atto_eq(groupStates[0].currentCtrNonce, 11);  // state ctrnonce was NOT increased
+    // state ctrnonce was NOT increased
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 11);
     //Equal to the current ctrnonce => accepted
     err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPduWithCtrNonce11,
                                     rxPduLen, 0xABC);
@@ -546,11 +555,12 @@ hzlServerTest_ServerProcessReceivedSadfdCurrentSessionAcceptedDuringRenewal(void
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy old session state
-    groupStates[0].previousCtrNonce = 0xF11111;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->previousCtrNonce = 0xF11111;
     groupStates[0].previousStk[0] = 222;
     memset(&groupStates[0].previousStk[1], 0, 15);  // The rest is zeros
+    HZL_TEST_SERVER_MARK_RENEWAL_PHASE_ACTIVE(&ctx, 0);
     // Dummy new session state
-    groupStates[0].currentCtrNonce = 0x010200;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 0x010200;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -598,11 +608,12 @@ hzlServerTest_ServerProcessReceivedSadfdPreviousSessionAcceptedDuringRenewal(voi
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy old session state
-    groupStates[0].previousCtrNonce = 0x010200;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->previousCtrNonce = 0x010200;
     groupStates[0].previousStk[0] = 99;
     memset(&groupStates[0].previousStk[1], 0, 15);  // The rest is zeros
+    HZL_TEST_SERVER_MARK_RENEWAL_PHASE_ACTIVE(&ctx, 0);
     // Dummy new session state
-    groupStates[0].currentCtrNonce = 3;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 3;
     groupStates[0].currentStk[0] = 100;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -650,11 +661,12 @@ hzlServerTest_ServerProcessReceivedSadfdPreviousSessionRejectedAfterTooManyMsgs(
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy old session state
-    groupStates[0].previousCtrNonce = 0x010202;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->previousCtrNonce = 0x010202;
     groupStates[0].previousStk[0] = 99;
     memset(&groupStates[0].previousStk[1], 0, 15);  // The rest is zeros
+    HZL_TEST_SERVER_MARK_RENEWAL_PHASE_ACTIVE(&ctx, 0);
     // Dummy new session state
-    groupStates[0].currentCtrNonce = 3;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 3;
     groupStates[0].currentStk[0] = 100;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -671,18 +683,24 @@ hzlServerTest_ServerProcessReceivedSadfdPreviousSessionRejectedAfterTooManyMsgs(
     };
     size_t rxPduLen = 64;
 
-    groupStates[0].currentCtrNonce = ctx.groupConfigs[0].maxCtrnonceDelayMsgs * 2 - 1;  // still OK
+    // still OK
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce =
+            ctx.groupConfigs[0].maxCtrnonceDelayMsgs * 2 - 1;
     err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPdu, rxPduLen, 0xABC);
     atto_eq(err, HZL_OK);
 
-    groupStates[0].currentCtrNonce = ctx.groupConfigs[0].maxCtrnonceDelayMsgs * 2;  // Too much
-    atto_ge(groupStates[0].currentCtrNonce, ctx.groupConfigs[0].maxCtrnonceDelayMsgs * 2);
+    // Too much
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce =
+            ctx.groupConfigs[0].maxCtrnonceDelayMsgs * 2;
+    atto_ge(HZL_TEST_SERVER_GROUP_HOT(&ctx,
+            0)->currentCtrNonce, ctx.groupConfigs[0].maxCtrnonceDelayMsgs * 2);
     err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPdu, rxPduLen, 0xABC);
     atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
     // After the ctrnonce of the current session reached the threshold, the data of the old
     // session is deleted.
-    atto_eq(groupStates[0].previousCtrNonce, 0);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->previousCtrNonce, 0);
     atto_zeros(groupStates[0].previousStk, HZL_STK_LEN);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionState, HZL_SESSION_STATE_ACTIVE);
 }
 
 static void
@@ -701,11 +719,12 @@ hzlServerTest_ServerProcessReceivedSadfdPreviousSessionRejectedAfterTooMuchTime(
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy old session state
-    groupStates[0].previousCtrNonce = 0x010200;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->previousCtrNonce = 0x010200;
     groupStates[0].previousStk[0] = 99;
     memset(&groupStates[0].previousStk[1], 0, 15);  // The rest is zeros
+    HZL_TEST_SERVER_MARK_RENEWAL_PHASE_ACTIVE(&ctx, 0);
     // Dummy new session state
-    groupStates[0].currentCtrNonce = 3;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 3;
     groupStates[0].currentStk[0] = 100;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -736,8 +755,9 @@ hzlServerTest_ServerProcessReceivedSadfdPreviousSessionRejectedAfterTooMuchTime(
     atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
     // After the time since the last handshake reached the threshold, the data of the old
     // session is deleted.
-    atto_eq(groupStates[0].previousCtrNonce, 0);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->previousCtrNonce, 0);
     atto_zeros(groupStates[0].previousStk, HZL_STK_LEN);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionState, HZL_SESSION_STATE_ACTIVE);
 }
 
 static void
@@ -756,7 +776,7 @@ hzlServerTest_ServerProcessReceivedSadfdTriggersRenewalWhenCtrNonceHitsLimit(voi
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy session state, about to expire
-    groupStates[0].currentCtrNonce = ctx.groupConfigs->ctrNonceUpperLimit - 1;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = ctx.groupConfigs->ctrNonceUpperLimit - 1;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     hzl_CbsPduMsg_t msgToTx = {0};
@@ -779,8 +799,8 @@ hzlServerTest_ServerProcessReceivedSadfdTriggersRenewalWhenCtrNonceHitsLimit(voi
     atto_neq(groupStates[0].currentStk[0], 99);
     atto_eq(groupStates[0].previousStk[0], 99);
     // Greater by 1 because it was incremented after building the REN
-    atto_eq(groupStates[0].previousCtrNonce, 0xFF0001);
-    atto_eq(groupStates[0].currentCtrNonce, 0);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->previousCtrNonce, 0xFF0001);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 0);
     // REN message available
     atto_eq(msgToTx.dataLen, 3 + 19);
     // Packed header 0
@@ -815,11 +835,11 @@ hzlServerTest_ServerProcessReceivedSadfdTriggersRenewalWhenTooMuchTimePassed(voi
     err = hzl_ServerInit(&ctx);
     atto_eq(err, HZL_OK);
     // Dummy session state
-    groupStates[0].currentCtrNonce = 0x010203;
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 0x010203;
     groupStates[0].currentStk[0] = 99;
     memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
     // Setting the Session start to NOW
-    hzlTest_IoMockupCurrentTimeSucceeding(&groupStates[0].sessionStartInstant);
+    hzlTest_IoMockupCurrentTimeSucceeding(&HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant);
     hzl_CbsPduMsg_t msgToTx = {0};
     hzl_RxSduMsg_t unpackedMsg = {0};
     const uint8_t rxPdu1[64] = {
@@ -839,8 +859,8 @@ hzlServerTest_ServerProcessReceivedSadfdTriggersRenewalWhenTooMuchTimePassed(voi
     // Session was NOT renewed
     atto_eq(groupStates[0].currentStk[0], 99);
     atto_neq(groupStates[0].previousStk[0], 99);
-    atto_eq(groupStates[0].previousCtrNonce, 0);
-    atto_eq(groupStates[0].currentCtrNonce, 0x010204);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->previousCtrNonce, 0);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 0x010204);
 
     // Making the session expire in time: let virtually too much time pass
     for (size_t i = 0; i < 700; i++)
@@ -865,8 +885,8 @@ hzlServerTest_ServerProcessReceivedSadfdTriggersRenewalWhenTooMuchTimePassed(voi
     atto_neq(groupStates[0].currentStk[0], 99);
     atto_eq(groupStates[0].previousStk[0], 99);
     // Greater by 1 because it was incremented after building the REN
-    atto_eq(groupStates[0].previousCtrNonce, 0x010206);
-    atto_eq(groupStates[0].currentCtrNonce, 0);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->previousCtrNonce, 0x010206);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 0);
     // REN message available
     atto_eq(msgToTx.dataLen, 3 + 19);
     // Packed header 0
@@ -885,10 +905,92 @@ hzlServerTest_ServerProcessReceivedSadfdTriggersRenewalWhenTooMuchTimePassed(voi
     atto_memeq(&msgToTx.data[6], expectedTag, 16);
 }
 
+static void
+hzlServerTest_ServerProcessReceivedInPlaceSadfdDecryptsOverCiphertext(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    // Dummy established-session state
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 20;
+    groupStates[0].currentStk[0] = 99;
+    memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
+    hzl_CbsPduMsg_t msgToTx;
+    memset(&msgToTx, 0xAA, sizeof(msgToTx));  // Dirty, reused buffer
+    hzl_RxSduView_t unpackedView;
+    memset(&unpackedView, 0xAA, sizeof(unpackedView));  // Dirty, reused buffer
+    uint8_t rxPdu[64] = {
+            // Header 0
+            0,  // GID
+            1,  // SID
+            4,  // PTY == SADFD
+            0x03, 0x02, 0x01,  // Ctrnonce
+            5,  // ptlen
+            0x1D, 0x5A, 0x14, 0x41, 0x8F,  // ctext: "ABCDE" in ASCII encoding
+            0xFA, 0x4F, 0x11, 0x4C, 0xF3, 0x33, 0x99, 0xD7,  // Tag (correct)
+    };
+    size_t rxPduLen = 64;
+    hzl_Timestamp_t now = 0;
+    err = ctx.io.currentTime(&now);
+    atto_eq(err, HZL_OK);
+
+    err = hzl_ServerProcessReceivedInPlace(&msgToTx, &unpackedView, &ctx,
+                                           rxPdu, rxPduLen, 0xABC, now);
+
+    atto_eq(err, HZL_OK);
+    atto_eq(unpackedView.canId, 0xABC);
+    atto_eq(unpackedView.dataLen, 5);
+    atto_eq(unpackedView.gid, 0);
+    atto_eq(unpackedView.sid, 1);
+    atto_true(unpackedView.wasSecured);
+    atto_true(unpackedView.isForUser);
+    // The plaintext is exactly where the ciphertext was
+    atto_eq(unpackedView.data, &rxPdu[7]);
+    atto_memeq(&rxPdu[7], "ABCDE", 5);
+    atto_eq(msgToTx.dataLen, 0); // No msg to transmit
+}
+
+static void
+hzlServerTest_ServerProcessReceivedInPlaceSadfdMustBeLongEnoughForMetadata(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduView_t unpackedView = {0};
+    uint8_t rxPdu[64] = {0, 1, 4, 0x03, 0x02, 0x01, 0};  // Header 0, ctrnonce, ptlen, no tag
+    size_t rxPduLen = 7;
+
+    err = hzl_ServerProcessReceivedInPlace(&msgToTx, &unpackedView, &ctx,
+                                           rxPdu, rxPduLen, 0xABC, 1000);
+
+    atto_eq(err, HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_SADFD);
+    atto_eq(unpackedView.data, NULL);
+    atto_eq(msgToTx.dataLen, 0);
+}
+
 void hzlServerTest_ServerProcessReceivedSecuredFd(void)
 {
     hzlServerTest_ServerProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader0();
+#if HZL_FIXED_HEADER_TYPE == HZL_FIXED_HEADER_TYPE_ANY
     hzlServerTest_ServerProcessReceivedSadfdMsgMustNotHaveTooLongPlaintextHeader6();
+#endif
     hzlServerTest_ServerProcessReceivedSadfdMsgMustHaveKnownGid();
     hzlServerTest_ServerProcessReceivedSadfdMsgMustHaveKnownSid();
     hzlServerTest_ServerProcessReceivedSadfdMsgMustBeLongEnoughForMetadata();
@@ -903,5 +1005,7 @@ void hzlServerTest_ServerProcessReceivedSecuredFd(void)
     hzlServerTest_ServerProcessReceivedSadfdPreviousSessionRejectedAfterTooMuchTime();
     hzlServerTest_ServerProcessReceivedSadfdTriggersRenewalWhenCtrNonceHitsLimit();
     hzlServerTest_ServerProcessReceivedSadfdTriggersRenewalWhenTooMuchTimePassed();
+    hzlServerTest_ServerProcessReceivedInPlaceSadfdDecryptsOverCiphertext();
+    hzlServerTest_ServerProcessReceivedInPlaceSadfdMustBeLongEnoughForMetadata();
     HZL_TEST_PARTIAL_REPORT();
 }
@@ -29,7 +29,8 @@
 /**
  * @file
  * @internal
- * Tests of the hzl_ServerProcessReceived() function for the UAD messages.
+ * Tests of the hzl_ServerProcessReceived() and hzl_ServerProcessReceivedInPlace() functions
+ * for the UAD messages.
  *
  * @warning
  * REDUCING COVERAGE ON PURPOSE. NOT implementing all the testcases for all possible incorrect
@@ -75,8 +76,102 @@ hzlServerTest_ServerProcessReceivedUadMsgSuccessfully(void)
     atto_zeros(&msgToTx, sizeof(hzl_CbsPduMsg_t)); // No msg to transmit
 }
 
+static void
+hzlServerTest_ServerProcessReceivedInPlaceUadMsgPointsIntoPdu(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduView_t unpackedView = {0};
+    uint8_t rxPdu[64] = {0, 42, 5, 11, 22, 33, 44};  // Unsecured Application Data msg
+    size_t rxPduLen = 7;
+
+    err = hzl_ServerProcessReceivedInPlace(&msgToTx, &unpackedView, &ctx,
+                                           rxPdu, rxPduLen, 0xABC, 1000);
+
+    atto_eq(err, HZL_OK);
+    atto_eq(unpackedView.canId, 0xABC);
+    atto_eq(unpackedView.dataLen, 4);
+    atto_eq(unpackedView.gid, 0);
+    atto_eq(unpackedView.sid, 42);
+    atto_false(unpackedView.wasSecured);
+    atto_true(unpackedView.isForUser);
+    atto_eq(unpackedView.data, &rxPdu[3]);
+    atto_eq(msgToTx.dataLen, 0); // No msg to transmit
+}
+
+static void
+hzlServerTest_ServerProcessReceivedReusedOutputsKeepNoStalePlaintext(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    // Dummy established-session state
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 20;
+    groupStates[0].currentStk[0] = 99;
+    memset(&groupStates[0].currentStk[1], 0, 15);  // The rest is zeros
+    // Same outputs for all messages, zero-initialised once
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+    const uint8_t sadfdPdu[64] = {
+            // Header 0
+            0,  // GID
+            1,  // SID
+            4,  // PTY == SADFD
+            0x03, 0x02, 0x01,  // Ctrnonce
+            5,  // ptlen
+            0x1D, 0x5A, 0x14, 0x41, 0x8F,  // ctext: "ABCDE" in ASCII encoding
+            0xFA, 0x4F, 0x11, 0x4C, 0xF3, 0x33, 0x99, 0xD7,  // Tag (correct)
+    };
+    const uint8_t uadPdu[64] = {0, 42, 5, 11, 22};  // Unsecured Application Data msg
+
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, sadfdPdu, 64, 0xABC);
+    atto_eq(err, HZL_OK);
+    atto_memeq(unpackedMsg.data, "ABCDE", 5);
+
+    // Shorter message: nothing of the previous plaintext is left after it
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, uadPdu, 5, 0xDEF);
+    atto_eq(err, HZL_OK);
+    atto_eq(unpackedMsg.canId, 0xDEF);
+    atto_eq(unpackedMsg.dataLen, 2);
+    atto_eq(unpackedMsg.sid, 42);
+    atto_false(unpackedMsg.wasSecured);
+    atto_eq(unpackedMsg.data[0], 11);
+    atto_eq(unpackedMsg.data[1], 22);
+    atto_zeros(&unpackedMsg.data[2], sizeof(unpackedMsg.data) - 2);
+
+    // Invalid message: the outputs are left empty
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, uadPdu, 1, 0xABC);
+    atto_neq(err, HZL_OK);
+    atto_eq(unpackedMsg.dataLen, 0);
+    atto_eq(unpackedMsg.canId, 0);
+    atto_eq(unpackedMsg.sid, 0);
+    atto_false(unpackedMsg.isForUser);
+    atto_zeros(unpackedMsg.data, sizeof(unpackedMsg.data));
+    atto_eq(msgToTx.dataLen, 0);
+}
+
 void hzlServerTest_ServerProcessReceivedUnsecured(void)
 {
     hzlServerTest_ServerProcessReceivedUadMsgSuccessfully();
+    hzlServerTest_ServerProcessReceivedInPlaceUadMsgPointsIntoPdu();
+    hzlServerTest_ServerProcessReceivedReusedOutputsKeepNoStalePlaintext();
     HZL_TEST_PARTIAL_REPORT();
 }
@@ -0,0 +1,270 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Tests of the Server cache of rejected SADFD messages.
+ */
+
+#include "hzlTest.h"
+
+#if HZL_SERVER_REJECTED_CACHE_SLOTS > 0
+
+/** SADFD message "ABCDE", valid with the STK [99, 0, 0, ..., 0]. */
+static const uint8_t HZL_TEST_REJECTED_CACHE_SADFD[64] = {
+        // Header 0
+        0,  // GID
+        1,  // SID
+        4,  // PTY == SADFD
+        0x03, 0x02, 0x01,  // Ctrnonce
+        5,  // ptlen
+        0x1D, 0x5A, 0x14, 0x41, 0x8F,  // ctext: "ABCDE" in ASCII encoding
+        0xFA, 0x4F, 0x11, 0x4C, 0xF3, 0x33, 0x99, 0xD7,  // Tag (correct)
+};
+
+/** Server with a dummy established Session in GID 0, with the STK [stk0, 0, 0, ..., 0]. */
+static void
+hzlServerTest_RejectedCacheServerInit(hzl_ServerCtx_t* const ctx,
+                                      const uint8_t stk0)
+{
+    hzl_Err_t err = hzl_ServerInit(ctx);
+    atto_eq(err, HZL_OK);
+    HZL_TEST_SERVER_GROUP_HOT(ctx, 0)->currentCtrNonce = 20;
+    memset(ctx->groupStates[0].currentStk, 0, HZL_STK_LEN);
+    ctx->groupStates[0].currentStk[0] = stk0;
+}
+
+static void
+hzlServerTest_RejectedCacheRejectsRepetitionsWithoutDecryption(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerRejectedCache_t rejectedCache;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .rejectedCache = &rejectedCache,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlServerTest_RejectedCacheServerInit(&ctx, 99);
+    atto_eq(rejectedCache.hits, 0);
+    atto_eq(rejectedCache.misses, 0);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+    uint8_t rxPdu[64];
+    memcpy(rxPdu, HZL_TEST_REJECTED_CACHE_SADFD, sizeof(rxPdu));
+    rxPdu[7] ^= 1U;  // Corrupted ciphertext
+
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPdu, sizeof(rxPdu), 0xABC);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    atto_eq(rejectedCache.hits, 0);
+    atto_eq(rejectedCache.misses, 1);
+
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPdu, sizeof(rxPdu), 0xABC);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    atto_eq(rejectedCache.hits, 1);
+    atto_eq(rejectedCache.misses, 1);
+    atto_false(unpackedMsg.isForUser);
+    atto_zeros(unpackedMsg.data, sizeof(unpackedMsg.data));
+
+    // Bytes after the message, unused by it, are not part of the fingerprint
+    rxPdu[63] = 0xAA;
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPdu, sizeof(rxPdu), 0xABC);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    atto_eq(rejectedCache.hits, 2);
+
+    // The original message is still validated and accepted
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx,
+                                    HZL_TEST_REJECTED_CACHE_SADFD, 64, 0xABC);
+    atto_eq(err, HZL_OK);
+    atto_memeq(unpackedMsg.data, "ABCDE", 5);
+    atto_eq(rejectedCache.hits, 2);
+    atto_eq(rejectedCache.misses, 2);
+
+    err = hzl_ServerDeInit(&ctx);
+    atto_eq(err, HZL_OK);
+    atto_zeros(&rejectedCache, sizeof(rejectedCache));
+}
+
+static void
+hzlServerTest_RejectedCacheForgetsRejectionsWithOtherKeys(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerRejectedCache_t rejectedCache;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .rejectedCache = &rejectedCache,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlServerTest_RejectedCacheServerInit(&ctx, 98);  // Wrong STK
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx,
+                                    HZL_TEST_REJECTED_CACHE_SADFD, 64, 0xABC);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx,
+                                    HZL_TEST_REJECTED_CACHE_SADFD, 64, 0xABC);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    atto_eq(rejectedCache.hits, 1);
+
+    // New Session with another STK: the same message is validated again
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant += 1U;
+    groupStates[0].currentStk[0] = 99;
+    memset(&groupStates[0].currentAeadKey, 0, sizeof(hzl_AeadKey_t));  // Expanded on first use
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx,
+                                    HZL_TEST_REJECTED_CACHE_SADFD, 64, 0xABC);
+    atto_eq(err, HZL_OK);
+    atto_eq(rejectedCache.hits, 1);
+    atto_eq(rejectedCache.misses, 2);
+}
+
+static void
+hzlServerTest_RejectedCacheForgetsRejectionsWithOtherHeaders(void)
+{
+    hzl_Err_t err;
+    hzl_ServerConfig_t serverConfigWithHeaderInCanId = HZL_TEST_CORRECT_SERVER_CONFIG;
+    serverConfigWithHeaderInCanId.headerPlacement = HZL_HEADER_IN_CAN_ID;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerRejectedCache_t rejectedCache;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &serverConfigWithHeaderInCanId,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .rejectedCache = &rejectedCache,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlServerTest_RejectedCacheServerInit(&ctx, 99);
+    // Same Session start in GID 1, but with another STK
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentCtrNonce = 20;
+    memset(groupStates[1].currentStk, 0, HZL_STK_LEN);
+    groupStates[1].currentStk[0] = 98;
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->sessionStartInstant,
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+    // The whole 3-bytes header is in the CAN ID: the payloads in the two Groups are identical
+    const uint8_t* const payload = &HZL_TEST_REJECTED_CACHE_SADFD[3];
+    const size_t payloadLen = sizeof(HZL_TEST_REJECTED_CACHE_SADFD) - 3U;
+
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, payload, payloadLen, 0x010104);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, payload, payloadLen, 0x010104);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    atto_eq(rejectedCache.hits, 1);
+
+    // Same payload in GID 0, where it's valid
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, payload, payloadLen, 0x000104);
+    atto_eq(err, HZL_OK);
+    atto_memeq(unpackedMsg.data, "ABCDE", 5);
+    atto_eq(rejectedCache.hits, 1);
+    atto_eq(rejectedCache.misses, 2);
+}
+
+static void
+hzlServerTest_RejectedCacheAlsoUsedInPlace(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerRejectedCache_t rejectedCache;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .rejectedCache = &rejectedCache,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlServerTest_RejectedCacheServerInit(&ctx, 99);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduView_t unpackedView = {0};
+    uint8_t rxPdu[64];
+
+    // The rejected ciphertext is cleared in place, so the message is received anew each time
+    memcpy(rxPdu, HZL_TEST_REJECTED_CACHE_SADFD, sizeof(rxPdu));
+    rxPdu[19] ^= 1U;  // Corrupted tag
+    err = hzl_ServerProcessReceivedInPlace(&msgToTx, &unpackedView, &ctx,
+                                           rxPdu, sizeof(rxPdu), 0xABC, 1000);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    memcpy(rxPdu, HZL_TEST_REJECTED_CACHE_SADFD, sizeof(rxPdu));
+    rxPdu[19] ^= 1U;
+    err = hzl_ServerProcessReceivedInPlace(&msgToTx, &unpackedView, &ctx,
+                                           rxPdu, sizeof(rxPdu), 0xABC, 1000);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    atto_eq(rejectedCache.hits, 1);
+    atto_eq(rejectedCache.misses, 1);
+    atto_eq(unpackedView.data, NULL);
+}
+
+static void
+hzlServerTest_RejectedCacheIsOptional(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .rejectedCache = NULL,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlServerTest_RejectedCacheServerInit(&ctx, 99);
+    hzl_CbsPduMsg_t msgToTx = {0};
+    hzl_RxSduMsg_t unpackedMsg = {0};
+    uint8_t rxPdu[64];
+    memcpy(rxPdu, HZL_TEST_REJECTED_CACHE_SADFD, sizeof(rxPdu));
+    rxPdu[7] ^= 1U;  // Corrupted ciphertext
+
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPdu, sizeof(rxPdu), 0xABC);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+    err = hzl_ServerProcessReceived(&msgToTx, &unpackedMsg, &ctx, rxPdu, sizeof(rxPdu), 0xABC);
+    atto_eq(err, HZL_ERR_SECWARN_INVALID_TAG);
+}
+
+#endif
+
+void hzlServerTest_ServerRejectedCache(void)
+{
+#if HZL_SERVER_REJECTED_CACHE_SLOTS > 0
+    hzlServerTest_RejectedCacheRejectsRepetitionsWithoutDecryption();
+    hzlServerTest_RejectedCacheForgetsRejectionsWithOtherKeys();
+    hzlServerTest_RejectedCacheForgetsRejectionsWithOtherHeaders();
+    hzlServerTest_RejectedCacheAlsoUsedInPlace();
+    hzlServerTest_RejectedCacheIsOptional();
+#endif
+    HZL_TEST_PARTIAL_REPORT();
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Tests of the hzl_ServerBuildSecuredTpStart() and hzl_ServerBuildSecuredTpNext() functions
+ * and of the reception of SADTP messages by the Server.
+ *
+ * The framing and reassembly are shared with the Client and are tested in more depth
+ * in the Client test suite, the exchanges between the parties in the interoperability test
+ * suite: these test cases focus on the Server-specific checks.
+ */
+
+#include "hzlTest.h"
+
+#include <string.h>
+
+#if HZL_SADTP
+
+static hzl_SadtpRxPool_t hzlServerTest_sadtpServerPool;
+
+/** Initialises the context with a dummy established Session in Group 0. */
+static void
+hzlServerTest_SadtpInit(hzl_ServerCtx_t* const ctx)
+{
+    const hzl_Err_t err = hzl_ServerInit(ctx);
+    atto_eq(err, HZL_OK);
+    HZL_TEST_SERVER_GROUP_HOT(ctx, 0)->currentCtrNonce = 1;
+    ctx->groupStates[0].currentStk[0] = 99;
+    // Fake a Request being received
+    HZL_TEST_SERVER_GROUP_HOT(ctx, 0)->currentRxLastMessageInstant =
+            HZL_TEST_SERVER_GROUP_HOT(ctx, 0)->sessionStartInstant + 1U;
+}
+
+static void
+hzlServerTest_ServerBuildSecuredTpChecksInputs(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_SadtpTx_t tx;
+    hzl_CbsPduMsg_t frame;
+    uint8_t userData[16] = {1, 2, 3};
+
+    err = hzl_ServerBuildSecuredTpStart(NULL, &ctx, userData, sizeof(userData), 0, 8);
+    atto_eq(err, HZL_ERR_NULL_SADTP_TX);
+    err = hzl_ServerBuildSecuredTpStart(&tx, NULL, userData, sizeof(userData), 0, 8);
+    atto_eq(err, HZL_ERR_NULL_CTX);
+    atto_true(tx.isDone);
+    err = hzl_ServerBuildSecuredTpStart(&tx, &ctx, NULL, 1, 0, 8);
+    atto_eq(err, HZL_ERR_NULL_SDU);
+    err = hzl_ServerBuildSecuredTpStart(&tx, &ctx, userData, HZL_SADTP_MAX_SDU_LEN + 1U, 0, 8);
+    atto_eq(err, HZL_ERR_TOO_LONG_SDU);
+    err = hzl_ServerBuildSecuredTpStart(&tx, &ctx, userData, sizeof(userData), 0, 4);
+    atto_eq(err, HZL_ERR_TOO_SHORT_OUTPUT_BUFFER);
+    err = hzl_ServerBuildSecuredTpStart(&tx, &ctx, userData, sizeof(userData),
+                                        HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, 8);
+    atto_eq(err, HZL_ERR_UNKNOWN_GROUP);
+    err = hzl_ServerBuildSecuredTpStart(&tx, &ctx, userData, sizeof(userData), 0, 8);
+    atto_eq(err, HZL_ERR_NO_POTENTIAL_RECEIVER);
+    atto_true(tx.isDone);
+    err = hzl_ServerBuildSecuredTpNext(&frame, &tx);
+    atto_eq(err, HZL_ERR_SADTP_TX_COMPLETED);
+
+    hzlServerTest_SadtpInit(&ctx);
+    err = hzl_ServerBuildSecuredTpStart(&tx, &ctx, userData, sizeof(userData), 0, 8);
+    atto_eq(err, HZL_OK);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 2);
+    err = hzl_ServerBuildSecuredTpNext(&frame, &tx);
+    atto_eq(err, HZL_OK);
+    atto_eq(frame.dataLen, 8);
+    atto_eq(frame.data[0], 0);  // GID
+    atto_eq(frame.data[1], 0);  // SID of the Server
+    atto_eq(frame.data[2], 3);  // PTY == SADTP
+    atto_eq(frame.data[3], 0x10);  // First Frame
+    atto_eq(frame.data[4], 1);  // Ctrnonce
+}
+
+static void
+hzlServerTest_ServerProcessReceivedSadtpChecksSender(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlServerTest_SadtpInit(&ctx);
+    hzl_CbsPduMsg_t reactionPdu;
+    hzl_RxSduMsg_t msg;
+    uint8_t rxPdu[8] = {
+            // Header 0
+            0,  // GID
+            1,  // SID
+            3,  // PTY == SADTP
+            0x10,  // First Frame
+            0x01, 0x00, 0x00,  // Ctrnonce
+            0x04,  // Ptlen, low byte
+    };
+
+    err = hzl_ServerProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 10);
+    atto_eq(err, HZL_ERR_NULL_SADTP_POOL);
+    ctx.sadtpRxPool = &hzlServerTest_sadtpServerPool;
+    memset(ctx.sadtpRxPool, 0, sizeof(hzl_SadtpRxPool_t));
+    rxPdu[1] = 30;  // Unknown Client
+    err = hzl_ServerProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 10);
+    atto_eq(err, HZL_ERR_UNKNOWN_SOURCE);
+    rxPdu[1] = 1;
+    rxPdu[0] = 2;  // Group without SID 1
+    err = hzl_ServerProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 10);
+    atto_eq(err, HZL_ERR_SECWARN_NOT_IN_GROUP);
+    rxPdu[0] = 0;
+    err = hzl_ServerProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 4, 0x123, 10);
+    atto_eq(err, HZL_ERR_TOO_SHORT_PDU_TO_CONTAIN_SADTP);
+    atto_zeros(&hzlServerTest_sadtpServerPool.slots, sizeof(hzlServerTest_sadtpServerPool.slots));
+}
+
+static void
+hzlServerTest_ServerProcessReceivedSadtpChecksCtrnonceBeforeDecrypting(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .sadtpRxPool = &hzlServerTest_sadtpServerPool,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    hzlServerTest_SadtpInit(&ctx);
+    HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce = 10;
+    hzl_CbsPduMsg_t reactionPdu;
+    hzl_RxSduMsg_t msg;
+    uint8_t rxPdu[8] = {
+            // Header 0
+            0,  // GID
+            1,  // SID
+            3,  // PTY == SADTP
+            0x10,  // First Frame
+            0x01, 0x00, 0x00,  // Ctrnonce, more than maxCtrnonceDelayMsgs behind
+            0x04,  // Ptlen, low byte
+    };
+
+    // The metadata is incomplete: the ctrnonce is not checked yet
+    err = hzl_ServerProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 8, 0x123, 10);
+    atto_eq(err, HZL_OK);
+    atto_false(msg.isForUser);
+    atto_true(hzlServerTest_sadtpServerPool.slots[0].isBusy);
+    // The whole message is dropped as soon as the ctrnonce is known
+    rxPdu[3] = 0x21;  // Consecutive Frame
+    rxPdu[4] = 0x00;  // Ptlen, high byte
+    err = hzl_ServerProcessReceivedAt(&reactionPdu, &msg, &ctx, rxPdu, 5, 0x123, 10);
+    atto_eq(err, HZL_ERR_SECWARN_OLD_MESSAGE);
+    atto_zeros(&hzlServerTest_sadtpServerPool.slots, sizeof(hzlServerTest_sadtpServerPool.slots));
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentCtrNonce, 10);
+}
+
+#endif  /* HZL_SADTP */
+
+void
+hzlServerTest_ServerSecuredTp(void)
+{
+#if HZL_SADTP
+    hzlServerTest_ServerBuildSecuredTpChecksInputs();
+    hzlServerTest_ServerProcessReceivedSadtpChecksSender();
+    hzlServerTest_ServerProcessReceivedSadtpChecksCtrnonceBeforeDecrypting();
+#endif
+}
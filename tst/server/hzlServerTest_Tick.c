@@ -0,0 +1,391 @@
+/*
+ * Copyright © 2020-2022, Matjaž Guštin <dev@matjaz.it>
+ * <https://matjaz.it>. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. Neither the name of nor the names of its contributors may be used to
+ *    endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDER AND CONTRIBUTORS “AS IS”
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @internal
+ * Tests of the hzl_ServerTick() function.
+ *
+ * @warning
+ * REDUCING COVERAGE ON PURPOSE. NOT implementing all the testcases for all possible incorrect
+ * content of the context, because they have already been checked for the hzl_ServerInit()
+ * function and the inner checks are exactly the same, performed by the same internal
+ * function hzl_ServerCheckCtxPointers().
+ */
+
+#include "hzlTest.h"
+
+static void
+hzlServerTest_ServerTickOutputsMustBeNotNull(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerTimerWheel_t timerWheel;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .timerWheel = &timerWheel,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t renewalPdus[1];
+    size_t amount = 123;
+
+    err = hzl_ServerTick(renewalPdus, NULL, &ctx, 1, 0);
+    atto_eq(err, HZL_ERR_NULL_PDU);
+
+    err = hzl_ServerTick(NULL, &amount, &ctx, 1, 0);
+    atto_eq(err, HZL_ERR_NULL_PDU);
+    atto_eq(amount, 0);
+
+    // No space for messages: allowed to be NULL
+    err = hzl_ServerTick(NULL, &amount, &ctx, 0, timerWheel.nextTickInstant);
+    atto_eq(err, HZL_OK);
+    atto_eq(amount, 0);
+}
+
+static void
+hzlServerTest_ServerTickCtxMustBeNotNull(void)
+{
+    hzl_Err_t err;
+    hzl_CbsPduMsg_t renewalPdus[1];
+    size_t amount;
+
+    err = hzl_ServerTick(renewalPdus, &amount, NULL, 1, 0);
+
+    atto_eq(err, HZL_ERR_NULL_CTX);
+}
+
+static void
+hzlServerTest_ServerTickTimerWheelMustBeNotNull(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t renewalPdus[1];
+    size_t amount;
+
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx, 1, 0);
+
+    atto_eq(err, HZL_ERR_NULL_TIMER_WHEEL);
+}
+
+static void
+hzlServerTest_ServerTickDoesNothingBeforeSessionExpiration(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerTimerWheel_t timerWheel;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .timerWheel = &timerWheel,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t renewalPdus[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    size_t amount;
+    const hzl_Timestamp_t sessionStart = HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant;
+
+    // Session of Group 0 lasts 50000 ms: still valid at its last instant
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx,
+                         HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, sessionStart + 50000U);
+
+    atto_eq(err, HZL_OK);
+    atto_eq(amount, 0);
+    atto_eq(timerWheel.nextTickInstant, sessionStart + 50001U);
+    for (hzl_Gid_t gid = 0; gid < HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS; gid++)
+    {
+        atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, gid)->sessionState, HZL_SESSION_STATE_ACTIVE);
+    }
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant, sessionStart);
+
+    // Same instant again: already processed
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx,
+                         HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, sessionStart + 50000U);
+    atto_eq(err, HZL_OK);
+    atto_eq(amount, 0);
+    atto_eq(timerWheel.nextTickInstant, sessionStart + 50001U);
+}
+
+static void
+hzlServerTest_ServerTickRenewsExpiredSessionWithRenMsg(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerTimerWheel_t timerWheel;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .timerWheel = &timerWheel,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t renewalPdus[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    size_t amount;
+    const hzl_Timestamp_t sessionStart = HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant;
+    // Assume at least one Client Requested the state already:
+    // the last RX message was after the start of the session.
+    hzlTest_IoMockupCurrentTimeSucceeding(
+            &HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->currentRxLastMessageInstant);
+    groupStates[0].currentStk[0] = 99;
+
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx,
+                         HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, sessionStart + 50001U);
+
+    atto_eq(err, HZL_OK);
+    atto_eq(amount, 1);
+    // Session was renewed
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionState, HZL_SESSION_STATE_RENEWING);
+    atto_neq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant, sessionStart);
+    atto_eq(groupStates[0].previousStk[0], 99);
+    // REN message available, packed header 0
+    atto_eq(renewalPdus[0].dataLen, 3 + 19);
+    atto_eq(renewalPdus[0].data[0], 0);  // GID
+    atto_eq(renewalPdus[0].data[1], 0);  // SID
+    // Other Groups are untouched
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->sessionState, HZL_SESSION_STATE_ACTIVE);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 2)->sessionState, HZL_SESSION_STATE_ACTIVE);
+}
+
+static void
+hzlServerTest_ServerTickRotatesExpiredSessionWithoutReceivers(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerTimerWheel_t timerWheel;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .timerWheel = &timerWheel,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t renewalPdus[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    size_t amount;
+    const hzl_Timestamp_t sessionStart = HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant;
+    groupStates[0].currentStk[0] = 99;
+
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx,
+                         HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, sessionStart + 50001U);
+
+    atto_eq(err, HZL_OK);
+    // No Client has the expired Session: no REN, no renewal phase
+    atto_eq(amount, 0);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionState, HZL_SESSION_STATE_ACTIVE);
+    atto_neq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 0)->sessionStartInstant, sessionStart);
+    atto_neq(groupStates[0].currentStk[0], 99);
+    atto_zeros(groupStates[0].previousStk, HZL_STK_LEN);
+}
+
+static void
+hzlServerTest_ServerTickPacesRenMsgsAndEndsRenewalPhase(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerTimerWheel_t timerWheel;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .timerWheel = &timerWheel,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t renewalPdus[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    size_t amount;
+    hzlTest_IoMockupCurrentTimeSucceeding(
+            &HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentRxLastMessageInstant);
+    // Entering the renewal phase reschedules the Group
+    err = hzl_ServerForceSessionRenewal(&renewalPdus[0], &ctx, 1);
+    atto_eq(err, HZL_OK);
+    const hzl_Timestamp_t sessionStart = HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->sessionStartInstant;
+    const hzl_CtrNonce_t renCtrNonce = HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->previousCtrNonce;
+
+    // Delay between REN messages is 4000 ms
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx,
+                         HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, sessionStart + 3999U);
+    atto_eq(err, HZL_OK);
+    atto_eq(amount, 0);
+
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx,
+                         HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, sessionStart + 4000U);
+    atto_eq(err, HZL_OK);
+    atto_eq(amount, 1);
+    atto_eq(renewalPdus[0].dataLen, 3 + 19);
+    atto_eq(renewalPdus[0].data[0], 1);  // GID
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->previousCtrNonce, renCtrNonce + 1U);
+
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx,
+                         HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, sessionStart + 7999U);
+    atto_eq(err, HZL_OK);
+    atto_eq(amount, 0);
+
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx,
+                         HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, sessionStart + 8000U);
+    atto_eq(err, HZL_OK);
+    atto_eq(amount, 1);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->sessionState, HZL_SESSION_STATE_RENEWING);
+
+    // Renewal phase lasts 6 * 4000 ms: the missed REN messages are not sent late
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx,
+                         HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, sessionStart + 24001U);
+    atto_eq(err, HZL_OK);
+    atto_eq(amount, 0);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->sessionState, HZL_SESSION_STATE_ACTIVE);
+    atto_zeros(groupStates[1].previousStk, HZL_STK_LEN);
+
+    err = hzl_ServerDeInit(&ctx);
+    atto_eq(err, HZL_OK);
+    atto_zeros(&timerWheel, sizeof(timerWheel));
+}
+
+static void
+hzlServerTest_ServerTickResumesWhenOutOfCapacity(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerTimerWheel_t timerWheel;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .timerWheel = &timerWheel,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    hzl_CbsPduMsg_t renewalPdus[1];
+    size_t amount;
+    hzlTest_IoMockupCurrentTimeSucceeding(
+            &HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->currentRxLastMessageInstant);
+    hzlTest_IoMockupCurrentTimeSucceeding(
+            &HZL_TEST_SERVER_GROUP_HOT(&ctx, 2)->currentRxLastMessageInstant);
+    // Both Groups 1 and 2 expired, far from the previous tick: all Groups are rescheduled
+    const hzl_Timestamp_t now =
+            HZL_TEST_SERVER_GROUP_HOT(&ctx, 2)->sessionStartInstant + 1200001U;
+
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx, 1, now);
+    atto_eq(err, HZL_OK);
+    atto_eq(amount, 1);
+    const uint8_t firstGid = renewalPdus[0].data[0];
+    atto_true(firstGid == 1 || firstGid == 2);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, firstGid)->sessionState,
+            HZL_SESSION_STATE_RENEWING);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 3 - firstGid)->sessionState,
+            HZL_SESSION_STATE_ACTIVE);
+
+    // The remaining due event is handled by the next call, even at the same instant
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx, 1, now);
+    atto_eq(err, HZL_OK);
+    atto_eq(amount, 1);
+    atto_eq(renewalPdus[0].data[0], 3 - firstGid);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 1)->sessionState, HZL_SESSION_STATE_RENEWING);
+    atto_eq(HZL_TEST_SERVER_GROUP_HOT(&ctx, 2)->sessionState, HZL_SESSION_STATE_RENEWING);
+}
+
+static void
+hzlServerTest_ServerTickGeneratesUsedNextStks(void)
+{
+    hzl_Err_t err;
+    hzl_ServerGroupState_t groupStates[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    hzl_ServerTimerWheel_t timerWheel;
+    hzl_ServerCtx_t ctx = {
+            .serverConfig = &HZL_TEST_CORRECT_SERVER_CONFIG,
+            .clientConfigs = HZL_TEST_SERVER_CORRECT_CLIENT_CONFIGS,
+            .groupConfigs = HZL_TEST_SERVER_CORRECT_GROUP_CONFIGS,
+            .groupStates = groupStates,
+            .timerWheel = &timerWheel,
+            .io = HZL_TEST_CORRECT_IO,
+    };
+    err = hzl_ServerInit(&ctx);
+    atto_eq(err, HZL_OK);
+    atto_zeros(timerWheel.nextStkToGenerateBitmap, sizeof(timerWheel.nextStkToGenerateBitmap));
+    hzl_CbsPduMsg_t renewalPdus[HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS];
+    size_t amount;
+    hzlTest_IoMockupCurrentTimeSucceeding(
+            &HZL_TEST_SERVER_GROUP_HOT(&ctx, 2)->currentRxLastMessageInstant);
+    err = hzl_ServerForceSessionRenewal(&renewalPdus[0], &ctx, 2);
+    atto_eq(err, HZL_OK);
+    atto_false(groupStates[2].nextAeadKey.isExpanded);
+    atto_eq(timerWheel.nextStkToGenerateBitmap[0], 1U << 2U);
+    const hzl_Timestamp_t now = timerWheel.nextTickInstant;
+
+    // Failing TRNG: retried on the next call
+    ctx.io.trng = hzlTest_IoMockupTrngFailing;
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx, HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, now);
+    atto_eq(err, HZL_ERR_CANNOT_GENERATE_RANDOM);
+    atto_false(groupStates[2].nextAeadKey.isExpanded);
+    atto_eq(timerWheel.nextStkToGenerateBitmap[0], 1U << 2U);
+
+    ctx.io.trng = hzlTest_IoMockupTrngSucceeding;
+    err = hzl_ServerTick(renewalPdus, &amount, &ctx, HZL_DEFAULT_TEST_AMOUNT_OF_GROUPS, now);
+    atto_eq(err, HZL_OK);
+    atto_eq(amount, 0);
+    atto_true(groupStates[2].nextAeadKey.isExpanded);
+    atto_zeros(timerWheel.nextStkToGenerateBitmap, sizeof(timerWheel.nextStkToGenerateBitmap));
+    err = hzl_ServerDeInit(&ctx);
+    atto_eq(err, HZL_OK);
+}
+
+void hzlServerTest_ServerTick(void)
+{
+    hzlServerTest_ServerTickOutputsMustBeNotNull();
+    hzlServerTest_ServerTickCtxMustBeNotNull();
+    hzlServerTest_ServerTickTimerWheelMustBeNotNull();
+    hzlServerTest_ServerTickDoesNothingBeforeSessionExpiration();
+    hzlServerTest_ServerTickRenewsExpiredSessionWithRenMsg();
+    hzlServerTest_ServerTickRotatesExpiredSessionWithoutReceivers();
+    hzlServerTest_ServerTickPacesRenMsgsAndEndsRenewalPhase();
+    hzlServerTest_ServerTickResumesWhenOutOfCapacity();
+    hzlServerTest_ServerTickGeneratesUsedNextStks();
+    HZL_TEST_PARTIAL_REPORT();
+}